@@ -0,0 +1,588 @@
+/* bench/bench.c
+ *
+ * Micro-benchmarks for the hot parts of the engine.  The game data is read
+ * once, a character is born, and each benchmark is then run on a level made
+ * from a fixed seed, enough times to take about BENCH_TIME seconds.
+ *
+ * Usage: bench [-w] [-b <file>] [-t <percent>] [name...]
+ *        bench -g <seeds> [depth...]
+ *   -w            write the results as the new baseline
+ *   -b <file>     the baseline to compare with (default: baseline.txt)
+ *   -t <percent>  how much slower than the baseline counts (default: 10)
+ *   name...       only run benchmarks whose names start with one of these
+ *   -g <seeds>    instead, build <seeds> levels at each depth and report
+ *                 where the time went for each cave profile
+ *
+ * Baselines only mean anything on the machine and build they were made on.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-input.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-util.h"
+#include "obj-desc.h"
+#include "obj-power.h"
+#include "parser.h"
+#include "player-calcs.h"
+#include "player-path.h"
+#include "project.h"
+#include "savefile.h"
+#include "test-utils.h"
+#include "z-util.h"
+
+#define BENCH_TIME 0.25
+#define BENCH_SEED 0x5eed
+#define BENCH_DEPTH 10
+#define BENCH_POINTS 64
+#define BENCH_SAVE "bench-save"
+#define GEN_REPORT_SEEDS 20
+
+struct bench {
+	const char *name;
+	void (*run)(int n);
+	const char *profile;
+};
+
+/**
+ * Passable grids picked on the benchmark level, for paths and sight lines
+ */
+static struct loc points[BENCH_POINTS];
+
+static double now(void)
+{
+#if defined(UNIX) && defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void println(const char *str)
+{
+	printf("%s\n", str);
+}
+
+static void seed(void)
+{
+	Rand_quick = false;
+	state_i = 0;
+	Rand_state_init(BENCH_SEED);
+}
+
+/**
+ * Make the level the benchmarks run on, the same every time
+ */
+static void make_level(void)
+{
+	int i;
+
+	seed();
+	player->depth = BENCH_DEPTH;
+	cave_generate(&cave, player);
+	on_new_level();
+	wiz_light(cave, true);
+
+	for (i = 0; i < BENCH_POINTS; i++) {
+		int y, x;
+
+		cave_find(cave, &y, &x, square_ispassable);
+		points[i] = loc(x, y);
+	}
+}
+
+static void bench_los(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[i % BENCH_POINTS];
+		struct loc b = points[(i * 7 + 3) % BENCH_POINTS];
+
+		los(cave, a.y, a.x, b.y, b.x);
+	}
+}
+
+static void bench_distance(int n)
+{
+	int i, total = 0;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[i % BENCH_POINTS];
+		struct loc b = points[(i * 7 + 3) % BENCH_POINTS];
+
+		total += distance(a.y, a.x, b.y, b.x);
+	}
+
+	/* Keep the result live */
+	if (total < 0) println("");
+}
+
+static void bench_update_view(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[i % BENCH_POINTS];
+
+		player->py = a.y;
+		player->px = a.x;
+		update_view(cave, player);
+	}
+}
+
+static void bench_update_monsters(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[(i / 8) % BENCH_POINTS];
+
+		/* A move, then a few updates with the player standing still */
+		if (i % 8 == 0) {
+			player->py = a.y;
+			player->px = a.x;
+			update_view(cave, player);
+			update_monsters(true);
+		} else {
+			update_monsters(false);
+		}
+	}
+}
+
+static void bench_project_path(int n)
+{
+	struct loc path[512];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[i % BENCH_POINTS];
+		struct loc b = points[(i * 7 + 3) % BENCH_POINTS];
+
+		project_path(path, z_info->max_range, a.y, a.x, b.y, b.x, 0);
+	}
+}
+
+static void bench_findpath(int n)
+{
+	int i;
+
+	player->py = points[0].y;
+	player->px = points[0].x;
+	for (i = 0; i < n; i++) {
+		struct loc b = points[1 + i % (BENCH_POINTS - 1)];
+
+		findpath(b.y, b.x);
+	}
+}
+
+static void bench_make_noise(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct loc a = points[i % BENCH_POINTS];
+
+		/* Make the whole field again each time */
+		player->py = a.y;
+		player->px = a.x;
+		cave->noise_origin = loc(-1, -1);
+		make_noise(player);
+	}
+}
+
+static void bench_calc_bonuses(int n)
+{
+	struct player_state state;
+	int i;
+
+	for (i = 0; i < n; i++)
+		calc_bonuses(player, &state, false, false);
+}
+
+static void bench_object_desc(int n)
+{
+	char buf[80];
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct object *obj;
+
+		for (obj = player->gear; obj; obj = obj->next)
+			object_desc(buf, sizeof(buf), obj, ODESC_PREFIX | ODESC_FULL);
+	}
+}
+
+static void bench_object_power(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		struct object *obj;
+
+		for (obj = player->gear; obj; obj = obj->next)
+			object_power(obj, false, NULL);
+	}
+}
+
+static enum parser_error parse_bench(struct parser *p)
+{
+	return parser_getint(p, "idx") < 0 ? PARSE_ERROR_GENERIC :
+		PARSE_ERROR_NONE;
+}
+
+static void bench_parser_parse(int n)
+{
+	struct parser *p = parser_new();
+	int i;
+
+	parser_reg(p, "name int idx str text", parse_bench);
+	for (i = 0; i < n; i++)
+		parser_parse(p, "name:123:Grip, Farmer Maggot's Dog");
+	parser_destroy(p);
+}
+
+static void bench_savefile(int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (!savefile_save(BENCH_SAVE) || !savefile_load(BENCH_SAVE, false))
+			quit("Savefile round trip failed");
+	}
+}
+
+/**
+ * Asked for the profile by cave_generate() through the debug hack used for
+ * jumping levels
+ */
+static const char *gen_profile;
+
+static bool gen_get_string(const char *prompt, char *buf, size_t len)
+{
+	my_strcpy(buf, gen_profile, len);
+	return true;
+}
+
+static const struct bench *gen_bench;
+
+static void bench_cave_generate(int n)
+{
+	bool (*old_hook)(const char *prompt, char *buf, size_t len) =
+		get_string_hook;
+	int i;
+
+	gen_profile = gen_bench->profile;
+	get_string_hook = gen_get_string;
+	player->depth = streq(gen_profile, "town") ? 0 : BENCH_DEPTH;
+	for (i = 0; i < n; i++) {
+		player->noscore |= NOSCORE_JUMPING;
+		cave_generate(&cave, player);
+	}
+	player->noscore &= ~(NOSCORE_JUMPING);
+	get_string_hook = old_hook;
+}
+
+static const struct bench benches[] = {
+	{ "los", bench_los, NULL },
+	{ "distance", bench_distance, NULL },
+	{ "update_view", bench_update_view, NULL },
+	{ "update_monsters", bench_update_monsters, NULL },
+	{ "project_path", bench_project_path, NULL },
+	{ "findpath", bench_findpath, NULL },
+	{ "make_noise", bench_make_noise, NULL },
+	{ "calc_bonuses", bench_calc_bonuses, NULL },
+	{ "object_desc", bench_object_desc, NULL },
+	{ "object_power", bench_object_power, NULL },
+	{ "parser_parse", bench_parser_parse, NULL },
+	{ "savefile", bench_savefile, NULL },
+	{ "cave_generate/town", bench_cave_generate, "town" },
+	{ "cave_generate/classic", bench_cave_generate, "classic" },
+	{ "cave_generate/modified", bench_cave_generate, "modified" },
+	{ "cave_generate/moria", bench_cave_generate, "moria" },
+	{ "cave_generate/lair", bench_cave_generate, "lair" },
+	{ "cave_generate/cavern", bench_cave_generate, "cavern" },
+	{ "cave_generate/labyrinth", bench_cave_generate, "labyrinth" },
+	{ "cave_generate/gauntlet", bench_cave_generate, "gauntlet" },
+	{ "cave_generate/hard centre", bench_cave_generate, "hard centre" },
+};
+
+/**
+ * Print one line of the generation report; times are per finished level
+ */
+static void gen_report_line(const char *name, const struct gen_stats *s)
+{
+	double levels = s->levels ? s->levels : 1;
+	double staged = 0.0;
+	int k;
+
+	printf("%-12s %6lu %6lu %5lu %5lu %8.2f", name, (unsigned long)s->levels,
+		   (unsigned long)s->attempts, (unsigned long)s->no_builder,
+		   (unsigned long)s->too_many_monsters, s->total / levels);
+	for (k = 0; k < GEN_STAGE_MAX; k++) {
+		printf(" %9.2f", s->stage[k] / levels);
+		staged += s->stage[k];
+	}
+	printf(" %9.2f\n", (s->total - staged) / levels);
+}
+
+static void gen_report_head(void)
+{
+	int k;
+
+	printf("%-12s %6s %6s %5s %5s %8s", "profile", "levels", "tries",
+		   "nobld", "mons", "ms/level");
+	for (k = 0; k < GEN_STAGE_MAX; k++)
+		printf(" %9s", gen_stage_name(k));
+	printf(" %9s\n", "other");
+}
+
+static void gen_stats_add(struct gen_stats *to, const struct gen_stats *s)
+{
+	int k;
+
+	to->levels += s->levels;
+	to->attempts += s->attempts;
+	to->no_builder += s->no_builder;
+	to->too_many_monsters += s->too_many_monsters;
+	to->total += s->total;
+	for (k = 0; k < GEN_STAGE_MAX; k++)
+		to->stage[k] += s->stage[k];
+}
+
+/**
+ * Build seeds levels at each depth, each from a seed of its own, letting
+ * cave_generate() choose the profile as it would in play, and say for each
+ * profile how often it had to try again and which stages took the time.
+ * "nobld" counts tries the builder gave up on, and "mons" those thrown away
+ * for having too many monsters; "other" is the time outside the stages.
+ */
+static void gen_report(int seeds, const int *depths, int n_depths)
+{
+	struct gen_stats all[64];
+	int i, j, n_profiles = 0;
+
+	memset(all, 0, sizeof(all));
+	gen_stats_on = true;
+	for (i = 0; i < n_depths; i++) {
+		struct gen_stats depth_total;
+		struct gen_stats s;
+		const char *name;
+		int prof;
+
+		memset(&depth_total, 0, sizeof(depth_total));
+		gen_stats_reset();
+		player->depth = depths[i];
+		for (j = 0; j < seeds; j++) {
+			Rand_quick = false;
+			state_i = 0;
+			Rand_state_init(BENCH_SEED + j);
+			cave_generate(&cave, player);
+		}
+
+		printf("depth %d, %d levels\n", depths[i], seeds);
+		gen_report_head();
+		for (prof = 0; (name = gen_stats_get(prof, &s)); prof++) {
+			if (prof < (int)N_ELEMENTS(all)) {
+				gen_stats_add(&all[prof], &s);
+				n_profiles = MAX(n_profiles, prof + 1);
+			}
+			if (!s.attempts) continue;
+			gen_report_line(name, &s);
+			gen_stats_add(&depth_total, &s);
+		}
+		gen_report_line("all", &depth_total);
+		printf("\n");
+		fflush(stdout);
+	}
+
+	printf("all depths\n");
+	gen_report_head();
+	for (i = 0; i < n_profiles; i++) {
+		struct gen_stats s;
+		const char *name = gen_stats_get(i, &s);
+
+		if (all[i].attempts) gen_report_line(name, &all[i]);
+	}
+
+	gen_stats_on = false;
+	gen_stats_reset();
+}
+
+/**
+ * Run one benchmark, doubling the count until it takes long enough to
+ * time, and return nanoseconds per operation
+ */
+static double run_bench(const struct bench *b)
+{
+	double start, spent = 0.0;
+	int n = 1;
+
+	gen_bench = b;
+	while (true) {
+		make_level();
+		start = now();
+		b->run(n);
+		spent = now() - start;
+		if (spent >= BENCH_TIME || n >= (1 << 24)) break;
+		n *= 2;
+	}
+
+	return spent * 1e9 / n;
+}
+
+/**
+ * Read the baseline for each benchmark, leaving 0 where there isn't one
+ */
+static void read_baseline(const char *path, double *baseline)
+{
+	char line[256];
+	ang_file *f = file_open(path, MODE_READ, FTYPE_TEXT);
+	size_t j;
+
+	if (!f) return;
+
+	while (file_getl(f, line, sizeof(line))) {
+		/* The time is after the last space; names may have spaces in */
+		char *gap = strrchr(line, ' ');
+
+		if (!gap) continue;
+		*gap = '\0';
+		for (j = 0; j < N_ELEMENTS(benches); j++)
+			if (streq(line, benches[j].name))
+				baseline[j] = atof(gap + 1);
+	}
+
+	file_close(f);
+}
+
+static bool wanted(const char *name, int argc, char *argv[], int first)
+{
+	int i;
+
+	if (first >= argc) return true;
+	for (i = first; i < argc; i++)
+		if (prefix(name, argv[i])) return true;
+
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *base_path = "baseline.txt";
+	double threshold = 10.0;
+	bool write = false;
+	int gen_seeds = 0;
+	ang_file *out;
+	double results[N_ELEMENTS(benches)];
+	double baseline[N_ELEMENTS(benches)] = { 0.0 };
+	int slower = 0;
+	int i;
+	size_t j;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (streq(argv[i], "-w")) {
+			write = true;
+		} else if (streq(argv[i], "-b") && i + 1 < argc) {
+			base_path = argv[++i];
+		} else if (streq(argv[i], "-t") && i + 1 < argc) {
+			threshold = atof(argv[++i]);
+		} else if (streq(argv[i], "-g") && i + 1 < argc) {
+			gen_seeds = atoi(argv[++i]);
+			if (gen_seeds <= 0) gen_seeds = GEN_REPORT_SEEDS;
+		} else {
+			printf("Usage: %s [-w] [-b <file>] [-t <percent>] [name...]\n"
+				   "       %s -g <seeds> [depth...]\n", argv[0], argv[0]);
+			return 2;
+		}
+	}
+
+	/* Read the game data once, and make a character to play with */
+	plog_aux = println;
+	game_headless = true;
+	set_file_paths();
+	init_angband();
+
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", "Bencher");
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	if (gen_seeds) {
+		int depths[128];
+		int n_depths = 0;
+
+		/* The depths asked for, or every tenth level */
+		for (; i < argc && n_depths < (int)N_ELEMENTS(depths); i++) {
+			int depth = atoi(argv[i]);
+
+			depths[n_depths++] = MAX(0, MIN(depth, z_info->max_depth - 1));
+		}
+		if (!n_depths) {
+			for (n_depths = 0; n_depths < 10; n_depths++)
+				depths[n_depths] = n_depths ? n_depths * 10 : 1;
+		}
+
+		gen_report(gen_seeds, depths, n_depths);
+		cleanup_angband();
+		return 0;
+	}
+
+	if (!write) read_baseline(base_path, baseline);
+
+	printf("%-26s %14s %14s\n", "benchmark", "ns/op", "baseline");
+	for (j = 0; j < N_ELEMENTS(benches); j++) {
+		const struct bench *b = &benches[j];
+		double was = baseline[j];
+
+		if (!wanted(b->name, argc, argv, i)) {
+			results[j] = 0.0;
+			continue;
+		}
+
+		results[j] = run_bench(b);
+		if (was > 0.0) {
+			double change = (results[j] - was) * 100.0 / was;
+			bool worse = change > threshold;
+
+			printf("%-26s %14.1f %14.1f %+6.1f%%%s\n", b->name, results[j],
+				   was, change, worse ? "  SLOWER" : "");
+			if (worse) slower++;
+		} else {
+			printf("%-26s %14.1f %14s\n", b->name, results[j], "-");
+		}
+		fflush(stdout);
+	}
+
+	if (write) {
+		out = file_open(base_path, MODE_WRITE, FTYPE_TEXT);
+		if (!out) quit_fmt("Cannot write '%s'", base_path);
+		for (j = 0; j < N_ELEMENTS(benches); j++)
+			if (results[j] > 0.0)
+				file_putf(out, "%s %.1f\n", benches[j].name, results[j]);
+		file_close(out);
+		printf("Baseline written to %s\n", base_path);
+	}
+
+	file_delete(BENCH_SAVE);
+	file_delete(SAVEFILE_INDEX_NAME);
+	cleanup_angband();
+
+	if (slower)
+		printf("%d benchmark%s slower than the baseline\n", slower,
+			   slower == 1 ? "" : "s");
+	return slower ? 1 : 0;
+}
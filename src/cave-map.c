@@ -164,6 +164,7 @@ void map_info(unsigned y, unsigned x, struct grid_data *g)
 
 	/* Rare random hallucination on non-outer walls */
 	if (g->hallucinate && g->m_idx == 0 && g->first_kind == 0) {
+		int rng = Rand_stream(RNG_UI);
 		if (one_in_(128) && (int) g->f_idx != FEAT_PERM)
 			g->m_idx = 1;
 		else if (one_in_(128) && (int) g->f_idx != FEAT_PERM)
@@ -171,6 +172,7 @@ void map_info(unsigned y, unsigned x, struct grid_data *g)
 			g->first_kind = k_info;
 		else
 			g->hallucinate = false;
+		Rand_stream(rng);
 	}
 
 	assert((int) g->f_idx <= FEAT_PASS_RUBBLE);
@@ -355,18 +357,21 @@ static void cave_unlight(struct point_set *ps)
 
 /*
  * Aux function -- see below
+ *
+ * The grid's own tests come first, so that only room grids are looked for
+ * in the set
  */
 static void cave_room_aux(struct point_set *seen, int y, int x)
 {
-	if (point_set_contains(seen, y, x))
-		return;
-
 	if (!square_in_bounds(cave, y, x))
 		return;
 
 	if (!square_isroom(cave, y, x))
 		return;
 
+	if (point_set_contains(seen, y, x))
+		return;
+
 	/* Add it to the "seen" set */
 	add_to_point_set(seen, y, x);
 }
@@ -567,8 +572,10 @@ void cave_known(struct player *p)
 			}
 
 			/* Internal walls not known */
-			if (count < 8)
+			if (count < 8) {
 				p->cave->squares[y][x].feat = cave->squares[y][x].feat;
+				square_sync_projectable(p->cave, y, x);
+			}
 		}
 	}
 }
@@ -73,7 +73,7 @@ bool feat_is_treasure(int feat)
  */
 bool feat_is_wall(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_WALL);
+	return feat_has_cap(feat, FCAP_WALL) ? true : false;
 }
 
 /**
@@ -105,7 +105,7 @@ bool feat_is_object_holding(int feat)
  */
 bool feat_is_monster_walkable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PASSABLE);
+	return feat_has_cap(feat, FCAP_PASSABLE) ? true : false;
 }
 
 /**
@@ -121,7 +121,7 @@ bool feat_is_shop(int feat)
  */
 bool feat_is_passable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PASSABLE);
+	return feat_has_cap(feat, FCAP_PASSABLE) ? true : false;
 }
 
 /**
@@ -129,7 +129,7 @@ bool feat_is_passable(int feat)
  */
 bool feat_is_projectable(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_PROJECT);
+	return feat_has_cap(feat, FCAP_PROJECT) ? true : false;
 }
 
 /**
@@ -137,7 +137,7 @@ bool feat_is_projectable(int feat)
  */
 bool feat_is_torch(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_TORCH);
+	return feat_has_cap(feat, FCAP_TORCH) ? true : false;
 }
 
 /**
@@ -145,7 +145,7 @@ bool feat_is_torch(int feat)
  */
 bool feat_is_bright(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_BRIGHT);
+	return feat_has_cap(feat, FCAP_BRIGHT) ? true : false;
 }
 
 /**
@@ -153,7 +153,7 @@ bool feat_is_bright(int feat)
  */
 bool feat_is_fiery(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_FIERY);
+	return feat_has_cap(feat, FCAP_FIERY) ? true : false;
 }
 
 /**
@@ -161,7 +161,7 @@ bool feat_is_fiery(int feat)
  */
 bool feat_is_no_flow(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_NO_FLOW);
+	return feat_has_cap(feat, FCAP_NO_FLOW) ? true : false;
 }
 
 /**
@@ -169,7 +169,7 @@ bool feat_is_no_flow(int feat)
  */
 bool feat_is_no_scent(int feat)
 {
-	return tf_has(f_info[feat].flags, TF_NO_SCENT);
+	return feat_has_cap(feat, FCAP_NO_SCENT) ? true : false;
 }
 
 /**
@@ -628,7 +628,7 @@ bool square_ispassable(struct chunk *c, int y, int x) {
  */
 bool square_isprojectable(struct chunk *c, int y, int x) {
 	if (!square_in_bounds(c, y, x)) return false;
-	return feat_is_projectable(c->squares[y][x].feat);
+	return square_project_bit(c, y, x) ? true : false;
 }
 
 /**
@@ -694,7 +694,12 @@ bool square_isnoscent(struct chunk *c, int y, int x) {
 
 bool square_iswarded(struct chunk *c, int y, int x)
 {
-	struct trap_kind *rune = lookup_trap("glyph of warding");
+	struct trap_kind *rune;
+
+	/* Most squares have no trap at all; skip the kind lookup for those */
+	if (!square_istrap(c, y, x)) return false;
+
+	rune = lookup_trap("glyph of warding");
 	return square_trap_specific(c, y, x, rune->tidx);
 }
 
@@ -893,6 +898,9 @@ bool square_holds_object(struct chunk *c, int y, int x, struct object *obj) {
 void square_excise_object(struct chunk *c, int y, int x, struct object *obj) {
 	assert(square_in_bounds(c, y, x));
 	pile_excise(&c->squares[y][x].obj, obj);
+	c->fingerprint -= square_fingerprint_obj(y, x, obj);
+	square_pile_changed(c, y, x);
+	square_note_empty(c, y, x);
 }
 
 /**
@@ -900,8 +908,11 @@ void square_excise_object(struct chunk *c, int y, int x, struct object *obj) {
  */
 void square_excise_pile(struct chunk *c, int y, int x) {
 	assert(square_in_bounds(c, y, x));
+	c->fingerprint -= square_fingerprint_pile(c, y, x);
 	object_pile_free(square_object(c, y, x));
 	c->squares[y][x].obj = NULL;
+	square_pile_changed(c, y, x);
+	square_note_empty(c, y, x);
 }
 
 /**
@@ -917,17 +928,28 @@ void square_sense_pile(struct chunk *c, int y, int x)
 	for (obj = square_object(c, y, x); obj; obj = obj->next) {
 		object_sense(player, obj);
 	}
+
+	/* What the player knows of the pile has changed */
+	square_pile_changed(player->cave, y, x);
 }
 
 /**
- * Update the player's knowledge of the objects on a grid in the current level
+ * Update the player's knowledge of the objects on a grid in the current level.
+ * Nothing need be done if neither the pile nor the player's record of it has
+ * changed since this was last done, unless the player is standing on it.
  */
 void square_know_pile(struct chunk *c, int y, int x)
 {
 	struct object *obj;
+	u32b stamp;
 
 	if (c != cave) return;
 
+	stamp = c->pile_stamps[y * c->width + x];
+	if (stamp && stamp == player->cave->pile_stamps[y * c->width + x] &&
+		((y != player->py) || (x != player->px)))
+		return;
+
 	object_lists_check_integrity(c, player->cave);
 
 	/* Know every item on this grid, greater knowledge for the player grid */
@@ -960,6 +982,9 @@ void square_know_pile(struct chunk *c, int y, int x)
 		}
 		obj = next;
 	}
+
+	/* The record now matches the pile as it is */
+	player->cave->pile_stamps[y * c->width + x] = stamp;
 }
 
 
@@ -979,9 +1004,23 @@ void square_set_feat(struct chunk *c, int y, int x, int feat)
 	/* Track changes */
 	if (current_feat) c->feat_count[current_feat]--;
 	if (feat) c->feat_count[feat]++;
+	c->fingerprint += square_fingerprint_feat(y, x, feat) -
+		square_fingerprint_feat(y, x, current_feat);
 
 	/* Make the change */
 	c->squares[y][x].feat = feat;
+	square_sync_projectable(c, y, x);
+
+	/* Stored view LOS may now be wrong */
+	if (feat_is_projectable(current_feat) != feat_is_projectable(feat))
+		square_note_opacity(c, y, x);
+
+	/* So may the noise field */
+	if (feat_is_no_flow(current_feat) != feat_is_no_flow(feat))
+		square_note_flow(c, y, x);
+
+	/* And may have opened up a grid for generation to place things in */
+	square_note_empty(c, y, x);
 
 	/* Make the new terrain feel at home */
 	if (character_dungeon) {
@@ -999,6 +1038,160 @@ void square_set_feat(struct chunk *c, int y, int x, int feat)
 	}
 }
 
+/**
+ * Bring the projectable bitboard up to date with the terrain at a grid.
+ * Anything which writes to squares[y][x].feat directly must call this.
+ */
+void square_sync_projectable(struct chunk *c, int y, int x)
+{
+	u32b *word = &c->project_bits[y * c->project_stride + (x >> 5)];
+	u32b bit = 1UL << (x & 31);
+
+	if (feat_is_projectable(c->squares[y][x].feat))
+		*word |= bit;
+	else
+		*word &= ~bit;
+}
+
+/**
+ * Note that the grid at (y, x) has changed whether it carries noise.  A grid
+ * which now lets noise through can only shorten paths, so it is kept for
+ * make_noise() to spread out from; one which now blocks noise means the
+ * field has to be made again from scratch.
+ */
+void square_note_flow(struct chunk *c, int y, int x)
+{
+	if (c->noise_origin.x < 0) return;
+
+	if (square_isnoflow(c, y, x)) {
+		c->noise_origin = loc(-1, -1);
+		return;
+	}
+
+	if (!c->noise_opened)
+		c->noise_opened = point_set_new(8);
+	add_to_point_set(c->noise_opened, y, x);
+}
+
+/**
+ * Note that the grid at (y, x) may have become empty, so that find_empty()
+ * can draw it while generation is keeping its list of empty grids.
+ */
+void square_note_empty(struct chunk *c, int y, int x)
+{
+	int grid = y * c->width + x;
+
+	if (!c->empty_grids || c->empty_slots[grid]) return;
+	if (!square_isempty(c, y, x)) return;
+
+	c->empty_grids[c->empty_num++] = grid;
+	c->empty_slots[grid] = c->empty_num;
+}
+
+/**
+ * Note that the pile of objects at (y, x) has changed, so that what the
+ * player knows of it must be brought up to date when it is next seen.  Each
+ * change gets a stamp of its own, so a grid of the player's record only
+ * matches the level if it was last brought up to date from the pile as it
+ * is now; a stamp of 0 means nothing is known about the grid.
+ */
+void square_pile_changed(struct chunk *c, int y, int x)
+{
+	static u32b pile_clock;
+
+	if (!++pile_clock) pile_clock = 1;
+	c->pile_stamps[y * c->width + x] = pile_clock;
+}
+
+/**
+ * Mix a grid, a kind of thing and which one of them it is into 64 bits,
+ * spread well enough that sums of them are unlikely to collide
+ */
+static u64b fingerprint_mix(int y, int x, int what, int which)
+{
+	u64b z = ((u64b)y << 44) ^ ((u64b)x << 28) ^ ((u64b)what << 24) ^
+		(u64b)(which & 0xFFFFFF);
+
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * What a feature adds to the fingerprint of a chunk at (y, x)
+ */
+u64b square_fingerprint_feat(int y, int x, int feat)
+{
+	return feat ? fingerprint_mix(y, x, 0, feat) : 0;
+}
+
+/**
+ * What the monster or player at (y, x) adds to the fingerprint of the chunk
+ */
+u64b square_fingerprint_mon(struct chunk *c, int y, int x)
+{
+	int m_idx = c->squares[y][x].mon;
+
+	if (m_idx < 0)
+		return fingerprint_mix(y, x, 1, 0);
+	if (m_idx > 0 && cave_monster(c, m_idx)->race)
+		return fingerprint_mix(y, x, 2, cave_monster(c, m_idx)->race->ridx);
+	return 0;
+}
+
+/**
+ * What an object lying at (y, x) adds to the fingerprint of its chunk
+ */
+u64b square_fingerprint_obj(int y, int x, const struct object *obj)
+{
+	return fingerprint_mix(y, x, 3, obj->kind->kidx);
+}
+
+/**
+ * What the pile at (y, x) adds to the fingerprint of the chunk
+ */
+u64b square_fingerprint_pile(struct chunk *c, int y, int x)
+{
+	struct object *obj;
+	u64b sum = 0;
+
+	for (obj = c->squares[y][x].obj; obj; obj = obj->next)
+		sum += square_fingerprint_obj(y, x, obj);
+	return sum;
+}
+
+/**
+ * What the grid at (y, x) adds to the fingerprint of the chunk
+ */
+u64b square_fingerprint(struct chunk *c, int y, int x)
+{
+	return square_fingerprint_feat(y, x, c->squares[y][x].feat) +
+		square_fingerprint_mon(c, y, x) + square_fingerprint_pile(c, y, x);
+}
+
+/**
+ * Work out the fingerprint of a chunk from scratch.
+ *
+ * The fingerprint is the sum of what each grid's feature, monster or player
+ * and floor objects (by kind) add to it, so it can be kept up by those that
+ * change one grid at a time without looking at the rest; square_set_feat(),
+ * place_monster(), floor_carry() and the like all do, so two levels can be
+ * told apart by comparing their fingerprint fields.  Grid flags, traps and
+ * the state of monsters and objects are left out.  It is only kept for the
+ * level itself, not the player's memory of it.
+ */
+u64b chunk_fingerprint(struct chunk *c)
+{
+	int y, x;
+	u64b sum = 0;
+
+	for (y = 0; y < c->height; y++)
+		for (x = 0; x < c->width; x++)
+			sum += square_fingerprint(c, y, x);
+	return sum;
+}
+
 void square_add_trap(struct chunk *c, int y, int x)
 {
 	assert(square_in_bounds_fully(c, y, x));
@@ -1134,6 +1327,15 @@ void square_force_floor(struct chunk *c, int y, int x) {
 	square_set_feat(c, y, x, FEAT_FLOOR);
 }
 
+/**
+ * Get the age of the player's scent at a grid; higher is older, and 0 means
+ * there is no scent
+ */
+int square_scent(struct chunk *c, int y, int x) {
+	u16b laid = c->scent.grids[y][x];
+	return laid ? c->scent_clock - laid : 0;
+}
+
 /* Note that this returns the STORE_ index, which is one less than shopnum */
 int square_shopnum(struct chunk *c, int y, int x) {
 	if (square_isshop(c, y, x))
@@ -1157,11 +1359,13 @@ const char *square_apparent_name(struct chunk *c, struct player *p, int y, int x
 void square_memorize(struct chunk *c, int y, int x) {
 	if (c != cave) return;
 	player->cave->squares[y][x].feat = c->squares[y][x].feat;
+	square_sync_projectable(player->cave, y, x);
 }
 
 void square_forget(struct chunk *c, int y, int x) {
 	if (c != cave) return;
 	player->cave->squares[y][x].feat = FEAT_NONE;
+	square_sync_projectable(player->cave, y, x);
 }
 
 void square_mark(struct chunk *c, int y, int x) {
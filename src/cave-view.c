@@ -20,30 +20,47 @@
 #include "cave.h"
 #include "cmds.h"
 #include "init.h"
+#include "mon-move.h"
+#include "mon-util.h"
 #include "monster.h"
 #include "player-calcs.h"
 #include "player-timed.h"
+#include "profile.h"
 #include "trap.h"
 
 /**
- * Approximate distance between two points.
- *
- * When either the X or Y component dwarfs the other component,
- * this function is almost perfect, and otherwise, it tends to
- * over-estimate about one grid per fifteen grids of distance.
- *
- * Algorithm: hypot(dy,dx) = max(dy,dx) + min(dy,dx) / 2
+ * Check a grid on a line of sight.  When both ends of the line are legal,
+ * every grid between them is too, and the projectable bitboard can be read
+ * directly.
  */
-int distance(int y1, int x1, int y2, int x2)
+static bool los_grid(struct chunk *c, bool safe, int y, int x)
 {
-	/* Find the absolute y/x distance components */
-	int ay = abs(y2 - y1);
-	int ax = abs(x2 - x1);
-
-	/* Approximate the distance */
-	return ay > ax ? ay + (ax >> 1) : ax + (ay >> 1);
+	if (!safe) return square_isprojectable(c, y, x);
+	return square_project_bit(c, y, x) ? true : false;
 }
 
+/**
+ * Check that every grid in row y from xa to xb (inclusive, both legal) is
+ * projectable, testing whole words of the projectable bitboard at once
+ */
+static bool los_row_clear(struct chunk *c, int y, int xa, int xb)
+{
+	const u32b *row = c->project_bits + y * c->project_stride;
+	int x = xa;
+
+	while (x <= xb) {
+		int w = x >> 5;
+		int first = x & 31;
+		int last = MIN(31, xb - (w << 5));
+		u32b mask = (last == 31 ? 0xFFFFFFFFUL : ((1UL << (last + 1)) - 1)) &
+			~((1UL << first) - 1);
+
+		if ((row[w] & mask) != mask) return false;
+		x = (w + 1) << 5;
+	}
+
+	return true;
+}
 
 /**
  * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
@@ -105,6 +122,10 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 	int m;
 
 
+	/* Grids between two legal grids are legal */
+	bool safe = square_in_bounds(c, y1, x1) && square_in_bounds(c, y2, x2);
+
+
 	/* Extract the offset */
 	dy = y2 - y1;
 	dx = x2 - x1;
@@ -123,29 +144,24 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* South -- check for walls */
 		if (dy > 0) {
 			for (ty = y1 + 1; ty < y2; ty++)
-				if (!square_isprojectable(c, ty, x1)) return (false);
+				if (!los_grid(c, safe, ty, x1)) return (false);
 		} else { /* North -- check for walls */
 			for (ty = y1 - 1; ty > y2; ty--)
-				if (!square_isprojectable(c, ty, x1)) return (false);
+				if (!los_grid(c, safe, ty, x1)) return (false);
 		}
 
 		/* Assume los */
 		return (true);
 	}
 
-	/* Directly East/West */
+	/* Directly East/West -- check for walls a word at a time */
 	if (!dy) {
-		/* East -- check for walls */
-		if (dx > 0) {
-			for (tx = x1 + 1; tx < x2; tx++)
-				if (!square_isprojectable(c, y1, tx)) return (false);
-		} else { /* West -- check for walls */
-			for (tx = x1 - 1; tx > x2; tx--)
+		if (!safe) {
+			for (tx = MIN(x1, x2) + 1; tx < MAX(x1, x2); tx++)
 				if (!square_isprojectable(c, y1, tx)) return (false);
+			return (true);
 		}
-
-		/* Assume los */
-		return (true);
+		return los_row_clear(c, y1, MIN(x1, x2) + 1, MAX(x1, x2) - 1);
 	}
 
 
@@ -154,11 +170,11 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 	sy = (dy < 0) ? -1 : 1;
 
 	/* Vertical "knights" */
-	if ((ax == 1) && (ay == 2) && square_isprojectable(c, y1 + sy, x1))
+	if ((ax == 1) && (ay == 2) && los_grid(c, safe, y1 + sy, x1))
 		return (true);
 	
 	/* Horizontal "knights" */
-	else if ((ay == 1) && (ax == 2) && square_isprojectable(c, y1, x1 + sx))
+	else if ((ay == 1) && (ax == 2) && los_grid(c, safe, y1, x1 + sx))
 		return (true);
 
 	/* Calculate scale factor div 2 */
@@ -187,7 +203,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* Note (below) the case (qy == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (x2 - tx) {
-			if (!square_isprojectable(c, ty, tx))
+			if (!los_grid(c, safe, ty, tx))
 				return (false);
 
 			qy += m;
@@ -196,7 +212,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 				tx += sx;
 			} else if (qy > f2) {
 				ty += sy;
-				if (!square_isprojectable(c, ty, tx))
+				if (!los_grid(c, safe, ty, tx))
 					return (false);
 				qy -= f1;
 				tx += sx;
@@ -223,7 +239,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 		/* Note (below) the case (qx == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
 		while (y2 - ty) {
-			if (!square_isprojectable(c, ty, tx))
+			if (!los_grid(c, safe, ty, tx))
 				return (false);
 
 			qx += m;
@@ -232,7 +248,7 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 				ty += sy;
 			} else if (qx > f2) {
 				tx += sx;
-				if (!square_isprojectable(c, ty, tx))
+				if (!los_grid(c, safe, ty, tx))
 					return (false);
 				qx -= f1;
 				ty += sy;
@@ -336,10 +352,12 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
  * for a grid which has "SQUARE_VIEW" set.
  *
  * The "SQUARE_WASSEEN" flag is used for a variety of temporary purposes.  This
- * flag is used to determine if the "SQUARE_SEEN" flag for a grid has changed
- * during the "update_view()" function.  This flag is used to "spread" light
- * or darkness through a room.  This flag is used by the "monster flow code".
- * This flag must always be cleared by any code which sets it.
+ * flag is used to "spread" light or darkness through a room.  This flag is
+ * used by the "monster flow code".  This flag must always be cleared by any
+ * code which sets it.  The "update_view()" function no longer uses it to see
+ * which grids changed; it keeps the grids in view in the "view_bits" bitboard
+ * of the chunk, and those seen before the update in "seen_bits", so that it
+ * only ever visits grids in the old or the new view.
  *
  * The "update_view()" function is an extremely important function.  It is
  * called only when the player moves, significant terrain changes, or the
@@ -429,18 +447,71 @@ bool los(struct chunk *c, int y1, int x1, int y2, int x2)
 
 
 /**
- * Mark the currently seen grids, then wipe in preparation for recalculating
+ * Find the rectangle of grids that a view calculation centred on `grid`
+ * can have touched; an unknown centre gives the whole chunk
  */
-static void mark_wasseen(struct chunk *c)
+static void view_window(struct chunk *c, struct loc grid, struct loc *tl,
+						struct loc *br)
 {
-	int x, y;
-	/* Save the old "view" grids for later */
-	for (y = 0; y < c->height; y++) {
-		for (x = 0; x < c->width; x++) {
-			if (square_isseen(c, y, x))
-				sqinfo_on(c->squares[y][x].info, SQUARE_WASSEEN);
-			sqinfo_off(c->squares[y][x].info, SQUARE_VIEW);
-			sqinfo_off(c->squares[y][x].info, SQUARE_SEEN);
+	if (grid.x < 0 || grid.y < 0) {
+		*tl = loc(0, 0);
+		*br = loc(c->width - 1, c->height - 1);
+		return;
+	}
+
+	tl->x = MAX(grid.x - z_info->max_sight, 0);
+	tl->y = MAX(grid.y - z_info->max_sight, 0);
+	br->x = MIN(grid.x + z_info->max_sight, c->width - 1);
+	br->y = MIN(grid.y + z_info->max_sight, c->height - 1);
+}
+
+/**
+ * Add a grid to the view, in its flags and in c->view_bits
+ */
+static void view_on(struct chunk *c, int y, int x)
+{
+	sqinfo_on(c->squares[y][x].info, SQUARE_VIEW);
+	c->view_bits[y * c->project_stride + (x >> 5)] |= 1UL << (x & 31);
+}
+
+/**
+ * Note which grids of the old view are seen in c->seen_bits, then wipe the
+ * view ready for recalculating.  Only the grids set in c->view_bits need
+ * looking at, unless the view has been forgotten, when the flags may have
+ * come from anywhere and the whole rectangle is gone over.
+ */
+static void mark_wasseen(struct chunk *c, struct loc tl, struct loc br,
+						 bool forgotten)
+{
+	int x, y, w;
+
+	for (y = tl.y; y <= br.y; y++) {
+		u32b *view = c->view_bits + y * c->project_stride;
+		u32b *seen = c->seen_bits + y * c->project_stride;
+
+		if (forgotten) {
+			for (x = tl.x; x <= br.x; x++) {
+				if (square_isseen(c, y, x))
+					seen[x >> 5] |= 1UL << (x & 31);
+				sqinfo_off(c->squares[y][x].info, SQUARE_VIEW);
+				sqinfo_off(c->squares[y][x].info, SQUARE_SEEN);
+			}
+			for (w = tl.x >> 5; w <= br.x >> 5; w++)
+				view[w] = 0;
+			continue;
+		}
+
+		for (w = tl.x >> 5; w <= br.x >> 5; w++) {
+			u32b bits = view[w];
+
+			for (x = w << 5; bits; x++, bits >>= 1) {
+				if (!(bits & 1)) continue;
+				if (square_isseen(c, y, x))
+					seen[w] |= 1UL << (x & 31);
+				sqinfo_off(c->squares[y][x].info, SQUARE_VIEW);
+				sqinfo_off(c->squares[y][x].info, SQUARE_SEEN);
+			}
+			view[w] = 0;
 		}
 	}
 }
@@ -449,18 +520,19 @@ static void mark_wasseen(struct chunk *c)
  */
 static void add_monster_lights(struct chunk *c, struct loc from)
 {
-	int i, j, k;
+	int i, j, k, n;
+	int r = z_info->max_sight + 1;
+	s16b *found = mem_zalloc(cave_monster_max(c) * sizeof(s16b));
 
-	/* Scan monster list and add monster lights */
-	for (k = 1; k < cave_monster_max(c); k++) {
-		/* Check the k'th monster */
-		struct monster *m = cave_monster(c, k);
+	/* Only monsters near enough to light a grid in range can matter */
+	n = monsters_in_rect(c, from.y - r, from.x - r, from.y + r, from.x + r,
+						 found);
 
-		bool in_los = los(c, from.y, from.x, m->fy, m->fx);
+	/* Add monster lights */
+	for (k = 0; k < n; k++) {
+		struct monster *m = cave_monster(c, found[k]);
 
-		/* Skip dead monsters */
-		if (!m->race)
-			continue;
+		bool in_los = los(c, from.y, from.x, m->fy, m->fx);
 
 		/* Skip monsters not carrying light */
 		if (!rf_has(m->race->flags, RF_HAS_LIGHT))
@@ -485,16 +557,19 @@ static void add_monster_lights(struct chunk *c, struct loc from)
 					continue;
 
 				/* Mark the square lit and seen */
-				sqinfo_on(c->squares[sy][sx].info, SQUARE_VIEW);
+				view_on(c, sy, sx);
 				sqinfo_on(c->squares[sy][sx].info, SQUARE_SEEN);
 			}
 	}
+
+	mem_free(found);
 }
 
 /**
- * Update view for a single square
+ * Update view for a single square, which was seen before the update if
+ * `was` is set
  */
-static void update_one(struct chunk *c, int y, int x, int blind)
+static void update_one(struct chunk *c, int y, int x, int blind, bool was)
 {
 
 	/* Remove view if blind, check visible squares for traps */
@@ -505,7 +580,7 @@ static void update_one(struct chunk *c, int y, int x, int blind)
 	}
 
 	/* Square went from unseen -> seen */
-	if (square_isseen(c, y, x) && !square_wasseen(c, y, x)) {
+	if (square_isseen(c, y, x) && !was) {
 		if (square_isfeel(c, y, x)) {
 			c->feeling_squares++;
 			sqinfo_off(c->squares[y][x].info, SQUARE_FEEL);
@@ -522,10 +597,8 @@ static void update_one(struct chunk *c, int y, int x, int blind)
 	}
 
 	/* Square went from seen -> unseen */
-	if (!square_isseen(c, y, x) && square_wasseen(c, y, x))
+	if (!square_isseen(c, y, x) && was)
 		square_light_spot(c, y, x);
-
-	sqinfo_off(c->squares[y][x].info, SQUARE_WASSEEN);
 }
 
 /**
@@ -538,7 +611,7 @@ static void become_viewable(struct chunk *c, int y, int x, int lit, int py, int
 	if (square_isview(c, y, x))
 		return;
 
-	sqinfo_on(c->squares[y][x].info, SQUARE_VIEW);
+	view_on(c, y, x);
 
 	if (lit)
 		sqinfo_on(c->squares[y][x].info, SQUARE_SEEN);
@@ -557,28 +630,15 @@ static void become_viewable(struct chunk *c, int y, int x, int lit, int py, int
 }
 
 /**
- * Decide whether to include a square in the current view
+ * Decide whether a square is in the player's line of sight for the purposes
+ * of the view.  This depends only on the terrain, so the result can be kept
+ * in c->view_los until the terrain near the player changes.
  */
-static void update_view_one(struct chunk *c, int y, int x, int radius, int py, int px)
+static bool view_los_one(struct chunk *c, int y, int x, int py, int px)
 {
-	int dir;
 	int xc = x;
 	int yc = y;
 
-	int d = distance(y, x, py, px);
-	int lit = d < radius;
-
-	if (d > z_info->max_sight)
-		return;
-
-	/* Light squares with adjacent bright terrain */
-	for (dir = 0; dir < 8; dir++) {
-		if (!square_in_bounds(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
-			continue;
-		if (square_isbright(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
-			lit = true;
-	}
-
 	/* Special case for wall lighting. If we are a wall and the square in
 	 * the direction of the player is in LOS, we are in LOS. This avoids
 	 * situations like:
@@ -625,21 +685,237 @@ static void update_view_one(struct chunk *c, int y, int x, int radius, int py, i
 		}
 	}
 
+	return los(c, py, px, yc, xc);
+}
 
-	if (los(c, py, px, yc, xc))
-		become_viewable(c, y, x, lit, py, px);
+/**
+ * Find which octants around the view origin an offset lies in.  Grids on
+ * the diagonals and axes belong to more than one octant.
+ */
+static byte view_octants(int dy, int dx)
+{
+	int ax = ABS(dx), ay = ABS(dy);
+	byte mask = 0;
+	int oct;
+
+	for (oct = 0; oct < 8; oct++) {
+		int sx = (oct & 1) ? -1 : 1;
+		int sy = (oct & 2) ? -1 : 1;
+		bool x_major = (oct & 4) ? true : false;
+
+		if (dx * sx < 0 || dy * sy < 0) continue;
+		if (x_major ? (ax < ay) : (ay < ax)) continue;
+		mask |= (1 << oct);
+	}
+
+	return mask;
+}
+
+/**
+ * Get the stored view LOS for a grid near the view origin
+ */
+static bool *view_los_grid(struct chunk *c, int dy, int dx)
+{
+	int side = 2 * z_info->max_sight + 1;
+	return &c->view_los[(dy + z_info->max_sight) * side +
+						dx + z_info->max_sight];
+}
+
+/**
+ * Decide whether to include a square in the current view, recalculating
+ * its line of sight only if it lies in an octant with changed terrain
+ */
+static void update_view_one(struct chunk *c, int y, int x, int radius, int py, int px)
+{
+	int dir;
+	bool *in_los;
+
+	int d = distance(y, x, py, px);
+	int lit = d < radius;
+
+	if (d > z_info->max_sight)
+		return;
+
+	in_los = view_los_grid(c, y - py, x - px);
+	if (view_octants(y - py, x - px) & c->view_dirty)
+		*in_los = view_los_one(c, y, x, py, px);
+
+	if (!*in_los)
+		return;
+
+	/* Light squares with adjacent bright terrain */
+	for (dir = 0; dir < 8; dir++) {
+		if (!square_in_bounds(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
+			continue;
+		if (square_isbright(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
+			lit = true;
+	}
+
+	become_viewable(c, y, x, lit, py, px);
+}
+
+/**
+ * Note that the grid at (y, x) has changed between blocking and not blocking
+ * LOS, so any stored view LOS which could depend on it is out of date.
+ *
+ * A grid affects LOS to targets in its own octants, and through the wall
+ * lighting and knight's move rules also to targets a grid or two aside, so
+ * the octants of all grids within two of it are marked.
+ */
+void square_note_opacity(struct chunk *c, int y, int x)
+{
+	int dy, dx;
+	struct loc origin = c->view_origin;
+
+	if (c->view_dirty == 0xFF) return;
+	if (ABS(y - origin.y) > z_info->max_sight + 2) return;
+	if (ABS(x - origin.x) > z_info->max_sight + 2) return;
+
+	for (dy = -2; dy <= 2; dy++)
+		for (dx = -2; dx <= 2; dx++)
+			c->view_dirty |= view_octants(y + dy - origin.y,
+										  x + dx - origin.x);
+}
+
+/**
+ * Find the rectangle holding every grid marked as in view by the last call
+ * to update_view(); it is the whole chunk if the view has been forgotten
+ */
+void view_bounds(struct chunk *c, struct loc *tl, struct loc *br)
+{
+	view_window(c, c->view_origin, tl, br);
+}
+
+/**
+ * Forget everything stored about the current view, so the next call to
+ * update_view() starts from scratch over the whole chunk
+ */
+void forget_view(struct chunk *c)
+{
+	c->view_origin = loc(-1, -1);
+	c->view_dirty = 0xFF;
+}
+
+/**
+ * Octant transforms for shadowcasting, as multipliers taking (column, row)
+ * offsets within an octant to (x, y) offsets on the map
+ */
+static const int octant_xx[8] = { 1,  0,  0, -1, -1,  0,  0,  1 };
+static const int octant_xy[8] = { 0,  1, -1,  0,  0, -1,  1,  0 };
+static const int octant_yx[8] = { 0,  1,  1,  0,  0, -1, -1,  0 };
+static const int octant_yy[8] = { 1,  0,  0,  1, -1,  0,  0, -1 };
+
+/**
+ * Decide whether a square found by shadowcasting is lit, and add it to the
+ * view.  Walls need none of the LOS stealing of update_view_one(), because
+ * shadowcasting reaches the first blocking grid in every direction.
+ */
+static void shadow_view_one(struct chunk *c, int y, int x, int radius,
+							int py, int px)
+{
+	int dir;
+	int lit = distance(y, x, py, px) < radius;
+
+	/* Light squares with adjacent bright terrain */
+	for (dir = 0; dir < 8 && !lit; dir++) {
+		if (!square_in_bounds(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
+			continue;
+		if (square_isbright(c, y + ddy_ddd[dir], x + ddx_ddd[dir]))
+			lit = true;
+	}
+
+	become_viewable(c, y, x, lit, py, px);
+}
+
+/**
+ * Recursive shadowcasting of one octant, from `row` outwards, between the
+ * slopes `start` and `end`.
+ *
+ * Only grids within z_info->max_sight of the player are ever visited, so
+ * the cost is bounded by the sight radius rather than the level size.
+ */
+static void cast_view(struct chunk *c, int radius, int py, int px, int row,
+					  double start, double end, int oct)
+{
+	int j;
+	double new_start = 0.0;
+
+	if (start < end) return;
+
+	for (j = row; j <= z_info->max_sight; j++) {
+		int dy = -j;
+		int dx = -j - 1;
+		bool blocked = false;
+
+		while (dx <= 0) {
+			double l_slope, r_slope;
+			int x, y;
+
+			dx++;
+			x = px + dx * octant_xx[oct] + dy * octant_xy[oct];
+			y = py + dx * octant_yx[oct] + dy * octant_yy[oct];
+			l_slope = (dx - 0.5) / (dy + 0.5);
+			r_slope = (dx + 0.5) / (dy - 0.5);
+
+			if (start < r_slope) continue;
+			if (end > l_slope) break;
+
+			/* Off the map counts as solid rock */
+			if (!square_in_bounds(c, y, x)) {
+				if (!blocked) {
+					blocked = true;
+					cast_view(c, radius, py, px, j + 1, start, l_slope, oct);
+				}
+				new_start = r_slope;
+				continue;
+			}
+
+			if (distance(y, x, py, px) <= z_info->max_sight)
+				shadow_view_one(c, y, x, radius, py, px);
+
+			if (blocked) {
+				if (!square_isprojectable(c, y, x)) {
+					new_start = r_slope;
+					continue;
+				}
+				blocked = false;
+				start = new_start;
+			} else if (!square_isprojectable(c, y, x) &&
+					   j < z_info->max_sight) {
+				blocked = true;
+				cast_view(c, radius, py, px, j + 1, start, l_slope, oct);
+				new_start = r_slope;
+			}
+		}
+
+		if (blocked) break;
+	}
 }
 
 /**
  * Update the player's current view
+ *
+ * Only the grids within z_info->max_sight of the player, and those which
+ * were in view after the last update, are visited.  The view itself is found
+ * either by tracing LOS to every grid in range, or by shadowcasting if the
+ * view_shadowcast option is set.  Traced LOS is kept between calls, and only
+ * retraced in octants where square_note_opacity() has seen terrain change,
+ * or everywhere if the player has moved.
  */
 void update_view(struct chunk *c, struct player *p)
 {
-	int x, y;
+	struct loc grid = loc(p->px, p->py);
+	struct loc old_tl, old_br, tl, br;
+	int x, y, oct;
 
 	int radius;
 
-	mark_wasseen(c);
+	PROFILE_ENTER(PROF_VIEW);
+
+	view_window(c, c->view_origin, &old_tl, &old_br);
+	view_window(c, grid, &tl, &br);
+
+	mark_wasseen(c, old_tl, old_br, c->view_origin.x < 0);
 
 	/* Extract "radius" value */
 	radius = p->state.cur_light;
@@ -647,22 +923,65 @@ void update_view(struct chunk *c, struct player *p)
 	/* Handle real light */
 	if (radius > 0) ++radius;
 
-	add_monster_lights(c, loc(p->px, p->py));
+	add_monster_lights(c, grid);
 
 	/* Assume we can view the player grid */
-	sqinfo_on(c->squares[p->py][p->px].info, SQUARE_VIEW);
+	view_on(c, p->py, p->px);
 	if (radius > 0 || square_isglow(c, p->py, p->px))
 		sqinfo_on(c->squares[p->py][p->px].info, SQUARE_SEEN);
 
 	/* View squares we have LOS to */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
-			update_view_one(c, y, x, radius, p->py, p->px);
-
-	/* Complete the algorithm */
-	for (y = 0; y < c->height; y++)
-		for (x = 0; x < c->width; x++)
-			update_one(c, y, x, p->timed[TMD_BLIND]);
+	if (OPT(p, view_shadowcast)) {
+		for (oct = 0; oct < 8; oct++)
+			cast_view(c, radius, p->py, p->px, 1, 1.0, 0.0, oct);
+		c->view_dirty = 0xFF;
+	} else {
+		/* Stored LOS is only good for the grid it was calculated from */
+		if (!c->view_los) {
+			int side = 2 * z_info->max_sight + 1;
+			c->view_los = chunk_alloc(c, side * side * sizeof(bool));
+			c->view_dirty = 0xFF;
+		}
+		if (grid.x != c->view_origin.x || grid.y != c->view_origin.y)
+			c->view_dirty = 0xFF;
+
+		for (y = tl.y; y <= br.y; y++)
+			for (x = tl.x; x <= br.x; x++)
+				update_view_one(c, y, x, radius, p->py, p->px);
+		c->view_dirty = 0;
+	}
+
+	/* Complete the algorithm over the grids in the old or the new view,
+	 * in the same order as a walk over the rectangle holding both */
+	tl = loc(MIN(tl.x, old_tl.x), MIN(tl.y, old_tl.y));
+	br = loc(MAX(br.x, old_br.x), MAX(br.y, old_br.y));
+	for (y = tl.y; y <= br.y; y++) {
+		u32b *view = c->view_bits + y * c->project_stride;
+		u32b *seen = c->seen_bits + y * c->project_stride;
+		int w;
+
+		for (w = tl.x >> 5; w <= br.x >> 5; w++) {
+			u32b bits = view[w] | seen[w];
+
+			for (x = w << 5; bits; x++, bits >>= 1) {
+				if (!(bits & 1)) continue;
+				update_one(c, y, x, p->timed[TMD_BLIND],
+						   (seen[w] >> (x & 31)) & 1);
+
+				/* Dormant monsters notice coming into view */
+				if (square_isview(c, y, x))
+					rouse_monster_at(c, y, x);
+			}
+			seen[w] = 0;
+		}
+	}
+
+	/* Monsters in either view may now be seen differently */
+	note_monster_views(c, tl.y, tl.x, br.y, br.x);
+
+	c->view_origin = grid;
+
+	PROFILE_LEAVE(PROF_VIEW);
 }
 
 
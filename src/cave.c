@@ -31,8 +31,10 @@
 #include "object.h"
 #include "player-timed.h"
 #include "trap.h"
+#include "z-index.h"
 
 struct feature *f_info;
+byte *f_caps;
 struct chunk *cave = NULL;
 
 int FEAT_NONE;
@@ -243,6 +245,12 @@ const byte side_dirs[20][8] = {
 	{9, 8, 6, 7, 3, 4, 2, 1}
 };
 
+/**
+ * Index of feature names, for the f_info it was built from
+ */
+static struct name_index *feat_names;
+static struct feature *feat_names_info;
+
 /**
  * Find a terrain feature index by name
  */
@@ -250,27 +258,42 @@ int lookup_feat(const char *name)
 {
 	int i;
 
-	/* Look for it */
-	for (i = 0; i < z_info->f_max; i++) {
-		struct feature *feat = &f_info[i];
-		if (!feat->name)
-			continue;
-
-		/* Test for equality */
-		if (streq(name, feat->name))
-			return i;
+	/* Index the features the first time; the map looks up mimics often */
+	if (feat_names_info != f_info) {
+		name_index_free(feat_names);
+		feat_names = name_index_new(z_info->f_max, false);
+		for (i = 0; i < z_info->f_max; i++)
+			name_index_add(feat_names, f_info[i].name, i);
+		feat_names_info = f_info;
 	}
 
+	/* Look for it */
+	i = name_index_find(feat_names, name);
+	if (i >= 0)
+		return i;
+
 	/* Fail horribly */
 	quit_fmt("Failed to find terrain feature %s", name);
 	return -1;
 }
 
+/**
+ * Forget the feature name index, as f_info is going away.
+ */
+void lookup_feat_forget(void)
+{
+	name_index_free(feat_names);
+	feat_names = NULL;
+	feat_names_info = NULL;
+}
+
 /**
  * Set terrain constants to the indices from terrain.txt
  */
 void set_terrain(void)
 {
+	int i;
+
 	FEAT_NONE = lookup_feat("unknown grid");
 	FEAT_FLOOR = lookup_feat("open floor");
 	FEAT_CLOSED = lookup_feat("closed door");
@@ -288,42 +311,117 @@ void set_terrain(void)
 	FEAT_GRANITE = lookup_feat("granite wall");
 	FEAT_PERM = lookup_feat("permanent wall");
 	FEAT_LAVA = lookup_feat("lava");
+
+	/* Build the capability table */
+	mem_free(f_caps);
+	f_caps = mem_zalloc(z_info->f_max * sizeof(byte));
+	for (i = 0; i < z_info->f_max; i++) {
+		bitflag *flags = f_info[i].flags;
+
+		if (tf_has(flags, TF_PASSABLE)) f_caps[i] |= FCAP_PASSABLE;
+		if (tf_has(flags, TF_PROJECT)) f_caps[i] |= FCAP_PROJECT;
+		if (tf_has(flags, TF_WALL)) f_caps[i] |= FCAP_WALL;
+		if (tf_has(flags, TF_BRIGHT)) f_caps[i] |= FCAP_BRIGHT;
+		if (tf_has(flags, TF_TORCH)) f_caps[i] |= FCAP_TORCH;
+		if (tf_has(flags, TF_FIERY)) f_caps[i] |= FCAP_FIERY;
+		if (tf_has(flags, TF_NO_FLOW)) f_caps[i] |= FCAP_NO_FLOW;
+		if (tf_has(flags, TF_NO_SCENT)) f_caps[i] |= FCAP_NO_SCENT;
+	}
 }
 
 /**
- * Allocate a new chunk of the world
+ * Allocate zeroed memory which lasts as long as a chunk, and is freed with
+ * it by cave_free()
  */
-struct chunk *cave_new(int height, int width) {
-	int y, x;
+void *chunk_alloc(struct chunk *c, size_t len)
+{
+	return mem_arena_alloc(c->arena, len);
+}
+
+/**
+ * Give back memory from chunk_alloc() before the chunk itself goes; `len`
+ * must be the length it was allocated with
+ */
+void chunk_release(struct chunk *c, void *p, size_t len)
+{
+	mem_arena_release(c->arena, p, len);
+}
+
+/**
+ * Allocate a chunk; `level` chunks also get the noise and scent maps and the
+ * monster list, which a record of the player's knowledge never uses.
+ */
+static struct chunk *chunk_new(int height, int width, bool level) {
+	int y;
+	struct square *grids;
+	u16b *noise = NULL, *scent = NULL;
+	int tag = mem_tag_set(MEM_TAG_CAVE);
 
 	struct chunk *c = mem_zalloc(sizeof *c);
 	c->height = height;
 	c->width = width;
-	c->feat_count = mem_zalloc((z_info->f_max + 1) * sizeof(int));
 
-	c->squares = mem_zalloc(c->height * sizeof(struct square*));
-	c->noise.grids = mem_zalloc(c->height * sizeof(u16b*));
-	c->scent.grids = mem_zalloc(c->height * sizeof(u16b*));
+	/* Everything which lasts as long as the chunk comes from its arena */
+	c->arena = mem_arena_new(CHUNK_ARENA_BLOCK);
+	c->feat_count = chunk_alloc(c, (z_info->f_max + 1) * sizeof(int));
+
+	/* Each grid array is one block, with row pointers into it */
+	c->squares = chunk_alloc(c, c->height * sizeof(struct square*));
+	grids = chunk_alloc(c, c->height * c->width * sizeof(struct square));
+	if (level) {
+		c->noise.grids = chunk_alloc(c, c->height * sizeof(u16b*));
+		c->scent.grids = chunk_alloc(c, c->height * sizeof(u16b*));
+		noise = chunk_alloc(c, c->height * c->width * sizeof(u16b));
+		scent = chunk_alloc(c, c->height * c->width * sizeof(u16b));
+	}
+	c->project_stride = (c->width + 31) / 32;
+	c->project_bits = chunk_alloc(c, c->height * c->project_stride *
+								  sizeof(u32b));
+	c->pile_stamps = chunk_alloc(c, c->height * c->width * sizeof(u32b));
+	c->view_bits = chunk_alloc(c, c->height * c->project_stride *
+							   sizeof(u32b));
+	c->seen_bits = chunk_alloc(c, c->height * c->project_stride *
+							   sizeof(u32b));
 	for (y = 0; y < c->height; y++) {
-		c->squares[y] = mem_zalloc(c->width * sizeof(struct square));
-		for (x = 0; x < c->width; x++) {
-			c->squares[y][x].info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-		}
-		c->noise.grids[y] = mem_zalloc(c->width * sizeof(u16b));
-		c->scent.grids[y] = mem_zalloc(c->width * sizeof(u16b));
+		c->squares[y] = grids + y * c->width;
+		if (!level) continue;
+		c->noise.grids[y] = noise + y * c->width;
+		c->scent.grids[y] = scent + y * c->width;
 	}
 
 	c->objects = mem_zalloc(OBJECT_LIST_SIZE * sizeof(struct object*));
 	c->obj_max = OBJECT_LIST_SIZE - 1;
 
-	c->monsters = mem_zalloc(z_info->level_monster_max *sizeof(struct monster));
+	if (level)
+		c->monsters = chunk_alloc(c, z_info->level_monster_max *
+								  sizeof(struct monster));
 	c->mon_max = 1;
 	c->mon_current = -1;
 
+	forget_view(c);
+	c->noise_origin = loc(-1, -1);
+	c->scent_clock = SCENT_CLOCK_MIN;
+
 	c->created_at = turn;
+
+	mem_tag_set(tag);
 	return c;
 }
 
+/**
+ * Allocate a new chunk of the world
+ */
+struct chunk *cave_new(int height, int width) {
+	return chunk_new(height, width, true);
+}
+
+/**
+ * Allocate a new chunk to hold the player's knowledge of a level
+ */
+struct chunk *known_cave_new(int height, int width) {
+	return chunk_new(height, width, false);
+}
+
 /**
  * Free a chunk
  */
@@ -332,52 +430,102 @@ void cave_free(struct chunk *c) {
 
 	for (y = 0; y < c->height; y++) {
 		for (x = 0; x < c->width; x++) {
-			mem_free(c->squares[y][x].info);
 			if (c->squares[y][x].trap)
 				square_free_trap(c, y, x);
 			if (c->squares[y][x].obj)
 				object_pile_free(c->squares[y][x].obj);
 		}
-		mem_free(c->squares[y]);
-		mem_free(c->noise.grids[y]);
-		mem_free(c->scent.grids[y]);
 	}
-	mem_free(c->squares);
-	mem_free(c->noise.grids);
-	mem_free(c->scent.grids);
-
-	mem_free(c->feat_count);
+	if (c->noise_opened)
+		point_set_dispose(c->noise_opened);
+	mem_free(c->empty_grids);
+	mem_free(c->empty_slots);
 	mem_free(c->objects);
-	mem_free(c->monsters);
+	mem_free(c->obj_slots);
 	if (c->name)
 		string_free(c->name);
+	mem_arena_free(c->arena);
 	mem_free(c);
 }
 
 
+/**
+ * Whether a slot of a chunk's object list is in use.  A slot of the current
+ * level's list stays in use while the player's memory of an object is listed
+ * there, as the two lists share their indices.
+ */
+static bool object_slot_in_use(struct chunk *c, int i)
+{
+	if (c->objects[i]) return true;
+	return (c == cave) && player->cave && player->cave->objects[i];
+}
+
+/**
+ * Make the slot bitmap of a chunk cover the whole object list
+ */
+static void object_slots_fit(struct chunk *c)
+{
+	int words = (c->obj_max + 31) / 32;
+
+	if (words <= c->obj_slot_words) return;
+	c->obj_slots = mem_realloc(c->obj_slots, words * sizeof(u32b));
+	memset(c->obj_slots + c->obj_slot_words, 0,
+		   (words - c->obj_slot_words) * sizeof(u32b));
+
+	/* Slot 0 is never used */
+	if (!c->obj_slot_words) c->obj_slots[0] = 1;
+	c->obj_slot_words = words;
+}
+
+/**
+ * Note that a slot of a chunk's object list may have been given up.
+ *
+ * A set bit in obj_slots means the slot is in use, so every place that
+ * empties a slot has to come through here; a clear bit only means the slot
+ * is worth checking, so filling one without setting its bit is harmless.
+ */
+void object_slot_release(struct chunk *c, int oidx)
+{
+	if (!c) return;
+	if (oidx < c->obj_slot_words * 32)
+		c->obj_slots[oidx / 32] &= ~(1UL << (oidx % 32));
+
+	/* A slot of the known list is one of the level's list too */
+	if (player && (c == player->cave) && cave && (cave != c))
+		object_slot_release(cave, oidx);
+}
+
 /**
  * Enter an object in the list of objects for the current level/chunk.  This
- * function is robust against listing of duplicates or non-objects
+ * function is robust against listing of duplicates or non-objects.
+ *
+ * The object goes in the lowest free slot, found through obj_slots a word
+ * at a time; if there is none, the list grows by half again.
  */
 void list_object(struct chunk *c, struct object *obj)
 {
-	int i, newsize;
+	int i, w, incr, newsize;
 
-	/* Check for duplicates and objects already deleted or combined */
+	/* Check for duplicates and objects already deleted or combined; a listed
+	 * object always sits at its own oidx */
 	if (!obj) return;
-	for (i = 1; i < c->obj_max; i++)
-		if (c->objects[i] == obj)
-			return;
+	if (obj->oidx > 0 && obj->oidx < c->obj_max && c->objects[obj->oidx] == obj)
+		return;
 
 	/* Put objects in holes in the object list */
-	for (i = 1; i < c->obj_max; i++) {
-		/* If there is a known object, skip this slot */
-		if ((c == cave) && player->cave && player->cave->objects[i]) {
-			continue;
-		}
+	object_slots_fit(c);
+	for (w = 0; w < c->obj_slot_words; w++) {
+		while (c->obj_slots[w] != 0xFFFFFFFFUL) {
+			u32b bit = ~c->obj_slots[w] & (c->obj_slots[w] + 1);
+
+			for (i = w * 32; !(bit & (1UL << (i % 32))); i++) ;
+			if (i >= c->obj_max) break;
+			c->obj_slots[w] |= bit;
 
-		/* Put the object in a hole */
-		if (c->objects[i] == NULL) {
+			/* Skip slots in use that weren't marked yet */
+			if (object_slot_in_use(c, i)) continue;
+
+			/* Put the object in a hole */
 			c->objects[i] = obj;
 			obj->oidx = i;
 			return;
@@ -385,13 +533,18 @@ void list_object(struct chunk *c, struct object *obj)
 	}
 
 	/* Extend the list */
-	newsize = (c->obj_max + OBJECT_LIST_INCR + 1) * sizeof(struct object*);
+	incr = MAX(OBJECT_LIST_INCR, c->obj_max / 2);
+	incr = MIN(incr, 65535 - c->obj_max);
+	assert(incr > 0);
+	newsize = (c->obj_max + incr + 1) * sizeof(struct object*);
 	c->objects = mem_realloc(c->objects, newsize);
 	c->objects[c->obj_max] = obj;
 	obj->oidx = c->obj_max;
-	for (i = c->obj_max + 1; i <= c->obj_max + OBJECT_LIST_INCR; i++)
+	for (i = c->obj_max + 1; i <= c->obj_max + incr; i++)
 		c->objects[i] = NULL;
-	c->obj_max += OBJECT_LIST_INCR;
+	c->obj_max += incr;
+	object_slots_fit(c);
+	c->obj_slots[obj->oidx / 32] |= 1UL << (obj->oidx % 32);
 
 	/* If we're on the current level, extend the known list */
 	if ((c == cave) && player->cave) {
@@ -408,14 +561,17 @@ void list_object(struct chunk *c, struct object *obj)
  */
 void delist_object(struct chunk *c, struct object *obj)
 {
-	if (!obj->oidx) return;
-	assert(c->objects[obj->oidx] == obj);
+	int oidx = obj->oidx;
+
+	if (!oidx) return;
+	assert(c->objects[oidx] == obj);
 
 	/* Don't delist an actual object if it still has a listed known object */
-	if ((c == cave) && player->cave->objects[obj->oidx]) return;
+	if ((c == cave) && player->cave->objects[oidx]) return;
 
-	c->objects[obj->oidx] = NULL;
+	c->objects[oidx] = NULL;
 	obj->oidx = 0;
+	object_slot_release(c, oidx);
 }
 
 /**
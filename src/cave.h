@@ -114,6 +114,25 @@ struct feature {
 
 extern struct feature *f_info;
 
+/**
+ * Terrain capabilities, worked out from the terrain flags by set_terrain()
+ * so that the commonest feature predicates can test a single byte
+ */
+enum {
+	FCAP_PASSABLE  = 0x01,
+	FCAP_PROJECT   = 0x02,
+	FCAP_WALL      = 0x04,
+	FCAP_BRIGHT    = 0x08,
+	FCAP_TORCH     = 0x10,
+	FCAP_FIERY     = 0x20,
+	FCAP_NO_FLOW   = 0x40,
+	FCAP_NO_SCENT  = 0x80
+};
+
+extern byte *f_caps;
+
+#define feat_has_cap(feat, cap)    (f_caps[(feat)] & (cap))
+
 enum grid_light_level
 {
 	LIGHTING_LOS = 0,   /* line of sight */
@@ -138,9 +157,16 @@ struct grid_data {
 	bool hallucinate;
 };
 
+/**
+ * A single grid of a chunk.
+ *
+ * The grids of a chunk are held in one contiguous block, row by row, with
+ * the square flags stored inline; the fields most used by the square
+ * predicates come first.
+ */
 struct square {
 	byte feat;
-	bitflag *info;
+	bitflag info[SQUARE_SIZE];
 	s16b mon;
 	struct object *obj;
 	struct trap *trap;
@@ -150,8 +176,39 @@ struct heatmap {
     u16b **grids;
 };
 
+/**
+ * What the player could see with when monster visibility was last worked
+ * out; see update_monsters()
+ */
+struct monster_sight {
+	bool valid;
+	struct loc grid;		/* Player grid */
+	bool blind;
+	bool telepathy;
+	bool see_invis;
+	int see_infra;
+};
+
+/**
+ * Scent is stored as the scent clock reading it was laid at (less its initial
+ * strength), with 0 for no scent, so it ages without every grid being
+ * touched.  The clock is wound back to SCENT_CLOCK_MIN before it overflows.
+ */
+#define SCENT_CLOCK_MIN		0x1000
+#define SCENT_CLOCK_MAX		0xFFF0
+
+/**
+ * Size of the blocks a chunk's arena gets memory in
+ */
+#define CHUNK_ARENA_BLOCK	0x4000
+
+#define square_project_bit(c, y, x) \
+	((c)->project_bits[(y) * (c)->project_stride + ((x) >> 5)] & \
+	 (1UL << ((x) & 31)))
+
 struct chunk {
 	char *name;
+	struct mem_arena *arena;	/* Memory lasting as long as the chunk */
 	s32b created_at;
 	int depth;
 
@@ -165,18 +222,58 @@ struct chunk {
 
 	u16b feeling_squares; /* How many feeling squares the player has visited */
 	int *feat_count;
+	u64b fingerprint;	/* Sum of square_fingerprint() over the grids; see
+						 * chunk_fingerprint() */
 
 	struct square **squares;
+	u32b *project_bits;		/* Bit per grid, set if the grid is projectable */
+	int project_stride;		/* Words per row of project_bits */
 	struct heatmap noise;
-	struct heatmap scent;
+	struct heatmap scent;	/* Scent clock reading when each grid was scented */
+	u16b scent_clock;		/* Counts scent updates; see square_scent() */
+
+	int trap_timeouts;		/* Turns until all disabled traps are live again */
+
+	struct loc noise_origin;		/* Player grid the noise field is from */
+	struct point_set *noise_opened;	/* Grids opened to flow since then */
+
+	u32b *pile_stamps;		/* When each grid's pile last changed; see
+							 * square_pile_changed() */
+	u32b *view_bits;		/* Bit per grid in view, laid out as project_bits */
+	u32b *seen_bits;		/* Bit per grid seen before this view update */
+
+	struct loc view_origin;	/* Player grid at the last view update */
+	bool *view_los;			/* LOS from view_origin to grids in sight range */
+	byte view_dirty;		/* Octants of view_los which are out of date */
+
+	int *empty_grids;		/* Grids which may be empty; see find_empty() */
+	int *empty_slots;		/* Index + 1 of each grid in empty_grids, or 0 */
+	int empty_num;
 
 	struct object **objects;
 	u16b obj_max;
+	u32b *obj_slots;		/* Bit per objects[] slot known to be in use; see
+							 * list_object() */
+	int obj_slot_words;
 
 	struct monster *monsters;
 	u16b mon_max;
 	u16b mon_cnt;
 	int mon_current;
+	s16b *mon_blocks;		/* Monster lists by block of grids; see mon-util.c */
+	int mon_block_wid;		/* Blocks per row of mon_blocks */
+
+	bool mon_scheduled;		/* Monsters are in mon_wheel; see mon-move.c */
+	s16b *mon_wheel;		/* Monster lists by game turn they can next move */
+	s16b *mon_due;			/* Monsters which can move this turn, in order */
+	int mon_due_num;
+	s32b mon_due_turn;		/* Game turn mon_due was gathered for */
+	int mon_done_min;		/* Least energy of the passes done that turn */
+	int mon_scan;			/* Index the current pass has reached */
+	int mon_scan_min;		/* Least energy the current pass visits */
+	int mon_dormant;		/* Passive monsters taken out of mon_wheel */
+	int mon_dormant_stealth;	/* Player stealth they were passive with */
+	struct monster_sight mon_sight;	/* Sight monster visibility is up to */
 };
 
 /*** Feature Indexes (see "lib/gamedata/terrain.txt") ***/
@@ -217,9 +314,35 @@ extern struct chunk *cave;
 extern struct chunk **chunk_list;
 extern u16b chunk_list_max;
 
+/**
+ * Approximate distance between two points.
+ *
+ * When either the X or Y component dwarfs the other component,
+ * this function is almost perfect, and otherwise, it tends to
+ * over-estimate about one grid per fifteen grids of distance.
+ *
+ * Algorithm: hypot(dy,dx) = max(dy,dx) + min(dy,dx) / 2
+ *
+ * This is called for every grid of every view update and for every
+ * monster, so it lives here where it can be inlined; the min is found
+ * from the max so the compiler can do without branches.
+ */
+static inline int distance(int y1, int x1, int y2, int x2)
+{
+	/* Find the absolute y/x distance components */
+	int ay = abs(y2 - y1);
+	int ax = abs(x2 - x1);
+
+	/* Approximate the distance */
+	int big = ay > ax ? ay : ax;
+	return big + ((ay + ax - big) >> 1);
+}
+
 /* cave-view.c */
-int distance(int y1, int x1, int y2, int x2);
 bool los(struct chunk *c, int y1, int x1, int y2, int x2);
+void square_note_opacity(struct chunk *c, int y, int x);
+void view_bounds(struct chunk *c, struct loc *tl, struct loc *br);
+void forget_view(struct chunk *c);
 void update_view(struct chunk *c, struct player *p);
 bool no_light(void);
 
@@ -349,6 +472,16 @@ void square_sense_pile(struct chunk *c, int y, int x);
 void square_know_pile(struct chunk *c, int y, int x);
 
 void square_set_feat(struct chunk *c, int y, int x, int feat);
+void square_sync_projectable(struct chunk *c, int y, int x);
+void square_note_flow(struct chunk *c, int y, int x);
+void square_note_empty(struct chunk *c, int y, int x);
+void square_pile_changed(struct chunk *c, int y, int x);
+u64b square_fingerprint_feat(int y, int x, int feat);
+u64b square_fingerprint_mon(struct chunk *c, int y, int x);
+u64b square_fingerprint_obj(int y, int x, const struct object *obj);
+u64b square_fingerprint_pile(struct chunk *c, int y, int x);
+u64b square_fingerprint(struct chunk *c, int y, int x);
+u64b chunk_fingerprint(struct chunk *c);
 
 /* Feature placers */
 void square_add_trap(struct chunk *c, int y, int x);
@@ -376,6 +509,7 @@ void square_destroy_rubble(struct chunk *c, int y, int x);
 void square_force_floor(struct chunk *c, int y, int x);
 
 
+int square_scent(struct chunk *c, int y, int x);
 int square_shopnum(struct chunk *c, int y, int x);
 int square_digging(struct chunk *c, int y, int x);
 const char *square_apparent_name(struct chunk *c, struct player *p, int y, int x);
@@ -387,11 +521,16 @@ void square_unmark(struct chunk *c, int y, int x);
 
 /* cave.c */
 int lookup_feat(const char *name);
+void lookup_feat_forget(void);
 void set_terrain(void);
+void *chunk_alloc(struct chunk *c, size_t len);
+void chunk_release(struct chunk *c, void *p, size_t len);
 struct chunk *cave_new(int height, int width);
+struct chunk *known_cave_new(int height, int width);
 void cave_free(struct chunk *c);
 void list_object(struct chunk *c, struct object *obj);
 void delist_object(struct chunk *c, struct object *obj);
+void object_slot_release(struct chunk *c, int oidx);
 void object_lists_check_integrity(struct chunk *c, struct chunk *c_k);
 void scatter(struct chunk *c, int *yp, int *xp, int y, int x, int d, bool need_los);
 
@@ -402,6 +541,8 @@ int cave_monster_count(struct chunk *c);
 int count_feats(int *y, int *x, bool (*test)(struct chunk *cave, int y, int x), bool under);
 
 void cave_generate(struct chunk **c, struct player *p);
+bool cave_pregenerate(struct player *p, bool (*stop)(void));
+void cave_pregen_free(void);
 bool is_quest(int level);
 
 void cave_known(struct player *p);
@@ -1210,12 +1210,38 @@ void do_cmd_pathfind(struct command *cmd)
 		/* Calculate torch radius */
 		player->upkeep->update |= (PU_TORCH);
 		player->upkeep->running_withpathfind = true;
+		player->upkeep->running_explore = false;
 		run_step(0);
 	}
 }
 
 
 
+/**
+ * Explore the level, walking along the pathfinder's way to the nearest grid
+ * the player doesn't know until something disturbs them.
+ *
+ * Note that exploring while confused is not allowed.
+ */
+void do_cmd_explore(struct command *cmd)
+{
+	if (player->timed[TMD_CONFUSED])
+		return;
+
+	if (!findpath_explore()) {
+		msg("There is nowhere else to explore from here.");
+		return;
+	}
+
+	player->upkeep->running = 1000;
+	/* Calculate torch radius */
+	player->upkeep->update |= (PU_TORCH);
+	player->upkeep->running_withpathfind = true;
+	player->upkeep->running_explore = true;
+	run_step(0);
+}
+
+
 /**
  * Stay still.  Search.  Enter stores.
  * Pick up treasure if "pickup" is true.
@@ -20,6 +20,7 @@
 #include "angband.h"
 #include "cmds.h"
 #include "cmd-core.h"
+#include "cmd-record.h"
 #include "game-input.h"
 #include "obj-chest.h"
 #include "obj-desc.h"
@@ -29,6 +30,7 @@
 #include "player-birth.h"
 #include "player-calcs.h"
 #include "player-spell.h"
+#include "profile.h"
 #include "store.h"
 #include "target.h"
 
@@ -79,6 +81,7 @@ static const struct command_info game_cmds[] =
 	{ CMD_REST, "rest", do_cmd_rest, false, 0 },
 	{ CMD_SLEEP, "sleep", do_cmd_sleep, false, 0 },
 	{ CMD_PATHFIND, "walk", do_cmd_pathfind, false, 0 },
+	{ CMD_EXPLORE, "explore", do_cmd_explore, false, 0 },
 	{ CMD_PICKUP, "pickup", do_cmd_pickup, false, 0 },
 	{ CMD_AUTOPICKUP, "autopickup", do_cmd_autopickup, false, 0 },
 	{ CMD_WIELD, "wear or wield", do_cmd_wield, false, 0 },
@@ -139,54 +142,216 @@ static int cmd_idx(cmd_code code)
  * The command queue.
  * ------------------------------------------------------------------------ */
 
+/**
+ * The queue is a ring with one consumer (the game) and any number of
+ * producers: the game and front end pushing as they play, and perhaps a
+ * driver on a thread of its own.  Commands in [cmd_tail, cmd_head) are
+ * waiting; the slot just before cmd_tail holds the command being carried
+ * out, which is kept for repeats and so is never pushed over.
+ *
+ * A producer claims slots by moving cmd_claim on with a compare-and-swap,
+ * fills them in, and then publishes them by moving cmd_head up to the end
+ * of its claim, once any earlier claims have been published.  Only the
+ * consumer writes cmd_tail, so pushing and popping never wait for each
+ * other, and producers only wait for each other while a claim just before
+ * theirs is being copied in.
+ */
 #define CMD_QUEUE_SIZE 20
-#define prev_cmd_idx(idx) ((idx + CMD_QUEUE_SIZE - 1) % CMD_QUEUE_SIZE)
-
+#define next_cmd_idx(idx) (((idx) + 1) % cmd_queue_size)
+#define prev_cmd_idx(idx) (((idx) + cmd_queue_size - 1) % cmd_queue_size)
+
+#if defined(__GNUC__)
+# define cmdq_load(v) __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+# define cmdq_store(v, x) __atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
+# define cmdq_cas(v, old, x) \
+	__atomic_compare_exchange_n(&(v), &(old), (x), false, __ATOMIC_ACQ_REL, \
+								__ATOMIC_ACQUIRE)
+#else
+# define cmdq_load(v) (v)
+# define cmdq_store(v, x) ((v) = (x))
+# define cmdq_cas(v, old, x) ((v) == (old) ? ((v) = (x), true) : false)
+#endif
+
+static struct command cmd_queue_default[CMD_QUEUE_SIZE];
+static struct command *cmd_queue = cmd_queue_default;
+static int cmd_queue_size = CMD_QUEUE_SIZE;
 static int cmd_head = 0;
+static int cmd_claim = 0;
 static int cmd_tail = 0;
-static struct command cmd_queue[CMD_QUEUE_SIZE];
+
+/* The slot cmdq_push_copy() last filled, for cmdq_peek() */
+static int cmd_pushed = CMD_QUEUE_SIZE - 1;
 
 static bool repeat_prev_allowed = false;
 static bool repeating = false;
 
+/**
+ * Returns the command last pushed by cmdq_push_copy() (and so by
+ * cmdq_push()), so that the game and front end can fill its arguments in.
+ * A producer on another thread should fill its commands in before pushing
+ * them with cmdq_push_batch() instead, as once pushed they belong to the
+ * game.
+ */
 struct command *cmdq_peek(void)
 {
-	return &cmd_queue[prev_cmd_idx(cmd_head)];
+	return &cmd_queue[cmd_pushed];
+}
+
+/**
+ * How many slots are free, for claims starting at `from`
+ */
+static int cmdq_room(int from)
+{
+	int used = from - cmdq_load(cmd_tail);
+
+	if (used < 0) used += cmd_queue_size;
+	return cmd_queue_size - 1 - used;
+}
+
+/**
+ * Claim n slots, returning the first, or -1 if there isn't room for them
+ */
+static int cmdq_claim(int n)
+{
+	int start = cmdq_load(cmd_claim);
+
+	do {
+		if (n > cmdq_room(start)) return -1;
+	} while (!cmdq_cas(cmd_claim, start, (start + n) % cmd_queue_size));
+
+	return start;
+}
+
+/**
+ * Wait for the claims before the one at `start` to be published
+ */
+static void cmdq_wait(int start)
+{
+	while (cmdq_load(cmd_head) != start) ;
+}
+
+/**
+ * How many more commands can be pushed right now
+ */
+int cmdq_space(void)
+{
+	return cmdq_room(cmdq_load(cmd_claim));
+}
+
+/**
+ * Change how many commands the queue can hold, keeping those waiting and
+ * the one being carried out.  This must only be done while nothing else
+ * is pushing; returns nonzero if the waiting commands wouldn't fit.
+ */
+errr cmdq_set_size(int size)
+{
+	struct command *queue;
+	int i, n = cmd_queue_size - cmdq_space();
+
+	if (size < 2 || n > size) return 1;
+
+	/* The one being carried out, then those waiting */
+	queue = mem_zalloc(size * sizeof(*queue));
+	for (i = 0; i < n; i++)
+		queue[i] = cmd_queue[prev_cmd_idx(cmd_tail + i)];
+
+	if (cmd_queue != cmd_queue_default)
+		mem_free(cmd_queue);
+	cmd_queue = queue;
+	cmd_queue_size = size;
+	cmd_tail = 1 % size;
+	cmd_head = cmd_claim = n % size;
+	cmd_pushed = prev_cmd_idx(cmd_head);
+
+	return 0;
 }
 
+/**
+ * Forget every command waiting, and any repeats of the current one
+ */
+void cmdq_flush(void)
+{
+	cmd_cancel_repeat();
+	cmdq_store(cmd_tail, cmdq_load(cmd_head));
+}
+
+/**
+ * Free a queue made by cmdq_set_size(), going back to the usual one
+ */
+void cmdq_free(void)
+{
+	if (cmd_queue != cmd_queue_default)
+		mem_free(cmd_queue);
+	cmd_queue = cmd_queue_default;
+	cmd_queue_size = CMD_QUEUE_SIZE;
+	cmd_head = cmd_claim = cmd_tail = 0;
+	cmd_pushed = CMD_QUEUE_SIZE - 1;
+	memset(cmd_queue_default, 0, sizeof(cmd_queue_default));
+}
 
 /**
- * Insert the given command into the command queue.
+ * Insert the given command into the command queue.  This is for the game
+ * and front end, which use cmdq_peek() afterwards; see cmdq_push_batch().
  */
 errr cmdq_push_copy(struct command *cmd)
 {
+	int slot;
+
+	if (cmd->code == CMD_REPEAT && !repeat_prev_allowed) return 1;
+
 	/* If queue full, return error */
-	if (cmd_head + 1 == cmd_tail) return 1;
-	if (cmd_head + 1 == CMD_QUEUE_SIZE && cmd_tail == 0) return 1;
+	slot = cmdq_claim(1);
+	if (slot < 0) return 1;
 
 	/* Insert command into queue. */
 	if (cmd->code != CMD_REPEAT) {
-		cmd_queue[cmd_head] = *cmd;
+		cmd_queue[slot] = *cmd;
+		cmdq_wait(slot);
 	} else {
-		int cmd_prev = cmd_head - 1;
-
-		if (!repeat_prev_allowed) return 1;
+		int cmd_prev = prev_cmd_idx(slot);
 
 		/* If we're repeating a command, we duplicate the previous command 
-		   in the next command "slot". */
-		if (cmd_prev < 0) cmd_prev = CMD_QUEUE_SIZE - 1;
-		
+		   in the next command "slot", once it is there. */
+		cmdq_wait(slot);
 		if (cmd_queue[cmd_prev].code != CMD_NULL)
-			cmd_queue[cmd_head] = cmd_queue[cmd_prev];
+			cmd_queue[slot] = cmd_queue[cmd_prev];
 	}
 
 	/* Advance point in queue, wrapping around at the end */
-	cmd_head++;
-	if (cmd_head == CMD_QUEUE_SIZE) cmd_head = 0;
+	cmd_pushed = slot;
+	cmdq_store(cmd_head, next_cmd_idx(slot));
 
 	return 0;	
 }
 
+/**
+ * Insert a run of commands into the queue all at once, so the game never
+ * sees only some of them; if there isn't room for all, none go in.  This
+ * is the one to use from another thread.
+ */
+errr cmdq_push_batch(const struct command *cmds, int n)
+{
+	int start, slot;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (cmds[i].code == CMD_REPEAT) return 1;
+	}
+
+	start = cmdq_claim(n);
+	if (start < 0) return 1;
+
+	for (i = 0, slot = start; i < n; i++) {
+		cmd_queue[slot] = cmds[i];
+		slot = next_cmd_idx(slot);
+	}
+
+	cmdq_wait(start);
+	cmdq_store(cmd_head, slot);
+
+	return 0;
+}
+
 /**
  * Process a game command from the UI or the command queue and carry out
  * whatever actions go along with it.
@@ -218,8 +383,13 @@ void process_command(cmd_context ctx, struct command *cmd)
 	cmd->context = ctx;
 
 	/* Actually execute the command function */
-	if (game_cmds[idx].fn)
+	if (game_cmds[idx].fn) {
+		PROFILE_COMMAND_ENTER(cmd->code, player->upkeep->energy_use);
+		cmd_record_enter(true);
 		game_cmds[idx].fn(cmd);
+		cmd_record_leave();
+		PROFILE_COMMAND_LEAVE(player->upkeep->energy_use);
+	}
 
 	/* If the command hasn't changed nrepeats, count this execution. */
 	if (cmd->nrepeats > 0 && oldrepeats == cmd_get_nrepeats())
@@ -236,13 +406,17 @@ bool cmdq_pop(cmd_context c)
 	/* If we're repeating, just pull the last command again. */
 	if (repeating) {
 		cmd = &cmd_queue[prev_cmd_idx(cmd_tail)];
-	} else if (cmd_head != cmd_tail) {
+	} else if (cmdq_load(cmd_head) != cmd_tail) {
 		/* If we have a command ready, set it. */
-		cmd = &cmd_queue[cmd_tail++];
-		if (cmd_tail == CMD_QUEUE_SIZE)
-			cmd_tail = 0;
+		cmd = &cmd_queue[cmd_tail];
+		cmdq_store(cmd_tail, next_cmd_idx(cmd_tail));
+
+		/* Write it down, or fill it in when playing a record back */
+		cmd_record_pop(c, cmd);
 	} else {
 		/* Failure to get a command. */
+		if (c == CMD_GAME)
+			cmd_record_idle();
 		return false;
 	}
 
@@ -59,6 +59,7 @@ typedef enum cmd_code {
 	CMD_WALK,
 	CMD_JUMP,
 	CMD_PATHFIND,
+	CMD_EXPLORE,
 
 	CMD_INSCRIBE,
 	CMD_UNINSCRIBE,
@@ -237,6 +238,14 @@ const char *cmd_verb(cmd_code cmd);
  */
 struct command *cmdq_peek(void);
 
+/**
+ * Room left in the queue, and changing, emptying or freeing it.
+ */
+int cmdq_space(void);
+errr cmdq_set_size(int size);
+void cmdq_flush(void);
+void cmdq_free(void);
+
 /**
  * A function called by the game to get a command from the UI.
  */
@@ -253,6 +262,7 @@ bool cmdq_pop(cmd_context c);
 errr cmdq_push_copy(struct command *cmd);
 errr cmdq_push_repeat(cmd_code c, int nrepeats);
 errr cmdq_push(cmd_code c);
+errr cmdq_push_batch(const struct command *cmds, int n);
 
 
 /**
@@ -0,0 +1,886 @@
+/**
+ * \file cmd-record.c
+ * \brief Record the commands a game is played with, and play them back
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ *
+ * A record is a text file with one line for everything the game got from
+ * outside itself while it was being played, in the order it got them:
+ *
+ *   v <version> <build>        the header
+ *   seed <hex>                 the RNG seed, given when the character is born
+ *   c <context> <code> <repeats> [<name> <type> <value>]...
+ *                              a command taken from the queue
+ *   o <option> <value>         an option the player had changed
+ *   t <set> <monster> <x> <y>  the target, if it had changed
+ *   a <kind> <value>...        the answer to a question the game asked
+ *   n                          no command was waiting
+ *   x <turn>                   the player cut a repeated command short
+ *   e <turn> <depth> <exp> <au> <hp> <x> <y>
+ *                              how the game ended up
+ *
+ * Given the same seed and the same lines in the same order, the game plays
+ * out the same way, so a record can be played back without any front end
+ * to time the game or to check that a change hasn't altered how it plays.
+ * Record lines that follow a command are read along with it.
+ */
+
+#include "angband.h"
+#include "buildid.h"
+#include "cave.h"
+#include "cmd-record.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "generate.h"
+#include "mon-make.h"
+#include "monster.h"
+#include "obj-pile.h"
+#include "option.h"
+#include "player-calcs.h"
+#include "player-util.h"
+#include "store.h"
+#include "target.h"
+
+/**
+ * Bump this whenever the format changes
+ */
+#define RECORD_VERSION	1
+
+#define RECORD_LINE		1024
+
+/**
+ * The file being written, and whether the seed has gone into it yet
+ */
+static ang_file *record_file;
+static bool record_seeded;
+
+/**
+ * The file being played back, with one line of lookahead
+ */
+static ang_file *replay_file;
+static char replay_line[RECORD_LINE];
+static bool replay_ready;
+static int replay_lineno;
+
+/**
+ * The options and target as the other end last saw them
+ */
+static struct player_options record_opts;
+static struct record_target {
+	bool set;
+	int midx;
+	int x, y;
+} record_target;
+
+/**
+ * What was running the game at each level of nesting, one bit per level,
+ * set for a command and clear for the front end.  Only questions asked on
+ * behalf of a command are recorded; the front end asks plenty of its own.
+ */
+static u32b frame_bits;
+static int frame_depth;
+
+/**
+ * ------------------------------------------------------------------------
+ * Writing
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Add to a record line
+ */
+static void line_add(char *buf, size_t *len, const char *fmt, ...)
+{
+	va_list vp;
+
+	va_start(vp, fmt);
+	*len += vstrnfmt(buf + *len, RECORD_LINE - *len, fmt, vp);
+	va_end(vp);
+}
+
+/**
+ * Add a string, escaping anything that would get in the way of reading
+ * the line back
+ */
+static void line_add_string(char *buf, size_t *len, const char *str)
+{
+	line_add(buf, len, " =");
+	for (; *str; str++) {
+		unsigned char c = (unsigned char)*str;
+		if (c <= ' ' || c == '\\')
+			line_add(buf, len, "\\%02x", c);
+		else
+			line_add(buf, len, "%c", c);
+	}
+}
+
+/**
+ * Name an object by where it is, relative to the player
+ */
+static void line_add_object(char *buf, size_t *len, const struct object *obj)
+{
+	const struct object *o;
+	struct store *s;
+	int n;
+
+	if (!obj) {
+		line_add(buf, len, " -");
+		return;
+	}
+
+	for (o = player->gear, n = 0; o; o = o->next, n++)
+		if (o == obj) {
+			line_add(buf, len, " g%d", n);
+			return;
+		}
+
+	if (cave && square_in_bounds(cave, player->py, player->px)) {
+		o = square_object(cave, player->py, player->px);
+		for (n = 0; o; o = o->next, n++)
+			if (o == obj) {
+				line_add(buf, len, " f%d", n);
+				return;
+			}
+
+		s = store_at(cave, player->py, player->px);
+		for (o = s ? s->stock : NULL, n = 0; o; o = o->next, n++)
+			if (o == obj) {
+				line_add(buf, len, " s%d", n);
+				return;
+			}
+
+		if (obj->oidx && obj->oidx < cave->obj_max &&
+			cave->objects[obj->oidx] == obj) {
+			line_add(buf, len, " o%d", obj->oidx);
+			return;
+		}
+	}
+
+	line_add(buf, len, " -");
+}
+
+static void record_put(const char *buf)
+{
+	file_put(record_file, buf);
+	file_put(record_file, "\n");
+}
+
+/**
+ * Note any options or target that have changed since they were last written
+ */
+static void record_changes(void)
+{
+	char buf[RECORD_LINE];
+	struct record_target now;
+	int i;
+
+	for (i = 0; i < OPT_MAX; i++) {
+		if (!option_name(i) || player->opts.opt[i] == record_opts.opt[i])
+			continue;
+		strnfmt(buf, sizeof(buf), "o %s %d", option_name(i),
+				player->opts.opt[i] ? 1 : 0);
+		record_put(buf);
+	}
+	if (player->opts.hitpoint_warn != record_opts.hitpoint_warn) {
+		strnfmt(buf, sizeof(buf), "o hitpoint_warn %d",
+				player->opts.hitpoint_warn);
+		record_put(buf);
+	}
+	record_opts = player->opts;
+
+	now.set = target_is_set();
+	now.midx = target_get_monster() ? target_get_monster()->midx : 0;
+	target_get(&now.x, &now.y);
+	if (now.set != record_target.set || now.midx != record_target.midx ||
+		now.x != record_target.x || now.y != record_target.y) {
+		strnfmt(buf, sizeof(buf), "t %d %d %d %d", now.set ? 1 : 0, now.midx,
+				now.x, now.y);
+		record_put(buf);
+		record_target = now;
+	}
+}
+
+/**
+ * Write a command as it comes off the queue
+ */
+static void record_command(cmd_context c, struct command *cmd)
+{
+	char buf[RECORD_LINE];
+	size_t len = 0;
+	int i;
+
+	line_add(buf, &len, "c %d %d %d", c, cmd->code, cmd->nrepeats);
+	for (i = 0; i < CMD_MAX_ARGS; i++) {
+		struct cmd_arg *arg = &cmd->arg[i];
+		if (!arg->name[0] || arg->type == arg_NONE) continue;
+
+		line_add(buf, &len, " %s", arg->name);
+		switch (arg->type) {
+			case arg_STRING:
+				line_add(buf, &len, " s");
+				line_add_string(buf, &len, arg->data.string);
+				break;
+			case arg_CHOICE:
+				line_add(buf, &len, " c %d", arg->data.choice);
+				break;
+			case arg_ITEM:
+				line_add(buf, &len, " i");
+				line_add_object(buf, &len, arg->data.obj);
+				break;
+			case arg_NUMBER:
+				line_add(buf, &len, " n %d", arg->data.number);
+				break;
+			case arg_DIRECTION:
+				line_add(buf, &len, " d %d", arg->data.direction);
+				break;
+			case arg_TARGET:
+				line_add(buf, &len, " t %d", arg->data.direction);
+				break;
+			case arg_POINT:
+				line_add(buf, &len, " p %d %d", arg->data.point.x,
+						 arg->data.point.y);
+				break;
+			default:
+				break;
+		}
+	}
+	record_put(buf);
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Reading
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Give up on a replay that has gone out of step with its record
+ */
+static void replay_desync(const char *what)
+{
+	char buf[RECORD_LINE];
+
+	strnfmt(buf, sizeof(buf), "Replay out of step at line %d: expected %s, "
+			"got '%s'", replay_lineno, what,
+			replay_ready ? replay_line : "end of file");
+	quit(buf);
+}
+
+/**
+ * The next record line, or NULL at the end; it stays there until taken
+ */
+static const char *replay_peek(void)
+{
+	while (!replay_ready) {
+		if (!replay_file || !file_getl(replay_file, replay_line,
+										sizeof(replay_line)))
+			return NULL;
+		replay_lineno++;
+		if (replay_line[0] && replay_line[0] != '#')
+			replay_ready = true;
+	}
+
+	return replay_line;
+}
+
+static void replay_take(void)
+{
+	replay_ready = false;
+}
+
+/**
+ * Whether the next line is of the given kind
+ */
+static bool replay_is(const char *kind)
+{
+	const char *line = replay_peek();
+	size_t n = strlen(kind);
+
+	return line && !strncmp(line, kind, n) && (!line[n] || line[n] == ' ');
+}
+
+/**
+ * Take the next space-separated word from a line
+ */
+static const char *replay_word(char **s)
+{
+	char *start;
+
+	while (**s == ' ') (*s)++;
+	start = *s;
+	while (**s && **s != ' ') (*s)++;
+	if (**s) *(*s)++ = '\0';
+
+	return start;
+}
+
+static int replay_int(char **s)
+{
+	return atoi(replay_word(s));
+}
+
+/**
+ * Read back a string written by line_add_string()
+ */
+static void replay_string(char **s, char *buf, size_t len)
+{
+	const char *word = replay_word(s);
+	size_t i = 0;
+
+	if (*word == '=') word++;
+	while (*word && i + 1 < len) {
+		unsigned int c;
+		if (*word == '\\' && sscanf(word + 1, "%2x", &c) == 1) {
+			buf[i++] = (char)c;
+			word += 3;
+		} else {
+			buf[i++] = *word++;
+		}
+	}
+	buf[i] = '\0';
+}
+
+/**
+ * Find an object named by line_add_object()
+ */
+static struct object *replay_object(char **s)
+{
+	const char *word = replay_word(s);
+	struct object *o = NULL;
+	struct store *store;
+	int n = atoi(word + 1);
+
+	switch (word[0]) {
+		case 'g':
+			o = player->gear;
+			break;
+		case 'f':
+			o = square_object(cave, player->py, player->px);
+			break;
+		case 's':
+			store = store_at(cave, player->py, player->px);
+			o = store ? store->stock : NULL;
+			break;
+		case 'o':
+			return (n > 0 && n < (int)cave->obj_max) ? cave->objects[n] : NULL;
+		default:
+			return NULL;
+	}
+
+	while (o && n--)
+		o = o->next;
+
+	return o;
+}
+
+/**
+ * Apply any option and target lines waiting to be read
+ */
+static void replay_changes(void)
+{
+	while (replay_is("o") || replay_is("t")) {
+		char *s = replay_line + 2;
+
+		if (replay_line[0] == 'o') {
+			const char *name = replay_word(&s);
+			int val = replay_int(&s);
+			int i;
+
+			if (streq(name, "hitpoint_warn")) {
+				player->opts.hitpoint_warn = val;
+			} else {
+				for (i = 0; i < OPT_MAX; i++)
+					if (option_name(i) && streq(option_name(i), name))
+						break;
+				if (i == OPT_MAX)
+					replay_desync("an option this version knows");
+				player->opts.opt[i] = val ? true : false;
+			}
+		} else {
+			bool set = replay_int(&s) ? true : false;
+			int midx = replay_int(&s);
+			int x = replay_int(&s);
+			int y = replay_int(&s);
+
+			if (set && midx)
+				target_set_monster(cave_monster(cave, midx));
+			else if (set)
+				target_set_location(y, x);
+			else
+				target_set_monster(NULL);
+		}
+
+		replay_take();
+	}
+}
+
+/**
+ * Fill in a command from its record line
+ */
+static void replay_command(cmd_context c, struct command *cmd)
+{
+	const char *verb = cmd_verb(cmd->code);
+	char *s;
+
+	if (!verb) verb = "a command";
+	if (!replay_is("c"))
+		replay_desync(verb);
+
+	s = replay_line + 2;
+	if (replay_int(&s) != (int)c || replay_int(&s) != (int)cmd->code)
+		replay_desync(verb);
+
+	cmd->nrepeats = replay_int(&s);
+	memset(cmd->arg, 0, sizeof(cmd->arg));
+	while (*s) {
+		char name[sizeof(cmd->arg[0].name)];
+		const char *type;
+
+		my_strcpy(name, replay_word(&s), sizeof(name));
+		type = replay_word(&s);
+		if (!name[0]) break;
+
+		switch (type[0]) {
+			case 's': {
+				char str[RECORD_LINE];
+				replay_string(&s, str, sizeof(str));
+				cmd_set_arg_string(cmd, name, str);
+				break;
+			}
+			case 'c':
+				cmd_set_arg_choice(cmd, name, replay_int(&s));
+				break;
+			case 'i':
+				cmd_set_arg_item(cmd, name, replay_object(&s));
+				break;
+			case 'n':
+				cmd_set_arg_number(cmd, name, replay_int(&s));
+				break;
+			case 'd':
+				cmd_set_arg_direction(cmd, name, replay_int(&s));
+				break;
+			case 't':
+				cmd_set_arg_target(cmd, name, replay_int(&s));
+				break;
+			case 'p': {
+				int x = replay_int(&s);
+				cmd_set_arg_point(cmd, name, x, replay_int(&s));
+				break;
+			}
+			default:
+				replay_desync("a command argument");
+		}
+	}
+	replay_take();
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Starting and stopping
+ * ------------------------------------------------------------------------ */
+
+static void record_reset(void)
+{
+	options_init_defaults(&record_opts);
+	memset(&record_target, 0, sizeof(record_target));
+	frame_bits = 0;
+	frame_depth = 0;
+}
+
+/**
+ * Start writing a record of the game to the given file.  Only a game begun
+ * from a new character can be recorded, as nothing is kept of a savefile.
+ */
+bool cmd_record_start(const char *path)
+{
+	cmd_record_stop();
+	record_file = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!record_file) return false;
+
+	record_reset();
+	record_seeded = false;
+	file_putf(record_file, "v %d %s\n", RECORD_VERSION, buildid);
+	return true;
+}
+
+/**
+ * Start playing back a record in place of a front end
+ */
+bool cmd_replay_start(const char *path)
+{
+	int version;
+	char *s;
+
+	cmd_record_stop();
+	replay_file = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!replay_file) return false;
+
+	/* Nothing left over from before is part of the record */
+	cmdq_flush();
+	record_reset();
+	replay_ready = false;
+	replay_lineno = 0;
+	if (!replay_is("v")) {
+		cmd_record_stop();
+		return false;
+	}
+	s = replay_line + 2;
+	version = replay_int(&s);
+	if (version != RECORD_VERSION) {
+		cmd_record_stop();
+		return false;
+	}
+	if (!streq(s, buildid))
+		plog_fmt("Replaying a record made by %s", s);
+	replay_take();
+
+	/* The game plays the same only from the same starting options */
+	options_init_defaults(&player->opts);
+	return true;
+}
+
+/**
+ * Stop recording or playing back, finishing the record off with how the
+ * game ended up
+ */
+void cmd_record_stop(void)
+{
+	if (record_file) {
+		if (record_seeded) {
+			struct record_digest d;
+			cmd_record_digest(&d);
+			file_putf(record_file, "e %d %d %d %d %d %d %d\n", d.turn,
+					  d.depth, d.exp, d.au, d.chp, d.px, d.py);
+		}
+		file_close(record_file);
+		record_file = NULL;
+	}
+
+	if (replay_file) {
+		file_close(replay_file);
+		replay_file = NULL;
+	}
+	replay_ready = false;
+}
+
+bool cmd_recording(void)
+{
+	return record_file != NULL;
+}
+
+bool cmd_replaying(void)
+{
+	return replay_file != NULL;
+}
+
+/**
+ * Sum up the state of the game, to tell whether two runs came out the same
+ */
+void cmd_record_digest(struct record_digest *d)
+{
+	d->turn = turn;
+	d->depth = player->depth;
+	d->exp = player->exp;
+	d->au = player->au;
+	d->chp = player->chp;
+	d->px = player->px;
+	d->py = player->py;
+}
+
+/**
+ * Read how the recorded game ended up, once all of it has been played back
+ */
+bool cmd_replay_expected(struct record_digest *d)
+{
+	char buf[RECORD_LINE];
+	char *s = buf + 2;
+
+	if (!replay_is("e")) return false;
+
+	my_strcpy(buf, replay_line, sizeof(buf));
+	d->turn = replay_int(&s);
+	d->depth = replay_int(&s);
+	d->exp = replay_int(&s);
+	d->au = replay_int(&s);
+	d->chp = replay_int(&s);
+	d->px = replay_int(&s);
+	d->py = replay_int(&s);
+	return true;
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Hooks into the game
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Note that a command, or the front end, has started running
+ */
+void cmd_record_enter(bool command)
+{
+	frame_bits = (frame_bits << 1) | (command ? 1 : 0);
+	frame_depth++;
+}
+
+void cmd_record_leave(void)
+{
+	frame_bits >>= 1;
+	frame_depth--;
+}
+
+/**
+ * Whether questions asked now are asked by a command
+ */
+static bool record_in_command(void)
+{
+	return frame_depth > 0 && (frame_bits & 1);
+}
+
+/**
+ * Start a new character from nothing, whatever went before.  Rand_state_init()
+ * carries on from the current state index, so that has to go back to the
+ * start, the last character mustn't be offered for a quick start, and the
+ * shopkeepers are picked afresh rather than as "anyone but the last one".
+ * Levels kept from the last game (the town, at least) go too, so that the
+ * new town is built just as it will be when played back.  So does the level
+ * the last game was on, while its monsters are still counted; birth zeroes
+ * the counts, and clearing the level after that would leave them short.
+ * Resting is forgotten, as a rest cut short sticks to the next one.
+ */
+static void record_seed(u32b seed)
+{
+	int i;
+
+	for (i = 0; stores && i < MAX_STORES; i++)
+		stores[i].owner = NULL;
+	chunk_list_free();
+	if (cave) {
+		wipe_mon_list(cave, player);
+		cave_free(cave);
+		cave = NULL;
+	}
+	if (player->cave) {
+		cave_free(player->cave);
+		player->cave = NULL;
+	}
+	character_dungeon = false;
+	player_resting_cancel(player, false);
+
+	Rand_quick = false;
+	state_i = 0;
+	Rand_state_init(seed);
+
+	player->ht_birth = 0;
+	player->full_name[0] = '\0';
+}
+
+/**
+ * A command is about to be carried out; write it down, or fill it in from
+ * the record.
+ */
+void cmd_record_pop(cmd_context c, struct command *cmd)
+{
+	if (replay_file) {
+		replay_command(c, cmd);
+
+		/* Everything hangs on the seed the character was born with */
+		if (cmd->code == CMD_BIRTH_INIT) {
+			unsigned int seed;
+			if (!replay_is("seed") || sscanf(replay_line + 5, "%x", &seed) != 1)
+				replay_desync("the seed");
+			replay_take();
+			record_seed(seed);
+		}
+
+		replay_changes();
+	} else if (record_file) {
+		if (cmd->code == CMD_BIRTH_INIT && !record_seeded) {
+			u32b seed = randint0(0x10000000);
+
+			record_command(c, cmd);
+			file_putf(record_file, "seed %08x\n", seed);
+			record_seeded = true;
+			record_seed(seed);
+		} else if (!record_seeded) {
+			/* A loaded game can't be played back */
+			cmd_record_stop();
+			return;
+		} else {
+			record_command(c, cmd);
+		}
+
+		record_changes();
+	}
+}
+
+/**
+ * The game wanted a command and none was waiting
+ */
+void cmd_record_idle(void)
+{
+	if (replay_file) {
+		if (!replay_is("n"))
+			replay_desync("no command");
+		replay_take();
+	} else if (record_file && record_seeded) {
+		file_put(record_file, "n\n");
+	}
+}
+
+/**
+ * Give the front end its chance to cut short a repeated command, running
+ * or resting; when playing back, it is cut short just where it was before.
+ */
+void cmd_record_interrupt(void)
+{
+	if (replay_file) {
+		if (!replay_is("x") || atoi(replay_line + 2) != turn) return;
+		replay_take();
+
+		event_signal(EVENT_INPUT_FLUSH);
+		disturb(player, 0);
+		msg("Cancelled.");
+	} else {
+		int running = player->upkeep->running;
+		int repeats = cmd_get_nrepeats();
+		int resting = player_resting_count(player);
+
+		event_signal(EVENT_CHECK_INTERRUPT);
+
+		if (record_file && record_seeded &&
+			(running != player->upkeep->running ||
+			 repeats != cmd_get_nrepeats() ||
+			 resting != player_resting_count(player)))
+			file_putf(record_file, "x %d\n", turn);
+	}
+}
+
+/**
+ * When playing back, put the next recorded command for the given context
+ * on the queue; cmd_record_pop() fills in the rest of it.  Returns false
+ * once there are no more to be had for that context.
+ */
+bool cmd_replay_push(cmd_context c)
+{
+	char buf[RECORD_LINE];
+	char *s = buf + 2;
+	int ctx, code;
+
+	if (replay_is("n")) return c == CMD_GAME;
+	if (!replay_is("c")) return false;
+
+	/* Leave the line itself for cmd_record_pop() */
+	my_strcpy(buf, replay_line, sizeof(buf));
+	ctx = replay_int(&s);
+	code = replay_int(&s);
+	if (ctx != (int)c) return false;
+
+	cmdq_push((cmd_code)code);
+	return true;
+}
+
+/**
+ * Answer a question asked on behalf of a command from the record.
+ */
+bool cmd_replay_answer(char kind, int *vals, int n)
+{
+	char *s;
+	int i;
+
+	if (!replay_file || !record_in_command()) return false;
+
+	if (!replay_is("a") || replay_line[2] != kind)
+		replay_desync("an answer");
+
+	s = replay_line + 3;
+	for (i = 0; i < n; i++)
+		vals[i] = replay_int(&s);
+	replay_take();
+
+	replay_changes();
+	return true;
+}
+
+/**
+ * Write down the answer to a question asked on behalf of a command
+ */
+void cmd_record_answer(char kind, const int *vals, int n)
+{
+	char buf[RECORD_LINE];
+	size_t len = 0;
+	int i;
+
+	if (!record_file || !record_seeded || !record_in_command()) return;
+
+	line_add(buf, &len, "a %c", kind);
+	for (i = 0; i < n; i++)
+		line_add(buf, &len, " %d", vals[i]);
+	record_put(buf);
+
+	record_changes();
+}
+
+bool cmd_replay_answer_string(bool *ret, char *buf, size_t len)
+{
+	char *s;
+
+	if (!replay_file || !record_in_command()) return false;
+
+	if (!replay_is("a") || replay_line[2] != 's')
+		replay_desync("an answer");
+
+	s = replay_line + 3;
+	*ret = replay_int(&s) ? true : false;
+	replay_string(&s, buf, len);
+	replay_take();
+	return true;
+}
+
+void cmd_record_answer_string(bool ret, const char *buf)
+{
+	char line[RECORD_LINE];
+	size_t len = 0;
+
+	if (!record_file || !record_seeded || !record_in_command()) return;
+
+	line_add(line, &len, "a s %d", ret ? 1 : 0);
+	line_add_string(line, &len, buf);
+	record_put(line);
+}
+
+bool cmd_replay_answer_item(bool *ret, struct object **obj)
+{
+	char *s;
+
+	if (!replay_file || !record_in_command()) return false;
+
+	if (!replay_is("a") || replay_line[2] != 'i')
+		replay_desync("an answer");
+
+	s = replay_line + 3;
+	*ret = replay_int(&s) ? true : false;
+	if (*ret) *obj = replay_object(&s);
+	replay_take();
+	return true;
+}
+
+void cmd_record_answer_item(bool ret, struct object *obj)
+{
+	char line[RECORD_LINE];
+	size_t len = 0;
+
+	if (!record_file || !record_seeded || !record_in_command()) return;
+
+	line_add(line, &len, "a i %d", ret ? 1 : 0);
+	line_add_object(line, &len, obj);
+	record_put(line);
+}
@@ -0,0 +1,60 @@
+/**
+ * \file cmd-record.h
+ * \brief Record the commands a game is played with, and play them back
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_CMD_RECORD_H
+#define INCLUDED_CMD_RECORD_H
+
+#include "cmd-core.h"
+
+/**
+ * What a game ended up as, for checking a replay against its record
+ */
+struct record_digest {
+	s32b turn;
+	int depth;
+	s32b exp;
+	s32b au;
+	int chp;
+	int px, py;
+};
+
+bool cmd_record_start(const char *path);
+bool cmd_replay_start(const char *path);
+void cmd_record_stop(void);
+bool cmd_recording(void);
+bool cmd_replaying(void);
+
+void cmd_record_digest(struct record_digest *d);
+bool cmd_replay_expected(struct record_digest *d);
+
+void cmd_record_enter(bool command);
+void cmd_record_leave(void);
+
+void cmd_record_pop(cmd_context c, struct command *cmd);
+void cmd_record_idle(void);
+void cmd_record_interrupt(void);
+bool cmd_replay_push(cmd_context c);
+
+bool cmd_replay_answer(char kind, int *vals, int n);
+void cmd_record_answer(char kind, const int *vals, int n);
+bool cmd_replay_answer_string(bool *ret, char *buf, size_t len);
+void cmd_record_answer_string(bool ret, const char *buf);
+bool cmd_replay_answer_item(bool *ret, struct object **obj);
+void cmd_record_answer_item(bool ret, struct object *obj);
+
+#endif /* !INCLUDED_CMD_RECORD_H */
@@ -37,6 +37,7 @@ void do_cmd_walk(struct command *cmd);
 void do_cmd_jump(struct command *cmd);
 void do_cmd_run(struct command *cmd);
 void do_cmd_pathfind(struct command *cmd);
+void do_cmd_explore(struct command *cmd);
 void do_cmd_hold(struct command *cmd);
 void do_cmd_rest(struct command *cmd);
 void do_cmd_sleep(struct command *cmd);
@@ -24,6 +24,7 @@
 #include "game-world.h"
 #include "init.h"
 #include "parser.h"
+#include "profile.h"
 
 const char *parser_error_str[PARSE_ERROR_MAX] = {
 	#define PARSE_ERROR(a, b) b,
@@ -46,19 +47,21 @@ static void print_error(struct file_parser *fp, struct parser *p) {
 }
 
 errr run_parser(struct file_parser *fp) {
-	struct parser *p = fp->init();
+	struct parser *p;
 	errr r;
+
+	PROFILE_BEGIN(fp->name);
+	p = fp->init();
 	if (!p) {
+		PROFILE_END(fp->name);
 		return PARSE_ERROR_GENERIC;
 	}
 	r = fp->run(p);
-	if (r) {
-		print_error(fp, p);
-		return r;
-	}
-	r = fp->finish(p);
+	if (!r)
+		r = fp->finish(p);
 	if (r)
 		print_error(fp, p);
+	PROFILE_END(fp->name);
 	return r;
 }
 
@@ -26,6 +26,7 @@
 #include "mon-desc.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -975,7 +976,7 @@ bool effect_handler_RESTORE_STAT(effect_handler_context_t *context)
 	player->stat_cur[stat] = player->stat_max[stat];
 
 	/* Recalculate bonuses */
-	player->upkeep->update |= (PU_BONUS);
+	player->upkeep->update |= (PU_STATE);
 	update_stuff(player);
 
 	/* Message */
@@ -1336,6 +1337,20 @@ bool effect_handler_ALTER_REALITY(effect_handler_context_t *context)
 	return true;
 }
 
+/**
+ * Find the rectangle of grids an area effect around the player covers:
+ * context->value.dice rows above and below, context->value.sides columns
+ * either side, dragged into the dungeon.
+ */
+static void effect_area(effect_handler_context_t *context, int *y1, int *x1,
+						int *y2, int *x2)
+{
+	*y1 = MAX(player->py - context->value.dice, 0);
+	*y2 = MIN(player->py + context->value.dice, cave->height - 1);
+	*x1 = MAX(player->px - context->value.sides, 0);
+	*x2 = MIN(player->px + context->value.sides, cave->width - 1);
+}
+
 /**
  * Map an area around the player.  The height to map above and below the player
  * is context->value.dice, the width either side of the player
@@ -1346,20 +1361,9 @@ bool effect_handler_MAP_AREA(effect_handler_context_t *context)
 {
 	int i, x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	/* Pick an area to map */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	/* Drag the co-ordinates into the dungeon */
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
@@ -1380,8 +1384,10 @@ bool effect_handler_MAP_AREA(effect_handler_context_t *context)
 					int yy = y + ddy_ddd[i];
 					int xx = x + ddx_ddd[i];
 
-					/* Memorize walls (etc) */
-					if (square_seemslikewall(cave, yy, xx))
+					/* Memorize walls (etc), each wall once even though it
+					 * borders several floor grids */
+					if (square_seemslikewall(cave, yy, xx) &&
+						square_isnotknown(cave, yy, xx))
 						square_memorize(cave, yy, xx);
 				}
 			}
@@ -1420,23 +1426,13 @@ bool effect_handler_DETECT_TRAPS(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool detect = false;
 
 	struct object *obj;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 
 	/* Scan the dungeon */
@@ -1498,21 +1494,11 @@ bool effect_handler_DETECT_DOORS(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool doors = false;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
@@ -1559,21 +1545,11 @@ bool effect_handler_DETECT_STAIRS(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool stairs = false;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
@@ -1612,21 +1588,11 @@ bool effect_handler_DETECT_GOLD(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool gold_buried = false;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the dungeon */
 	for (y = y1; y < y2; y++) {
@@ -1666,21 +1632,11 @@ bool effect_handler_SENSE_OBJECTS(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool objects = false;
 
 	/* Pick an area to sense */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the area for objects */
 	for (y = y1; y <= y2; y++) {
@@ -1719,21 +1675,11 @@ bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
 {
 	int x, y;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool objects = false;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
 	/* Scan the area for objects */
 	for (y = y1; y <= y2; y++) {
@@ -1772,37 +1718,20 @@ bool effect_handler_DETECT_OBJECTS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
 {
-	int i, x, y;
+	int i, n;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool monsters = false;
+	s16b *found;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
-
-	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Skip dead monsters */
-		if (!mon->race) continue;
-
-		/* Location */
-		y = mon->fy;
-		x = mon->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
+	/* Scan the monsters in the area */
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, y1, x1, y2, x2, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
 
 		/* Detect all non-invisible, obvious monsters */
 		if (!monster_is_invisible(mon) && !monster_is_camouflaged(mon)) {
@@ -1822,6 +1751,7 @@ bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
 			monsters = true;
 		}
 	}
+	mem_free(found);
 
 	if (monsters)
 		msg("You sense the presence of monsters!");
@@ -1840,41 +1770,24 @@ bool effect_handler_DETECT_VISIBLE_MONSTERS(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_INVISIBLE_MONSTERS(effect_handler_context_t *context)
 {
-	int i, x, y;
+	int i, n;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool monsters = false;
+	s16b *found;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
-	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
+	/* Scan the monsters in the area */
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, y1, x1, y2, x2, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
 		struct monster_lore *lore;
 
-		/* Skip dead monsters */
-		if (!mon->race) continue;
-
 		lore = get_lore(mon->race);
 
-		/* Location */
-		y = mon->fy;
-		x = mon->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect invisible monsters */
 		if (monster_is_invisible(mon)) {
 			/* Take note that they are invisible */
@@ -1895,6 +1808,7 @@ bool effect_handler_DETECT_INVISIBLE_MONSTERS(effect_handler_context_t *context)
 			monsters = true;
 		}
 	}
+	mem_free(found);
 
 	if (monsters)
 		msg("You sense the presence of invisible creatures!");
@@ -1937,41 +1851,24 @@ bool effect_handler_IDENTIFY(effect_handler_context_t *context)
  */
 bool effect_handler_DETECT_EVIL(effect_handler_context_t *context)
 {
-	int i, x, y;
+	int i, n;
 	int x1, x2, y1, y2;
-	int y_dist = context->value.dice;
-	int x_dist = context->value.sides;
 
 	bool monsters = false;
+	s16b *found;
 
 	/* Pick an area to detect */
-	y1 = player->py - y_dist;
-	y2 = player->py + y_dist;
-	x1 = player->px - x_dist;
-	x2 = player->px + x_dist;
-
-	if (y1 < 0) y1 = 0;
-	if (x1 < 0) x1 = 0;
-	if (y2 > cave->height - 1) y2 = cave->height - 1;
-	if (x2 > cave->width - 1) x2 = cave->width - 1;
+	effect_area(context, &y1, &x1, &y2, &x2);
 
-	/* Scan monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
+	/* Scan the monsters in the area */
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, y1, x1, y2, x2, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
 		struct monster_lore *lore;
 
-		/* Skip dead monsters */
-		if (!mon->race) continue;
-
 		lore = get_lore(mon->race);
 
-		/* Location */
-		y = mon->fy;
-		x = mon->fx;
-
-		/* Only detect nearby monsters */
-		if (x < x1 || y < y1 || x > x2 || y > y2) continue;
-
 		/* Detect evil monsters */
 		if (monster_is_evil(mon)) {
 			/* Take note that they are evil */
@@ -1992,6 +1889,7 @@ bool effect_handler_DETECT_EVIL(effect_handler_context_t *context)
 			monsters = true;
 		}
 	}
+	mem_free(found);
 
 	if (monsters)
 		msg("You sense the presence of evil creatures!");
@@ -2211,37 +2109,50 @@ bool effect_handler_RECHARGE(effect_handler_context_t *context)
 }
 
 /**
- * Apply a "project()" directly to all viewable monsters.  If context->p2 is
- * set, the effect damage boost is applied.  This is a hack - NRM
+ * Apply a "project()" with flags 'flg' directly to all viewable monsters.
  *
- * Note that affected monsters are NOT auto-tracked by this usage.
+ * Only the monsters inside the bounds of the view are looked at, found from
+ * the monster block lists, and the list is taken before anything is hit so
+ * that monsters dying or moving part way through don't upset it.
  */
-bool effect_handler_PROJECT_LOS(effect_handler_context_t *context)
+static void project_los(effect_handler_context_t *context, int flg)
 {
-	int i, x, y;
+	int i, n;
+	struct loc tl, br;
+	s16b *found;
 	int dam = effect_calculate_value(context, context->p2 ? true : false);
 	int typ = context->p1;
 
-	int flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
-
 	/* Affect all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
+	view_bounds(cave, &tl, &br);
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, tl.y, tl.x, br.y, br.x, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
 
 		/* Paranoia -- Skip dead monsters */
 		if (!mon->race) continue;
 
-		/* Location */
-		y = mon->fy;
-		x = mon->fx;
-
 		/* Require line of sight */
-		if (!square_isview(cave, y, x)) continue;
+		if (!square_isview(cave, mon->fy, mon->fx)) continue;
 
 		/* Jump directly to the target monster */
-		(void)project(source_player(), 0, y, x, dam, typ, flg, 0, 0, context->obj);
+		(void)project(source_player(), 0, mon->fy, mon->fx, dam, typ, flg, 0,
+					  0, context->obj);
 		context->ident = true;
 	}
+	mem_free(found);
+}
+
+/**
+ * Apply a "project()" directly to all viewable monsters.  If context->p2 is
+ * set, the effect damage boost is applied.  This is a hack - NRM
+ *
+ * Note that affected monsters are NOT auto-tracked by this usage.
+ */
+bool effect_handler_PROJECT_LOS(effect_handler_context_t *context)
+{
+	project_los(context, PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE);
 
 	/* Result */
 	return true;
@@ -2255,32 +2166,11 @@ bool effect_handler_PROJECT_LOS(effect_handler_context_t *context)
  */
 bool effect_handler_PROJECT_LOS_AWARE(effect_handler_context_t *context)
 {
-	int i, x, y;
-	int dam = effect_calculate_value(context, context->p2 ? true : false);
-	int typ = context->p1;
-
 	int flg = PROJECT_JUMP | PROJECT_KILL | PROJECT_HIDE;
 
 	if (context->aware) flg |= PROJECT_AWARE;
 
-	/* Affect all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!mon->race) continue;
-
-		/* Location */
-		y = mon->fy;
-		x = mon->fx;
-
-		/* Require line of sight */
-		if (!square_isview(cave, y, x)) continue;
-
-		/* Jump directly to the target monster */
-		(void)project(source_player(), 0, y, x, dam, typ, flg, 0, 0, context->obj);
-		context->ident = true;
-	}
+	project_los(context, flg);
 
 	/* Result */
 	return true;
@@ -2299,25 +2189,28 @@ bool effect_handler_ACQUIRE(effect_handler_context_t *context)
  */
 bool effect_handler_WAKE(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
+	int radius = z_info->max_sight * 2;
 	bool woken = false;
+	s16b *found;
 
 	struct loc origin_loc = origin_get_loc(context->origin);
 
 	/* Wake everyone nearby */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-		if (mon->race) {
-			int radius = z_info->max_sight * 2;
-
-			/* Skip monsters too far away */
-			if (distance(origin_loc.y, origin_loc.x, mon->fy, mon->fx) < radius &&
-					mon->m_timed[MON_TMD_SLEEP]) {
-				mon_clear_timed(mon, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, false);
-				woken = true;
-			}
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, origin_loc.y - radius, origin_loc.x - radius,
+						 origin_loc.y + radius, origin_loc.x + radius, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
+
+		/* Skip monsters too far away */
+		if (distance(origin_loc.y, origin_loc.x, mon->fy, mon->fx) < radius &&
+				mon->m_timed[MON_TMD_SLEEP]) {
+			mon_clear_timed(mon, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, false);
+			woken = true;
 		}
 	}
+	mem_free(found);
 
 	/* Messages */
 	if (woken) {
@@ -2511,16 +2404,18 @@ bool effect_handler_MASS_BANISH(effect_handler_context_t *context)
  */
 bool effect_handler_PROBE(effect_handler_context_t *context)
 {
-	int i;
+	int i, n;
+	struct loc tl, br;
+	s16b *found;
 
 	bool probe = false;
 
 	/* Probe all (nearby) monsters */
-	for (i = 1; i < cave_monster_max(cave); i++) {
-		struct monster *mon = cave_monster(cave, i);
-
-		/* Paranoia -- Skip dead monsters */
-		if (!mon->race) continue;
+	view_bounds(cave, &tl, &br);
+	found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+	n = monsters_in_rect(cave, tl.y, tl.x, br.y, br.x, found);
+	for (i = 0; i < n; i++) {
+		struct monster *mon = cave_monster(cave, found[i]);
 
 		/* Require line of sight */
 		if (!square_isview(cave, mon->fy, mon->fx)) continue;
@@ -2546,6 +2441,7 @@ bool effect_handler_PROBE(effect_handler_context_t *context)
 			probe = true;
 		}
 	}
+	mem_free(found);
 
 	/* Done */
 	if (probe) {
@@ -2758,12 +2654,8 @@ bool effect_handler_TELEPORT(effect_handler_context_t *context)
 	int dis = context->value.base;
 	int y, x, pick;
 
-	struct jumps {
-		int y;
-		int x;
-		struct jumps *next;
-	} *spots = NULL;
-	int num_spots = 0;
+	struct loc *spots = NULL;
+	int num_spots = 0, max_spots = 0;
 	int current_score = 2 * MAX(z_info->dungeon_wid, z_info->dungeon_hgt);
 	bool only_vault_grids_possible = true;
 
@@ -2803,11 +2695,15 @@ bool effect_handler_TELEPORT(effect_handler_context_t *context)
 		for (x = 1; x < cave->width - 1; x++) {
 			int d = distance(y, x, y_start, x_start);
 			int score = ABS(d - dis);
-			struct jumps *new;
 
 			/* Must move */
 			if (d == 0) continue;
 
+			/* Once a non-vault grid has been seen the score to beat can only
+			 * go down, so worse grids need no further look */
+			if (!only_vault_grids_possible && (score > current_score))
+				continue;
+
 			/* Require "naked" floor space */
 			if (!square_isempty(cave, y, x)) continue;
 
@@ -2831,53 +2727,45 @@ bool effect_handler_TELEPORT(effect_handler_context_t *context)
 			/* Do we have better spots already? */
 			if (score > current_score) continue;
 
-			/* Make a new spot */
-			new = mem_zalloc(sizeof(struct jumps));
-			new->y = y;
-			new->x = x;
-
 			/* If improving start a new list, otherwise extend the old one */
 			if (score < current_score) {
 				current_score = score;
-				while (spots) {
-					struct jumps *next = spots->next;
-					mem_free(spots);
-					spots = next;
-				}
-				spots = new;
-				num_spots = 1;
-			} else {
-				new->next = spots;
-				spots = new;
-				num_spots++;
+				num_spots = 0;
 			}
+			if (num_spots == max_spots) {
+				max_spots = max_spots ? 2 * max_spots : 64;
+				spots = mem_realloc(spots, max_spots * sizeof(*spots));
+			}
+			spots[num_spots].y = y;
+			spots[num_spots].x = x;
+			num_spots++;
 		}
 	}
 
 	/* Report failure (very unlikely) */
 	if (!num_spots) {
 		msg("Failed to find teleport destination!");
+		mem_free(spots);
 		return true;
 	}
 
-	/* Pick a spot */
-	pick = randint0(num_spots);
-	while (pick) {
-		spots = spots->next;
-		pick--;
-	}
+	/* Pick a spot, counting from the last found as the old list did */
+	pick = num_spots - 1 - randint0(num_spots);
+	y = spots[pick].y;
+	x = spots[pick].x;
+	mem_free(spots);
 
 	/* Sound */
 	sound(is_player ? MSG_TELEPORT : MSG_TPOTHER);
 
 	/* Move player */
-	monster_swap(y_start, x_start, spots->y, spots->x);
+	monster_swap(y_start, x_start, y, x);
 
 	/* Clear any projection marker to prevent double processing */
-	sqinfo_off(cave->squares[spots->y][spots->x].info, SQUARE_PROJECT);
+	sqinfo_off(cave->squares[y][x].info, SQUARE_PROJECT);
 
-	/* Lots of updates after monster_swap */
-	handle_stuff(player);
+	/* Lots of updates after monster_swap, needed even mid-command */
+	update_stuff(player);
 
 	return true;
 }
@@ -2944,8 +2832,8 @@ bool effect_handler_TELEPORT_TO(effect_handler_context_t *context)
 	/* Clear any projection marker to prevent double processing */
 	sqinfo_off(cave->squares[y][x].info, SQUARE_PROJECT);
 
-	/* Lots of updates after monster_swap */
-	handle_stuff(player);
+	/* Lots of updates after monster_swap, needed even mid-command */
+	update_stuff(player);
 
 	return true;
 }
@@ -3385,6 +3273,7 @@ bool effect_handler_EARTHQUAKE(effect_handler_context_t *context)
 
 					/* Apply damage directly */
 					mon->hp -= damage;
+					rouse_monster(cave, mon);
 
 					/* Delete (not kill) "dead" monsters */
 					if (mon->hp < 0) {
@@ -4394,6 +4283,15 @@ static const char *effect_names[] = {
 void free_effect(struct effect *source)
 {
 	struct effect *e = source, *e_next;
+
+	/* A packed chain is one block */
+	if (source && source->packed) {
+		for (e = source; e; e = e->next)
+			dice_free(e->dice);
+		mem_free(source);
+		return;
+	}
+
 	while (e) {
 		e_next = e->next;
 		dice_free(e->dice);
@@ -4402,6 +4300,33 @@ void free_effect(struct effect *source)
 	}
 }
 
+/**
+ * Move an effect chain of more than one effect into one block, in order, so
+ * that running it walks straight through memory rather than about the heap.
+ * The chain must not be pointed to from anywhere else yet; the new head is
+ * returned, and free_effect() frees the block with it.
+ */
+struct effect *effect_chain_pack(struct effect *chain)
+{
+	struct effect *e, *next, *block;
+	size_t n = 0, i = 0;
+
+	for (e = chain; e; e = e->next)
+		n++;
+	if (n < 2 || chain->packed) return chain;
+
+	block = mem_alloc(n * sizeof(*block));
+	for (e = chain; e; e = next, i++) {
+		next = e->next;
+		block[i] = *e;
+		block[i].packed = true;
+		block[i].next = next ? &block[i + 1] : NULL;
+		mem_free(e);
+	}
+
+	return block;
+}
+
 bool effect_valid(struct effect *effect)
 {
 	if (!effect) return false;
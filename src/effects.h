@@ -35,6 +35,7 @@ typedef enum
 /*** Functions ***/
 
 void free_effect(struct effect *source);
+struct effect *effect_chain_pack(struct effect *chain);
 bool effect_valid(struct effect *effect);
 bool effect_aim(struct effect *effect);
 const char *effect_info(struct effect *effect);
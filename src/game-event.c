@@ -17,105 +17,133 @@
  */
 
 #include <assert.h>
+#include "cmd-record.h"
 #include "game-event.h"
 #include "object.h"
 #include "z-virt.h"
 
 struct event_handler_entry
 {
-	struct event_handler_entry *next;	
 	game_event_handler *fn;
 	void *user;
 };
 
-static struct event_handler_entry *event_handlers[N_GAME_EVENTS];
+/**
+ * The handlers for one event type, oldest first; they are called newest
+ * first, as they always have been.
+ */
+struct event_handler_list
+{
+	struct event_handler_entry *entries;
+	size_t count;
+	size_t alloc;
+};
+
+static struct event_handler_list event_handlers[N_GAME_EVENTS];
+
+/**
+ * Points signalled for a coalescing event type, waiting to go out as one
+ * batch.  `slots` is an open-addressed set of (y << 16 | x) + 1 so that
+ * each grid is only queued once.
+ */
+struct event_point_set
+{
+	bool coalesce;
+	struct loc *grids;
+	int count;
+	int alloc;
+	u32b *slots;
+	size_t n_slots;
+};
+
+static struct event_point_set event_points[N_GAME_EVENTS];
+static int event_points_pending = 0;
+
+static void event_queue_point(game_event_type type, int x, int y);
+static void event_flush_type(game_event_type type);
 
 static void game_event_dispatch(game_event_type type, game_event_data *data)
 {
-	struct event_handler_entry *this = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i;
+
+	/* Anything else that happens should see the map up to date */
+	if (event_points_pending)
+		event_flush_points();
+
+	if (!list->count) return;
 
 	/* 
-	 * Send the word out to all interested event handlers.
+	 * Send the word out to all interested event handlers.  Any questions
+	 * they ask are the front end's own, not the game's.
 	 */
-	while (this)
-	{
+	cmd_record_enter(false);
+	for (i = list->count; i > 0; i--) {
+		struct event_handler_entry *this = &list->entries[i - 1];
+
 		/* Call the handler with the relevant data */
 		this->fn(type, data, this->user);
-		this = this->next;
 	}
+	cmd_record_leave();
 }
 
 void event_add_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *new;
+	struct event_handler_list *list = &event_handlers[type];
 
 	assert(fn != NULL);
 
-	/* Make a new entry */
-	new = mem_alloc(sizeof *new);
-	new->fn = fn;
-	new->user = user;
+	if (list->count == list->alloc) {
+		list->alloc = list->alloc ? list->alloc * 2 : 4;
+		list->entries = mem_realloc(list->entries,
+									list->alloc * sizeof(*list->entries));
+	}
 
-	/* Add it to the head of the appropriate list */
-	new->next = event_handlers[type];
-	event_handlers[type] = new;
+	list->entries[list->count].fn = fn;
+	list->entries[list->count].user = user;
+	list->count++;
 }
 
 void event_remove_handler(game_event_type type, game_event_handler *fn, void *user)
 {
-	struct event_handler_entry *prev = NULL;
-	struct event_handler_entry *this = event_handlers[type];
+	struct event_handler_list *list = &event_handlers[type];
+	size_t i;
+
+	/* Look for the entry, newest first as in dispatch */
+	for (i = list->count; i > 0; i--) {
+		struct event_handler_entry *this = &list->entries[i - 1];
 
-	/* Look for the entry in the list */
-	while (this)
-	{
 		/* Check if this is the entry we want to remove */
-		if (this->fn == fn && this->user == user)
-		{
-			if (!prev)
-			{
-				event_handlers[type] = this->next;
-			}
-			else
-			{
-				prev->next = this->next;
-			}
-
-			mem_free(this);
+		if (this->fn == fn && this->user == user) {
+			memmove(this, this + 1,
+					(list->count - i) * sizeof(*list->entries));
+			list->count--;
 			return;
 		}
-
-		prev = this;
-		this = this->next;
 	}
 }
 
 void event_remove_handler_type(game_event_type type)
 {
-	struct event_handler_entry *handler = event_handlers[type];
-
-	while (handler) {
-		struct event_handler_entry *next = handler->next;
-		mem_free(handler);
-		handler = next;
-	}
-	event_handlers[type] = NULL;
+	event_handlers[type].count = 0;
 }
 
 void event_remove_all_handlers(void)
 {
 	int type;
-	struct event_handler_entry *handler, *next;
 
 	for (type = 0; type < N_GAME_EVENTS; type++) {
-		handler = event_handlers[type];
-		while (handler) {
-			next = handler->next;
-			mem_free(handler);
-			handler = next;
-		}
-		event_handlers[type] = NULL;
+		struct event_point_set *set = &event_points[type];
+
+		mem_free(event_handlers[type].entries);
+		memset(&event_handlers[type], 0, sizeof(event_handlers[type]));
+
+		mem_free(set->grids);
+		mem_free(set->slots);
+		memset(set, 0, sizeof(*set));
 	}
+
+	event_points_pending = 0;
 }
 
 void event_add_handler_set(game_event_type *type, size_t n_types, game_event_handler *fn, void *user)
@@ -151,15 +179,140 @@ void event_signal_flag(game_event_type type, bool flag)
 }
 
 
+/**
+ * Signal a change at one grid, or at every grid with (-1, -1).  Whether or
+ * not the type is coalescing, handlers get data->points; when it isn't,
+ * they get a batch of the one grid straight away.
+ */
 void event_signal_point(game_event_type type, int x, int y)
 {
 	game_event_data data;
-	data.point.x = x;
-	data.point.y = y;
+	struct loc grid = loc(x, y);
+
+	if (event_points[type].coalesce) {
+		event_queue_point(type, x, y);
+		return;
+	}
 
+	memset(&data, 0, sizeof(data));
+	if (x == -1 && y == -1) {
+		data.points.all = true;
+	} else {
+		data.points.grids = &grid;
+		data.points.count = 1;
+	}
 	game_event_dispatch(type, &data);
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Coalescing of point events
+ * ------------------------------------------------------------------------ */
+
+/**
+ * Choose whether point signals of the given type are collected up and sent
+ * as batches.  Either way their handlers get data->points: a list of grids,
+ * or with `all` set, a request to redraw everything.
+ */
+void event_set_coalescing(game_event_type type, bool coalesce)
+{
+	if (!coalesce) event_flush_type(type);
+	event_points[type].coalesce = coalesce;
+}
+
+static void event_queue_point(game_event_type type, int x, int y)
+{
+	struct event_point_set *set = &event_points[type];
+	u32b key;
+	size_t i;
+
+	/* Everything at once makes anything waiting redundant */
+	if (x == -1 && y == -1) {
+		game_event_data data;
+
+		if (set->count) {
+			event_points_pending--;
+			set->count = 0;
+			memset(set->slots, 0, set->n_slots * sizeof(*set->slots));
+		}
+
+		memset(&data, 0, sizeof(data));
+		data.points.all = true;
+		game_event_dispatch(type, &data);
+		return;
+	}
+
+	/* Keep the set no more than half full */
+	if ((size_t)(set->count + 1) * 2 > set->n_slots) {
+		int j;
+
+		mem_free(set->slots);
+		set->n_slots = set->n_slots ? set->n_slots * 2 : 256;
+		set->slots = mem_zalloc(set->n_slots * sizeof(*set->slots));
+		for (j = 0; j < set->count; j++) {
+			key = ((u32b)set->grids[j].y << 16 | set->grids[j].x) + 1;
+			for (i = (key * 2654435761U) & (set->n_slots - 1); set->slots[i];
+				 i = (i + 1) & (set->n_slots - 1)) ;
+			set->slots[i] = key;
+		}
+	}
+
+	key = ((u32b)y << 16 | (u32b)x) + 1;
+	for (i = (key * 2654435761U) & (set->n_slots - 1); set->slots[i];
+		 i = (i + 1) & (set->n_slots - 1))
+		if (set->slots[i] == key) return;
+	set->slots[i] = key;
+
+	if (set->count == set->alloc) {
+		set->alloc = set->alloc ? set->alloc * 2 : 128;
+		set->grids = mem_realloc(set->grids, set->alloc * sizeof(*set->grids));
+	}
+	set->grids[set->count].x = x;
+	set->grids[set->count].y = y;
+	if (!set->count++)
+		event_points_pending++;
+}
+
+static void event_flush_type(game_event_type type)
+{
+	struct event_point_set *set = &event_points[type];
+	game_event_data data;
+
+	if (!set->count) return;
+
+	/* Take the batch off first, as handlers may signal more */
+	event_points_pending--;
+	memset(&data, 0, sizeof(data));
+	data.points.grids = set->grids;
+	data.points.count = set->count;
+	set->grids = NULL;
+	set->count = 0;
+	set->alloc = 0;
+	memset(set->slots, 0, set->n_slots * sizeof(*set->slots));
+
+	game_event_dispatch(type, &data);
+
+	/* Reuse the array unless a new one was started meanwhile */
+	if (!set->grids) {
+		set->grids = (struct loc *)data.points.grids;
+		set->alloc = data.points.count;
+	} else {
+		mem_free((void *)data.points.grids);
+	}
+}
+
+/**
+ * Send out every batch of points that is waiting.  This is done before any
+ * other event is dispatched, so handlers always see them in order, and
+ * once per handle_stuff().
+ */
+void event_flush_points(void)
+{
+	int type;
+
+	for (type = 0; event_points_pending && type < N_GAME_EVENTS; type++)
+		event_flush_type(type);
+}
 
 void event_signal_string(game_event_type type, const char *s)
 {
@@ -99,6 +99,13 @@ typedef union
 {
 	struct loc point;
 
+	struct
+	{
+		const struct loc *grids;
+		int count;
+		bool all;
+	} points;
+
 	const char *string;
 
 	bool flag;
@@ -177,6 +184,8 @@ void event_remove_handler_set(game_event_type *type, size_t n_types, game_event_
 void event_signal_birthpoints(int stats[6], int remaining);
 
 void event_signal_point(game_event_type, int x, int y);
+void event_set_coalescing(game_event_type type, bool coalesce);
+void event_flush_points(void);
 void event_signal_string(game_event_type, const char *s);
 void event_signal_message(game_event_type type, int t, const char *s);
 void event_signal_flag(game_event_type type, bool flag);
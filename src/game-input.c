@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "cmd-core.h"
+#include "cmd-record.h"
 #include "game-input.h"
 
 bool (*get_string_hook)(const char *prompt, char *buf, size_t len);
@@ -48,11 +49,21 @@ bool (*map_is_visible_hook)(void);
  */
 bool get_string(const char *prompt, char *buf, size_t len)
 {
+	bool ret = false;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer_string(&ret, buf, len))
+		return ret;
+
 	/* Ask the UI for it */
-	if (get_string_hook)
-		return get_string_hook(prompt, buf, len);
-	else
-		return false;
+	if (get_string_hook) {
+		cmd_record_enter(false);
+		ret = get_string_hook(prompt, buf, len);
+		cmd_record_leave();
+	}
+
+	cmd_record_answer_string(ret, buf);
+	return ret;
 }
 
 /**
@@ -64,11 +75,21 @@ bool get_string(const char *prompt, char *buf, size_t len)
  */
 int get_quantity(const char *prompt, int max)
 {
+	int amt = 0;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('q', &amt, 1))
+		return amt;
+
 	/* Ask the UI for it */
-	if (get_quantity_hook)
-		return get_quantity_hook(prompt, max);
-	else
-		return 0;
+	if (get_quantity_hook) {
+		cmd_record_enter(false);
+		amt = get_quantity_hook(prompt, max);
+		cmd_record_leave();
+	}
+
+	cmd_record_answer('q', &amt, 1);
+	return amt;
 }
 
 /**
@@ -82,11 +103,21 @@ int get_quantity(const char *prompt, int max)
  */
 bool get_check(const char *prompt)
 {
+	int answer = 0;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('y', &answer, 1))
+		return answer ? true : false;
+
 	/* Ask the UI for it */
-	if (get_check_hook)
-		return get_check_hook(prompt);
-	else
-		return false;
+	if (get_check_hook) {
+		cmd_record_enter(false);
+		answer = get_check_hook(prompt) ? 1 : 0;
+		cmd_record_leave();
+	}
+
+	cmd_record_answer('y', &answer, 1);
+	return answer ? true : false;
 }
 
 /**
@@ -98,11 +129,24 @@ bool get_check(const char *prompt)
  */
 bool get_com(const char *prompt, char *command)
 {
+	int answer[2] = { 0, 0 };
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('k', answer, 2)) {
+		if (answer[0]) *command = (char)answer[1];
+		return answer[0] ? true : false;
+	}
+
 	/* Ask the UI for it */
-	if (get_com_hook)
-		return get_com_hook(prompt, command);
-	else
-		return false;
+	if (get_com_hook) {
+		cmd_record_enter(false);
+		answer[0] = get_com_hook(prompt, command) ? 1 : 0;
+		cmd_record_leave();
+		answer[1] = answer[0] ? (unsigned char)*command : 0;
+	}
+
+	cmd_record_answer('k', answer, 2);
+	return answer[0] ? true : false;
 }
 
 
@@ -115,11 +159,24 @@ bool get_com(const char *prompt, char *command)
  */
 bool get_rep_dir(int *dir, bool allow_none)
 {
+	int answer[2] = { 0, 0 };
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('d', answer, 2)) {
+		if (answer[0]) *dir = answer[1];
+		return answer[0] ? true : false;
+	}
+
 	/* Ask the UI for it */
-	if (get_rep_dir_hook)
-		return get_rep_dir_hook(dir, allow_none);
-	else
-		return false;
+	if (get_rep_dir_hook) {
+		cmd_record_enter(false);
+		answer[0] = get_rep_dir_hook(dir, allow_none) ? 1 : 0;
+		cmd_record_leave();
+		answer[1] = answer[0] ? *dir : 0;
+	}
+
+	cmd_record_answer('d', answer, 2);
+	return answer[0] ? true : false;
 }
 
 /**
@@ -130,11 +187,24 @@ bool get_rep_dir(int *dir, bool allow_none)
  */
 bool get_aim_dir(int *dir)
 {
+	int answer[2] = { 0, 0 };
+
+	/* Play it back if there's a record, along with any target chosen */
+	if (cmd_replay_answer('t', answer, 2)) {
+		if (answer[0]) *dir = answer[1];
+		return answer[0] ? true : false;
+	}
+
 	/* Ask the UI for it */
-	if (get_aim_dir_hook)
-		return get_aim_dir_hook(dir);
-	else
-		return false;
+	if (get_aim_dir_hook) {
+		cmd_record_enter(false);
+		answer[0] = get_aim_dir_hook(dir) ? 1 : 0;
+		cmd_record_leave();
+		answer[1] = answer[0] ? *dir : 0;
+	}
+
+	cmd_record_answer('t', answer, 2);
+	return answer[0] ? true : false;
 }
 
 /**
@@ -143,11 +213,21 @@ bool get_aim_dir(int *dir)
 int get_spell_from_book(const char *verb, struct object *book,
 		const char *error, bool (*spell_filter)(int spell))
 {
+	int spell = -1;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('p', &spell, 1))
+		return spell;
+
 	/* Ask the UI for it */
-	if (get_spell_from_book_hook)
-		return get_spell_from_book_hook(verb, book, error, spell_filter);
-	else
-		return -1;
+	if (get_spell_from_book_hook) {
+		cmd_record_enter(false);
+		spell = get_spell_from_book_hook(verb, book, error, spell_filter);
+		cmd_record_leave();
+	}
+
+	cmd_record_answer('p', &spell, 1);
+	return spell;
 }
 
 /**
@@ -157,11 +237,21 @@ int get_spell(const char *verb, item_tester book_filter,
 						cmd_code cmd, const char *error,
 						bool (*spell_filter)(int spell))
 {
+	int spell = -1;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('p', &spell, 1))
+		return spell;
+
 	/* Ask the UI for it */
-	if (get_spell_hook)
-		return get_spell_hook(verb, book_filter, cmd, error, spell_filter);
-	else
-		return -1;
+	if (get_spell_hook) {
+		cmd_record_enter(false);
+		spell = get_spell_hook(verb, book_filter, cmd, error, spell_filter);
+		cmd_record_leave();
+	}
+
+	cmd_record_answer('p', &spell, 1);
+	return spell;
 }
 
 /**
@@ -182,11 +272,21 @@ int get_spell(const char *verb, item_tester book_filter,
 bool get_item(struct object **choice, const char *pmt, const char *str,
 			  cmd_code cmd, item_tester tester, int mode)
 {
+	bool ret = false;
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer_item(&ret, choice))
+		return ret;
+
 	/* Ask the UI for it */
-	if (get_item_hook)
-		return get_item_hook(choice, pmt, str, cmd, tester, mode);
-	else
-		return false;
+	if (get_item_hook) {
+		cmd_record_enter(false);
+		ret = get_item_hook(choice, pmt, str, cmd, tester, mode);
+		cmd_record_leave();
+	}
+
+	cmd_record_answer_item(ret, ret ? *choice : NULL);
+	return ret;
 }
 
 /**
@@ -194,11 +294,24 @@ bool get_item(struct object **choice, const char *pmt, const char *str,
  */
 bool get_curse(int *choice, struct object *obj)
 {
+	int answer[2] = { 0, 0 };
+
+	/* Play it back if there's a record */
+	if (cmd_replay_answer('u', answer, 2)) {
+		if (answer[0]) *choice = answer[1];
+		return answer[0] ? true : false;
+	}
+
 	/* Ask the UI for it */
-	if (get_curse_hook)
-		return get_curse_hook(choice, obj);
-	else
-		return false;
+	if (get_curse_hook) {
+		cmd_record_enter(false);
+		answer[0] = get_curse_hook(choice, obj) ? 1 : 0;
+		cmd_record_leave();
+		answer[1] = answer[0] ? *choice : 0;
+	}
+
+	cmd_record_answer('u', answer, 2);
+	return answer[0] ? true : false;
 }
 
 /**
@@ -17,6 +17,7 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
 #include "cmds.h"
 #include "effects.h"
 #include "game-world.h"
@@ -34,6 +35,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "profile.h"
 #include "source.h"
 #include "target.h"
 #include "trap.h"
@@ -45,6 +47,7 @@ u32b seed_flavor;		/* Hack -- consistent object colors */
 s32b turn;				/* Current game turn */
 bool character_generated;	/* The character exists */
 bool character_dungeon;		/* The character has a dungeon */
+bool game_headless;		/* Nothing is displayed, so never redraw */
 
 /**
  * This table allows quick conversion from "speed" to "energy"
@@ -174,6 +177,9 @@ static void recharge_objects(void)
 		/* Skip non-objects */
 		assert(obj->kind);
 
+		/* Most objects have nothing charging */
+		if (!obj->timeout) continue;
+
 		/* Recharge equipment */
 		if (object_is_equipped(player->body, obj)) {
 			/* Recharge activatable objects */
@@ -184,13 +190,13 @@ static void recharge_objects(void)
 				/* Window stuff */
 				player->upkeep->redraw |= (PR_EQUIP);
 			}
-		} else {
+		} else if (tval_can_have_timeout(obj)) {
 			/* Recharge the inventory */
 			discharged_stack =
 				(number_charging(obj) == obj->number) ? true : false;
 
 			/* Recharge rods, and update if any rods are recharged */
-			if (tval_can_have_timeout(obj) && recharge_timeout(obj)) {
+			if (recharge_timeout(obj)) {
 				/* Entire stack is recharged */
 				if (obj->timeout == 0)
 					recharged_notice(obj, true);
@@ -214,7 +220,7 @@ static void recharge_objects(void)
 		if (!obj) continue;
 
 		/* Recharge rods */
-		if (tval_can_have_timeout(obj))
+		if (obj->timeout && tval_can_have_timeout(obj))
 			recharge_timeout(obj);
 	}
 }
@@ -305,6 +311,130 @@ static void decrease_timeouts(void)
 }
 
 
+/**
+ * A grid to spread noise from, with the noise it should get
+ */
+struct noise_seed {
+	int grid;
+	int noise;
+};
+
+static int cmp_noise_seed(const void *a, const void *b)
+{
+	const struct noise_seed *sa = a, *sb = b;
+	return sa->noise - sb->noise;
+}
+
+/**
+ * Distance of a grid from the player in the noise field, or -1 if noise
+ * doesn't reach it
+ */
+static int noise_dist(struct chunk *c, struct player *p, int y, int x)
+{
+	if (y == p->py && x == p->px) return 0;
+	return c->noise.grids[y][x] ? c->noise.grids[y][x] : -1;
+}
+
+/**
+ * Bring the noise field up to date after the grids in `opened` have started
+ * carrying noise.  Opening grids can only bring other grids closer to the
+ * player, so this lowers noise values outwards from the opened grids,
+ * handling grids in order of their new noise just as a full rebuild would,
+ * and gives exactly the field make_noise() would have made from scratch.
+ */
+static void spread_noise(struct chunk *c, struct player *p,
+						 struct point_set *opened)
+{
+	int area = c->height * c->width;
+	struct noise_seed *seeds = mem_zalloc(point_set_size(opened) *
+										  sizeof(*seeds));
+	int *queue = mem_zalloc(area * sizeof(int));
+	int n = 0, s = 0, head = 0, tail = 0;
+	int i, d;
+
+	/* Work out what noise each opened grid would hear from its neighbours */
+	for (i = 0; i < point_set_size(opened); i++) {
+		int y = opened->pts[i].y, x = opened->pts[i].x;
+		int best = -1, old;
+
+		if (!square_in_bounds(c, y, x)) continue;
+		if (square_isnoflow(c, y, x)) continue;
+		if (y == p->py && x == p->px) continue;
+
+		for (d = 0; d < 8; d++) {
+			int adj_y = y + ddy_ddd[d];
+			int adj_x = x + ddx_ddd[d];
+			int dist;
+
+			if (!square_in_bounds(c, adj_y, adj_x)) continue;
+			dist = noise_dist(c, p, adj_y, adj_x);
+			if (dist >= 0 && (best < 0 || dist < best))
+				best = dist;
+		}
+		if (best < 0) continue;
+
+		old = noise_dist(c, p, y, x);
+		if (old >= 0 && old <= best + 1) continue;
+
+		seeds[n].grid = yx_to_i(y, x, c->width);
+		seeds[n].noise = best + 1;
+		n++;
+	}
+	sort(seeds, n, sizeof(*seeds), cmp_noise_seed);
+
+	/* Spread outwards, always from the grid with the least noise */
+	while (s < n || head < tail) {
+		int next_y, next_x, noise;
+
+		if (s < n) {
+			bool use_seed = (head == tail);
+
+			if (!use_seed) {
+				i_to_yx(queue[head], c->width, &next_y, &next_x);
+				use_seed = seeds[s].noise <= c->noise.grids[next_y][next_x];
+			}
+
+			if (use_seed) {
+				int old;
+
+				i_to_yx(seeds[s].grid, c->width, &next_y, &next_x);
+				noise = seeds[s++].noise;
+				old = noise_dist(c, p, next_y, next_x);
+				if (old >= 0 && old <= noise) continue;
+				c->noise.grids[next_y][next_x] = noise;
+				rouse_monster_at(c, next_y, next_x);
+			} else {
+				noise = c->noise.grids[next_y][next_x];
+				head++;
+			}
+		} else {
+			i_to_yx(queue[head++], c->width, &next_y, &next_x);
+			noise = c->noise.grids[next_y][next_x];
+		}
+
+		for (d = 0; d < 8; d++) {
+			int y = next_y + ddy_ddd[d];
+			int x = next_x + ddx_ddd[d];
+			int old;
+
+			if (!square_in_bounds(c, y, x)) continue;
+			if (square_isnoflow(c, y, x)) continue;
+			if (y == p->py && x == p->px) continue;
+
+			old = noise_dist(c, p, y, x);
+			if (old >= 0 && old <= noise + 1) continue;
+
+			c->noise.grids[y][x] = noise + 1;
+			rouse_monster_at(c, y, x);
+			if (tail < area)
+				queue[tail++] = yx_to_i(y, x, c->width);
+		}
+	}
+
+	mem_free(queue);
+	mem_free(seeds);
+}
+
 /**
  * Every turn, the character makes enough noise that nearby monsters can use
  * it to home in.
@@ -320,22 +450,39 @@ static void decrease_timeouts(void)
  * values, thereby homing in on the player even though twisty tunnels and
  * mazes.  Monsters have a hearing value, which is the largest sound value
  * they can detect.
+ *
+ * The field only depends on where the player is and which grids carry
+ * noise, so it is left alone while neither changes, and grids opened up by
+ * tunnelling and the like are just spread out from (see spread_noise()).
+ * Any other change means the whole field is made again.
  */
-static void make_noise(struct player *p)
+void make_noise(struct player *p)
 {
 	int next_y = p->py;
 	int next_x = p->px;
 	int y, x, d;
 	int noise = 0;
-    struct queue *queue = q_new(cave->height * cave->width);
+	struct queue *queue;
+
+	PROFILE_ENTER(PROF_NOISE);
 
-	/* Set all the grids to silence */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			cave->noise.grids[y][x] = 0;
+	/* The old field may still be good */
+	if (cave->noise_origin.x == p->px && cave->noise_origin.y == p->py) {
+		if (cave->noise_opened) {
+			spread_noise(cave, p, cave->noise_opened);
+			point_set_dispose(cave->noise_opened);
+			cave->noise_opened = NULL;
 		}
+		PROFILE_LEAVE(PROF_NOISE);
+		return;
 	}
 
+	queue = q_new(cave->height * cave->width);
+
+	/* Set all the grids to silence; the rows are one block (see chunk_new()) */
+	memset(cave->noise.grids[0], 0,
+		   cave->height * cave->width * sizeof(cave->noise.grids[0][0]));
+
 	/* Player makes noise */
 	cave->noise.grids[next_y][next_x] = noise;
 	q_push_int(queue, yx_to_i(next_y, next_x, cave->width));
@@ -369,8 +516,9 @@ static void make_noise(struct player *p)
 			/* Skip the player grid */
 			if (y == player->py && x == player->px) continue;
 
-			/* Save the noise */
+			/* Save the noise, and let any dormant monster hear it */
 			cave->noise.grids[y][x] = noise;
+			rouse_monster_at(cave, y, x);
 
 			/* Enqueue that entry */
 			q_push_int(queue, yx_to_i(y, x, cave->width));
@@ -378,6 +526,15 @@ static void make_noise(struct player *p)
 	}
 
 	q_free(queue);
+
+	/* Remember where this field is from */
+	cave->noise_origin = loc(p->px, p->py);
+	if (cave->noise_opened) {
+		point_set_dispose(cave->noise_opened);
+		cave->noise_opened = NULL;
+	}
+
+	PROFILE_LEAVE(PROF_NOISE);
 }
 
 /**
@@ -393,6 +550,9 @@ static void make_noise(struct player *p)
  * value which indicates the oldest scent they can detect.  Grids where the
  * player has never been will have scent 0.  The player's grid will also have
  * scent 0, but this is OK as no monster will ever be smelling it.
+ *
+ * Ageing is done by advancing the chunk's scent clock, as each grid holds
+ * the clock reading its scent was laid at rather than the age itself.
  */
 static void update_scent(void)
 {
@@ -405,14 +565,19 @@ static void update_scent(void)
 		{2, 2, 2, 2, 2},
 	};
 
-	/* Update scent for all grids */
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			if (cave->scent.grids[y][x] > 0) {
-				cave->scent.grids[y][x]++;
+	/* Age all the scent, winding the clock back if it is about to run out */
+	if (cave->scent_clock >= SCENT_CLOCK_MAX) {
+		for (y = 0; y < cave->height; y++) {
+			for (x = 0; x < cave->width; x++) {
+				int age = square_scent(cave, y, x);
+				if (!age) continue;
+				age = MIN(age, SCENT_CLOCK_MIN - 1);
+				cave->scent.grids[y][x] = SCENT_CLOCK_MIN - age;
 			}
 		}
+		cave->scent_clock = SCENT_CLOCK_MIN;
 	}
+	cave->scent_clock++;
 
 	/* Lay down new scent around the player */
 	for (y = 0; y < 5; y++) {
@@ -442,7 +607,7 @@ static void update_scent(void)
 				}
 
 				/* Adjacent to a closer grid, so valid */
-				if (cave->scent.grids[adj_y][adj_x] == new_scent - 1) {
+				if (square_scent(cave, adj_y, adj_x) == new_scent - 1) {
 					add_scent = true;
 				}
 			}
@@ -453,7 +618,9 @@ static void update_scent(void)
 			}
 
 			/* Mark the scent */
-			cave->scent.grids[scent_y][scent_x] = new_scent;
+			cave->scent.grids[scent_y][scent_x] =
+				new_scent ? cave->scent_clock - new_scent : 0;
+			rouse_monster_at(cave, scent_y, scent_x);
 		}
 	}
 }
@@ -465,6 +632,8 @@ void process_world(struct chunk *c)
 {
 	int i, y, x;
 
+	PROFILE_ENTER(PROF_WORLD);
+
 	/* Compact the monster list if we're approaching the limit */
 	if (cave_monster_count(cave) + 32 > z_info->level_monster_max)
 		compact_monsters(64);
@@ -621,17 +790,20 @@ void process_world(struct chunk *c)
 	if (!(turn % 100))
 		equip_learn_after_time(player);
 
-	/* Decrease trap timeouts */
-	for (y = 0; y < cave->height; y++) {
-		for (x = 0; x < cave->width; x++) {
-			struct trap *trap = cave->squares[y][x].trap;
-			while (trap) {
-				if (trap->timeout) {
-					trap->timeout--;
-					if (!trap->timeout)
-						square_light_spot(cave, y, x);
+	/* Decrease trap timeouts, if any can still be running */
+	if (cave->trap_timeouts) {
+		cave->trap_timeouts--;
+		for (y = 0; y < cave->height; y++) {
+			for (x = 0; x < cave->width; x++) {
+				struct trap *trap = cave->squares[y][x].trap;
+				while (trap) {
+					if (trap->timeout) {
+						trap->timeout--;
+						if (!trap->timeout)
+							square_light_spot(cave, y, x);
+					}
+					trap = trap->next;
 				}
-				trap = trap->next;
 			}
 		}
 	}
@@ -696,6 +868,8 @@ void process_world(struct chunk *c)
 			}
 		}
 	}
+
+	PROFILE_LEAVE(PROF_WORLD);
 }
 
 
@@ -778,9 +952,13 @@ static void process_player_cleanup(void)
  */
 void process_player(void)
 {
+	bool got_cmd;
+
+	PROFILE_ENTER(PROF_PLAYER);
+
 	/* Check for interrupts */
 	player_resting_complete_special(player);
-	event_signal(EVENT_CHECK_INTERRUPT);
+	cmd_record_interrupt();
 
 	/* Repeat until energy is reduced */
 	do {
@@ -824,8 +1002,12 @@ void process_player(void)
 			event_signal(EVENT_REFRESH);
 		}
 
-		/* Get a command from the queue if there is one */
-		if (!cmdq_pop(CMD_GAME))
+		/* Get a command from the queue if there is one, and do all the
+		 * updates and redraws it asks for once it has finished */
+		defer_stuff(player);
+		got_cmd = cmdq_pop(CMD_GAME);
+		undefer_stuff(player);
+		if (!got_cmd)
 			break;
 
 		if (!player->upkeep->playing)
@@ -838,6 +1020,8 @@ void process_player(void)
 
 	/* Notice stuff (if needed) */
 	notice_stuff(player);
+
+	PROFILE_LEAVE(PROF_PLAYER);
 }
 
 /**
@@ -895,6 +1079,9 @@ void on_new_level(void)
  * Housekeeping on leaving a level
  */
 static void on_leave_level(void) {
+	/* Bring the monsters up to date */
+	unschedule_monsters(cave);
+
 	/* Any pending processing */
 	notice_stuff(player);
 	update_stuff(player);
@@ -905,6 +1092,18 @@ static void on_leave_level(void) {
 }
 
 
+/**
+ * Bring the player and the display up to date between the parts of a turn
+ */
+static void refresh_stuff(void)
+{
+	PROFILE_BEGIN("refresh");
+	notice_stuff(player);
+	handle_stuff(player);
+	event_signal(EVENT_REFRESH);
+	PROFILE_END("refresh");
+}
+
 /**
  * The main game loop.
  *
@@ -951,9 +1150,7 @@ void run_game_loop(void)
 	/* Now that the player's turn is fully complete, we run the main loop 
 	 * until player input is needed again */
 	while (true) {
-		notice_stuff(player);
-		handle_stuff(player);
-		event_signal(EVENT_REFRESH);
+		refresh_stuff();
 
 		/* Process the rest of the world, give the player energy and 
 		 * increment the turn counter unless we need to stop playing or
@@ -968,9 +1165,7 @@ void run_game_loop(void)
 			reset_monsters();
 
 			/* Refresh */
-			notice_stuff(player);
-			handle_stuff(player);
-			event_signal(EVENT_REFRESH);
+			refresh_stuff();
 			if (player->is_dead || !player->upkeep->playing)
 				return;
 
@@ -979,9 +1174,7 @@ void run_game_loop(void)
 				process_world(cave);
 
 				/* Refresh */
-				notice_stuff(player);
-				handle_stuff(player);
-				event_signal(EVENT_REFRESH);
+				refresh_stuff();
 				if (player->is_dead || !player->upkeep->playing)
 					return;
 			}
@@ -991,15 +1184,18 @@ void run_game_loop(void)
 
 			/* Count game turns */
 			turn++;
+			profile_metrics_turn();
 		}
 
 		/* Make a new level if requested */
 		if (player->upkeep->generate_level) {
+			PROFILE_BEGIN("change level");
 			if (character_dungeon)
 				on_leave_level();
 
 			cave_generate(&cave, player);
 			on_new_level();
+			PROFILE_END("change level");
 
 			player->upkeep->generate_level = false;
 		}
@@ -27,11 +27,13 @@ extern u32b seed_flavor;
 extern s32b turn;
 extern bool character_generated;
 extern bool character_dungeon;
+extern bool game_headless;
 extern const byte extract_energy[200];
 
 bool is_daytime(void);
 int turn_energy(int speed);
 void play_ambient_sound(void);
+void make_noise(struct player *p);
 void process_world(struct chunk *c);
 void on_new_level(void);
 void process_player(void);
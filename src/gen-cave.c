@@ -92,6 +92,7 @@ static bool square_is_granite_with_flag(struct chunk *c, int y, int x, int flag)
 /**
  * Places a streamer of rock through dungeon.
  *
+ * \param dun is the current generation data
  * \param c is the current chunk
  * \param feat is the base feature (FEAT_MAGMA or FEAT_QUARTZ)
  * \param chance is the number of regular features per one gold
@@ -101,11 +102,14 @@ static bool square_is_granite_with_flag(struct chunk *c, int y, int x, int flag)
  * with hidden gold, and one with known gold. The hidden gold types are
  * currently unused.
  */
-static void build_streamer(struct chunk *c, int feat, int chance)
+static void build_streamer(struct dun_data *dun, struct chunk *c, int feat,
+						   int chance)
 {
     int i, tx, ty;
     int y, x, dir;
 
+    GEN_STAGE_ENTER(GEN_STAGE_STREAMERS);
+
     /* Hack -- Choose starting point */
     y = rand_spread(c->height / 2, 10);
     x = rand_spread(c->width / 2, 15);
@@ -139,12 +143,15 @@ static void build_streamer(struct chunk *c, int feat, int chance)
 		/* Stop at dungeon edge */
 		if (!square_in_bounds(c, y, x)) break;
     }
+
+    GEN_STAGE_LEAVE(GEN_STAGE_STREAMERS);
 }
 
 
 /**
  * Constructs a tunnel between two points
  *
+ * \param dun is the current generation data
  * \param c is the current chunk
  * \param row1 are the co-ordinates of the first point
  * \param col1 are the co-ordinates of the first point
@@ -168,7 +175,8 @@ static void build_streamer(struct chunk *c, int feat, int chance)
  * The solid wall check prevents corridors from chopping the corners of rooms
  * off, as well as silly door placement, and excessively wide room entrances.
  */
-static void build_tunnel(struct chunk *c, int row1, int col1, int row2, int col2)
+static void build_tunnel(struct dun_data *dun, struct chunk *c, int row1,
+						 int col1, int row2, int col2)
 {
     int i, y, x;
     int tmp_row, tmp_col;
@@ -178,6 +186,8 @@ static void build_tunnel(struct chunk *c, int row1, int col1, int row2, int col2
 
     /* Used to prevent excessive door creation along overlapping corridors. */
     bool door_flag = false;
+
+    GEN_STAGE_ENTER(GEN_STAGE_TUNNELS);
 	
     /* Reset the arrays */
     dun->tunn_n = 0;
@@ -350,6 +360,8 @@ static void build_tunnel(struct chunk *c, int row1, int col1, int row2, int col2
 		if (randint0(100) < dun->profile->tun.pen)
 			place_random_door(c, y, x);
     }
+
+    GEN_STAGE_LEAVE(GEN_STAGE_TUNNELS);
 }
 
 /**
@@ -407,11 +419,12 @@ static bool possible_doorway(struct chunk *c, int y, int x)
 
 /**
  * Places door or trap at y, x position if at least 2 walls found
+ * \param dun is the current generation data
  * \param c is the current chunk
  * \param y are the co-ordinates
  * \param x are the co-ordinates
  */
-static void try_door(struct chunk *c, int y, int x)
+static void try_door(struct dun_data *dun, struct chunk *c, int y, int x)
 {
     assert(square_in_bounds(c, y, x));
 
@@ -429,10 +442,11 @@ static void try_door(struct chunk *c, int y, int x)
 
 /**
  * Generate a new dungeon level.
+ * \param dun is the current generation data
  * \param p is the player 
  * \return a pointer to the generated chunk
  */
-struct chunk *classic_gen(struct player *p) {
+struct chunk *classic_gen(struct dun_data *dun, struct player *p) {
     int i, j, k, y, x, y1, x1;
     int by, bx = 0, tby, tbx, key, rarity, built;
     int num_rooms, size_percent;
@@ -536,7 +550,7 @@ struct chunk *classic_gen(struct player *p) {
 			if (profile.rarity > rarity) continue;
 			if (profile.cutoff <= key) continue;
 			
-			if (room_build(c, by, bx, profile, false)) {
+			if (room_build(dun, c, by, bx, profile, false)) {
 				built++;
 				break;
 			}
@@ -576,7 +590,7 @@ struct chunk *classic_gen(struct player *p) {
     /* Connect all the rooms together */
     for (i = 0; i < dun->cent_n; i++) {
 		/* Connect the room to the previous room */
-		build_tunnel(c, dun->cent[i].y, dun->cent[i].x, y, x);
+		build_tunnel(dun, c, dun->cent[i].y, dun->cent[i].x, y, x);
 
 		/* Remember the "previous" room */
 		y = dun->cent[i].y;
@@ -590,21 +604,21 @@ struct chunk *classic_gen(struct player *p) {
 		x = dun->door[i].x;
 
 		/* Try placing doors */
-		try_door(c, y, x - 1);
-		try_door(c, y, x + 1);
-		try_door(c, y - 1, x);
-		try_door(c, y + 1, x);
+		try_door(dun, c, y, x - 1);
+		try_door(dun, c, y, x + 1);
+		try_door(dun, c, y - 1, x);
+		try_door(dun, c, y + 1, x);
     }
 
     ensure_connectedness(c);
 
     /* Add some magma streamers */
     for (i = 0; i < dun->profile->str.mag; i++)
-		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
+		build_streamer(dun, c, FEAT_MAGMA, dun->profile->str.mc);
 
     /* Add some quartz streamers */
     for (i = 0; i < dun->profile->str.qua; i++)
-		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
+		build_streamer(dun, c, FEAT_QUARTZ, dun->profile->str.qc);
 
     /* Place 3 or 4 down stairs near some walls */
     alloc_stairs(c, FEAT_MORE, rand_range(3, 4), 3);
@@ -817,13 +831,14 @@ struct chunk *labyrinth_chunk(int depth, int h, int w, bool lit, bool soft)
 
 /**
  * Build a labyrinth level.
+ * \param dun is the current generation data
  * \param p is the player
  * Note that if the function returns false, a level wasn't generated.
  * Labyrinths use the dungeon level's number to determine whether to generate
  * themselves (which means certain level numbers are more likely to generate
  * labyrinths than others).
  */
-struct chunk *labyrinth_gen(struct player *p) {
+struct chunk *labyrinth_gen(struct dun_data *dun, struct player *p) {
     int i, k, y, x;
 	struct chunk *c;
 
@@ -920,59 +935,94 @@ static void init_cavern(struct chunk *c, int density) {
 }
 
 /**
- * Return the number of walls (0-8) adjacent to this square.
- * \param c is the current chunk
- * \param y are the co-ordinates
- * \param x are the co-ordinates
+ * Add a bit to each of 32 counters held across four words, bit by bit: bit
+ * x of s[0] is the lowest bit of counter x, and so on up to s[3].
+ * \param s are the counter words
+ * \param bits has a bit set for each counter to add one to
  */
-static int count_adj_walls(struct chunk *c, int y, int x) {
-    int yd, xd;
-    int count = 0;
-
-    for (yd = -1; yd <= 1; yd++) {
-		for (xd = -1; xd <= 1; xd++) {
-			if (yd == 0 && xd == 0) continue;
-			if (square_isfloor(c, y + yd, x + xd)) continue;
-			count++;
-		}
-    }
-
-    return count;
+static void add_bits(u32b s[4], u32b bits) {
+    u32b carry0 = s[0] & bits;
+    u32b carry1 = s[1] & carry0;
+    u32b carry2 = s[2] & carry1;
+
+    s[0] ^= bits;
+    s[1] ^= carry0;
+    s[2] ^= carry1;
+    s[3] |= carry2;
 }
 
 /**
  * Run a single pass of the cellular automata rules (4,5) on the dungeon.
  * \param c is the chunk being mutated
+ *
+ * Rows are packed into words with a bit set for each floor, so that the
+ * floors next to 32 squares are counted at once.  A square with more than
+ * five walls next to it (fewer than three floors) becomes granite, with
+ * fewer than four (more than four floors) becomes floor, and otherwise stays
+ * as it is.  Only the squares which change are written back.
  */
-static void mutate_cavern(struct chunk *c) {
-    int y, x;
+void mutate_cavern(struct chunk *c) {
+    int y, x, i;
     int h = c->height;
     int w = c->width;
+    int stride = (w + 31) / 32;
 
-    int *temp = mem_zalloc(h * w * sizeof(int));
+    u32b *floors = mem_zalloc(h * stride * sizeof(u32b));
+    u32b *next = mem_zalloc(h * stride * sizeof(u32b));
+
+    for (y = 0; y < h; y++)
+		for (x = 0; x < w; x++)
+			if (square_isfloor(c, y, x))
+				floors[y * stride + (x >> 5)] |= 1UL << (x & 31);
 
     for (y = 1; y < h - 1; y++) {
-		for (x = 1; x < w - 1; x++) {
-			int count = count_adj_walls(c, y, x);
-			if (count > 5)
-				temp[y * w + x] = FEAT_GRANITE;
-			else if (count < 4)
-				temp[y * w + x] = FEAT_FLOOR;
-			else
-				temp[y * w + x] = c->squares[y][x].feat;
+		for (i = 0; i < stride; i++) {
+			u32b count[4] = { 0, 0, 0, 0 };
+			u32b old = floors[y * stride + i];
+			u32b fewer_than_three, more_than_four, now;
+			u32b inside = 0xFFFFFFFFUL;
+			int yd;
+
+			for (yd = -1; yd <= 1; yd++) {
+				u32b *row = &floors[(y + yd) * stride];
+				u32b west = (row[i] << 1) | (i > 0 ? row[i - 1] >> 31 : 0);
+				u32b east = (row[i] >> 1) |
+					(i < stride - 1 ? row[i + 1] << 31 : 0);
+
+				add_bits(count, west);
+				add_bits(count, east);
+				if (yd) add_bits(count, row[i]);
+			}
+
+			fewer_than_three = ~(count[3] | count[2]) & ~(count[1] & count[0]);
+			more_than_four = count[3] | (count[2] & (count[1] | count[0]));
+
+			now = (old | more_than_four) & ~fewer_than_three;
+
+			/* The outer squares never change */
+			if (i == 0) inside &= ~1UL;
+			if (i == stride - 1) inside &= (1UL << ((w - 1) & 31)) - 1;
+
+			next[y * stride + i] = (now & inside) | (old & ~inside);
 		}
     }
 
     for (y = 1; y < h - 1; y++) {
 		for (x = 1; x < w - 1; x++) {
-			if (temp[y * w + x] == FEAT_GRANITE)
-				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+			int n = y * stride + (x >> 5);
+			u32b bit = 1UL << (x & 31);
+
+			if (!((floors[n] ^ next[n]) & bit)) continue;
+
+			if (next[n] & bit)
+				square_set_feat(c, y, x, FEAT_FLOOR);
 			else
-				square_set_feat(c, y, x, temp[y * w + x]);
+				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
 		}
     }
 
-    mem_free(temp);
+    mem_free(floors);
+    mem_free(next);
 }
 
 /**
@@ -1019,57 +1069,19 @@ static void glow_point(struct chunk *c, int y, int x) {
 #endif
 
 /**
- * Color a particular point, and all adjacent points.
- * \param c is the current chunk
- * \param colors is the array of current point colors
- * \param counts is the array of current color counts
- * \param y are the co-ordinates
- * \param x are the co-ordinates
- * \param color is the color we are coloring
- * \param diagonal controls whether we can progress diagonally
+ * Find the set a square or color belongs to.
+ * \param parents is the disjoint set forest; each set is a tree whose root is
+ * its own parent
+ * \param n is the square or color
+ *
+ * Paths are halved on the way up, so they stay short however sets are joined.
  */
-static void build_color_point(struct chunk *c, int colors[], int counts[], int y, int x, int color, bool diagonal) {
-    int h = c->height;
-    int w = c->width;
-    int size = h * w;
-    struct queue *queue = q_new(size);
-
-    int dslimit = diagonal ? 8 : 4;
-
-    int *added = mem_zalloc(size * sizeof(int));
-    array_filler(added, 0, size);
-
-    q_push_int(queue, yx_to_i(y, x, w));
-
-    counts[color] = 0;
-
-    while (q_len(queue) > 0) {
-		int i, y2, x2;
-		int n2 = q_pop_int(queue);
-
-		i_to_yx(n2, w, &y2, &x2);
-
-		if (ignore_point(c, colors, y2, x2)) continue;
-
-		colors[n2] = color;
-		counts[color]++;
-
-		/*if (lit) glow_point(c, y2, x2);*/
-
-		for (i = 0; i < dslimit; i++) {
-			int y3 = y2 + yds[i];
-			int x3 = x2 + xds[i];
-			int n3 = yx_to_i(y3, x3, w);
-			if (ignore_point(c, colors, y3, x3)) continue;
-			if (added[n3]) continue;
-
-			q_push_int(queue, n3);
-			added[n3] = 1;
-		}
+static int find_set(int parents[], int n) {
+    while (parents[n] != n) {
+		parents[n] = parents[parents[n]];
+		n = parents[n];
     }
-
-    mem_free(added);
-    q_free(queue);
+    return n;
 }
 
 /**
@@ -1077,21 +1089,74 @@ static void build_color_point(struct chunk *c, int colors[], int counts[], int y
  * \param c is the current chunk
  * \param colors is the array of current point colors
  * \param counts is the array of current color counts
+ * \param parents is the disjoint set forest over colors
  * \param diagonal controls whether we can progress diagonally
+ *
+ * Each open square is put in a set of its own, and joined to the sets of the
+ * open squares before it and next to it.  Sets keep their first square as
+ * root, so the regions get colors in the order a row-by-row scan first finds
+ * them, and each square can take its color from its root.
  */
-static void build_colors(struct chunk *c, int colors[], int counts[], bool diagonal) {
-    int y, x;
+static void build_colors(struct chunk *c, int colors[], int counts[],
+						 int parents[], bool diagonal) {
+    int y, x, i;
     int h = c->height;
     int w = c->width;
+    int size = h * w;
     int color = 1;
 
+    /* The neighbours a row-by-row scan has already passed: W, N, NW, NE */
+    int dslimit = diagonal ? 4 : 2;
+    int sets_yd[] = {0, -1, -1, -1};
+    int sets_xd[] = {-1, 0, -1, 1};
+
+    int *sets = mem_zalloc(size * sizeof(int));
+    array_filler(sets, -1, size);
+
     for (y = 0; y < h; y++) {
 		for (x = 0; x < w; x++) {
+			int n = yx_to_i(y, x, w);
+
 			if (ignore_point(c, colors, y, x)) continue;
-			build_color_point(c, colors, counts, y, x, color, diagonal);
-			color++;
+			sets[n] = n;
+
+			for (i = 0; i < dslimit; i++) {
+				int y2 = y + sets_yd[i];
+				int x2 = x + sets_xd[i];
+				int root, root2;
+
+				if (y2 < 0 || x2 < 0 || x2 >= w) continue;
+				if (sets[yx_to_i(y2, x2, w)] < 0) continue;
+
+				/* Join the two sets under the earlier root */
+				root = find_set(sets, n);
+				root2 = find_set(sets, yx_to_i(y2, x2, w));
+				if (root < root2)
+					sets[root2] = root;
+				else
+					sets[root] = root2;
+			}
+		}
+    }
+
+    for (i = 0; i < size; i++) {
+		int root;
+
+		if (sets[i] < 0) continue;
+
+		/* A root is the first square of a region; it gets the next color */
+		root = find_set(sets, i);
+		if (root == i) {
+			parents[color] = color;
+			counts[color] = 0;
+			colors[i] = color++;
+		} else {
+			colors[i] = colors[root];
 		}
+		counts[colors[i]]++;
     }
+
+    mem_free(sets);
 }
 
 /**
@@ -1153,16 +1218,20 @@ static int first_color(int counts[], int size) {
 }
 
 /**
- * Find all cells of 'fromcolor' and repaint them to 'tocolor'.
- * \param colors is the array of current point colors
+ * Join the region of color 'from' to that of color 'to'.
  * \param counts is the array of current color counts
+ * \param parents is the disjoint set forest over colors
  * \param from is the color to change
  * \param to is the color to change to
- * \param size is the total area
+ *
+ * The squares keep their colors; find_set() gives the color they now have.
  */
-static void fix_colors(int colors[], int counts[], int from, int to, int size) {
-    int i;
-    for (i = 0; i < size; i++) if (colors[i] == from) colors[i] = to;
+static void join_colors(int counts[], int parents[], int from, int to) {
+    from = find_set(parents, from);
+    to = find_set(parents, to);
+    if (from == to) return;
+
+    parents[from] = to;
     counts[to] += counts[from];
     counts[from] = 0;
 }
@@ -1173,11 +1242,12 @@ static void fix_colors(int colors[], int counts[], int from, int to, int size) {
  * \param c is the current chunk
  * \param colors is the array of current point colors
  * \param counts is the array of current color counts
+ * \param parents is the disjoint set forest over colors
  * \param color is the color of the region we want to connect
  * \param new_color is the color of the region we want to connect to (if used)
  */
-static void join_region(struct chunk *c, int colors[], int counts[], int color,
-	int new_color)
+static void join_region(struct chunk *c, int colors[], int counts[],
+	int parents[], int color, int new_color)
 {
     int i;
     int h = c->height;
@@ -1193,9 +1263,13 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
     int *previous = mem_zalloc(size * sizeof(int));
     array_filler(previous, -1, size);
 
+    /* Regions may have been joined since these colors were looked up */
+    color = find_set(parents, color);
+    if (new_color != -1) new_color = find_set(parents, new_color);
+
     /* Push all squares of the given color onto the queue */
     for (i = 0; i < size; i++) {
-		if (colors[i] == color) {
+		if (find_set(parents, colors[i]) == color) {
 			q_push_int(queue, i);
 			previous[i] = i;
 		}
@@ -1205,7 +1279,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
     while (q_len(queue) > 0) {
 		/* Get the current square and its color */
 		int n = q_pop_int(queue);
-		int color2 = colors[n];
+		int color2 = find_set(parents, colors[n]);
 
 		/* If we're not looking for a specific color, any new one will do */
 		if ((new_color == -1) && color2 && (color2 != color))
@@ -1214,7 +1288,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
 		/* See if we've reached a square with a new color */
 		if (color2 == new_color) {
 			/* Step backward through the path, turning stone to tunnel */
-			while (colors[n] != color) {
+			while (find_set(parents, colors[n]) != color) {
 				int x, y;
 				i_to_yx(n, w, &y, &x);
 				colors[n] = color;
@@ -1225,7 +1299,7 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
 			}
 
 			/* Update the color mapping to combine the two colors */
-			fix_colors(colors, counts, color2, color, size);
+			join_colors(counts, parents, color2, color);
 
 			/* We're done now */
 			break;
@@ -1265,8 +1339,10 @@ static void join_region(struct chunk *c, int colors[], int counts[], int color,
  * \param c is the current chunk
  * \param colors is the array of current point colors
  * \param counts is the array of current color counts
+ * \param parents is the disjoint set forest over colors
  */
-static void join_regions(struct chunk *c, int colors[], int counts[]) {
+static void join_regions(struct chunk *c, int colors[], int counts[],
+						 int parents[]) {
     int h = c->height;
     int w = c->width;
     int size = h * w;
@@ -1277,7 +1353,7 @@ static void join_regions(struct chunk *c, int colors[], int counts[]) {
      */
     while (num > 1) {
 		int color = first_color(counts, size);
-		join_region(c, colors, counts, color, -1);
+		join_region(c, colors, counts, parents, color, -1);
 		num--;
     }
 }
@@ -1294,12 +1370,16 @@ void ensure_connectedness(struct chunk *c) {
     int size = c->height * c->width;
     int *colors = mem_zalloc(size * sizeof(int));
     int *counts = mem_zalloc(size * sizeof(int));
+    int *parents = mem_zalloc(size * sizeof(int));
 
-    build_colors(c, colors, counts, true);
-    join_regions(c, colors, counts);
+    GEN_STAGE_ENTER(GEN_STAGE_CONNECT);
+    build_colors(c, colors, counts, parents, true);
+    join_regions(c, colors, counts, parents);
+    GEN_STAGE_LEAVE(GEN_STAGE_CONNECT);
 
     mem_free(colors);
     mem_free(counts);
+    mem_free(parents);
 }
 
 
@@ -1321,6 +1401,7 @@ struct chunk *cavern_chunk(int depth, int h, int w)
 
     int *colors = mem_zalloc(size * sizeof(int));
     int *counts = mem_zalloc(size * sizeof(int));
+    int *parents = mem_zalloc(size * sizeof(int));
 
     int tries;
 
@@ -1347,16 +1428,20 @@ struct chunk *cavern_chunk(int depth, int h, int w)
 
 	/* If we couldn't make a big enough cavern then fail */
 	if (tries == MAX_CAVERN_TRIES) {
+		mem_free(colors);
+		mem_free(counts);
+		mem_free(parents);
 		cave_free(c);
 		return NULL;
 	}
 
-	build_colors(c, colors, counts, false);
+	build_colors(c, colors, counts, parents, false);
 	clear_small_regions(c, colors, counts);
-	join_regions(c, colors, counts);
+	join_regions(c, colors, counts, parents);
 
     mem_free(colors);
     mem_free(counts);
+    mem_free(parents);
 
 	return c;
 }
@@ -1364,9 +1449,10 @@ struct chunk *cavern_chunk(int depth, int h, int w)
 
 /**
  * Make a cavern level.
+ * \param dun is the current generation data
  * \param p is the player
  */
-struct chunk *cavern_gen(struct player *p) {
+struct chunk *cavern_gen(struct dun_data *dun, struct player *p) {
     int i, k;
 
     int h = rand_range(z_info->dungeon_hgt / 2, (z_info->dungeon_hgt * 3) / 4);
@@ -1456,10 +1542,12 @@ static void build_store(struct chunk *c, int n, int yy, int xx)
 
 /**
  * Generate the town for the first time, and place the player
+ * \param dun is the current generation data
  * \param c is the current chunk
  * \param p is the player
  */
-static void town_gen_layout(struct chunk *c, struct player *p)
+static void town_gen_layout(struct dun_data *dun, struct chunk *c,
+							struct player *p)
 {
 	int y, x, py, px, n;
 	int num_lava = 3 + randint0(3), num_rubble = 3 + randint0(3);
@@ -1476,7 +1564,7 @@ static void town_gen_layout(struct chunk *c, struct player *p)
 
 	/* Make some lava streamers */
 	for (n = 0; n < 3 + num_lava; n++)
-		build_streamer(c, FEAT_LAVA, 0);
+		build_streamer(dun, c, FEAT_LAVA, 0);
 
 	/* Make a town-sized starburst room. */
 	(void) generate_starburst_room(c, 1, 1, c->height - 1, c->width - 1, false,
@@ -1555,13 +1643,14 @@ static void town_gen_layout(struct chunk *c, struct player *p)
 
 /**
  * Town logic flow for generation of new town.
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  * We start with a fully wiped cave of normal floors. This function does NOT do
  * anything about the owners of the stores, nor the contents thereof. It only
  * handles the physical layout.
  */
-struct chunk *town_gen(struct player *p)
+struct chunk *town_gen(struct dun_data *dun, struct player *p)
 {
 	int i, y, x = 0;
 	int residents = is_daytime() ? z_info->town_monsters_day :
@@ -1576,7 +1665,7 @@ struct chunk *town_gen(struct player *p)
 		c_new->depth = p->depth;
 
 		/* Build stuff */
-		town_gen_layout(c_new, p);
+		town_gen_layout(dun, c_new, p);
 	} else {
 		/* Copy from the chunk list */
 		if (!chunk_copy(c_new, c_old, 0, 0, 0, 0))
@@ -1612,12 +1701,14 @@ struct chunk *town_gen(struct player *p)
 /* ------------------ MODIFIED ---------------- */
 /**
  * The main modified generation algorithm
+ * \param dun is the current generation data
  * \param depth is the chunk's native depth
  * \param height are the chunk's dimensions
  * \param width are the chunk's dimensions
  * \return a pointer to the generated chunk
  */
-struct chunk *modified_chunk(int depth, int height, int width)
+struct chunk *modified_chunk(struct dun_data *dun, int depth, int height,
+							 int width)
 {
     int i, y, x, y1, x1;
     int by = 0, bx = 0, key, rarity;
@@ -1679,7 +1770,7 @@ struct chunk *modified_chunk(int depth, int height, int width)
 			struct room_profile profile = dun->profile->room_profiles[i];
 			if (profile.rarity > rarity) continue;
 			if (profile.cutoff <= key) continue;
-			if (room_build(c, by, bx, profile, true)) break;
+			if (room_build(dun, c, by, bx, profile, true)) break;
 		}
     }
 
@@ -1709,7 +1800,7 @@ struct chunk *modified_chunk(int depth, int height, int width)
     /* Connect all the rooms together */
     for (i = 0; i < dun->cent_n; i++) {
 		/* Connect the room to the previous room */
-		build_tunnel(c, dun->cent[i].y, dun->cent[i].x, y, x);
+		build_tunnel(dun, c, dun->cent[i].y, dun->cent[i].x, y, x);
 
 		/* Remember the "previous" room */
 		y = dun->cent[i].y;
@@ -1723,10 +1814,10 @@ struct chunk *modified_chunk(int depth, int height, int width)
 		x = dun->door[i].x;
 
 		/* Try placing doors */
-		try_door(c, y, x - 1);
-		try_door(c, y, x + 1);
-		try_door(c, y - 1, x);
-		try_door(c, y + 1, x);
+		try_door(dun, c, y, x - 1);
+		try_door(dun, c, y, x + 1);
+		try_door(dun, c, y - 1, x);
+		try_door(dun, c, y + 1, x);
     }
 
     ensure_connectedness(c);
@@ -1740,6 +1831,7 @@ struct chunk *modified_chunk(int depth, int height, int width)
 
 /**
  * Generate a new dungeon level.
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  *
@@ -1761,7 +1853,7 @@ struct chunk *modified_chunk(int depth, int height, int width)
  *   interesting rooms, as well as to make general monster restrictions in
  *   areas or the whole dungeon
  */
-struct chunk *modified_gen(struct player *p) {
+struct chunk *modified_gen(struct dun_data *dun, struct player *p) {
     int i, k;
     int size_percent, y_size, x_size;
 	struct chunk *c;
@@ -1782,7 +1874,7 @@ struct chunk *modified_gen(struct player *p) {
 	dun->block_hgt = dun->profile->block_size;
 	dun->block_wid = dun->profile->block_size;
 
-    c = modified_chunk(p->depth, MIN(z_info->dungeon_hgt, y_size),
+    c = modified_chunk(dun, p->depth, MIN(z_info->dungeon_hgt, y_size),
 					   MIN(z_info->dungeon_wid, x_size));
 	c->depth = p->depth;
 
@@ -1792,11 +1884,11 @@ struct chunk *modified_gen(struct player *p) {
 
     /* Add some magma streamers */
     for (i = 0; i < dun->profile->str.mag; i++)
-		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
+		build_streamer(dun, c, FEAT_MAGMA, dun->profile->str.mc);
 
     /* Add some quartz streamers */
     for (i = 0; i < dun->profile->str.qua; i++)
-		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
+		build_streamer(dun, c, FEAT_QUARTZ, dun->profile->str.qc);
 
     /* Place 3 or 4 down stairs near some walls */
     alloc_stairs(c, FEAT_MORE, rand_range(3, 4), 3);
@@ -1820,7 +1912,7 @@ struct chunk *modified_gen(struct player *p) {
     i = z_info->level_monster_min + randint1(8) + k;
 
 	/* Remove all monster restrictions. */
-	mon_restrict(NULL, c->depth, true);
+	mon_restrict(dun, NULL, c->depth, true);
 
     /* Put some monsters in the dungeon */
     for (; i > 0; i--)
@@ -1843,12 +1935,14 @@ struct chunk *modified_gen(struct player *p) {
 /* ------------------ MORIA ---------------- */
 /**
  * The main moria generation algorithm
+ * \param dun is the current generation data
  * \param depth is the chunk's native depth
  * \param height are the chunk's dimensions
  * \param width are the chunk's dimensions
  * \return a pointer to the generated chunk
  */
-struct chunk *moria_chunk(int depth, int height, int width)
+struct chunk *moria_chunk(struct dun_data *dun, int depth, int height,
+						  int width)
 {
     int i, y, x, y1, x1;
     int by = 0, bx = 0, key, rarity;
@@ -1910,7 +2004,7 @@ struct chunk *moria_chunk(int depth, int height, int width)
 			struct room_profile profile = dun->profile->room_profiles[i];
 			if (profile.rarity > rarity) continue;
 			if (profile.cutoff <= key) continue;
-			if (room_build(c, by, bx, profile, true)) break;
+			if (room_build(dun, c, by, bx, profile, true)) break;
 		}
     }
 
@@ -1940,7 +2034,7 @@ struct chunk *moria_chunk(int depth, int height, int width)
     /* Connect all the rooms together */
     for (i = 0; i < dun->cent_n; i++) {
 		/* Connect the room to the previous room */
-		build_tunnel(c, dun->cent[i].y, dun->cent[i].x, y, x);
+		build_tunnel(dun, c, dun->cent[i].y, dun->cent[i].x, y, x);
 
 		/* Remember the "previous" room */
 		y = dun->cent[i].y;
@@ -1954,10 +2048,10 @@ struct chunk *moria_chunk(int depth, int height, int width)
 		x = dun->door[i].x;
 
 		/* Try placing doors */
-		try_door(c, y, x - 1);
-		try_door(c, y, x + 1);
-		try_door(c, y - 1, x);
-		try_door(c, y + 1, x);
+		try_door(dun, c, y, x - 1);
+		try_door(dun, c, y, x + 1);
+		try_door(dun, c, y - 1, x);
+		try_door(dun, c, y + 1, x);
     }
 
     ensure_connectedness(c);
@@ -1971,6 +2065,7 @@ struct chunk *moria_chunk(int depth, int height, int width)
 
 /**
  * Generate a new dungeon level.
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  *
@@ -1985,7 +2080,7 @@ struct chunk *moria_chunk(int depth, int height, int width)
  * labyrinth levels are selected) would be
  *	if ((c->depth >= 10) && (c->depth < 40) && one_in_(40))
  */
-struct chunk *moria_gen(struct player *p) {
+struct chunk *moria_gen(struct dun_data *dun, struct player *p) {
     int i, k;
     int size_percent, y_size, x_size;
 	struct chunk *c;
@@ -2006,7 +2101,7 @@ struct chunk *moria_gen(struct player *p) {
 	dun->block_hgt = dun->profile->block_size;
 	dun->block_wid = dun->profile->block_size;
 
-    c = moria_chunk(p->depth, MIN(z_info->dungeon_hgt, y_size),
+    c = moria_chunk(dun, p->depth, MIN(z_info->dungeon_hgt, y_size),
 					   MIN(z_info->dungeon_wid, x_size));
 	c->depth = p->depth;
 
@@ -2016,11 +2111,11 @@ struct chunk *moria_gen(struct player *p) {
 
     /* Add some magma streamers */
     for (i = 0; i < dun->profile->str.mag; i++)
-		build_streamer(c, FEAT_MAGMA, dun->profile->str.mc);
+		build_streamer(dun, c, FEAT_MAGMA, dun->profile->str.mc);
 
     /* Add some quartz streamers */
     for (i = 0; i < dun->profile->str.qua; i++)
-		build_streamer(c, FEAT_QUARTZ, dun->profile->str.qc);
+		build_streamer(dun, c, FEAT_QUARTZ, dun->profile->str.qc);
 
     /* Place 3 or 4 down stairs near some walls */
     alloc_stairs(c, FEAT_MORE, rand_range(3, 4), 3);
@@ -2044,14 +2139,14 @@ struct chunk *moria_gen(struct player *p) {
     i = z_info->level_monster_min + randint1(8) + k;
 
 	/* Moria levels have a high proportion of cave dwellers. */
-	mon_restrict("Moria dwellers", c->depth, true);
+	mon_restrict(dun, "Moria dwellers", c->depth, true);
 
     /* Put some monsters in the dungeon */
     for (; i > 0; i--)
 		pick_and_place_distant_monster(c, p, 0, true, c->depth);
 
 	/* Remove our restrictions. */
-	(void) mon_restrict(NULL, c->depth, false);
+	(void) mon_restrict(dun, NULL, c->depth, false);
 
     /* Put some objects in rooms */
     alloc_objects(c, SET_ROOM, TYP_OBJECT, Rand_normal(z_info->room_item_av, 3),
@@ -2070,10 +2165,11 @@ struct chunk *moria_gen(struct player *p) {
 /* ------------------ HARD CENTRE ---------------- */
 /**
  * Make a chunk consisting only of a greater vault
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  */
-struct chunk *vault_chunk(struct player *p)
+struct chunk *vault_chunk(struct dun_data *dun, struct player *p)
 {
 	struct vault *v;
 	struct chunk *c;
@@ -2086,7 +2182,7 @@ struct chunk *vault_chunk(struct player *p)
 	c->depth = p->depth;
 
 	/* Build the vault in it */
-	build_vault(c, v->hgt / 2, v->wid / 2, v);
+	build_vault(dun, c, v->hgt / 2, v->wid / 2, v);
 
 	return c;
 }
@@ -2103,39 +2199,40 @@ void connect_caverns(struct chunk *c, struct loc floor[])
     int size = c->height * c->width;
     int *colors = mem_zalloc(size * sizeof(int));
     int *counts = mem_zalloc(size * sizeof(int));
+    int *parents = mem_zalloc(size * sizeof(int));
 	int color_of_floor[4];
 
 	/* Color the regions, find which cavern is which color */
-    build_colors(c, colors, counts, true);
+    build_colors(c, colors, counts, parents, true);
 	for (i = 0; i < 4; i++) {
 		int spot = yx_to_i(floor[i].y, floor[i].x, c->width);
 		color_of_floor[i] = colors[spot];
 	}
 
 	/* Join left and upper, right and lower */
-	join_region(c, colors, counts, color_of_floor[0], color_of_floor[1]);
-	join_region(c, colors, counts, color_of_floor[2], color_of_floor[3]);
+	join_region(c, colors, counts, parents, color_of_floor[0],
+				color_of_floor[1]);
+	join_region(c, colors, counts, parents, color_of_floor[2],
+				color_of_floor[3]);
 
-	/* Redo the colors, join the two big caverns */
-    build_colors(c, colors, counts, true);
-	for (i = 1; i < 3; i++) {
-		int spot = yx_to_i(floor[i].y, floor[i].x, c->width);
-		color_of_floor[i] = colors[spot];
-	}
-	join_region(c, colors, counts, color_of_floor[1], color_of_floor[2]);
+	/* Join the two big caverns; join_region() finds their current colors */
+	join_region(c, colors, counts, parents, color_of_floor[1],
+				color_of_floor[2]);
 
     mem_free(colors);
     mem_free(counts);
+    mem_free(parents);
 }
 /**
  * Generate a hard centre level - a greater vault surrounded by caverns
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
 */
-struct chunk *hard_centre_gen(struct player *p)
+struct chunk *hard_centre_gen(struct dun_data *dun, struct player *p)
 {
 	/* Make a vault for the centre */
-	struct chunk *centre = vault_chunk(p);
+	struct chunk *centre = vault_chunk(dun, p);
 	int rotate = 0;
 
 	/* Dimensions for the surrounding caverns */
@@ -2287,10 +2384,11 @@ struct chunk *hard_centre_gen(struct player *p)
 /**
  * Generate a lair level - a regular cave generated with the modified
  * algorithm, connected to a cavern with themed monsters
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  */
-struct chunk *lair_gen(struct player *p) {
+struct chunk *lair_gen(struct dun_data *dun, struct player *p) {
     int i, k;
     int size_percent, y_size, x_size;
 	struct chunk *c;
@@ -2313,7 +2411,7 @@ struct chunk *lair_gen(struct player *p) {
 	dun->block_hgt = dun->profile->block_size;
 	dun->block_wid = dun->profile->block_size;
 
-    normal = modified_chunk(p->depth, y_size, x_size / 2);
+    normal = modified_chunk(dun, p->depth, y_size, x_size / 2);
 	if (!normal) return NULL;
 	normal->depth = p->depth;
 
@@ -2336,11 +2434,11 @@ struct chunk *lair_gen(struct player *p) {
 
     /* Add some magma streamers */
     for (i = 0; i < dun->profile->str.mag; i++)
-		build_streamer(normal, FEAT_MAGMA, dun->profile->str.mc);
+		build_streamer(dun, normal, FEAT_MAGMA, dun->profile->str.mc);
 
     /* Add some quartz streamers */
     for (i = 0; i < dun->profile->str.qua; i++)
-		build_streamer(normal, FEAT_QUARTZ, dun->profile->str.qc);
+		build_streamer(dun, normal, FEAT_QUARTZ, dun->profile->str.qc);
 
     /* Pick a larger number of monsters for the lair */
     i = (z_info->level_monster_min + randint1(20) + k);
@@ -2348,22 +2446,22 @@ struct chunk *lair_gen(struct player *p) {
 	/* Find appropriate monsters */
 	while (true) {
 		/* Choose a pit profile */
-		set_pit_type(lair->depth, 0);
+		set_pit_type(dun, lair->depth, 0);
 
 		/* Set monster generation restrictions */
-		if (mon_restrict(dun->pit_type->name, lair->depth, true))
+		if (mon_restrict(dun, dun->pit_type->name, lair->depth, true))
 			break;
 	}
 
 	ROOM_LOG("Monster lair - %s", dun->pit_type->name);
 
     /* Place lair monsters */
-	spread_monsters(lair, dun->pit_type->name, lair->depth, i, lair->height / 2,
-					lair->width / 2, lair->height / 2, lair->width / 2, 
-					ORIGIN_CAVERN);
+	spread_monsters(dun, lair, dun->pit_type->name, lair->depth, i,
+					lair->height / 2, lair->width / 2, lair->height / 2,
+					lair->width / 2, ORIGIN_CAVERN);
 
 	/* Remove our restrictions. */
-	(void) mon_restrict(NULL, lair->depth, false);
+	(void) mon_restrict(dun, NULL, lair->depth, false);
 
 	/* Make the level */
 	c = cave_new(y_size, x_size);
@@ -2423,10 +2521,11 @@ struct chunk *lair_gen(struct player *p) {
  * between them, and no teleport and only upstairs from the side where the
  * player starts.
  *
+ * \param dun is the current generation data
  * \param p is the player
  * \return a pointer to the generated chunk
  */
-struct chunk *gauntlet_gen(struct player *p) {
+struct chunk *gauntlet_gen(struct dun_data *dun, struct player *p) {
 	int i, k, y;
 	struct chunk *c;
 	struct chunk *arrival;
@@ -2507,23 +2606,23 @@ struct chunk *gauntlet_gen(struct player *p) {
 	/* Find appropriate monsters */
 	while (true) {
 		/* Choose a pit profile */
-		set_pit_type(gauntlet->depth, 0);
+		set_pit_type(dun, gauntlet->depth, 0);
 
 		/* Set monster generation restrictions */
-		if (mon_restrict(dun->pit_type->name, gauntlet->depth, true))
+		if (mon_restrict(dun, dun->pit_type->name, gauntlet->depth, true))
 			break;
 	}
 
 	ROOM_LOG("Gauntlet - %s", dun->pit_type->name);
 
 	/* Place labyrinth monsters */
-	spread_monsters(gauntlet, dun->pit_type->name, gauntlet->depth, i,
+	spread_monsters(dun, gauntlet, dun->pit_type->name, gauntlet->depth, i,
 					gauntlet->height / 2, gauntlet->width / 2,
 					gauntlet->height / 2, gauntlet->width / 2,
 					ORIGIN_LABYRINTH);
 
 	/* Remove our restrictions. */
-	(void) mon_restrict(NULL, gauntlet->depth, false);
+	(void) mon_restrict(dun, NULL, gauntlet->depth, false);
 
 	/* Make the level */
 	c = cave_new(y_size, arrival->width + gauntlet->width + departure->width);
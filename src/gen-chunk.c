@@ -28,6 +28,7 @@
 #include "generate.h"
 #include "init.h"
 #include "mon-make.h"
+#include "mon-util.h"
 #include "obj-util.h"
 #include "trap.h"
 
@@ -55,69 +56,80 @@ struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 
 	struct chunk *new = cave_new(height, width);
 
-	/* Write the location stuff */
+	/* Write the location stuff a row at a time, then sort out what's on
+	 * each square */
 	for (y = 0; y < height; y++) {
+		struct square *from = &cave->squares[y0 + y][x0];
+		struct square *to = new->squares[y];
+
+		memcpy(to, from, width * sizeof(*to));
 		for (x = 0; x < width; x++) {
-			/* Terrain */
-			new->squares[y][x].feat = cave->squares[y0 + y][x0 + x].feat;
-			sqinfo_copy(new->squares[y][x].info,
-						cave->squares[y0 + y][x0 + x].info);
+			square_sync_projectable(new, y, x);
+			to[x].mon = 0;
+			to[x].obj = NULL;
+			to[x].trap = NULL;
 
 			/* Dungeon objects */
-			if (objects) {
-				struct object *obj = square_object(cave, y0 + y, x0 + x);
-				if (obj) {
-					new->squares[y][x].obj = obj;
-					while (obj) {
-						/* Adjust stuff */
-						obj->iy = y;
-						obj->ix = x;
-					}
+			if (objects && from[x].obj) {
+				struct object *obj;
+
+				cave->fingerprint -= square_fingerprint_pile(cave, y0 + y,
+															 x0 + x);
+				to[x].obj = from[x].obj;
+				from[x].obj = NULL;
+				for (obj = to[x].obj; obj; obj = obj->next) {
+					/* Adjust stuff */
+					obj->iy = y;
+					obj->ix = x;
 				}
 			}
 
 			/* Monsters and held objects */
-			if (monsters) {
-				if (cave->squares[y0 + y][x0 + x].mon > 0) {
-					struct monster *source_mon = square_monster(cave, y0 + y,
-															  x0 + x);
-					struct monster *dest_mon = NULL;
-
-					/* Valid monster */
-					if (!source_mon->race)
-						continue;
-
-					/* Copy over */
-					new->squares[y][x].mon = ++new->mon_cnt;
-					dest_mon = cave_monster(new, new->mon_cnt);
-					memcpy(dest_mon, source_mon, sizeof(*source_mon));
-
-					/* Adjust position */
-					dest_mon->fy = y;
-					dest_mon->fx = x;
-
-					/* Held objects */
-					if (objects && source_mon->held_obj)
-						dest_mon->held_obj = source_mon->held_obj;
-
-					delete_monster(y0 + y, x0 + x);
-				}
+			if (monsters && from[x].mon > 0) {
+				struct monster *source_mon = square_monster(cave, y0 + y,
+														  x0 + x);
+				struct monster *dest_mon = NULL;
+
+				/* Valid monster */
+				if (!source_mon->race)
+					continue;
+
+				/* Copy over */
+				to[x].mon = ++new->mon_cnt;
+				dest_mon = cave_monster(new, new->mon_cnt);
+				memcpy(dest_mon, source_mon, sizeof(*source_mon));
+
+				/* Adjust position */
+				dest_mon->fy = y;
+				dest_mon->fx = x;
+
+				/* Held objects */
+				if (objects && source_mon->held_obj)
+					dest_mon->held_obj = source_mon->held_obj;
+
+				delete_monster(y0 + y, x0 + x);
 			}
 
 			/* Traps */
-			if (traps) {
+			if (traps && from[x].trap) {
+				struct trap *trap;
+
 				/* Copy over */
-				struct trap *trap = cave->squares[y][x].trap;
-				new->squares[y][x].trap = trap;
-				cave->squares[y][x].trap = NULL;
+				to[x].trap = from[x].trap;
+				from[x].trap = NULL;
 
 				/* Adjust position */
-				trap->fy = y;
-				trap->fx = x;
+				for (trap = to[x].trap; trap; trap = trap->next) {
+					trap->fy = y;
+					trap->fx = x;
+				}
+				new->trap_timeouts = cave->trap_timeouts;
 			}
 		}
 	}
 
+	/* The grids came across without being fingerprinted */
+	new->fingerprint = chunk_fingerprint(new);
 	return new;
 }
 
@@ -140,6 +152,22 @@ void chunk_list_add(struct chunk *c)
 	chunk_list[chunk_list_max++] = c;
 }
 
+/**
+ * Find the index of a chunk in the chunk list by name
+ * \param name the name of the chunk being sought
+ * \return the index, or -1 if there is no such chunk
+ */
+static int chunk_list_index(const char *name)
+{
+	int i;
+
+	for (i = 0; i < chunk_list_max; i++)
+		if (streq(name, chunk_list[i]->name))
+			return i;
+
+	return -1;
+}
+
 /**
  * Remove an entry from the chunk list, return whether it was found
  * \param name the name of the chunk being removed from the list
@@ -147,30 +175,37 @@ void chunk_list_add(struct chunk *c)
  */
 bool chunk_list_remove(char *name)
 {
-	int i, j;
-	int newsize = 0;
-
-	for (i = 0; i < chunk_list_max; i++) {
-		/* Find the match */
-		if (!strcmp(name, chunk_list[i]->name)) {
-			/* Copy all the succeeding ones back one */
-			for (j = i + 1; j < chunk_list_max; j++)
-				chunk_list[j - 1] = chunk_list[j];
-
-			/* Destroy the last one, and shorten the list */
-			if ((chunk_list_max % CHUNK_LIST_INCR) == 0)
-				newsize = (chunk_list_max - CHUNK_LIST_INCR) *	
-					sizeof(struct chunk *);
-			chunk_list_max--;
-			chunk_list[chunk_list_max] = NULL;
-			if (newsize)
-				chunk_list = (struct chunk **) mem_realloc(chunk_list, newsize);
+	int i = chunk_list_index(name);
 
-			return true;
-		}
+	if (i < 0)
+		return false;
+
+	/* Copy all the succeeding ones back one */
+	memmove(&chunk_list[i], &chunk_list[i + 1],
+			(chunk_list_max - i - 1) * sizeof(struct chunk *));
+	chunk_list[--chunk_list_max] = NULL;
+
+	/* Free the list once it is empty, so chunk_list_add() starts afresh */
+	if (chunk_list_max == 0) {
+		mem_free(chunk_list);
+		chunk_list = NULL;
 	}
 
-	return false;
+	return true;
+}
+
+/**
+ * Free every chunk on the list, and the list itself
+ */
+void chunk_list_free(void)
+{
+	int i;
+
+	for (i = 0; i < chunk_list_max; i++)
+		cave_free(chunk_list[i]);
+	mem_free(chunk_list);
+	chunk_list = NULL;
+	chunk_list_max = 0;
 }
 
 /**
@@ -180,13 +215,9 @@ bool chunk_list_remove(char *name)
  */
 struct chunk *chunk_find_name(char *name)
 {
-	int i;
-
-	for (i = 0; i < chunk_list_max; i++)
-		if (!strcmp(name, chunk_list[i]->name))
-			return chunk_list[i];
+	int i = chunk_list_index(name);
 
-	return NULL;
+	return (i < 0) ? NULL : chunk_list[i];
 }
 
 /**
@@ -237,9 +268,94 @@ void symmetry_transform(int *y, int *x, int y0, int x0, int height, int width,
 	*x += x0;
 }
 
+/**
+ * Move the contents of one square of a chunk being copied to its new place
+ * in the destination; see chunk_copy()
+ * \return false if the destination has run out of room for monsters
+ */
+static bool chunk_copy_square(struct chunk *dest, struct chunk *source,
+							  int y, int x, int dest_y, int dest_x)
+{
+	/* Dungeon objects */
+	if (square_object(source, y, x)) {
+		struct object *obj;
+		source->fingerprint -= square_fingerprint_pile(source, y, x);
+		dest->squares[dest_y][dest_x].obj = square_object(source, y, x);
+		dest->fingerprint += square_fingerprint_pile(dest, dest_y, dest_x);
+
+		for (obj = square_object(source, y, x); obj; obj = obj->next) {
+			/* Adjust position */
+			obj->iy = dest_y;
+			obj->ix = dest_x;
+		}
+		source->squares[y][x].obj = NULL;
+		square_pile_changed(source, y, x);
+		square_pile_changed(dest, dest_y, dest_x);
+	}
+
+	/* Monsters */
+	if (source->squares[y][x].mon > 0) {
+		struct monster *source_mon = square_monster(source, y, x);
+		struct monster *dest_mon = NULL;
+		int idx;
+
+		/* Valid monster */
+		if (!source_mon->race)
+			return true;
+
+		/* Make a monster */
+		idx = mon_pop(dest);
+
+		/* Hope this never happens */
+		if (!idx)
+			return false;
+
+		/* Copy over */
+		dest_mon = cave_monster(dest, idx);
+		dest->squares[dest_y][dest_x].mon = idx;
+		memcpy(dest_mon, source_mon, sizeof(*source_mon));
+
+		/* Adjust stuff */
+		dest_mon->midx = idx;
+		dest_mon->fy = dest_y;
+		dest_mon->fx = dest_x;
+		dest->fingerprint += square_fingerprint_mon(dest, dest_y, dest_x);
+
+		/* Held objects */
+		if (source_mon->held_obj)
+			dest_mon->held_obj = source_mon->held_obj;
+	}
+
+	/* Traps */
+	if (source->squares[y][x].trap) {
+		struct trap *trap = source->squares[y][x].trap;
+		dest->squares[dest_y][dest_x].trap = trap;
+
+		/* Traverse the trap list */
+		while (trap) {
+			/* Adjust location */
+			trap->fy = dest_y;
+			trap->fx = dest_x;
+			trap = trap->next;
+		}
+		source->squares[y][x].trap = NULL;
+		dest->trap_timeouts = MAX(dest->trap_timeouts,
+								  source->trap_timeouts);
+	}
+
+	/* Player */
+	if (source->squares[y][x].mon == -1) {
+		dest->squares[dest_y][dest_x].mon = -1;
+		dest->fingerprint += square_fingerprint_mon(dest, dest_y, dest_x);
+	}
+
+	return true;
+}
+
 /**
  * Write a chunk, transformed, to a given offset in another chunk.  Note that
- * objects are copied from the old chunk and not retained there
+ * objects are copied from the old chunk and not retained there, and that
+ * the destination area is expected to be empty of objects, monsters and traps
  * \param dest the chunk where the copy is going
  * \param source the chunk being copied
  * \param y0 transformation parameters  - see symmetry_transform()
@@ -264,82 +380,61 @@ bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
 			return false;
 	}
 
-	/* Write the location stuff */
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++) {
-			/* Work out where we're going */
-			int dest_y = y;
-			int dest_x = x;
-			symmetry_transform(&dest_y, &dest_x, y0, x0, h, w, rotate, reflect);
-
-			/* Terrain */
-			dest->squares[dest_y][dest_x].feat = source->squares[y][x].feat;
-			sqinfo_copy(dest->squares[dest_y][dest_x].info,
-						source->squares[y][x].info);
-
-			/* Dungeon objects */
-			if (square_object(source, y, x)) {
-				struct object *obj;
-				dest->squares[dest_y][dest_x].obj = square_object(source, y, x);
-
-				for (obj = square_object(source, y, x); obj; obj = obj->next) {
-					/* Adjust position */
-					obj->iy = dest_y;
-					obj->ix = dest_x;
-				}
-				source->squares[y][x].obj = NULL;
-			}
+	/* The copied view flags belong to no known view, the noise field
+	 * needs making again, and monsters arrive without being filed */
+	forget_view(dest);
+	dest->noise_origin = loc(-1, -1);
+	forget_monster_blocks(dest);
 
-			/* Monsters */
-			if (source->squares[y][x].mon > 0) {
-				struct monster *source_mon = square_monster(source, y, x);
-				struct monster *dest_mon = NULL;
-				int idx;
-
-				/* Valid monster */
-				if (!source_mon->race)
+	/* Write the location stuff */
+	if (rotate % 4 == 0 && !reflect) {
+		/* Nothing moves about, so whole rows can come across at once;
+		 * the contents are then put right square by square */
+		for (y = 0; y < h; y++) {
+			struct square *from = source->squares[y];
+			struct square *to = &dest->squares[y + y0][x0];
+
+			/* The terrain being written over may have been filled in */
+			for (x = 0; x < w; x++)
+				dest->fingerprint -= square_fingerprint_feat(y + y0, x + x0,
+															 to[x].feat);
+			memcpy(to, from, w * sizeof(*to));
+			for (x = 0; x < w; x++) {
+				square_sync_projectable(dest, y + y0, x + x0);
+				to[x].mon = 0;
+				to[x].obj = NULL;
+				to[x].trap = NULL;
+				dest->fingerprint += square_fingerprint_feat(y + y0, x + x0,
+															 to[x].feat);
+				if (!from[x].mon && !from[x].obj && !from[x].trap)
 					continue;
-
-				/* Make a monster */
-				idx = mon_pop(dest);
-
-				/* Hope this never happens */
-				if (!idx)
+				if (!chunk_copy_square(dest, source, y, x, y + y0, x + x0))
 					break;
-
-				/* Copy over */
-				dest_mon = cave_monster(dest, idx);
-				dest->squares[dest_y][dest_x].mon = idx;
-				memcpy(dest_mon, source_mon, sizeof(*source_mon));
-
-				/* Adjust stuff */
-				dest_mon->midx = idx;
-				dest_mon->fy = dest_y;
-				dest_mon->fx = dest_x;
-
-				/* Held objects */
-				if (source_mon->held_obj)
-					dest_mon->held_obj = source_mon->held_obj;
 			}
-
-			/* Traps */
-			if (source->squares[y][x].trap) {
-				struct trap *trap = source->squares[y][x].trap;
-				dest->squares[dest_y][dest_x].trap = trap;
-
-				/* Traverse the trap list */
-				while (trap) {
-					/* Adjust location */
-					trap->fy = dest_y;
-					trap->fx = dest_x;
-					trap = trap->next;
-				}
-				source->squares[y][x].trap = NULL;
+		}
+	} else {
+		for (y = 0; y < h; y++) {
+			for (x = 0; x < w; x++) {
+				/* Work out where we're going */
+				int dest_y = y;
+				int dest_x = x;
+				symmetry_transform(&dest_y, &dest_x, y0, x0, h, w, rotate,
+								   reflect);
+
+				/* Terrain */
+				dest->fingerprint +=
+					square_fingerprint_feat(dest_y, dest_x,
+											source->squares[y][x].feat) -
+					square_fingerprint_feat(dest_y, dest_x,
+									dest->squares[dest_y][dest_x].feat);
+				dest->squares[dest_y][dest_x].feat = source->squares[y][x].feat;
+				square_sync_projectable(dest, dest_y, dest_x);
+				sqinfo_copy(dest->squares[dest_y][dest_x].info,
+							source->squares[y][x].info);
+
+				if (!chunk_copy_square(dest, source, y, x, dest_y, dest_x))
+					break;
 			}
-
-			/* Player */
-			if (source->squares[y][x].mon == -1) 
-				dest->squares[dest_y][dest_x].mon = -1;
 		}
 	}
 
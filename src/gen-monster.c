@@ -97,6 +97,7 @@ static bool mon_select(struct monster_race *race)
  * an (adjusted) depth, and use these to set values for required
  * monster base symbol.
  *
+ * \param dun the current generation data
  * \param monster_type the monster type to be selected, as described below
  * \param depth the native depth to choose monsters
  * \param unique_ok whether to allow uniques to be chosen
@@ -112,7 +113,8 @@ static bool mon_select(struct monster_race *race)
  * If called with monster_type "random", it will get a random monster base and 
  * describe the monsters by its name (for use by cheat_room).
  */
-bool mon_restrict(const char *monster_type, int depth, bool unique_ok)
+bool mon_restrict(struct dun_data *dun, const char *monster_type, int depth,
+				  bool unique_ok)
 {
     int i, j = 0;
 
@@ -172,7 +174,7 @@ bool mon_restrict(const char *monster_type, int depth, bool unique_ok)
 			return false;
 
 		/* Prepare allocation table */
-		get_mon_num_prep(mon_pit_hook);
+		mon_pit_prep(dun->pit_type);
 		return true;
 	}
 }
@@ -183,6 +185,7 @@ bool mon_restrict(const char *monster_type, int depth, bool unique_ok)
  * y0, x0.  Accept values for monster depth, symbol, and maximum vertical 
  * and horizontal displacement.  Call monster restriction functions if 
  * needed.
+ * \param dun the current generation data
  * \param c the current chunk being generated
  * \param type the type of monster (see comments to mon_restrict())
  * \param depth selection depth
@@ -196,8 +199,9 @@ bool mon_restrict(const char *monster_type, int depth, bool unique_ok)
  * Return prematurely if the code starts looping too much (this may happen 
  * if y0 or x0 are out of bounds, or the area is already occupied).
  */
-void spread_monsters(struct chunk *c, const char *type, int depth, int num, 
-					 int y0, int x0, int dy, int dx, byte origin)
+void spread_monsters(struct dun_data *dun, struct chunk *c, const char *type,
+					 int depth, int num, int y0, int x0, int dy, int dx,
+					 byte origin)
 {
     int i, j;			/* Limits on loops */
     int count;
@@ -205,7 +209,7 @@ void spread_monsters(struct chunk *c, const char *type, int depth, int num,
     int start_mon_num = c->mon_max;
 
     /* Restrict monsters.  Allow uniques. Leave area empty if none found. */
-    if (!mon_restrict(type, depth, true))
+    if (!mon_restrict(dun, type, depth, true))
 		return;
 
     /* Build the monster probability table. */
@@ -220,7 +224,7 @@ void spread_monsters(struct chunk *c, const char *type, int depth, int num,
 			y = y0;
 			x = x0;
 			if (!square_in_bounds(c, y, x)) {
-				(void) mon_restrict(NULL, depth, true);
+				(void) mon_restrict(dun, NULL, depth, true);
 				return;
 			}
 		} else {
@@ -231,7 +235,7 @@ void spread_monsters(struct chunk *c, const char *type, int depth, int num,
 					if (j < 9) {
 						continue;
 					} else {
-						(void) mon_restrict(NULL, depth, true);
+						(void) mon_restrict(dun, NULL, depth, true);
 						return;
 					}
 				}
@@ -255,7 +259,7 @@ void spread_monsters(struct chunk *c, const char *type, int depth, int num,
     }
 
     /* Remove monster restrictions. */
-    (void) mon_restrict(NULL, depth, true);
+    (void) mon_restrict(dun, NULL, depth, true);
 }
 
 
@@ -321,6 +325,7 @@ void get_vault_monsters(struct chunk *c, char racial_symbol[], char *vault_type,
 /**
  * Funtion for placing appropriate monsters in a room of chambers
  *
+ * \param dun the current generation data
  * \param c the current chunk being generated
  * \param y1 the limits of the vault
  * \param x1 the limits of the vault
@@ -329,8 +334,8 @@ void get_vault_monsters(struct chunk *c, char racial_symbol[], char *vault_type,
  * \param name the name of the monster type for use in mon_select()
  * \param area the total room area, used for scaling monster quantity
  */
-void get_chamber_monsters(struct chunk *c, int y1, int x1, int y2, int x2, 
-						  char *name, int area)
+void get_chamber_monsters(struct dun_data *dun, struct chunk *c, int y1, int x1,
+						  int y2, int x2, char *name, int area)
 {
 	int i, y, x;
 	s16b monsters_left, depth;
@@ -341,25 +346,25 @@ void get_chamber_monsters(struct chunk *c, int y1, int x1, int y2, int x2,
 
 	/* Choose a pit profile, using that depth. */
 	if (!random)
-		set_pit_type(depth, 0);
+		set_pit_type(dun, depth, 0);
 
 	/* Allow (slightly) tougher monsters. */
 	depth = c->depth + (c->depth < 60 ? c->depth / 12 : 5);
 
 	/* Set monster generation restrictions. Occasionally random. */
 	if (random) {
-		if (!mon_restrict("random", depth, true))
+		if (!mon_restrict(dun, "random", depth, true))
 			return;
 		my_strcpy(name, "random", sizeof(name));
 	} else {
-		if (!mon_restrict(dun->pit_type->name, depth, true))
+		if (!mon_restrict(dun, dun->pit_type->name, depth, true))
 			return;
 		my_strcpy(name, dun->pit_type->name, sizeof(name));
 	}
 
 	/* Build the monster probability table. */
 	if (!get_mon_num(depth)) {
-		(void) mon_restrict(NULL, depth, false);
+		(void) mon_restrict(dun, NULL, depth, false);
 		name = NULL;
 		return;
 	}
@@ -393,6 +398,6 @@ void get_chamber_monsters(struct chunk *c, int y1, int x1, int y2, int x2,
 	}
 
 	/* Remove our restrictions. */
-	(void) mon_restrict(NULL, depth, false);
+	(void) mon_restrict(dun, NULL, depth, false);
 }
 
@@ -726,55 +726,61 @@ extern bool generate_starburst_room(struct chunk *c, int y1, int x1, int y2,
 	return (true);
 }
 
+/**
+ * The pit profile mon_pit_hook() tests against; only set while
+ * mon_pit_prep() is preparing the allocation table
+ */
+static const struct pit_profile *pit_hook_type;
+
 /**
  * Hook for picking monsters appropriate to a nest/pit or region.
  * \param race the race being tested for inclusion
  * \return the race is acceptable
- * Requires dun->pit_type to be set.
  */
-bool mon_pit_hook(struct monster_race *race)
+static bool mon_pit_hook(struct monster_race *race)
 {
+	const struct pit_profile *pit = pit_hook_type;
 	bool match_base = true;
 	bool match_color = true;
 
 	assert(race);
-	assert(dun->pit_type);
+	assert(pit);
 
 	if (rf_has(race->flags, RF_UNIQUE)) {
 		return false;
-	} else if (!rf_is_subset(race->flags, dun->pit_type->flags)) {
+	} else if (!rf_is_subset(race->flags, pit->flags)) {
 		return false;
-	} else if (rf_is_inter(race->flags, dun->pit_type->forbidden_flags)) {
+	} else if (rf_is_inter(race->flags, pit->forbidden_flags)) {
 		return false;
-	} else if (!rsf_is_subset(race->spell_flags, dun->pit_type->spell_flags)) {
+	} else if (!rsf_is_subset(race->spell_flags, pit->spell_flags)) {
 		return false;
 	} else if (rsf_is_inter(race->spell_flags,
-							dun->pit_type->forbidden_spell_flags)) {
+							pit->forbidden_spell_flags)) {
 		return false;
-	} else if (dun->pit_type->forbidden_monsters) {
+	} else if (pit->forbidden_monsters) {
 		struct pit_forbidden_monster *monster;
-		for (monster = dun->pit_type->forbidden_monsters; monster;
+		for (monster = pit->forbidden_monsters; monster;
 			 monster = monster->next) {
 			if (race == monster->race)
 				return false;
 		}
 	}
 
-	if (dun->pit_type->bases) {
+	if (pit->bases) {
 		struct pit_monster_profile *bases;
 		match_base = false;
 
-		for (bases = dun->pit_type->bases; bases; bases = bases->next) {
+		for (bases = pit->bases; bases; bases = bases->next) {
 			if (race->base == bases->base)
 				match_base = true;
 		}
 	}
 	
-	if (dun->pit_type->colors) {
+	if (pit->colors) {
 		struct pit_color_profile *colors;
 		match_color = false;
 
-		for (colors = dun->pit_type->colors; colors; colors = colors->next) {
+		for (colors = pit->colors; colors; colors = colors->next) {
 			if (race->d_attr == colors->color)
 				match_color = true;
 		}
@@ -783,6 +789,17 @@ bool mon_pit_hook(struct monster_race *race)
 	return (match_base && match_color);
 }
 
+/**
+ * Prepare the monster allocation table for a nest/pit or region.
+ * \param pit the pit profile monsters must fit
+ */
+void mon_pit_prep(const struct pit_profile *pit)
+{
+	pit_hook_type = pit;
+	get_mon_num_prep_key(mon_pit_hook, pit->pit_idx);
+	pit_hook_type = NULL;
+}
+
 /**
  * Pick a type of monster for pits (or other purposes), based on the level.
  * 
@@ -791,11 +808,12 @@ bool mon_pit_hook(struct monster_race *race)
  * standard deviation of 10. Then we pick the profile that gave us a depth that
  * is closest to the player's actual depth.
  *
- * Sets dun->pit_type, which is required for mon_pit_hook.
+ * Sets dun->pit_type, which mon_pit_prep() then uses.
+ * \param dun the current generation data
  * \param depth is the pit profile depth to aim for in selection
  * \param type is 1 for pits, 2 for nests, 0 for any profile
  */
-void set_pit_type(int depth, int type)
+void set_pit_type(struct dun_data *dun, int depth, int type)
 {
 	int i;
 	int pit_idx = 0;
@@ -826,6 +844,7 @@ void set_pit_type(int depth, int type)
 /**
  * Find a good spot for the next room.
  *
+ * \param dun the current generation data
  * \param y centre of the room
  * \param x centre of the room
  * \param height dimensions of the room
@@ -842,7 +861,8 @@ void set_pit_type(int depth, int type)
  * Return true and values for the center of the room if all went well.
  * Otherwise, return false.
  */
-static bool find_space(int *y, int *x, int height, int width)
+static bool find_space(struct dun_data *dun, int *y, int *x, int height,
+					   int width)
 {
 	int i;
 	int by, bx, by1, bx1, by2, bx2;
@@ -870,10 +890,12 @@ static bool find_space(int *y, int *x, int height, int width)
 		if (bx1 < 0 || bx2 >= dun->col_blocks) continue;
 
 		/* Verify open space */
-		for (by = by1; by <= by2; by++) {
+		for (by = by1; by <= by2 && !filled; by++) {
 			for (bx = bx1; bx <= bx2; bx++) {
-				if (dun->room_map[by][bx])
+				if (dun->room_map[by][bx]) {
 					filled = true;
+					break;
+				}
 			}
 		}
 
@@ -907,23 +929,20 @@ static bool find_space(int *y, int *x, int height, int width)
 }
 
 /**
- * Build a room template from its string representation.
+ * Build a room template from the grids listed when it was parsed.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
- * \param ymax the room dimensions
- * \param xmax the room dimensions
- * \param doors the door position
- * \param data the room template text description
- * \param tval the object type for any included objects
+ * \param room the room template
  * \return success
  */
-static bool build_room_template(struct chunk *c, int y0, int x0, int ymax, int xmax, int doors, const char *data, int tval)
+static bool build_room_template(struct dun_data *dun, struct chunk *c, int y0,
+								int x0, struct room_template *room)
 {
-	int dx, dy, x, y, rnddoors, doorpos;
-	const char *t;
+	int ymax = room->hgt, xmax = room->wid, tval = room->tval;
+	int i, x, y, rnddoors, doorpos;
 	bool rndwalls, light;
-	
 
 	assert(c);
 
@@ -932,123 +951,121 @@ static bool build_room_template(struct chunk *c, int y0, int x0, int ymax, int x
 
 	/* Set the random door position here so it generates doors in all squares
 	 * marked with the same number */
-	rnddoors = randint1(doors);
+	rnddoors = randint1(room->dor);
 
 	/* Decide whether optional walls will be generated this time */
 	rndwalls = one_in_(2) ? true : false;
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, ymax + 2, xmax + 2))
+		if (!find_space(dun, &y0, &x0, ymax + 2, xmax + 2))
 			return (false);
 	}
 
 	/* Place dungeon features and objects */
-	for (t = data, dy = 0; dy < ymax && *t; dy++) {
-		for (dx = 0; dx < xmax && *t; dx++, t++) {
-			/* Extract the location */
-			x = x0 - (xmax / 2) + dx;
-			y = y0 - (ymax / 2) + dy;
-
-			/* Skip non-grids */
-			if (*t == ' ') continue;
-
-			/* Lay down a floor */
-			square_set_feat(c, y, x, FEAT_FLOOR);
-
-			/* Debugging assertion */
-			assert(square_isempty(c, y, x));
-
-			/* Analyze the grid */
-			switch (*t) {
-			case '%': set_marked_granite(c, y, x, SQUARE_WALL_OUTER); break;
-			case '#': set_marked_granite(c, y, x, SQUARE_WALL_SOLID); break;
-			case '+': place_closed_door(c, y, x); break;
-			case '^': if (one_in_(4)) place_trap(c, y, x, -1, c->depth); break;
-			case 'x': {
-
-				/* If optional walls are generated, put a wall in this square */
-				if (rndwalls)
-					set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
-				break;
-			}
-			case '(': {
+	for (i = 0; i < room->num_grids; i++) {
+		int grid = room->grids[i];
+		char t = room->text[grid];
+
+		/* Extract the location */
+		y = y0 - (ymax / 2) + grid / xmax;
+		x = x0 - (xmax / 2) + grid % xmax;
+
+		/* Lay down a floor */
+		square_set_feat(c, y, x, FEAT_FLOOR);
+
+		/* Debugging assertion */
+		assert(square_isempty(c, y, x));
+
+		/* Analyze the grid */
+		switch (t) {
+		case '%': set_marked_granite(c, y, x, SQUARE_WALL_OUTER); break;
+		case '#': set_marked_granite(c, y, x, SQUARE_WALL_SOLID); break;
+		case '+': place_closed_door(c, y, x); break;
+		case '^': if (one_in_(4)) place_trap(c, y, x, -1, c->depth); break;
+		case 'x': {
+
+			/* If optional walls are generated, put a wall in this square */
+			if (rndwalls)
+				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+			break;
+		}
+		case '(': {
 
-				/* If optional walls are generated, put a door in this square */
-				if (rndwalls)
-					place_secret_door(c, y, x);
-				break;
-			}
-			case ')': {
-				/* If no optional walls generated, put a door in this square */
-				if (!rndwalls)
-					place_secret_door(c, y, x);
-				else
-					set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
-				break;
-			}
-			case '8': {
+			/* If optional walls are generated, put a door in this square */
+			if (rndwalls)
+				place_secret_door(c, y, x);
+			break;
+		}
+		case ')': {
+			/* If no optional walls generated, put a door in this square */
+			if (!rndwalls)
+				place_secret_door(c, y, x);
+			else
+				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+			break;
+		}
+		case '8': {
 
-				/* Put something nice in this square
-				 * Object (80%) or Stairs (20%) */
-				if (randint0(100) < 80)
-					place_object(c, y, x, c->depth, false, false, ORIGIN_SPECIAL, 0);
-				else
-					place_random_stairs(c, y, x);
+			/* Put something nice in this square
+			 * Object (80%) or Stairs (20%) */
+			if (randint0(100) < 80)
+				place_object(c, y, x, c->depth, false, false, ORIGIN_SPECIAL, 0);
+			else
+				place_random_stairs(c, y, x);
 
-				/* Some monsters to guard it */
-				vault_monsters(c, y, x, c->depth + 2, randint0(2) + 3);
+			/* Some monsters to guard it */
+			vault_monsters(c, y, x, c->depth + 2, randint0(2) + 3);
 
-				break;
-			}
-			case '9': {
+			break;
+		}
+		case '9': {
 
-				/* Create some interesting stuff nearby */
+			/* Create some interesting stuff nearby */
 
-				/* A few monsters */
-				vault_monsters(c, y - 3, x - 3, c->depth + randint0(2), randint1(2));
-				vault_monsters(c, y + 3, x + 3, c->depth + randint0(2), randint1(2));
+			/* A few monsters */
+			vault_monsters(c, y - 3, x - 3, c->depth + randint0(2), randint1(2));
+			vault_monsters(c, y + 3, x + 3, c->depth + randint0(2), randint1(2));
 
-				/* And maybe a bit of treasure */
+			/* And maybe a bit of treasure */
 
-				if (one_in_(2))
-					vault_objects(c, y - 2, x + 2, c->depth, 1 + randint0(2));
+			if (one_in_(2))
+				vault_objects(c, y - 2, x + 2, c->depth, 1 + randint0(2));
 
-				if (one_in_(2))
-					vault_objects(c, y + 2, x - 2, c->depth, 1 + randint0(2));
-
-				break;
+			if (one_in_(2))
+				vault_objects(c, y + 2, x - 2, c->depth, 1 + randint0(2));
 
-			}
-			case '[': {
-				
-				/* Place an object of the template's specified tval */
-				place_object(c, y, x, c->depth, false, false, ORIGIN_SPECIAL, tval);
-				break;
-			}
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6': {
-				/* Check if this is chosen random door position */
-				doorpos = (int) (*t - '0');
-
-				if (doorpos == rnddoors)
-					place_secret_door(c, y, x);
-				else
-					set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+			break;
 
-				break;
-			}
-			}
+		}
+		case '[': {
+			
+			/* Place an object of the template's specified tval */
+			place_object(c, y, x, c->depth, false, false, ORIGIN_SPECIAL, tval);
+			break;
+		}
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6': {
+			/* Check if this is chosen random door position */
+			doorpos = (int) (t - '0');
+
+			if (doorpos == rnddoors)
+				place_secret_door(c, y, x);
+			else
+				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
 
-			/* Part of a room */
-			sqinfo_on(c->squares[y][x].info, SQUARE_ROOM);
-			if (light)
-				sqinfo_on(c->squares[y][x].info, SQUARE_GLOW);
+			break;
 		}
+		}
+
+		/* Part of a room */
+		sqinfo_on(c->squares[y][x].info, SQUARE_ROOM);
+		if (light)
+			sqinfo_on(c->squares[y][x].info, SQUARE_GLOW);
 	}
 
 	return true;
@@ -1056,14 +1073,15 @@ static bool build_room_template(struct chunk *c, int y0, int x0, int ymax, int x
 
 /**
  * Helper function for building room templates.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param typ the room template type (currently unused)
  * \return success
  */
-static bool build_room_template_type(struct chunk *c, int y0, int x0, int typ,
-									 int rating)
+static bool build_room_template_type(struct dun_data *dun, struct chunk *c,
+									 int y0, int x0, int typ, int rating)
 {
 	struct room_template *room = random_room_template(typ, rating);
 	
@@ -1071,8 +1089,7 @@ static bool build_room_template_type(struct chunk *c, int y0, int x0, int typ,
 		return false;
 
 	/* Build the room */
-	if (!build_room_template(c, y0, x0, room->hgt, room->wid, room->dor,
-							 room->text, room->tval))
+	if (!build_room_template(dun, c, y0, x0, room))
 		return false;
 
 	ROOM_LOG("Room template (%s)", room->name);
@@ -1082,18 +1099,19 @@ static bool build_room_template_type(struct chunk *c, int y0, int x0, int typ,
 
 /**
  * Build a vault from its string representation.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param v pointer to the vault template
  * \return success
  */
-bool build_vault(struct chunk *c, int y0, int x0, struct vault *v)
+bool build_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 struct vault *v)
 {
 	const char *data = v->text;
 	int y1, x1, y2, x2;
-	int x, y, races_local = 0;
-	const char *t;
+	int i, x, y, races_local = 0;
 	char racial_symbol[30] = "";
 	bool icky;
 
@@ -1101,7 +1119,7 @@ bool build_vault(struct chunk *c, int y0, int x0, struct vault *v)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, v->hgt + 2, v->wid + 2))
+		if (!find_space(dun, &y0, &x0, v->hgt + 2, v->wid + 2))
 			return (false);
 	}
 
@@ -1115,218 +1133,218 @@ bool build_vault(struct chunk *c, int y0, int x0, struct vault *v)
 	generate_mark(c, y1, x1, y2, x2, SQUARE_MON_RESTRICT);
 
 	/* Place dungeon features and objects */
-	for (t = data, y = y1; y <= y2 && *t; y++) {
-		for (x = x1; x <= x2 && *t; x++, t++) {
-			/* Skip non-grids */
-			if (*t == ' ') continue;
-
-			/* Lay down a floor */
-			square_set_feat(c, y, x, FEAT_FLOOR);
-
-			/* Debugging assertion */
-			assert(square_isempty(c, y, x));
-
-			/* By default vault squares are marked icky */
-			icky = true;
-
-			/* Analyze the grid */
-			switch (*t) {
-			case '%': {
-				/* In this case, the square isn't really part of the
-				 * vault, but rather is part of the "door step" to the
-				 * vault. We don't mark it icky so that the tunneling
-				 * code knows its allowed to remove this wall. */
-				set_marked_granite(c, y, x, SQUARE_WALL_OUTER);
-				icky = false;
-				break;
-			}
-				/* Inner granite wall */
-			case '#': set_marked_granite(c, y, x, SQUARE_WALL_INNER); break;
-				/* Permanent wall */
-			case '@': square_set_feat(c, y, x, FEAT_PERM); break;
-				/* Gold seam */
-			case '*': {
-				square_set_feat(c, y, x, one_in_(2) ? FEAT_MAGMA_K :
-								FEAT_QUARTZ_K);
-				break;
-			}
-				/* Rubble */
-			case ':': {
-				square_set_feat(c, y, x, one_in_(2) ? FEAT_PASS_RUBBLE :
-								FEAT_RUBBLE);
-				break;
-			}
-				/* Secret door */
-			case '+': place_secret_door(c, y, x); break;
-				/* Trap */
-			case '^': if (one_in_(4)) place_trap(c, y, x, -1, c->depth); break;
-				/* Treasure or a trap */
-			case '&': {
-				if (randint0(100) < 75) {
-					place_object(c, y, x, c->depth, false, false, ORIGIN_VAULT, 0);
-				} else if (one_in_(4)) {
-					place_trap(c, y, x, -1, c->depth);
-				}
-				break;
-			}
-				/* Stairs */
-			case '<': square_set_feat(c, y, x, FEAT_LESS); break;
-			case '>': {
-				/* No down stairs at bottom or on quests */
-				if (is_quest(c->depth) || c->depth >= z_info->max_depth - 1)
-					square_set_feat(c, y, x, FEAT_LESS);
-				else
-					square_set_feat(c, y, x, FEAT_MORE);
-				break;
-			}
-				/* Lava */
-			case '`': square_set_feat(c, y, x, FEAT_LAVA); break;
-				/* Included to allow simple inclusion of FA vaults */
-			case '/': /*square_set_feat(c, y, x, FEAT_WATER)*/; break;
-			case ';': /*square_set_feat(c, y, x, FEAT_TREE)*/; break;
+	for (i = 0; i < v->num_grids; i++) {
+		char t = data[v->grids[i]];
+
+		y = y1 + v->grids[i] / v->wid;
+		x = x1 + v->grids[i] % v->wid;
+
+		/* Lay down a floor */
+		square_set_feat(c, y, x, FEAT_FLOOR);
+
+		/* Debugging assertion */
+		assert(square_isempty(c, y, x));
+
+		/* By default vault squares are marked icky */
+		icky = true;
+
+		/* Analyze the grid */
+		switch (t) {
+		case '%': {
+			/* In this case, the square isn't really part of the
+			 * vault, but rather is part of the "door step" to the
+			 * vault. We don't mark it icky so that the tunneling
+			 * code knows its allowed to remove this wall. */
+			set_marked_granite(c, y, x, SQUARE_WALL_OUTER);
+			icky = false;
+			break;
+		}
+			/* Inner granite wall */
+		case '#': set_marked_granite(c, y, x, SQUARE_WALL_INNER); break;
+			/* Permanent wall */
+		case '@': square_set_feat(c, y, x, FEAT_PERM); break;
+			/* Gold seam */
+		case '*': {
+			square_set_feat(c, y, x, one_in_(2) ? FEAT_MAGMA_K :
+							FEAT_QUARTZ_K);
+			break;
+		}
+			/* Rubble */
+		case ':': {
+			square_set_feat(c, y, x, one_in_(2) ? FEAT_PASS_RUBBLE :
+							FEAT_RUBBLE);
+			break;
+		}
+			/* Secret door */
+		case '+': place_secret_door(c, y, x); break;
+			/* Trap */
+		case '^': if (one_in_(4)) place_trap(c, y, x, -1, c->depth); break;
+			/* Treasure or a trap */
+		case '&': {
+			if (randint0(100) < 75) {
+				place_object(c, y, x, c->depth, false, false, ORIGIN_VAULT, 0);
+			} else if (one_in_(4)) {
+				place_trap(c, y, x, -1, c->depth);
 			}
-
-			/* Part of a vault */
-			sqinfo_on(c->squares[y][x].info, SQUARE_ROOM);
-			if (icky) sqinfo_on(c->squares[y][x].info, SQUARE_VAULT);
+			break;
+		}
+			/* Stairs */
+		case '<': square_set_feat(c, y, x, FEAT_LESS); break;
+		case '>': {
+			/* No down stairs at bottom or on quests */
+			if (is_quest(c->depth) || c->depth >= z_info->max_depth - 1)
+				square_set_feat(c, y, x, FEAT_LESS);
+			else
+				square_set_feat(c, y, x, FEAT_MORE);
+			break;
+		}
+			/* Lava */
+		case '`': square_set_feat(c, y, x, FEAT_LAVA); break;
+			/* Included to allow simple inclusion of FA vaults */
+		case '/': /*square_set_feat(c, y, x, FEAT_WATER)*/; break;
+		case ';': /*square_set_feat(c, y, x, FEAT_TREE)*/; break;
 		}
+
+		/* Part of a vault */
+		sqinfo_on(c->squares[y][x].info, SQUARE_ROOM);
+		if (icky) sqinfo_on(c->squares[y][x].info, SQUARE_VAULT);
 	}
 
 
 	/* Place regular dungeon monsters and objects */
-	for (t = data, y = y1; y <= y2 && *t; y++) {
-		for (x = x1; x <= x2 && *t; x++, t++) {
-			/* Hack -- skip "non-grids" */
-			if (*t == ' ') continue;
-
-			/* Most alphabetic characters signify monster races. */
-			if (isalpha(*t) && (*t != 'x') && (*t != 'X')) {
-				/* If the symbol is not yet stored, ... */
-				if (!strchr(racial_symbol, *t)) {
-					/* ... store it for later processing. */
-					if (races_local < 30)
-						racial_symbol[races_local++] = *t;
-				}
+	for (i = 0; i < v->num_fixups; i++) {
+		char t = data[v->fixups[i]];
+
+		y = y1 + v->fixups[i] / v->wid;
+		x = x1 + v->fixups[i] % v->wid;
+
+		/* Most alphabetic characters signify monster races. */
+		if (isalpha(t) && (t != 'x') && (t != 'X')) {
+			/* If the symbol is not yet stored, ... */
+			if (!strchr(racial_symbol, t)) {
+				/* ... store it for later processing. */
+				if (races_local < 30)
+					racial_symbol[races_local++] = t;
 			}
+		}
 
-			/* Otherwise, analyze the symbol */
-			else
-				switch (*t) {
-					/* An ordinary monster, object (sometimes good), or trap. */
-				case '1': {
-					if (one_in_(2)) {
-						pick_and_place_monster(c, y, x, c->depth , true, true,
-											   ORIGIN_DROP_VAULT);
-					} else if (one_in_(2)) {
-						place_object(c, y, x, c->depth,
-									 one_in_(8) ? true : false, false,
-									 ORIGIN_VAULT, 0);
-					} else if (one_in_(4)) {
-						place_trap(c, y, x, -1, c->depth);
-					}
-					break;
-				}
-					/* Slightly out of depth monster. */
-				case '2': pick_and_place_monster(c, y, x, c->depth + 5, true, true, ORIGIN_DROP_VAULT); break;
-					/* Slightly out of depth object. */
-				case '3': place_object(c, y, x, c->depth + 3, false, false, 
-									   ORIGIN_VAULT, 0); break;
-					/* Monster and/or object */
-				case '4': {
-					if (one_in_(2))
-						pick_and_place_monster(c, y, x, c->depth + 3, true, 
-											   true, ORIGIN_DROP_VAULT);
-					if (one_in_(2))
-						place_object(c, y, x, c->depth + 7, false, false,
-									 ORIGIN_VAULT, 0);
-					break;
-				}
-					/* Out of depth object. */
-				case '5': place_object(c, y, x, c->depth + 7, false, false,
-									   ORIGIN_VAULT, 0); break;
-					/* Out of depth monster. */
-				case '6': pick_and_place_monster(c, y, x, c->depth + 11, true, true, ORIGIN_DROP_VAULT); break;
-					/* Very out of depth object. */
-				case '7': place_object(c, y, x, c->depth + 15, false, false,
-									   ORIGIN_VAULT, 0); break;
-					/* Very out of depth monster. */
-				case '0': pick_and_place_monster(c, y, x, c->depth + 20, true, true, ORIGIN_DROP_VAULT); break;
-					/* Meaner monster, plus treasure */
-				case '9': {
-					pick_and_place_monster(c, y, x, c->depth + 9, true, true,
+		/* Otherwise, analyze the symbol */
+		else
+			switch (t) {
+				/* An ordinary monster, object (sometimes good), or trap. */
+			case '1': {
+				if (one_in_(2)) {
+					pick_and_place_monster(c, y, x, c->depth , true, true,
 										   ORIGIN_DROP_VAULT);
-					place_object(c, y, x, c->depth + 7, true, false,
+				} else if (one_in_(2)) {
+					place_object(c, y, x, c->depth,
+								 one_in_(8) ? true : false, false,
 								 ORIGIN_VAULT, 0);
-					break;
+				} else if (one_in_(4)) {
+					place_trap(c, y, x, -1, c->depth);
 				}
-					/* Nasty monster and treasure */
-				case '8': {
-					pick_and_place_monster(c, y, x, c->depth + 40, true, true,
-										   ORIGIN_DROP_VAULT);
-					place_object(c, y, x, c->depth + 20, true, true,
+				break;
+			}
+				/* Slightly out of depth monster. */
+			case '2': pick_and_place_monster(c, y, x, c->depth + 5, true, true, ORIGIN_DROP_VAULT); break;
+				/* Slightly out of depth object. */
+			case '3': place_object(c, y, x, c->depth + 3, false, false, 
+								   ORIGIN_VAULT, 0); break;
+				/* Monster and/or object */
+			case '4': {
+				if (one_in_(2))
+					pick_and_place_monster(c, y, x, c->depth + 3, true, 
+										   true, ORIGIN_DROP_VAULT);
+				if (one_in_(2))
+					place_object(c, y, x, c->depth + 7, false, false,
 								 ORIGIN_VAULT, 0);
-					break;
-				}
-					/* A chest. */
-				case '~': place_object(c, y, x, c->depth + 5, false, false,
-									   ORIGIN_VAULT, TV_CHEST); break;
-					/* Treasure. */
-				case '$': place_gold(c, y, x, c->depth, ORIGIN_VAULT);break;
-					/* Armour. */
-				case ']': {
-					int	tval = 0, temp = one_in_(3) ? randint1(9) : randint1(8);
-					switch (temp) {
-					case 1: tval = TV_BOOTS; break;
-					case 2: tval = TV_GLOVES; break;
-					case 3: tval = TV_HELM; break;
-					case 4: tval = TV_CROWN; break;
-					case 5: tval = TV_SHIELD; break;
-					case 6: tval = TV_CLOAK; break;
-					case 7: tval = TV_SOFT_ARMOR; break;
-					case 8: tval = TV_HARD_ARMOR; break;
-					case 9: tval = TV_DRAG_ARMOR; break;
-					}
-					place_object(c, y, x, c->depth + 3, true, false,
-								 ORIGIN_VAULT, tval);
-					break;
-				}
-					/* Weapon. */
-				case '|': {
-					int	tval = 0, temp = randint1(4);
-					switch (temp) {
-					case 1: tval = TV_SWORD; break;
-					case 2: tval = TV_POLEARM; break;
-					case 3: tval = TV_HAFTED; break;
-					case 4: tval = TV_BOW; break;
-					}
-					place_object(c, y, x, c->depth + 3, true, false,
-								 ORIGIN_VAULT, tval);
-					break;
+				break;
+			}
+				/* Out of depth object. */
+			case '5': place_object(c, y, x, c->depth + 7, false, false,
+								   ORIGIN_VAULT, 0); break;
+				/* Out of depth monster. */
+			case '6': pick_and_place_monster(c, y, x, c->depth + 11, true, true, ORIGIN_DROP_VAULT); break;
+				/* Very out of depth object. */
+			case '7': place_object(c, y, x, c->depth + 15, false, false,
+								   ORIGIN_VAULT, 0); break;
+				/* Very out of depth monster. */
+			case '0': pick_and_place_monster(c, y, x, c->depth + 20, true, true, ORIGIN_DROP_VAULT); break;
+				/* Meaner monster, plus treasure */
+			case '9': {
+				pick_and_place_monster(c, y, x, c->depth + 9, true, true,
+									   ORIGIN_DROP_VAULT);
+				place_object(c, y, x, c->depth + 7, true, false,
+							 ORIGIN_VAULT, 0);
+				break;
+			}
+				/* Nasty monster and treasure */
+			case '8': {
+				pick_and_place_monster(c, y, x, c->depth + 40, true, true,
+									   ORIGIN_DROP_VAULT);
+				place_object(c, y, x, c->depth + 20, true, true,
+							 ORIGIN_VAULT, 0);
+				break;
+			}
+				/* A chest. */
+			case '~': place_object(c, y, x, c->depth + 5, false, false,
+								   ORIGIN_VAULT, TV_CHEST); break;
+				/* Treasure. */
+			case '$': place_gold(c, y, x, c->depth, ORIGIN_VAULT);break;
+				/* Armour. */
+			case ']': {
+				int	tval = 0, temp = one_in_(3) ? randint1(9) : randint1(8);
+				switch (temp) {
+				case 1: tval = TV_BOOTS; break;
+				case 2: tval = TV_GLOVES; break;
+				case 3: tval = TV_HELM; break;
+				case 4: tval = TV_CROWN; break;
+				case 5: tval = TV_SHIELD; break;
+				case 6: tval = TV_CLOAK; break;
+				case 7: tval = TV_SOFT_ARMOR; break;
+				case 8: tval = TV_HARD_ARMOR; break;
+				case 9: tval = TV_DRAG_ARMOR; break;
 				}
-					/* Ring. */
-				case '=': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_RING); break;
-					/* Amulet. */
-				case '"': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_AMULET); break;
-					/* Potion. */
-				case '!': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_POTION); break;
-					/* Scroll. */
-				case '?': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_SCROLL); break;
-					/* Staff. */
-				case '_': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_STAFF); break;
-					/* Wand or rod. */
-				case '-': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, one_in_(2) ? TV_WAND : TV_ROD);
-					break;
-					/* Food or mushroom. */
-				case ',': place_object(c, y, x, c->depth + 3, one_in_(4), false,
-									   ORIGIN_VAULT, TV_FOOD); break;
+				place_object(c, y, x, c->depth + 3, true, false,
+							 ORIGIN_VAULT, tval);
+				break;
+			}
+				/* Weapon. */
+			case '|': {
+				int	tval = 0, temp = randint1(4);
+				switch (temp) {
+				case 1: tval = TV_SWORD; break;
+				case 2: tval = TV_POLEARM; break;
+				case 3: tval = TV_HAFTED; break;
+				case 4: tval = TV_BOW; break;
 				}
-		}
+				place_object(c, y, x, c->depth + 3, true, false,
+							 ORIGIN_VAULT, tval);
+				break;
+			}
+				/* Ring. */
+			case '=': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_RING); break;
+				/* Amulet. */
+			case '"': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_AMULET); break;
+				/* Potion. */
+			case '!': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_POTION); break;
+				/* Scroll. */
+			case '?': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_SCROLL); break;
+				/* Staff. */
+			case '_': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_STAFF); break;
+				/* Wand or rod. */
+			case '-': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, one_in_(2) ? TV_WAND : TV_ROD);
+				break;
+				/* Food or mushroom. */
+			case ',': place_object(c, y, x, c->depth + 3, one_in_(4), false,
+								   ORIGIN_VAULT, TV_FOOD); break;
+			}
 	}
 
 	/* Place specified monsters */
@@ -1337,6 +1355,7 @@ bool build_vault(struct chunk *c, int y0, int x0, struct vault *v)
 
 /**
  * Helper function for building vaults.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -1344,7 +1363,8 @@ bool build_vault(struct chunk *c, int y0, int x0, struct vault *v)
  * \param label name of the vault type (eg "Greater vault")
  * \return success
  */
-static bool build_vault_type(struct chunk *c, int y0, int x0, const char *typ)
+static bool build_vault_type(struct dun_data *dun, struct chunk *c, int y0,
+							 int x0, const char *typ)
 {
 	struct vault *v = random_vault(c->depth, typ);
 	if (v == NULL) {
@@ -1353,7 +1373,7 @@ static bool build_vault_type(struct chunk *c, int y0, int x0, const char *typ)
 	}
 
 	/* Build the vault */
-	if (!build_vault(c, y0, x0, v))
+	if (!build_vault(dun, c, y0, x0, v))
 		return false;
 
 	ROOM_LOG("%s (%s)", typ, v->name);
@@ -1511,12 +1531,14 @@ static void hollow_out_room(struct chunk *c, int y, int x)
  * ------------------------------------------------------------------------ */
 /**
  * Build a circular room (interior radius 4-7).
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_circular(struct chunk *c, int y0, int x0, int rating)
+bool build_circular(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					int rating)
 {
 	/* Pick a room size */
 	int radius = 2 + randint1(2) + randint1(3);
@@ -1526,7 +1548,7 @@ bool build_circular(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve lots of space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, 2 * radius + 10, 2 * radius + 10))
+		if (!find_space(dun, &y0, &x0, 2 * radius + 10, 2 * radius + 10))
 			return (false);
 	}
 
@@ -1559,12 +1581,14 @@ bool build_circular(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Builds a normal rectangular room.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_simple(struct chunk *c, int y0, int x0, int rating)
+bool build_simple(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				  int rating)
 {
 	int y, x, y1, x1, y2, x2;
 	int light = false;
@@ -1575,7 +1599,7 @@ bool build_simple(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -1619,12 +1643,14 @@ bool build_simple(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Builds an overlapping rectangular room.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_overlap(struct chunk *c, int y0, int x0, int rating)
+bool build_overlap(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				   int rating)
 {
 	int y1a, x1a, y2a, x2a;
 	int y1b, x1b, y2b, x2b;
@@ -1653,7 +1679,7 @@ bool build_overlap(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -1695,6 +1721,7 @@ bool build_overlap(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Builds a cross-shaped room.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -1707,7 +1734,8 @@ bool build_overlap(struct chunk *c, int y0, int x0, int rating)
  * below will work for 5x5 (and perhaps even for unsymetric values like 4x3 or
  * 5x3 or 3x4 or 3x5).
  */
-bool build_crossed(struct chunk *c, int y0, int x0, int rating)
+bool build_crossed(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				   int rating)
 {
 	int y, x;
 	int height, width;
@@ -1748,7 +1776,7 @@ bool build_crossed(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -1858,6 +1886,7 @@ bool build_crossed(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Build a large room with an inner room.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -1870,7 +1899,8 @@ bool build_crossed(struct chunk *c, int y0, int x0, int rating)
  *	4 - An inner room with a checkerboard
  *	5 - An inner room with four compartments
  */
-bool build_large(struct chunk *c, int y0, int x0, int rating)
+bool build_large(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 int rating)
 {
 	int y, x, y1, x1, y2, x2;
 	int height = 9;
@@ -1883,7 +1913,7 @@ bool build_large(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -2070,6 +2100,7 @@ bool build_large(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Build a monster nest
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -2092,7 +2123,8 @@ bool build_large(struct chunk *c, int y0, int x0, int rating)
  *
  * Monster nests will never contain unique monsters.
  */
-bool build_nest(struct chunk *c, int y0, int x0, int rating)
+bool build_nest(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				int rating)
 {
 	int y, x, y1, x1, y2, x2;
 	int i;
@@ -2106,7 +2138,7 @@ bool build_nest(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -2138,13 +2170,13 @@ bool build_nest(struct chunk *c, int y0, int x0, int rating)
 	generate_hole(c, y1-1, x1-1, y2+1, x2+1, FEAT_CLOSED);
 
 	/* Decide on the pit type */
-	set_pit_type(c->depth, 2);
+	set_pit_type(dun, c->depth, 2);
 
 	/* Chance of objects on the floor */
 	alloc_obj = dun->pit_type->obj_rarity;
 	
 	/* Prepare allocation table */
-	get_mon_num_prep(mon_pit_hook);
+	mon_pit_prep(dun->pit_type);
 
 	/* Pick some monster types */
 	for (i = 0; i < 64; i++) {
@@ -2186,6 +2218,7 @@ bool build_nest(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Build a monster pit
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -2219,7 +2252,8 @@ bool build_nest(struct chunk *c, int y0, int x0, int rating)
  *
  * Like monster nests, monster pits will never contain unique monsters.
  */
-bool build_pit(struct chunk *c, int y0, int x0, int rating)
+bool build_pit(struct dun_data *dun, struct chunk *c, int y0, int x0,
+			   int rating)
 {
 	struct monster_race *what[16];
 	int i, j, y, x, y1, x1, y2, x2;
@@ -2231,7 +2265,7 @@ bool build_pit(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height + 2, width + 2))
+		if (!find_space(dun, &y0, &x0, height + 2, width + 2))
 			return (false);
 	}
 
@@ -2257,13 +2291,13 @@ bool build_pit(struct chunk *c, int y0, int x0, int rating)
 	generate_hole(c, y1-1, x1-1, y2+1, x2+1, FEAT_CLOSED);
 
 	/* Decide on the pit type */
-	set_pit_type(c->depth, 1);
+	set_pit_type(dun, c->depth, 1);
 
 	/* Chance of objects on the floor */
 	alloc_obj = dun->pit_type->obj_rarity;
 	
 	/* Prepare allocation table */
-	get_mon_num_prep(mon_pit_hook);
+	mon_pit_prep(dun->pit_type);
 
 	/* Pick some monster types */
 	for (i = 0; i < 16; i++) {
@@ -2377,15 +2411,17 @@ bool build_pit(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Build a template room
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
 */
-bool build_template(struct chunk *c, int y0, int x0, int rating)
+bool build_template(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					int rating)
 {
 	/* All room templates currently have type 1 */
-	return build_room_template_type(c, y0, x0, 1, rating);
+	return build_room_template_type(dun, c, y0, x0, 1, rating);
 }
 
 
@@ -2393,49 +2429,56 @@ bool build_template(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Build an interesting room.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_interesting(struct chunk *c, int y0, int x0, int rating)
+bool build_interesting(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					   int rating)
 {
-	return build_vault_type(c, y0, x0, "Interesting room");
+	return build_vault_type(dun, c, y0, x0, "Interesting room");
 }
 
 
 /**
  * Build a lesser vault.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_lesser_vault(struct chunk *c, int y0, int x0, int rating)
+bool build_lesser_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						int rating)
 {
 	if (!streq(dun->profile->name, "classic") && (one_in_(2)))
-		return build_vault_type(c, y0, x0, "Lesser vault (new)");
-	return build_vault_type(c, y0, x0, "Lesser vault");
+		return build_vault_type(dun, c, y0, x0, "Lesser vault (new)");
+	return build_vault_type(dun, c, y0, x0, "Lesser vault");
 }
 
 
 /**
  * Build a medium vault.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_medium_vault(struct chunk *c, int y0, int x0, int rating)
+bool build_medium_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						int rating)
 {
 	if (!streq(dun->profile->name, "classic") && (one_in_(2)))
-		return build_vault_type(c, y0, x0, "Medium vault (new)");
-	return build_vault_type(c, y0, x0, "Medium vault");
+		return build_vault_type(dun, c, y0, x0, "Medium vault (new)");
+	return build_vault_type(dun, c, y0, x0, "Medium vault");
 }
 
 
 /**
  * Build a greater vaults.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -2462,7 +2505,8 @@ bool build_medium_vault(struct chunk *c, int y0, int x0, int rating)
  * 50-59  1.8 -  2.1%
  * 0-49   0.0 -  1.0%
  */
-bool build_greater_vault(struct chunk *c, int y0, int x0, int rating)
+bool build_greater_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						 int rating)
 {
 	int i;
 	int numerator   = 2;
@@ -2484,19 +2528,21 @@ bool build_greater_vault(struct chunk *c, int y0, int x0, int rating)
 	if (!streq(dun->profile->name, "classic") && !one_in_(3)) return false;
 
 	if (!streq(dun->profile->name, "classic") && (one_in_(2)))
-		return build_vault_type(c, y0, x0, "Greater vault (new)");
-	return build_vault_type(c, y0, x0, "Greater vault");
+		return build_vault_type(dun, c, y0, x0, "Greater vault (new)");
+	return build_vault_type(dun, c, y0, x0, "Greater vault");
 }
 
 
 /**
  * Moria room (from Oangband).  Uses the "starburst room" code.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \return success
  */
-bool build_moria(struct chunk *c, int y0, int x0, int rating)
+bool build_moria(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 int rating)
 {
 	int y1, x1, y2, x2;
 	int i;
@@ -2527,7 +2573,7 @@ bool build_moria(struct chunk *c, int y0, int x0, int rating)
 
 		/* Find and reserve some space in the dungeon.  Get center of room. */
 		if ((y0 >= c->height) || (x0 >= c->width)) {
-			if (!find_space(&y0, &x0, height, width)) {
+			if (!find_space(dun, &y0, &x0, height, width)) {
 				if (i == 0) continue;  /* Failed first attempt */
 				if (i == 1) return (false);  /* Failed second attempt */
 			} else break;  /* Success */
@@ -2560,6 +2606,7 @@ bool build_moria(struct chunk *c, int y0, int x0, int rating)
 
 /**
  * Rooms of chambers
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -2585,7 +2632,8 @@ bool build_moria(struct chunk *c, int y0, int x0, int rating)
  * monsters.
  *
  */
-bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating)
+bool build_room_of_chambers(struct dun_data *dun, struct chunk *c, int y0,
+							int x0, int rating)
 {
 	int i, d;
 	int area, num_chambers;
@@ -2604,7 +2652,7 @@ bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space in the dungeon.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height, width))
+		if (!find_space(dun, &y0, &x0, height, width))
 			return (false);
 	}
 
@@ -2856,7 +2904,7 @@ bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating)
 	}
 
 	/*** Now we get to place the monsters. ***/
-	get_chamber_monsters(c, y1, x1, y2, x2, name, height * width);
+	get_chamber_monsters(dun, c, y1, x1, y2, x2, name, height * width);
 
 	/* Increase the level rating */
 	c->mon_rating += 10;
@@ -2872,6 +2920,7 @@ bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating)
  * A single starburst-shaped room of extreme size, usually dotted or
  * even divided with irregularly-shaped fields of rubble. No special
  * monsters.  Appears deeper than level 40.
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param y0 co-ordinates of the centre; out of chunk bounds invoke find_space()
  * \param x0 co-ordinates of the centre; out of chunk bounds invoke find_space()
@@ -2881,7 +2930,8 @@ bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating)
  * priority rooms in the dungeon.  They should be rare, so as not to
  * interfere with greater vaults.
  */
-bool build_huge(struct chunk *c, int y0, int x0, int rating)
+bool build_huge(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				int rating)
 {
 	bool light;
 
@@ -2905,7 +2955,7 @@ bool build_huge(struct chunk *c, int y0, int x0, int rating)
 
 	/* Find and reserve some space.  Get center of room. */
 	if ((y0 >= c->height) || (x0 >= c->width)) {
-		if (!find_space(&y0, &x0, height, width))
+		if (!find_space(dun, &y0, &x0, height, width))
 			return (false);
 	}
 
@@ -2949,9 +2999,24 @@ bool build_huge(struct chunk *c, int y0, int x0, int rating)
 	return (true);
 }
 
+/**
+ * Call the room profile's builder, timing it if generation is being timed
+ */
+static bool room_build_timed(struct dun_data *dun, struct chunk *c, int y0,
+							 int x0, struct room_profile profile)
+{
+	bool built;
+
+	GEN_STAGE_ENTER(GEN_STAGE_ROOMS);
+	built = profile.builder(dun, c, y0, x0, profile.rating);
+	GEN_STAGE_LEAVE(GEN_STAGE_ROOMS);
+	return built;
+}
+
 /**
  * Attempt to build a room of the given type at the given block
  *
+ * \param dun the current generation data
  * \param c the chunk the room is being built in
  * \param by0 block co-ordinates of the top left block
  * \param bx0 block co-ordinates of the top left block
@@ -2966,8 +3031,8 @@ bool build_huge(struct chunk *c, int y0, int x0, int rating)
  * Note that we restrict the number of pits/nests to reduce
  * the chance of overflowing the monster list during level creation.
  */
-bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
-	bool finds_own_space)
+bool room_build(struct dun_data *dun, struct chunk *c, int by0, int bx0,
+				struct room_profile profile, bool finds_own_space)
 {
 	/* Extract blocks */
 	int by1 = by0;
@@ -2991,7 +3056,7 @@ bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
 	/* Does the profile allocate space, or the room find it? */
 	if (finds_own_space) {
 		/* Try to build a room, pass silly place so room finds its own */
-		if (!profile.builder(c, c->height, c->width, profile.rating))
+		if (!room_build_timed(dun, c, c->height, c->width, profile))
 			return false;
 	} else {
 		/* Never run off the screen */
@@ -3011,7 +3076,7 @@ bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
 		x = ((bx1 + bx2 + 1) * dun->block_wid) / 2;
 
 		/* Try to build a room */
-		if (!profile.builder(c, y, x, profile.rating)) return false;
+		if (!room_build_timed(dun, c, y, x, profile)) return false;
 
 		/* Save the room location */
 		if (dun->cent_n < z_info->level_room_max) {
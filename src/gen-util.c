@@ -225,8 +225,48 @@ static bool cave_find_in_range(struct chunk *c, int *y, int y1, int y2, int *x,
 }
 
 
+/**
+ * Start keeping the list of empty grids which find_empty() draws from.
+ *
+ * square_note_empty() adds grids to the list as they become empty.  Grids are
+ * only taken out when a draw finds them filled, so the list may hold some
+ * which are no longer empty, but never misses one which is.
+ * \param c current chunk
+ */
+static void track_empty_grids(struct chunk *c)
+{
+	int y, x, n = c->height * c->width;
+
+	c->empty_grids = mem_alloc(n * sizeof(int));
+	c->empty_slots = mem_zalloc(n * sizeof(int));
+	c->empty_num = 0;
+
+	for (y = 0; y < c->height; y++)
+		for (x = 0; x < c->width; x++)
+			square_note_empty(c, y, x);
+}
+
+
+/**
+ * Stop keeping the list of empty grids, once generation is done with it.
+ * \param c current chunk
+ */
+void untrack_empty_grids(struct chunk *c)
+{
+	mem_free(c->empty_grids);
+	mem_free(c->empty_slots);
+	c->empty_grids = NULL;
+	c->empty_slots = NULL;
+	c->empty_num = 0;
+}
+
+
 /**
  * Locate an empty square for 0 <= y < ymax, 0 <= x < xmax.
+ *
+ * Draws from the chunk's list of empty grids, dropping any which have been
+ * filled since they were listed, so each call costs about the same however
+ * crowded the level has become.
  * \param c current chunk
  * \param y found y co-ordinate
  * \param x found x co-ordinate
@@ -234,7 +274,24 @@ static bool cave_find_in_range(struct chunk *c, int *y, int y1, int y2, int *x,
  */
 bool find_empty(struct chunk *c, int *y, int *x)
 {
-    return cave_find(c, y, x, square_isempty);
+	if (!c->empty_grids)
+		track_empty_grids(c);
+
+	while (c->empty_num) {
+		int i = randint0(c->empty_num);
+		int grid = c->empty_grids[i], last;
+
+		i_to_yx(grid, c->width, y, x);
+		if (square_isempty(c, *y, *x)) return true;
+
+		/* Filled since it was listed, so swap the last grid into its slot */
+		last = c->empty_grids[--c->empty_num];
+		c->empty_grids[i] = last;
+		c->empty_slots[last] = i + 1;
+		c->empty_slots[grid] = 0;
+	}
+
+	return false;
 }
 
 
@@ -614,6 +671,8 @@ bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin)
     int x = 0, y = 0;
     int tries = 0;
 
+    GEN_STAGE_ENTER(GEN_STAGE_OBJECTS);
+
     /* Pick a "legal" spot */
     while (tries < 2000) {
 		tries++;
@@ -627,7 +686,10 @@ bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin)
 		if (set & SET_ROOM && square_isroom(c, y, x)) break;
     }
 
-    if (tries == 2000) return false;
+    if (tries == 2000) {
+		GEN_STAGE_LEAVE(GEN_STAGE_OBJECTS);
+		return false;
+	}
 
     /* Place something */
     switch (typ) {
@@ -638,6 +700,8 @@ bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin)
     case TYP_GOOD: place_object(c, y, x, depth, true, false, origin, 0); break;
     case TYP_GREAT: place_object(c, y, x, depth, true, true, origin, 0); break;
     }
+
+    GEN_STAGE_LEAVE(GEN_STAGE_OBJECTS);
     return true;
 }
 
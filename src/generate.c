@@ -39,10 +39,14 @@
 #include "mon-make.h"
 #include "mon-spell.h"
 #include "monster.h"
+#include "obj-pile.h"
 #include "obj-tval.h"
 #include "obj-util.h"
 #include "object.h"
 #include "player-history.h"
+#include "player-util.h"
+#include "profile.h"
+#include "target.h"
 #include "trap.h"
 #include "z-queue.h"
 #include "z-type.h"
@@ -53,7 +57,6 @@
 struct pit_profile *pit_info;
 struct vault *vaults;
 static struct cave_profile *cave_profiles;
-struct dun_data *dun;
 struct room_template *room_templates;
 
 static const struct {
@@ -290,6 +293,7 @@ static void cleanup_profile(void)
 		string_free((char *) cave_profiles[i].name);
 	}
 	mem_free(cave_profiles);
+	gen_stats_reset();
 }
 
 static struct file_parser profile_parser = {
@@ -419,8 +423,56 @@ static errr run_parse_room(struct parser *p) {
 	return parse_file_quit_not_found(p, "room_template");
 }
 
+/**
+ * List the offsets into a template's text of the grids which the room
+ * builders act on, in the order they visit them, so that placing a room
+ * or vault need not walk its blank grids.
+ * \param text the template text, row by row
+ * \param size the number of grids the template covers
+ * \param want which grids to list
+ * \param num the number listed
+ * \return the offsets
+ */
+static u16b *template_grids(const char *text, int size, bool (*want)(char),
+							u16b *num)
+{
+	u16b *grids = mem_zalloc(MAX(size, 1) * sizeof(*grids));
+	int i;
+
+	*num = 0;
+	for (i = 0; text && i < size && text[i]; i++)
+		if (want(text[i]))
+			grids[(*num)++] = i;
+
+	return grids;
+}
+
+/**
+ * True for template grids that are part of the room or vault.
+ */
+static bool template_grid_laid(char ch)
+{
+	return ch != ' ';
+}
+
+/**
+ * True for vault grids that get monsters or objects once the vault is laid.
+ */
+static bool vault_grid_filled(char ch)
+{
+	if (isalpha((unsigned char)ch))
+		return (ch != 'x') && (ch != 'X');
+	return strchr("1234567890~$]|=\"!?_-,", ch) != NULL;
+}
+
 static errr finish_parse_room(struct parser *p) {
+	struct room_template *t;
+
 	room_templates = parser_priv(p);
+	for (t = room_templates; t; t = t->next)
+		t->grids = template_grids(t->text, t->hgt * t->wid,
+								  template_grid_laid, &t->num_grids);
+
 	parser_destroy(p);
 	return 0;
 }
@@ -432,6 +484,7 @@ static void cleanup_room(void)
 		next = t->next;
 		mem_free(t->name);
 		mem_free(t->text);
+		mem_free(t->grids);
 		mem_free(t);
 	}
 }
@@ -567,7 +620,16 @@ static errr run_parse_vault(struct parser *p) {
 }
 
 static errr finish_parse_vault(struct parser *p) {
+	struct vault *v;
+
 	vaults = parser_priv(p);
+	for (v = vaults; v; v = v->next) {
+		v->grids = template_grids(v->text, v->hgt * v->wid,
+								  template_grid_laid, &v->num_grids);
+		v->fixups = template_grids(v->text, v->hgt * v->wid,
+								   vault_grid_filled, &v->num_fixups);
+	}
+
 	parser_destroy(p);
 	return 0;
 }
@@ -580,6 +642,8 @@ static void cleanup_vault(void)
 		mem_free(v->name);
 		mem_free(v->typ);
 		mem_free(v->text);
+		mem_free(v->grids);
+		mem_free(v->fixups);
 		mem_free(v);
 	}
 }
@@ -829,64 +893,145 @@ static void cave_clear(struct chunk *c, struct player *p)
 
 
 /**
- * Generate a random level.
- *
- * Confusingly, this function also generate the town level (level 0).
- * \param c is the level we're going to end up with, in practice the global cave
- * \param p is the current player struct, in practice the global player
+ * Where the time building levels goes, for each profile; only gathered while
+ * gen_stats_on is set, so that ordinary play pays one test per stage
  */
-void cave_generate(struct chunk **c, struct player *p)
+bool gen_stats_on = false;
+
+static struct gen_stats *gen_stats;
+static struct gen_stats *gen_stats_cur;
+
+static const char *gen_stage_names[] = {
+	"rooms",
+	"tunnels",
+	"streamers",
+	"objects",
+	"monsters",
+	"connect"
+};
+
+/**
+ * The stages being timed, innermost last, and when the innermost one was
+ * last charged for
+ */
+static int gen_stage_stack[GEN_STAGE_MAX];
+static int gen_stage_depth;
+static double gen_stage_mark;
+
+const char *gen_stage_name(int stage)
 {
-	const char *error = "no generation";
-	int i, y, x, tries = 0;
-	struct chunk *chunk = NULL;
+	assert(stage >= 0 && stage < GEN_STAGE_MAX);
+	return gen_stage_names[stage];
+}
 
-	assert(c);
+/**
+ * Charge the stage being timed with the time since it was last charged
+ */
+static void gen_stage_charge(void)
+{
+	double now = profile_now();
 
-	/* Forget old level */
-	if (p->cave && (*c == cave)) {
-		int x, y;
+	if (gen_stage_depth && gen_stats_cur)
+		gen_stats_cur->stage[gen_stage_stack[gen_stage_depth - 1]] +=
+			now - gen_stage_mark;
+	gen_stage_mark = now;
+}
 
-		/* Deal with artifacts */
-		for (y = 0; y < (*c)->height; y++) {
-			for (x = 0; x < (*c)->width; x++) {
-				struct object *obj = square_object(*c, y, x);
-				while (obj) {
-					if (obj->artifact) {
-						bool found = obj->known && obj->known->artifact;
-						if (OPT(p, birth_lose_arts) || found) {
-							history_lose_artifact(p, obj->artifact);
-						} else {
-							obj->artifact->created = false;
-						}
-					}
+void gen_stage_enter(int stage)
+{
+	/* Stages don't go inside themselves, so this can't overflow */
+	assert(gen_stage_depth < (int)N_ELEMENTS(gen_stage_stack));
+	gen_stage_charge();
+	gen_stage_stack[gen_stage_depth++] = stage;
+}
 
-					obj = obj->next;
-				}
-			}
-		}
+void gen_stage_leave(int stage)
+{
+	if (!gen_stage_depth) return;
+	gen_stage_charge();
+	gen_stage_depth--;
+}
 
-		/* Free the known cave */
-		cave_free(p->cave);
-		p->cave = NULL;
-	}
+/**
+ * Forget what has been gathered so far
+ */
+void gen_stats_reset(void)
+{
+	mem_free(gen_stats);
+	gen_stats = NULL;
+	gen_stats_cur = NULL;
+	gen_stage_depth = 0;
+}
 
-	/* Free the old cave */
-	if (*c) {
-		cave_clear(*c, p);
-		*c = NULL;
-	}
+/**
+ * Get what has been gathered for the profile with the given index, returning
+ * the profile's name, or NULL once there are no more profiles
+ */
+const char *gen_stats_get(int profile, struct gen_stats *stats)
+{
+	if (profile < 0 || profile >= z_info->profile_max) return NULL;
+
+	if (gen_stats)
+		*stats = gen_stats[profile];
+	else
+		memset(stats, 0, sizeof(*stats));
+	return cave_profiles[profile].name;
+}
+
+/**
+ * Start gathering for one try at building a level with the given profile
+ */
+static void gen_stats_begin(const struct cave_profile *profile)
+{
+	if (!gen_stats)
+		gen_stats = mem_zalloc(z_info->profile_max * sizeof(*gen_stats));
+	gen_stats_cur = &gen_stats[profile - cave_profiles];
+	gen_stats_cur->attempts++;
+	gen_stage_depth = 0;
+}
+
+/**
+ * Finish one try, started at start, with the error that ended it if any
+ */
+static void gen_stats_end(double start, const char *error)
+{
+	struct gen_stats *stats = gen_stats_cur;
+
+	if (!stats) return;
+	stats->total += profile_now() - start;
+	if (!error)
+		stats->levels++;
+	else if (streq(error, "too many monsters"))
+		stats->too_many_monsters++;
+	else
+		stats->no_builder++;
+	gen_stats_cur = NULL;
+}
+
+/**
+ * Build a level for the player's depth, trying again until one comes out
+ * right.  The quest monsters are added, and the generation flags cleared.
+ * If there is a stop hook, it is asked before every try, and NULL returned
+ * as soon as it says to give up.
+ */
+static struct chunk *cave_build(struct player *p, bool (*stop)(void))
+{
+	const char *error = "no generation";
+	int y, x, tries;
+	struct chunk *chunk = NULL;
 
-	/* Generate */
 	for (tries = 0; tries < 100 && error; tries++) {
-		struct dun_data dun_body;
+		struct dun_data dun_body, *dun;
+		double start = 0.0;
+
+		if (stop && stop()) return NULL;
 
 		error = NULL;
 
 		/* Mark the dungeon as being unready (to avoid artifact loss, etc) */
 		character_dungeon = false;
 
-		/* Allocate global data (will be freed when we leave the loop) */
+		/* Allocate generation data (will be freed when we leave the loop) */
 		dun = &dun_body;
 		dun->cent = mem_zalloc(z_info->level_room_max * sizeof(struct loc));
 		dun->door = mem_zalloc(z_info->level_door_max * sizeof(struct loc));
@@ -895,9 +1040,16 @@ void cave_generate(struct chunk **c, struct player *p)
 
 		/* Choose a profile and build the level */
 		dun->profile = choose_profile(p->depth);
-		chunk = dun->profile->builder(p);
+		if (gen_stats_on) {
+			start = profile_now();
+			gen_stats_begin(dun->profile);
+		}
+		PROFILE_BEGIN(dun->profile->name);
+		chunk = dun->profile->builder(dun, p);
+		PROFILE_END(dun->profile->name);
 		if (!chunk) {
 			error = "Failed to find builder";
+			if (gen_stats_on) gen_stats_end(start, error);
 			mem_free(dun->cent);
 			mem_free(dun->door);
 			mem_free(dun->wall);
@@ -923,6 +1075,9 @@ void cave_generate(struct chunk **c, struct player *p)
 			}
 		}
 
+		/* Placement is done, so stop listing empty grids */
+		untrack_empty_grids(chunk);
+
 		/* Clear generation flags. */
 		for (y = 0; y < chunk->height; y++) {
 			for (x = 0; x < chunk->width; x++) {
@@ -937,6 +1092,8 @@ void cave_generate(struct chunk **c, struct player *p)
 		if (cave_monster_max(chunk) >= z_info->level_monster_max)
 			error = "too many monsters";
 
+		if (gen_stats_on) gen_stats_end(start, error);
+
 		if (error) {
 			if (OPT(p, cheat_room)) {
 				msg("Generation restarted: %s.", error);
@@ -952,10 +1109,434 @@ void cave_generate(struct chunk **c, struct player *p)
 
 	if (error) quit_fmt("cave_generate() failed 100 times!");
 
+	return chunk;
+}
+
+
+/**
+ * Everything outside the player and the level that building a level reads
+ * or changes
+ */
+struct gen_state {
+	struct rand_state rng;
+	int *cur_num;
+	byte *max_num;
+	bool *created;
+};
+
+static void gen_state_get(struct gen_state *s)
+{
+	int i;
+
+	if (!s->cur_num) {
+		s->cur_num = mem_zalloc(z_info->r_max * sizeof(int));
+		s->max_num = mem_zalloc(z_info->r_max * sizeof(byte));
+		s->created = mem_zalloc(z_info->a_max * sizeof(bool));
+	}
+
+	Rand_stream_get(RNG_GENERATION, &s->rng);
+	for (i = 0; i < z_info->r_max; i++) {
+		s->cur_num[i] = r_info[i].cur_num;
+		s->max_num[i] = r_info[i].max_num;
+	}
+	for (i = 0; i < z_info->a_max; i++)
+		s->created[i] = a_info[i].created;
+}
+
+static void gen_state_set(const struct gen_state *s)
+{
+	int i;
+
+	Rand_stream_set(RNG_GENERATION, &s->rng);
+	for (i = 0; i < z_info->r_max; i++)
+		r_info[i].cur_num = s->cur_num[i];
+	for (i = 0; i < z_info->a_max; i++)
+		a_info[i].created = s->created[i];
+}
+
+static bool gen_state_same(const struct gen_state *a, const struct gen_state *b)
+{
+	return !memcmp(&a->rng, &b->rng, sizeof(a->rng)) &&
+		!memcmp(a->cur_num, b->cur_num, z_info->r_max * sizeof(int)) &&
+		!memcmp(a->max_num, b->max_num, z_info->r_max * sizeof(byte)) &&
+		!memcmp(a->created, b->created, z_info->a_max * sizeof(bool));
+}
+
+static void gen_state_free(struct gen_state *s)
+{
+	mem_free(s->cur_num);
+	mem_free(s->max_num);
+	mem_free(s->created);
+	memset(s, 0, sizeof(*s));
+}
+
+/**
+ * Change the state to how it will be once the player has left level c, as
+ * cave_generate() and wipe_mon_list() leave it
+ */
+static void gen_state_leave(struct gen_state *s, struct chunk *c,
+							struct player *p)
+{
+	int y, x, i;
+
+	for (y = 0; y < c->height; y++) {
+		for (x = 0; x < c->width; x++) {
+			struct object *obj;
+
+			for (obj = square_object(c, y, x); obj; obj = obj->next) {
+				bool found = obj->known && obj->known->artifact;
+				if (obj->artifact && !OPT(p, birth_lose_arts) && !found)
+					s->created[obj->artifact->aidx] = false;
+			}
+		}
+	}
+
+	for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+		struct monster *mon = cave_monster(c, i);
+		struct object *obj;
+
+		if (!mon->race) continue;
+		for (obj = mon->held_obj; obj; obj = obj->next)
+			if (obj->artifact && !(obj->known && obj->known->artifact))
+				s->created[obj->artifact->aidx] = false;
+		s->cur_num[mon->race->ridx]--;
+	}
+}
+
+/**
+ * A level built while the player was deciding what to do, for one of the
+ * staircases next to them
+ */
+struct pregen {
+	struct chunk *chunk;
+
+	/* What it was built for */
+	int depth;
+	struct loc from;
+	bool up_stair, down_stair;
+	struct gen_state before;
+
+	/* What building it left behind */
+	struct gen_state after;
+	struct loc grid;
+	s16b repro;
+	bool light;
+};
+
+static struct pregen pregens[2];
+
+/**
+ * Forget a level built ahead.  Its monsters and artifacts were never
+ * counted, so the chunk is just freed.
+ */
+static void pregen_clear(struct pregen *g)
+{
+	if (g->chunk) {
+		int i;
+
+		for (i = cave_monster_max(g->chunk) - 1; i >= 1; i--) {
+			struct monster *mon = cave_monster(g->chunk, i);
+			if (mon->race && mon->held_obj)
+				object_pile_free(mon->held_obj);
+		}
+		cave_free(g->chunk);
+	}
+
+	gen_state_free(&g->before);
+	gen_state_free(&g->after);
+	memset(g, 0, sizeof(*g));
+}
+
+/**
+ * Forget all the levels built ahead
+ */
+void cave_pregen_free(void)
+{
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(pregens); i++)
+		pregen_clear(&pregens[i]);
+}
+
+/**
+ * Build the level the player would get by taking the stairs at from to
+ * depth, with everything else as it would be by then; the state expected
+ * then is in *leave, and is taken over.  The game is put back as it was
+ * afterwards, so nothing the new level holds is counted yet.  Returns
+ * false, keeping nothing, if stop gave up on the level before it was done.
+ */
+static bool pregen_build(struct pregen *g, struct player *p, int depth,
+						 struct loc from, bool up_stair, bool down_stair,
+						 struct gen_state *leave, bool (*stop)(void))
+{
+	struct gen_state now = { 0 };
+	struct chunk *old_cave = cave, *old_known = p->cave;
+	int old_depth = p->depth, old_py = p->py, old_px = p->px;
+	bool old_up = p->upkeep->create_up_stair;
+	bool old_down = p->upkeep->create_down_stair;
+	bool old_light = p->upkeep->light_level;
+	u32b old_update = p->upkeep->update;
+	s16b old_repro = num_repro;
+	struct target old_target;
+	int rng;
+
+	PROFILE_ENTER(PROF_GENERATE);
+	PROFILE_BEGIN("pregenerate");
+
+	pregen_clear(g);
+	g->depth = depth;
+	g->from = from;
+	g->up_stair = up_stair;
+	g->down_stair = down_stair;
+	g->before = *leave;
+	memset(leave, 0, sizeof(*leave));
+
+	/* Set things up as the stairs and cave_generate() would */
+	gen_state_get(&now);
+	target_save(&old_target);
+	gen_state_set(&g->before);
+	cave = NULL;
+	p->cave = NULL;
+	p->depth = depth;
+	p->py = from.y;
+	p->px = from.x;
+	p->upkeep->create_up_stair = up_stair;
+	p->upkeep->create_down_stair = down_stair;
+	num_repro = 0;
+
+	rng = Rand_stream(RNG_GENERATION);
+	g->chunk = cave_build(p, stop);
+	Rand_stream(rng);
+
+	/* Note what it changed */
+	gen_state_get(&g->after);
+	g->grid = loc(p->px, p->py);
+	g->repro = num_repro;
+	g->light = p->upkeep->light_level;
+
+	/* Put everything back */
+	gen_state_set(&now);
+	gen_state_free(&now);
+	cave = old_cave;
+	p->cave = old_known;
+	p->depth = old_depth;
+	p->py = old_py;
+	p->px = old_px;
+	p->upkeep->create_up_stair = old_up;
+	p->upkeep->create_down_stair = old_down;
+	p->upkeep->light_level = old_light;
+	p->upkeep->update = old_update;
+	num_repro = old_repro;
+	target_restore(&old_target);
+	character_dungeon = true;
+
+	/* Nothing from a level given up on is kept */
+	if (!g->chunk)
+		pregen_clear(g);
+
+	PROFILE_END("pregenerate");
+	PROFILE_LEAVE(PROF_GENERATE);
+
+	return g->chunk != NULL;
+}
+
+/**
+ * Make sure the level for one staircase is built, building it if there
+ * isn't one or what it was built from has changed.  Returns whether it
+ * was built.
+ */
+static bool pregen_stairs(struct pregen *g, struct player *p, int depth,
+						  struct loc from, bool up_stair, bool down_stair,
+						  bool (*stop)(void))
+{
+	struct gen_state leave = { 0 };
+
+	/* Never the town, which comes back as it was left */
+	if (depth <= 0 || depth == p->depth) return false;
+
+	gen_state_get(&leave);
+	gen_state_leave(&leave, cave, p);
+	if (g->chunk && g->depth == depth && g->from.y == from.y &&
+		g->from.x == from.x &&
+		g->up_stair == up_stair && g->down_stair == down_stair &&
+		gen_state_same(&g->before, &leave)) {
+		gen_state_free(&leave);
+		return false;
+	}
+
+	return pregen_build(g, p, depth, from, up_stair, down_stair, &leave,
+						stop);
+}
+
+/**
+ * Look for stairs of one kind under or next to the player
+ */
+static bool pregen_find_stairs(struct chunk *c, struct player *p,
+							   bool (*pred)(struct chunk *c, int y, int x),
+							   struct loc *grid)
+{
+	int d;
+
+	for (d = 0; d < 9; d++) {
+		int y = p->py + ddy_ddd[(d + 8) % 9];
+		int x = p->px + ddx_ddd[(d + 8) % 9];
+
+		if (!square_in_bounds(c, y, x) || !pred(c, y, x)) continue;
+		*grid = loc(x, y);
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Build the levels the stairs next to the player lead to, one at a time,
+ * while the game waits for a command.  They are built just as they would
+ * be on taking the stairs, and cave_generate() only uses one if nothing
+ * it was made from has changed by then, so records and replays aren't
+ * affected.  Building can take a while, so stop, if given, is asked
+ * between tries at a level, and the level given up on once it says so.
+ * Returns whether a level was built.
+ */
+bool cave_pregenerate(struct player *p, bool (*stop)(void))
+{
+	struct loc grid;
+
+	if (!character_dungeon || !cave || p->is_dead) return false;
+	if (p->upkeep->generate_level) return false;
+	if (Rand_quick || Rand_compat) return false;
+
+	/* Building makes messages for these */
+	if (OPT(p, cheat_room) || OPT(p, cheat_hear)) return false;
+
+	if (p->depth < z_info->max_depth - 1 &&
+		pregen_find_stairs(cave, p, square_isdownstairs, &grid)) {
+		int depth = OPT(p, birth_force_descend) ?
+			dungeon_get_next_level(p->max_depth, 1) :
+			dungeon_get_next_level(p->depth, 1);
+
+		if (pregen_stairs(&pregens[0], p, depth, grid, true, false, stop))
+			return true;
+	}
+
+	if (!OPT(p, birth_force_descend) &&
+		pregen_find_stairs(cave, p, square_isupstairs, &grid)) {
+		int depth = dungeon_get_next_level(p->depth, -1);
+
+		return pregen_stairs(&pregens[1], p, depth, grid, false, true,
+							 stop);
+	}
+
+	return false;
+}
+
+/**
+ * Take the level built ahead for where the player is going, if there is
+ * one and it was built from the state the game is now in.  This is called
+ * once the old level has gone, with the generation stream active.
+ */
+static struct chunk *pregen_take(struct player *p)
+{
+	struct gen_state now = { 0 };
+	struct chunk *chunk = NULL;
+	size_t i;
+
+	gen_state_get(&now);
+	for (i = 0; i < N_ELEMENTS(pregens); i++) {
+		struct pregen *g = &pregens[i];
+
+		if (!g->chunk || g->depth != p->depth) continue;
+		if (g->from.y != p->py || g->from.x != p->px) continue;
+		if (g->up_stair != p->upkeep->create_up_stair) continue;
+		if (g->down_stair != p->upkeep->create_down_stair) continue;
+		if (!gen_state_same(&g->before, &now)) continue;
+
+		/* Count what it holds, and put the player in it */
+		gen_state_set(&g->after);
+		p->py = g->grid.y;
+		p->px = g->grid.x;
+		p->upkeep->create_up_stair = false;
+		p->upkeep->create_down_stair = false;
+		p->upkeep->light_level = g->light;
+		num_repro = g->repro;
+
+		chunk = g->chunk;
+		g->chunk = NULL;
+		break;
+	}
+	gen_state_free(&now);
+
+	return chunk;
+}
+
+
+/**
+ * Generate a random level.
+ *
+ * Confusingly, this function also generate the town level (level 0).
+ * \param c is the level we're going to end up with, in practice the global cave
+ * \param p is the current player struct, in practice the global player
+ */
+void cave_generate(struct chunk **c, struct player *p)
+{
+	int i;
+	struct chunk *chunk = NULL;
+	int rng = Rand_stream(RNG_GENERATION);
+
+	assert(c);
+
+	PROFILE_ENTER(PROF_GENERATE);
+
+	/* Forget old level */
+	PROFILE_BEGIN("forget level");
+	if (p->cave && (*c == cave)) {
+		int x, y;
+
+		/* Deal with artifacts */
+		for (y = 0; y < (*c)->height; y++) {
+			for (x = 0; x < (*c)->width; x++) {
+				struct object *obj = square_object(*c, y, x);
+				while (obj) {
+					if (obj->artifact) {
+						bool found = obj->known && obj->known->artifact;
+						if (OPT(p, birth_lose_arts) || found) {
+							history_lose_artifact(p, obj->artifact);
+						} else {
+							obj->artifact->created = false;
+						}
+					}
+
+					obj = obj->next;
+				}
+			}
+		}
+
+		/* Free the known cave */
+		cave_free(p->cave);
+		p->cave = NULL;
+	}
+
+	/* Free the old cave */
+	if (*c) {
+		cave_clear(*c, p);
+		*c = NULL;
+	}
+	PROFILE_END("forget level");
+
+	/* Use a level built ahead if there is a good one, or generate */
+	if (c == &cave) {
+		chunk = pregen_take(p);
+		if (chunk) character_dungeon = false;
+	}
+	if (!chunk)
+		chunk = cave_build(p, NULL);
+	cave_pregen_free();
+
 	/* Use the new cave */
 	*c = chunk;
 
 	/* Place dungeon squares to trigger feeling (not in town) */
+	PROFILE_BEGIN("finish level");
 	if (player->depth) {
 		place_feeling(*c);
 	} else if (!chunk_find_name("Town")) {
@@ -976,7 +1557,7 @@ void cave_generate(struct chunk **c, struct player *p)
 
 	/* Allocate new known level, light it if requested */
 	if (*c == cave) {
-		p->cave = cave_new((*c)->height, (*c)->width);
+		p->cave = known_cave_new((*c)->height, (*c)->width);
 		p->cave->objects = mem_realloc(p->cave->objects, ((*c)->obj_max + 1)
 										 * sizeof(struct object*));
 		p->cave->obj_max = (*c)->obj_max;
@@ -993,6 +1574,10 @@ void cave_generate(struct chunk **c, struct player *p)
 	}
 
 	(*c)->created_at = turn;
+	PROFILE_END("finish level");
+
+	PROFILE_LEAVE(PROF_GENERATE);
+	Rand_stream(rng);
 }
 
 /**
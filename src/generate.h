@@ -152,7 +152,7 @@ struct streamer_profile {
 /*
  * cave_builder is a function pointer which builds a level.
  */
-typedef struct chunk * (*cave_builder) (struct player *p);
+typedef struct chunk * (*cave_builder) (struct dun_data *dun, struct player *p);
 
 
 struct cave_profile {
@@ -176,7 +176,8 @@ struct cave_profile {
  * room_builder is a function pointer which builds rooms in the cave given
  * anchor coordinates.
  */
-typedef bool (*room_builder) (struct chunk *c, int y0, int x0, int rating);
+typedef bool (*room_builder) (struct dun_data *dun, struct chunk *c, int y0,
+							  int x0, int rating);
 
 
 /**
@@ -215,6 +216,11 @@ struct vault {
 
     byte min_lev;		/*!< Minimum allowable level, if specified. */
     byte max_lev;		/*!< Maximum allowable level, if specified. */
+
+    u16b *grids;		/*!< Offsets into text of the non-blank grids */
+    u16b num_grids;
+    u16b *fixups;		/*!< Offsets of grids with monsters or objects */
+    u16b num_fixups;
 };
 
 
@@ -236,29 +242,76 @@ struct room_template {
     byte wid;			/*!< Room width */
     byte dor;           /*!< Random door options */
     byte tval;			/*!< tval for objects in this room */
+
+    u16b *grids;		/*!< Offsets into text of the non-blank grids */
+    u16b num_grids;
 };
 
-extern struct dun_data *dun;
 extern struct vault *vaults;
 extern struct room_template *room_templates;
 
+/**
+ * The stages of building a level whose times are gathered for each profile
+ * while gen_stats_on is set
+ */
+enum gen_stage {
+	GEN_STAGE_ROOMS,
+	GEN_STAGE_TUNNELS,
+	GEN_STAGE_STREAMERS,
+	GEN_STAGE_OBJECTS,
+	GEN_STAGE_MONSTERS,
+	GEN_STAGE_CONNECT,
+
+	GEN_STAGE_MAX
+};
+
+/**
+ * What has been gathered about building levels with one cave profile.  Times
+ * are in milliseconds, and a stage's time leaves out any other stage inside
+ * it.
+ */
+struct gen_stats {
+	u32b levels;			/* Levels finished */
+	u32b attempts;			/* Tries at building them, good or bad */
+	u32b no_builder;		/* Tries the builder gave up on */
+	u32b too_many_monsters;	/* Tries thrown away for overflowing */
+	double total;
+	double stage[GEN_STAGE_MAX];
+};
+
+extern bool gen_stats_on;
+
+#define GEN_STAGE_ENTER(s) \
+	do { if (gen_stats_on) gen_stage_enter(s); } while (0)
+#define GEN_STAGE_LEAVE(s) \
+	do { if (gen_stats_on) gen_stage_leave(s); } while (0)
+
+/* generate.c */
+const char *gen_stage_name(int stage);
+void gen_stage_enter(int stage);
+void gen_stage_leave(int stage);
+void gen_stats_reset(void);
+const char *gen_stats_get(int profile, struct gen_stats *stats);
+
 /* gen-cave.c */
-struct chunk *town_gen(struct player *p);
-struct chunk *classic_gen(struct player *p);
-struct chunk *labyrinth_gen(struct player *p);
+struct chunk *town_gen(struct dun_data *dun, struct player *p);
+struct chunk *classic_gen(struct dun_data *dun, struct player *p);
+struct chunk *labyrinth_gen(struct dun_data *dun, struct player *p);
 void ensure_connectedness(struct chunk *c);
-struct chunk *cavern_gen(struct player *p);
-struct chunk *modified_gen(struct player *p);
-struct chunk *moria_gen(struct player *p);
-struct chunk *hard_centre_gen(struct player *p);
-struct chunk *lair_gen(struct player *p);
-struct chunk *gauntlet_gen(struct player *p);
+void mutate_cavern(struct chunk *c);
+struct chunk *cavern_gen(struct dun_data *dun, struct player *p);
+struct chunk *modified_gen(struct dun_data *dun, struct player *p);
+struct chunk *moria_gen(struct dun_data *dun, struct player *p);
+struct chunk *hard_centre_gen(struct dun_data *dun, struct player *p);
+struct chunk *lair_gen(struct dun_data *dun, struct player *p);
+struct chunk *gauntlet_gen(struct dun_data *dun, struct player *p);
 
 /* gen-chunk.c */
 struct chunk *chunk_write(int y0, int x0, int height, int width, bool monsters,
 						 bool objects, bool traps);
 void chunk_list_add(struct chunk *c);
 bool chunk_list_remove(char *name);
+void chunk_list_free(void);
 struct chunk *chunk_find_name(char *name);
 bool chunk_find(struct chunk *c);
 bool chunk_copy(struct chunk *dest, struct chunk *source, int y0, int x0,
@@ -279,27 +332,43 @@ extern bool generate_starburst_room(struct chunk *c, int y1, int x1, int y2,
 									bool special_ok);
 
 struct vault *random_vault(int depth, const char *typ);
-bool build_vault(struct chunk *c, int y0, int x0, struct vault *v);
-
-bool build_simple(struct chunk *c, int y0, int x0, int rating);
-bool build_circular(struct chunk *c, int y0, int x0, int rating);
-bool build_overlap(struct chunk *c, int y0, int x0, int rating);
-bool build_crossed(struct chunk *c, int y0, int x0, int rating);
-bool build_large(struct chunk *c, int y0, int x0, int rating);
-bool mon_pit_hook(struct monster_race *race);
-void set_pit_type(int depth, int type);
-bool build_nest(struct chunk *c, int y0, int x0, int rating);
-bool build_pit(struct chunk *c, int y0, int x0, int rating);
-bool build_template(struct chunk *c, int y0, int x0, int rating);
-bool build_interesting(struct chunk *c, int y0, int x0, int rating);
-bool build_lesser_vault(struct chunk *c, int y0, int x0, int rating);
-bool build_medium_vault(struct chunk *c, int y0, int x0, int rating);
-bool build_greater_vault(struct chunk *c, int y0, int x0, int rating);
-bool build_moria(struct chunk *c, int y0, int x0, int rating);
-bool build_room_of_chambers(struct chunk *c, int y0, int x0, int rating);
-bool build_huge(struct chunk *c, int y0, int x0, int rating);
-bool room_build(struct chunk *c, int by0, int bx0, struct room_profile profile,
-	bool finds_own_space);
+bool build_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 struct vault *v);
+
+bool build_simple(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				  int rating);
+bool build_circular(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					int rating);
+bool build_overlap(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				   int rating);
+bool build_crossed(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				   int rating);
+bool build_large(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 int rating);
+void mon_pit_prep(const struct pit_profile *pit);
+void set_pit_type(struct dun_data *dun, int depth, int type);
+bool build_nest(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				int rating);
+bool build_pit(struct dun_data *dun, struct chunk *c, int y0, int x0,
+			   int rating);
+bool build_template(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					int rating);
+bool build_interesting(struct dun_data *dun, struct chunk *c, int y0, int x0,
+					   int rating);
+bool build_lesser_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						int rating);
+bool build_medium_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						int rating);
+bool build_greater_vault(struct dun_data *dun, struct chunk *c, int y0, int x0,
+						 int rating);
+bool build_moria(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				 int rating);
+bool build_room_of_chambers(struct dun_data *dun, struct chunk *c, int y0,
+							int x0, int rating);
+bool build_huge(struct dun_data *dun, struct chunk *c, int y0, int x0,
+				int rating);
+bool room_build(struct dun_data *dun, struct chunk *c, int by0, int bx0,
+				struct room_profile profile, bool finds_own_space);
 
 
 /* gen-util.c */
@@ -309,6 +378,7 @@ int yx_to_i(int y, int x, int w);
 void i_to_yx(int i, int w, int *y, int *x);
 void shuffle(int *arr, int n);
 bool cave_find(struct chunk *c, int *y, int *x, square_predicate pred);
+void untrack_empty_grids(struct chunk *c);
 bool find_empty(struct chunk *c, int *y, int *x);
 bool find_empty_range(struct chunk *c, int *y, int y1, int y2, int *x, int x1, int x2);
 bool find_nearby_grid(struct chunk *c, int *y, int y0, int yd, int *x, int x0, int xd);
@@ -330,12 +400,15 @@ void alloc_objects(struct chunk *c, int set, int typ, int num, int depth, byte o
 bool alloc_object(struct chunk *c, int set, int typ, int depth, byte origin);
 
 /* gen-monster.c */
-bool mon_restrict(const char *monster_type, int depth, bool unique_ok);
-void spread_monsters(struct chunk *c, const char *type, int depth, int num, 
-					 int y0, int x0, int dy, int dx, byte origin);
+bool mon_restrict(struct dun_data *dun, const char *monster_type, int depth,
+				  bool unique_ok);
+void spread_monsters(struct dun_data *dun, struct chunk *c, const char *type,
+					 int depth, int num, int y0, int x0, int dy, int dx,
+					 byte origin);
 void get_vault_monsters(struct chunk *c, char racial_symbol[], char *vault_type,
 						const char *data, int y1, int y2, int x1, int x2);
-void get_chamber_monsters(struct chunk *c, int y1, int x1, int y2, int x2, char *name, int area);
+void get_chamber_monsters(struct dun_data *dun, struct chunk *c, int y1, int x1,
+						  int y2, int x2, char *name, int area);
 
 
 #endif /* !GENERATE_H */
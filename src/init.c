@@ -57,8 +57,10 @@
 #include "player-quest.h"
 #include "player-spell.h"
 #include "player-timed.h"
+#include "profile.h"
 #include "project.h"
 #include "randname.h"
+#include "savefile.h"
 #include "store.h"
 #include "trap.h"
 
@@ -1190,6 +1192,8 @@ static errr finish_parse_trap(struct parser *p) {
 
 		memcpy(&trap_info[tidx], t, sizeof(*t));
 		trap_info[tidx].tidx = tidx;
+		trap_info[tidx].effect = effect_chain_pack(t->effect);
+		trap_info[tidx].effect_xtra = effect_chain_pack(t->effect_xtra);
 		if (tidx < z_info->trap_max - 1)
 			trap_info[tidx].next = &trap_info[tidx + 1];
 		else
@@ -1210,6 +1214,7 @@ static errr finish_parse_trap(struct parser *p) {
 static void cleanup_trap(void)
 {
 	int i;
+	lookup_trap_forget();
 	for (i = 0; i < z_info->trap_max; i++) {
 		string_free(trap_info[i].name);
 		mem_free(trap_info[i].text);
@@ -1439,12 +1444,15 @@ static errr finish_parse_feat(struct parser *p) {
 
 static void cleanup_feat(void) {
 	int idx;
+	lookup_feat_forget();
 	for (idx = 0; idx < z_info->f_max; idx++) {
 		string_free(f_info[idx].mimic);
 		string_free(f_info[idx].desc);
 		string_free(f_info[idx].name);
 	}
 	mem_free(f_info);
+	mem_free(f_caps);
+	f_caps = NULL;
 }
 
 static struct file_parser feat_parser = {
@@ -2549,8 +2557,19 @@ static errr finish_parse_class(struct parser *p) {
 	classes = parser_priv(p);
 	for (c = classes; c; c = c->next) num++;
 	for (c = classes; c; c = c->next, num--) {
+		int i, j;
+
 		assert(num);
 		c->cidx = num - 1;
+
+		/* Pack the spell effects */
+		for (i = 0; i < c->magic.num_books; i++) {
+			struct class_book *book = &c->magic.books[i];
+
+			for (j = 0; j < book->num_spells; j++)
+				book->spells[j].effect =
+					effect_chain_pack(book->spells[j].effect);
+		}
 	}
 	parser_destroy(p);
 	return 0;
@@ -2760,6 +2779,10 @@ static struct file_parser hints_parser = {
 /**
  * A list of all the above parsers, plus those found in mon-init.c and
  * obj-init.c
+ *
+ * Order matters: a parser may look up entries made by any parser before it
+ * (monsters name their bases, spells and drop kinds, for example), so they
+ * are run one at a time, in this order.
  */
 static struct {
 	const char *name;
@@ -2844,6 +2867,7 @@ extern struct init_module rune_module;
 extern struct init_module obj_make_module;
 extern struct init_module ignore_module;
 extern struct init_module mon_make_module;
+extern struct init_module project_module;
 extern struct init_module player_module;
 extern struct init_module store_module;
 extern struct init_module messages_module;
@@ -2859,6 +2883,7 @@ static struct init_module *modules[] = {
 	&obj_make_module,
 	&ignore_module,
 	&mon_make_module,
+	&project_module,
 	&store_module,
 	&options_module,
 	NULL
@@ -2881,6 +2906,7 @@ static struct init_module *modules[] = {
 bool init_angband(void)
 {
 	int i;
+	int tag = mem_tag_set(MEM_TAG_GAMEDATA);
 
 	event_signal(EVENT_ENTER_INIT);
 
@@ -2902,25 +2928,93 @@ bool init_angband(void)
 	event_signal_message(EVENT_INITSTATUS, 0, "Getting the dice rolling...");
 	Rand_init();
 
+	mem_tag_set(tag);
 	return true;
 }
 
+/**
+ * The most each tag is expected to need at once, in kilobytes, or 0 for no
+ * limit; only the low-memory build sets any, from what a game on a shallow
+ * level has been seen to use with some room to spare.
+ */
+static const size_t mem_budget_kb[MEM_TAG_MAX] = {
+#ifdef LOW_MEMORY
+	512,	/* other */
+	3072,	/* gamedata */
+	1280,	/* cave */
+	192,	/* objects */
+	32,		/* messages */
+	64,		/* ui */
+#else
+	0
+#endif /* LOW_MEMORY */
+};
+
+/**
+ * Write what the allocations have been counted against to memory.txt in the
+ * user directory, if they have been counted, with each tag's budget and
+ * whether the most it used went over that.
+ */
+static void mem_stats_dump(void)
+{
+	char buf[1024];
+	ang_file *fp;
+	size_t total = 0, most = 0, budget = 0;
+	int i;
+
+	if (!(mem_flags & MEM_ACCOUNT) || !ANGBAND_DIR_USER) return;
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "memory.txt");
+	fp = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+	if (!fp) return;
+
+	file_putf(fp, "%-10s %12s %12s %10s %10s %10s\n", "tag", "live bytes",
+			  "most bytes", "blocks", "allocs", "budget kb");
+	for (i = 0; i < MEM_TAG_MAX; i++) {
+		struct mem_tag_stats stats;
+		bool over;
+
+		mem_tag_get(i, &stats);
+		over = mem_budget_kb[i] && stats.high_water > mem_budget_kb[i] * 1024;
+		file_putf(fp, "%-10s %12lu %12lu %10u %10u %10lu%s\n", stats.name,
+				  (unsigned long)stats.live, (unsigned long)stats.high_water,
+				  stats.blocks, stats.allocs, (unsigned long)mem_budget_kb[i],
+				  over ? " over" : "");
+		total += stats.live;
+		most += stats.high_water;
+		budget += mem_budget_kb[i];
+	}
+	file_putf(fp, "%-10s %12lu %12lu %10s %10s %10lu\n", "total",
+			  (unsigned long)total, (unsigned long)most, "", "",
+			  (unsigned long)budget);
+
+	file_close(fp);
+}
+
 /**
  * Free all the stuff initialised in init_angband()
  */
 void cleanup_angband(void)
 {
 	int i;
+
+	/* Say where the time and memory went, if they were measured */
+	profile_metrics_stop();
+	profile_dump();
+	mem_stats_dump();
+
 	for (i = 0; modules[i]; i++)
 		if (modules[i]->cleanup)
 			modules[i]->cleanup();
 
 	event_remove_all_handlers();
 
-	/* Free the chunk list */
-	for (i = 0; i < chunk_list_max; i++)
-		cave_free(chunk_list[i]);
-	mem_free(chunk_list);
+	/* Free the chunk list, and any levels built ahead */
+	chunk_list_free();
+	cave_pregen_free();
+
+	/* Free the command queue */
+	cmdq_free();
 
 	/* Free the main cave */
 	if (cave) {
@@ -2930,12 +3024,17 @@ void cleanup_angband(void)
 
 	monster_list_finalize();
 	object_list_finalize();
+	object_pool_cleanup();
+	savefile_cleanup();
 
 	cleanup_game_constants();
 
 	/* Free the format() buffer */
 	vformat_kill();
 
+	/* Finish any trace off */
+	profile_trace_stop();
+
 	/* Free the directories */
 	string_free(ANGBAND_DIR_GAMEDATA);
 	string_free(ANGBAND_DIR_CUSTOMIZE);
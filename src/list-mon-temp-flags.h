@@ -13,3 +13,4 @@ MFLAG(VISIBLE,	"Monster is \"visible\"")
 MFLAG(CAMOUFLAGE,"Player doesn't know this is a monster")
 MFLAG(AWARE,	"Monster is aware of the player")
 MFLAG(HANDLED,	"Monster has been processed this turn")
+MFLAG(REVIEW,	"Monster visibility needs working out again")
@@ -2,7 +2,7 @@
  * \file list-options.h
  * \brief options
  *
- * Currently, if there are more than 20 of any option type, the later ones
+ * Currently, if there are more than 21 of any option type, the later ones
  * will be ignored
  * Cheat options need to be followed by corresponding score options
  */
@@ -51,6 +51,8 @@ OP(mouse_movement,        "Allow mouse clicks to move the player",
 INTERFACE, true)
 OP(notify_recharge,       "Notify on object recharge",
 INTERFACE, false)
+OP(view_shadowcast,       "Use shadowcasting to calculate the field of view",
+INTERFACE, false)
 OP(cheat_hear,            "Cheat: Peek into monster creation",
 CHEAT, false)
 OP(score_hear,            "Score: Peek into monster creation",
@@ -0,0 +1,19 @@
+/**
+ * \file list-profile.h
+ * \brief The parts of a turn the profiler times
+ *
+ * Fields:
+ * symbol - the timer is PROF_<symbol>
+ * name - what it is called on the profile screen and in profile.txt
+ */
+
+/* symbol		name */
+PROF(WORLD,		"process_world")
+PROF(PLAYER,	"process_player")
+PROF(MONSTERS,	"process_monsters")
+PROF(VIEW,		"update_view")
+PROF(NOISE,		"make_noise")
+PROF(UPDATE_MON,"update_mon")
+PROF(PROJECT,	"project")
+PROF(GENERATE,	"cave_generate")
+PROF(REDRAW,	"redraw_stuff")
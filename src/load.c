@@ -79,6 +79,12 @@ static byte mflag_size = 0;
  */
 static byte trf_size = 0;
 
+/**
+ * Whether monster and trap locations are 16-bit; blocks from before version 2
+ * of "monsters", "traps" and "chunks" stored them as a byte each
+ */
+static bool wide_locations = true;
+
 /**
  * Shorthand function pointer for rd_item version
  */
@@ -106,8 +112,15 @@ static struct object *rd_item(void)
 	rd_u16b(&obj->oidx);
 
 	/* Location */
-	rd_byte(&obj->iy);
-	rd_byte(&obj->ix);
+	if (ver >= 6) {
+		rd_s16b(&obj->iy);
+		rd_s16b(&obj->ix);
+	} else {
+		rd_byte(&tmp8u);
+		obj->iy = tmp8u;
+		rd_byte(&tmp8u);
+		obj->ix = tmp8u;
+	}
 
 	/* Type/Subtype */
 	rd_string(buf, sizeof(buf));
@@ -245,6 +258,24 @@ static struct object *rd_item(void)
 }
 
 
+/**
+ * Read a monster or trap location
+ */
+static void rd_location(s16b *y, s16b *x)
+{
+	byte tmp8u;
+
+	if (wide_locations) {
+		rd_s16b(y);
+		rd_s16b(x);
+	} else {
+		rd_byte(&tmp8u);
+		*y = tmp8u;
+		rd_byte(&tmp8u);
+		*x = tmp8u;
+	}
+}
+
 /**
  * Read a monster
  */
@@ -264,8 +295,7 @@ static bool rd_monster(struct chunk *c, struct monster *mon)
 	}
 
 	/* Read the other information */
-	rd_byte(&mon->fy);
-	rd_byte(&mon->fx);
+	rd_location(&mon->fy, &mon->fx);
 	rd_s16b(&mon->hp);
 	rd_s16b(&mon->maxhp);
 	rd_byte(&mon->mspeed);
@@ -283,7 +313,7 @@ static bool rd_monster(struct chunk *c, struct monster *mon)
 		rd_byte(&mon->known_pstate.flags[j]);
 
 	for (j = 0; j < elem_max; j++)
-		rd_s16b(&mon->known_pstate.el_info[j].res_level);
+		rd_s16b(&mon->known_pstate.res_level[j]);
 
 	rd_u16b(&tmp16u);
 
@@ -329,8 +359,7 @@ static void rd_trap(struct trap *trap)
 		trap->kind = lookup_trap(buf);
 		trap->t_idx = trap->kind->tidx;
 	}
-    rd_byte(&trap->fy);
-    rd_byte(&trap->fx);
+    rd_location(&trap->fy, &trap->fx);
     rd_byte(&trap->power);
     rd_byte(&trap->timeout);
 
@@ -373,6 +402,7 @@ int rd_randomizer(void)
 		rd_u32b(&noop);
 
 	Rand_quick = false;
+	Rand_streams_reset();
 
 	return 0;
 }
@@ -1203,8 +1233,11 @@ static int rd_dungeon_aux(struct chunk **c)
 	rd_u16b(&height);
 	rd_u16b(&width);
 
-	/* We need a cave struct */
-	c1 = cave_new(height, width);
+	/* We need a cave struct; the player's knowledge needs less of one */
+	if (c == &player->cave)
+		c1 = known_cave_new(height, width);
+	else
+		c1 = cave_new(height, width);
 	c1->name = string_make(name);
 
     /* Run length decoding of cave->squares[y][x].info */
@@ -1292,8 +1325,11 @@ static int rd_objects_aux(rd_item_t rd_item_version, struct chunk *c)
 		if (!obj)
 			break;
 
-		if (square_in_bounds_fully(c, obj->iy, obj->ix))
+		if (square_in_bounds_fully(c, obj->iy, obj->ix)) {
 			pile_insert_end(&c->squares[obj->iy][obj->ix].obj, obj);
+			c->fingerprint += square_fingerprint_obj(obj->iy, obj->ix, obj);
+			square_pile_changed(c, obj->iy, obj->ix);
+		}
 		assert(obj->oidx);
 		assert(c->objects[obj->oidx] == NULL);
 		c->objects[obj->oidx] = obj;
@@ -1369,6 +1405,7 @@ static int rd_traps_aux(struct chunk *c)
 			/* Put the trap at the front of the grid trap list */
 			trap->next = c->squares[y][x].trap;
 			c->squares[y][x].trap = trap;
+			c->trap_timeouts = MAX(c->trap_timeouts, trap->timeout);
 		}
 	}
 
@@ -1462,6 +1499,16 @@ int rd_monsters(void)
 	return 0;
 }
 
+int rd_monsters_1(void)
+{
+	int result;
+
+	wide_locations = false;
+	result = rd_monsters();
+	wide_locations = true;
+	return result;
+}
+
 /**
  * Read the traps - wrapper functions
  */
@@ -1474,6 +1521,16 @@ int rd_traps(void)
 	return 0;
 }
 
+int rd_traps_1(void)
+{
+	int result;
+
+	wide_locations = false;
+	result = rd_traps();
+	wide_locations = true;
+	return result;
+}
+
 /**
  * Read the chunk list
  */
@@ -1511,6 +1568,16 @@ int rd_chunks(void)
 	return 0;
 }
 
+int rd_chunks_1(void)
+{
+	int result;
+
+	wide_locations = false;
+	result = rd_chunks();
+	wide_locations = true;
+	return result;
+}
+
 
 int rd_history(void)
 {
@@ -154,6 +154,9 @@ static bool bold_extended = false;
 static bool ascii_walls = false;
 static int term_count = 4;
 
+/* Send screen updates only when waiting for input or delaying? */
+static bool defer_update = false;
+
 /**
  * Background color we should draw with; either BLACK or DEFAULT
  */
@@ -289,16 +292,18 @@ static errr Term_xtra_gcu_alive(int v) {
 	return 0;
 }
 
-const char help_gcu[] = "Text mode, subopts\n              -a     Use ASCII walls\n              -b     Big screen (equivalent to -n1)\n              -B     Use brighter bold characters\n              -nN    Use N terminals (up to 6)";
+const char help_gcu[] = "Text mode, subopts\n              -a     Use ASCII walls\n              -b     Big screen (equivalent to -n1)\n              -B     Use brighter bold characters\n              -d     Defer screen updates until input or delay\n              -nN    Use N terminals (up to 6)";
 
 /**
  * Usage:
  *
- * angband -mgcu -- [-a] [-b] [-B] [-nN]
+ * angband -mgcu -- [-a] [-b] [-B] [-d] [-nN]
  *
  *   -a      Use ASCII walls
  *   -b      Big screen (equivalent to -n1)
  *   -B      Use brighter bold characters
+ *   -d      Defer screen updates until input or delay, so that all the
+ *           windows refreshed in between go to the terminal together
  *   -nN     Use N terminals (up to 6)
  */
 
@@ -737,8 +742,11 @@ static errr Term_xtra_gcu(int n, int v) {
 		/* Make a noise */
 		case TERM_XTRA_NOISE: write(1, "\007", 1); return 0;
 
-		/* Flush the Curses buffer */
-		case TERM_XTRA_FRESH: wrefresh(td->win); return 0;
+		/* Flush the Curses buffer, or just queue it if deferring */
+		case TERM_XTRA_FRESH:
+			if (defer_update) wnoutrefresh(td->win);
+			else wrefresh(td->win);
+			return 0;
 
 #ifdef USE_CURS_SET
 		/* Change the cursor visibility */
@@ -749,13 +757,18 @@ static errr Term_xtra_gcu(int n, int v) {
 		case TERM_XTRA_ALIVE: return Term_xtra_gcu_alive(v);
 
 		/* Process events */
-		case TERM_XTRA_EVENT: return Term_xtra_gcu_event(v);
+		case TERM_XTRA_EVENT:
+			if (defer_update) doupdate();
+			return Term_xtra_gcu_event(v);
 
 		/* Flush events */
 		case TERM_XTRA_FLUSH: while (!Term_xtra_gcu_event(false)); return 0;
 
 		/* Delay */
-		case TERM_XTRA_DELAY: if (v > 0) usleep(1000 * v); return 0;
+		case TERM_XTRA_DELAY:
+			if (defer_update) doupdate();
+			if (v > 0) usleep(1000 * v);
+			return 0;
 
 		/* React to events */
 		case TERM_XTRA_REACT: Term_xtra_gcu_react(); return 0;
@@ -917,6 +930,8 @@ errr init_gcu(int argc, char **argv) {
 			bold_extended = true;
 		} else if (prefix(argv[i], "-a")) {
 			ascii_walls = true;
+		} else if (prefix(argv[i], "-d")) {
+			defer_update = true;
 		} else if (prefix(argv[i], "-n")) {
 			term_count = atoi(&argv[i][2]);
 			if (term_count > MAX_TERM_DATA) term_count = MAX_TERM_DATA;
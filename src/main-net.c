@@ -0,0 +1,523 @@
+/**
+ * \file main-net.c
+ * \brief Play over a socket, sending the screen as a compact binary diff
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "game-world.h"
+#include "grafmode.h"
+#include "main.h"
+#include "ui-game.h"
+#include "ui-input.h"
+#include "ui-prefs.h"
+
+#ifdef USE_NET
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * The term package only hands on the spans of the screen which changed at
+ * each Term_fresh(), so they are sent just as they come, as messages of a
+ * byte saying what they are and then their fields as bytes, with wider
+ * numbers most significant byte first.  The server sends:
+ *
+ *   'Z' cols rows graf          The size of the screen and the graphics mode
+ *                               the tiles are from (0 for none), sent first
+ *   'T' x y attr(2) n len(2)    n grids of text in attr, as len bytes of
+ *       text                    UTF-8 following
+ *   'P' x y n                   n grids of tiles, each as attr(2) char(4)
+ *       {a(2) c(4) ta(2) tc(4)}   and the terrain attr(2) char(4) under it
+ *   'W' x y n                   n grids blanked
+ *   'X'                         The whole screen blanked
+ *   'C' x y                     The cursor moved
+ *   'S' shown                   The cursor shown (1) or hidden (0)
+ *   'B'                         A bell
+ *   'F'                         The end of a frame; show what came since
+ *                               the last one
+ *
+ * and nothing is sent between frames.  The client sends:
+ *
+ *   'K' code(4) mods            A keypress, as the keycode_t and KC_MOD_*
+ *                               flags of ui-event.h
+ */
+
+#define NET_MSG_SIZE	'Z'
+#define NET_MSG_TEXT	'T'
+#define NET_MSG_PICT	'P'
+#define NET_MSG_WIPE	'W'
+#define NET_MSG_CLEAR	'X'
+#define NET_MSG_CURS	'C'
+#define NET_MSG_SHAPE	'S'
+#define NET_MSG_BELL	'B'
+#define NET_MSG_FRESH	'F'
+#define NET_MSG_KEY		'K'
+
+#define NET_KEY_LEN		6	/* Bytes in a keypress message */
+
+/* A client going away should end the game quietly, not by SIGPIPE */
+#ifdef MSG_NOSIGNAL
+# define NET_SEND_FLAGS	MSG_NOSIGNAL
+#else
+# define NET_SEND_FLAGS	0
+#endif
+
+typedef struct term_data term_data;
+struct term_data {
+	term t;
+};
+
+static term_data td;
+
+static int net_port = 0;
+static const char *net_addr = "127.0.0.1";
+static int net_cols = 80;
+static int net_rows = 24;
+static int net_graf = 0;
+
+static int net_fd = -1;
+
+/**
+ * What is waiting to be sent, which goes at the end of each frame or when
+ * the game waits for a key
+ */
+static byte *out_buf;
+static size_t out_len;
+static size_t out_size;
+
+/**
+ * What has come in but isn't a whole message yet
+ */
+static byte in_buf[64];
+static size_t in_len;
+
+/**
+ * Where the cursor is to go, and where the client was last told it is
+ */
+static int curs_x, curs_y;
+static int sent_x = -1, sent_y = -1;
+
+static void net_put(byte b)
+{
+	if (out_len == out_size) {
+		out_size = out_size ? out_size * 2 : 4096;
+		out_buf = mem_realloc(out_buf, out_size);
+	}
+	out_buf[out_len++] = b;
+}
+
+static void net_put_u16(int v)
+{
+	net_put((v >> 8) & 0xFF);
+	net_put(v & 0xFF);
+}
+
+static void net_put_u32(u32b v)
+{
+	net_put_u16((v >> 16) & 0xFFFF);
+	net_put_u16(v & 0xFFFF);
+}
+
+/**
+ * Put a character as UTF-8, returning how many bytes it took
+ */
+static int net_put_utf8(wchar_t wc)
+{
+	u32b c = (u32b) wc;
+
+	if (c < 0x80) {
+		net_put(c);
+		return 1;
+	} else if (c < 0x800) {
+		net_put(0xC0 | (c >> 6));
+		net_put(0x80 | (c & 0x3F));
+		return 2;
+	} else if (c < 0x10000) {
+		net_put(0xE0 | (c >> 12));
+		net_put(0x80 | ((c >> 6) & 0x3F));
+		net_put(0x80 | (c & 0x3F));
+		return 3;
+	}
+
+	net_put(0xF0 | ((c >> 18) & 0x07));
+	net_put(0x80 | ((c >> 12) & 0x3F));
+	net_put(0x80 | ((c >> 6) & 0x3F));
+	net_put(0x80 | (c & 0x3F));
+	return 4;
+}
+
+/**
+ * The client has gone, so save the game if a character is being played and
+ * leave, as the SDL front end does when its window is closed
+ */
+static void net_hangup(void)
+{
+	if (net_fd >= 0) close(net_fd);
+	net_fd = -1;
+	out_len = 0;
+
+	if (character_generated && inkey_flag) {
+		msg_flag = false;
+		save_game();
+	}
+
+	quit(NULL);
+}
+
+/**
+ * Send everything that is waiting
+ */
+static void net_send(void)
+{
+	size_t done = 0;
+
+	while (done < out_len && net_fd >= 0) {
+		ssize_t n = send(net_fd, out_buf + done, out_len - done,
+						 NET_SEND_FLAGS);
+
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) net_hangup();
+		done += n;
+	}
+	out_len = 0;
+}
+
+/**
+ * Take in what the client has sent, waiting for it if asked to, and pass
+ * on any keypresses; returns false if there was nothing
+ */
+static bool net_receive(bool wait)
+{
+	struct timeval none = { 0, 0 };
+	fd_set fds;
+	ssize_t n;
+	size_t i;
+
+	FD_ZERO(&fds);
+	FD_SET(net_fd, &fds);
+	n = select(net_fd + 1, &fds, NULL, NULL, wait ? NULL : &none);
+	if (n < 0 && errno == EINTR) return false;
+	if (n <= 0) return false;
+
+	n = read(net_fd, in_buf + in_len, sizeof(in_buf) - in_len);
+	if (n < 0 && errno == EINTR) return false;
+	if (n <= 0) net_hangup();
+	in_len += n;
+
+	/* Pass on the whole messages, and keep any part of one for later */
+	for (i = 0; i < in_len; ) {
+		if (in_buf[i] != NET_MSG_KEY) {
+			/* Nothing else is understood, so pass over it */
+			i++;
+			continue;
+		}
+		if (in_len - i < NET_KEY_LEN) break;
+
+		Term_keypress(((u32b)in_buf[i + 1] << 24) |
+					  ((u32b)in_buf[i + 2] << 16) |
+					  ((u32b)in_buf[i + 3] << 8) | in_buf[i + 4],
+					  in_buf[i + 5]);
+		i += NET_KEY_LEN;
+	}
+	memmove(in_buf, in_buf + i, in_len - i);
+	in_len -= i;
+
+	return true;
+}
+
+/**
+ * Finish a frame and send it
+ */
+static void net_fresh(void)
+{
+	if (curs_x != sent_x || curs_y != sent_y) {
+		net_put(NET_MSG_CURS);
+		net_put(curs_x);
+		net_put(curs_y);
+		sent_x = curs_x;
+		sent_y = curs_y;
+	}
+	net_put(NET_MSG_FRESH);
+	net_send();
+}
+
+static void Term_nuke_net(term *t)
+{
+	if (net_fd < 0) return;
+
+	/* Get the last of the screen across before going */
+	net_fresh();
+	close(net_fd);
+	net_fd = -1;
+	mem_free(out_buf);
+	out_buf = NULL;
+	out_len = out_size = 0;
+}
+
+/**
+ * Handle a "special request"
+ */
+static errr Term_xtra_net(int n, int v)
+{
+	switch (n) {
+		/* Clear screen */
+		case TERM_XTRA_CLEAR: net_put(NET_MSG_CLEAR); return 0;
+
+		/* Make a noise */
+		case TERM_XTRA_NOISE: net_put(NET_MSG_BELL); return 0;
+
+		/* Send the frame */
+		case TERM_XTRA_FRESH: net_fresh(); return 0;
+
+		/* Change the cursor visibility */
+		case TERM_XTRA_SHAPE:
+			net_put(NET_MSG_SHAPE);
+			net_put(v ? 1 : 0);
+			return 0;
+
+		/* Process events, sending anything waiting first */
+		case TERM_XTRA_EVENT:
+			if (out_len) net_send();
+			return net_receive(v != 0) ? 0 : 1;
+
+		/* Flush events */
+		case TERM_XTRA_FLUSH:
+			while (net_receive(false));
+			return 0;
+
+		/* Delay */
+		case TERM_XTRA_DELAY:
+			if (out_len) net_send();
+			if (v > 0) usleep(1000 * v);
+			return 0;
+
+		/* Nothing to react to */
+		case TERM_XTRA_REACT: return 0;
+	}
+
+	/* Unknown event */
+	return 1;
+}
+
+/**
+ * Move the cursor; it is only sent at the end of the frame, since the term
+ * package may move it several times in one
+ */
+static errr Term_curs_net(int x, int y)
+{
+	curs_x = x;
+	curs_y = y;
+	return 0;
+}
+
+static errr Term_wipe_net(int x, int y, int n)
+{
+	net_put(NET_MSG_WIPE);
+	net_put(x);
+	net_put(y);
+	net_put(n);
+	return 0;
+}
+
+static errr Term_text_net(int x, int y, int n, int a, const wchar_t *s)
+{
+	size_t len_at;
+	int i, len = 0;
+
+	net_put(NET_MSG_TEXT);
+	net_put(x);
+	net_put(y);
+	net_put_u16(a);
+	net_put(n);
+
+	/* The length goes before the text, so is filled in afterwards */
+	len_at = out_len;
+	net_put_u16(0);
+	for (i = 0; i < n; i++)
+		len += net_put_utf8(s[i]);
+	out_buf[len_at] = (len >> 8) & 0xFF;
+	out_buf[len_at + 1] = len & 0xFF;
+
+	return 0;
+}
+
+static errr Term_pict_net(int x, int y, int n, const int *ap,
+						  const wchar_t *cp, const int *tap,
+						  const wchar_t *tcp)
+{
+	int i;
+
+	net_put(NET_MSG_PICT);
+	net_put(x);
+	net_put(y);
+	net_put(n);
+	for (i = 0; i < n; i++) {
+		net_put_u16(ap[i]);
+		net_put_u32(cp[i]);
+		net_put_u16(tap[i]);
+		net_put_u32(tcp[i]);
+	}
+
+	return 0;
+}
+
+static void term_data_link(int i)
+{
+	term *t = &td.t;
+
+	term_init(t, net_cols, net_rows, 256);
+
+	/* The client has the tiles, if there are any */
+	if (net_graf) t->higher_pict = true;
+
+	/* Erase with "white space" */
+	t->attr_blank = COLOUR_WHITE;
+	t->char_blank = ' ';
+
+	/* Keys come with their modifiers */
+	t->complex_input = true;
+
+	t->nuke_hook = Term_nuke_net;
+	t->xtra_hook = Term_xtra_net;
+	t->curs_hook = Term_curs_net;
+	t->wipe_hook = Term_wipe_net;
+	t->text_hook = Term_text_net;
+	if (net_graf) t->pict_hook = Term_pict_net;
+
+	t->data = &td;
+
+	Term_activate(t);
+
+	angband_term[i] = t;
+}
+
+/**
+ * Wait for the one client this game is played by
+ */
+static bool net_accept(void)
+{
+	struct sockaddr_in addr;
+	int one = 1;
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (fd < 0) return false;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(net_port);
+	if (inet_pton(AF_INET, net_addr, &addr.sin_addr) != 1 ||
+		bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+		listen(fd, 1) < 0) {
+		close(fd);
+		return false;
+	}
+
+	printf("Waiting for a player on %s port %d...\n", net_addr, net_port);
+	fflush(stdout);
+
+	do {
+		net_fd = accept(fd, NULL, NULL);
+	} while (net_fd < 0 && errno == EINTR);
+	close(fd);
+	if (net_fd < 0) return false;
+
+	/* Keypresses and frames are small, and shouldn't wait to be sent */
+	setsockopt(net_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	return true;
+}
+
+const char help_net[] = "Network mode, subopts -p<port> -b<address> -w<cols> -h<rows> -g<graphics mode>";
+
+/**
+ * Usage:
+ *
+ * angband -mnet -- -p<port> [-b<address>] [-w<cols>] [-h<rows>] [-g<mode>]
+ *
+ *   -p<port>     Wait for a player on this TCP port
+ *   -b<address>  Listen on this IPv4 address (default: 127.0.0.1)
+ *   -w<cols>     Make the screen this wide (default and least 80)
+ *   -h<rows>     Make the screen this high (default and least 24)
+ *   -g<mode>     Send tiles from this graphics mode, for a client which
+ *                has them, rather than text for the map
+ */
+errr init_net(int argc, char *argv[])
+{
+	int i;
+
+	/* Skip over argv[0] */
+	for (i = 1; i < argc; i++) {
+		if (prefix(argv[i], "-p")) {
+			net_port = atoi(argv[i] + 2);
+			continue;
+		}
+		if (prefix(argv[i], "-b")) {
+			net_addr = argv[i] + 2;
+			continue;
+		}
+		if (prefix(argv[i], "-w")) {
+			net_cols = MIN(MAX(atoi(argv[i] + 2), 80), 255);
+			continue;
+		}
+		if (prefix(argv[i], "-h")) {
+			net_rows = MIN(MAX(atoi(argv[i] + 2), 24), 255);
+			continue;
+		}
+		if (prefix(argv[i], "-g")) {
+			net_graf = atoi(argv[i] + 2);
+			continue;
+		}
+		printf("init-net: bad argument '%s'\n", argv[i]);
+	}
+
+	/* No port, so leave it to the other modules */
+	if (net_port <= 0) return 1;
+
+	if (net_graf) {
+		if (init_graphics_modes())
+			current_graphics_mode = get_graphics_mode(net_graf);
+		if (!current_graphics_mode || !current_graphics_mode->grafID) {
+			printf("init-net: no graphics mode %d\n", net_graf);
+			net_graf = 0;
+			current_graphics_mode = NULL;
+		} else {
+			use_graphics = arg_graphics = net_graf;
+		}
+	}
+
+	if (!net_accept()) {
+		printf("init-net: can't take a player on port %d\n", net_port);
+		return 1;
+	}
+
+	term_data_link(0);
+
+	net_put(NET_MSG_SIZE);
+	net_put(net_cols);
+	net_put(net_rows);
+	net_put(net_graf);
+	net_send();
+
+	return 0;
+}
+
+#endif /* USE_NET */
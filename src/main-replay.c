@@ -0,0 +1,273 @@
+/**
+ * \file main-replay.c
+ * \brief Play back a recorded game with no display, to time or check it
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "cmd-record.h"
+#include "game-event.h"
+#include "game-world.h"
+#include "init.h"
+#include "main.h"
+#include "player-calcs.h"
+#include "player-util.h"
+#include "wizard.h"
+#include <time.h>
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+static const char *replay_path;
+static bool quiet = false;
+
+const char help_replay[] = "Replay mode, subopts <file> (- for a list on stdin) -q(uiet)";
+
+/**
+ * Usage:
+ *
+ * angband -mreplay -- [-q] <file>
+ *
+ *   -q      Quiet mode (only say whether the game came out the same)
+ *   <file>  A record made with angband -r<file>, or - to read the names of
+ *           records from stdin, one per line, and play each back in turn
+ *           without loading the game data again
+ */
+errr init_replay(int argc, char *argv[])
+{
+	int i;
+
+	/* Skip over argv[0] */
+	for (i = 1; i < argc; i++) {
+		if (streq(argv[i], "-q")) {
+			quiet = true;
+			continue;
+		}
+		if ((argv[i][0] != '-' || streq(argv[i], "-")) && !replay_path) {
+			replay_path = argv[i];
+			continue;
+		}
+		printf("init-replay: bad argument '%s'\n", argv[i]);
+	}
+
+	/* Nothing to play, so leave it to the other modules */
+	return replay_path ? 0 : 1;
+}
+
+/**
+ * The game asks for a command when it needs one
+ */
+static errr replay_get_cmd(cmd_context context)
+{
+	if (!cmd_replay_push(context))
+		player->upkeep->playing = false;
+
+	return 0;
+}
+
+/**
+ * Stores are used through commands in the store context, and then left
+ * just as the front end does it.  The game drops all store handlers after
+ * each visit, so they have to be put back each time.
+ */
+static void replay_enter_store(game_event_type type, game_event_data *data,
+							   void *user);
+
+static void replay_use_store(game_event_type type, game_event_data *data,
+							 void *user)
+{
+	while (cmd_replay_push(CMD_STORE))
+		cmdq_pop(CMD_STORE);
+
+	/* Take a turn */
+	player->upkeep->energy_use = z_info->move_energy;
+}
+
+static void replay_leave_store(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	cmd_disable_repeat();
+	player->upkeep->update |= (PU_UPDATE_VIEW | PU_MONSTERS);
+	event_add_handler(EVENT_ENTER_STORE, replay_enter_store, NULL);
+}
+
+static void replay_enter_store(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	event_add_handler(EVENT_USE_STORE, replay_use_store, NULL);
+	event_add_handler(EVENT_LEAVE_STORE, replay_leave_store, NULL);
+}
+
+/**
+ * The front end saves on arriving at a new level, which disturbs the player
+ */
+static void replay_new_level(game_event_type type, game_event_data *data,
+							 void *user)
+{
+	if (player->upkeep->autosave) {
+		disturb(player, 1);
+		player->upkeep->autosave = false;
+	}
+}
+
+static void replay_cheat_death(game_event_type type, game_event_data *data,
+							   void *user)
+{
+	wiz_cheat_death();
+}
+
+/**
+ * Play the whole record back, quitting if it can't be or comes out different
+ */
+static void replay_one(void)
+{
+	struct record_digest got, want;
+	clock_t start;
+	double secs;
+
+	if (!cmd_replay_start(replay_path))
+		quit_fmt("Cannot play back '%s'", replay_path);
+
+	cmd_get_hook = replay_get_cmd;
+	event_add_handler(EVENT_ENTER_STORE, replay_enter_store, NULL);
+	event_add_handler(EVENT_NEW_LEVEL_DISPLAY, replay_new_level, NULL);
+	event_add_handler(EVENT_CHEAT_DEATH, replay_cheat_death, NULL);
+
+	start = clock();
+
+	/* Birth the character */
+	character_generated = false;
+	while (cmd_replay_push(CMD_BIRTH))
+		cmdq_execute(CMD_BIRTH);
+	if (!character_generated)
+		quit_fmt("'%s' does not start with a new character", replay_path);
+
+	/* Then play it, as play_game() would */
+	player->upkeep->autosave = false;
+	if (!character_dungeon)
+		cave_generate(&cave, player);
+	on_new_level();
+
+	while (!player->is_dead && player->upkeep->playing) {
+		cmd_get_hook(CMD_GAME);
+		run_game_loop();
+	}
+
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	cmd_record_digest(&got);
+
+	if (!quiet) {
+		printf("Played back to turn %d in %.2fs\n", got.turn, secs);
+		printf("Depth %d, exp %d, gold %d, hp %d, at (%d, %d)\n", got.depth,
+			   got.exp, got.au, got.chp, got.px, got.py);
+	}
+
+	if (!cmd_replay_expected(&want)) {
+		cmd_record_stop();
+		quit_fmt("'%s' ends early, so can't be checked", replay_path);
+	}
+	cmd_record_stop();
+
+	if (memcmp(&got, &want, sizeof(got)))
+		quit_fmt("Replay differs from the record, which ended on turn %d at "
+				 "depth %d with exp %d, gold %d, hp %d, at (%d, %d)", want.turn,
+				 want.depth, want.exp, want.au, want.chp, want.px, want.py);
+
+	printf("Replay matches the record\n");
+
+	event_remove_handler(EVENT_ENTER_STORE, replay_enter_store, NULL);
+	event_remove_handler(EVENT_NEW_LEVEL_DISPLAY, replay_new_level, NULL);
+	event_remove_handler(EVENT_CHEAT_DEATH, replay_cheat_death, NULL);
+}
+
+#ifdef UNIX
+/**
+ * Play back each record named on stdin in a child process, so that each
+ * starts from the freshly loaded game data without having to load it again
+ */
+static void replay_list(void)
+{
+	char buf[1024];
+	char **paths = NULL;
+	int n = 0, i;
+	int played = 0, failed = 0;
+
+	/* Read the whole list first; the children share stdin's file offset,
+	 * and a child leaving through exit() would move it under us */
+	while (fgets(buf, sizeof(buf), stdin)) {
+		/* Strip the line ending, and skip blank lines */
+		buf[strcspn(buf, "\r\n")] = '\0';
+		if (!buf[0]) continue;
+
+		paths = mem_realloc(paths, (n + 1) * sizeof(*paths));
+		paths[n++] = string_make(buf);
+	}
+
+	for (i = 0; i < n; i++) {
+		pid_t pid;
+		int status;
+
+		/* Don't let the child print what is waiting to be printed again */
+		fflush(stdout);
+
+		pid = fork();
+		if (pid < 0) quit("Couldn't start a replay!");
+
+		if (pid == 0) {
+			replay_path = paths[i];
+			replay_one();
+			fflush(stdout);
+			_exit(0);
+		}
+
+		played++;
+		if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+			WEXITSTATUS(status)) {
+			printf("%s: replay failed\n", paths[i]);
+			failed++;
+		}
+	}
+
+	for (i = 0; i < n; i++)
+		string_free(paths[i]);
+	mem_free(paths);
+
+	printf("%d of %d replays matched their records\n", played - failed,
+		   played);
+	fflush(stdout);
+	if (failed)
+		quit_fmt("%d replays failed", failed);
+}
+#endif /* UNIX */
+
+/**
+ * Play the record, or records, back; there is no display, so this is called
+ * from main() in place of play_game().
+ */
+errr run_replay(void)
+{
+#ifdef UNIX
+	if (streq(replay_path, "-")) {
+		replay_list();
+		return 0;
+	}
+#endif /* UNIX */
+
+	replay_one();
+	return 0;
+}
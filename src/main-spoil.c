@@ -0,0 +1,184 @@
+/**
+ * \file main-spoil.c
+ * \brief Write the spoiler files with no display, for scripts and web sites
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "game-world.h"
+#include "init.h"
+#include "main.h"
+#include "obj-randart.h"
+#include "wizard.h"
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * The spoiler files there are, by the name used to ask for them
+ */
+static const struct spoiler {
+	const char *name;
+	const char *fname;
+	bool (*write)(const char *fname);
+} spoilers[] = {
+	{ "obj", "obj-desc.spo", spoil_obj_desc },
+	{ "art", "artifact.spo", spoil_artifact },
+	{ "mon", "mon-desc.spo", spoil_mon_desc },
+	{ "info", "mon-info.spo", spoil_mon_info },
+};
+
+static bool wanted[N_ELEMENTS(spoilers)];
+static bool spoil_mode = false;
+static bool randarts = false;
+static u32b randart_seed;
+static const char *out_dir;
+
+const char help_spoil[] = "Spoiler mode, subopts -s(poil: obj, art, mon, info or all) -r<seed> (randarts) -d<dir>";
+
+/**
+ * Usage:
+ *
+ * angband -mspoil -- -s<which> [-s<which>...] [-r<seed>] [-d<dir>]
+ *
+ *   -s<which>  Write the spoiler <which>: obj, art, mon, info, or all of them
+ *   -r<seed>   Make the artifacts random first, from <seed>
+ *   -d<dir>    Write the files to <dir> rather than the user directory
+ */
+errr init_spoil(int argc, char *argv[])
+{
+	size_t j;
+	int i;
+
+	/* Skip over argv[0] */
+	for (i = 1; i < argc; i++) {
+		if (prefix(argv[i], "-s")) {
+			const char *which = argv[i] + 2;
+			bool found = false;
+
+			for (j = 0; j < N_ELEMENTS(spoilers); j++) {
+				if (streq(which, "all") || streq(which, spoilers[j].name)) {
+					wanted[j] = true;
+					found = true;
+				}
+			}
+			if (!found)
+				printf("init-spoil: no spoiler called '%s'\n", which);
+			spoil_mode = true;
+			continue;
+		}
+		if (prefix(argv[i], "-r")) {
+			randarts = true;
+			randart_seed = strtoul(argv[i] + 2, NULL, 0);
+			continue;
+		}
+		if (prefix(argv[i], "-d")) {
+			out_dir = argv[i] + 2;
+			continue;
+		}
+		printf("init-spoil: bad argument '%s'\n", argv[i]);
+	}
+
+	/* Nothing asked for, so leave it to the other modules */
+	return spoil_mode ? 0 : 1;
+}
+
+/**
+ * Write one spoiler file, saying how it went
+ */
+static bool spoil_one(const struct spoiler *spoiler)
+{
+	char path[1024];
+
+	if (out_dir)
+		path_build(path, sizeof(path), out_dir, spoiler->fname);
+	else
+		path_build(path, sizeof(path), ANGBAND_DIR_USER, spoiler->fname);
+
+	if (!spoiler->write(path)) {
+		printf("Cannot write %s\n", path);
+		return false;
+	}
+
+	printf("Wrote %s\n", path);
+	return true;
+}
+
+/**
+ * Write the spoilers that were asked for; there is no display, so this is
+ * called from main() in place of play_game().
+ *
+ * Each file is written by a process of its own if there is more than one,
+ * since they share nothing but the game data, which is loaded already by
+ * the time they are set going.
+ */
+errr run_spoil(void)
+{
+	int failed = 0, count = 0;
+	size_t j;
+#ifdef UNIX
+	pid_t pids[N_ELEMENTS(spoilers)];
+	int started = 0;
+#endif /* UNIX */
+
+	for (j = 0; j < N_ELEMENTS(spoilers); j++)
+		if (wanted[j]) count++;
+
+	if (randarts) {
+		seed_randart = randart_seed;
+		do_randart(seed_randart, false);
+	}
+
+	/* Don't let the children print what is waiting to be printed again */
+	fflush(stdout);
+
+	for (j = 0; j < N_ELEMENTS(spoilers); j++) {
+		if (!wanted[j]) continue;
+
+#ifdef UNIX
+		pids[j] = (count > 1) ? fork() : -1;
+		if (pids[j] == 0) {
+			bool ok = spoil_one(&spoilers[j]);
+			fflush(stdout);
+			_exit(ok ? 0 : 1);
+		}
+		if (pids[j] > 0) {
+			started++;
+			continue;
+		}
+#endif /* UNIX */
+
+		/* Just the one, or no processes to spare, so write it here */
+		if (!spoil_one(&spoilers[j]))
+			failed++;
+	}
+
+#ifdef UNIX
+	for (j = 0; started && j < N_ELEMENTS(spoilers); j++) {
+		int status;
+
+		if (!wanted[j] || pids[j] <= 0) continue;
+		if (waitpid(pids[j], &status, 0) < 0 || !WIFEXITED(status) ||
+			WEXITSTATUS(status))
+			failed++;
+	}
+#endif /* UNIX */
+
+	if (failed)
+		quit_fmt("%d spoiler files could not be written", failed);
+
+	return 0;
+}
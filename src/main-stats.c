@@ -42,6 +42,10 @@
 #include "store.h"
 #include <stddef.h>
 #include <time.h>
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #define OBJ_FEEL_MAX	 11
 #define MON_FEEL_MAX 	 10
@@ -53,6 +57,9 @@
 #define TOP_POWER		999
 #define TOP_MOD 		 25
 #define RUNS_PER_CHECKPOINT	10000
+#define RUNS_PER_ROUND		 1000 /* runs shared out to workers at a time */
+#define CHECKPOINT_FILE		"checkpoint"
+#define CHECKPOINT_MAGIC	0x41734301
 
 /* For ref, e_max is 128, a_max is 136, r_max is ~650,
 	ORIGIN_STATS is 14, OF_MAX is ~120 */
@@ -66,16 +73,29 @@
 static int randarts = 0;
 static int no_selling = 0;
 static u32b num_runs = 1;
+static int num_workers = 1;
 static bool quiet = false;
-static int nextkey = 0;
-static int running_stats = 0;
+static bool scratch_db = false;
+static bool resume = false;
+static u32b runs_resumed = 0;
 static char *ANGBAND_DIR_STATS;
 
 static int *consumables_index;
 static int *wearables_index;
+static int *consumables_kidx;
+static int *wearables_kidx;
 static int wearable_count = 0;
 static int consumable_count = 0;
 
+/**
+ * What stats_pipe_counts() does with the counters
+ */
+enum {
+	STATS_PIPE_ADD,		/* Read counts and add them on */
+	STATS_PIPE_SEND,	/* Write counts out and zero them */
+	STATS_PIPE_SAVE		/* Write counts out and keep them */
+};
+
 struct wearables_data {
 	u32b count;
 	u32b dice[TOP_DICE][TOP_SIDES];
@@ -107,6 +127,10 @@ static void create_indices()
 	consumables_index = mem_zalloc(z_info->k_max * sizeof(int));
 	wearables_index = mem_zalloc(z_info->k_max * sizeof(int));
 
+	/* The way back from those indices to k_idx; 0 is always 0 */
+	consumables_kidx = mem_zalloc((z_info->k_max + 1) * sizeof(int));
+	wearables_kidx = mem_zalloc((z_info->k_max + 1) * sizeof(int));
+
 	for (i = 0; i < z_info->k_max; i++) {
 
 		struct object object_type_body = { 0 };
@@ -116,10 +140,13 @@ static void create_indices()
 
 		if (!kind->name) continue;
 
-		if (tval_has_variable_power(obj))
+		if (tval_has_variable_power(obj)) {
 			wearables_index[i] = ++wearable_count;
-		else
+			wearables_kidx[wearable_count] = i;
+		} else {
 			consumables_index[i] = ++consumable_count;
+			consumables_kidx[consumable_count] = i;
+		}
 	}
 }
 
@@ -173,6 +200,8 @@ static void free_stats_memory(void)
 	}
 	mem_free(consumables_index);
 	mem_free(wearables_index);
+	mem_free(consumables_kidx);
+	mem_free(wearables_kidx);
 	string_free(ANGBAND_DIR_STATS);
 }
 
@@ -213,7 +242,15 @@ static void generate_player_for_stats()
 	player->history = get_history(player->race->history);
 }
 
-static void initialize_character(void)
+/**
+ * Whether the stores have been stocked yet.  No run ever goes back to town,
+ * and stocking them is most of the cost of starting a run (ten maintenance
+ * passes over every store, far more than making the character), so it is
+ * only done for the first run of each process.
+ */
+static bool stores_stocked = false;
+
+static void initialize_character(u32b run)
 {
 	u32b seed;
 
@@ -222,7 +259,8 @@ static void initialize_character(void)
 		fflush(stdout);
 	}
 
-	seed = (time(NULL));
+	/* Runs started in the same second, or by other workers, must differ */
+	seed = (time(NULL)) ^ (run * 2654435761U);
 	Rand_quick = false;
 	Rand_state_init(seed);
 
@@ -236,7 +274,10 @@ static void initialize_character(void)
 		do_randart(seed_randart, false);
 	}
 
-	store_reset();
+	if (!stores_stocked) {
+		store_reset();
+		stores_stocked = true;
+	}
 	flavor_init();
 	player->upkeep->playing = true;
 	player->upkeep->autosave = false;
@@ -290,54 +331,62 @@ static void reset_artifacts(void)
 
 }
 
+/**
+ * Count the objects lying on the level.  Every one of them is in the level's
+ * object list, along with those monsters carry, so the list is gone through
+ * rather than every grid; the monsters have all been killed by now, so their
+ * objects are on the floor and were listed already.
+ */
 static void log_all_objects(int level)
 {
-	int x, y, i;
-
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			struct object *obj = square_object(cave, y, x);
-
-			for (obj = square_object(cave, y, x); obj; obj = obj->next) {
-				/*	u32b o_power = 0; */
-
-/*				o_power = object_power(obj, false, NULL, true); */
-
-				/* Capture gold amounts */
-				if (tval_is_money(obj))
-					level_data[level].gold[obj->origin] += obj->pval;
-
-				/* Capture artifact drops */
-				if (obj->artifact)
-					level_data[level].artifacts[obj->origin][obj->artifact->aidx]++;
-
-				/* Capture kind details */
-				if (tval_has_variable_power(obj)) {
-					struct wearables_data *w
-						= &level_data[level].wearables[obj->origin][wearables_index[obj->kind->kidx]];
-
-					w->count++;
-					w->dice[MIN(obj->dd, TOP_DICE - 1)][MIN(obj->ds, TOP_SIDES - 1)]++;
-					w->ac[MIN(MAX(obj->ac + obj->to_a, 0), TOP_AC - 1)]++;
-					w->hit[MIN(MAX(obj->to_h, 0), TOP_PLUS - 1)]++;
-					w->dam[MIN(MAX(obj->to_d, 0), TOP_PLUS - 1)]++;
-
-					/* Capture egos */
-					if (obj->ego)
-						w->egos[obj->ego->eidx]++;
-					/* Capture object flags */
-					for (i = of_next(obj->flags, FLAG_START); i != FLAG_END;
-							i = of_next(obj->flags, i + 1))
-						w->flags[i]++;
-					/* Capture object modifiers */
-					for (i = 0; i < OBJ_MOD_MAX; i++) {
-						int p = obj->modifiers[i];
-						w->modifiers[MIN(MAX(p, 0), TOP_MOD - 1)][i]++;
-					}
-				} else
-					level_data[level].consumables[obj->origin][consumables_index[obj->kind->kidx]]++;
+	int i, j;
+
+	for (j = 1; j < cave->obj_max; j++) {
+		struct object *obj = cave->objects[j];
+
+		/* Not there, or still held by something */
+		if (!obj || obj->held_m_idx) continue;
+
+		/*	u32b o_power = 0; */
+
+		/* Only the first ORIGIN_STATS origins are counted */
+		if (obj->origin >= ORIGIN_STATS) continue;
+
+/*		o_power = object_power(obj, false, NULL, true); */
+
+		/* Capture gold amounts */
+		if (tval_is_money(obj))
+			level_data[level].gold[obj->origin] += obj->pval;
+
+		/* Capture artifact drops */
+		if (obj->artifact)
+			level_data[level].artifacts[obj->origin][obj->artifact->aidx]++;
+
+		/* Capture kind details */
+		if (tval_has_variable_power(obj)) {
+			struct wearables_data *w
+				= &level_data[level].wearables[obj->origin][wearables_index[obj->kind->kidx]];
+
+			w->count++;
+			w->dice[MIN(obj->dd, TOP_DICE - 1)][MIN(obj->ds, TOP_SIDES - 1)]++;
+			w->ac[MIN(MAX(obj->ac + obj->to_a, 0), TOP_AC - 1)]++;
+			w->hit[MIN(MAX(obj->to_h, 0), TOP_PLUS - 1)]++;
+			w->dam[MIN(MAX(obj->to_d, 0), TOP_PLUS - 1)]++;
+
+			/* Capture egos */
+			if (obj->ego)
+				w->egos[obj->ego->eidx]++;
+			/* Capture object flags */
+			for (i = of_next(obj->flags, FLAG_START); i != FLAG_END;
+					i = of_next(obj->flags, i + 1))
+				w->flags[i]++;
+			/* Capture object modifiers */
+			for (i = 0; i < OBJ_MOD_MAX; i++) {
+				int p = obj->modifiers[i];
+				w->modifiers[MIN(MAX(p, 0), TOP_MOD - 1)][i]++;
 			}
-		}
+		} else
+			level_data[level].consumables[obj->origin][consumables_index[obj->kind->kidx]]++;
 	}
 }
 
@@ -809,11 +858,11 @@ static int stats_dump_lists(void)
 	STATS_DB_FINALIZE(sql_stmt)
 
 	err = stats_db_stmt_prep(&sql_stmt, 
-		"INSERT INTO object_flags_list VALUES(?,?);");
+		"INSERT INTO object_flags_list(idx, name) VALUES(?,?);");
 	if (err) return err;
 
 	for (idx = 0; idx < OF_MAX; idx++) {
-		err = stats_db_bind_ints(sql_stmt, 1, idx);
+		err = stats_db_bind_ints(sql_stmt, 1, 0, idx);
 		if (err) return err;
 		err = sqlite3_bind_text(sql_stmt, 2, object_flag_names[idx],
 			strlen(object_flag_names[idx]), SQLITE_STATIC);
@@ -824,11 +873,11 @@ static int stats_dump_lists(void)
 	STATS_DB_FINALIZE(sql_stmt)
 
 	err = stats_db_stmt_prep(&sql_stmt, 
-		"INSERT INTO object_mods_list VALUES(?,?);");
+		"INSERT INTO object_mods_list(idx, name) VALUES(?,?);");
 	if (err) return err;
 
 	for (idx = 0; object_mods[idx] != NULL; idx++) {
-		err = stats_db_bind_ints(sql_stmt, 1, idx);
+		err = stats_db_bind_ints(sql_stmt, 1, 0, idx);
 		if (err) return err;
 		err = sqlite3_bind_text(sql_stmt, 2, object_mods[idx],
 			strlen(object_mods[idx]), SQLITE_STATIC);
@@ -962,6 +1011,14 @@ static bool stats_prep_db(void)
 	status = stats_db_open();
 	if (!status) return status;
 
+	/* A scratch database isn't worth keeping safe from a crash */
+	if (scratch_db) {
+		err = stats_db_exec("PRAGMA journal_mode=WAL;");
+		if (err) return false;
+		err = stats_db_exec("PRAGMA synchronous=OFF;");
+		if (err) return false;
+	}
+
 	/* Create some tables */
 	err = stats_db_exec("CREATE TABLE metadata(field TEXT UNIQUE NOT NULL, value TEXT);");
 	if (err) return false;
@@ -1134,23 +1191,6 @@ static int stats_wearables_data_offsetof(const char *member)
 	assert(0);
 }
 
-/**
- * Given a pointer to a dynamically allocated array and a value, look up
- * the index with that value; e.g. given wearables_index[k_idx], return k_idx.
- * If not found, return -1 * value.
- */
-
-static int stats_lookup_index(const int *index, int max_idx, int value)
-{
-	int idx;
-
-	for (idx = 0; idx < max_idx; idx ++) {
-		if (index[idx] == value) return idx;
-	}
-
-	return -1 * value;
-}
-
 static int stats_write_db_level_data(const char *table, int max_idx)
 {
 	char sql_buf[256];
@@ -1170,6 +1210,8 @@ static int stats_write_db_level_data(const char *table, int max_idx)
 			u32b count;
 			if (streq(table, "gold"))
 				count = *((long long *)((byte *)&level_data[level] + offset) + i);
+			else if (streq(table, "monsters"))
+				count = level_data[level].monsters[i];
 			else
 				count = *((u32b *)((byte *)&level_data[level] + offset) + i);
 
@@ -1206,7 +1248,7 @@ static int stats_write_db_level_data_items(const char *table, int max_idx,
 				u32b count = ((u32b **)((byte *)&level_data[level] + offset))[origin][i];
 				if (!count) continue;
 				
-				err = stats_db_bind_ints(sql_stmt, 4, 0, level, count, translate_consumables ? stats_lookup_index(consumables_index, z_info->k_max, i) : i, origin);
+				err = stats_db_bind_ints(sql_stmt, 4, 0, level, count, translate_consumables ? consumables_kidx[i] : i, origin);
 				if (err) return err;
 
 				STATS_DB_STEP_RESET(sql_stmt)
@@ -1231,8 +1273,7 @@ static int stats_write_db_wearables_count(void)
 				/* Skip if object did not appear */
 				if (!count) continue;
 
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1268,8 +1309,10 @@ static int stats_write_db_wearables_array(const char *field, int max_val, bool a
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				/* Nothing else was counted if it did not appear */
+				if (!level_data[level].wearables[origin][idx].count) continue;
+
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1319,8 +1362,10 @@ static int stats_write_db_wearables_2d_array(const char *field,
 	for (level = 1; level < LEVEL_MAX; level++)
 		for (origin = 0; origin < ORIGIN_STATS; origin++)
 			for (idx = 0; idx < wearable_count + 1; idx++) {
-				k_idx = stats_lookup_index(wearables_index, 
-					z_info->k_max, idx);
+				/* Nothing else was counted if it did not appear */
+				if (!level_data[level].wearables[origin][idx].count) continue;
+
+				k_idx = wearables_kidx[idx];
 
 				/* Skip if pile */
 				if (! k_idx) continue;
@@ -1432,7 +1477,8 @@ void progress_bar(u32b run, time_t start) {
 
 	time_t delta = time(NULL) - start;
 	u32b togo = num_runs - run;
-	u32b expect = delta ? ((long long)delta * (long long)togo) / run 
+	u32b made = run - runs_resumed;
+	u32b expect = (delta && made) ? ((long long)delta * (long long)togo) / made
 		: 0;
 
 	int h = expect / 3600;
@@ -1455,222 +1501,483 @@ void progress_bar(u32b run, time_t start) {
 
 static void stats_cleanup_angband_run(void)
 {
-	if (player->history) mem_free(player->history);
+	string_free(player->history);
+	player->history = NULL;
 }
 
-static errr run_stats(void)
+/**
+ * Send the counters in a block that aren't zero down a pipe or into a
+ * checkpoint file as index and count pairs, or add what was sent to them.
+ * Most counters stay at zero, so this is far less than the whole block, and
+ * a worker only ever writes to the pages it has counted something in.
+ *
+ * STATS_PIPE_SEND zeroes the counters as they go, for workers handing on what
+ * they found; STATS_PIPE_SAVE leaves them be.
+ */
+static bool stats_pipe_counts(FILE *f, u32b *counts, u32b n, int how)
 {
-	u32b run;
-	struct artifact *a_info_save;
-	unsigned int i;
-	int err;
-	bool status; 
-
-	time_t start;
-
-	prep_output_dir();
-	create_indices();
-	alloc_memory();
-	if (randarts) {
-		a_info_save = mem_zalloc(z_info->a_max * sizeof(struct artifact));
-		for (i = 0; i < z_info->a_max; i++) {
-			if (!a_info[i].name) continue;
+	u32b pair[2];
+	u32b i;
 
-			memcpy(&a_info_save[i], &a_info[i], sizeof(struct artifact));
+	if (how != STATS_PIPE_ADD) {
+		for (i = 0; i < n; i++) {
+			if (!counts[i]) continue;
+			pair[0] = i;
+			pair[1] = counts[i];
+			if (how == STATS_PIPE_SEND) counts[i] = 0;
+			if (fwrite(pair, sizeof(pair), 1, f) != 1) return false;
 		}
+		pair[0] = n;
+		pair[1] = 0;
+		return fwrite(pair, sizeof(pair), 1, f) == 1;
 	}
 
-	if (!quiet) printf("Creating the database and dumping info...\n");
-	status = stats_prep_db();
-	if (!status) quit("Couldn't prepare database!");
-
-	if (!quiet) {
-		printf("Beginning %d runs...\n", num_runs);
-		fflush(stdout);
+	while (fread(pair, sizeof(pair), 1, f) == 1) {
+		if (pair[0] == n) return true;
+		if (pair[0] > n) return false;
+		counts[pair[0]] += pair[1];
 	}
 
-	start = time(NULL);
-	for (run = 1; run <= num_runs; run++) {
-		if (!quiet) progress_bar(run - 1, start);
-
-		if (randarts)
-			for (i = 0; i < z_info->a_max; i++)
-				memcpy(&a_info[i], &a_info_save[i], sizeof(struct artifact));
+	return false;
+}
 
-		initialize_character();
-		unkill_uniques();
-		reset_artifacts();
-		descend_dungeon();
-		stats_cleanup_angband_run();
+/**
+ * Send every counter in level_data, or add what was sent to them
+ */
+static bool stats_pipe_level_data(FILE *f, int how)
+{
+	int i, j, k, l;
 
-		/* Checkpoint every so many runs */
-		if (run % RUNS_PER_CHECKPOINT == 0) {
-			err = stats_write_db(run);
-			if (err) {
-				stats_db_close();
-				quit_fmt("Problems writing to database!  sqlite3 errno %d.",
-						 err);
-			}
+	for (i = 0; i < LEVEL_MAX; i++) {
+		struct level_data *d = &level_data[i];
+		long long gold[ORIGIN_STATS];
+
+		if (!stats_pipe_counts(f, d->monsters, z_info->r_max, how) ||
+			!stats_pipe_counts(f, d->obj_feelings, OBJ_FEEL_MAX, how) ||
+			!stats_pipe_counts(f, d->mon_feelings, MON_FEEL_MAX, how))
+			return false;
+
+		/* Gold is wider than the rest, and always there */
+		if (how != STATS_PIPE_ADD) {
+			if (fwrite(d->gold, sizeof(d->gold), 1, f) != 1) return false;
+			if (how == STATS_PIPE_SEND) memset(d->gold, 0, sizeof(d->gold));
+		} else {
+			if (fread(gold, sizeof(gold), 1, f) != 1) return false;
+			for (j = 0; j < ORIGIN_STATS; j++)
+				d->gold[j] += gold[j];
 		}
 
-		if (quiet && run % 1000 == 0) {
-			printf("Finished %d runs.\n", run);
-			fflush(stdout);
+		for (j = 0; j < ORIGIN_STATS; j++) {
+			if (!stats_pipe_counts(f, d->artifacts[j], z_info->a_max, how) ||
+				!stats_pipe_counts(f, d->consumables[j], consumable_count + 1,
+								   how))
+				return false;
+
+			for (k = 0; k < wearable_count + 1; k++) {
+				struct wearables_data *w = &d->wearables[j][k];
+				u32b count = w->count;
+
+				/* Nothing else is counted for a kind without counting it,
+				 * so a kind that wasn't found is just the one zero */
+				if (how != STATS_PIPE_ADD) {
+					if (fwrite(&count, sizeof(count), 1, f) != 1) return false;
+					if (how == STATS_PIPE_SEND) w->count = 0;
+				} else {
+					if (fread(&count, sizeof(count), 1, f) != 1) return false;
+					w->count += count;
+				}
+				if (!count) continue;
+
+				if (!stats_pipe_counts(f, w->dice[0], TOP_DICE * TOP_SIDES,
+									   how) ||
+					!stats_pipe_counts(f, w->ac, TOP_AC, how) ||
+					!stats_pipe_counts(f, w->hit, TOP_PLUS, how) ||
+					!stats_pipe_counts(f, w->dam, TOP_PLUS, how) ||
+					!stats_pipe_counts(f, w->egos, z_info->e_max, how) ||
+					!stats_pipe_counts(f, w->flags, OF_MAX, how))
+					return false;
+				for (l = 0; l < TOP_MOD; l++)
+					if (!stats_pipe_counts(f, w->modifiers[l], OBJ_MOD_MAX + 1,
+										   how))
+						return false;
+			}
 		}
 	}
 
-	if (!quiet) {
-		progress_bar(num_runs, start);
-		printf("\nSaving the data...\n");
-		fflush(stdout);
-	}
+	return true;
+}
 
-	err = stats_write_db(run);
-	stats_db_close();
-	if (err) quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
+/**
+ * The randart set each run starts from
+ */
+static struct artifact *a_info_save;
+
+/**
+ * Make one run through the dungeon, adding what was found to level_data
+ */
+static void stats_make_run(u32b run)
+{
+	unsigned int i;
 
 	if (randarts)
-		mem_free(a_info_save);
-	free_stats_memory();
-	cleanup_angband();
-	if (!quiet) printf("Done!\n");
-	quit(NULL);
-	exit(0);
+		for (i = 0; i < z_info->a_max; i++)
+			memcpy(&a_info[i], &a_info_save[i], sizeof(struct artifact));
+
+	initialize_character(run);
+	unkill_uniques();
+	reset_artifacts();
+	descend_dungeon();
+	stats_cleanup_angband_run();
 }
 
-typedef struct term_data term_data;
-struct term_data {
-	term t;
-};
+/**
+ * Fill in the header of the checkpoint file, which holds what has to match
+ * for the counters in it to make sense to the runs that carry on from it
+ */
+static void stats_checkpoint_header(u32b *head, u32b run)
+{
+	head[0] = CHECKPOINT_MAGIC;
+	head[1] = run;
+	head[2] = randarts;
+	head[3] = no_selling;
+	head[4] = z_info->r_max;
+	head[5] = z_info->a_max;
+	head[6] = z_info->e_max;
+	head[7] = wearable_count;
+	head[8] = consumable_count;
+}
 
-static term_data td;
-typedef struct {
-	int key;
-	errr (*func)(int v);
-} term_xtra_func;
+/**
+ * Write the counters so far and how many runs they came from to the
+ * checkpoint file.  It is written beside and then moved over the old one,
+ * so being stopped part way leaves the last checkpoint as it was.
+ */
+static bool stats_write_checkpoint(u32b run)
+{
+	char path[1024], temp[1024];
+	u32b head[9];
+	FILE *f;
+	bool ok;
 
-static void term_init_stats(term *t) {
-	return;
-}
+	path_build(path, sizeof(path), ANGBAND_DIR_STATS, CHECKPOINT_FILE);
+	strnfmt(temp, sizeof(temp), "%s.new", path);
 
-static void term_nuke_stats(term *t) {
-	return;
-}
+	f = fopen(temp, "wb");
+	if (!f) return false;
 
-static errr term_xtra_clear(int v) {
-	return 0;
-}
+	stats_checkpoint_header(head, run);
+	ok = fwrite(head, sizeof(head), 1, f) == 1 &&
+		stats_pipe_level_data(f, STATS_PIPE_SAVE);
+	ok = !fclose(f) && ok;
 
-static errr term_xtra_noise(int v) {
-	return 0;
+	return ok && file_move(temp, path);
 }
 
-static errr term_xtra_fresh(int v) {
-	return 0;
-}
+/**
+ * The checkpoint being resumed from, once its header has been read
+ */
+static FILE *checkpoint_in;
 
-static errr term_xtra_shape(int v) {
-	return 0;
+/**
+ * Open the checkpoint file, if there is one, and return how many runs the
+ * counters in it came from
+ */
+static u32b stats_open_checkpoint(void)
+{
+	char path[1024];
+	u32b head[9], want[9];
+
+	path_build(path, sizeof(path), ANGBAND_DIR_STATS, CHECKPOINT_FILE);
+	checkpoint_in = fopen(path, "rb");
+	if (!checkpoint_in) {
+		if (!quiet) printf("No checkpoint to resume from, starting afresh.\n");
+		return 0;
+	}
+
+	if (fread(head, sizeof(head), 1, checkpoint_in) != 1)
+		quit("Couldn't read the checkpoint!");
+	stats_checkpoint_header(want, head[1]);
+	if (memcmp(head, want, sizeof(head)))
+		quit("The checkpoint is not from runs like these!");
+
+	return head[1];
 }
 
-static errr term_xtra_alive(int v) {
-	return 0;
+/**
+ * Add the counters from the checkpoint being resumed from to level_data.
+ * This is left until any workers have been started, or they would send the
+ * counters back as if they had found them.
+ */
+static void stats_read_checkpoint(void)
+{
+	bool ok;
+
+	if (!checkpoint_in) return;
+
+	ok = stats_pipe_level_data(checkpoint_in, STATS_PIPE_ADD);
+	fclose(checkpoint_in);
+	checkpoint_in = NULL;
+	if (!ok) quit("Couldn't read the checkpoint!");
 }
 
-static errr term_xtra_event(int v) {
-	if (nextkey) {
-		Term_keypress(nextkey, 0);
-		nextkey = 0;
+static void stats_checkpoint(u32b run)
+{
+	int err = stats_write_db(run);
+
+	if (err) {
+		stats_db_close();
+		quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
 	}
-	if (running_stats) {
-		return 0;
+
+	if (!stats_write_checkpoint(run)) {
+		stats_db_close();
+		quit("Couldn't write the checkpoint!");
 	}
-	running_stats = 1;
-	return run_stats();
 }
 
-static errr term_xtra_flush(int v) {
-	return 0;
-}
+/**
+ * Make the runs one after another in this process
+ */
+static void stats_make_runs(time_t start)
+{
+	u32b run;
 
-static errr term_xtra_delay(int v) {
-	return 0;
-}
+	stats_read_checkpoint();
+	for (run = runs_resumed + 1; run <= num_runs; run++) {
+		if (!quiet) progress_bar(run - 1, start);
 
-static errr term_xtra_react(int v) {
-	return 0;
+		stats_make_run(run);
+
+		/* Checkpoint every so many runs */
+		if (run % RUNS_PER_CHECKPOINT == 0)
+			stats_checkpoint(run);
+
+		if (quiet && run % 1000 == 0) {
+			printf("Finished %d runs.\n", run);
+			fflush(stdout);
+		}
+	}
 }
 
-static term_xtra_func xtras[] = {
-	{ TERM_XTRA_CLEAR, term_xtra_clear },
-	{ TERM_XTRA_NOISE, term_xtra_noise },
-	{ TERM_XTRA_FRESH, term_xtra_fresh },
-	{ TERM_XTRA_SHAPE, term_xtra_shape },
-	{ TERM_XTRA_ALIVE, term_xtra_alive },
-	{ TERM_XTRA_EVENT, term_xtra_event },
-	{ TERM_XTRA_FLUSH, term_xtra_flush },
-	{ TERM_XTRA_DELAY, term_xtra_delay },
-	{ TERM_XTRA_REACT, term_xtra_react },
-	{ 0, NULL },
-};
+#ifdef UNIX
 
-static errr term_xtra_stats(int n, int v) {
+/**
+ * Find the share of a round's runs that worker w makes, splitting the round
+ * as evenly as it goes; *first is set to how far into the round it starts
+ */
+static u32b stats_worker_share(u32b round, int w, u32b *first)
+{
 	int i;
-	for (i = 0; xtras[i].func; i++) {
-		if (xtras[i].key == n) {
-			return xtras[i].func(v);
+
+	*first = 0;
+	for (i = 0; i < w; i++)
+		*first += (round + i) / num_workers;
+
+	return (round + w) / num_workers;
+}
+
+/**
+ * Make worker w's share of every round in a child process, sending what it
+ * found back down the pipe at the end of each round.
+ *
+ * Workers are all started before any runs are made, so they begin with the
+ * parent's empty counters and share its memory until they count something.
+ */
+static pid_t stats_start_worker(int w, FILE **result)
+{
+	int fds[2];
+	pid_t pid;
+
+	if (pipe(fds) < 0) quit("Couldn't make a pipe for a worker!");
+
+	/* Don't let the child print what is waiting to be printed again */
+	fflush(stdout);
+
+	pid = fork();
+	if (pid < 0) quit("Couldn't start a worker!");
+
+	if (pid == 0) {
+		FILE *f = fdopen(fds[1], "wb");
+		bool ok = f != NULL;
+		u32b done, round, first, share, run;
+
+		close(fds[0]);
+		quiet = true;
+		for (done = runs_resumed; ok && done < num_runs; done += round) {
+			round = MIN(RUNS_PER_ROUND, num_runs - done);
+			share = stats_worker_share(round, w, &first);
+			for (run = done + first + 1; run <= done + first + share; run++)
+				stats_make_run(run);
+
+			ok = stats_pipe_level_data(f, STATS_PIPE_SEND) && !fflush(f);
 		}
+
+		/* Leave the database and the rest alone on the way out */
+		_exit(ok && !fclose(f) ? 0 : 1);
 	}
-	return 0;
-}
 
-static errr term_curs_stats(int x, int y) {
-	return 0;
+	close(fds[1]);
+	*result = fdopen(fds[0], "rb");
+	if (!*result) quit("Couldn't read from a worker!");
+
+	return pid;
 }
 
-static errr term_wipe_stats(int x, int y, int n) {
-	return 0;
+static void stats_worker_failed(void)
+{
+	stats_db_close();
+	quit("A worker failed!");
 }
 
-static errr term_text_stats(int x, int y, int n, int a, const wchar_t *s) {
-	return 0;
+/**
+ * Share the runs out between num_workers processes, since each has its own
+ * copy of the game, and add up what they found a round at a time
+ */
+static void stats_make_runs_parallel(time_t start)
+{
+	pid_t *pids;
+	FILE **results;
+	u32b done;
+	int i;
+
+	/* There's no point having workers with nothing to do */
+	if ((u32b) num_workers > num_runs - runs_resumed)
+		num_workers = num_runs - runs_resumed;
+
+	pids = mem_zalloc(num_workers * sizeof(pid_t));
+	results = mem_zalloc(num_workers * sizeof(FILE *));
+	for (i = 0; i < num_workers; i++)
+		pids[i] = stats_start_worker(i, &results[i]);
+	stats_read_checkpoint();
+
+	for (done = runs_resumed; done < num_runs; ) {
+		if (!quiet) progress_bar(done, start);
+
+		/* Reading each in turn lets the others get on with the next round */
+		for (i = 0; i < num_workers; i++)
+			if (!stats_pipe_level_data(results[i], STATS_PIPE_ADD))
+				stats_worker_failed();
+
+		done += MIN(RUNS_PER_ROUND, num_runs - done);
+
+		if (done % RUNS_PER_CHECKPOINT == 0)
+			stats_checkpoint(done);
+
+		if (quiet && done % 1000 == 0) {
+			printf("Finished %d runs.\n", done);
+			fflush(stdout);
+		}
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		int status;
+
+		fclose(results[i]);
+		if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) ||
+			WEXITSTATUS(status))
+			stats_worker_failed();
+	}
+
+	mem_free(results);
+	mem_free(pids);
 }
 
-static void term_data_link(int i) {
-	term *t = &td.t;
+#endif /* UNIX */
 
-	term_init(t, 80, 24, 256);
+/**
+ * Make all the runs and write out the results; there is no display, so
+ * this is called from main() in place of play_game().
+ */
+errr run_stats(void)
+{
+	unsigned int i;
+	int err;
+	bool status; 
 
-	/* Ignore some actions for efficiency and safety */
-	t->never_bored = true;
-	t->never_frosh = true;
+	time_t start;
 
-	t->init_hook = term_init_stats;
-	t->nuke_hook = term_nuke_stats;
+	prep_output_dir();
+	create_indices();
+	alloc_memory();
+	if (randarts) {
+		a_info_save = mem_zalloc(z_info->a_max * sizeof(struct artifact));
+		for (i = 0; i < z_info->a_max; i++) {
+			if (!a_info[i].name) continue;
 
-	t->xtra_hook = term_xtra_stats;
-	t->curs_hook = term_curs_stats;
-	t->wipe_hook = term_wipe_stats;
-	t->text_hook = term_text_stats;
+			memcpy(&a_info_save[i], &a_info[i], sizeof(struct artifact));
+		}
+	}
 
-	t->data = &td;
+	/* Carry on from where the runs got to last time */
+	if (resume) {
+		runs_resumed = stats_open_checkpoint();
+		if (runs_resumed > num_runs) num_runs = runs_resumed;
+	}
 
-	Term_activate(t);
+	if (!quiet) printf("Creating the database and dumping info...\n");
+	status = stats_prep_db();
+	if (!status) quit("Couldn't prepare database!");
 
-	angband_term[i] = t;
+	if (!quiet) {
+		if (runs_resumed)
+			printf("Resuming after %d of %d runs...\n", runs_resumed,
+				   num_runs);
+		else
+			printf("Beginning %d runs...\n", num_runs);
+		fflush(stdout);
+	}
+
+	start = time(NULL);
+#ifdef UNIX
+	if (num_workers > 1 && num_runs > runs_resumed)
+		stats_make_runs_parallel(start);
+	else
+#endif /* UNIX */
+		stats_make_runs(start);
+
+	if (!quiet) {
+		progress_bar(num_runs, start);
+		printf("\nSaving the data...\n");
+		fflush(stdout);
+	}
+
+	err = stats_write_db(num_runs);
+	stats_db_close();
+	if (err) quit_fmt("Problems writing to database!  sqlite3 errno %d.", err);
+
+	/* Everything is in the database, so there's nothing to resume */
+	{
+		char path[1024];
+
+		path_build(path, sizeof(path), ANGBAND_DIR_STATS, CHECKPOINT_FILE);
+		if (file_exists(path)) file_delete(path);
+	}
+
+	if (randarts)
+		mem_free(a_info_save);
+	free_stats_memory();
+	cleanup_angband();
+	if (!quiet) printf("Done!\n");
+	quit(NULL);
+	exit(0);
 }
 
-const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling)";
+const char help_stats[] = "Stats mode, subopts -q(uiet) -r(andarts) -n(# of runs) -s(no selling) -j(# of workers) -f(ast, unsafe writes) -R(esume)";
 
 /**
  * Usage:
  *
- * angband -mstats -- [-q] [-r] [-nNNNN] [-s]
+ * angband -mstats -- [-q] [-r] [-nNNNN] [-s] [-jNN] [-f] [-R]
  *
  *   -q      Quiet mode (turn off progress messages)
  *   -r      Turn on randarts
  *   -nNNNN  Make NNNN runs through the dungeon (default: 1)
  *   -s      Turn on no-selling
+ *   -jNN    Share the runs out between NN processes (default: 1)
+ *   -f      Write the database through a write-ahead log without syncing;
+ *           faster, but a crash may lose it, so only for scratch databases
+ *   -R      Carry on from the checkpoint left by runs that were stopped; the
+ *           counts so far are saved there every RUNS_PER_CHECKPOINT runs
  */
 
 errr init_stats(int argc, char *argv[]) {
@@ -1694,10 +2001,21 @@ errr init_stats(int argc, char *argv[]) {
 			no_selling = 1;
 			continue;
 		}
+		if (streq(argv[i], "-f")) {
+			scratch_db = true;
+			continue;
+		}
+		if (streq(argv[i], "-R")) {
+			resume = true;
+			continue;
+		}
+		if (prefix(argv[i], "-j")) {
+			num_workers = MAX(atoi(&argv[i][2]), 1);
+			continue;
+		}
 		printf("init-stats: bad argument '%s'\n", argv[i]);
 	}
 
-	term_data_link(0);
 	return 0;
 }
 
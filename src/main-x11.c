@@ -1481,8 +1481,9 @@ static errr Infofnt_text_std(int x, int y, const wchar_t *str, int len)
 
 	/*** Handle the fake mono we can enforce on fonts ***/
 
-	/* Monotize the font */
-	if (Infofnt->mono) {
+	/* Monotize the font, unless every character already takes one tile */
+	if (Infofnt->mono && ((Infofnt->wid != td->tile_wid) ||
+		(XwcTextEscapement(Infofnt->fs, str, len) != w))) {
 		/* Do each character */
 		for (i = 0; i < len; ++i) {
 			/* Note that the Infoclr is set up to contain the Infofnt */
@@ -17,7 +17,10 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
+#include "game-world.h"
 #include "init.h"
+#include "profile.h"
 #include "savefile.h"
 #include "ui-command.h"
 #include "ui-display.h"
@@ -63,13 +66,21 @@ static const struct module modules[] =
 	{ "gcu", help_gcu, init_gcu },
 #endif /* USE_GCU */
 
+#ifdef USE_NET
+	{ "net", help_net, init_net },
+#endif /* USE_NET */
+
 #ifdef USE_TEST
 	{ "test", help_test, init_test },
 #endif /* !USE_TEST */
 
 #ifdef USE_STATS
-	{ "stats", help_stats, init_stats },
+	{ "stats", help_stats, init_stats, run_stats },
 #endif /* USE_STATS */
+
+	{ "replay", help_replay, init_replay, run_replay },
+
+	{ "spoil", help_spoil, init_spoil, run_spoil },
 };
 
 /**
@@ -258,6 +269,10 @@ static void list_saves(void)
 			continue;
 #endif
 
+		/* Skip the index of descriptions */
+		if (streq(fname, SAVEFILE_INDEX_NAME))
+			continue;
+
 		path_build(path, sizeof path, ANGBAND_DIR_SAVE, fname);
 		desc = savefile_get_description(path);
 
@@ -282,10 +297,22 @@ static void debug_opt(const char *arg) {
 		mem_flags |= MEM_POISON_ALLOC;
 	else if (streq(arg, "mem-poison-free"))
 		mem_flags |= MEM_POISON_FREE;
-	else {
+	else if (streq(arg, "mem-stats"))
+		mem_flags |= MEM_ACCOUNT;
+	else if (prefix(arg, "trace=")) {
+		if (!profile_trace_start(arg + strlen("trace=")))
+			quit_fmt("Cannot trace to '%s'%s", arg + strlen("trace="),
+					 profile_enabled() ? "" : " (needs --enable-profile)");
+	} else if (prefix(arg, "metrics=")) {
+		if (!profile_metrics_start(arg + strlen("metrics="), 1000))
+			quit_fmt("Cannot write metrics to '%s'", arg + strlen("metrics="));
+	} else {
 		puts("Debug flags:");
 		puts("  mem-poison-alloc: Poison all memory allocations");
 		puts("   mem-poison-free: Poison all freed memory");
+		puts("         mem-stats: Count allocations by part of the game");
+		puts("      trace=<file>: Write a Chrome trace of the session to <file>");
+		puts("    metrics=<file>: Write a JSON line of counters to <file> every 1000 game turns");
 		exit(0);
 	}
 }
@@ -302,8 +329,10 @@ int main(int argc, char *argv[])
 	int i;
 
 	bool done = false;
+	const struct module *mod = NULL;
 
 	const char *mstr = NULL;
+	const char *recordstr = NULL;
 #ifdef SOUND
 	const char *soundstr = NULL;
 #endif
@@ -411,6 +440,11 @@ int main(int argc, char *argv[])
 				debug_opt(arg);
 				continue;
 
+			case 'r':
+				if (!*arg) goto usage;
+				recordstr = arg;
+				continue;
+
 			case '-':
 				argv[i] = argv[0];
 				argc = argc - i;
@@ -427,6 +461,7 @@ int main(int argc, char *argv[])
 				puts("  -g             Request graphics mode");
 				puts("  -x<opt>        Debug options; see -xhelp");
 				puts("  -u<who>        Use your <who> savefile");
+				puts("  -r<file>       Record a new character's game to <file>, for -mreplay");
 				puts("  -d<dir>=<path> Override a specific directory with <path>. <path> can be:");
 				for (i = 0; i < (int)N_ELEMENTS(change_path_values); i++) {
 #ifdef SETGID
@@ -471,12 +506,16 @@ int main(int argc, char *argv[])
 			quit("Angband requires UTF-8 support");
 	}
 
+	/* What the front ends set up is counted as the UI's */
+	mem_tag_set(MEM_TAG_UI);
+
 	/* Try the modules in the order specified by modules[] */
 	for (i = 0; i < (int)N_ELEMENTS(modules); i++) {
 		/* User requested a specific module? */
 		if (!mstr || (streq(mstr, modules[i].name))) {
 			ANGBAND_SYS = modules[i].name;
 			if (0 == modules[i].init(argc, argv)) {
+				mod = &modules[i];
 				done = true;
 				break;
 			}
@@ -512,14 +551,29 @@ int main(int argc, char *argv[])
 	init_sound(soundstr, argc, argv);
 #endif
 
+	/* Headless modules drive the game themselves, with no UI at all */
+	if (mod->run) {
+		mem_tag_set(MEM_TAG_OTHER);
+		game_headless = true;
+		init_angband();
+		mod->run();
+		cleanup_angband();
+		quit(NULL);
+	}
+
 	/* Set up the display handlers and things. */
 	init_display();
 	init_angband();
 	textui_init();
+	mem_tag_set(MEM_TAG_OTHER);
 
 	/* Wait for response */
 	pause_line(Term);
 
+	/* Start recording if asked; only a new character can be played back */
+	if (recordstr && !cmd_record_start(recordstr))
+		quit_fmt("Cannot record to '%s'", recordstr);
+
 	/* Play the game */
 	play_game(new_game);
 
@@ -38,7 +38,14 @@ extern errr init_vme(int argc, char **argv);
 extern errr init_vcs(int argc, char **argv);
 extern errr init_sdl(int argc, char **argv);
 extern errr init_test(int argc, char **argv);
+extern errr init_net(int argc, char **argv);
 extern errr init_stats(int argc, char **argv);
+extern errr init_replay(int argc, char **argv);
+extern errr init_spoil(int argc, char **argv);
+
+extern errr run_stats(void);
+extern errr run_replay(void);
+extern errr run_spoil(void);
 
 
 extern const char help_lfb[];
@@ -57,7 +64,10 @@ extern const char help_ibm[];
 extern const char help_dos[];
 extern const char help_sdl[];
 extern const char help_test[];
+extern const char help_net[];
 extern const char help_stats[];
+extern const char help_replay[];
+extern const char help_spoil[];
 
 //phantom server play
 extern bool arg_force_name;
@@ -68,6 +78,7 @@ struct module
 	const char *name;
 	const char *help;
 	errr (*init)(int argc, char **argv);
+	errr (*run)(void);	/* Plays without a display, if set */
 };
 
 #endif /* INCLUDED_MAIN_H */
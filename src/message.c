@@ -26,27 +26,49 @@
 
 typedef struct _message_t
 {
-	char *str;
-	struct _message_t *newer;
-	struct _message_t *older;
+	u32b text;
 	u16b type;
 	u16b count;
 } message_t;
 
-typedef struct _msgcolor_t
-{
-	u16b type;
-	byte color;
-	struct _msgcolor_t *next;
-} msgcolor_t;
+/**
+ * How many messages are kept, and the bytes of their text; the low-memory
+ * build keeps enough for the message window and a few screens of recall
+ */
+#ifdef LOW_MEMORY
+#define MESSAGE_MAX	256
+#define MESSAGE_TEXT	16384
+#else
+#define MESSAGE_MAX	2048
+#define MESSAGE_TEXT	262144
+#endif
 
+/**
+ * The longest text kept for one message; anything longer is cut short
+ */
+#define MESSAGE_LEN	1024
+
+/**
+ * The messages are kept in a ring of `max` entries, allocated once; `head`
+ * is the slot of the newest, and older ones are found by stepping back.
+ *
+ * Their text goes in a slab of MESSAGE_TEXT bytes, also allocated once and
+ * written round and round.  Each message keeps the offset of its text as
+ * a count of bytes written since the start, so it can tell when newer text
+ * has been written over it; `text_head` is where the next text goes.  The
+ * oldest messages are dropped once their text is overwritten, so with long
+ * messages fewer than `max` are kept.  Adding a message never allocates.
+ */
 typedef struct _msgqueue_t
 {
-	message_t *head;
-	message_t *tail;
-	msgcolor_t *colors;
+	message_t *ring;
+	u32b head;
+	char *text;
+	u32b text_head;
+	byte colors[MSG_MAX];
 	u32b count;
 	u32b max;
+	u32b added;
 } msgqueue_t;
 
 static msgqueue_t *messages = NULL;
@@ -61,8 +83,13 @@ static msgqueue_t *messages = NULL;
  */
 void messages_init(void)
 {
+	int tag = mem_tag_set(MEM_TAG_MESSAGE);
+
 	messages = mem_zalloc(sizeof(msgqueue_t));
-	messages->max = 2048;
+	messages->max = MESSAGE_MAX;
+	messages->ring = mem_zalloc(messages->max * sizeof(message_t));
+	messages->text = mem_zalloc(MESSAGE_TEXT);
+	mem_tag_set(tag);
 }
 
 /**
@@ -70,24 +97,8 @@ void messages_init(void)
  */
 void messages_free(void)
 {
-	msgcolor_t *c = messages->colors;
-	msgcolor_t *nextc;
-	message_t *m = messages->head;
-	message_t *nextm;
-
-	while (m) {
-		nextm = m->older;
-		mem_free(m->str);
-		mem_free(m);
-		m = nextm;
-	}
-
-	while (c) {
-		nextc = c->next;
-		mem_free(c);
-		c = nextc;
-	}
-
+	mem_free(messages->ring);
+	mem_free(messages->text);
 	mem_free(messages);
 }
 
@@ -99,6 +110,15 @@ u16b messages_num(void)
 	return messages->count;
 }
 
+/**
+ * Return how many messages have been saved since the start, not counting
+ * repeats of the last one, so a viewer can tell how far the log has moved.
+ */
+u32b messages_added(void)
+{
+	return messages->added;
+}
+
 /**
  * ------------------------------------------------------------------------
  * Functions for individual messages
@@ -113,37 +133,46 @@ u16b messages_num(void)
  */
 void message_add(const char *str, u16b type)
 {
+	size_t len = MIN(strlen(str), MESSAGE_LEN - 1);
+	u32b pos;
 	message_t *m;
 
-	if (messages->head &&
-	    messages->head->type == type &&
-	    !strcmp(messages->head->str, str)) {
-		messages->head->count++;
-		return;
-	}
+	/* A repeat is the same as the last message as far as it was kept */
+	if (messages->count) {
+		const char *last;
 
-	m = mem_zalloc(sizeof(message_t));
-	m->str = string_make(str);
-	m->type = type;
-	m->count = 1;
-	m->older = messages->head;
+		m = &messages->ring[messages->head];
+		last = &messages->text[m->text % MESSAGE_TEXT];
+		if (m->type == type && !strncmp(last, str, len) && !last[len]) {
+			m->count++;
+			return;
+		}
+	}
 
-	if (messages->head)
-		messages->head->newer = m;
+	/* Keep the text in one piece, going back to the start if need be */
+	pos = messages->text_head % MESSAGE_TEXT;
+	if (pos + len + 1 > MESSAGE_TEXT)
+		messages->text_head += MESSAGE_TEXT - pos;
 
-	messages->head = m;
-	messages->count++;
+	/* Take the next slot, overwriting the oldest message once full */
+	messages->head = (messages->head + 1) % messages->max;
+	if (messages->count < messages->max)
+		messages->count++;
+	messages->added++;
 
-	if (!messages->tail)
-		messages->tail = m;
+	m = &messages->ring[messages->head];
+	m->text = messages->text_head;
+	m->type = type;
+	m->count = 1;
+	my_strcpy(&messages->text[m->text % MESSAGE_TEXT], str, len + 1);
+	messages->text_head += len + 1;
 
-	if (messages->count > messages->max) {
-		message_t *old_tail = messages->tail;
+	/* Forget the oldest messages, if their text has been written over */
+	while (messages->count > 1) {
+		message_t *oldest = &messages->ring[(messages->head + messages->max
+			- (messages->count - 1)) % messages->max];
 
-		messages->tail = old_tail->newer;
-		messages->tail->older = NULL;
-		mem_free(old_tail->str);
-		mem_free(old_tail);
+		if (messages->text_head - oldest->text <= MESSAGE_TEXT) break;
 		messages->count--;
 	}
 }
@@ -153,12 +182,11 @@ void message_add(const char *str, u16b type)
  */
 static message_t *message_get(u16b age)
 {
-	message_t *m = messages->head;
-
-	while (m && age--)
-		m = m->older;
+	if (age >= messages->count)
+		return NULL;
 
-	return m;
+	return &messages->ring[(messages->head + messages->max - age)
+						   % messages->max];
 }
 
 
@@ -172,7 +200,7 @@ static message_t *message_get(u16b age)
 const char *message_str(u16b age)
 {
 	message_t *m = message_get(age);
-	return (m ? m->str : "");
+	return (m ? &messages->text[m->text % MESSAGE_TEXT] : "");
 }
 
 /**
@@ -222,28 +250,8 @@ byte message_color(u16b age)
  */
 void message_color_define(u16b type, byte color)
 {
-	msgcolor_t *mc;
-
-	if (!messages->colors)
-	{
-		messages->colors = mem_zalloc(sizeof(msgcolor_t));
-		messages->colors->type = type;
-		messages->colors->color = color;
-	}
-
-	mc = messages->colors;
-	while (mc->next)
-	{
-		if (mc->type == type)
-		{
-			mc->color = color;
-		}
-		mc = mc->next;
-	}
-
-	mc->next = mem_zalloc(sizeof(msgcolor_t));
-	mc->next->type = type;
-	mc->next->color = color;
+	if (type < MSG_MAX)
+		messages->colors[type] = color;
 }
 
 /**
@@ -251,21 +259,85 @@ void message_color_define(u16b type, byte color)
  */
 byte message_type_color(u16b type)
 {
-	msgcolor_t *mc;
 	byte color = COLOUR_WHITE;
 
-	if (messages)
-	{
-		mc = messages->colors;
+	if (messages && (type < MSG_MAX) &&
+		(messages->colors[type] != COLOUR_DARK))
+		color = messages->colors[type];
+
+	return color;
+}
+
+/**
+ * ------------------------------------------------------------------------
+ * Message names
+ * ------------------------------------------------------------------------ */
+
+static const char *message_names[] = {
+	#define MSG(x, s) #x,
+	#include "list-message.h"
+	#undef MSG
+};
+
+static const char *sound_names[] = {
+	#define MSG(x, s) s,
+	#include "list-message.h"
+	#undef MSG
+};
+
+/**
+ * Open-addressed indexes from the names above to 1 + their MSG_ value, so
+ * that pref files and sound configs don't scan the whole list per line.
+ */
+#define MSG_NAME_SLOTS	512
+
+static u16b message_name_index[MSG_NAME_SLOTS];
+static u16b sound_name_index[MSG_NAME_SLOTS];
+static bool message_indexes_built = false;
+
+/**
+ * Find the slot holding `name`, or the empty one where it would go.  The
+ * hash is djb2 without case, as names are matched with my_stricmp().
+ */
+static size_t message_name_slot(const u16b *index, const char **names,
+								const char *name)
+{
+	u32b hash = 5381;
+	const char *s;
+	size_t i;
+
+	for (s = name; *s; s++)
+		hash = ((hash << 5) + hash) + tolower((unsigned char)*s);
+
+	for (i = hash & (MSG_NAME_SLOTS - 1); index[i];
+		 i = (i + 1) & (MSG_NAME_SLOTS - 1))
+		if (my_stricmp(names[index[i] - 1], name) == 0)
+			break;
 
-		while (mc && mc->type != type)
-			mc = mc->next;
+	return i;
+}
 
-		if (mc && (mc->color != COLOUR_DARK))
-			color = mc->color;
+static void message_indexes_build(void)
+{
+	size_t i, slot;
+
+	assert(MSG_MAX * 2 <= MSG_NAME_SLOTS);
+
+	/* Earlier entries win, as they did in a straight scan */
+	for (i = 0; i < MSG_MAX; i++) {
+		slot = message_name_slot(message_name_index, message_names,
+								 message_names[i]);
+		if (!message_name_index[slot])
+			message_name_index[slot] = i + 1;
+
+		if (!sound_names[i][0]) continue;
+		slot = message_name_slot(sound_name_index, sound_names,
+								 sound_names[i]);
+		if (!sound_name_index[slot])
+			sound_name_index[slot] = i + 1;
 	}
 
-	return color;
+	message_indexes_built = true;
 }
 
 /**
@@ -277,23 +349,17 @@ byte message_type_color(u16b type)
  */
 int message_lookup_by_name(const char *name)
 {
-	static const char *message_names[] = {
-		#define MSG(x, s) #x,
-		#include "list-message.h"
-		#undef MSG
-	};
-	size_t i;
 	unsigned int number;
+	size_t slot;
 
 	if (sscanf(name, "%u", &number) == 1)
 		return (number < MSG_MAX) ? (int)number : -1;
 
-	for (i = 0; i < N_ELEMENTS(message_names); i++) {
-		if (my_stricmp(name, message_names[i]) == 0)
-			return (int)i;
-	}
+	if (!message_indexes_built)
+		message_indexes_build();
 
-	return -1;
+	slot = message_name_slot(message_name_index, message_names, name);
+	return (int)message_name_index[slot] - 1;
 }
 
 /**
@@ -304,19 +370,13 @@ int message_lookup_by_name(const char *name)
  */
 int message_lookup_by_sound_name(const char *name)
 {
-	static const char *sound_names[] = {
-		#define MSG(x, s) s,
-		#include "list-message.h"
-		#undef MSG
-	};
-	size_t i;
+	size_t slot;
 
-	for (i = 0; i < N_ELEMENTS(sound_names); i++) {
-		if (my_stricmp(name, sound_names[i]) == 0)
-			return (int)i;
-	}
+	if (!message_indexes_built)
+		message_indexes_build();
 
-	return MSG_GENERIC;
+	slot = message_name_slot(sound_name_index, sound_names, name);
+	return sound_name_index[slot] ? sound_name_index[slot] - 1 : MSG_GENERIC;
 }
 
 /**
@@ -327,12 +387,6 @@ int message_lookup_by_sound_name(const char *name)
  */
 const char *message_sound_name(int message)
 {
-	static const char *sound_names[] = {
-		#define MSG(x, s) s,
-		#include "list-message.h"
-		#undef MSG
-	};
-
 	if (message < MSG_GENERIC || message >= MSG_MAX)
 		return NULL;
 
@@ -103,7 +103,7 @@ static void remove_bad_spells(struct monster *mon, bitflag f[RSF_SIZE])
 			of_wipe(mon->known_pstate.flags);
 			pf_wipe(mon->known_pstate.pflags);
 			for (i = 0; i < ELEM_MAX; i++)
-				mon->known_pstate.el_info[i].res_level = 0;
+				mon->known_pstate.res_level[i] = 0;
 		}
 
 		/* Use the memorized info */
@@ -113,7 +113,7 @@ static void remove_bad_spells(struct monster *mon, bitflag f[RSF_SIZE])
 			know_something = true;
 
 		for (i = 0; i < ELEM_MAX; i++) {
-			el[i].res_level = mon->known_pstate.el_info[i].res_level;
+			el[i].res_level = mon->known_pstate.res_level[i];
 			if (el[i].res_level != 0)
 				know_something = true;
 		}
@@ -128,30 +128,40 @@ static void remove_bad_spells(struct monster *mon, bitflag f[RSF_SIZE])
 }
 
 
+/**
+ * Offsets of the grids a summon can appear in: everything within distance 2,
+ * which is the 5x5 square less its corners
+ */
+static const struct loc summon_offsets[] = {
+	{ -1, -2 }, {  0, -2 }, {  1, -2 },
+	{ -2, -1 }, { -1, -1 }, {  0, -1 }, {  1, -1 }, {  2, -1 },
+	{ -2,  0 }, { -1,  0 }, {  0,  0 }, {  1,  0 }, {  2,  0 },
+	{ -2,  1 }, { -1,  1 }, {  0,  1 }, {  1,  1 }, {  2,  1 },
+	{ -1,  2 }, {  0,  2 }, {  1,  2 }
+};
+
 /**
  * Determine if there is a space near the selected spot in which
  * a summoned creature can appear
  */
 static bool summon_possible(int y1, int x1)
 {
-	int y, x;
+	size_t i;
 
-	/* Start at the location, and check 2 grids in each dir */
-	for (y = y1 - 2; y <= y1 + 2; y++) {
-		for (x = x1 - 2; x <= x1 + 2; x++) {
-			/* Ignore illegal locations */
-			if (!square_in_bounds(cave, y, x)) continue;
+	/* Check the grids within 2 of the location */
+	for (i = 0; i < N_ELEMENTS(summon_offsets); i++) {
+		int y = y1 + summon_offsets[i].y;
+		int x = x1 + summon_offsets[i].x;
 
-			/* Only check a circular area */
-			if (distance(y1, x1, y, x) > 2) continue;
+		/* Ignore illegal locations */
+		if (!square_in_bounds(cave, y, x)) continue;
 
-			/* Hack: no summon on glyph of warding */
-			if (square_iswarded(cave, y, x)) continue;
+		/* Hack: no summon on glyph of warding */
+		if (square_iswarded(cave, y, x)) continue;
 
-			/* If it's empty floor grid in line of sight, we're good */
-			if (square_isempty(cave, y, x) && los(cave, y1, x1, y, x))
-				return (true);
-		}
+		/* If it's empty floor grid in line of sight, we're good */
+		if (square_isempty(cave, y, x) && los(cave, y1, x1, y, x))
+			return (true);
 	}
 
 	return false;
@@ -300,7 +310,8 @@ bool make_attack_spell(struct monster *mon)
 			ignore_spells(f, RST_BOLT);
 
 		/* Check for a possible summon */
-		if (!(summon_possible(mon->fy, mon->fx)))
+		if (test_spells(f, RST_SUMMON) &&
+			!(summon_possible(mon->fy, mon->fx)))
 
 			/* Remove summoning spells */
 			ignore_spells(f, RST_SUMMON);
@@ -460,10 +471,14 @@ bool make_attack_normal(struct monster *mon, struct player *p)
 	char ddesc[80];
 	bool blinked;
 	bool stunned;
+	int rng;
 
 	/* Not allowed to attack */
 	if (rf_has(mon->race->flags, RF_NEVER_BLOW)) return (false);
 
+	/* Blows come from the combat stream */
+	rng = Rand_stream(RNG_COMBAT);
+
 	/* Total armor */
 	ac = p->state.ac + p->state.to_a;
 
@@ -694,6 +709,8 @@ bool make_attack_normal(struct monster *mon, struct player *p)
 	/* Learn lore */
 	lore_update(mon->race, lore);
 
+	Rand_stream(rng);
+
 	/* Assume we attacked */
 	return (true);
 }
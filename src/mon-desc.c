@@ -64,57 +64,13 @@ void get_mon_name(char *buf, size_t buflen,
 }
 
 /**
- * Builds a string describing a monster in some way.
- *
- * We can correctly describe monsters based on their visibility.
- * We can force all monsters to be treated as visible or invisible.
- * We can build nominatives, objectives, possessives, or reflexives.
- * We can selectively pronominalize hidden, visible, or all monsters.
- * We can use definite or indefinite descriptions for hidden monsters.
- * We can use definite or indefinite descriptions for visible monsters.
- *
- * Pronominalization involves the gender whenever possible and allowed,
- * so that by cleverly requesting pronominalization / visibility, you
- * can get messages like "You hit someone.  She screams in agony!".
- *
- * Reflexives are acquired by requesting Objective plus Possessive.
- *
- * Note that the "possessive" for certain unique monsters will look
- * really silly, as in "Morgoth, King of Darkness's".  We should
- * perhaps add a flag to "remove" any "descriptives" in the name.
- *
- * Note that "offscreen" monsters will get a special "(offscreen)"
- * notation in their name if they are visible but offscreen.  This
- * may look silly with possessives, as in "the rat's (offscreen)".
- * Perhaps the "offscreen" descriptor should be abbreviated.
- *
- * Mode Flags:
- *   0x01 --> Objective (or Reflexive)
- *   0x02 --> Possessive (or Reflexive)
- *   0x04 --> Use indefinites for hidden monsters ("something")
- *   0x08 --> Use indefinites for visible monsters ("a kobold")
- *   0x10 --> Pronominalize hidden monsters
- *   0x20 --> Pronominalize visible monsters
- *   0x40 --> Assume the monster is hidden
- *   0x80 --> Assume the monster is visible
- *  0x100 --> Capitalise monster name
- *
- * Useful Modes:
- *   0x00 --> Full nominative name ("the kobold") or "it"
- *   0x04 --> Full nominative name ("the kobold") or "something"
- *   0x80 --> Banishment resistance name ("the kobold")
- *   0x88 --> Killing name ("a kobold")
- *   0x22 --> Possessive, genderized if visable ("his") or "its"
- *   0x23 --> Reflexive, genderized if visable ("himself") or "itself"
+ * Describe a monster of race `race`, as monster_desc() does, given whether
+ * it is seen and whether it is offscreen
  */
-void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
+static void monster_desc_aux(char *desc, size_t max,
+							 const struct monster_race *race, int mode,
+							 bool seen, bool offscreen)
 {
-	assert(mon != NULL);
-
-	/* Can we see it? (forced, or not hidden + visible) */
-	bool seen = (mode & MDESC_SHOW) ||
-		(!(mode & MDESC_HIDE) && monster_is_visible(mon));
-
 	/* Sexed pronouns (seen and forced, or unseen and allowed) */
 	bool use_pronoun = (seen && (mode & MDESC_PRO_VIS)) ||
 			(!seen && (mode & MDESC_PRO_HID));
@@ -128,9 +84,9 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
 
 		/* Extract the gender (if applicable) */
 		if (use_pronoun) {
-			if (rf_has(mon->race->flags, RF_FEMALE)) {
+			if (rf_has(race->flags, RF_FEMALE)) {
 				msex = 0x20;
-			} else if (rf_has(mon->race->flags, RF_MALE)) {
+			} else if (rf_has(race->flags, RF_MALE)) {
 				msex = 0x10;
 			}
 		}
@@ -171,28 +127,28 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
 		my_strcpy(desc, choice, max);
 	} else if ((mode & MDESC_POSS) && (mode & MDESC_OBJE)) {
 		/* The monster is visible, so use its gender */
-		if (rf_has(mon->race->flags, RF_FEMALE))
+		if (rf_has(race->flags, RF_FEMALE))
 			my_strcpy(desc, "herself", max);
-		else if (rf_has(mon->race->flags, RF_MALE))
+		else if (rf_has(race->flags, RF_MALE))
 			my_strcpy(desc, "himself", max);
 		else
 			my_strcpy(desc, "itself", max);
 	} else {
 		/* Unique, indefinite or definite */
-		if (rf_has(mon->race->flags, RF_UNIQUE)) {
+		if (rf_has(race->flags, RF_UNIQUE)) {
 			/* Start with the name (thus nominative and objective) */
-			my_strcpy(desc, mon->race->name, max);
+			my_strcpy(desc, race->name, max);
 		} else {
 			if (mode & MDESC_IND_VIS) {
 				/* XXX Check plurality for "some" */
 				/* Indefinite monsters need an indefinite article */
-				my_strcpy(desc, is_a_vowel(mon->race->name[0]) ? "an " : "a ", max);
+				my_strcpy(desc, is_a_vowel(race->name[0]) ? "an " : "a ", max);
 			} else {
 				/* Definite monsters need a definite article */
 				my_strcpy(desc, "the ", max);
 			}
 
-			my_strcat(desc, mon->race->name, max);
+			my_strcat(desc, race->name, max);
 		}
 
 		/* Handle the possessive */
@@ -202,7 +158,7 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
 		}
 
 		/* Mention "offscreen" monsters */
-		if (!panel_contains(mon->fy, mon->fx)) {
+		if (offscreen) {
 			my_strcat(desc, " (offscreen)", max);
 		}
 	}
@@ -211,3 +167,107 @@ void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
 		my_strcap(desc);
 	}
 }
+
+/**
+ * Descriptions made lately, by everything that goes into one: the race, the
+ * mode, and whether the monster is seen and offscreen.  The same monsters
+ * are described many times in a busy turn, once or more for each of their
+ * moves and attacks, and this saves building the name each time.  An entry
+ * can only go out of date if the races are loaded again.
+ */
+#define MDESC_CACHE_SIZE	64
+#define MDESC_CACHE_SEEN	0x1000
+#define MDESC_CACHE_OFFSCREEN	0x2000
+
+static struct mdesc_cache {
+	const struct monster_race *race;
+	int key;
+	char desc[80];
+} mdesc_cache[MDESC_CACHE_SIZE];
+
+/**
+ * Forget the descriptions made so far, for when the races are freed
+ */
+void monster_desc_forget(void)
+{
+	memset(mdesc_cache, 0, sizeof(mdesc_cache));
+}
+
+/**
+ * Builds a string describing a monster in some way.
+ *
+ * We can correctly describe monsters based on their visibility.
+ * We can force all monsters to be treated as visible or invisible.
+ * We can build nominatives, objectives, possessives, or reflexives.
+ * We can selectively pronominalize hidden, visible, or all monsters.
+ * We can use definite or indefinite descriptions for hidden monsters.
+ * We can use definite or indefinite descriptions for visible monsters.
+ *
+ * Pronominalization involves the gender whenever possible and allowed,
+ * so that by cleverly requesting pronominalization / visibility, you
+ * can get messages like "You hit someone.  She screams in agony!".
+ *
+ * Reflexives are acquired by requesting Objective plus Possessive.
+ *
+ * Note that the "possessive" for certain unique monsters will look
+ * really silly, as in "Morgoth, King of Darkness's".  We should
+ * perhaps add a flag to "remove" any "descriptives" in the name.
+ *
+ * Note that "offscreen" monsters will get a special "(offscreen)"
+ * notation in their name if they are visible but offscreen.  This
+ * may look silly with possessives, as in "the rat's (offscreen)".
+ * Perhaps the "offscreen" descriptor should be abbreviated.
+ *
+ * Mode Flags:
+ *   0x01 --> Objective (or Reflexive)
+ *   0x02 --> Possessive (or Reflexive)
+ *   0x04 --> Use indefinites for hidden monsters ("something")
+ *   0x08 --> Use indefinites for visible monsters ("a kobold")
+ *   0x10 --> Pronominalize hidden monsters
+ *   0x20 --> Pronominalize visible monsters
+ *   0x40 --> Assume the monster is hidden
+ *   0x80 --> Assume the monster is visible
+ *  0x100 --> Capitalise monster name
+ *
+ * Useful Modes:
+ *   0x00 --> Full nominative name ("the kobold") or "it"
+ *   0x04 --> Full nominative name ("the kobold") or "something"
+ *   0x80 --> Banishment resistance name ("the kobold")
+ *   0x88 --> Killing name ("a kobold")
+ *   0x22 --> Possessive, genderized if visable ("his") or "its"
+ *   0x23 --> Reflexive, genderized if visable ("himself") or "itself"
+ */
+void monster_desc(char *desc, size_t max, const struct monster *mon, int mode)
+{
+	struct mdesc_cache *entry;
+	bool seen, offscreen;
+	int key;
+
+	assert(mon != NULL);
+
+	/* Can we see it? (forced, or not hidden + visible) */
+	seen = (mode & MDESC_SHOW) ||
+		(!(mode & MDESC_HIDE) && monster_is_visible(mon));
+	offscreen = !panel_contains(mon->fy, mon->fx);
+
+	/* Longer than the cache keeps, so make it here */
+	if (max > sizeof(entry->desc)) {
+		monster_desc_aux(desc, max, mon->race, mode, seen, offscreen);
+		return;
+	}
+
+	/* A shorter buffer just gets the start of the cached description, as it
+	 * would have if the description were made straight into it */
+	key = mode | (seen ? MDESC_CACHE_SEEN : 0) |
+		(offscreen ? MDESC_CACHE_OFFSCREEN : 0);
+	entry = &mdesc_cache[(((size_t)mon->race >> 4) ^ (size_t)(key * 31)) %
+						 MDESC_CACHE_SIZE];
+	if ((entry->race != mon->race) || (entry->key != key)) {
+		monster_desc_aux(entry->desc, sizeof(entry->desc), mon->race, mode,
+						 seen, offscreen);
+		entry->race = mon->race;
+		entry->key = key;
+	}
+
+	my_strcpy(desc, entry->desc, max);
+}
@@ -21,6 +21,7 @@
 #include "effects.h"
 #include "generate.h"
 #include "init.h"
+#include "mon-desc.h"
 #include "mon-init.h"
 #include "mon-lore.h"
 #include "mon-msg.h"
@@ -899,7 +900,11 @@ static errr run_parse_mon_spell(struct parser *p) {
 }
 
 static errr finish_parse_mon_spell(struct parser *p) {
+	struct monster_spell *s;
+
 	monster_spells = parser_priv(p);
+	for (s = monster_spells; s; s = s->next)
+		s->effect = effect_chain_pack(s->effect);
 	parser_destroy(p);
 	return 0;
 }
@@ -1058,6 +1063,7 @@ static void cleanup_mon_base(void)
 {
 	struct monster_base *rb, *next;
 
+	lookup_monster_forget();
 	rb = rb_info;
 	while (rb) {
 		next = rb->next;
@@ -1654,6 +1660,8 @@ static void cleanup_monster(void)
 		mem_free(r->blow);
 	}
 
+	lookup_monster_forget();
+	monster_desc_forget();
 	mem_free(r_info);
 }
 
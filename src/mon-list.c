@@ -18,6 +18,7 @@
  */
 
 #include "game-world.h"
+#include "init.h"
 #include "mon-desc.h"
 #include "mon-list.h"
 #include "mon-predicate.h"
@@ -139,17 +140,23 @@ void monster_list_collect(monster_list_t *list)
 {
 	int i;
 
+	/* Each race's place in the list, plus one; zero if not there yet */
+	u16b *race_entry;
+
 	if (list == NULL || list->entries == NULL)
 		return;
 
 	if (!monster_list_can_update(list))
 		return;
 
+	race_entry = mem_zalloc(z_info->r_max * sizeof(*race_entry));
+	list->distinct_entries = 0;
+
 	/* Use cave_monster_max() here in case the monster list isn't compacted. */
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		struct monster *mon = cave_monster(cave, i);
 		monster_list_entry_t *entry = NULL;
-		int j, field;
+		int field;
 		bool los = false;
 
 		/* Only consider visible, known monsters */
@@ -157,19 +164,15 @@ void monster_list_collect(monster_list_t *list)
 			continue;
 
 		/* Find or add a list entry. */
-		for (j = 0; j < (int)list->entries_size; j++) {
-			if (list->entries[j].race == NULL) {
-				/* We found an empty slot, so add this race here. */
-				entry = &list->entries[j];
-				memset(entry, 0, sizeof(monster_list_entry_t));
-				entry->race = mon->race;
-				break;
-			}
-			else if (list->entries[j].race == mon->race) {
-				/* We found a matching race and we'll use that. */
-				entry = &list->entries[j];
-				break;
-			}
+		if (race_entry[mon->race->ridx]) {
+			/* We found a matching race and we'll use that. */
+			entry = &list->entries[race_entry[mon->race->ridx] - 1];
+		} else if (list->distinct_entries < list->entries_size) {
+			/* Add this race in the next empty slot. */
+			entry = &list->entries[list->distinct_entries++];
+			memset(entry, 0, sizeof(monster_list_entry_t));
+			entry->race = mon->race;
+			race_entry[mon->race->ridx] = list->distinct_entries;
 		}
 
 		if (entry == NULL)
@@ -200,11 +203,10 @@ void monster_list_collect(monster_list_t *list)
 		entry->dy[field] = mon->fy - player->py;
 	}
 
-	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++) {
-		if (list->entries[i].race == NULL)
-			continue;
+	mem_free(race_entry);
 
+	/* Collect totals for easier calculations of the list. */
+	for (i = 0; i < (int)list->distinct_entries; i++) {
 		if (list->entries[i].count[MONSTER_LIST_SECTION_LOS] > 0)
 			list->total_entries[MONSTER_LIST_SECTION_LOS]++;
 
@@ -215,7 +217,6 @@ void monster_list_collect(monster_list_t *list)
 			list->entries[i].count[MONSTER_LIST_SECTION_LOS];
 		list->total_monsters[MONSTER_LIST_SECTION_ESP] +=
 			list->entries[i].count[MONSTER_LIST_SECTION_ESP];
-		list->distinct_entries++;
 	}
 
 	list->creation_turn = turn;
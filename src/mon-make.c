@@ -19,9 +19,11 @@
 #include "angband.h"
 #include "alloc.h"
 #include "game-world.h"
+#include "generate.h"
 #include "init.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-predicate.h"
 #include "mon-timed.h"
 #include "mon-util.h"
@@ -38,6 +40,44 @@ s16b num_repro;
 static s16b alloc_race_size;
 static struct alloc_entry *alloc_race_table;
 
+/**
+ * The "prob3" pass of the allocation table, kept from one get_mon_num() call
+ * to the next.  It only needs working out again for a new level or player
+ * depth, after get_mon_num_prep(), at Christmas, or when one of the uniques
+ * it covers comes or goes.
+ */
+static struct {
+	bool valid;
+	int level;			/* Level the table was worked out for */
+	int depth;			/* Player depth, for FORCE_DEPTH monsters */
+	bool xmas;			/* Whether seasonal monsters were allowed */
+	int end;			/* Entries no deeper than level */
+	long *totals;		/* Running total of prob3 up to each entry */
+	int *uniques;		/* Entries for uniques, bar their cur_num */
+	bool *unique_ok;	/* Whether each of those was allowed */
+	int num_uniques;
+	bool *special;		/* Entries whose race is seasonal, FORCE_DEPTH or
+						 * unique, so the pass needs to look at it */
+} race_probs;
+
+/**
+ * Whether prob2 is currently a plain copy of prob1 throughout the allocation
+ * table, i.e. the last get_mon_num_prep() had no hook
+ */
+static bool race_allocs_unrestricted;
+
+/**
+ * Restrictions remembered by get_mon_num_prep_key(): which allocation table
+ * entries the hook accepted for that key
+ */
+#define MON_NUM_MEMO_MAX 64
+static struct {
+	bool (*hook)(struct monster_race *race);
+	int key;
+	bool *accept;
+} race_memo[MON_NUM_MEMO_MAX];
+static int race_memo_num;
+
 static void init_race_allocs(void) {
 	int i;
 	struct monster_race *race;
@@ -115,9 +155,31 @@ static void init_race_allocs(void) {
 	}
 	mem_free(aux);
 	mem_free(num);
+
+	race_allocs_unrestricted = true;
+	race_probs.valid = false;
+	race_probs.totals = mem_zalloc(alloc_race_size * sizeof(long));
+	race_probs.uniques = mem_zalloc(alloc_race_size * sizeof(int));
+	race_probs.unique_ok = mem_zalloc(alloc_race_size * sizeof(bool));
+	race_probs.special = mem_zalloc(alloc_race_size * sizeof(bool));
+	for (i = 0; i < alloc_race_size; i++) {
+		race = &r_info[table[i].index];
+		race_probs.special[i] = rf_has(race->flags, RF_SEASONAL) ||
+			rf_has(race->flags, RF_FORCE_DEPTH) ||
+			rf_has(race->flags, RF_UNIQUE);
+	}
 }
 
 static void cleanup_race_allocs(void) {
+	int i;
+
+	for (i = 0; i < race_memo_num; i++)
+		mem_free(race_memo[i].accept);
+	race_memo_num = 0;
+	mem_free(race_probs.totals);
+	mem_free(race_probs.uniques);
+	mem_free(race_probs.unique_ok);
+	mem_free(race_probs.special);
 	mem_free(alloc_race_table);
 }
 
@@ -152,7 +214,9 @@ void delete_monster_idx(int m_idx)
 		health_track(player->upkeep, NULL);
 
 	/* Monster is gone */
+	cave->fingerprint -= square_fingerprint_mon(cave, y, x);
 	cave->squares[y][x].mon = 0;
+	square_note_empty(cave, y, x);
 
 	/* Delete objects */
 	struct object *obj = mon->held_obj;
@@ -178,6 +242,10 @@ void delete_monster_idx(int m_idx)
 		object_delete(&mon->mimicked_obj);
 	}
 
+	/* Take the monster out of the schedule and its block */
+	unschedule_monster(cave, mon);
+	monster_block_remove(cave, mon);
+
 	/* Wipe the Monster */
 	memset(mon, 0, sizeof(struct monster));
 
@@ -276,6 +344,10 @@ void compact_monsters(int num_to_compact)
 	if (num_to_compact)
 		msg("Compacting monsters...");
 
+	/* Monsters are about to be renumbered */
+	unschedule_monsters(cave);
+	forget_monster_blocks(cave);
+
 
 	/* Compact at least 'num_to_compact' objects */
 	for (num_compacted = 0, iter = 1; num_compacted < num_to_compact; iter++) {
@@ -349,6 +421,10 @@ void wipe_mon_list(struct chunk *c, struct player *p)
 {
 	int m_idx;
 
+	/* Stop scheduling the monsters */
+	unschedule_monsters(c);
+	forget_monster_blocks(c);
+
 	/* Delete all the monsters */
 	for (m_idx = cave_monster_max(c) - 1; m_idx >= 1; m_idx--) {
 		struct monster *mon = cave_monster(c, m_idx);
@@ -373,7 +449,9 @@ void wipe_mon_list(struct chunk *c, struct player *p)
 		mon->race->cur_num--;
 
 		/* Monster is gone */
+		c->fingerprint -= square_fingerprint_mon(c, mon->fy, mon->fx);
 		c->squares[mon->fy][mon->fx].mon = 0;
+		square_note_empty(c, mon->fy, mon->fx);
 
 		/* Wipe the Monster */
 		memset(mon, 0, sizeof(struct monster));
@@ -419,17 +497,19 @@ s16b mon_pop(struct chunk *c)
 		return m_idx;
 	}
 
-	/* Recycle dead monsters if we've run out of room */
-	for (m_idx = 1; m_idx < cave_monster_max(c); m_idx++) {
-		struct monster *mon = cave_monster(c, m_idx);
+	/* Recycle dead monsters if we've run out of room, and there are any */
+	if (c->mon_cnt < cave_monster_max(c) - 1) {
+		for (m_idx = 1; m_idx < cave_monster_max(c); m_idx++) {
+			struct monster *mon = cave_monster(c, m_idx);
 
-		/* Skip live monsters */
-		if (!mon->race) {
-			/* Count monsters */
-			c->mon_cnt++;
+			/* Skip live monsters */
+			if (!mon->race) {
+				/* Count monsters */
+				c->mon_cnt++;
 
-			/* Use this monster */
-			return m_idx;
+				/* Use this monster */
+				return m_idx;
+			}
 		}
 	}
 
@@ -452,6 +532,11 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 {
 	int i;
 
+	/* Lifting the restriction again is the commonest call, and often a
+	 * repeat */
+	if (!get_mon_num_hook && race_allocs_unrestricted)
+		return;
+
 	/* Scan the allocation table */
 	for (i = 0; i < alloc_race_size; i++) {
 		alloc_entry *entry = &alloc_race_table[i];
@@ -464,6 +549,52 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 		else
 			entry->prob2 = 0;
 	}
+
+	race_allocs_unrestricted = !get_mon_num_hook;
+	race_probs.valid = false;
+}
+
+/**
+ * As get_mon_num_prep(), for a hook whose verdict on each race depends only
+ * on the race and on `key` (a summon type, a pit profile...).  The entries
+ * the hook accepts are remembered, so later calls with the same hook and key
+ * don't run it again.
+ */
+void get_mon_num_prep_key(bool (*get_mon_num_hook)(struct monster_race *race),
+						  int key)
+{
+	int i, m;
+
+	assert(get_mon_num_hook);
+
+	/* Look for a remembered restriction */
+	for (m = 0; m < race_memo_num; m++)
+		if ((race_memo[m].hook == get_mon_num_hook) && (race_memo[m].key == key))
+			break;
+
+	/* Not seen before; work it out, keeping it if there's room */
+	if (m == race_memo_num) {
+		if (race_memo_num == MON_NUM_MEMO_MAX) {
+			get_mon_num_prep(get_mon_num_hook);
+			return;
+		}
+		race_memo[m].hook = get_mon_num_hook;
+		race_memo[m].key = key;
+		race_memo[m].accept = mem_alloc(alloc_race_size * sizeof(bool));
+		for (i = 0; i < alloc_race_size; i++)
+			race_memo[m].accept[i] =
+				(*get_mon_num_hook)(&r_info[alloc_race_table[i].index]);
+		race_memo_num++;
+	}
+
+	/* Apply it */
+	for (i = 0; i < alloc_race_size; i++) {
+		alloc_entry *entry = &alloc_race_table[i];
+		entry->prob2 = race_memo[m].accept[i] ? entry->prob1 : 0;
+	}
+
+	race_allocs_unrestricted = false;
+	race_probs.valid = false;
 }
 
 /**
@@ -474,21 +605,107 @@ void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race))
 static struct monster_race *get_mon_race_aux(long total,
 											 const alloc_entry *table)
 {
-	int i;
+	int lo = 0, hi = race_probs.end - 1;
 
 	/* Pick a monster */
 	long value = randint0(total);
 
-	/* Find the monster */
+	/* Find the first entry whose running total passes the value */
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (value < race_probs.totals[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return &r_info[table[lo].index];
+}
+
+/**
+ * Check whether the kept "prob3" pass still holds for the given level.
+ */
+static bool get_mon_probs_valid(int level, bool xmas)
+{
+	int i;
+
+	if (!race_probs.valid) return false;
+	if (race_probs.level != level) return false;
+	if (race_probs.depth != player->depth) return false;
+	if (race_probs.xmas != xmas) return false;
+
+	/* Uniques come and go without telling anyone */
+	for (i = 0; i < race_probs.num_uniques; i++) {
+		struct monster_race *race =
+			&r_info[alloc_race_table[race_probs.uniques[i]].index];
+		if ((race->cur_num < race->max_num) != race_probs.unique_ok[i])
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Work out the "prob3" pass of the allocation table for the given level,
+ * and the running totals get_mon_race_aux() searches.
+ */
+static void get_mon_probs(int level, bool xmas)
+{
+	int i;
+	long total = 0L;
+	alloc_entry *table = alloc_race_table;
+
+	race_probs.num_uniques = 0;
+
+	/* Process probabilities */
 	for (i = 0; i < alloc_race_size; i++) {
-		/* Found the entry */
-		if (value < table[i].prob3) break;
+		struct monster_race *race;
+
+		/* Monsters are sorted by depth */
+		if (table[i].level > level) break;
+
+		/* Default */
+		table[i].prob3 = 0;
+		race_probs.totals[i] = total;
 
-		/* Decrement */
-		value -= table[i].prob3;
+		/* No town monsters in dungeon */
+		if ((level > 0) && (table[i].level <= 0)) continue;
+
+		/* Most races have nothing more to check */
+		if (race_probs.special[i]) {
+			/* Get the chosen monster */
+			race = &r_info[table[i].index];
+
+			/* No seasonal monsters outside of Christmas */
+			if (rf_has(race->flags, RF_SEASONAL) && !xmas)
+				continue;
+
+			/* Some monsters never appear out of depth */
+			if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > player->depth)
+				continue;
+
+			/* Only one copy of a a unique must be around at the same time */
+			if (rf_has(race->flags, RF_UNIQUE)) {
+				bool ok = race->cur_num < race->max_num;
+				race_probs.uniques[race_probs.num_uniques] = i;
+				race_probs.unique_ok[race_probs.num_uniques++] = ok;
+				if (!ok) continue;
+			}
+		}
+
+		/* Accept */
+		table[i].prob3 = table[i].prob2;
+
+		/* Total */
+		total += table[i].prob3;
+		race_probs.totals[i] = total;
 	}
 
-	return &r_info[table[i].index];
+	race_probs.end = i;
+	race_probs.level = level;
+	race_probs.depth = player->depth;
+	race_probs.xmas = xmas;
+	race_probs.valid = true;
 }
 
 /**
@@ -515,7 +732,7 @@ static struct monster_race *get_mon_race_aux(long total,
  */
 struct monster_race *get_mon_num(int level)
 {
-	int i, p;
+	int p;
 
 	long total;
 
@@ -523,49 +740,19 @@ struct monster_race *get_mon_num(int level)
 
 	alloc_entry *table = alloc_race_table;
 
+	time_t cur_time = time(NULL);
+	struct tm *date = localtime(&cur_time);
+	bool xmas = date->tm_mon == 11 && date->tm_mday >= 24 &&
+		date->tm_mday <= 26;
+
 	/* Occasionally produce a nastier monster in the dungeon */
 	if (level > 0 && one_in_(z_info->ood_monster_chance))
 		level += MIN(level / 4 + 2, z_info->ood_monster_amount);
 
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++) {
-		time_t cur_time = time(NULL);
-		struct tm *date = localtime(&cur_time);
-
-		/* Monsters are sorted by depth */
-		if (table[i].level > level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* No town monsters in dungeon */
-		if ((level > 0) && (table[i].level <= 0)) continue;
-
-		/* Get the chosen monster */
-		race = &r_info[table[i].index];
-
-		/* No seasonal monsters outside of Christmas */
-		if (rf_has(race->flags, RF_SEASONAL) &&
-			!(date->tm_mon == 11 && date->tm_mday >= 24 && date->tm_mday <= 26))
-			continue;
-
-		/* Only one copy of a a unique must be around at the same time */
-		if (rf_has(race->flags, RF_UNIQUE) &&
-				race->cur_num >= race->max_num)
-			continue;
-
-		/* Some monsters never appear out of depth */
-		if (rf_has(race->flags, RF_FORCE_DEPTH) && race->level > player->depth)
-			continue;
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
-
-		/* Total */
-		total += table[i].prob3;
-	}
+	/* Process probabilities, unless they are the same as last time */
+	if (!get_mon_probs_valid(level, xmas))
+		get_mon_probs(level, xmas);
+	total = race_probs.end ? race_probs.totals[race_probs.end - 1] : 0L;
 
 	/* No legal monsters */
 	if (total <= 0) return NULL;
@@ -688,7 +875,7 @@ static bool mon_create_drop(struct chunk *c, struct monster *mon, byte origin)
 			}
 
 			/* Allocate by hand, prep, apply magic */
-			obj = mem_zalloc(sizeof(*obj));
+			obj = object_new();
 			object_prep(obj, kind, 100, RANDOMISE);
 			obj->artifact = art;
 			copy_artifact_data(obj, obj->artifact);
@@ -705,8 +892,7 @@ static bool mon_create_drop(struct chunk *c, struct monster *mon, byte origin)
 				any = true;
 			} else {
 				obj->artifact->created = false;
-				object_wipe(obj);
-				mem_free(obj);
+				object_free(obj);
 			}
 		}
 	}
@@ -717,7 +903,7 @@ static bool mon_create_drop(struct chunk *c, struct monster *mon, byte origin)
 			continue;
 
 		/* Allocate by hand, prep, apply magic */
-		obj = mem_zalloc(sizeof(*obj));
+		obj = object_new();
 		object_prep(obj, drop->kind, level, RANDOMISE);
 		apply_magic(obj, level, true, good, great, extra_roll);
 
@@ -731,8 +917,7 @@ static bool mon_create_drop(struct chunk *c, struct monster *mon, byte origin)
 		if (monster_carry(c, mon, obj)) {
 			any = true;
 		} else {
-			object_wipe(obj);
-			mem_free(obj);
+			object_free(obj);
 		}
 	}
 
@@ -755,8 +940,7 @@ static bool mon_create_drop(struct chunk *c, struct monster *mon, byte origin)
 			any = true;
 		} else {
 			obj->artifact->created = false;
-			object_wipe(obj);
-			mem_free(obj);
+			object_free(obj);
 		}
 	}
 
@@ -801,10 +985,15 @@ s16b place_monster(struct chunk *c, int y, int x, struct monster *mon,
 
 	/* Set the location */
 	c->squares[y][x].mon = new_mon->midx;
+	c->fingerprint += square_fingerprint_mon(c, y, x);
 	new_mon->fy = y;
 	new_mon->fx = x;
 	assert(square_monster(c, y, x) == new_mon);
 
+	/* Give the monster its turns, and file it by location */
+	schedule_monster(c, new_mon);
+	monster_block_add(c, new_mon);
+
 	update_mon(new_mon, c, true);
 
 	/* Hack -- Count the number of "reproducers" */
@@ -1314,14 +1503,24 @@ bool pick_and_place_distant_monster(struct chunk *c, struct player *p, int dis,
 {
 	int y = 0, x = 0;
 	int	attempts_left = 10000;
+	bool placed;
 
 	assert(c);
 
+	GEN_STAGE_ENTER(GEN_STAGE_MONSTERS);
+
 	/* Find a legal, distant, unoccupied, space */
 	while (--attempts_left) {
-		/* Pick a location */
-		y = randint0(c->height);
-		x = randint0(c->width);
+		/* Pick a location, from the empty grids if generation lists them */
+		if (c->empty_grids) {
+			if (!find_empty(c, &y, &x)) {
+				attempts_left = 0;
+				break;
+			}
+		} else {
+			y = randint0(c->height);
+			x = randint0(c->width);
+		}
 
 		/* Require "naked" floor grid */
 		if (!square_isempty(c, y, x)) continue;
@@ -1338,15 +1537,15 @@ bool pick_and_place_distant_monster(struct chunk *c, struct player *p, int dis,
 		if (OPT(p, cheat_xtra) || OPT(p, cheat_hear))
 			msg("Warning! Could not allocate a new monster.");
 
+		GEN_STAGE_LEAVE(GEN_STAGE_MONSTERS);
 		return false;
 	}
 
 	/* Attempt to place the monster, allow groups */
-	if (pick_and_place_monster(c, y, x, depth, sleep, true, ORIGIN_DROP))
-		return (true);
+	placed = pick_and_place_monster(c, y, x, depth, sleep, true, ORIGIN_DROP);
 
-	/* Nope */
-	return (false);
+	GEN_STAGE_LEAVE(GEN_STAGE_MONSTERS);
+	return placed;
 }
 
 struct init_module mon_make_module = {
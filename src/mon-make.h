@@ -27,6 +27,8 @@ void compact_monsters(int num_to_compact);
 void wipe_mon_list(struct chunk *c, struct player *p);
 s16b mon_pop(struct chunk *c);
 void get_mon_num_prep(bool (*get_mon_num_hook)(struct monster_race *race));
+void get_mon_num_prep_key(bool (*get_mon_num_hook)(struct monster_race *race),
+						  int key);
 struct monster_race *get_mon_num(int level);
 int mon_create_drop_count(const struct monster_race *race, bool maximize);
 s16b place_monster(struct chunk *c, int y, int x, struct monster *mon,
@@ -31,6 +31,7 @@
 #include "mon-desc.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
 #include "mon-util.h"
@@ -43,10 +44,16 @@
 #include "obj-util.h"
 #include "player-calcs.h"
 #include "player-util.h"
+#include "profile.h"
 #include "project.h"
 #include "trap.h"
 
 
+/**
+ * How many times a monster has been given its turn
+ */
+u32b monsters_processed;
+
 /**
  * ------------------------------------------------------------------------
  * Routines to enable decisions on monster behaviour
@@ -98,10 +105,10 @@ static bool monster_can_hear(struct chunk *c, struct monster *mon)
  */
 static bool monster_can_smell(struct chunk *c, struct monster *mon)
 {
-	if (c->scent.grids[mon->fy][mon->fx] == 0) {
+	if (square_scent(c, mon->fy, mon->fx) == 0) {
 		return false;
 	}
-	return mon->race->smell > c->scent.grids[mon->fy][mon->fx];
+	return mon->race->smell > square_scent(c, mon->fy, mon->fx);
 }
 
 /**
@@ -273,8 +280,8 @@ static void get_move_find_range(struct monster *mon)
  * Note that ghosts and rock-eaters generally just head straight for the player.
  *
  * Monsters first try to use current sound information as saved in
- * c->noise.grids[y][x].  Failing that, they'll try using scent, saved in 
- * c->scent.grids[y][x].
+ * c->noise.grids[y][x].  Failing that, they'll try using scent, read with
+ * square_scent().
  *
  * Note that this function assumes the monster is moving to an adjacent grid,
  * and so the noise can be louder by at most 1.
@@ -360,8 +367,8 @@ static bool get_move_advance(struct chunk *c, struct monster *mon)
 			int smelled_scent;
 
 			/* If no good sound yet, use scent */
-			smelled_scent = mon->race->smell - c->scent.grids[y][x];
-			if ((smelled_scent > best_scent) && (c->scent.grids[y][x] != 0)) {
+			smelled_scent = mon->race->smell - square_scent(c, y, x);
+			if ((smelled_scent > best_scent) && (square_scent(c, y, x) != 0)) {
 				best_scent = smelled_scent;
 				best_direction = i;
 				found_direction = true;
@@ -511,14 +518,16 @@ static bool get_move_find_hiding(struct chunk *c, struct monster *mon)
 			/* Skip occupied locations */
 			if (!square_isempty(c, y, x)) continue;
 
-			/* Check for hidden, available grid */
-			if (!square_isview(c, y, x) &&
-				projectable(c, fy, fx, y, x, PROJECT_STOP)) {
+			/* Check for hidden grid */
+			if (!square_isview(c, y, x)) {
 				/* Calculate distance from player */
 				dis = distance(y, x, py, px);
 
-				/* Remember if closer than previous */
-				if (dis < gdis && dis >= min) {
+				/* Ignore grids no closer than the previous one */
+				if (dis >= gdis || dis < min) continue;
+
+				/* Remember if available */
+				if (projectable(c, fy, fx, y, x, PROJECT_STOP)) {
 					gy = y;
 					gx = x;
 					gdis = dis;
@@ -1332,29 +1341,40 @@ static void monster_turn(struct chunk *c, struct monster *mon)
  * gets a turn, and/or to decide whether it gets a turn
  * ------------------------------------------------------------------------ */
 /**
- * Determine whether a monster is active or passive
+ * Determine whether a monster should be active or passive
  */
-static bool monster_check_active(struct chunk *c, struct monster *mon)
+static bool monster_wants_active(struct chunk *c, struct monster *mon)
 {
 	if ((mon->cdis <= mon->race->hearing) && monster_passes_walls(mon)) {
 		/* Character is inside scanning range, monster can go straight there */
-		mflag_on(mon->mflag, MFLAG_ACTIVE);
+		return true;
 	} else if (mon->hp < mon->maxhp) {
 		/* Monster is hurt */
-		mflag_on(mon->mflag, MFLAG_ACTIVE);
+		return true;
 	} else if (square_isview(c, mon->fy, mon->fx)) {
 		/* Monster can "see" the player (checked backwards) */
-		mflag_on(mon->mflag, MFLAG_ACTIVE);
+		return true;
 	} else if (monster_can_hear(c, mon)) {
 		/* Monster can hear the player */
-		mflag_on(mon->mflag, MFLAG_ACTIVE);
+		return true;
 	} else if (monster_can_smell(c, mon)) {
 		/* Monster can smell the player */
+		return true;
+	}
+
+	/* Otherwise go passive */
+	return false;
+}
+
+/**
+ * Determine whether a monster is active or passive
+ */
+static bool monster_check_active(struct chunk *c, struct monster *mon)
+{
+	if (monster_wants_active(c, mon))
 		mflag_on(mon->mflag, MFLAG_ACTIVE);
-	} else {
-		/* Otherwise go passive */
+	else
 		mflag_off(mon->mflag, MFLAG_ACTIVE);
-	}
 
 	return mflag_has(mon->mflag, MFLAG_ACTIVE) ? true : false;
 }
@@ -1495,16 +1515,382 @@ static void regen_monster(struct monster *mon)
 }
 
 
+/**
+ * ------------------------------------------------------------------------
+ * Monster scheduling
+ * ------------------------------------------------------------------------ */
+/**
+ * Most game turns only a few monsters have enough energy to move, so rather
+ * than visit every monster every turn, process_monsters() keeps monsters in
+ * a wheel of lists indexed by the game turn they will next be able to move,
+ * and only visits those due this turn.  The energy a waiting monster would
+ * have gained is added when it comes due, or when its speed or energy is
+ * about to change, so monsters move in exactly the order they did when all
+ * were visited.
+ *
+ * A monster which finds itself passive does nothing with its moves until
+ * one of the things monster_wants_active() looks at changes, so it is taken
+ * out of the wheel altogether.  The code which changes those things calls
+ * rouse_monster() or rouse_monster_at() to put it back; its energy is then
+ * worked out as if it had spent a move every time it had enough.
+ *
+ * Regeneration turns, and anything which renumbers monsters, fall back to
+ * visiting every monster; reset_monsters() rebuilds the wheel afterwards.
+ */
+#define MON_WHEEL_SIZE	256
+
+enum {
+	MON_SCHED_NONE = 0,	/* Not in the schedule, or being processed */
+	MON_SCHED_WHEEL,	/* Waiting in the wheel */
+	MON_SCHED_DUE,		/* In the list of monsters due this turn */
+	MON_SCHED_DORMANT	/* Passive, and out of the wheel until roused */
+};
+
+/**
+ * Calculate a monster's net speed
+ */
+static int monster_net_speed(const struct monster *mon)
+{
+	int mspeed = mon->mspeed;
+	if (mon->m_timed[MON_TMD_FAST])
+		mspeed += 10;
+	if (mon->m_timed[MON_TMD_SLOW])
+		mspeed -= 2;
+	return mspeed;
+}
+
+/**
+ * Put a monster in the wheel, working out when it can next move from its
+ * energy as of the start of game turn mon->energy_turn
+ */
+static void monster_sched_link(struct chunk *c, struct monster *mon)
+{
+	int need = z_info->move_energy - mon->energy;
+	s16b *head;
+
+	mon->next_turn = mon->energy_turn;
+	if (need > 0) {
+		int gain = turn_energy(monster_net_speed(mon));
+		mon->next_turn += (need + gain - 1) / gain;
+	}
+
+	/* Monsters due this turn after it was gathered join the due list */
+	if (mon->next_turn <= turn && c->mon_due_turn == turn) {
+		int n = c->mon_due_num++;
+		while (n > 0 && c->mon_due[n - 1] < mon->midx) {
+			c->mon_due[n] = c->mon_due[n - 1];
+			n--;
+		}
+		c->mon_due[n] = mon->midx;
+		mon->sched = MON_SCHED_DUE;
+		return;
+	}
+
+	head = &c->mon_wheel[mon->next_turn % MON_WHEEL_SIZE];
+	mon->sched_prev = 0;
+	mon->sched_next = *head;
+	if (*head)
+		cave_monster(c, *head)->sched_prev = mon->midx;
+	*head = mon->midx;
+	mon->sched = MON_SCHED_WHEEL;
+}
+
+/**
+ * Take a monster out of the wheel
+ */
+static void monster_sched_unlink(struct chunk *c, struct monster *mon)
+{
+	if (mon->sched_prev)
+		cave_monster(c, mon->sched_prev)->sched_next = mon->sched_next;
+	else
+		c->mon_wheel[mon->next_turn % MON_WHEEL_SIZE] = mon->sched_next;
+	if (mon->sched_next)
+		cave_monster(c, mon->sched_next)->sched_prev = mon->sched_prev;
+	mon->sched_prev = mon->sched_next = 0;
+	mon->sched = MON_SCHED_NONE;
+}
+
+/**
+ * Whether the passes over the monsters so far this game turn would already
+ * have visited this monster, given its energy at the start of the turn
+ */
+static bool monster_sched_passed(struct chunk *c, const struct monster *mon)
+{
+	if (c->mon_due_turn != turn) return false;
+	if (mon->energy >= c->mon_done_min) return true;
+	return mon->midx > c->mon_scan && mon->energy >= c->mon_scan_min;
+}
+
+/**
+ * Give a monster out of the wheel its energy for the game turns before
+ * `upto`, spending a move whenever it had enough.  A monster still waiting
+ * in the wheel never had enough, so nothing is spent.
+ */
+static void monster_idle_energy(struct monster *mon, s32b upto)
+{
+	int turns = upto - mon->energy_turn;
+	int gain, moves;
+
+	if (turns <= 0) return;
+
+	gain = turn_energy(monster_net_speed(mon));
+	moves = (mon->energy + gain * (turns - 1)) / z_info->move_energy;
+	mon->energy += gain * turns - moves * z_info->move_energy;
+	mon->energy_turn = upto;
+}
+
+/**
+ * Add the energy a waiting or dormant monster has gained so far
+ */
+void settle_monster_energy(struct chunk *c, struct monster *mon)
+{
+	if (!c->mon_scheduled) return;
+	if (mon->sched != MON_SCHED_WHEEL && mon->sched != MON_SCHED_DORMANT)
+		return;
+
+	monster_idle_energy(mon, turn);
+	if (mon->energy_turn == turn && monster_sched_passed(c, mon))
+		monster_idle_energy(mon, turn + 1);
+}
+
+/**
+ * Add a newly placed monster to the schedule
+ */
+void schedule_monster(struct chunk *c, struct monster *mon)
+{
+	if (!c->mon_scheduled) return;
+
+	mon->energy_turn = monster_sched_passed(c, mon) ? turn + 1 : turn;
+	monster_sched_link(c, mon);
+}
+
+/**
+ * Put a dormant monster back in the wheel
+ */
+void rouse_monster(struct chunk *c, struct monster *mon)
+{
+	if (!c->mon_scheduled || mon->sched != MON_SCHED_DORMANT) return;
+
+	settle_monster_energy(c, mon);
+	c->mon_dormant--;
+	monster_sched_link(c, mon);
+}
+
+/**
+ * Rouse any dormant monster at a grid which would now be active
+ */
+void rouse_monster_at(struct chunk *c, int y, int x)
+{
+	struct monster *mon;
+
+	if (!c->mon_dormant || c->squares[y][x].mon <= 0) return;
+
+	mon = square_monster(c, y, x);
+	if (mon->sched == MON_SCHED_DORMANT && monster_wants_active(c, mon))
+		rouse_monster(c, mon);
+}
+
+/**
+ * Move a monster in the schedule after its energy or speed has changed; any
+ * energy gained at the old speed must already have been settled
+ */
+void reschedule_monster(struct chunk *c, struct monster *mon)
+{
+	if (!c->mon_scheduled) return;
+
+	if (mon->sched == MON_SCHED_DORMANT) {
+		rouse_monster(c, mon);
+	} else if (mon->sched == MON_SCHED_WHEEL) {
+		settle_monster_energy(c, mon);
+		monster_sched_unlink(c, mon);
+		monster_sched_link(c, mon);
+	}
+}
+
+/**
+ * Remove a monster which is about to be deleted from the schedule
+ */
+void unschedule_monster(struct chunk *c, struct monster *mon)
+{
+	if (c->mon_scheduled && mon->sched == MON_SCHED_WHEEL)
+		monster_sched_unlink(c, mon);
+	if (c->mon_scheduled && mon->sched == MON_SCHED_DORMANT)
+		c->mon_dormant--;
+	mon->sched = MON_SCHED_NONE;
+}
+
+/**
+ * Bring every monster's energy up to date and go back to visiting every
+ * monster each game turn.  Monsters which have had this turn's energy are
+ * marked as handled, just as a full pass would have left them.
+ */
+void unschedule_monsters(struct chunk *c)
+{
+	int i;
+
+	if (!c->mon_scheduled) return;
+
+	for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+		struct monster *mon = cave_monster(c, i);
+		if (!mon->race) continue;
+
+		settle_monster_energy(c, mon);
+		if ((mon->sched == MON_SCHED_WHEEL ||
+			 mon->sched == MON_SCHED_DORMANT) && mon->energy_turn > turn)
+			mflag_on(mon->mflag, MFLAG_HANDLED);
+		mon->sched = MON_SCHED_NONE;
+		mon->sched_prev = mon->sched_next = 0;
+	}
+
+	c->mon_scheduled = false;
+	c->mon_due_num = 0;
+	c->mon_dormant = 0;
+}
+
+/**
+ * Put every monster in the wheel at the end of a full game turn
+ */
+static void schedule_monsters(struct chunk *c)
+{
+	int i;
+
+	if (!c->mon_wheel) {
+		c->mon_wheel = chunk_alloc(c, MON_WHEEL_SIZE * sizeof(s16b));
+		c->mon_due = chunk_alloc(c, z_info->level_monster_max * sizeof(s16b));
+	} else {
+		memset(c->mon_wheel, 0, MON_WHEEL_SIZE * sizeof(s16b));
+	}
+
+	/* This turn is over for every monster, visited or not */
+	c->mon_scheduled = true;
+	c->mon_due_num = 0;
+	c->mon_dormant = 0;
+	c->mon_due_turn = turn;
+	c->mon_done_min = 0;
+	c->mon_scan = z_info->level_monster_max;
+
+	for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+		struct monster *mon = cave_monster(c, i);
+		if (!mon->race) continue;
+
+		mon->energy_turn = turn + 1;
+		monster_sched_link(c, mon);
+	}
+}
+
+static int cmp_due_monster(const void *a, const void *b)
+{
+	return *(const s16b *)b - *(const s16b *)a;
+}
+
+/**
+ * Gather the monsters which can move this game turn, highest index first
+ */
+static void gather_due_monsters(struct chunk *c)
+{
+	s16b i = c->mon_wheel[turn % MON_WHEEL_SIZE];
+
+	c->mon_due_turn = turn;
+	c->mon_due_num = 0;
+	c->mon_done_min = UCHAR_MAX + 1;
+	c->mon_scan = z_info->level_monster_max;
+
+	while (i) {
+		struct monster *mon = cave_monster(c, i);
+		i = mon->sched_next;
+
+		if (mon->next_turn > turn) continue;
+
+		settle_monster_energy(c, mon);
+		monster_sched_unlink(c, mon);
+		mon->sched = MON_SCHED_DUE;
+		c->mon_due[c->mon_due_num++] = mon->midx;
+	}
+
+	sort(c->mon_due, c->mon_due_num, sizeof(c->mon_due[0]), cmp_due_monster);
+}
+
+/**
+ * Whether any grid of the chunk can burn monsters
+ */
+static bool chunk_has_fiery_grids(struct chunk *c)
+{
+	int i;
+
+	for (i = 0; i < z_info->f_max; i++)
+		if (c->feat_count[i] && feat_has_cap(i, FCAP_FIERY))
+			return true;
+
+	return false;
+}
+
+
 /**
  * ------------------------------------------------------------------------
  * Monster processing routines to be called by the main game loop
  * ------------------------------------------------------------------------ */
+/**
+ * Give a monster its energy for this game turn, and its move if it has
+ * enough energy.
+ *
+ * Returns true if the monster spent its move doing nothing because it is
+ * passive.
+ */
+static bool process_monster(struct chunk *c, struct monster *mon, bool regen)
+{
+	/* Does this monster have enough energy to move? */
+	bool moving = mon->energy >= z_info->move_energy ? true : false;
+
+	/* Prevent reprocessing */
+	mflag_on(mon->mflag, MFLAG_HANDLED);
+	monsters_processed++;
+
+	/* Handle monster regeneration if requested */
+	if (regen)
+		regen_monster(mon);
+
+	/* Give this monster some energy */
+	mon->energy += turn_energy(monster_net_speed(mon));
+	mon->energy_turn = turn + 1;
+
+	/* End the turn of monsters without enough energy to move */
+	if (!moving)
+		return false;
+
+	/* Use up "some" energy */
+	mon->energy -= z_info->move_energy;
+
+	/* Mimics lie in wait */
+	if (monster_is_mimicking(mon)) return false;
+
+	/* Check if the monster is active */
+	if (monster_check_active(c, mon)) {
+		/* Process timed effects - skip turn if necessary */
+		if (process_monster_timed(c, mon))
+			return false;
+
+		/* Set this monster to be the current actor */
+		c->mon_current = mon->midx;
+
+		/* The monster takes its turn */
+		monster_turn(c, mon);
+
+		/* Monster is no longer current */
+		c->mon_current = -1;
+		return false;
+	}
+
+	return true;
+}
+
 /**
  * Process all the "live" monsters, once per game turn.
  *
  * During each game turn, we scan through the list of all the "live" monsters,
  * (backwards, so we can excise any "freshly dead" monsters), energizing each
  * monster, and allowing fully energized monsters to move, attack, pass, etc.
+ * When the monsters are scheduled, only those due to move are visited, in
+ * the same order.
  *
  * This function and its children are responsible for a considerable fraction
  * of the processor time in normal situations, greater if the character is
@@ -1512,85 +1898,114 @@ static void regen_monster(struct monster *mon)
  */
 void process_monsters(struct chunk *c, int minimum_energy)
 {
-	int i;
-	int mspeed;
+	int i, n;
 
 	/* Only process some things every so often */
 	bool regen = false;
 
+	/* Monsters think with their own stream */
+	int rng = Rand_stream(RNG_MONSTERS);
+
+	PROFILE_ENTER(PROF_MONSTERS);
+
 	/* Regenerate hitpoints and mana every 100 game turns */
 	if (turn % 100 == 0)
 		regen = true;
 
-	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(c) - 1; i >= 1; i--) {
-		struct monster *mon;
-		bool moving;
+	/* Regeneration, and passes which only some waiting monsters would get,
+	 * need every monster */
+	if (regen || (minimum_energy && minimum_energy <= z_info->move_energy))
+		unschedule_monsters(c);
 
-		/* Handle "leaving" */
-		if (player->is_dead || player->upkeep->generate_level) break;
+	/* Dormant monsters may hear differently now */
+	if (c->mon_dormant &&
+		player->state.skills[SKILL_STEALTH] != c->mon_dormant_stealth) {
+		for (i = cave_monster_max(c) - 1; i >= 1; i--)
+			rouse_monster(c, cave_monster(c, i));
+	}
 
-		/* Get a 'live' monster */
-		mon = cave_monster(c, i);
-		if (!mon->race) continue;
+	if (!c->mon_scheduled) {
+		/* Process the monsters (backwards) */
+		for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+			struct monster *mon;
 
-		/* Ignore monsters that have already been handled */
-		if (mflag_has(mon->mflag, MFLAG_HANDLED))
-			continue;
+			/* Handle "leaving" */
+			if (player->is_dead || player->upkeep->generate_level) break;
 
-		/* Not enough energy to move yet */
-		if (mon->energy < minimum_energy) continue;
+			/* Get a 'live' monster */
+			mon = cave_monster(c, i);
+			if (!mon->race) continue;
 
-		/* Does this monster have enough energy to move? */
-		moving = mon->energy >= z_info->move_energy ? true : false;
+			/* Ignore monsters that have already been handled */
+			if (mflag_has(mon->mflag, MFLAG_HANDLED))
+				continue;
 
-		/* Prevent reprocessing */
-		mflag_on(mon->mflag, MFLAG_HANDLED);
+			/* Not enough energy to move yet */
+			if (mon->energy < minimum_energy) continue;
 
-		/* Handle monster regeneration if requested */
-		if (regen)
-			regen_monster(mon);
+			process_monster(c, mon, regen);
+		}
+	} else {
+		if (c->mon_due_turn != turn)
+			gather_due_monsters(c);
 
-		/* Calculate the net speed */
-		mspeed = mon->mspeed;
-		if (mon->m_timed[MON_TMD_FAST])
-			mspeed += 10;
-		if (mon->m_timed[MON_TMD_SLOW])
-			mspeed -= 2;
+		/* Start a pass */
+		c->mon_scan = z_info->level_monster_max;
+		c->mon_scan_min = minimum_energy;
 
-		/* Give this monster some energy */
-		mon->energy += turn_energy(mspeed);
+		/* Process the monsters due to move (backwards) */
+		for (n = 0; n < c->mon_due_num; n++) {
+			struct monster *mon;
+			bool idle;
 
-		/* End the turn of monsters without enough energy to move */
-		if (!moving)
-			continue;
+			/* Handle "leaving", settling those we have passed */
+			if (player->is_dead || player->upkeep->generate_level) {
+				unschedule_monsters(c);
+				break;
+			}
 
-		/* Use up "some" energy */
-		mon->energy -= z_info->move_energy;
+			/* Waiting monsters above this one have now been visited */
+			i = c->mon_due[n];
+			c->mon_scan = i;
 
-		/* Mimics lie in wait */
-		if (monster_is_mimicking(mon)) continue;
+			/* Get a 'live' monster which is still due */
+			mon = cave_monster(c, i);
+			if (!mon->race || mon->sched != MON_SCHED_DUE) continue;
 
-		/* Check if the monster is active */
-		if (monster_check_active(c, mon)) {
-			/* Process timed effects - skip turn if necessary */
-			if (process_monster_timed(c, mon))
-				continue;
+			/* Not enough energy to move yet */
+			if (mon->energy < minimum_energy) continue;
 
-			/* Set this monster to be the current actor */
-			c->mon_current = i;
+			mon->sched = MON_SCHED_NONE;
+			idle = process_monster(c, mon, regen);
 
-			/* The monster takes its turn */
-			monster_turn(c, mon);
+			/* Back into the wheel, unless dead or replaced */
+			if (!c->mon_scheduled || !mon->race ||
+				mon->sched != MON_SCHED_NONE)
+				continue;
+			if (idle) {
+				if (!c->mon_dormant)
+					c->mon_dormant_stealth =
+						player->state.skills[SKILL_STEALTH];
+				mon->sched = MON_SCHED_DORMANT;
+				c->mon_dormant++;
+			} else {
+				monster_sched_link(c, mon);
+			}
+		}
 
-			/* Monster is no longer current */
-			c->mon_current = -1;
+		/* The pass is complete */
+		if (c->mon_scheduled) {
+			c->mon_done_min = MIN(c->mon_done_min, minimum_energy);
+			c->mon_scan = z_info->level_monster_max;
 		}
 	}
 
 	/* Update monster visibility after this */
 	/* XXX This may not be necessary */
 	player->upkeep->update |= PU_MONSTERS;
+
+	PROFILE_LEAVE(PROF_MONSTERS);
+	Rand_stream(rng);
 }
 
 /**
@@ -1600,18 +2015,37 @@ void process_monsters(struct chunk *c, int minimum_energy)
  */
 void reset_monsters(void)
 {
-	int i;
+	int i, n;
 	struct monster *mon;
 
-	/* Process the monsters (backwards) */
-	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
-		/* Access the monster */
-		mon = cave_monster(cave, i);
+	if (!cave->mon_scheduled) {
+		/* Process the monsters (backwards) */
+		for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
+			/* Access the monster */
+			mon = cave_monster(cave, i);
+
+			/* Dungeon hurts monsters */
+			monster_take_terrain_damage(mon);
+		}
+
+		/* Schedule the monsters for the next turn, unless leaving */
+		if (!player->is_dead && !player->upkeep->generate_level)
+			schedule_monsters(cave);
+
+		for (i = cave_monster_max(cave) - 1; i >= 1; i--)
+			mflag_off(cave_monster(cave, i)->mflag, MFLAG_HANDLED);
+		return;
+	}
 
-		/* Dungeon hurts monsters */
-		monster_take_terrain_damage(mon);
+	/* Dungeon hurts monsters */
+	if (chunk_has_fiery_grids(cave))
+		for (i = cave_monster_max(cave) - 1; i >= 1; i--)
+			monster_take_terrain_damage(cave_monster(cave, i));
 
-		/* Monster is ready to go again */
+	/* Only monsters which were due can have been handled */
+	for (n = 0; n < cave->mon_due_num; n++) {
+		mon = cave_monster(cave, cave->mon_due[n]);
 		mflag_off(mon->mflag, MFLAG_HANDLED);
 	}
+	cave->mon_due_num = 0;
 }
@@ -18,8 +18,17 @@
 #ifndef MONSTER_MOVE_H
 #define MONSTER_MOVE_H
 
+/* How many times a monster has been processed in all, for the metrics */
+extern u32b monsters_processed;
 
 bool multiply_monster(struct chunk *c, const struct monster *mon);
+void settle_monster_energy(struct chunk *c, struct monster *mon);
+void schedule_monster(struct chunk *c, struct monster *mon);
+void reschedule_monster(struct chunk *c, struct monster *mon);
+void rouse_monster(struct chunk *c, struct monster *mon);
+void rouse_monster_at(struct chunk *c, int y, int x);
+void unschedule_monster(struct chunk *c, struct monster *mon);
+void unschedule_monsters(struct chunk *c);
 void process_monsters(struct chunk *c, int minimum_energy);
 void reset_monsters(void);
 
@@ -60,6 +60,23 @@ static int size_mon_msg = 0;
 static struct monster_race_message mon_msg[MAX_STORED_MON_MSG];
 static struct monster_message_history mon_message_hist[MAX_STORED_MON_CODES];
 
+/**
+ * Hash tables finding entries of the two arrays above by their keys, so that
+ * a big area effect doesn't search the arrays once for every monster it hits.
+ * Slots from before the last show_monster_messages() have an old generation
+ * and count as empty.
+ */
+#define MON_MSG_HASH_SIZE		1024
+
+struct mon_msg_slot {
+	u32b gen;
+	int index;
+};
+
+static u32b mon_msg_gen = 1;
+static struct mon_msg_slot mon_msg_hash[MON_MSG_HASH_SIZE];
+static struct mon_msg_slot mon_hist_hash[MON_MSG_HASH_SIZE];
+
 /**
  * An array of monster messages in order of monster message type.
  *
@@ -112,6 +129,20 @@ void message_pain(struct monster *mon, int dam)
 	add_monster_message(mon, msg_code, false);
 }
 
+/**
+ * Work out the first hash slot for a pointer and two values
+ */
+static int mon_msg_bucket(const void *ptr, int a, int b)
+{
+	u32b h = (u32b)((uintptr_t)ptr >> 3);
+
+	h = (h * 31 + a) * 31 + b;
+	h ^= h >> 15;
+	h *= 0x2c1b3c6dU;
+	h ^= h >> 12;
+	return h & (MON_MSG_HASH_SIZE - 1);
+}
+
 /**
  * Tracks which monster has had which pain message stored, so redundant
  * messages don't happen due to monster attacks hitting other monsters.
@@ -123,7 +154,12 @@ static bool redundant_monster_message(struct monster *mon, int msg_code)
 	assert(msg_code >= 0);
 	assert(msg_code < MON_MSG_MAX);
 
-	for (int i = 0; i < size_mon_hist; i++) {
+	int b = mon_msg_bucket(mon, msg_code, 0);
+
+	for (; mon_hist_hash[b].gen == mon_msg_gen;
+		 b = (b + 1) & (MON_MSG_HASH_SIZE - 1)) {
+		int i = mon_hist_hash[b].index;
+
 		/* Check for a matched monster & monster code */
 		if (mon == mon_message_hist[i].mon &&
 				msg_code == mon_message_hist[i].message_code) {
@@ -159,6 +195,13 @@ static void store_monster(struct monster *mon, int msg_code)
 {
 	/* Record which monster had this message stored */
 	if (size_mon_hist < MAX_STORED_MON_CODES) {
+		int b = mon_msg_bucket(mon, msg_code, 0);
+
+		while (mon_hist_hash[b].gen == mon_msg_gen)
+			b = (b + 1) & (MON_MSG_HASH_SIZE - 1);
+		mon_hist_hash[b].gen = mon_msg_gen;
+		mon_hist_hash[b].index = size_mon_hist;
+
 		mon_message_hist[size_mon_hist].mon = mon;
 		mon_message_hist[size_mon_hist].message_code = msg_code;
 		size_mon_hist++;
@@ -172,9 +215,12 @@ static void store_monster(struct monster *mon, int msg_code)
  */
 static bool stack_message(struct monster *mon, int msg_code, int flags)
 {
-	int i;
+	int b = mon_msg_bucket(mon->race, msg_code, flags);
+
+	for (; mon_msg_hash[b].gen == mon_msg_gen;
+		 b = (b + 1) & (MON_MSG_HASH_SIZE - 1)) {
+		int i = mon_msg_hash[b].index;
 
-	for (i = 0; i < size_mon_msg; i++) {
 		/* We found the race and the message code */
 		if (mon_msg[i].race == mon->race &&
 					mon_msg[i].flags == flags &&
@@ -214,6 +260,13 @@ bool add_monster_message(struct monster *mon, int msg_code, bool delay)
 	if (!redundant_monster_message(mon, msg_code) &&
 			!stack_message(mon, msg_code, flags) &&
 			size_mon_msg < MAX_STORED_MON_MSG) {
+		int b = mon_msg_bucket(mon->race, msg_code, flags);
+
+		while (mon_msg_hash[b].gen == mon_msg_gen)
+			b = (b + 1) & (MON_MSG_HASH_SIZE - 1);
+		mon_msg_hash[b].gen = mon_msg_gen;
+		mon_msg_hash[b].index = size_mon_msg;
+
 		mon_msg[size_mon_msg].race = mon->race;
 		mon_msg[size_mon_msg].flags = flags;
 		mon_msg[size_mon_msg].msg_code = msg_code;
@@ -421,4 +474,9 @@ void show_monster_messages(void)
 
 	/* Delete all the stacked messages and history */
 	size_mon_msg = size_mon_hist = 0;
+	if (!++mon_msg_gen) {
+		memset(mon_msg_hash, 0, sizeof(mon_msg_hash));
+		memset(mon_hist_hash, 0, sizeof(mon_hist_hash));
+		mon_msg_gen = 1;
+	}
 }
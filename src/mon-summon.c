@@ -18,6 +18,7 @@
 
 #include "angband.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-summon.h"
 #include "mon-util.h"
 
@@ -187,7 +188,9 @@ int call_monster(int y, int x)
 	mon_clear_timed(mon, MON_TMD_SLEEP, MON_TMD_FLG_NOMESSAGE, false);
 
 	/* Set it's energy to 0 */
+	settle_monster_energy(cave, mon);
 	mon->energy = 0;
+	reschedule_monster(cave, mon);
 
 	return (mon->race->level);
 }
@@ -253,8 +256,12 @@ int summon_specific(int y1, int x1, int lev, int type, bool delay, bool call)
 		return (call_monster(y, x));
 	}
 
-	/* Prepare allocation table */
-	get_mon_num_prep(summon_specific_okay);
+	/* Prepare allocation table (kin depend on the summoner, not just the
+	 * summon type) */
+	if (type == S_KIN)
+		get_mon_num_prep(summon_specific_okay);
+	else
+		get_mon_num_prep_key(summon_specific_okay, type);
 
 	/* Pick a monster, using the level calculation */
 	race = get_mon_num((player->depth + lev) / 2 + 5);
@@ -277,6 +284,7 @@ int summon_specific(int y1, int x1, int lev, int type, bool delay, bool call)
 	/* XXX should this now be hold monster for a turn? */
 	if (delay) {
 		mon->energy = 0;
+		reschedule_monster(cave, mon);
 		if (mon->race->speed > player->state.speed)
 			mon_inc_timed(mon, MON_TMD_SLOW, 1,
 				MON_TMD_FLG_NOMESSAGE, false);
@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "mon-desc.h"
 #include "mon-lore.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -183,8 +184,20 @@ static bool mon_set_timed(struct monster *mon,
 		resisted = true;
 		m_note = MON_MSG_UNAFFECTED;
 	} else {
+		bool speed = effect_type == MON_TMD_FAST || effect_type == MON_TMD_SLOW;
+
+		/* Energy gained so far was at the old speed */
+		if (speed)
+			settle_monster_energy(cave, mon);
+
 		mon->m_timed[effect_type] = timer;
 
+		/* A dormant monster needs to notice the change */
+		if (speed)
+			reschedule_monster(cave, mon);
+		else
+			rouse_monster(cave, mon);
+
 		if (player->upkeep->health_who == mon)
 			player->upkeep->redraw |= (PR_HEALTH);
 
@@ -24,6 +24,7 @@
 #include "mon-list.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "mon-msg.h"
 #include "mon-predicate.h"
 #include "mon-spell.h"
@@ -40,7 +41,9 @@
 #include "player-quest.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "profile.h"
 #include "project.h"
+#include "z-index.h"
 #include "z-set.h"
 
 static const struct monster_flag monster_flag_table[] =
@@ -99,6 +102,32 @@ void create_mon_flag_mask(bitflag *f, ...)
 }
 
 
+/**
+ * Indices from race and base names, so that pref and data files naming
+ * hundreds of monsters don't scan the tables for each one.  Each is built on
+ * first use for the current table.
+ */
+static struct name_index *race_names;
+static struct monster_race *race_names_info;
+static struct name_index *base_names;
+static struct monster_base **base_names_list;
+static struct monster_base *base_names_info;
+
+/**
+ * Forget the name indices, as r_info or rb_info is going away.
+ */
+void lookup_monster_forget(void)
+{
+	name_index_free(race_names);
+	race_names = NULL;
+	race_names_info = NULL;
+	name_index_free(base_names);
+	base_names = NULL;
+	mem_free(base_names_list);
+	base_names_list = NULL;
+	base_names_info = NULL;
+}
+
 /**
  * Returns the monster with the given name. If no monster has the exact name
  * given, returns the first monster with the given name as a (case-insensitive)
@@ -107,25 +136,29 @@ void create_mon_flag_mask(bitflag *f, ...)
 struct monster_race *lookup_monster(const char *name)
 {
 	int i;
-	struct monster_race *closest = NULL;
-	
-	/* Look for it */
+
+	/* Look for an exact match first; that is the common case */
+	if (r_info) {
+		if (race_names_info != r_info) {
+			name_index_free(race_names);
+			race_names = name_index_new(z_info->r_max, true);
+			for (i = 0; i < z_info->r_max; i++)
+				name_index_add(race_names, r_info[i].name, i);
+			race_names_info = r_info;
+		}
+		i = name_index_find(race_names, name);
+		if (i >= 0)
+			return &r_info[i];
+	}
+
+	/* Settle for the first close match */
 	for (i = 0; i < z_info->r_max; i++) {
 		struct monster_race *race = &r_info[i];
-		if (!race->name)
-			continue;
-
-		/* Test for equality */
-		if (my_stricmp(name, race->name) == 0)
+		if (race->name && my_stristr(race->name, name))
 			return race;
+	}
 
-		/* Test for close matches */
-		if (!closest && my_stristr(race->name, name))
-			closest = race;
-	} 
-
-	/* Return our best match */
-	return closest;
+	return NULL;
 }
 
 /**
@@ -134,14 +167,27 @@ struct monster_race *lookup_monster(const char *name)
 struct monster_base *lookup_monster_base(const char *name)
 {
 	struct monster_base *base;
-
-	/* Look for it */
-	for (base = rb_info; base; base = base->next) {
-		if (streq(name, base->name))
-			return base;
+	int i, n = 0;
+
+	if (!rb_info) return NULL;
+
+	/* Index the bases the first time */
+	if (base_names_info != rb_info) {
+		for (base = rb_info; base; base = base->next)
+			n++;
+		name_index_free(base_names);
+		mem_free(base_names_list);
+		base_names = name_index_new(n, false);
+		base_names_list = mem_zalloc(n * sizeof(*base_names_list));
+		for (i = 0, base = rb_info; base; base = base->next, i++) {
+			base_names_list[i] = base;
+			name_index_add(base_names, base->name, i);
+		}
+		base_names_info = rb_info;
 	}
 
-	return NULL;
+	i = name_index_find(base_names, name);
+	return (i < 0) ? NULL : base_names_list[i];
 }
 
 /**
@@ -234,8 +280,6 @@ static void path_analyse(struct chunk *c, int y, int x)
  * of the primary bottlenecks, along with "update_view()" and the
  * "process_monsters()" code, so efficiency is important.
  *
- * Note the optimized "inline" version of the "distance()" function.
- *
  * A monster is "visible" to the player if (1) it has been detected
  * by the player, (2) it is close to the player and the player has
  * telepathy, or (3) it is close to the player, and in line of sight
@@ -276,6 +320,11 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 
 	assert(mon != NULL);
 
+	PROFILE_ENTER(PROF_UPDATE_MON);
+
+	/* Up to date now */
+	mflag_off(mon->mflag, MFLAG_REVIEW);
+
 	lore = get_lore(mon->race);
 	
 	fy = mon->fy;
@@ -283,18 +332,17 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 
 	/* Compute distance, or just use the current one */
 	if (full) {
-		/* Distance components */
-		int dy = (py > fy) ? (py - fy) : (fy - py);
-		int dx = (px > fx) ? (px - fx) : (fx - px);
-
 		/* Approximate distance */
-		d = (dy > dx) ? (dy + (dx>>1)) : (dx + (dy>>1));
+		d = distance(py, px, fy, fx);
 
 		/* Restrict distance */
 		if (d > 255) d = 255;
 
 		/* Save the distance */
 		mon->cdis = d;
+
+		/* A dormant monster may now be close enough to notice */
+		rouse_monster_at(c, fy, fx);
 	} else {
 		/* Extract the distance */
 		d = mon->cdis;
@@ -452,24 +500,70 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
 			player->upkeep->redraw |= PR_MONLIST;
 		}
 	}
+
+	PROFILE_LEAVE(PROF_UPDATE_MON);
 }
 
 
 
 
+/**
+ * Note that the view has been made again over the given area, so monsters
+ * in it need their visibility working out again.
+ */
+void note_monster_views(struct chunk *c, int y1, int x1, int y2, int x2)
+{
+	s16b *found = mem_zalloc(cave_monster_max(c) * sizeof(s16b));
+	int i, n = monsters_in_rect(c, y1, x1, y2, x2, found);
+
+	for (i = 0; i < n; i++)
+		mflag_on(cave_monster(c, found[i])->mflag, MFLAG_REVIEW);
+
+	mem_free(found);
+}
+
 /**
  * Updates all the (non-dead) monsters via update_mon().
+ *
+ * Without a full update, a monster's visibility can only have changed if it
+ * has been moved or seen differently since (each of which updates it or marks
+ * it for review), or if the player can see differently.  Mimics are always
+ * updated, as changes to ignoring can uncover them.
  */
 void update_monsters(bool full)
 {
+	struct monster_sight sight;
+	bool all = full;
 	int i;
 
+	/* What the player can see with now */
+	sight.valid = true;
+	sight.grid = character_dungeon ? loc(player->px, player->py) :
+		loc(cave->width / 2, cave->height / 2);
+	sight.blind = player->timed[TMD_BLIND] ? true : false;
+	sight.telepathy = player_of_has(player, OF_TELEPATHY);
+	sight.see_invis = player_of_has(player, OF_SEE_INVIS);
+	sight.see_infra = player->state.see_infra;
+
+	/* Everything needs working out again if it has changed */
+	if (!cave->mon_sight.valid ||
+		(sight.grid.x != cave->mon_sight.grid.x) ||
+		(sight.grid.y != cave->mon_sight.grid.y) ||
+		(sight.blind != cave->mon_sight.blind) ||
+		(sight.telepathy != cave->mon_sight.telepathy) ||
+		(sight.see_invis != cave->mon_sight.see_invis) ||
+		(sight.see_infra != cave->mon_sight.see_infra))
+		all = true;
+	cave->mon_sight = sight;
+
 	/* Update each (live) monster */
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		struct monster *mon = cave_monster(cave, i);
 
-		/* Update the monster if alive */
-		if (mon->race)
+		/* Update the monster if alive, and if it could have changed */
+		if (!mon->race) continue;
+		if (all || mflag_has(mon->mflag, MFLAG_REVIEW) ||
+			monster_is_mimicking(mon))
 			update_mon(mon, cave, full);
 	}
 }
@@ -511,6 +605,121 @@ bool monster_carry(struct chunk *c, struct monster *mon, struct object *obj)
 	return true;
 }
 
+/**
+ * ------------------------------------------------------------------------
+ * Finding monsters by location
+ * ------------------------------------------------------------------------ */
+/**
+ * Monsters are kept in lists by which 8x8 block of grids (MON_BLOCK_SHIFT)
+ * they stand in, so that queries about an area need only look at the
+ * monsters near it.  The lists are built the first time they are needed;
+ * anything which moves monsters around wholesale just forgets them.
+ */
+#define MON_BLOCK_SHIFT	3
+
+static int monster_block(struct chunk *c, int y, int x)
+{
+	return (y >> MON_BLOCK_SHIFT) * c->mon_block_wid + (x >> MON_BLOCK_SHIFT);
+}
+
+static size_t monster_blocks_size(struct chunk *c)
+{
+	return ((c->height >> MON_BLOCK_SHIFT) + 1) *
+		((c->width >> MON_BLOCK_SHIFT) + 1) * sizeof(s16b);
+}
+
+/**
+ * Add a monster to the list for its block
+ */
+void monster_block_add(struct chunk *c, struct monster *mon)
+{
+	s16b *head;
+
+	if (!c->mon_blocks) return;
+
+	head = &c->mon_blocks[monster_block(c, mon->fy, mon->fx)];
+	mon->block_next = *head;
+	*head = mon->midx;
+}
+
+/**
+ * Take a monster out of the list for its block
+ */
+void monster_block_remove(struct chunk *c, struct monster *mon)
+{
+	s16b *link;
+
+	if (!c->mon_blocks) return;
+
+	link = &c->mon_blocks[monster_block(c, mon->fy, mon->fx)];
+	while (*link && *link != mon->midx)
+		link = &cave_monster(c, *link)->block_next;
+	if (*link)
+		*link = mon->block_next;
+	mon->block_next = 0;
+}
+
+/**
+ * Forget the block lists, after monsters have been moved or renumbered
+ * without going through monster_block_add() and monster_block_remove()
+ */
+void forget_monster_blocks(struct chunk *c)
+{
+	chunk_release(c, c->mon_blocks, monster_blocks_size(c));
+	c->mon_blocks = NULL;
+}
+
+static int cmp_monster_index(const void *a, const void *b)
+{
+	return *(const s16b *)a - *(const s16b *)b;
+}
+
+/**
+ * Find the live monsters standing in a rectangle of grids, which is clipped
+ * to the chunk.  The indices are written to `found`, which must have room
+ * for cave_monster_max(c) of them, in increasing order, as a scan of the
+ * whole monster list would find them.
+ *
+ * Returns the number of monsters found.
+ */
+int monsters_in_rect(struct chunk *c, int y1, int x1, int y2, int x2,
+					 s16b *found)
+{
+	int by, bx, i, n = 0;
+
+	/* Build the lists if need be */
+	if (!c->mon_blocks) {
+		c->mon_block_wid = (c->width >> MON_BLOCK_SHIFT) + 1;
+		c->mon_blocks = chunk_alloc(c, monster_blocks_size(c));
+		for (i = cave_monster_max(c) - 1; i >= 1; i--) {
+			struct monster *mon = cave_monster(c, i);
+			if (mon->race)
+				monster_block_add(c, mon);
+		}
+	}
+
+	y1 = MAX(y1, 0);
+	x1 = MAX(x1, 0);
+	y2 = MIN(y2, c->height - 1);
+	x2 = MIN(x2, c->width - 1);
+
+	for (by = y1 >> MON_BLOCK_SHIFT; by <= y2 >> MON_BLOCK_SHIFT; by++) {
+		for (bx = x1 >> MON_BLOCK_SHIFT; bx <= x2 >> MON_BLOCK_SHIFT; bx++) {
+			i = c->mon_blocks[by * c->mon_block_wid + bx];
+			while (i) {
+				struct monster *mon = cave_monster(c, i);
+				if (mon->fy >= y1 && mon->fy <= y2 &&
+					mon->fx >= x1 && mon->fx <= x2)
+					found[n++] = i;
+				i = mon->block_next;
+			}
+		}
+	}
+
+	sort(found, n, sizeof(found[0]), cmp_monster_index);
+	return n;
+}
+
 /**
  * Swap the players/monsters (if any) at two locations.
  */
@@ -525,15 +734,21 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	m2 = cave->squares[y2][x2].mon;
 
 	/* Update grids */
+	cave->fingerprint -= square_fingerprint_mon(cave, y1, x1) +
+		square_fingerprint_mon(cave, y2, x2);
 	cave->squares[y1][x1].mon = m2;
 	cave->squares[y2][x2].mon = m1;
+	cave->fingerprint += square_fingerprint_mon(cave, y1, x1) +
+		square_fingerprint_mon(cave, y2, x2);
 
 	/* Monster 1 */
 	if (m1 > 0) {
 		/* Monster */
 		mon = cave_monster(cave, m1);
+		monster_block_remove(cave, mon);
 		mon->fy = y2;
 		mon->fx = x2;
+		monster_block_add(cave, mon);
 
 		/* Update monster */
 		update_mon(mon, cave, true);
@@ -563,8 +778,10 @@ void monster_swap(int y1, int x1, int y2, int x2)
 	if (m2 > 0) {
 		/* Monster */
 		mon = cave_monster(cave, m2);
+		monster_block_remove(cave, mon);
 		mon->fy = y1;
 		mon->fx = x1;
+		monster_block_add(cave, mon);
 
 		/* Update monster */
 		update_mon(mon, cave, true);
@@ -691,15 +908,15 @@ void update_smart_learn(struct monster *mon, struct player *p, int flag,
 	/* Learn the pflag */
 	if (pflag) {
 		if (pf_has(player->state.pflags, pflag)) {
-			of_on(mon->known_pstate.pflags, pflag);
+			pf_on(mon->known_pstate.pflags, pflag);
 		} else {
-			of_off(mon->known_pstate.pflags, pflag);
+			pf_off(mon->known_pstate.pflags, pflag);
 		}
 	}
 
 	/* Learn the element */
 	if (element_ok)
-		mon->known_pstate.el_info[element].res_level
+		mon->known_pstate.res_level[element]
 			= player->state.el_info[element].res_level;
 }
 
@@ -747,43 +964,71 @@ static struct monster *get_injured_kin(struct chunk *c, const struct monster *mo
  */
 bool find_any_nearby_injured_kin(struct chunk *c, const struct monster *mon)
 {
-	for (int y = mon->fy - MAX_KIN_RADIUS; y <= mon->fy + MAX_KIN_RADIUS; y++) {
-		for (int x = mon->fx - MAX_KIN_RADIUS; x <= mon->fx + MAX_KIN_RADIUS; x++) {
-			if (get_injured_kin(c, mon, x, y) != NULL) {
-				return true;
-			}
-		}
+	s16b *found = mem_zalloc(cave_monster_max(c) * sizeof(s16b));
+	int i, n = monsters_in_rect(c, mon->fy - MAX_KIN_RADIUS,
+								mon->fx - MAX_KIN_RADIUS,
+								mon->fy + MAX_KIN_RADIUS,
+								mon->fx + MAX_KIN_RADIUS, found);
+	bool any = false;
+
+	for (i = 0; i < n && !any; i++) {
+		struct monster *kin = cave_monster(c, found[i]);
+		if (get_injured_kin(c, mon, kin->fx, kin->fy) != NULL)
+			any = true;
 	}
 
-	return false;
+	mem_free(found);
+	return any;
+}
+
+/**
+ * Order monsters by grid, row by row
+ */
+static int cmp_monster_grid(const void *a, const void *b)
+{
+	const struct monster *ma = *(struct monster * const *)a;
+	const struct monster *mb = *(struct monster * const *)b;
+
+	if (ma->fy != mb->fy)
+		return ma->fy - mb->fy;
+	return ma->fx - mb->fx;
 }
 
 /**
  * Choose one injured monster of the same base in LOS of the provided monster.
  *
- * Scan MAX_KIN_RADIUS grids around the monster to find potential grids,
- * make a list of kin, and choose a random one.
+ * Find the monsters within MAX_KIN_RADIUS grids of the monster, make a list
+ * of kin in grid order, and choose a random one.
  */
 struct monster *choose_nearby_injured_kin(struct chunk *c, const struct monster *mon)
 {
 	struct set *set = set_new();
-
-	for (int y = mon->fy - MAX_KIN_RADIUS; y <= mon->fy + MAX_KIN_RADIUS; y++) {
-		for (int x = mon->fx - MAX_KIN_RADIUS; x <= mon->fx + MAX_KIN_RADIUS; x++) {
-			struct monster *kin = get_injured_kin(c, mon, x, y);
-			if (kin != NULL) {
-				set_add(set, kin);
-			}
-		}
+	s16b *found = mem_zalloc(cave_monster_max(c) * sizeof(s16b));
+	struct monster **kin = mem_zalloc(cave_monster_max(c) * sizeof(*kin));
+	int i, num = 0, n = monsters_in_rect(c, mon->fy - MAX_KIN_RADIUS,
+										 mon->fx - MAX_KIN_RADIUS,
+										 mon->fy + MAX_KIN_RADIUS,
+										 mon->fx + MAX_KIN_RADIUS, found);
+
+	for (i = 0; i < n; i++) {
+		struct monster *m = cave_monster(c, found[i]);
+		if (get_injured_kin(c, mon, m->fx, m->fy) != NULL)
+			kin[num++] = m;
 	}
 
-	struct monster *found = set_choose(set);
+	/* Keep the order a scan of the grids would give */
+	sort(kin, num, sizeof(kin[0]), cmp_monster_grid);
+	for (i = 0; i < num; i++)
+		set_add(set, kin[i]);
+
+	struct monster *chosen = set_choose(set);
 	set_free(set);
+	mem_free(kin);
+	mem_free(found);
 
-	return found;
+	return chosen;
 }
 
-
 /**
  * Handles the "death" of a monster.
  *
@@ -807,8 +1052,11 @@ void monster_death(struct monster *mon, bool stats)
 	bool visible = monster_is_visible(mon) || monster_is_unique(mon);
 
 	/* Delete any mimicked objects */
-	if (mon->mimicked_obj)
+	if (mon->mimicked_obj) {
+		square_excise_object(cave, mon->fy, mon->fx, mon->mimicked_obj);
+		delist_object(cave, mon->mimicked_obj);
 		object_delete(&mon->mimicked_obj);
+	}
 
 	/* Drop objects being carried */
 	while (obj) {
@@ -895,6 +1143,7 @@ bool mon_take_hit(struct monster *mon, int dam, bool *fear, const char *note)
 
 	/* Hurt it */
 	mon->hp -= dam;
+	rouse_monster(cave, mon);
 
 	/* It is dead now */
 	if (mon->hp < 0) {
@@ -23,12 +23,19 @@
 
 const char *describe_race_flag(int flag);
 void create_mon_flag_mask(bitflag *f, ...);
+void lookup_monster_forget(void);
 struct monster_race *lookup_monster(const char *name);
 struct monster_base *lookup_monster_base(const char *name);
 bool match_monster_bases(const struct monster_base *base, ...);
 void update_mon(struct monster *mon, struct chunk *c, bool full);
+void note_monster_views(struct chunk *c, int y1, int x1, int y2, int x2);
 void update_monsters(bool full);
 bool monster_carry(struct chunk *c, struct monster *mon, struct object *obj);
+void monster_block_add(struct chunk *c, struct monster *mon);
+void monster_block_remove(struct chunk *c, struct monster *mon);
+void forget_monster_blocks(struct chunk *c);
+int monsters_in_rect(struct chunk *c, int y1, int x1, int y2, int x2,
+					 s16b *found);
 void monster_swap(int y1, int x1, int y2, int x2);
 void become_aware(struct monster *m);
 void update_smart_learn(struct monster *mon, struct player *p, int flag,
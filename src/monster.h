@@ -312,10 +312,20 @@ struct monster_race {
 };
 
 
+/**
+ * What a monster has learned of the player's protections (birth_ai_learn)
+ */
+struct monster_pstate {
+	bitflag flags[OF_SIZE];		/* Object flags */
+	bitflag pflags[PF_SIZE];	/* Player flags */
+	s16b res_level[ELEM_MAX];	/* Element resistances */
+};
+
 /**
  * Monster information, for a specific monster.
  *
- * Note: fy, fx constrain dungeon size to 256x256
+ * Fields used every game turn come first; what the monster has learned
+ * about the player, needed only when it picks spells, comes last.
  *
  * The "held_obj" field points to the first object of a stack
  * of objects (if any) being carried by the monster (see above).
@@ -324,8 +334,8 @@ struct monster {
 	struct monster_race *race;
 	int midx;
 
-	byte fy;			/* Y location on map */
-	byte fx;			/* X location on map */
+	s16b fy;			/* Y location on map */
+	s16b fx;			/* X location on map */
 
 	s16b hp;			/* Current Hit points */
 	s16b maxhp;			/* Max Hit points */
@@ -335,6 +345,13 @@ struct monster {
 	byte mspeed;		/* Monster "speed" */
 	byte energy;		/* Monster "energy" */
 
+	byte sched;			/* Place in the monster schedule (see mon-move.c) */
+	s32b energy_turn;	/* First game turn whose energy is not yet added */
+	s32b next_turn;		/* Game turn the monster can next move */
+	s16b sched_prev;	/* Neighbours in the schedule wheel bucket */
+	s16b sched_next;
+	s16b block_next;	/* Next monster in the same block of grids */
+
 	byte cdis;			/* Current dis from player */
 
 	bitflag mflag[MFLAG_SIZE];	/* Temporary monster flags */
@@ -344,13 +361,13 @@ struct monster {
 
 	byte attr;  		/* attr last used for drawing monster */
 
-	struct player_state known_pstate; /* Known player state */
-
-    byte ty;		/**< Monster target */
-    byte tx;
+    s16b ty;		/**< Monster target */
+    s16b tx;
 
     byte min_range;	/**< What is the closest we want to be?  Not saved */
     byte best_range;	/**< How close do we want to be? Not saved */
+
+	struct monster_pstate known_pstate; /* Known player state */
 };
 
 /** Variables **/
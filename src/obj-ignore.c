@@ -110,6 +110,33 @@ bool **ego_ignore_types;
 /* Hackish - ego_ignore_types should be initialised with arrays */
 static int num_ego_types;
 
+/* The ignore type of each object kind, found once rather than per object */
+static ignore_type_t *kind_ignore_types;
+
+
+/**
+ * Find the ignore type for a tval and kind name, or ITYPE_MAX if none
+ */
+static ignore_type_t ignore_type_find(int tval, const char *name)
+{
+	size_t i;
+
+	/* Find the appropriate ignore group */
+	for (i = 0; i < N_ELEMENTS(quality_mapping); i++) {
+		if (quality_mapping[i].tval == tval) {
+			/* If there's an identifier, it must match */
+			if (quality_mapping[i].identifier[0]) {
+				if (!strstr(name, quality_mapping[i].identifier))
+					continue;
+			}
+			/* Otherwise we're fine */
+			return quality_mapping[i].ignore_type;
+		}
+	}
+
+	return ITYPE_MAX;
+}
+
 
 /**
  * Initialise the ignore package 
@@ -122,6 +149,14 @@ void init_ignore(void)
 	ego_ignore_types = mem_zalloc(z_info->e_max * sizeof(bool*));
 	for (i = 0; i < z_info->e_max; i++)
 		ego_ignore_types[i] = mem_zalloc(ITYPE_MAX * sizeof(bool));
+
+	kind_ignore_types = mem_zalloc(z_info->k_max * sizeof(ignore_type_t));
+	for (i = 0; i < z_info->k_max; i++) {
+		struct object_kind *kind = &k_info[i];
+
+		kind_ignore_types[i] = kind->name ?
+			ignore_type_find(kind->tval, kind->name) : ITYPE_MAX;
+	}
 }
 
 
@@ -134,6 +169,7 @@ void cleanup_ignore(void)
 	for (i = 0; i < num_ego_types; i++)
 		mem_free(ego_ignore_types[i]);
 	mem_free(ego_ignore_types);
+	mem_free(kind_ignore_types);
 }
 
 
@@ -196,8 +232,8 @@ void rune_autoinscribe(int i)
 	int py = player->py;
 	int px = player->px;
 
-	/* Check the player knows the rune */
-	if (!player_knows_rune(player, i)) {
+	/* Check the rune has a note and the player knows the rune */
+	if (!rune_note(i) || !player_knows_rune(player, i)) {
 		return;
 	}
 
@@ -220,8 +256,10 @@ static void runes_autoinscribe(struct object *obj)
 {
 	int i, rune_max = max_runes();
 
+	/* Few runes carry a note, so check for one before looking at the object */
 	for (i = 0; i < rune_max; i++)
-		if (object_has_rune(obj, i) && player_knows_rune(player, i))
+		if (rune_note(i) && object_has_rune(obj, i) &&
+			player_knows_rune(player, i))
 			rune_add_autoinscription(obj, i);
 }
 
@@ -380,22 +418,11 @@ void object_ignore_flavor_of(const struct object *obj)
  */
 ignore_type_t ignore_type_of(const struct object *obj)
 {
-	size_t i;
+	/* Objects of their kind's tval have the type worked out at start-up */
+	if (obj->tval == obj->kind->tval)
+		return kind_ignore_types[obj->kind->kidx];
 
-	/* Find the appropriate ignore group */
-	for (i = 0; i < N_ELEMENTS(quality_mapping); i++) {
-		if (quality_mapping[i].tval == obj->tval) {
-			/* If there's an identifier, it must match */
-			if (quality_mapping[i].identifier[0]) {
-				if (!strstr(obj->kind->name, quality_mapping[i].identifier))
-					continue;
-			}
-			/* Otherwise we're fine */
-			return quality_mapping[i].ignore_type;
-		}
-	}
-
-	return ITYPE_MAX;
+	return ignore_type_find(obj->tval, obj->kind->name);
 }
 
 /**
@@ -595,14 +622,20 @@ bool object_is_ignored(const struct object *obj)
 		 kind_is_ignored_unaware(obj->kind))
 		return true;
 
+	type = ignore_type_of(obj);
+
 	/* Ignore ego items if known */
-	if (obj->known->ego && ego_is_ignored(obj->ego->eidx, ignore_type_of(obj)))
+	if (obj->known->ego && ego_is_ignored(obj->ego->eidx, type))
 		return true;
 
-	type = ignore_type_of(obj);
 	if (type == ITYPE_MAX)
 		return false;
 
+	/* Most types have no quality ignoring set, and ignore_level_of() never
+	 * gives IGNORE_NONE, so don't bother working the level out */
+	if (ignore_level[type] == IGNORE_NONE)
+		return false;
+
 	/* Ignore items known not to be artifacts */
 	if ((obj->known->notice & OBJ_NOTICE_ASSESSED) && !obj->artifact &&
 		ignore_level[type] == IGNORE_ALL)
@@ -925,7 +925,7 @@ static enum parser_error parse_curse_name(struct parser *p) {
 	struct curse *h = parser_priv(p);
 
 	struct curse *curse = mem_zalloc(sizeof *curse);
-	curse->obj = mem_zalloc(sizeof(struct object));
+	curse->obj = object_new();
 	curse->next = h;
 	parser_setpriv(p, curse);
 	curse->name = string_make(name);
@@ -1201,6 +1201,9 @@ static errr finish_parse_curse(struct parser *p) {
 		memcpy(&curses[count], curse, sizeof(*curse));
 		next = curse->next;
 		curses[count].next = NULL;
+		if (curses[count].obj)
+			curses[count].obj->effect =
+				effect_chain_pack(curses[count].obj->effect);
 
 		mem_free(curse);
 	}
@@ -1221,11 +1224,11 @@ static void cleanup_curse(void)
 			if (curses[idx].obj->known) {
 				free_effect(curses[idx].obj->known->effect);
 				mem_free(curses[idx].obj->known->effect_msg);
-				mem_free(curses[idx].obj->known);
+				object_free(curses[idx].obj->known);
 			}
 			free_effect(curses[idx].obj->effect);
 			mem_free(curses[idx].obj->effect_msg);
-			mem_free(curses[idx].obj);
+			object_free(curses[idx].obj);
 		}
 		mem_free(curses[idx].poss);
 	}
@@ -1443,6 +1446,7 @@ static errr finish_parse_act(struct parser *p) {
 	for (act = parser_priv(p); act; act = next, count++) {
 		memcpy(&activations[count], act, sizeof(*act));
 		activations[count].index = count;
+		activations[count].effect = effect_chain_pack(act->effect);
 		next = act->next;
 		if (next)
 			activations[count].next = &activations[count + 1];
@@ -1905,6 +1909,7 @@ static errr finish_parse_object(struct parser *p) {
 
 		memcpy(&k_info[kidx], k, sizeof(*k));
 		k_info[kidx].kidx = kidx;
+		k_info[kidx].effect = effect_chain_pack(k->effect);
 
 		/* Add base kind flags to kind kind flags */
 		kf_union(k_info[kidx].kind_flags, kb_info[k->tval].kind_flags);
@@ -2349,6 +2354,7 @@ static errr finish_parse_ego(struct parser *p) {
 
 		memcpy(&e_info[eidx], e, sizeof(*e));
 		e_info[eidx].eidx = eidx;
+		e_info[eidx].effect = effect_chain_pack(e->effect);
 		n = e->next;
 		if (eidx < z_info->e_max - 1)
 			e_info[eidx].next = &e_info[eidx + 1];
@@ -3045,6 +3051,7 @@ static errr finish_parse_object_property(struct parser *p) {
 		mem_free(prop);
 	}
 	z_info->property_max += 1;
+	index_obj_properties();
 
 	parser_destroy(p);
 	return 0;
@@ -3053,6 +3060,8 @@ static errr finish_parse_object_property(struct parser *p) {
 static void cleanup_object_property(void)
 {
 	int idx;
+
+	free_obj_property_index();
 	for (idx = 0; idx < z_info->property_max; idx++) {
 		struct obj_property *prop = &obj_properties[idx];
 
@@ -3296,6 +3305,9 @@ static errr finish_parse_object_power(struct parser *p) {
 	}
 	z_info->calculation_max += 1;
 
+	/* The object properties are in, so the flag masks can be made */
+	power_calculation_masks_init();
+
 	parser_destroy(p);
 	return 0;
 }
@@ -1090,6 +1090,7 @@ void update_player_object_knowledge(struct player *p)
 	}
 
 	/* Update */
+	p->upkeep->update |= (PU_BONUS);
 	if (cave)
 		autoinscribe_ground();
 	autoinscribe_pack();
@@ -1103,13 +1104,14 @@ void update_player_object_knowledge(struct player *p)
  * These functions are for increasing player knowledge of object properties
  * ------------------------------------------------------------------------ */
 /**
- * Learn a given rune
+ * Learn a given rune, without bringing object knowledge up to date
  *
  * \param p is the player
  * \param i is the rune index
  * \param message is whether or not to print a message
+ * \return whether the rune was newly learned
  */
-static void player_learn_rune(struct player *p, size_t i, bool message)
+static bool player_learn_rune_aux(struct player *p, size_t i, bool message)
 {
 	struct rune *r = &rune_list[i];
 	bool learned = false;
@@ -1211,14 +1213,31 @@ static void player_learn_rune(struct player *p, size_t i, bool message)
 	}
 
 	/* Nothing learned */
-	if (!learned) return;
+	if (!learned) return false;
 
 	/* Give a message */
 	if (message)
 		msgt(MSG_RUNE, "You have learned the rune of %s.", rune_name(i));
 
+	return true;
+}
+
+/**
+ * Learn a given rune, and update object knowledge if it was new
+ *
+ * \param p is the player
+ * \param i is the rune index
+ * \param message is whether or not to print a message
+ * \return whether the rune was newly learned
+ */
+static bool player_learn_rune(struct player *p, size_t i, bool message)
+{
+	if (!player_learn_rune_aux(p, i, message))
+		return false;
+
 	/* Update knowledge */
 	update_player_object_knowledge(p);
+	return true;
 }
 
 /**
@@ -1226,8 +1245,9 @@ static void player_learn_rune(struct player *p, size_t i, bool message)
  */
 void player_learn_flag(struct player *p, int flag)
 {
-	player_learn_rune(p, rune_index(RUNE_VAR_FLAG, flag), true);
-	update_player_object_knowledge(p);
+	/* Update knowledge even if the rune was known, as the flag may be new */
+	if (!player_learn_rune(p, rune_index(RUNE_VAR_FLAG, flag), true))
+		update_player_object_knowledge(p);
 }
 
 /**
@@ -1236,10 +1256,8 @@ void player_learn_flag(struct player *p, int flag)
 void player_learn_curse(struct player *p, struct curse *curse)
 {
 	int index = rune_index(RUNE_VAR_CURSE, lookup_curse(curse->name));
-	if (index >= 0) {
-		player_learn_rune(p, index, true);
-	}
-	update_player_object_knowledge(p);
+	if ((index < 0) || !player_learn_rune(p, index, true))
+		update_player_object_knowledge(p);
 }
 
 /**
@@ -1254,14 +1272,15 @@ void player_learn_innate(struct player *p)
 	/* Elements */
 	for (element = 0; element < ELEM_MAX; element++) {
 		if (p->race->el_info[element].res_level != 0) {
-			player_learn_rune(p, rune_index(RUNE_VAR_RESIST, element), false);
+			player_learn_rune_aux(p, rune_index(RUNE_VAR_RESIST, element),
+								  false);
 		}
 	}
 
 	/* Flags */
 	for (flag = of_next(p->race->flags, FLAG_START); flag != FLAG_END;
 		 flag = of_next(p->race->flags, flag + 1)) {
-		player_learn_rune(p, rune_index(RUNE_VAR_FLAG, flag), false);
+		player_learn_rune_aux(p, rune_index(RUNE_VAR_FLAG, flag), false);
 	}
 
 	update_player_object_knowledge(p);
@@ -1275,9 +1294,14 @@ void player_learn_innate(struct player *p)
 void player_learn_everything(struct player *p)
 {
 	size_t i;
+	bool learned = false;
 
 	for (i = 0; i < rune_max; i++)
-		player_learn_rune(p, i, false);
+		if (player_learn_rune_aux(p, i, false))
+			learned = true;
+
+	if (learned)
+		update_player_object_knowledge(p);
 }
 
 /**
@@ -1725,8 +1749,8 @@ void object_learn_slay(struct player *p, struct object *obj, int index)
 		assert(i < z_info->slay_max);
 
 		/* Learn the rune */
-		player_learn_rune(p, rune_index(RUNE_VAR_SLAY, i), true);
-		update_player_object_knowledge(p);
+		if (!player_learn_rune(p, rune_index(RUNE_VAR_SLAY, i), true))
+			update_player_object_knowledge(p);
 	}
 }
 
@@ -1751,8 +1775,8 @@ void object_learn_brand(struct player *p, struct object *obj, int index)
 		assert(i < z_info->brand_max);
 
 		/* Learn the rune */
-		player_learn_rune(p, rune_index(RUNE_VAR_BRAND, i), true);
-		update_player_object_knowledge(p);
+		if (!player_learn_rune(p, rune_index(RUNE_VAR_BRAND, i), true))
+			update_player_object_knowledge(p);
 	}
 }
 
@@ -2075,6 +2099,7 @@ void object_flavor_aware(struct object *obj)
 	if (kind_is_ignored_unaware(obj->kind))
 		kind_ignore_when_aware(obj->kind);
 	player->upkeep->notice |= PN_IGNORE;
+	player->upkeep->update |= (PU_BONUS);
 
 	/* Update player objects */
 	for (obj1 = player->gear; obj1; obj1 = obj1->next)
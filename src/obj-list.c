@@ -158,6 +158,9 @@ void object_list_collect(object_list_t *list)
 	int py = player->py;
 	int px = player->px;
 
+	/* No list entry before this one is empty */
+	int entry_index = 0;
+
 	if (list == NULL || list->entries == NULL)
 		return;
 
@@ -167,7 +170,6 @@ void object_list_collect(object_list_t *list)
 	/* Scan each object in the dungeon. */
 	for (i = 1; i < player->cave->obj_max; i++) {
 		object_list_entry_t *entry = NULL;
-		int entry_index;
 		int current_distance;
 		int entry_distance;
 		int y, x, field;
@@ -183,29 +185,28 @@ void object_list_collect(object_list_t *list)
 			x = obj->ix;
 		}
 
+		if (object_list_should_ignore_object(obj)) continue;
+
 		/* Determine which section of the list the object entry is in */
 		los = projectable(cave, py, px, y, x, PROJECT_NONE) ||
 			((y == py) && (x == px));
 		field = (los) ? OBJECT_LIST_SECTION_LOS : OBJECT_LIST_SECTION_NO_LOS;
 
-		if (object_list_should_ignore_object(obj)) continue;
+		/* Find the next empty slot */
+		while (entry_index < (int)list->entries_size &&
+			   list->entries[entry_index].object != NULL)
+			entry_index++;
 
-		/* Find or add a list entry. */
-		for (entry_index = 0; entry_index < (int)list->entries_size;
-			 entry_index++) {
+		/* Add this object there */
+		if (entry_index < (int)list->entries_size) {
 			int j;
-			struct object *list_obj = list->entries[entry_index].object;
-
-			if (list_obj == NULL) {
-				/* We found an empty slot, so add this object here. */
-				list->entries[entry_index].object = obj;
-				for (j = 0; j < OBJECT_LIST_SECTION_MAX; j++)
-					list->entries[entry_index].count[j] = 0;
-				list->entries[entry_index].dy = y - player->py;
-				list->entries[entry_index].dx = x - player->px;
-				entry = &list->entries[entry_index];
-				break;
-			}
+
+			list->entries[entry_index].object = obj;
+			for (j = 0; j < OBJECT_LIST_SECTION_MAX; j++)
+				list->entries[entry_index].count[j] = 0;
+			list->entries[entry_index].dy = y - player->py;
+			list->entries[entry_index].dx = x - player->px;
+			entry = &list->entries[entry_index];
 		}
 
 		if (entry == NULL)
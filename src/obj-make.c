@@ -31,16 +31,23 @@
 #include "obj-tval.h"
 #include "obj-util.h"
 
-/** Arrays holding an index of objects to generate for a given level */
-static u32b *obj_total;
-static byte *obj_alloc;
+/** Arrays holding running totals of object kind probabilities by level */
+static u32b *obj_alloc;
+static u32b *obj_alloc_great;
 
-static u32b *obj_total_great;
-static byte *obj_alloc_great;
+/** The same, for the kinds of each tval in turn; see get_obj_num_by_kind() */
+static u32b *obj_alloc_tval;
+static u32b *obj_alloc_tval_great;
+static int *tval_kinds;		/* Kind indexes, in kind order within each tval */
+static int *tval_start;		/* Where each tval's kinds start in tval_kinds */
 
 static s16b alloc_ego_size = 0;
 static alloc_entry *alloc_ego_table;
 
+/** Ego table entries which can be applied to each kind, in table order */
+static s16b *kind_egos;
+static int *kind_egos_start;
+
 struct money {
 	char *name;
 	int type;
@@ -53,38 +60,66 @@ static int num_money_types;
  * Initialize object allocation info
  */
 static void alloc_init_objects(void) {
-	int item, lev;
+	int item, lev, tval;
 	int k_max = z_info->k_max;
+	size_t size = (z_info->max_obj_depth + 1) * k_max * sizeof(u32b);
 
 	/* Allocate and wipe */
-	obj_alloc = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(byte));
-	obj_alloc_great = mem_zalloc((z_info->max_obj_depth + 1) * k_max * sizeof(byte));
-	obj_total = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(u32b));
-	obj_total_great = mem_zalloc((z_info->max_obj_depth + 1) * sizeof(u32b));
-
-	/* Init allocation data */
+	obj_alloc = mem_zalloc(size);
+	obj_alloc_great = mem_zalloc(size);
+	obj_alloc_tval = mem_zalloc(size);
+	obj_alloc_tval_great = mem_zalloc(size);
+	tval_kinds = mem_zalloc(k_max * sizeof(int));
+	tval_start = mem_zalloc((TV_MAX + 1) * sizeof(int));
+
+	/* Group the kinds by tval, keeping them in order within each tval */
+	for (item = 0; item < k_max; item++)
+		tval_start[k_info[item].tval + 1]++;
+	for (tval = 1; tval <= TV_MAX; tval++)
+		tval_start[tval] += tval_start[tval - 1];
 	for (item = 0; item < k_max; item++) {
-		const struct object_kind *kind = &k_info[item];
-
-		int min = kind->alloc_min;
-		int max = kind->alloc_max;
-
-		/* If an item doesn't have a rarity, move on */
-		if (!kind->alloc_prob) continue;
-
-		/* Go through all the dungeon levels */
-		for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+		tval = k_info[item].tval;
+		tval_kinds[tval_start[tval]++] = item;
+	}
+	for (tval = TV_MAX; tval > 0; tval--)
+		tval_start[tval] = tval_start[tval - 1];
+	tval_start[0] = 0;
+
+	/* Go through all the dungeon levels */
+	for (lev = 0; lev <= z_info->max_obj_depth; lev++) {
+		size_t ind = lev * k_max;
+		u32b total = 0, total_great = 0;
+
+		/* Running totals in kind order */
+		for (item = 0; item < k_max; item++) {
+			const struct object_kind *kind = &k_info[item];
 			int rarity = kind->alloc_prob;
 
 			/* Save the probability in the standard table */
-			if ((lev < min) || (lev > max)) rarity = 0;
-			obj_total[lev] += rarity;
-			obj_alloc[(lev * k_max) + item] = rarity;
+			if ((lev < kind->alloc_min) || (lev > kind->alloc_max)) rarity = 0;
+			total += rarity;
+			obj_alloc[ind + item] = total;
 
 			/* Save the probability in the "great" table if relevant */
-			if (!kind_is_good(kind)) rarity = 0;
-			obj_total_great[lev] += rarity;
-			obj_alloc_great[(lev * k_max) + item] = rarity;
+			if (rarity && kind_is_good(kind)) total_great += rarity;
+			obj_alloc_great[ind + item] = total_great;
+		}
+
+		/* Running totals which start again at each tval */
+		for (tval = 0; tval < TV_MAX; tval++) {
+			total = total_great = 0;
+			for (item = tval_start[tval]; item < tval_start[tval + 1]; item++) {
+				const struct object_kind *kind = &k_info[tval_kinds[item]];
+				int rarity = kind->alloc_prob;
+
+				if ((lev < kind->alloc_min) || (lev > kind->alloc_max))
+					rarity = 0;
+				total += rarity;
+				obj_alloc_tval[ind + item] = total;
+
+				if (rarity && kind_is_good(kind)) total_great += rarity;
+				obj_alloc_tval_great[ind + item] = total_great;
+			}
 		}
 	}
 }
@@ -149,6 +184,28 @@ static void alloc_init_egos(void) {
 
 	mem_free(level_total);
 	mem_free(num);
+
+	/* List the entries which can be applied to each kind */
+	kind_egos_start = mem_zalloc((z_info->k_max + 1) * sizeof(int));
+	for (i = 0; i < alloc_ego_size; i++) {
+		struct poss_item *poss;
+		for (poss = e_info[alloc_ego_table[i].index].poss_items; poss;
+			 poss = poss->next)
+			kind_egos_start[poss->kidx + 1]++;
+	}
+	for (i = 1; i <= z_info->k_max; i++)
+		kind_egos_start[i] += kind_egos_start[i - 1];
+	kind_egos = mem_zalloc(MAX(kind_egos_start[z_info->k_max], 1) *
+						   sizeof(s16b));
+	level_total = mem_zalloc(z_info->k_max * sizeof(int));
+	for (i = 0; i < alloc_ego_size; i++) {
+		struct poss_item *poss;
+		for (poss = e_info[alloc_ego_table[i].index].poss_items; poss;
+			 poss = poss->next)
+			kind_egos[kind_egos_start[poss->kidx] +
+					  level_total[poss->kidx]++] = i;
+	}
+	mem_free(level_total);
 }
 
 /*
@@ -187,13 +244,36 @@ static void cleanup_obj_make(void) {
 		string_free(money_type[i].name);
 	}
 	mem_free(money_type);
+	mem_free(kind_egos_start);
+	mem_free(kind_egos);
 	mem_free(alloc_ego_table);
-	mem_free(obj_total_great);
-	mem_free(obj_total);
+	mem_free(tval_start);
+	mem_free(tval_kinds);
+	mem_free(obj_alloc_tval_great);
+	mem_free(obj_alloc_tval);
 	mem_free(obj_alloc_great);
 	mem_free(obj_alloc);
 }
 
+/**
+ * Find the first of n running totals which is more than value, or n if there
+ * is none.
+ */
+static int alloc_search(const u32b *totals, int n, u32b value)
+{
+	int lo = 0, hi = n;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (value < totals[mid])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
 /*** Make an ego item ***/
 
 /**
@@ -289,6 +369,10 @@ static struct ego_item *ego_find_random(struct object *obj, int level)
 
 	alloc_entry *table = alloc_ego_table;
 
+	/* The egos which take this item */
+	const s16b *egos = kind_egos + kind_egos_start[obj->kind->kidx];
+	const s16b *egos_end = kind_egos + kind_egos_start[obj->kind->kidx + 1];
+
 	/* Go through all possible ego items and find ones which fit this item */
 	for (i = 0; i < alloc_ego_size; i++) {
 		struct ego_item *ego = &e_info[table[i].index];
@@ -299,13 +383,10 @@ static struct ego_item *ego_find_random(struct object *obj, int level)
 		if (level <= ego->alloc_max) {
 			int ood_chance = MAX(2, (ego->alloc_min - level) / 3);
 			if (level >= ego->alloc_min || one_in_(ood_chance)) {
-				struct poss_item *poss;
-
-				for (poss = ego->poss_items; poss; poss = poss->next)
-					if (poss->kidx == obj->kind->kidx) {
-						table[i].prob3 = table[i].prob2;
-						break;
-					}
+				while ((egos < egos_end) && (*egos < i))
+					egos++;
+				if ((egos < egos_end) && (*egos == i))
+					table[i].prob3 = table[i].prob2;
 
 				/* Total */
 				total += table[i].prob3;
@@ -509,6 +590,26 @@ void copy_artifact_data(struct object *obj, const struct artifact *art)
 }
 
 
+/**
+ * Find the kind an artifact is made from.  Like lookup_kind(), but only the
+ * kinds of the artifact's tval are searched.
+ */
+static struct object_kind *artifact_kind(const struct artifact *art)
+{
+	int item;
+
+	if ((art->tval <= 0) || (art->tval >= TV_MAX)) return NULL;
+
+	for (item = tval_start[art->tval]; item < tval_start[art->tval + 1];
+		 item++) {
+		struct object_kind *kind = &k_info[tval_kinds[item]];
+		if (kind->sval == art->sval)
+			return kind;
+	}
+
+	return NULL;
+}
+
 /**
  * Mega-Hack -- Attempt to create one of the "Special Objects".
  *
@@ -535,20 +636,21 @@ static struct object *make_artifact_special(int level)
 	/* Check the special artifacts */
 	for (i = 0; i < z_info->a_max; ++i) {
 		struct artifact *art = &a_info[i];
-		struct object_kind *kind = lookup_kind(art->tval, art->sval);
+		struct object_kind *kind;
 
 		/* Skip "empty" artifacts */
 		if (!art->name) continue;
 
+		/* Cannot make an artifact twice */
+		if (art->created) continue;
+
 		/* Make sure the kind was found */
+		kind = artifact_kind(art);
 		if (!kind) continue;
 
 		/* Skip non-special artifacts */
 		if (!kf_has(kind->kind_flags, KF_INSTA_ART)) continue;
 
-		/* Cannot make an artifact twice */
-		if (art->created) continue;
-
 		/* Enforce minimum "depth" (loosely) */
 		if (art->alloc_min > player->depth) {
 			/* Get the "out-of-depth factor" */
@@ -623,24 +725,20 @@ static bool make_artifact(struct object *obj)
 	/* Check the artifact list (skip the "specials") */
 	for (i = 0; !obj->artifact && i < z_info->a_max; i++) {
 		struct artifact *art = &a_info[i];
-		struct object_kind *kind = lookup_kind(art->tval, art->sval);
 
 		/* Skip "empty" items */
 		if (!art->name) continue;
 
-		/* Make sure the kind was found */
-		if (!kind) continue;
-
-		/* Skip special artifacts */
-		if (kf_has(kind->kind_flags, KF_INSTA_ART)) continue;
-
 		/* Cannot make an artifact twice */
 		if (art->created) continue;
 
-		/* Must have the correct fields */
+		/* Must have the correct fields, so the kind is the object's */
 		if (art->tval != obj->tval) continue;
 		if (art->sval != obj->sval) continue;
 
+		/* Skip special artifacts */
+		if (kf_has(obj->kind->kind_flags, KF_INSTA_ART)) continue;
+
 		/* XXX XXX Enforce minimum "depth" (loosely) */
 		if (art->alloc_min > player->depth)
 		{
@@ -1005,34 +1103,19 @@ bool kind_is_good(const struct object_kind *kind)
  */
 static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	/* The running totals for this tval at this dlev */
+	int start = tval_start[tval], n = tval_start[tval + 1] - start;
+	const u32b *totals = (good ? obj_alloc_tval_great : obj_alloc_tval) +
+		level * z_info->k_max + start;
 	u32b value;
-	int total = 0;
-	byte *objects = good ? obj_alloc_great : obj_alloc;
-
-	/* Pick an object */
-	ind = level * z_info->k_max;
-
-	/* Get new total */
-	for (item = 0; item < z_info->k_max; item++)
-		if (objkind_byid(item)->tval == tval)
-			total += objects[ind + item];
 
 	/* No appropriate items of that tval */
-	if (!total) return NULL;
-	
-	value = randint0(total);
-	
-	for (item = 0; item < z_info->k_max; item++)
-		if (objkind_byid(item)->tval == tval) {
-			if (value < objects[ind + item]) break;
-
-			value -= objects[ind + item];
-		}
+	if (!n || !totals[n - 1]) return NULL;
+
+	value = randint0(totals[n - 1]);
 
 	/* Return the item index */
-	return objkind_byid(item);
+	return objkind_byid(tval_kinds[start + alloc_search(totals, n, value)]);
 }
 
 /**
@@ -1042,8 +1125,7 @@ static struct object_kind *get_obj_num_by_kind(int level, bool good, int tval)
  */
 struct object_kind *get_obj_num(int level, bool good, int tval)
 {
-	/* This is the base index into obj_alloc for this dlev */
-	size_t ind, item;
+	const u32b *totals;
 	u32b value;
 
 	/* Occasional level boost */
@@ -1055,34 +1137,17 @@ struct object_kind *get_obj_num(int level, bool good, int tval)
 	level = MIN(level, z_info->max_obj_depth);
 	level = MAX(level, 0);
 
-	/* Pick an object */
-	ind = level * z_info->k_max;
-	
 	if (tval)
 		return get_obj_num_by_kind(level, good, tval);
-	
-	if (!good) {
-		value = randint0(obj_total[level]);
-		for (item = 0; item < z_info->k_max; item++) {
-			/* Found it */
-			if (value < obj_alloc[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc[ind + item];
-		}
-	} else {
-		value = randint0(obj_total_great[level]);
-		for (item = 0; item < z_info->k_max; item++) {
-			/* Found it */
-			if (value < obj_alloc_great[ind + item]) break;
-
-			/* Decrement */
-			value -= obj_alloc_great[ind + item];
-		}
-	}
+
+	/* The running totals for this dlev */
+	totals = (good ? obj_alloc_great : obj_alloc) + level * z_info->k_max;
+
+	/* Pick an object */
+	value = randint0(totals[z_info->k_max - 1]);
 
 	/* Return the item index */
-	return objkind_byid(item);
+	return objkind_byid(alloc_search(totals, z_info->k_max, value));
 }
 
 
@@ -119,6 +119,10 @@ void pile_integrity_fail(struct object *pile, struct object *obj, char *file,
 /**
  * Check the integrity of a linked - make sure it's not circular and that each
  * entry in the chain has consistent next and prev pointers.
+ *
+ * The prev check is enough to catch circularity: the first object reached a
+ * second time was already checked to have a different prev (or none, if it
+ * heads the pile), so the walk fails there rather than looping.
  */
 void pile_check_integrity(const char *op, struct object *pile, struct object *hilight)
 {
@@ -145,16 +149,6 @@ void pile_check_integrity(const char *op, struct object *pile, struct object *hi
 		prev = obj;
 		obj = obj->next;
 	};
-
-	/* Check for circularity */
-	for (obj = pile; obj; obj = obj->next) {
-		struct object *check;
-		for (check = obj->next; check; check = check->next) {
-			if (check->next == obj) {
-				pile_integrity_fail(pile, check, __FILE__, __LINE__);
-			}
-		}
-	}
 }
 
 /**
@@ -276,12 +270,54 @@ bool pile_contains(const struct object *top, const struct object *obj)
 	return false;
 }
 
+/**
+ * Objects come from slabs of OBJECT_SLAB_SIZE, and freed objects are kept
+ * on a list, linked through their next pointers, for reuse.  Slabs are only
+ * given back by object_pool_cleanup().
+ */
+#define OBJECT_SLAB_SIZE	256
+
+struct object_slab {
+	struct object_slab *next;
+	struct object objs[OBJECT_SLAB_SIZE];
+};
+
+static struct object_slab *object_slabs;
+static struct object *object_free_list;
+static struct object_pool_stats object_pool;
+
 /**
  * Create a new object and return it
  */
 struct object *object_new(void)
 {
-	return mem_zalloc(sizeof(struct object));
+	struct object *obj;
+
+	/* Get another slab if need be */
+	if (!object_free_list) {
+		int tag = mem_tag_set(MEM_TAG_OBJECT);
+		struct object_slab *slab = mem_zalloc(sizeof(*slab));
+		int i;
+
+		mem_tag_set(tag);
+		for (i = OBJECT_SLAB_SIZE - 1; i >= 0; i--) {
+			slab->objs[i].next = object_free_list;
+			object_free_list = &slab->objs[i];
+		}
+		slab->next = object_slabs;
+		object_slabs = slab;
+		object_pool.capacity += OBJECT_SLAB_SIZE;
+	}
+
+	obj = object_free_list;
+	object_free_list = obj->next;
+	memset(obj, 0, sizeof(*obj));
+
+	object_pool.live++;
+	if (object_pool.live > object_pool.high_water)
+		object_pool.high_water = object_pool.live;
+
+	return obj;
 }
 
 /**
@@ -291,10 +327,43 @@ struct object *object_new(void)
  */
 void object_free(struct object *obj)
 {
+	if (!obj) return;
+
 	mem_free(obj->slays);
 	mem_free(obj->brands);
 	mem_free(obj->curses);
-	mem_free(obj);
+
+	if (mem_flags & MEM_POISON_FREE)
+		memset(obj, 0xCD, sizeof(*obj));
+	obj->next = object_free_list;
+	object_free_list = obj;
+	object_pool.live--;
+}
+
+/**
+ * Report how the object pool is being used
+ */
+void object_pool_get_stats(struct object_pool_stats *stats)
+{
+	*stats = object_pool;
+}
+
+/**
+ * Give the object pool's memory back, if no objects are still in use
+ */
+void object_pool_cleanup(void)
+{
+	struct object_slab *slab, *next;
+
+	if (object_pool.live) return;
+
+	for (slab = object_slabs; slab; slab = next) {
+		next = slab->next;
+		mem_free(slab);
+	}
+	object_slabs = NULL;
+	object_free_list = NULL;
+	memset(&object_pool, 0, sizeof(object_pool));
 }
 
 /**
@@ -339,12 +408,16 @@ void object_delete(struct object **obj_address)
 
 	/* Remove from any lists */
 	if (player && player->cave && player->cave->objects && obj->oidx
-		&& (obj == player->cave->objects[obj->oidx]))
+		&& (obj == player->cave->objects[obj->oidx])) {
 		player->cave->objects[obj->oidx] = NULL;
+		object_slot_release(player->cave, obj->oidx);
+	}
 
 	if (cave && cave->objects && obj->oidx
-		&& (obj == cave->objects[obj->oidx]))
+		&& (obj == cave->objects[obj->oidx])) {
 		cave->objects[obj->oidx] = NULL;
+		object_slot_release(cave, obj->oidx);
+	}
 
 	object_free(obj);
 	*obj_address = NULL;
@@ -385,25 +458,29 @@ bool object_stackable(const struct object *obj1, const struct object *obj2,
 {
 	int i;
 
-	/* Equipment items don't stack */
-	if (object_is_equipped(player->body, obj1))
-		return false;
-	if (object_is_equipped(player->body, obj2))
-		return false;
-
-	/* If either item is unknown, do not stack */
-	if (mode & OSTACK_LIST && obj1->kind != obj1->known->kind) return false;
-	if (mode & OSTACK_LIST && obj2->kind != obj2->known->kind) return false;
-
 	/* Hack -- identical items cannot be stacked */
 	if (obj1 == obj2) return false;
 
-	/* Require identical object kinds */
+	/* Require identical object kinds; this turns most pairs away, so it
+	 * comes before the dearer checks */
 	if (obj1->kind != obj2->kind) return false;
 
+	/* Artifacts never stack */
+	if (obj1->artifact || obj2->artifact) return false;
+
 	/* Different flags don't stack */
 	if (!of_is_equal(obj1->flags, obj2->flags)) return false;
 
+	/* If either item is unknown, do not stack */
+	if (mode & OSTACK_LIST && obj1->kind != obj1->known->kind) return false;
+	if (mode & OSTACK_LIST && obj2->kind != obj2->known->kind) return false;
+
+	/* Equipment items don't stack */
+	if (object_is_equipped(player->body, obj1))
+		return false;
+	if (object_is_equipped(player->body, obj2))
+		return false;
+
 	/* Different elements don't stack */
 	for (i = 0; i < ELEM_MAX; i++) {
 		if (obj1->el_info[i].res_level != obj2->el_info[i].res_level)
@@ -413,9 +490,6 @@ bool object_stackable(const struct object *obj1, const struct object *obj2,
 			return false;
 	}
 
-	/* Artifacts never stack */
-	if (obj1->artifact || obj2->artifact) return false;
-
 	/* Analyze the items */
 	if (tval_is_chest(obj1)) {
 		/* Chests never stack */
@@ -625,6 +699,8 @@ void object_wipe(struct object *obj)
  */
 void object_copy(struct object *dest, const struct object *src)
 {
+	int tag = mem_tag_set(MEM_TAG_OBJECT);
+
 	/* Copy the structure */
 	memcpy(dest, src, sizeof(struct object));
 
@@ -645,6 +721,8 @@ void object_copy(struct object *dest, const struct object *src)
 	/* Detach from any pile */
 	dest->prev = NULL;
 	dest->next = NULL;
+
+	mem_tag_set(tag);
 }
 
 /**
@@ -831,6 +909,7 @@ bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool *note)
 		if (object_similar(obj, drop, OSTACK_FLOOR)) {
 			/* Combine the items */
 			object_absorb(obj, drop);
+			square_pile_changed(c, y, x);
 
 			/* Don't mention if ignored */
 			if (ignore_item_ok(obj)) {
@@ -866,6 +945,8 @@ bool floor_carry(struct chunk *c, int y, int x, struct object *drop, bool *note)
 
 	/* Link to the first object in the pile */
 	pile_insert(&c->squares[y][x].obj, drop);
+	c->fingerprint += square_fingerprint_obj(y, x, drop);
+	square_pile_changed(c, y, x);
 
 	/* Record in the level list */
 	list_object(c, drop);
@@ -935,13 +1016,13 @@ static void drop_find_grid(struct object *drop, int *y, int *x)
 			int num_ignored = 0;
 			int score;
 
-			/* Lots of reasons to say no */
+			/* Lots of reasons to say no (line of sight, the dearest, last) */
 			if ((dist > 10) ||
 				!square_in_bounds_fully(cave, ty, tx) ||
-				!los(cave, *y, *x, ty, tx) ||
 				!square_isfloor(cave, ty, tx) ||
 				square_isplayertrap(cave, ty, tx) ||
-				square_iswarded(cave, ty, tx))
+				square_iswarded(cave, ty, tx) ||
+				!los(cave, *y, *x, ty, tx))
 				continue;
 
 			/* Analyse the grid for carrying the new object */
@@ -1068,6 +1149,8 @@ void push_object(int y, int x)
 
 	bool glyph = square_iswarded(cave, y, x);
 
+	cave->fingerprint -= square_fingerprint_pile(cave, y, x);
+
 	/* Push all objects on the square, stripped of pile info, into the queue */
 	while (obj) {
 		struct object *next = obj->next;
@@ -1085,6 +1168,7 @@ void push_object(int y, int x)
 
 	/* Disassociate the objects from the square */
 	cave->squares[y][x].obj = NULL;
+	square_pile_changed(cave, y, x);
 
 	/* Set feature to an open door */
 	square_force_floor(cave, y, x);
@@ -1220,10 +1304,6 @@ int scan_items(struct object **item_list, size_t item_max, int mode,
 	bool use_quiver = ((mode & USE_QUIVER) ? true : false);
 	bool use_floor = ((mode & USE_FLOOR) ? true : false);
 
-	int floor_max = z_info->floor_size;
-	struct object **floor_list = mem_zalloc(floor_max * sizeof(struct object *));
-	int floor_num;
-
 	int i;
 	size_t item_num = 0;
 
@@ -1245,17 +1325,14 @@ int scan_items(struct object **item_list, size_t item_max, int mode,
 				item_list[item_num++] = player->upkeep->quiver[i];
 		}
 
-	/* Scan all non-gold objects in the grid */
-	if (use_floor) {
-		floor_num = scan_floor(floor_list, floor_max,
+	/* Scan all non-gold objects in the grid straight into the list */
+	if (use_floor && item_num < item_max) {
+		int floor_max = MIN(z_info->floor_size, (int)(item_max - item_num));
+		item_num += scan_floor(item_list + item_num, floor_max,
 							   OFLOOR_TEST | OFLOOR_SENSE | OFLOOR_VISIBLE,
 							   tester);
-
-		for (i = 0; i < floor_num && item_num < item_max; i++)
-			item_list[item_num++] = floor_list[i];
 	}
 
-	mem_free(floor_list);
 	return item_num;
 }
 
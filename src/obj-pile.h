@@ -36,6 +36,15 @@ typedef enum
 	OSTACK_QUIVER  = 0x20  /* Quiver */
 } object_stack_t;
 
+/**
+ * Usage of the pool struct objects come from
+ */
+struct object_pool_stats {
+	int live;			/* Objects in use */
+	int high_water;		/* Most objects in use at once */
+	int capacity;		/* Objects the pool has room for */
+};
+
 /**
  * Modes for floor scanning by scan_floor()
  */
@@ -50,6 +59,8 @@ typedef enum
 
 struct object *object_new(void);
 void object_free(struct object *obj);
+void object_pool_get_stats(struct object_pool_stats *stats);
+void object_pool_cleanup(void);
 void object_delete(struct object **obj_address);
 void object_pile_free(struct object *obj);
 
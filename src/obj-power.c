@@ -39,9 +39,16 @@ static ang_file *object_log;
 /**
  * Log progress info to the object log
  */
-void log_obj(char *message)
+static void log_obj(const char *fmt, ...)
 {
-	file_putf(object_log, message);
+	va_list vp;
+
+	/* Don't format anything if nothing is being logged */
+	if (!object_log) return;
+
+	va_start(vp, fmt);
+	file_vputf(object_log, fmt, vp);
+	va_end(vp);
 }
 
 /**
@@ -54,6 +61,9 @@ static int num_slays;
 static int num_kills;
 static int best_power;
 static int iter;
+static bitflag sust_mask[OF_SIZE];
+static bitflag prot_mask[OF_SIZE];
+static bitflag misc_mask[OF_SIZE];
 
 static int object_power_calculation_TO_DAM(void)
 {
@@ -241,52 +251,40 @@ static int object_power_calculation_FLAG_TYPE_MULT(void)
 static int object_power_calculation_NUM_SUSTAINS(void)
 {
 	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_SUST, OFT_MAX);
+	of_copy(f, sust_mask);
 	of_inter(f, power_obj->flags);
 	return of_count(f) > 1 ? of_count(f) : 0;
 }
 
 static int object_power_calculation_ALL_SUSTAINS(void)
 {
-	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_SUST, OFT_MAX);
-	return of_is_subset(power_obj->flags, f) ? 1 : 0;
+	return of_is_subset(power_obj->flags, sust_mask) ? 1 : 0;
 }
 
 static int object_power_calculation_NUM_PROTECTS(void)
 {
 	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_PROT, OFT_MAX);
+	of_copy(f, prot_mask);
 	of_inter(f, power_obj->flags);
 	return of_count(f) > 1 ? of_count(f) : 0;
 }
 
 static int object_power_calculation_ALL_PROTECTS(void)
 {
-	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_PROT, OFT_MAX);
-	return of_is_subset(power_obj->flags, f) ? 1 : 0;
+	return of_is_subset(power_obj->flags, prot_mask) ? 1 : 0;
 }
 
 static int object_power_calculation_NUM_MISC(void)
 {
 	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_MISC, OFT_MAX);
+	of_copy(f, misc_mask);
 	of_inter(f, power_obj->flags);
 	return of_count(f) > 1 ? of_count(f) : 0;
 }
 
 static int object_power_calculation_ALL_MISC(void)
 {
-	bitflag f[OF_SIZE];
-	of_wipe(f);
-	create_obj_flag_mask(f, false, OFT_MISC, OFT_MAX);
-	return of_is_subset(power_obj->flags, f) ? 1 : 0;
+	return of_is_subset(power_obj->flags, misc_mask) ? 1 : 0;
 }
 
 static int object_power_calculation_IGNORE(void)
@@ -411,6 +409,17 @@ static int object_power_calculation_EFFECT_POWER(void)
 	return power_obj->kind->power;
 }
 
+/**
+ * Build the flag type masks the calculations use, once the object
+ * properties are known
+ */
+void power_calculation_masks_init(void)
+{
+	create_obj_flag_mask(sust_mask, false, OFT_SUST, OFT_MAX);
+	create_obj_flag_mask(prot_mask, false, OFT_PROT, OFT_MAX);
+	create_obj_flag_mask(misc_mask, false, OFT_MISC, OFT_MAX);
+}
+
 expression_base_value_f power_calculation_by_name(const char *name)
 {
 	static const struct power_calc_s {
@@ -584,7 +593,7 @@ static void collect_slay_brand_stats(const struct object *obj)
 			for (i = 1; i < z_info->brand_max; i++) {
 				if (obj->brands[i]) {
 					struct brand *b = &brands[i];
-					log_obj(format("%sx%d ", b->name, b->multiplier));
+					log_obj("%sx%d ", b->name, b->multiplier);
 				}
 			}
 		}
@@ -592,11 +601,11 @@ static void collect_slay_brand_stats(const struct object *obj)
 			for (i = 1; i < z_info->slay_max; i++) {
 				if (obj->slays[i]) {
 					struct slay *s = &slays[i];
-					log_obj(format("%sx%d ", s->name, s->multiplier));
+					log_obj("%sx%d ", s->name, s->multiplier);
 				}
 			}
 		}
-		log_obj(format("\nbest power is : %d\n", best_power));
+		log_obj("\nbest power is : %d\n", best_power);
 	}
 }
 
@@ -607,6 +616,8 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 {
 	int i;
 	int **current_value;
+	int *values;
+	int num_values = 0;
 	int power = 0;
 
 	/* Set the log file */
@@ -616,12 +627,16 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 	power_obj = (struct object *) obj;
 	collect_slay_brand_stats(obj);
 
-	/* Set up arrays for each power calculation (most of them length 1) */
-	current_value = mem_zalloc(z_info->calculation_max * sizeof(int*));
+	/* Set up arrays for each power calculation (most of them length 1),
+	 * carved out of one block */
+	for (i = 0; i < z_info->calculation_max; i++)
+		num_values += calculations[i].iterate.max;
+	current_value = mem_zalloc(z_info->calculation_max * sizeof(int*) +
+							   num_values * sizeof(int));
+	values = (int *) (current_value + z_info->calculation_max);
 	for (i = 0; i < z_info->calculation_max; i++) {
-		struct power_calc *calc = &calculations[i];
-
-		current_value[i] = mem_zalloc(calc->iterate.max * sizeof(int));
+		current_value[i] = values;
+		values += calculations[i].iterate.max;
 	}
 
 	/* Preprocess the power calculations for intermediate results */
@@ -646,8 +661,8 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 
 			/* Ignore this calculation if no name found, otherwise apply it */
 			if (i == j) {
-				log_obj(format("No target %s for %s to apply to\n",
-							   calc->apply_to, calc->name));
+				log_obj("No target %s for %s to apply to\n",
+						calc->apply_to, calc->name);
 			} else {
 				if ((calculations[j].iterate.max == 1) &&
 					(calc->iterate.max > 1)) {
@@ -663,8 +678,8 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 								 current_value[i][iter]);
 					}
 				} else {
-					log_obj(format("Size mismatch applying %s to %s\n",
-								   calc->name, calculations[j].name));
+					log_obj("Size mismatch applying %s to %s\n",
+							calc->name, calculations[j].name);
 				}
 			}
 		}
@@ -693,19 +708,19 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 			}
 
 			/* Report result if there's a change in power */
-			if (power != old_power) {
+			if (object_log && (power != old_power)) {
 				if (calc->iterate.max == 1) {
-					log_obj(format("%s is %d, power is %d\n", calc->name,
-								   power - old_power, power));
+					log_obj("%s is %d, power is %d\n", calc->name,
+							power - old_power, power);
 				} else {
 					for (iter = flg ? 1 : 0; iter < calc->iterate.max; iter++) {
 						struct obj_property *prop;
 						prop = lookup_obj_property(type, iter);
 						if (current_value[i][iter] != 0) {
 							old_power += current_value[i][iter];
-							log_obj(format("%d for %s, power is %d\n",
-										   current_value[i][iter], prop->name,
-										   old_power));
+							log_obj("%d for %s, power is %d\n",
+									current_value[i][iter], prop->name,
+									old_power);
 						}
 					}
 				}
@@ -714,9 +729,6 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 	}
 
 	/* Free the current value arrays */
-	for (i = 0; i < z_info->calculation_max; i++) {
-		mem_free(current_value[i]);
-	}
 	mem_free(current_value);
 
 	/* Deal with curse power */
@@ -729,15 +741,15 @@ int object_power(const struct object* obj, bool verbose, ang_file *log_file)
 				curse_power += object_power(curses[i].obj, verbose, log_file);
 				curse_power -= obj->curses[i].power / 10;
 				power += curse_power;
-				log_obj(format("%d for %s curse power, power is %d\n",
-							   curse_power, curses[i].name, power));
+				log_obj("%d for %s curse power, power is %d\n",
+						curse_power, curses[i].name, power);
 			}
 		}
 	}
 
 
 	if (obj->kind != curse_object_kind)
-		log_obj(format("FINAL POWER IS %d\n", power));
+		log_obj("FINAL POWER IS %d\n", power);
 	return power;
 }
 
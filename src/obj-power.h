@@ -73,6 +73,7 @@ extern struct power_calc *calculations;
 /*** Functions ***/
 
 extern expression_base_value_f power_calculation_by_name(const char *name);
+void power_calculation_masks_init(void);
 
 int object_power(const struct object *obj, bool verbose, ang_file *log_file);
 int object_value_real(const struct object *obj, int qty);
@@ -21,11 +21,71 @@
 
 struct obj_property *obj_properties;
 
+/**
+ * Each property by type and index, so lookups don't have to scan the list
+ */
+static struct obj_property **property_index[OBJ_PROPERTY_MAX];
+static int property_index_size;
+
+/**
+ * Build the lookup table for lookup_obj_property(), once the properties
+ * have been read
+ */
+void index_obj_properties(void)
+{
+	int i, type;
+
+	/* Make room for the largest index */
+	property_index_size = 0;
+	for (i = 0; i < z_info->property_max; i++)
+		property_index_size = MAX(property_index_size,
+								  obj_properties[i].index + 1);
+	for (type = 0; type < OBJ_PROPERTY_MAX; type++)
+		property_index[type] = mem_zalloc(property_index_size *
+										  sizeof(struct obj_property *));
+
+	/* The first property to match wins, as it would in the list */
+	for (i = 0; i < z_info->property_max; i++) {
+		struct obj_property *prop = &obj_properties[i];
+
+		if (prop->type < 0 || prop->type >= OBJ_PROPERTY_MAX || prop->index < 0)
+			continue;
+		if (!property_index[prop->type][prop->index])
+			property_index[prop->type][prop->index] = prop;
+
+		/* Special case - stats count as mods */
+		if ((prop->type == OBJ_PROPERTY_STAT) &&
+			!property_index[OBJ_PROPERTY_MOD][prop->index])
+			property_index[OBJ_PROPERTY_MOD][prop->index] = prop;
+	}
+}
+
+/**
+ * Free the lookup table
+ */
+void free_obj_property_index(void)
+{
+	int type;
+
+	for (type = 0; type < OBJ_PROPERTY_MAX; type++) {
+		mem_free(property_index[type]);
+		property_index[type] = NULL;
+	}
+	property_index_size = 0;
+}
+
 struct obj_property *lookup_obj_property(int type, int index)
 {
 	struct obj_property *prop;
 	int i;
 
+	/* Use the lookup table if there is one */
+	if ((type >= 0) && (type < OBJ_PROPERTY_MAX) && property_index[type]) {
+		if ((index < 0) || (index >= property_index_size))
+			return NULL;
+		return property_index[type][index];
+	}
+
 	/* Find the right property */
 	for (i = 0; i < z_info->property_max; i++) {
 		prop = &obj_properties[i];
@@ -187,6 +187,8 @@ extern struct obj_property *obj_properties;
  * ------------------------------------------------------------------------
  * Functions
  * ------------------------------------------------------------------------ */
+void index_obj_properties(void);
+void free_obj_property_index(void);
 struct obj_property *lookup_obj_property(int type, int index);
 void create_obj_flag_mask(bitflag *f, bool id, ...);
 void flag_message(int flag, char *name);
@@ -443,13 +443,13 @@ int lookup_sval(int tval, const char *name)
 		struct object_kind *kind = &k_info[k];
 		char cmp_name[1024];
 
-		if (!kind || !kind->name) continue;
+		if (!kind || !kind->name || kind->tval != tval) continue;
 
 		obj_desc_name_format(cmp_name, sizeof cmp_name, 0, kind->name, 0,
 							 false);
 
 		/* Found a match */
-		if (kind->tval == tval && !my_stricmp(cmp_name, name))
+		if (!my_stricmp(cmp_name, name))
 			return kind->sval;
 	}
 
@@ -809,14 +809,14 @@ int number_charging(const struct object *obj)
 {
 	int charge_time, num_charging;
 
+	/* No items are charging; this is most objects, so check it first */
+	if (obj->timeout <= 0) return 0;
+
 	charge_time = randcalc(obj->time, 0, AVERAGE);
 
 	/* Item has no timeout */
 	if (charge_time <= 0) return 0;
 
-	/* No items are charging */
-	if (obj->timeout <= 0) return 0;
-
 	/* Calculate number charging based on timeout */
 	num_charging = (obj->timeout + charge_time - 1) / charge_time;
 
@@ -52,6 +52,7 @@ enum {
 struct effect {
 	struct effect *next;
 	u16b index;		/**< The effect index */
+	bool packed;	/**< Part of one block with the rest of its chain */
 	dice_t *dice;	/**< Dice expression used in the effect */
 	int params[3];	/**< Extra parameters to be passed to the handler */
 };
@@ -401,8 +402,8 @@ struct object {
 
 	u16b oidx;				/**< Item list index, if any */
 
-	byte iy;				/**< Y-position on map, or zero */
-	byte ix;				/**< X-position on map, or zero */
+	s16b iy;				/**< Y-position on map, or zero */
+	s16b ix;				/**< X-position on map, or zero */
 
 	byte tval;				/**< Item type (from kind) */
 	byte sval;				/**< Item sub-type (from kind) */
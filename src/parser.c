@@ -71,43 +71,88 @@ struct parser_hook {
 	struct parser_spec *ftail;
 };
 
+/**
+ * Hooks are kept on a list (for freeing) and also in an open-addressed hash
+ * table keyed by directive, which holds the current hook for each directive.
+ * Value nodes from previous lines are kept on a free list for reuse, and
+ * each line is tokenised in a buffer owned by the parser, which symbol and
+ * string values point into; both therefore only live until the next line.
+ */
 struct parser {
 	enum parser_error error;
 	unsigned int lineno;
 	unsigned int colno;
 	char errmsg[1024];
 	struct parser_hook *hooks;
+	struct parser_hook **htable;
+	size_t hsize;
+	size_t nhooks;
 	struct parser_value *fhead;
 	struct parser_value *ftail;
+	struct parser_value *vfree;
+	char *line;
+	size_t line_size;
 	void *priv;
 };
 
+#define PARSER_HTABLE_INIT	32
+
 /**
  * Allocates a new parser.
  */
 struct parser *parser_new(void) {
 	struct parser *p = mem_zalloc(sizeof *p);
+	p->hsize = PARSER_HTABLE_INIT;
+	p->htable = mem_zalloc(p->hsize * sizeof(*p->htable));
 	return p;
 }
 
-static struct parser_hook *findhook(struct parser *p, const char *dir) {
-	struct parser_hook *h = p->hooks;
-	while (h) {
-		if (!strcmp(h->dir, dir))
-			break;
-		h = h->next;
+/**
+ * Find the hash table slot for directive `dir`, or the empty slot where it
+ * would go.
+ */
+static size_t hook_slot(struct parser *p, const char *dir) {
+	size_t mask = p->hsize - 1;
+	size_t i = djb2_hash(dir) & mask;
+	while (p->htable[i] && strcmp(p->htable[i]->dir, dir))
+		i = (i + 1) & mask;
+	return i;
+}
+
+/**
+ * Add a hook to the hash table, superseding any with the same directive.
+ */
+static void hook_insert(struct parser *p, struct parser_hook *h) {
+	size_t i = hook_slot(p, h->dir);
+
+	if (!p->htable[i])
+		p->nhooks++;
+	p->htable[i] = h;
+
+	/* Keep the table at most half full */
+	if (p->nhooks * 2 > p->hsize) {
+		struct parser_hook **old = p->htable;
+		size_t oldsize = p->hsize, j;
+
+		p->hsize *= 2;
+		p->htable = mem_zalloc(p->hsize * sizeof(*p->htable));
+		for (j = 0; j < oldsize; j++)
+			if (old[j])
+				p->htable[hook_slot(p, old[j]->dir)] = old[j];
+		mem_free(old);
 	}
-	return h;
+}
+
+static struct parser_hook *findhook(struct parser *p, const char *dir) {
+	return p->htable[hook_slot(p, dir)];
 }
 
 static void parser_freeold(struct parser *p) {
 	struct parser_value *v;
 	while (p->fhead) {
-		int t = p->fhead->spec.type & ~PARSE_T_OPT;
 		v = (struct parser_value *)p->fhead->spec.next;
-		if (t == PARSE_T_SYM || t == PARSE_T_STR)
-			mem_free(p->fhead->u.sval);
-		mem_free(p->fhead);
+		p->fhead->spec.next = (struct parser_spec *)p->vfree;
+		p->vfree = p->fhead;
 		p->fhead = v;
 	}
 }
@@ -204,6 +249,7 @@ static bool parse_random(const char *str, random_value *bonus) {
  */
 enum parser_error parser_parse(struct parser *p, const char *line) {
 	char *cline;
+	size_t len;
 	char *tok;
 	struct parser_hook *h;
 	struct parser_spec *s;
@@ -226,11 +272,17 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!*line || *line == '#')
 		return PARSE_ERROR_NONE;
 
-	cline = string_make(line);
+	/* Copy the line into the parser's buffer, growing it as needed */
+	len = strlen(line) + 1;
+	if (len > p->line_size) {
+		p->line_size = MAX(len, 2 * p->line_size);
+		p->line = mem_realloc(p->line, p->line_size);
+	}
+	cline = p->line;
+	memcpy(cline, line, len);
 
 	tok = strtok(cline, ":");
 	if (!tok) {
-		mem_free(cline);
 		p->error = PARSE_ERROR_MISSING_FIELD;
 		return PARSE_ERROR_MISSING_FIELD;
 	}
@@ -239,7 +291,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 	if (!h) {
 		my_strcpy(p->errmsg, tok, sizeof(p->errmsg));
 		p->error = PARSE_ERROR_UNDEFINED_DIRECTIVE;
-		mem_free(cline);
 		return PARSE_ERROR_UNDEFINED_DIRECTIVE;
 	}
 
@@ -269,14 +320,18 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			if (!(s->type & PARSE_T_OPT)) {
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_MISSING_FIELD;
-				mem_free(cline);
 				return PARSE_ERROR_MISSING_FIELD;
 			}
 			break;
 		}
 
-		/* Allocate a value node. */
-		v = mem_alloc(sizeof *v);
+		/* Allocate a value node, reusing one from an earlier line if we can. */
+		if (p->vfree) {
+			v = p->vfree;
+			p->vfree = (struct parser_value *)v->spec.next;
+		} else {
+			v = mem_alloc(sizeof *v);
+		}
 		v->spec.next = NULL;
 		v->spec.type = s->type;
 		v->spec.name = s->name;
@@ -287,7 +342,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			v->u.ival = strtol(tok, &z, 0);
 			if (z == tok) {
 				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -297,7 +351,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 			v->u.uval = strtoul(tok, &z, 0);
 			if (z == tok || *tok == '-') {
 				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_NUMBER;
 				return PARSE_ERROR_NOT_NUMBER;
@@ -305,11 +358,10 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		} else if (t == PARSE_T_CHAR) {
 			text_mbstowcs(&v->u.cval, tok, 1);
 		} else if (t == PARSE_T_SYM || t == PARSE_T_STR) {
-			v->u.sval = string_make(tok);
+			v->u.sval = tok;
 		} else if (t == PARSE_T_RAND) {
 			if (!parse_random(tok, &v->u.rval)) {
 				mem_free(v);
-				mem_free(cline);
 				my_strcpy(p->errmsg, s->name, sizeof(p->errmsg));
 				p->error = PARSE_ERROR_NOT_RANDOM;
 				return PARSE_ERROR_NOT_RANDOM;
@@ -324,8 +376,6 @@ enum parser_error parser_parse(struct parser *p, const char *line) {
 		p->ftail = v;
 	}
 
-	mem_free(cline);
-
 	p->error = h->func(p);
 	return p->error;
 }
@@ -390,6 +440,13 @@ void parser_destroy(struct parser *p) {
 		mem_free(p->hooks);
 		p->hooks = h;
 	}
+	while (p->vfree) {
+		struct parser_value *v = p->vfree;
+		p->vfree = (struct parser_value *)v->spec.next;
+		mem_free(v);
+	}
+	mem_free(p->line);
+	mem_free(p->htable);
 	mem_free(p);
 }
 
@@ -488,6 +545,7 @@ errr parser_reg(struct parser *p, const char *fmt,
 	}
 
 	p->hooks = h;
+	hook_insert(p, h);
 	mem_free(cfmt);
 	return 0;
 }
@@ -443,6 +443,7 @@ void py_attack(struct player *p, int y, int x)
 	int blows = 0;
 	bool fear = false;
 	struct monster *mon = square_monster(cave, y, x);
+	int rng = Rand_stream(RNG_COMBAT);
 	
 	/* disturb the player */
 	disturb(p, 0);
@@ -464,6 +465,8 @@ void py_attack(struct player *p, int y, int x)
 	if (fear && monster_is_visible(mon)) {
 		add_monster_message(mon, MON_MSG_FLEE_IN_TERROR, true);
 	}
+
+	Rand_stream(rng);
 }
 
 /* Shooting hit types */
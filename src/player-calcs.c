@@ -37,6 +37,7 @@
 #include "player-spell.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "profile.h"
 
 /**
  * Stat Table (INT) -- Magic devices
@@ -1664,6 +1665,193 @@ int weight_remaining(struct player *p)
 }
 
 
+/**
+ * What one equipment slot, with the curses on its object, adds to the
+ * player's state
+ */
+struct gear_bonus {
+	const struct object *obj;	/* The object this was worked out for */
+	bool valid;
+
+	bitflag flags[OF_SIZE];
+	int stat_add[STAT_MAX];
+	int stealth;
+	int search;
+	int digging;
+	int infra;
+	int speed;
+	int blows;
+	int shots;
+	int might;
+	int res_level[ELEM_MAX];
+	bool vuln;
+	int ac;
+	int to_a;
+	int to_h;
+	int to_d;
+};
+
+/**
+ * Work out what the object in slot `slot` and its curses add to the state
+ */
+static void calc_gear_bonus(struct player *p, int slot, bool known_only,
+							struct gear_bonus *b)
+{
+	int j;
+	int dig = 0;
+	int index = 0;
+	struct object *obj = slot_object(p, slot);
+	struct curse_data *curse = obj ? obj->curses : NULL;
+	bitflag f[OF_SIZE];
+
+	memset(b, 0, sizeof(*b));
+	b->obj = obj;
+
+	while (obj) {
+		/* Extract the item flags */
+		if (known_only) {
+			object_flags_known(obj, f);
+		} else {
+			object_flags(obj, f);
+		}
+		of_union(b->flags, f);
+
+		/* Apply modifiers */
+		b->stat_add[STAT_STR] += obj->modifiers[OBJ_MOD_STR]
+			* p->obj_k->modifiers[OBJ_MOD_STR];
+		b->stat_add[STAT_INT] += obj->modifiers[OBJ_MOD_INT]
+			* p->obj_k->modifiers[OBJ_MOD_INT];
+		b->stat_add[STAT_WIS] += obj->modifiers[OBJ_MOD_WIS]
+			* p->obj_k->modifiers[OBJ_MOD_WIS];
+		b->stat_add[STAT_DEX] += obj->modifiers[OBJ_MOD_DEX]
+			* p->obj_k->modifiers[OBJ_MOD_DEX];
+		b->stat_add[STAT_CON] += obj->modifiers[OBJ_MOD_CON]
+			* p->obj_k->modifiers[OBJ_MOD_CON];
+		b->stealth += obj->modifiers[OBJ_MOD_STEALTH]
+			* p->obj_k->modifiers[OBJ_MOD_STEALTH];
+		b->search += (obj->modifiers[OBJ_MOD_SEARCH] * 5)
+			* p->obj_k->modifiers[OBJ_MOD_SEARCH];
+
+		b->infra += obj->modifiers[OBJ_MOD_INFRA]
+			* p->obj_k->modifiers[OBJ_MOD_INFRA];
+		if (tval_is_digger(obj)) {
+			if (of_has(obj->flags, OF_DIG_1))
+				dig = 1;
+			else if (of_has(obj->flags, OF_DIG_2))
+				dig = 2;
+			else if (of_has(obj->flags, OF_DIG_3))
+				dig = 3;
+		}
+		dig += obj->modifiers[OBJ_MOD_TUNNEL]
+			* p->obj_k->modifiers[OBJ_MOD_TUNNEL];
+		b->digging += (dig * 20);
+		b->speed += obj->modifiers[OBJ_MOD_SPEED]
+			* p->obj_k->modifiers[OBJ_MOD_SPEED];
+		b->blows += obj->modifiers[OBJ_MOD_BLOWS]
+			* p->obj_k->modifiers[OBJ_MOD_BLOWS];
+		b->shots += obj->modifiers[OBJ_MOD_SHOTS]
+			* p->obj_k->modifiers[OBJ_MOD_SHOTS];
+		b->might += obj->modifiers[OBJ_MOD_MIGHT]
+			* p->obj_k->modifiers[OBJ_MOD_MIGHT];
+
+		/* Apply element info, noting vulnerabilites for later processing */
+		for (j = 0; j < ELEM_MAX; j++) {
+			if (!known_only || obj->known->el_info[j].res_level) {
+				if (obj->el_info[j].res_level == -1)
+					b->vuln = true;
+
+				/* OK because res_level hasn't included vulnerability yet */
+				if (obj->el_info[j].res_level > b->res_level[j])
+					b->res_level[j] = obj->el_info[j].res_level;
+			}
+		}
+
+		/* Apply combat bonuses */
+		b->ac += obj->ac;
+		if (!known_only || obj->known->to_a)
+			b->to_a += obj->to_a;
+		if (!slot_type_is(slot, EQUIP_WEAPON) && !slot_type_is(slot, EQUIP_BOW)) {
+			if (!known_only || obj->known->to_h) {
+				b->to_h += obj->to_h;
+			}
+			if (!known_only || obj->known->to_d) {
+				b->to_d += obj->to_d;
+			}
+		}
+
+		/* Move to any unprocessed curse object */
+		if (curse) {
+			index++;
+			obj = NULL;
+			while (index < z_info->curse_max) {
+				if (curse[index].power) {
+					obj = curses[index].obj;
+					break;
+				} else {
+					index++;
+				}
+			}
+		} else {
+			obj = NULL;
+		}
+	}
+
+	b->valid = true;
+}
+
+/**
+ * Get what a slot adds to the state, from the cache where it is still good.
+ *
+ * The cache holds the real then the known bonuses for each slot, and is
+ * forgotten whenever PU_BONUS is processed; PU_STATE, for timed effects and
+ * stats, keeps it.  Hypothetical states (update false) read the cache but
+ * work anything else out in `fresh` without storing it, so a pretend
+ * wielded object never gets in.
+ */
+static const struct gear_bonus *gear_bonus_get(struct player *p, int slot,
+											   bool known_only, bool update,
+											   struct gear_bonus *fresh)
+{
+	struct player_upkeep *upkeep = p->upkeep;
+	struct gear_bonus *b;
+
+	/* Gear changes are pending */
+	if (upkeep->update & PU_BONUS) {
+		calc_gear_bonus(p, slot, known_only, fresh);
+		return fresh;
+	}
+
+	if (upkeep->gear_bonus_slots != p->body.count) {
+		mem_free(upkeep->gear_bonus);
+		upkeep->gear_bonus = mem_zalloc(2 * p->body.count *
+										sizeof(*upkeep->gear_bonus));
+		upkeep->gear_bonus_slots = p->body.count;
+	}
+
+	b = &upkeep->gear_bonus[2 * slot + (known_only ? 1 : 0)];
+	if (b->valid && b->obj == slot_object(p, slot))
+		return b;
+
+	if (!update) {
+		calc_gear_bonus(p, slot, known_only, fresh);
+		return fresh;
+	}
+
+	calc_gear_bonus(p, slot, known_only, b);
+	return b;
+}
+
+/**
+ * Forget all cached slot bonuses, after the gear or knowledge of it changes
+ */
+static void forget_gear_bonuses(struct player *p)
+{
+	int i;
+
+	for (i = 0; i < 2 * p->upkeep->gear_bonus_slots; i++)
+		p->upkeep->gear_bonus[i].valid = false;
+}
+
 /**
  * Calculate the players current "state", taking into account
  * not only race/class intrinsics, but also objects being worn
@@ -1695,7 +1883,6 @@ void calc_bonuses(struct player *p, struct player_state *state, bool known_only,
 	int extra_might = 0;
 	struct object *launcher = equipped_item_by_slot_name(p, "shooting");
 	struct object *weapon = equipped_item_by_slot_name(p, "weapon");
-	bitflag f[OF_SIZE];
 	bitflag collect_f[OF_SIZE];
 	bool vuln[ELEM_MAX];
 
@@ -1733,99 +1920,34 @@ void calc_bonuses(struct player *p, struct player_state *state, bool known_only,
 
 	/* Analyze equipment */
 	for (i = 0; i < p->body.count; i++) {
-		int dig = 0;
-		int index = 0;
-		struct object *obj = slot_object(p, i);
-		struct curse_data *curse = obj ? obj->curses : NULL;
-
-		while (obj) {
-			/* Extract the item flags */
-			if (known_only) {
-				object_flags_known(obj, f);
-			} else {
-				object_flags(obj, f);
-			}
-			of_union(collect_f, f);
-
-			/* Apply modifiers */
-			state->stat_add[STAT_STR] += obj->modifiers[OBJ_MOD_STR]
-				* p->obj_k->modifiers[OBJ_MOD_STR];
-			state->stat_add[STAT_INT] += obj->modifiers[OBJ_MOD_INT]
-				* p->obj_k->modifiers[OBJ_MOD_INT];
-			state->stat_add[STAT_WIS] += obj->modifiers[OBJ_MOD_WIS]
-				* p->obj_k->modifiers[OBJ_MOD_WIS];
-			state->stat_add[STAT_DEX] += obj->modifiers[OBJ_MOD_DEX]
-				* p->obj_k->modifiers[OBJ_MOD_DEX];
-			state->stat_add[STAT_CON] += obj->modifiers[OBJ_MOD_CON]
-				* p->obj_k->modifiers[OBJ_MOD_CON];
-			state->skills[SKILL_STEALTH] += obj->modifiers[OBJ_MOD_STEALTH]
-				* p->obj_k->modifiers[OBJ_MOD_STEALTH];
-			state->skills[SKILL_SEARCH] += (obj->modifiers[OBJ_MOD_SEARCH] * 5)
-				* p->obj_k->modifiers[OBJ_MOD_SEARCH];
-
-			state->see_infra += obj->modifiers[OBJ_MOD_INFRA]
-				* p->obj_k->modifiers[OBJ_MOD_INFRA];
-			if (tval_is_digger(obj)) {
-				if (of_has(obj->flags, OF_DIG_1))
-					dig = 1;
-				else if (of_has(obj->flags, OF_DIG_2))
-					dig = 2;
-				else if (of_has(obj->flags, OF_DIG_3))
-					dig = 3;
-			}
-			dig += obj->modifiers[OBJ_MOD_TUNNEL]
-				* p->obj_k->modifiers[OBJ_MOD_TUNNEL];
-			state->skills[SKILL_DIGGING] += (dig * 20);
-			state->speed += obj->modifiers[OBJ_MOD_SPEED]
-				* p->obj_k->modifiers[OBJ_MOD_SPEED];
-			extra_blows += obj->modifiers[OBJ_MOD_BLOWS]
-				* p->obj_k->modifiers[OBJ_MOD_BLOWS];
-			extra_shots += obj->modifiers[OBJ_MOD_SHOTS]
-				* p->obj_k->modifiers[OBJ_MOD_SHOTS];
-			extra_might += obj->modifiers[OBJ_MOD_MIGHT]
-				* p->obj_k->modifiers[OBJ_MOD_MIGHT];
-
-			/* Apply element info, noting vulnerabilites for later processing */
-			for (j = 0; j < ELEM_MAX; j++) {
-				if (!known_only || obj->known->el_info[j].res_level) {
-					if (obj->el_info[j].res_level == -1)
-						vuln[i] = true;
-
-					/* OK because res_level hasn't included vulnerability yet */
-					if (obj->el_info[j].res_level > state->el_info[j].res_level)
-						state->el_info[j].res_level = obj->el_info[j].res_level;
-				}
-			}
-
-			/* Apply combat bonuses */
-			state->ac += obj->ac;
-			if (!known_only || obj->known->to_a)
-				state->to_a += obj->to_a;
-			if (!slot_type_is(i, EQUIP_WEAPON) && !slot_type_is(i, EQUIP_BOW)) {
-				if (!known_only || obj->known->to_h) {
-					state->to_h += obj->to_h;
-				}
-				if (!known_only || obj->known->to_d) {
-					state->to_d += obj->to_d;
-				}
-			}
+		struct gear_bonus fresh;
+		const struct gear_bonus *b = gear_bonus_get(p, i, known_only, update,
+													&fresh);
+
+		of_union(collect_f, b->flags);
+		for (j = 0; j < STAT_MAX; j++)
+			state->stat_add[j] += b->stat_add[j];
+		state->skills[SKILL_STEALTH] += b->stealth;
+		state->skills[SKILL_SEARCH] += b->search;
+		state->skills[SKILL_DIGGING] += b->digging;
+		state->see_infra += b->infra;
+		state->speed += b->speed;
+		extra_blows += b->blows;
+		extra_shots += b->shots;
+		extra_might += b->might;
+
+		for (j = 0; j < ELEM_MAX; j++)
+			if (b->res_level[j] > state->el_info[j].res_level)
+				state->el_info[j].res_level = b->res_level[j];
+
+		/* Vulnerabilities are noted by slot, as they always have been */
+		if (b->vuln)
+			vuln[i] = true;
 
-			/* Move to any unprocessed curse object */
-			if (curse) {
-				index++;
-				obj = NULL;
-				while (index < z_info->curse_max) {
-					if (curse[index].power) {
-						obj = curses[index].obj;
-						break;
-					} else {
-						index++;
-					}
-				}
-			} else {
-				obj = NULL;
-			}
-		}
+		state->ac += b->ac;
+		state->to_a += b->to_a;
+		state->to_h += b->to_h;
+		state->to_d += b->to_d;
 	}
 
 	/* Apply the collected flags */
@@ -2301,6 +2423,30 @@ void notice_stuff(struct player *p)
 	}
 }
 
+/**
+ * How often each update and redraw flag has been acted on, and how many
+ * calls to handle_stuff() were folded into a later one
+ */
+struct stuff_counts stuff_counts;
+
+static void count_flags(u32b counts[32], u32b flags)
+{
+	int bit;
+
+	for (bit = 0; flags; bit++, flags >>= 1)
+		if (flags & 1)
+			counts[bit]++;
+}
+
+/**
+ * Clear update flags that are being dealt with, counting them
+ */
+static void update_done(struct player *p, u32b flags)
+{
+	count_flags(stuff_counts.update, p->upkeep->update & flags);
+	p->upkeep->update &= ~flags;
+}
+
 /**
  * Handle "player->upkeep->update"
  */
@@ -2308,35 +2454,37 @@ void update_stuff(struct player *p)
 {
 	/* Update stuff */
 	if (!p->upkeep->update) return;
-
+	stuff_counts.updates++;
 
 	if (p->upkeep->update & (PU_INVEN)) {
-		p->upkeep->update &= ~(PU_INVEN);
+		update_done(p, PU_INVEN);
 		update_inventory(p);
 	}
 
-	if (p->upkeep->update & (PU_BONUS)) {
-		p->upkeep->update &= ~(PU_BONUS);
+	if (p->upkeep->update & (PU_BONUS | PU_STATE)) {
+		if (p->upkeep->update & (PU_BONUS))
+			forget_gear_bonuses(p);
+		update_done(p, PU_BONUS | PU_STATE);
 		update_bonuses(p);
 	}
 
 	if (p->upkeep->update & (PU_TORCH)) {
-		p->upkeep->update &= ~(PU_TORCH);
+		update_done(p, PU_TORCH);
 		calc_torch(p, &p->state, true);
 	}
 
 	if (p->upkeep->update & (PU_HP)) {
-		p->upkeep->update &= ~(PU_HP);
+		update_done(p, PU_HP);
 		calc_hitpoints(p);
 	}
 
 	if (p->upkeep->update & (PU_MANA)) {
-		p->upkeep->update &= ~(PU_MANA);
+		update_done(p, PU_MANA);
 		calc_mana(p, &p->state, true);
 	}
 
 	if (p->upkeep->update & (PU_SPELLS)) {
-		p->upkeep->update &= ~(PU_SPELLS);
+		update_done(p, PU_SPELLS);
 		if (p->class->magic.spell_realm)
 			calc_spells(p);
 	}
@@ -2348,24 +2496,24 @@ void update_stuff(struct player *p)
 	if (!map_is_visible()) return;
 
 	if (p->upkeep->update & (PU_UPDATE_VIEW)) {
-		p->upkeep->update &= ~(PU_UPDATE_VIEW);
+		update_done(p, PU_UPDATE_VIEW);
 		update_view(cave, p);
 	}
 
 	if (p->upkeep->update & (PU_DISTANCE)) {
-		p->upkeep->update &= ~(PU_DISTANCE);
-		p->upkeep->update &= ~(PU_MONSTERS);
+		update_done(p, PU_DISTANCE);
+		update_done(p, PU_MONSTERS);
 		update_monsters(true);
 	}
 
 	if (p->upkeep->update & (PU_MONSTERS)) {
-		p->upkeep->update &= ~(PU_MONSTERS);
+		update_done(p, PU_MONSTERS);
 		update_monsters(false);
 	}
 
 
 	if (p->upkeep->update & (PU_PANEL)) {
-		p->upkeep->update &= ~(PU_PANEL);
+		update_done(p, PU_PANEL);
 		event_signal(EVENT_PLAYERMOVED);
 	}
 }
@@ -2423,6 +2571,12 @@ void redraw_stuff(struct player *p)
 	/* Redraw stuff */
 	if (!redraw) return;
 
+	/* No front end, so there is nobody to redraw for */
+	if (game_headless) {
+		p->upkeep->redraw = 0;
+		return;
+	}
+
 	/* Character is not ready yet, no screen updates */
 	if (!character_generated) return;
 
@@ -2435,6 +2589,9 @@ void redraw_stuff(struct player *p)
 		&& !(redraw & PR_MESSAGE))
 		return;
 
+	PROFILE_ENTER(PROF_REDRAW);
+	stuff_counts.redraws++;
+
 	/* For each listed flag, send the appropriate signal to the UI */
 	for (i = 0; i < N_ELEMENTS(redraw_events); i++) {
 		const struct flag_event_trigger *hnd = &redraw_events[i];
@@ -2449,16 +2606,17 @@ void redraw_stuff(struct player *p)
 		event_signal_point(EVENT_MAP, -1, -1);
 	}
 
+	count_flags(stuff_counts.redraw, redraw);
 	p->upkeep->redraw &= ~redraw;
 
-	/* Map is not shown, subwindow updates only */
-	if (!map_is_visible()) return;
-
 	/*
 	 * Do any plotting, etc. delayed from earlier - this set of updates
-	 * is over.
+	 * is over; if the map is not shown, there were subwindow updates only.
 	 */
-	event_signal(EVENT_END);
+	if (map_is_visible())
+		event_signal(EVENT_END);
+
+	PROFILE_LEAVE(PROF_REDRAW);
 }
 
 
@@ -2467,7 +2625,49 @@ void redraw_stuff(struct player *p)
  */
 void handle_stuff(struct player *p)
 {
+	/* Leave it for the end of the command, or the next wait for input */
+	if (p->upkeep->defer_stuff) {
+		stuff_counts.deferred++;
+		return;
+	}
+
+	stuff_counts.handled++;
 	if (p->upkeep->update) update_stuff(p);
+	event_flush_points();
 	if (p->upkeep->redraw) redraw_stuff(p);
 }
 
+/**
+ * Put off handle_stuff() until the matching undefer_stuff(), so a command
+ * that asks for the same updates many times only gets them done once.
+ * These nest.
+ */
+void defer_stuff(struct player *p)
+{
+	p->upkeep->defer_stuff++;
+}
+
+/**
+ * End a defer_stuff(), handling everything that built up if it was the last
+ */
+void undefer_stuff(struct player *p)
+{
+	assert(p->upkeep->defer_stuff > 0);
+	if (--p->upkeep->defer_stuff) return;
+	handle_stuff(p);
+}
+
+/**
+ * Handle anything put off by defer_stuff() now, without ending the
+ * deferral; for when the game is about to wait for the player
+ */
+void flush_stuff(struct player *p)
+{
+	int defer = p->upkeep->defer_stuff;
+
+	if (!defer) return;
+	p->upkeep->defer_stuff = 0;
+	handle_stuff(p);
+	p->upkeep->defer_stuff = defer;
+}
+
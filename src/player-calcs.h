@@ -43,6 +43,7 @@
 #define PU_DISTANCE		0x00000080L	/* Update distances */
 #define PU_PANEL		0x00000100L	/* Update panel */
 #define PU_INVEN		0x00000200L	/* Update inventory */
+#define PU_STATE		0x00000400L	/* Calculate bonuses, gear unchanged */
 
 
 /**
@@ -94,11 +95,25 @@
 #define PR_SUBWINDOW \
 	(PR_MONSTER | PR_OBJECT | PR_MONLIST | PR_ITEMLIST)
 
+/**
+ * Counts of the work done by update_stuff() and redraw_stuff(), indexed by
+ * flag bit
+ */
+struct stuff_counts {
+	u32b update[32];	/* Times each PU_ flag was acted on */
+	u32b redraw[32];	/* Times each PR_ flag was sent to the UI */
+	u32b updates;		/* Calls to update_stuff() with something to do */
+	u32b redraws;		/* Calls to redraw_stuff() that sent anything */
+	u32b handled;		/* Calls to handle_stuff() that did the work */
+	u32b deferred;		/* Calls left for a later one */
+};
+
 
 extern const int adj_str_blow[STAT_RANGE];
 extern const int adj_dex_safe[STAT_RANGE];
 extern const int adj_con_fix[STAT_RANGE];
 extern const int adj_str_hold[STAT_RANGE];
+extern struct stuff_counts stuff_counts;
 
 bool earlier_object(struct object *orig, struct object *new, bool store);
 int equipped_item_slot(struct player_body body, struct object *obj);
@@ -122,6 +137,9 @@ void notice_stuff(struct player *p);
 void update_stuff(struct player *p);
 void redraw_stuff(struct player *p);
 void handle_stuff(struct player *p);
+void defer_stuff(struct player *p);
+void undefer_stuff(struct player *p);
+void flush_stuff(struct player *p);
 int weight_remaining(struct player *p);
 
 #endif /* !PLAYER_CALCS_H */
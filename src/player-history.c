@@ -30,6 +30,14 @@
 #define HISTORY_LEN_INIT		20
 #define HISTORY_LEN_INCR		20
 
+/**
+ * The low-memory build keeps at most this many entries, dropping the oldest
+ * ones that nothing else depends on to make room
+ */
+#ifdef LOW_MEMORY
+#define HISTORY_LEN_MAX			100
+#endif
+
 /**
  * Initialise an empty history list.
  */
@@ -50,6 +58,36 @@ static void history_realloc(struct player_history *h)
 			h->length * sizeof *h->entries);
 }
 
+#ifdef LOW_MEMORY
+/**
+ * Make room in a full history list by dropping its oldest entry other than
+ * the birth, and any that the artifact knowledge is kept in.
+ *
+ * Return true if there was one to drop.
+ */
+static bool history_drop_oldest(struct player_history *h)
+{
+	size_t i;
+
+	for (i = 0; i < h->next; i++) {
+		bitflag *type = h->entries[i].type;
+
+		if (hist_has(type, HIST_PLAYER_BIRTH) ||
+			hist_has(type, HIST_ARTIFACT_UNKNOWN) ||
+			hist_has(type, HIST_ARTIFACT_KNOWN) ||
+			hist_has(type, HIST_ARTIFACT_LOST))
+			continue;
+
+		memmove(&h->entries[i], &h->entries[i + 1],
+				(h->next - i - 1) * sizeof(*h->entries));
+		h->next--;
+		return true;
+	}
+
+	return false;
+}
+#endif /* LOW_MEMORY */
+
 /**
  * Clear any existing history.
  */
@@ -86,8 +124,12 @@ bool history_add_full(struct player *p,
 	/* Allocate or expand the history list if needed */
 	if (!h->entries)
 		history_init(h);
-	else if (h->next == h->length)
-		history_realloc(h);
+	else if (h->next == h->length) {
+#ifdef LOW_MEMORY
+		if (h->length < HISTORY_LEN_MAX || !history_drop_oldest(h))
+#endif /* LOW_MEMORY */
+			history_realloc(h);
+	}
 
 	/* Add entry */
 	hist_copy(h->entries[h->next].type, type);
@@ -35,23 +35,32 @@
  * ------------------------------------------------------------------------ */
 
 /**
- * Maximum size around the player to consider in the pathfinder
+ * The pathfinder is an A* search over the whole chunk.  Its arrays are kept
+ * between calls and only reallocated when the chunk size changes; grids are
+ * marked with the number of the search that last touched them, so nothing
+ * needs clearing between searches.
  */
-#define MAX_PF_RADIUS 100
-
-/**
- * Maximum distance to consider in the pathfinder
- */
-#define MAX_PF_LENGTH 500
-
-
-static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
-static char pf_result[MAX_PF_LENGTH];
+struct pf_node {
+	int cost;		/* Steps so far plus the estimate of steps to go */
+	int dist;		/* Steps so far */
+	int grid;		/* Grid as y * width + x */
+};
+
+static int pf_size;				/* Grids the arrays have room for */
+static u32b pf_search;			/* Number of the current search */
+static u32b *pf_seen;			/* Search which last reached each grid */
+static u32b *pf_done;			/* Search which last settled each grid */
+static int *pf_dist;			/* Steps from the player to each grid */
+static byte *pf_dir;			/* Direction of the step into each grid */
+static u32b *pf_goal;			/* Search for which each grid is a goal */
+static int *pf_left;			/* Steps still to take from each goal */
+static struct pf_node *pf_heap;	/* Open grids, as a binary heap */
+static int pf_heap_num;
+static int pf_heap_size;
+
+static char *pf_result;
 static int pf_result_index;
 
-static int ox, oy, ex, ey;
-static int dir_search[8] = {2,4,6,8,1,3,7,9};
-
 
 static bool is_valid_pf(int y, int x)
 {
@@ -65,114 +74,317 @@ static bool is_valid_pf(int y, int x)
 	return (square_ispassable(cave, y, x));
 }
 
-static void fill_terrain_info(void)
+/**
+ * Make sure the pathfinder arrays fit the current chunk, and start a new
+ * search
+ */
+static void pf_prepare(void)
 {
-	int i, j;
+	int size = cave->height * cave->width;
+
+	if (size != pf_size) {
+		mem_free(pf_seen);
+		mem_free(pf_done);
+		mem_free(pf_dist);
+		mem_free(pf_dir);
+		mem_free(pf_goal);
+		mem_free(pf_left);
+		mem_free(pf_result);
+		pf_seen = mem_zalloc(size * sizeof(*pf_seen));
+		pf_done = mem_zalloc(size * sizeof(*pf_done));
+		pf_dist = mem_zalloc(size * sizeof(*pf_dist));
+		pf_dir = mem_zalloc(size * sizeof(*pf_dir));
+		pf_goal = mem_zalloc(size * sizeof(*pf_goal));
+		pf_left = mem_zalloc(size * sizeof(*pf_left));
+		pf_result = mem_zalloc(size * sizeof(*pf_result));
+		pf_size = size;
+		pf_search = 0;
+	}
 
-	ox = MAX(player->px - MAX_PF_RADIUS / 2, 0);
-	oy = MAX(player->py - MAX_PF_RADIUS / 2, 0);
+	/* Wipe the marks when the search number wraps */
+	if (++pf_search == 0) {
+		memset(pf_seen, 0, pf_size * sizeof(*pf_seen));
+		memset(pf_done, 0, pf_size * sizeof(*pf_done));
+		memset(pf_goal, 0, pf_size * sizeof(*pf_goal));
+		pf_search = 1;
+	}
+
+	pf_heap_num = 0;
+}
 
-	ex = MIN(player->px + MAX_PF_RADIUS / 2 - 1, cave->width);
-	ey = MIN(player->py + MAX_PF_RADIUS / 2 - 1, cave->height);
+/**
+ * Whether heap node a should come out before heap node b; ties go to the
+ * node furthest along, which is nearer the target
+ */
+static bool pf_before(const struct pf_node *a, const struct pf_node *b)
+{
+	if (a->cost != b->cost) return a->cost < b->cost;
+	return a->dist > b->dist;
+}
 
-	for (i = 0; i < MAX_PF_RADIUS; i++)
-		for (j = 0; j < MAX_PF_RADIUS; j++)
-			terrain[i][j] = -1;
+static void pf_push(int cost, int dist, int grid)
+{
+	int i = pf_heap_num++;
 
-	for (j = oy; j < ey; j++)
-		for (i = ox; i < ex; i++)
-			if (is_valid_pf(j, i))
-				terrain[j - oy][i - ox] = MAX_PF_LENGTH;
+	if (pf_heap_num > pf_heap_size) {
+		pf_heap_size = pf_heap_size ? pf_heap_size * 2 : 256;
+		pf_heap = mem_realloc(pf_heap, pf_heap_size * sizeof(*pf_heap));
+	}
 
-	terrain[player->py - oy][player->px - ox] = 1;
+	/* Sift up */
+	pf_heap[i].cost = cost;
+	pf_heap[i].dist = dist;
+	pf_heap[i].grid = grid;
+	while (i > 0) {
+		int parent = (i - 1) / 2;
+		struct pf_node swap;
+		if (!pf_before(&pf_heap[i], &pf_heap[parent])) break;
+		swap = pf_heap[i];
+		pf_heap[i] = pf_heap[parent];
+		pf_heap[parent] = swap;
+		i = parent;
+	}
 }
 
-#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) \
-							{ c = d; try_again = (true); }
+static struct pf_node pf_pop(void)
+{
+	struct pf_node top = pf_heap[0];
+	int i = 0;
+
+	/* Sift the last node down from the top */
+	pf_heap[0] = pf_heap[--pf_heap_num];
+	while (true) {
+		int child = 2 * i + 1;
+		struct pf_node swap;
+		if (child >= pf_heap_num) break;
+		if (child + 1 < pf_heap_num &&
+			pf_before(&pf_heap[child + 1], &pf_heap[child]))
+			child++;
+		if (!pf_before(&pf_heap[child], &pf_heap[i])) break;
+		swap = pf_heap[i];
+		pf_heap[i] = pf_heap[child];
+		pf_heap[child] = swap;
+		i = child;
+	}
+
+	return top;
+}
 
-bool findpath(int y, int x)
+/**
+ * Whether a grid is known to block the player
+ */
+static bool pf_known_wall(int y, int x)
+{
+	return square_isknown(cave, y, x) && !square_ispassable(cave, y, x);
+}
+
+/**
+ * Search from the player for the cheapest way to a goal grid marked for the
+ * current search, where a goal costs the steps to reach it plus its
+ * pf_left[] value.  Steps may be taken in any direction at the same cost;
+ * if (`ty`, `tx`) is a grid it must be the only goal, and the larger of the
+ * row and column distances to it is an exact lower bound on the steps to go
+ * which guides the search, otherwise the search spreads out evenly.
+ *
+ * Grids must pass is_valid_pf(), and if `avoid_walls` is set must not be
+ * known walls either, except for closed doors if `doors_ok` is set;
+ * `goal_ok` says whether goals may be entered anyway.
+ *
+ * Returns the best goal, or -1 if none can be reached.
+ */
+static int pf_find(int ty, int tx, bool goal_ok, bool avoid_walls,
+				   bool doors_ok)
 {
-	int i, j, k;
-	int dir = 10;
-	bool try_again;
-	int cur_distance;
+	int w = cave->width;
+	int start = player->py * w + player->px;
+	int best = -1, best_cost = 0;
+
+#define PF_ESTIMATE(y, x) \
+	((ty < 0) ? 0 : MAX(ABS(ty - (y)), ABS(tx - (x))))
+
+	pf_seen[start] = pf_search;
+	pf_dist[start] = 0;
+	pf_push(PF_ESTIMATE(player->py, player->px), 0, start);
+
+	while (pf_heap_num) {
+		struct pf_node node = pf_pop();
+		int gy = node.grid / w, gx = node.grid % w;
+		int dir;
 
-	fill_terrain_info();
+		/* Nothing left can beat the best goal */
+		if (best >= 0 && node.cost >= best_cost) break;
 
-	terrain[player->py - oy][player->px - ox] = 1;
+		/* Skip grids already settled by a shorter path */
+		if (pf_done[node.grid] == pf_search) continue;
+		pf_done[node.grid] = pf_search;
 
-	if ((x >= ox) && (x < ex) && (y >= oy) && (y < ey)) {
-		if ((cave->squares[y][x].mon > 0) &&
-			monster_is_visible(square_monster(cave, y, x))) {
-			terrain[y - oy][x - ox] = MAX_PF_LENGTH;
+		if (pf_goal[node.grid] == pf_search &&
+			(best < 0 || node.dist + pf_left[node.grid] < best_cost)) {
+			best = node.grid;
+			best_cost = node.dist + pf_left[node.grid];
 		}
-	} else {
-		bell("Target out of range.");
-		return (false);
-	}
 
-	/* 
-	 * And now starts the very naive and very 
-	 * inefficient pathfinding algorithm
-	 */
-	do {
-		try_again = false;
-
-		for (j = oy + 1; j < ey - 1; j++) {
-			for (i = ox + 1; i < ex - 1; i++) {
-				cur_distance = terrain[j - oy][i - ox] + 1;
-
-				if ((cur_distance > 0) && (cur_distance < MAX_PF_LENGTH)) {
-					for (dir = 1; dir < 10; dir++) {
-						int next_y, next_x;
-						if (dir == 5)
-							dir++;
-						next_y = j - oy + ddy[dir];
-						next_x = i - ox + ddx[dir];
-
-						MARK_DISTANCE(terrain[next_y][next_x], cur_distance);
-					}
-				}
+		/* Paths don't lead out through the edge of the chunk */
+		if (!square_in_bounds_fully(cave, gy, gx)) continue;
+
+		for (dir = 1; dir < 10; dir++) {
+			int ny = gy + ddy[dir], nx = gx + ddx[dir];
+			int next = ny * w + nx;
+			int dist = node.dist + 1;
+
+			if (dir == 5) continue;
+			if (pf_goal[next] == pf_search && goal_ok) {
+				/* Allowed */
+			} else if (!is_valid_pf(ny, nx) ||
+					   (avoid_walls && pf_known_wall(ny, nx) &&
+						!(doors_ok && square_iscloseddoor(cave, ny, nx)))) {
+				continue;
 			}
+			if (pf_seen[next] == pf_search && pf_dist[next] <= dist) continue;
+
+			pf_seen[next] = pf_search;
+			pf_dist[next] = dist;
+			pf_dir[next] = dir;
+			pf_push(dist + PF_ESTIMATE(ny, nx), dist, next);
 		}
+	}
+
+#undef PF_ESTIMATE
+
+	return best;
+}
+
+/**
+ * Store the path found to a goal backwards in pf_result[], from the goal's
+ * pf_left[] index up, leaving the steps below that alone
+ */
+static bool pf_store(int goal)
+{
+	int w = cave->width;
+	int start = player->py * w + player->px;
+	int grid;
+
+	/* No room to store the path */
+	if (pf_left[goal] + pf_dist[goal] > pf_size) return false;
+
+	pf_result_index = pf_left[goal];
+	for (grid = goal; grid != start;) {
+		int dir = pf_dir[grid];
+		pf_result[pf_result_index++] = '0' + (char)dir;
+		grid -= ddy[dir] * w + ddx[dir];
+	}
+
+	pf_result_index--;
 
-		if (terrain[y - oy][x - ox] < MAX_PF_LENGTH)
-			try_again = false;
+	return true;
+}
+
+/**
+ * Find a path for the player to the given grid, and store it for run_step()
+ * to follow
+ */
+bool findpath(int y, int x)
+{
+	bool target_ok;
+	int goal;
 
+	if (!square_in_bounds(cave, y, x)) {
+		bell("Target out of range.");
+		return (false);
 	}
-	while (try_again) ;
 
-	/* Failure */
-	if (terrain[y - oy][x - ox] == MAX_PF_LENGTH) {
+	/* A visible monster in the target grid can be walked to */
+	target_ok = is_valid_pf(y, x) || ((cave->squares[y][x].mon > 0) &&
+				monster_is_visible(square_monster(cave, y, x)));
+
+	pf_prepare();
+	pf_goal[y * cave->width + x] = pf_search;
+	pf_left[y * cave->width + x] = 0;
+	goal = pf_find(y, x, target_ok, false, false);
+	if (goal < 0 || !pf_store(goal)) {
 		bell("Target space unreachable.");
 		return (false);
 	}
 
-	/* Success */
-	i = x;
-	j = y;
+	return (true);
+}
 
-	pf_result_index = 0;
+/**
+ * The unknown grid that the explore path leads to
+ */
+static int pf_explore_goal = -1;
 
-	while ((i != player->px) || (j != player->py)) {
-		cur_distance = terrain[j - oy][i - ox] - 1;
-		for (k = 0; k < 8; k++) {
-			dir = dir_search[k];
-			if (terrain[j - oy + ddy[dir]][i - ox + ddx[dir]] == cur_distance)
-				break;
+/**
+ * Find a path for the player to the nearest grid they don't know yet, keeping
+ * clear of known walls other than closed doors, and store it for run_step()
+ * to follow; the player stops in front of any door for it to be opened.
+ * Every unknown grid is a goal, so the search is a single spread out from the
+ * player which stops at the nearest one.
+ */
+bool findpath_explore(void)
+{
+	int y, x, goal;
+
+	pf_prepare();
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			if (square_isknown(cave, y, x)) continue;
+			pf_goal[y * cave->width + x] = pf_search;
+			pf_left[y * cave->width + x] = 0;
 		}
+	}
 
-		/* Should never happen */
-		assert ((dir != 10) && (dir != 5));
-
-		pf_result[pf_result_index++] = '0' + (char)(10 - dir);
-		i += ddx[dir];
-		j += ddy[dir];
+	goal = pf_find(-1, -1, true, true, true);
+	if (goal < 0 || !pf_store(goal)) {
+		pf_explore_goal = -1;
+		return false;
 	}
 
-	pf_result_index--;
+	pf_explore_goal = goal;
+	return true;
+}
 
-	return (true);
+/**
+ * Whether the explore path still leads somewhere unknown; once its goal has
+ * been seen, or the path has run out, it needs finding again
+ */
+static bool pf_explore_current(void)
+{
+	if (pf_result_index < 0 || pf_explore_goal < 0) return false;
+	return !square_isknown(cave, pf_explore_goal / cave->width,
+						   pf_explore_goal % cave->width);
+}
+
+/**
+ * Mend the stored path when walls turn out to be in its way.
+ *
+ * Every grid the path reaches past its first known wall is a goal, costing
+ * the steps left to take from it; the best way to one of them which keeps
+ * clear of known walls replaces the path up to that grid, and the rest of
+ * the path is kept as it was.  Returns false, leaving the path alone, if
+ * there is no way round.
+ */
+static bool pf_repair(void)
+{
+	int k, goal, y = player->py, x = player->px;
+	bool blocked = false, any = false;
+
+	pf_prepare();
+	for (k = pf_result_index; k >= 0; k--) {
+		y += ddy[pf_result[k] - '0'];
+		x += ddx[pf_result[k] - '0'];
+		if (pf_known_wall(y, x)) {
+			blocked = true;
+		} else if (blocked) {
+			pf_goal[y * cave->width + x] = pf_search;
+			pf_left[y * cave->width + x] = k;
+			any = true;
+		}
+	}
+	if (!any) return false;
+
+	goal = pf_find(-1, -1, true, true, player->upkeep->running_explore);
+	return (goal >= 0) && pf_store(goal);
 }
 
 /**
@@ -726,6 +938,10 @@ void run_step(int dir)
 
 	/* Start or continue run */
 	if (dir) {
+		/* A new run follows no path */
+		player->upkeep->running_withpathfind = false;
+		player->upkeep->running_explore = false;
+
 		/* Initialize */
 		run_init(dir);
 
@@ -744,6 +960,14 @@ void run_step(int dir)
 				disturb(player, 0);
 				return;
 			}
+		} else if (player->upkeep->running_explore && !pf_explore_current() &&
+				   !findpath_explore()) {
+			/* Exploring, and there is nowhere left to go */
+			msg("There is nowhere else to explore from here.");
+			disturb(player, 0);
+			player->upkeep->running_withpathfind = false;
+			player->upkeep->running_explore = false;
+			return;
 		} else if (pf_result_index < 0) {
 			/* Pathfinding, and the path is finished */
 			disturb(player, 0);
@@ -764,6 +988,13 @@ void run_step(int dir)
 			} else if (pf_result_index > 0) {
 				struct object *obj;
 
+				/* A known wall in the next two steps may just be in the way,
+				 * so first try to find a way round it */
+				if (pf_known_wall(y, x) ||
+					pf_known_wall(y + ddy[pf_result[pf_result_index - 1] - '0'],
+								  x + ddx[pf_result[pf_result_index - 1] - '0']))
+					(void)pf_repair();
+
 				/* If the player has computed a path that is going to end up
 				 * in a wall, we notice this and convert to a normal run. This
 				 * allows us to click on unknown areas to explore the map.
@@ -774,9 +1005,12 @@ void run_step(int dir)
 				y = player->py + ddy[pf_result[pf_result_index] - '0'];
 				x = player->px + ddx[pf_result[pf_result_index] - '0'];
 
-				/* Known wall */
+				/* Known wall; exploring leads to doors for opening */
 				if (square_isknown(cave, y, x) &&
 					!square_ispassable(cave, y, x)) {
+					if (player->upkeep->running_explore &&
+						square_iscloseddoor(cave, y, x))
+						msg("There is a door in the way.");
 					disturb(player, 0);
 					player->upkeep->running_withpathfind = false;
 					return;
@@ -807,8 +1041,10 @@ void run_step(int dir)
 				y = y + ddy[pf_result[pf_result_index - 1] - '0'];
 				x = x + ddx[pf_result[pf_result_index - 1] - '0'];
 
-				/* Known wall, so run the direction we were going */
-				if (square_isknown(cave, y, x) &&
+				/* Known wall, so run the direction we were going; exploring
+				 * just finds a new path after the next step */
+				if (!player->upkeep->running_explore &&
+					square_isknown(cave, y, x) &&
 					!square_ispassable(cave, y, x)) {
 					player->upkeep->running_withpathfind = false;
 					run_init(pf_result[pf_result_index] - '0');
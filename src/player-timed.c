@@ -361,7 +361,7 @@ static bool set_stun(struct player *p, int v)
 
 	/* Disturb and update */
 	disturb(player, 0);
-	p->upkeep->update |= (PU_BONUS);
+	p->upkeep->update |= (PU_STATE);
 	p->upkeep->redraw |= (PR_STATUS);
 	handle_stuff(player);
 
@@ -507,7 +507,7 @@ static bool set_cut(struct player *p, int v)
 
 	/* Disturb and update */
 	disturb(player, 0);
-	p->upkeep->update |= (PU_BONUS);
+	p->upkeep->update |= (PU_STATE);
 	p->upkeep->redraw |= (PR_STATUS);
 	handle_stuff(player);
 
@@ -600,7 +600,7 @@ bool player_set_food(struct player *p, int v)
 
 	/* Disturb and update */
 	disturb(player, 0);
-	p->upkeep->update |= (PU_BONUS);
+	p->upkeep->update |= (PU_STATE);
 	p->upkeep->redraw |= (PR_STATUS);
 	handle_stuff(player);
 
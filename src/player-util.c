@@ -912,6 +912,7 @@ void player_place(struct chunk *c, struct player *p, int y, int x)
 
 	/* Mark cave grid */
 	c->squares[y][x].mon = -1;
+	c->fingerprint += square_fingerprint_mon(c, y, x);
 
 	/* Clear stair creation */
 	p->upkeep->create_down_stair = false;
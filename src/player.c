@@ -161,7 +161,7 @@ bool player_stat_inc(struct player *p, int stat)
 	if (p->stat_cur[stat] > p->stat_max[stat])
 		p->stat_max[stat] = p->stat_cur[stat];
 	
-	p->upkeep->update |= PU_BONUS;
+	p->upkeep->update |= PU_STATE;
 	return true;
 }
 
@@ -195,7 +195,7 @@ bool player_stat_dec(struct player *p, int stat, bool permanent)
 	if (res) {
 		p->stat_cur[stat] = cur;
 		p->stat_max[stat] = max;
-		p->upkeep->update |= (PU_BONUS);
+		p->upkeep->update |= (PU_STATE);
 		p->upkeep->redraw |= (PR_STATS);
 	}
 
@@ -258,7 +258,7 @@ static void adjust_level(struct player *p, bool verbose)
 	       (p->max_exp >= (player_exp[p->max_lev-1] * p->expfact / 100L)))
 		p->max_lev++;
 
-	p->upkeep->update |= (PU_BONUS | PU_HP | PU_SPELLS);
+	p->upkeep->update |= (PU_STATE | PU_HP | PU_SPELLS);
 	p->upkeep->redraw |= (PR_LEV | PR_TITLE | PR_EXP | PR_STATS);
 	handle_stuff(p);
 }
@@ -413,6 +413,7 @@ static void cleanup_player(void) {
 	/* Free the things that are always initialised */
 	object_free(player->obj_k);
 	mem_free(player->timed);
+	mem_free(player->upkeep->gear_bonus);
 	mem_free(player->upkeep->quiver);
 	mem_free(player->upkeep->inven);
 	mem_free(player->upkeep);
@@ -426,6 +426,7 @@ struct player_upkeep {
 
 	int running;				/* Running counter */
 	bool running_withpathfind;	/* Are we using the pathfinder ? */
+	bool running_explore;		/* Is the pathfinder exploring? */
 	bool running_firststep;		/* Is this our first step running? */
 
 	struct object **quiver;	/* Quiver objects */
@@ -434,6 +435,11 @@ struct player_upkeep {
 	int inven_cnt;			/* Number of items in inventory */
 	int equip_cnt;			/* Number of items in equipment */
 	int quiver_cnt;			/* Number of items in the quiver */
+
+	int defer_stuff;		/* handle_stuff() is put off while non-zero */
+
+	struct gear_bonus *gear_bonus;	/* What each slot adds to the state */
+	int gear_bonus_slots;			/* Slots with room in gear_bonus */
 };
 
 /**
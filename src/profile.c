@@ -0,0 +1,566 @@
+/**
+ * \file profile.c
+ * \brief Time where each game turn goes
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-move.h"
+#include "player-calcs.h"
+#include "profile.h"
+#include "savefile.h"
+
+static const char *timer_names[] = {
+	#define PROF(a, b) b,
+	#include "list-profile.h"
+	#undef PROF
+};
+
+/**
+ * Gathered so far, and the game turn gathering started on
+ */
+static struct profile_stat stats[PROF_MAX];
+static s32b start_turn;
+
+/**
+ * Timers running now, innermost last.  A timer that is already running
+ * (project() within project(), say) is only counted, not timed again.
+ */
+#define PROFILE_DEPTH 32
+
+static struct {
+	int timer;
+	double start;
+	double inner;
+} running[PROFILE_DEPTH];
+static int depth;
+static int active[PROF_MAX];
+
+/**
+ * Gathered for each cmd_code, and the command being timed now; commands
+ * run from inside another are left to the outer one
+ */
+#define PROFILE_COMMANDS (CMD_REPEAT + 1)
+
+static struct profile_command commands[PROFILE_COMMANDS];
+static struct {
+	int depth;
+	int code;
+	double start;
+	int waiting;
+	double wait_start;
+	double waited;
+	int energy;
+	u32b updates;
+	u32b redraws;
+} command_now;
+
+/**
+ * Where begin and end events go, in the Chrome trace format, and when it
+ * was opened
+ */
+static ang_file *trace_file;
+static bool trace_first;
+static double trace_start;
+
+/**
+ * Where lines of metrics go, how many game turns apart, and the game turn,
+ * monsters processed and time the last one (or the first game turn) was at;
+ * metrics_turn is -1 until the game is under way
+ */
+static ang_file *metrics_file;
+static s32b metrics_every;
+static s32b metrics_turn;
+static u32b metrics_monsters;
+static double metrics_start;
+static double metrics_last;
+
+/**
+ * Milliseconds from some fixed point
+ */
+double profile_now(void)
+{
+#if defined(UNIX) && defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#else
+	return clock() * 1000.0 / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Write one begin ('B') or end ('E') event
+ */
+static void trace_event(const char *name, char phase, double now)
+{
+	char buf[80];
+	size_t i, j = 0;
+
+	/* Escape the name for JSON, leaving out any control characters */
+	for (i = 0; name[i] && j < sizeof(buf) - 2; i++) {
+		if (name[i] == '"' || name[i] == '\\') buf[j++] = '\\';
+		if ((unsigned char) name[i] >= ' ') buf[j++] = name[i];
+	}
+	buf[j] = '\0';
+
+	file_putf(trace_file, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.1f,"
+			  "\"pid\":1,\"tid\":1}", trace_first ? "" : ",", buf, phase,
+			  (now - trace_start) * 1000.0);
+	trace_first = false;
+}
+
+/**
+ * Start the given timer
+ */
+void profile_enter(int timer)
+{
+	assert(timer >= 0 && timer < PROF_MAX);
+
+	stats[timer].calls++;
+	if (active[timer]++) return;
+
+	/* Too deep to keep track of; just count it */
+	if (depth == PROFILE_DEPTH) return;
+
+	running[depth].timer = timer;
+	running[depth].inner = 0.0;
+	running[depth].start = profile_now();
+	depth++;
+
+	if (trace_file)
+		trace_event(timer_names[timer], 'B', running[depth - 1].start);
+}
+
+/**
+ * Stop the given timer, which must be the last one started
+ */
+void profile_leave(int timer)
+{
+	double now, spent;
+
+	assert(timer >= 0 && timer < PROF_MAX);
+	assert(active[timer] > 0);
+
+	if (--active[timer]) return;
+	if (!depth || running[depth - 1].timer != timer) return;
+
+	depth--;
+	now = profile_now();
+	spent = now - running[depth].start;
+	stats[timer].total += spent;
+	stats[timer].self += spent - running[depth].inner;
+	if (spent > stats[timer].longest)
+		stats[timer].longest = spent;
+
+	if (depth)
+		running[depth - 1].inner += spent;
+
+	if (trace_file)
+		trace_event(timer_names[timer], 'E', now);
+}
+
+/**
+ * Mark the start of a span in the trace, if one is being written
+ */
+void profile_begin(const char *name)
+{
+	if (trace_file)
+		trace_event(name, 'B', profile_now());
+}
+
+/**
+ * Mark the end of the span last begun
+ */
+void profile_end(const char *name)
+{
+	if (trace_file)
+		trace_event(name, 'E', profile_now());
+}
+
+/**
+ * Start timing a player command
+ */
+void profile_command_enter(int code, int energy)
+{
+	if (command_now.depth++) return;
+
+	command_now.code = code;
+	command_now.energy = energy;
+	command_now.updates = stuff_counts.updates;
+	command_now.redraws = stuff_counts.redraws;
+	command_now.waited = 0.0;
+	command_now.start = profile_now();
+}
+
+/**
+ * Stop timing the command started last; the energy it took up is how far it
+ * raised the player's energy_use
+ */
+void profile_command_leave(int energy)
+{
+	struct profile_command *cmd;
+	double spent;
+	int bucket;
+
+	assert(command_now.depth > 0);
+	if (--command_now.depth) return;
+	if (command_now.code < 0 || command_now.code >= PROFILE_COMMANDS) return;
+
+	spent = profile_now() - command_now.start - command_now.waited;
+	cmd = &commands[command_now.code];
+	cmd->count++;
+	cmd->total += spent;
+	if (spent > cmd->longest)
+		cmd->longest = spent;
+	if (energy > command_now.energy)
+		cmd->energy += energy - command_now.energy;
+	cmd->updates += stuff_counts.updates - command_now.updates;
+	cmd->redraws += stuff_counts.redraws - command_now.redraws;
+
+	for (bucket = 1; bucket < PROFILE_BUCKETS; bucket++)
+		if (spent < profile_bucket_ms(bucket))
+			break;
+	cmd->buckets[bucket - 1]++;
+}
+
+/**
+ * Start waiting for the player, which the command being timed isn't charged
+ * for
+ */
+void profile_wait_begin(void)
+{
+	if (!command_now.depth || command_now.waiting++) return;
+
+	command_now.wait_start = profile_now();
+}
+
+/**
+ * Stop waiting for the player
+ */
+void profile_wait_end(void)
+{
+	if (!command_now.waiting || --command_now.waiting) return;
+
+	command_now.waited += profile_now() - command_now.wait_start;
+}
+
+/**
+ * Start writing every timer and span to the given file, for loading into
+ * a trace viewer (chrome://tracing, say).  Only events from here on are
+ * in the trace.
+ */
+bool profile_trace_start(const char *path)
+{
+	if (!profile_enabled()) return false;
+
+	profile_trace_stop();
+	trace_file = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!trace_file) return false;
+
+	file_putf(trace_file, "{\"traceEvents\":[");
+	trace_first = true;
+	trace_start = profile_now();
+	return true;
+}
+
+/**
+ * Finish the trace off.  Timers still running get no end event, which
+ * viewers take as running to the end.
+ */
+void profile_trace_stop(void)
+{
+	if (!trace_file) return;
+
+	file_putf(trace_file, "\n]}\n");
+	file_close(trace_file);
+	trace_file = NULL;
+}
+
+/**
+ * Start writing a line of metrics to the given file every `every` game
+ * turns, for something outside the game to watch.  This works without the
+ * timers; they, and the memory counts, are only in the lines when the game
+ * is gathering them.
+ */
+bool profile_metrics_start(const char *path, int every)
+{
+	profile_metrics_stop();
+	metrics_file = file_open(path, MODE_WRITE, FTYPE_TEXT);
+	if (!metrics_file) return false;
+
+	metrics_every = MAX(every, 1);
+	metrics_turn = -1;
+	metrics_start = metrics_last = profile_now();
+	return true;
+}
+
+/**
+ * Write one line of metrics, as a JSON object
+ */
+static void profile_metrics_write(void)
+{
+	double now = profile_now();
+	double secs = (now - metrics_last) / 1000.0;
+	s32b turns = turn - metrics_turn;
+	struct savefile_stats save;
+	int i, view_bit = 0;
+
+	while ((1L << view_bit) != PU_UPDATE_VIEW) view_bit++;
+	savefile_get_stats(&save);
+
+	file_putf(metrics_file, "{\"turn\":%d,\"ms\":%.1f,\"turns_per_sec\":%.1f",
+			  turn, now - metrics_start,
+			  secs > 0.0 ? turns / secs : 0.0);
+	file_putf(metrics_file, ",\"depth\":%d,\"monsters\":%d,"
+			  "\"monsters_per_turn\":%.1f",
+			  player ? player->depth : 0, cave ? cave->mon_cnt : 0,
+			  turns > 0 ? (double)(monsters_processed - metrics_monsters) /
+			  turns : 0.0);
+	file_putf(metrics_file, ",\"handle_stuff\":%u,\"deferred\":%u,"
+			  "\"updates\":%u,\"redraws\":%u,\"view_updates\":%u",
+			  stuff_counts.handled, stuff_counts.deferred,
+			  stuff_counts.updates, stuff_counts.redraws,
+			  stuff_counts.update[view_bit]);
+	file_putf(metrics_file, ",\"saves\":%u,\"save_bytes\":%u,"
+			  "\"save_ms\":%.1f", save.saves, save.last_bytes, save.last_ms);
+
+	if (profile_enabled()) {
+		file_putf(metrics_file, ",\"commands\":%u,\"timers\":{",
+				  profile_command_total());
+		for (i = 0; i < PROF_MAX; i++)
+			file_putf(metrics_file, "%s\"%s\":{\"calls\":%u,\"ms\":%.1f}",
+					  i ? "," : "", timer_names[i], stats[i].calls,
+					  stats[i].total);
+		file_putf(metrics_file, "}");
+	}
+
+	if (mem_flags & MEM_ACCOUNT) {
+		file_putf(metrics_file, ",\"memory\":{");
+		for (i = 0; i < MEM_TAG_MAX; i++) {
+			struct mem_tag_stats mem;
+
+			mem_tag_get(i, &mem);
+			file_putf(metrics_file, "%s\"%s\":{\"live\":%lu,\"most\":%lu,"
+					  "\"blocks\":%u,\"allocs\":%u}", i ? "," : "",
+					  mem.name, (unsigned long)mem.live,
+					  (unsigned long)mem.high_water, mem.blocks, mem.allocs);
+		}
+		file_putf(metrics_file, "}");
+	}
+
+	file_putf(metrics_file, "}\n");
+	file_flush(metrics_file);
+
+	metrics_turn = turn;
+	metrics_monsters = monsters_processed;
+	metrics_last = now;
+}
+
+/**
+ * Write a line of metrics if enough game turns have gone by; called once
+ * every game turn.  The first call, once a game has been loaded or made,
+ * is where the counting starts from.
+ */
+void profile_metrics_turn(void)
+{
+	if (!metrics_file) return;
+	if (metrics_turn < 0) {
+		metrics_turn = turn;
+		metrics_monsters = monsters_processed;
+		metrics_last = profile_now();
+		return;
+	}
+	if (turn - metrics_turn < metrics_every) return;
+
+	profile_metrics_write();
+}
+
+/**
+ * Write a last line of metrics, if any game turns have gone by since the
+ * one before, and stop
+ */
+void profile_metrics_stop(void)
+{
+	if (!metrics_file) return;
+
+	if (metrics_turn >= 0 && turn != metrics_turn)
+		profile_metrics_write();
+	file_close(metrics_file);
+	metrics_file = NULL;
+}
+
+/**
+ * Whether the game was built with the timers in
+ */
+bool profile_enabled(void)
+{
+#ifdef USE_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Throw away what has been gathered, and start again from this turn; any
+ * timers running now carry on.
+ */
+void profile_reset(void)
+{
+	int i;
+
+	for (i = 0; i < PROF_MAX; i++) {
+		stats[i].calls = 0;
+		stats[i].total = stats[i].self = stats[i].longest = 0.0;
+	}
+	memset(commands, 0, sizeof(commands));
+	start_turn = turn;
+}
+
+/**
+ * Game turns gone by since gathering started
+ */
+s32b profile_turns(void)
+{
+	return turn > start_turn ? turn - start_turn : 0;
+}
+
+/**
+ * Get what one timer has gathered
+ */
+void profile_get(int timer, struct profile_stat *stat)
+{
+	assert(timer >= 0 && timer < PROF_MAX);
+
+	*stat = stats[timer];
+	stat->name = timer_names[timer];
+}
+
+/**
+ * Get what has been gathered about one kind of command; false if none of
+ * them have been timed
+ */
+bool profile_command_get(int code, struct profile_command *cmd)
+{
+	if (code < 0 || code >= PROFILE_COMMANDS || !commands[code].count)
+		return false;
+
+	*cmd = commands[code];
+	return true;
+}
+
+/**
+ * How many commands have been timed in all
+ */
+u32b profile_command_total(void)
+{
+	u32b total = 0;
+	int code;
+
+	for (code = 0; code < PROFILE_COMMANDS; code++)
+		total += commands[code].count;
+	return total;
+}
+
+/**
+ * The least time, in milliseconds, a command in the given histogram bucket
+ * took
+ */
+int profile_bucket_ms(int bucket)
+{
+	assert(bucket >= 0 && bucket < PROFILE_BUCKETS);
+	return bucket ? 1 << (bucket - 1) : 0;
+}
+
+/**
+ * Write a table of the commands timed so far, with their histograms
+ */
+void profile_command_dump(ang_file *fp)
+{
+	int code, i;
+
+	file_putf(fp, "%-24s %7s %9s %9s %7s %6s %6s ", "command", "count",
+			  "avg ms", "longest", "energy", "upd", "redraw");
+	for (i = 0; i < PROFILE_BUCKETS; i++) {
+		char label[16];
+
+		if (i)
+			strnfmt(label, sizeof(label), ">=%d", profile_bucket_ms(i));
+		else
+			my_strcpy(label, "<1", sizeof(label));
+		file_putf(fp, " %6s", label);
+	}
+	file_putf(fp, "\n");
+
+	for (code = 0; code < PROFILE_COMMANDS; code++) {
+		struct profile_command cmd;
+		const char *verb = cmd_verb(code);
+
+		if (!profile_command_get(code, &cmd)) continue;
+
+		file_putf(fp, "%-24.24s %7u %9.3f %9.3f %7.1f %6.2f %6.2f ",
+				  verb ? verb : format("command %d", code), cmd.count,
+				  cmd.total / cmd.count, cmd.longest,
+				  (double)cmd.energy / cmd.count,
+				  (double)cmd.updates / cmd.count,
+				  (double)cmd.redraws / cmd.count);
+		for (i = 0; i < PROFILE_BUCKETS; i++)
+			file_putf(fp, " %6u", cmd.buckets[i]);
+		file_putf(fp, "\n");
+	}
+}
+
+/**
+ * Write what has been gathered to profile.txt in the user directory, if
+ * anything has been.
+ */
+void profile_dump(void)
+{
+	char buf[1024];
+	ang_file *fp;
+	s32b turns = profile_turns();
+	int i;
+
+	for (i = 0; i < PROF_MAX && !stats[i].calls; i++) ;
+	if ((i == PROF_MAX && !profile_command_total()) || !ANGBAND_DIR_USER)
+		return;
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_USER, "profile.txt");
+	fp = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+	if (!fp) return;
+
+	file_putf(fp, "%d game turns\n\n", turns);
+	file_putf(fp, "%-18s %10s %12s %12s %10s %10s\n", "timer", "calls",
+			  "total ms", "self ms", "ms/turn", "longest");
+	for (i = 0; i < PROF_MAX; i++) {
+		struct profile_stat stat;
+
+		profile_get(i, &stat);
+		file_putf(fp, "%-18s %10u %12.3f %12.3f %10.4f %10.3f\n", stat.name,
+				  stat.calls, stat.total, stat.self,
+				  turns ? stat.total / turns : 0.0, stat.longest);
+	}
+
+	file_putf(fp, "\n");
+	profile_command_dump(fp);
+
+	file_close(fp);
+}
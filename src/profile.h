@@ -0,0 +1,140 @@
+/**
+ * \file profile.h
+ * \brief Time where each game turn goes
+ *
+ * Copyright (c) 2016 The Angband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef INCLUDED_PROFILE_H
+#define INCLUDED_PROFILE_H
+
+#include "h-basic.h"
+#include "z-file.h"
+
+enum {
+	#define PROF(a, b) PROF_##a,
+	#include "list-profile.h"
+	#undef PROF
+	PROF_MAX
+};
+
+/**
+ * What one timer has gathered.  Times are in milliseconds; "self" leaves
+ * out the time spent in other timers inside this one.
+ */
+struct profile_stat {
+	const char *name;
+	u32b calls;
+	double total;
+	double self;
+	double longest;
+};
+
+/**
+ * Number of buckets in a command's latency histogram: under 1ms, then one
+ * for each doubling up to 512ms, and one for 1s and over
+ */
+#define PROFILE_BUCKETS 12
+
+/**
+ * What has been gathered about one kind of player command.  Times are in
+ * milliseconds; buckets[0] counts commands under 1ms, and buckets[i] those
+ * of at least profile_bucket_ms(i).
+ */
+struct profile_command {
+	u32b count;
+	double total;
+	double longest;
+	s32b energy;		/* Player energy the commands took up */
+	u32b updates;		/* update_stuff() passes while they ran */
+	u32b redraws;		/* redraw_stuff() passes while they ran */
+	u32b buckets[PROFILE_BUCKETS];
+};
+
+/**
+ * The timers are only there when built with --enable-profile (USE_PROFILE);
+ * otherwise they cost nothing.
+ */
+#ifdef USE_PROFILE
+# define PROFILE_ENTER(t) profile_enter(t)
+# define PROFILE_LEAVE(t) profile_leave(t)
+#else
+# define PROFILE_ENTER(t) ((void)0)
+# define PROFILE_LEAVE(t) ((void)0)
+#endif
+
+/**
+ * Spans that only show up in a trace, not on the timings screen; the name
+ * is only looked at while the call is made.
+ */
+#ifdef USE_PROFILE
+# define PROFILE_BEGIN(name) profile_begin(name)
+# define PROFILE_END(name) profile_end(name)
+#else
+# define PROFILE_BEGIN(name) ((void)0)
+# define PROFILE_END(name) ((void)0)
+#endif
+
+/**
+ * Time a player command, given its cmd_code and the player's energy_use
+ * before and after it
+ */
+#ifdef USE_PROFILE
+# define PROFILE_COMMAND_ENTER(code, energy) profile_command_enter(code, energy)
+# define PROFILE_COMMAND_LEAVE(energy) profile_command_leave(energy)
+#else
+# define PROFILE_COMMAND_ENTER(code, energy) ((void)0)
+# define PROFILE_COMMAND_LEAVE(energy) ((void)0)
+#endif
+
+/**
+ * Leave time spent waiting for a key out of the command being timed
+ */
+#ifdef USE_PROFILE
+# define PROFILE_WAIT_BEGIN() profile_wait_begin()
+# define PROFILE_WAIT_END() profile_wait_end()
+#else
+# define PROFILE_WAIT_BEGIN() ((void)0)
+# define PROFILE_WAIT_END() ((void)0)
+#endif
+
+void profile_enter(int timer);
+void profile_leave(int timer);
+void profile_begin(const char *name);
+void profile_end(const char *name);
+void profile_command_enter(int code, int energy);
+void profile_command_leave(int energy);
+void profile_wait_begin(void);
+void profile_wait_end(void);
+
+bool profile_trace_start(const char *path);
+void profile_trace_stop(void);
+
+bool profile_metrics_start(const char *path, int every);
+void profile_metrics_turn(void);
+void profile_metrics_stop(void);
+
+double profile_now(void);
+
+bool profile_enabled(void);
+void profile_reset(void);
+s32b profile_turns(void);
+void profile_get(int timer, struct profile_stat *stat);
+bool profile_command_get(int code, struct profile_command *cmd);
+u32b profile_command_total(void);
+int profile_bucket_ms(int bucket);
+void profile_command_dump(ang_file *fp);
+void profile_dump(void);
+
+#endif /* !INCLUDED_PROFILE_H */
@@ -792,6 +792,7 @@ static bool project_m_monster_attack(project_monster_handler_context_t *context,
 
 	/* Hurt the monster */
 	mon->hp -= dam;
+	rouse_monster(cave, mon);
 
 	/* Dead or damaged monster */
 	if (mon->hp < 0) {
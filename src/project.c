@@ -26,6 +26,7 @@
 #include "mon-util.h"
 #include "player-calcs.h"
 #include "player-timed.h"
+#include "profile.h"
 #include "project.h"
 #include "source.h"
 #include "trap.h"
@@ -81,46 +82,21 @@ const char *proj_idx_to_name(int type)
  * Projection paths
  * ------------------------------------------------------------------------ */
 /**
- * Determine the path taken by a projection.
- *
- * The projection will always start from the grid (y1,x1), and will travel
- * towards the grid (y2,x2), touching one grid per unit of distance along
- * the major axis, and stopping when it enters the destination grid or a
- * wall grid, or has travelled the maximum legal distance of "range".
- *
- * Note that "distance" in this function (as in the "update_view()" code)
- * is defined as "MAX(dy,dx) + MIN(dy,dx)/2", which means that the player
- * actually has an "octagon of projection" not a "circle of projection".
- *
- * The path grids are saved into the grid array pointed to by "gp", and
- * there should be room for at least "range" grids in "gp".  Note that
- * due to the way in which distance is calculated, this function normally
- * uses fewer than "range" grids for the projection path, so the result
- * of this function should never be compared directly to "range".  Note
- * that the initial grid (y1,x1) is never saved into the grid array, not
- * even if the initial grid is also the final grid.  XXX XXX XXX
- *
- * The "flg" flags can be used to modify the behavior of this function.
- *
- * In particular, the "PROJECT_STOP" and "PROJECT_THRU" flags have the same
- * semantics as they do for the "project" function, namely, that the path
- * will stop as soon as it hits a monster, or that the path will continue
- * through the destination grid, respectively.
- *
- * The "PROJECT_JUMP" flag, which for the "project()" function means to
- * start at a special grid (which makes no sense in this function), means
- * that the path should be "angled" slightly if needed to avoid any wall
- * grids, allowing the player to "target" any grid which is in "view".
- * This flag is non-trivial and has not yet been implemented, but could
- * perhaps make use of the "vinfo" array (above).  XXX XXX XXX
- *
- * This function returns the number of grids (if any) in the path.  This
- * function will return zero if and only if (y1,x1) and (y2,x2) are equal.
- *
- * This algorithm is similar to, but slightly different from, the one used
- * by "update_view_los()", and very different from the one used by "los()".
+ * Rays for every offset (dy, dx) with both parts no more than ray_range,
+ * stored in the table row by row; ray_start[i] is where the ray for entry
+ * i starts in ray_steps, and ray_start[i + 1] where it ends
  */
-int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int flg)
+static int ray_range;
+static int *ray_start;
+static struct loc *ray_steps;
+
+/**
+ * Work out the offsets from the start of the grids on a projection path
+ * towards (dy, dx), ignoring anything in the way and carrying on through
+ * the destination, until "range" is reached.  There must be room for
+ * "range" offsets in "ray"; the number stored is returned.
+ */
+static int project_ray(struct loc *ray, int range, int dy, int dx)
 {
 	int y, x;
 
@@ -144,24 +120,24 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 
 
 	/* No path necessary (or allowed) */
-	if ((x1 == x2) && (y1 == y2)) return (0);
+	if ((dx == 0) && (dy == 0)) return (0);
 
 
 	/* Analyze "dy" */
-	if (y2 < y1) {
-		ay = (y1 - y2);
+	if (dy < 0) {
+		ay = -dy;
 		sy = -1;
 	} else {
-		ay = (y2 - y1);
+		ay = dy;
 		sy = 1;
 	}
 
 	/* Analyze "dx" */
-	if (x2 < x1) {
-		ax = (x1 - x2);
+	if (dx < 0) {
+		ax = -dx;
 		sx = -1;
 	} else {
-		ax = (x2 - x1);
+		ax = dx;
 		sx = 1;
 	}
 
@@ -182,31 +158,17 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 		m = frac << 1;
 
 		/* Start */
-		y = y1 + sy;
-		x = x1;
+		y = sy;
+		x = 0;
 
 		/* Create the projection path */
 		while (1) {
 			/* Save grid */
-			gp[n++] = loc(x, y);
+			ray[n++] = loc(x, y);
 
 			/* Hack -- Check maximum range */
 			if ((n + (k >> 1)) >= range) break;
 
-			/* Sometimes stop at destination grid */
-			if (!(flg & (PROJECT_THRU)))
-				if ((x == x2) && (y == y2)) break;
-
-			/* Stop at non-initial wall grids, except where that would
-			 * leak info during targetting */
-			if (!(flg & (PROJECT_INFO))) {
-				if ((n > 0) && !square_isprojectable(cave, y, x)) break;
-			} else if ((n > 0) && square_isbelievedwall(cave,y,x)) break;
-
-			/* Sometimes stop at non-initial monsters/players */
-			if (flg & (PROJECT_STOP))
-				if ((n > 0) && (cave->squares[y][x].mon != 0)) break;
-
 			/* Slant */
 			if (m) {
 				/* Advance (X) part 1 */
@@ -239,31 +201,17 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 		m = frac << 1;
 
 		/* Start */
-		y = y1;
-		x = x1 + sx;
+		y = 0;
+		x = sx;
 
 		/* Create the projection path */
 		while (1) {
 			/* Save grid */
-			gp[n++] = loc(x, y);
+			ray[n++] = loc(x, y);
 
 			/* Hack -- Check maximum range */
 			if ((n + (k >> 1)) >= range) break;
 
-			/* Sometimes stop at destination grid */
-			if (!(flg & (PROJECT_THRU)))
-				if ((x == x2) && (y == y2)) break;
-
-			/* Stop at non-initial wall grids, except where that would
-			 * leak info during targetting */
-			if (!(flg & (PROJECT_INFO))) {			
-				if ((n > 0) && !square_isprojectable(cave, y, x)) break;
-			} else if ((n > 0) && square_isbelievedwall(cave,y,x)) break;
-
-			/* Sometimes stop at non-initial monsters/players */
-			if (flg & (PROJECT_STOP))
-				if ((n > 0) && (cave->squares[y][x].mon != 0)) break;
-
 			/* Slant */
 			if (m) {
 				/* Advance (Y) part 1 */
@@ -290,31 +238,17 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 	/* Diagonal */
 	else {
 		/* Start */
-		y = y1 + sy;
-		x = x1 + sx;
+		y = sy;
+		x = sx;
 
 		/* Create the projection path */
 		while (1) {
 			/* Save grid */
-			gp[n++] = loc(x, y);
+			ray[n++] = loc(x, y);
 
 			/* Hack -- Check maximum range */
 			if ((n + (n >> 1)) >= range) break;
 
-			/* Sometimes stop at destination grid */
-			if (!(flg & (PROJECT_THRU)))
-				if ((x == x2) && (y == y2)) break;
-
-			/* Stop at non-initial wall grids, except where that would
-			 * leak info during targetting */
-			if (!(flg & (PROJECT_INFO))) {
-				if ((n > 0) && !square_isprojectable(cave, y, x)) break;
-			} else if ((n > 0) && square_isbelievedwall(cave,y,x)) break;
-
-			/* Sometimes stop at non-initial monsters/players */
-			if (flg & (PROJECT_STOP))
-				if ((n > 0) && (cave->squares[y][x].mon != 0)) break;
-
 			/* Advance */
 			y += sy;
 			x += sx;
@@ -325,6 +259,186 @@ int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int
 	return (n);
 }
 
+/**
+ * Build the ray table
+ */
+static void init_project_rays(void)
+{
+	int dy, dx, i = 0, num = 0;
+	int side;
+
+	ray_range = z_info->max_range;
+	side = 2 * ray_range + 1;
+	ray_start = mem_zalloc((side * side + 1) * sizeof(*ray_start));
+	ray_steps = mem_zalloc(side * side * MAX(ray_range, 1) *
+						   sizeof(*ray_steps));
+	for (dy = -ray_range; dy <= ray_range; dy++)
+		for (dx = -ray_range; dx <= ray_range; dx++) {
+			ray_start[i++] = num;
+			num += project_ray(ray_steps + num, ray_range, dy, dx);
+		}
+	ray_start[i] = num;
+	ray_steps = mem_realloc(ray_steps, MAX(num, 1) * sizeof(*ray_steps));
+}
+
+/**
+ * Offsets of the grids within each explosion radius, excluding the centre,
+ * in the row by row order of a scan of the bounding box.  They are made
+ * the first time each radius is used.
+ */
+static struct loc **blast_mask;
+static int *blast_mask_num;
+static int blast_mask_max;
+
+static const struct loc *get_blast_mask(int rad, int *num)
+{
+	if (rad >= blast_mask_max) {
+		int max = rad + 1;
+		blast_mask = mem_realloc(blast_mask, max * sizeof(*blast_mask));
+		blast_mask_num = mem_realloc(blast_mask_num,
+									 max * sizeof(*blast_mask_num));
+		while (blast_mask_max < max) {
+			blast_mask[blast_mask_max] = NULL;
+			blast_mask_num[blast_mask_max] = 0;
+			blast_mask_max++;
+		}
+	}
+
+	if (!blast_mask[rad]) {
+		int dy, dx, n = 0;
+		struct loc *mask = mem_zalloc((2 * rad + 1) * (2 * rad + 1) *
+									  sizeof(*mask));
+		for (dy = -rad; dy <= rad; dy++)
+			for (dx = -rad; dx <= rad; dx++) {
+				if (!dy && !dx) continue;
+				if (distance(0, 0, dy, dx) > rad) continue;
+				mask[n++] = loc(dx, dy);
+			}
+		blast_mask[rad] = mask;
+		blast_mask_num[rad] = n;
+	}
+
+	*num = blast_mask_num[rad];
+	return blast_mask[rad];
+}
+
+static void cleanup_project_rays(void)
+{
+	int i;
+
+	mem_free(ray_start);
+	mem_free(ray_steps);
+	ray_start = NULL;
+	ray_steps = NULL;
+
+	for (i = 0; i < blast_mask_max; i++)
+		mem_free(blast_mask[i]);
+	mem_free(blast_mask);
+	mem_free(blast_mask_num);
+	blast_mask = NULL;
+	blast_mask_num = NULL;
+	blast_mask_max = 0;
+}
+
+struct init_module project_module = {
+	.name = "project",
+	.init = init_project_rays,
+	.cleanup = cleanup_project_rays
+};
+
+/**
+ * Determine the path taken by a projection.
+ *
+ * The projection will always start from the grid (y1,x1), and will travel
+ * towards the grid (y2,x2), touching one grid per unit of distance along
+ * the major axis, and stopping when it enters the destination grid or a
+ * wall grid, or has travelled the maximum legal distance of "range".
+ *
+ * Note that "distance" in this function (as in the "update_view()" code)
+ * is defined as "MAX(dy,dx) + MIN(dy,dx)/2", which means that the player
+ * actually has an "octagon of projection" not a "circle of projection".
+ *
+ * The path grids are saved into the grid array pointed to by "gp", and
+ * there should be room for at least "range" grids in "gp".  Note that
+ * due to the way in which distance is calculated, this function normally
+ * uses fewer than "range" grids for the projection path, so the result
+ * of this function should never be compared directly to "range".  Note
+ * that the initial grid (y1,x1) is never saved into the grid array, not
+ * even if the initial grid is also the final grid.  XXX XXX XXX
+ *
+ * The "flg" flags can be used to modify the behavior of this function.
+ *
+ * In particular, the "PROJECT_STOP" and "PROJECT_THRU" flags have the same
+ * semantics as they do for the "project" function, namely, that the path
+ * will stop as soon as it hits a monster, or that the path will continue
+ * through the destination grid, respectively.
+ *
+ * The "PROJECT_JUMP" flag, which for the "project()" function means to
+ * start at a special grid (which makes no sense in this function), means
+ * that the path should be "angled" slightly if needed to avoid any wall
+ * grids, allowing the player to "target" any grid which is in "view".
+ * This flag is non-trivial and has not yet been implemented, but could
+ * perhaps make use of the "vinfo" array (above).  XXX XXX XXX
+ *
+ * This function returns the number of grids (if any) in the path.  This
+ * function will return zero if and only if (y1,x1) and (y2,x2) are equal.
+ *
+ * This algorithm is similar to, but slightly different from, the one used
+ * by "update_view_los()", and very different from the one used by "los()".
+ *
+ * The grids on a path only depend on where the destination is relative to
+ * the start, so the rays to every offset within z_info->max_range are worked
+ * out once by project_ray() at startup, and this function just walks the
+ * right one testing each grid.
+ */
+int project_path(struct loc *gp, int range, int y1, int x1, int y2, int x2, int flg)
+{
+	int dy = y2 - y1, dx = x2 - x1;
+	const struct loc *ray;
+	int i, len, n = 0;
+
+	/* Find the ray, working it out (in place) if it isn't in the table */
+	if (ray_start && range <= ray_range && ABS(dy) <= ray_range &&
+		ABS(dx) <= ray_range) {
+		int entry = (dy + ray_range) * (2 * ray_range + 1) + dx + ray_range;
+		ray = ray_steps + ray_start[entry];
+		len = ray_start[entry + 1] - ray_start[entry];
+	} else {
+		len = project_ray(gp, range, dy, dx);
+		ray = gp;
+	}
+
+	/* Create the projection path */
+	for (i = 0; i < len; i++) {
+		int dist = distance(0, 0, ray[i].y, ray[i].x);
+		int y = y1 + ray[i].y;
+		int x = x1 + ray[i].x;
+
+		/* Save grid */
+		gp[n++] = loc(x, y);
+
+		/* Hack -- Check maximum range */
+		if (dist >= range) break;
+
+		/* Sometimes stop at destination grid */
+		if (!(flg & (PROJECT_THRU)))
+			if ((x == x2) && (y == y2)) break;
+
+		/* Stop at non-initial wall grids, except where that would
+		 * leak info during targetting */
+		if (!(flg & (PROJECT_INFO))) {
+			if (!square_isprojectable(cave, y, x)) break;
+		} else if (square_isbelievedwall(cave, y, x)) break;
+
+		/* Sometimes stop at non-initial monsters/players */
+		if (flg & (PROJECT_STOP))
+			if (cave->squares[y][x].mon != 0) break;
+	}
+
+	/* Length */
+	return (n);
+}
+
 
 /**
  * Determine if a bolt spell cast from (y1,x1) to (y2,x2) will arrive
@@ -400,6 +514,22 @@ struct loc origin_get_loc(struct source origin)
 	return loc(-1, -1);
 }
 
+/**
+ * Check LOS from an explosion centre to a grid at most `rad` + 1 away from
+ * it, remembering the answers in `memo` so that the walls of the blast area
+ * can share the checks on their neighbours
+ */
+static bool blast_los(byte *memo, int rad, struct loc centre, int y, int x)
+{
+	int side = 2 * rad + 3;
+	byte *known = &memo[(y - centre.y + rad + 1) * side + x - centre.x + rad + 1];
+
+	if (!*known)
+		*known = los(cave, centre.y, centre.x, y, x) ? 2 : 1;
+
+	return *known == 2;
+}
+
 /**
  * Generic "beam"/"bolt"/"ball" projection routine.
  *   -BEN-, some changes by -LM-
@@ -592,7 +722,15 @@ bool project(struct source origin, int rad, int y, int x,
 	/* Precalculated damage values for each distance. */
 	int *dam_at_dist = malloc((z_info->max_range + 1) * sizeof(*dam_at_dist));
 
-	/* Flush any pending output */
+	/* Offsets of the grids in the blast radius, and remembered LOS */
+	const struct loc *mask;
+	int mask_num;
+	byte *los_memo;
+
+	PROFILE_ENTER(PROF_PROJECT);
+
+	/* Flush any pending output; the view must be right even mid-command */
+	update_stuff(player);
 	handle_stuff(player);
 
 	/* No projection path - jump to target */
@@ -751,60 +889,88 @@ bool project(struct source origin, int rad, int y, int x,
 			num_grids++;
 		}
 
-		/* Scan every grid that might possibly be in the blast radius. */
-		for (y = centre.y - rad; y <= centre.y + rad; y++) {
-			for (x = centre.x - rad; x <= centre.x + rad; x++) {
+		/* Scan every grid in the blast radius. */
+		mask = get_blast_mask(rad, &mask_num);
+		los_memo = mem_zalloc((2 * rad + 3) * (2 * rad + 3) *
+							  sizeof(*los_memo));
+		for (j = 0; j < mask_num; j++) {
+			y = centre.y + mask[j].y;
+			x = centre.x + mask[j].x;
 
-				/* Center grid has already been stored. */
-				if ((y == centre.y) && (x == centre.x))
-					continue;
+			/* Precaution: Stay within area limit. */
+			if (num_grids >= 255)
+				break;
 
-				/* Precaution: Stay within area limit. */
-				if (num_grids >= 255)
-					break;
+			/* Ignore "illegal" locations */
+			if (!square_in_bounds(cave, y, x))
+				continue;
 
-				/* Ignore "illegal" locations */
-				if (!square_in_bounds(cave, y, x))
-					continue;
-
-				/* Most explosions are immediately stopped by walls. If
-				 * PROJECT_THRU is set, walls can be affected if adjacent to
-				 * a grid visible from the explosion centre - note that as of
-				 * Angband 3.5.0 there are no such explosions - NRM.
-				 * All explosions can affect one layer of terrain which is
-				 * passable but not projectable - note that as of Angband 3.5.0
-				 * there is no such terrain - NRM */
-				if ((flg & (PROJECT_THRU)) ||
-					square_ispassable(cave, y, x)){
-					/* If this is a wall grid, ... */
-					if (!square_isprojectable(cave, y, x)) {
-						/* Check neighbors */
-						for (i = 0, k = 0; i < 8; i++) {
-							int yy = y + ddy_ddd[i];
-							int xx = x + ddx_ddd[i];
-
-							if (los(cave, centre.y, centre.x, yy, xx)) {
-								k++;
-								break;
-							}
+			/* Most explosions are immediately stopped by walls. If
+			 * PROJECT_THRU is set, walls can be affected if adjacent to
+			 * a grid visible from the explosion centre - note that as of
+			 * Angband 3.5.0 there are no such explosions - NRM.
+			 * All explosions can affect one layer of terrain which is
+			 * passable but not projectable - note that as of Angband 3.5.0
+			 * there is no such terrain - NRM */
+			if ((flg & (PROJECT_THRU)) ||
+				square_ispassable(cave, y, x)){
+				/* If this is a wall grid, ... */
+				if (!square_isprojectable(cave, y, x)) {
+					/* Check neighbors */
+					for (i = 0, k = 0; i < 8; i++) {
+						int yy = y + ddy_ddd[i];
+						int xx = x + ddx_ddd[i];
+
+						if (blast_los(los_memo, rad, centre, yy, xx)) {
+							k++;
+							break;
 						}
-
-						/* Require at least one adjacent grid in LOS. */
-						if (!k)
-							continue;
 					}
-				} else if (!square_isprojectable(cave, y, x))
-					continue;
 
-				/* Must be within maximum distance. */
-				dist_from_centre  = (distance(centre.y, centre.x, y, x));
-				if (dist_from_centre > rad)
-					continue;
+					/* Require at least one adjacent grid in LOS. */
+					if (!k)
+						continue;
+				}
+			} else if (!square_isprojectable(cave, y, x))
+				continue;
 
+			/* Distance from the centre */
+			dist_from_centre = distance(0, 0, mask[j].y, mask[j].x);
 
-				/* If not an arc, accept all grids in LOS. */
-				if (!(flg & (PROJECT_ARC))) {
-					if (los(cave, centre.y, centre.x, y, x)) {
+			/* If not an arc, accept all grids in LOS. */
+			if (!(flg & (PROJECT_ARC))) {
+				if (blast_los(los_memo, rad, centre, y, x)) {
+					blast_grid[num_grids].y = y;
+					blast_grid[num_grids].x = x;
+					distance_to_grid[num_grids] = dist_from_centre;
+					sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
+					num_grids++;
+				}
+			}
+
+			/* Use angle comparison to delineate an arc. */
+			else {
+				int n2y, n2x, tmp, rotate, diff;
+
+				/* Reorient current grid for table access. */
+				n2y = y - source.y + 20;
+				n2x = x - source.x + 20;
+
+				/* 
+				 * Find the angular difference (/2) between 
+				 * the lines to the end of the arc's center-
+				 * line and to the current grid.
+				 */
+				rotate = 90 - get_angle_to_grid[n1y][n1x];
+				tmp = ABS(get_angle_to_grid[n2y][n2x] + rotate) % 180;
+				diff = ABS(90 - tmp);
+
+				/* 
+				 * If difference is not greater then that 
+				 * allowed, and the grid is in LOS, accept it.
+				 */
+				if (diff < (degrees_of_arc + 6) / 4) {
+					if (blast_los(los_memo, rad, centre, y, x)) {
 						blast_grid[num_grids].y = y;
 						blast_grid[num_grids].x = x;
 						distance_to_grid[num_grids] = dist_from_centre;
@@ -812,40 +978,9 @@ bool project(struct source origin, int rad, int y, int x,
 						num_grids++;
 					}
 				}
-
-				/* Use angle comparison to delineate an arc. */
-				else {
-					int n2y, n2x, tmp, rotate, diff;
-
-					/* Reorient current grid for table access. */
-					n2y = y - source.y + 20;
-					n2x = x - source.x + 20;
-
-					/* 
-					 * Find the angular difference (/2) between 
-					 * the lines to the end of the arc's center-
-					 * line and to the current grid.
-					 */
-					rotate = 90 - get_angle_to_grid[n1y][n1x];
-					tmp = ABS(get_angle_to_grid[n2y][n2x] + rotate) % 180;
-					diff = ABS(90 - tmp);
-
-					/* 
-					 * If difference is not greater then that 
-					 * allowed, and the grid is in LOS, accept it.
-					 */
-					if (diff < (degrees_of_arc + 6) / 4) {
-						if (los(cave, centre.y, centre.x, y, x)) {
-							blast_grid[num_grids].y = y;
-							blast_grid[num_grids].x = x;
-							distance_to_grid[num_grids] = dist_from_centre;
-							sqinfo_on(cave->squares[y][x].info, SQUARE_PROJECT);
-							num_grids++;
-						}
-					}
-				}
 			}
 		}
+		mem_free(los_memo);
 	}
 
 	/* Calculate and store the actual damage at each distance. */
@@ -999,8 +1134,10 @@ bool project(struct source origin, int rad, int y, int x,
 			if (project_p(origin, distance_to_grid[i], y, x,
 						  dam_at_dist[distance_to_grid[i]], typ)) {
 				notice = true;
-				if (player->is_dead)
+				if (player->is_dead) {
+					PROFILE_LEAVE(PROF_PROJECT);
 					return notice;
+				}
 				break;
 			}
 		}
@@ -1037,6 +1174,8 @@ bool project(struct source origin, int rad, int y, int x,
 
 	free(dam_at_dist);
 
+	PROFILE_LEAVE(PROF_PROJECT);
+
 	/* Return "something was noticed" */
 	return (notice);
 }
@@ -32,11 +32,21 @@ const char *** name_sections;
 
 typedef unsigned short name_probs[S_WORD+1][S_WORD+1][TOTAL+1];
 
+/**
+ * Probability tables for each name type, and the word list each was built
+ * from
+ */
+static name_probs type_probs[RANDNAME_NUM_TYPES];
+static const char **type_learnt[RANDNAME_NUM_TYPES];
+
 /**
  * This function builds probability tables from a list of purely alphabetical
  * lower-case words, and puts them into the supplied name_probs object.
  * The array of names should have a NULL entry at the end of the list.
  * It relies on the ASCII character set (through use of A2I).
+ *
+ * The tables are cumulative: probs[a][b][c] counts the letters up to and
+ * including c which follow a and b, and probs[a][b][TOTAL] counts them all.
  */
 static void build_prob(name_probs probs, const char **learn)
 {
@@ -65,6 +75,13 @@ static void build_prob(name_probs probs, const char **learn)
 		probs[c_prev][c_cur][E_WORD]++;
 		probs[c_prev][c_cur][TOTAL]++;
 	}
+
+	/* Make the frequencies cumulative */
+	for (c_prev = 0; c_prev <= S_WORD; c_prev++)
+		for (c_cur = 0; c_cur <= S_WORD; c_cur++)
+			for (c_next = 1; c_next <= E_WORD; c_next++)
+				probs[c_prev][c_cur][c_next] +=
+					probs[c_prev][c_cur][c_next - 1];
 }
 
 /**
@@ -80,26 +97,19 @@ size_t randname_make(randname_type name_type, size_t min, size_t max,
 	size_t lnum = 0;
 	bool found_word = false;
 
-	static name_probs lprobs;
-	static randname_type cached_type = RANDNAME_NUM_TYPES;
+	unsigned short (*lprobs)[S_WORD+1][TOTAL+1];
 
 	assert(name_type > 0 && name_type < RANDNAME_NUM_TYPES);
 
 	/* To allow for a terminating character */
 	assert(buflen > max);
 
-	/* We cache one set of probabilities, only regenerate when
-	   the type changes.  It's as good a way as any for now.
-	   Frankly, we could probably regenerate every time. */
-	if (cached_type != name_type) {
-		const char **wordlist = NULL;
-
-		wordlist = sections[name_type];
-
+	/* Each type's tables are built the first time it is used */
+	lprobs = type_probs[name_type];
+	if (type_learnt[name_type] != sections[name_type]) {
 		(void)memset(lprobs, 0, sizeof(name_probs));
-		build_prob(lprobs, wordlist);
-
-		cached_type = name_type;
+		build_prob(lprobs, sections[name_type]);
+		type_learnt[name_type] = sections[name_type];
 	}
         
 	/* Generate the actual word wanted. */
@@ -125,10 +135,8 @@ size_t randname_make(randname_type name_type, size_t min, size_t max,
 
 			r = randint0(lprobs[c_prev][c_cur][TOTAL]);
 
-			while (r >= lprobs[c_prev][c_cur][c_next]) {
-				r -= lprobs[c_prev][c_cur][c_next];
+			while (r >= lprobs[c_prev][c_cur][c_next])
 				c_next++;
-			}
 
 			assert(c_next <= E_WORD);
 			assert(c_next >= 0);
@@ -22,6 +22,7 @@
 #include "init.h"
 #include "mon-lore.h"
 #include "mon-make.h"
+#include "mon-move.h"
 #include "monster.h"
 #include "object.h"
 #include "obj-desc.h"
@@ -77,8 +78,8 @@ static void wr_item(const struct object *obj)
 	wr_u16b(obj->oidx);
 
 	/* Location */
-	wr_byte(obj->iy);
-	wr_byte(obj->ix);
+	wr_s16b(obj->iy);
+	wr_s16b(obj->ix);
 
 	/* Names of object base and object */
 	wr_string(tval_find_name(obj->tval));
@@ -206,8 +207,8 @@ static void wr_monster(const struct monster *mon)
 	struct object *dummy = object_new();
 
 	wr_string(mon->race->name);
-	wr_byte(mon->fy);
-	wr_byte(mon->fx);
+	wr_s16b(mon->fy);
+	wr_s16b(mon->fx);
 	wr_s16b(mon->hp);
 	wr_s16b(mon->maxhp);
 	wr_byte(mon->mspeed);
@@ -224,7 +225,7 @@ static void wr_monster(const struct monster *mon)
 		wr_byte(mon->known_pstate.flags[j]);
 
 	for (j = 0; j < ELEM_MAX; j++)
-		wr_s16b(mon->known_pstate.el_info[j].res_level);
+		wr_s16b(mon->known_pstate.res_level[j]);
 
 	/* Write mimicked object marker, if any */
 	if (mon->mimicked_obj) {
@@ -253,8 +254,8 @@ static void wr_trap(struct trap *trap)
 	} else {
 		wr_string("");
 	}
-    wr_byte(trap->fy);
-    wr_byte(trap->fx);
+    wr_s16b(trap->fy);
+    wr_s16b(trap->fx);
     wr_byte(trap->power);
     wr_byte(trap->timeout);
 
@@ -273,6 +274,9 @@ void wr_randomizer(void)
 {
 	int i;
 
+	/* Only the main stream is saved */
+	int rng = Rand_stream(RNG_MAIN);
+
 	/* current value for the simple RNG */
 	wr_u32b(Rand_value);
 
@@ -291,6 +295,8 @@ void wr_randomizer(void)
 	/* NULL padding */
 	for (i = 0; i < 59 - RAND_DEG; i++)
 		wr_u32b(0);
+
+	Rand_stream(rng);
 }
 
 
@@ -881,10 +887,12 @@ static void wr_monsters_aux(struct chunk *c)
 	/* Total monsters */
 	wr_u16b(cave_monster_max(c));
 
-	/* Dump the monsters */
+	/* Dump the monsters, with the energy those waiting have gained */
 	for (i = 1; i < cave_monster_max(c); i++) {
-		const struct monster *mon = cave_monster(c, i);
+		struct monster *mon = cave_monster(c, i);
 
+		if (mon->race)
+			settle_monster_energy(c, mon);
 		wr_monster(mon);
 	}
 }
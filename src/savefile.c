@@ -19,6 +19,7 @@
 #include "angband.h"
 #include "game-world.h"
 #include "init.h"
+#include "profile.h"
 #include "savefile.h"
 
 /**
@@ -86,6 +87,7 @@ struct blockheader {
 	char name[16];
 	u32b version;
 	u32b size;
+	bool packed;
 };
 
 struct blockinfo {
@@ -119,12 +121,23 @@ static const struct {
 	{ "stores", wr_stores, 1 },
 	{ "dungeon", wr_dungeon, 1 },
 	{ "objects", wr_objects, 1 },
-	{ "monsters", wr_monsters, 1 },
-	{ "traps", wr_traps, 1 },
-	{ "chunks", wr_chunks, 1 },
+	{ "monsters", wr_monsters, 2 },
+	{ "traps", wr_traps, 2 },
+	{ "chunks", wr_chunks, 2 },
 	{ "history", wr_history, 1 },
 };
 
+/**
+ * What was written for each block by the last save, so that a block whose
+ * contents have not changed since can reuse its packed form
+ */
+static struct {
+	byte *raw;
+	u32b raw_len;
+	byte *packed;
+	u32b packed_len;
+} block_cache[N_ELEMENTS(savers)];
+
 /**
  * Savefile loading functions
  */
@@ -146,9 +159,12 @@ static const struct blockinfo loaders[] = {
 	{ "stores", rd_stores, 1 },	
 	{ "dungeon", rd_dungeon, 1 },
 	{ "objects", rd_objects, 1 },	
-	{ "monsters", rd_monsters, 1 },
-	{ "traps", rd_traps, 1 },
-	{ "chunks", rd_chunks, 1 },
+	{ "monsters", rd_monsters_1, 1 },
+	{ "monsters", rd_monsters, 2 },
+	{ "traps", rd_traps_1, 1 },
+	{ "traps", rd_traps, 2 },
+	{ "chunks", rd_chunks_1, 1 },
+	{ "chunks", rd_chunks, 2 },
 	{ "history", rd_history, 1 },
 };
 
@@ -159,11 +175,23 @@ static u32b buffer_size;
 static u32b buffer_pos;
 static u32b buffer_check;
 
+/* Largest block written by the last save; the next one starts at that size */
+static u32b buffer_size_hint;
+
+/* What savefile_get_stats() gives */
+static struct savefile_stats save_stats;
+
 #define BUFFER_INITIAL_SIZE		1024
-#define BUFFER_BLOCK_INCREMENT	1024
 
 #define SAVEFILE_HEAD_SIZE		28
 
+/**
+ * Blocks at least this big are compressed if that makes them smaller; such
+ * blocks have this bit set in the version in their header
+ */
+#define SAVEFILE_PACK_MIN		1024
+#define SAVEFILE_PACKED			0x80000000UL
+
 
 /**
  * ------------------------------------------------------------------------
@@ -190,9 +218,10 @@ static void sf_put(byte v)
 	assert(buffer != NULL);
 	assert(buffer_size > 0);
 
+	/* Double the buffer when full, so a big block costs few reallocs */
 	if (buffer_size == buffer_pos)
 	{
-		buffer_size += BUFFER_BLOCK_INCREMENT;
+		buffer_size *= 2;
 		buffer = mem_realloc(buffer, buffer_size);
 	}
 
@@ -202,14 +231,28 @@ static void sf_put(byte v)
 	buffer_check += v;
 }
 
-static byte sf_get(void)
+/**
+ * Take the next n bytes from the buffer, checking once that they are there.
+ */
+static const byte *sf_get_n(u32b n)
 {
-	if ((buffer == NULL) || (buffer_size <= 0) || (buffer_pos >= buffer_size))
+	const byte *bytes;
+	u32b i;
+
+	if ((buffer == NULL) || (buffer_size < n) || (buffer_pos > buffer_size - n))
 		quit("Broken savefile - probably from a development version");
 
-	buffer_check += buffer[buffer_pos];
+	bytes = buffer + buffer_pos;
+	for (i = 0; i < n; i++)
+		buffer_check += bytes[i];
+	buffer_pos += n;
+
+	return bytes;
+}
 
-	return buffer[buffer_pos++];
+static byte sf_get(void)
+{
+	return *sf_get_n(1);
 }
 
 
@@ -265,8 +308,8 @@ void rd_byte(byte *ip)
 
 void rd_u16b(u16b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u16b)(sf_get()) << 8);
+	const byte *b = sf_get_n(2);
+	(*ip) = b[0] | ((u16b)b[1] << 8);
 }
 
 void rd_s16b(s16b *ip)
@@ -276,10 +319,8 @@ void rd_s16b(s16b *ip)
 
 void rd_u32b(u32b *ip)
 {
-	(*ip) = sf_get();
-	(*ip) |= ((u32b)(sf_get()) << 8);
-	(*ip) |= ((u32b)(sf_get()) << 16);
-	(*ip) |= ((u32b)(sf_get()) << 24);
+	const byte *b = sf_get_n(4);
+	(*ip) = b[0] | ((u32b)b[1] << 8) | ((u32b)b[2] << 16) | ((u32b)b[3] << 24);
 }
 
 void rd_s32b(s32b *ip)
@@ -289,23 +330,24 @@ void rd_s32b(s32b *ip)
 
 void rd_string(char *str, int max)
 {
-	byte tmp8u;
-	int i = 0;
+	const byte *end = NULL;
+	u32b len;
 
-	do {
-		rd_byte(&tmp8u);
+	if (buffer && buffer_pos < buffer_size)
+		end = memchr(buffer + buffer_pos, 0, buffer_size - buffer_pos);
+	if (!end)
+		quit("Broken savefile - probably from a development version");
 
-		if (i < max) str[i] = tmp8u;
-		if (!tmp8u) break;
-	} while (++i);
+	/* Take the string along with its terminator */
+	len = end - (buffer + buffer_pos) + 1;
+	memcpy(str, sf_get_n(len), MIN(len, (u32b)max));
 
 	str[max - 1] = '\0';
 }
 
 void strip_bytes(int n)
 {
-	byte tmp8u;
-	while (n--) rd_byte(&tmp8u);
+	sf_get_n(n);
 }
 
 void pad_bytes(int n)
@@ -314,27 +356,405 @@ void pad_bytes(int n)
 }
 
 
+/**
+ * ------------------------------------------------------------------------
+ * Block compression
+ *
+ * A simple LZ77 scheme.  A packed block is its unpacked length as a u32b,
+ * then a series of sequences, each of them a token byte, some literal bytes,
+ * and then (except for the last) a two byte offset back to copy a match
+ * from.  The top four bits of the token count literals and the bottom four
+ * count match bytes beyond the minimum of four; a count of 15 carries on in
+ * following bytes, each adding up to 255 more.
+ * ------------------------------------------------------------------------ */
+
+#define PACK_MIN_MATCH	4
+#define PACK_HASH_BITS	12
+#define PACK_MAX_OFFSET	0xFFFF
+
+/**
+ * Write a run length that did not fit in its token nibble
+ */
+static bool pack_length(byte *out, u32b *pos, u32b max, u32b len)
+{
+	for (; len >= 255; len -= 255) {
+		if (*pos >= max) return false;
+		out[(*pos)++] = 255;
+	}
+	if (*pos >= max) return false;
+	out[(*pos)++] = (byte)len;
+	return true;
+}
+
+/**
+ * Write one sequence of literals followed by a match of mlen bytes (none if
+ * this is the last sequence)
+ */
+static bool pack_sequence(byte *out, u32b *pos, u32b max, const byte *lit,
+		u32b llen, u32b offset, u32b mlen)
+{
+	u32b extra = mlen ? mlen - PACK_MIN_MATCH : 0;
+	byte *token;
+
+	if (*pos >= max) return false;
+	token = &out[(*pos)++];
+	*token = (byte)((MIN(llen, 15) << 4) | MIN(extra, 15));
+
+	if (llen >= 15 && !pack_length(out, pos, max, llen - 15)) return false;
+	if (max - *pos < llen) return false;
+	memcpy(out + *pos, lit, llen);
+	*pos += llen;
+
+	if (!mlen) return true;
+	if (max - *pos < 2) return false;
+	out[(*pos)++] = (byte)(offset & 0xFF);
+	out[(*pos)++] = (byte)(offset >> 8);
+	if (extra >= 15 && !pack_length(out, pos, max, extra - 15)) return false;
+	return true;
+}
+
+/**
+ * Compress len bytes of data, returning NULL unless the result is smaller
+ */
+static byte *sf_pack(const byte *data, u32b len, u32b *packed_len)
+{
+	u32b table[1 << PACK_HASH_BITS];
+	byte *out;
+	u32b pos = 4, i = 0, lit = 0;
+
+	if (len <= 4)
+		return NULL;
+
+	out = mem_alloc(len);
+	memset(table, 0xFF, sizeof(table));
+	out[0] = len & 0xFF;
+	out[1] = (len >> 8) & 0xFF;
+	out[2] = (len >> 16) & 0xFF;
+	out[3] = (len >> 24) & 0xFF;
+
+	while (i + PACK_MIN_MATCH <= len) {
+		u32b seq = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16) |
+			((u32b)data[i + 3] << 24);
+		u32b h = (u32b)(seq * 2654435761U) >> (32 - PACK_HASH_BITS);
+		u32b cand = table[h];
+		u32b mlen = 0;
+
+		table[h] = i;
+		if (cand != 0xFFFFFFFFUL && i - cand <= PACK_MAX_OFFSET)
+			while (i + mlen < len && data[cand + mlen] == data[i + mlen])
+				mlen++;
+
+		if (mlen < PACK_MIN_MATCH) {
+			i++;
+			continue;
+		}
+
+		if (!pack_sequence(out, &pos, len, data + lit, i - lit, i - cand,
+				mlen)) {
+			mem_free(out);
+			return NULL;
+		}
+		i += mlen;
+		lit = i;
+	}
+
+	if (!pack_sequence(out, &pos, len, data + lit, len - lit, 0, 0)) {
+		mem_free(out);
+		return NULL;
+	}
+
+	*packed_len = pos;
+	return out;
+}
+
+/**
+ * Read a run length continued past its token nibble
+ */
+static bool unpack_length(const byte *in, u32b *pos, u32b len, u32b *n)
+{
+	byte b;
+	do {
+		if (*pos >= len) return false;
+		b = in[(*pos)++];
+		*n += b;
+	} while (b == 255);
+	return true;
+}
+
+/**
+ * Expand a packed block, returning NULL if it is malformed
+ */
+static byte *sf_unpack(const byte *in, u32b len, u32b *unpacked_len)
+{
+	u32b pos = 4, out_pos = 0, size;
+	byte *out;
+
+	if (len < 4) return NULL;
+	size = in[0] | (in[1] << 8) | (in[2] << 16) | ((u32b)in[3] << 24);
+
+	/* No packed byte stands for more than 255 unpacked ones, so a bigger
+	 * size means the block is corrupt, and it mustn't be allocated */
+	if (size / 255 > len - 4) return NULL;
+	out = mem_alloc(MAX(size, 1));
+
+	while (out_pos < size) {
+		u32b llen, mlen, offset;
+		byte token;
+
+		if (pos >= len) break;
+		token = in[pos++];
+
+		/* Literals */
+		llen = token >> 4;
+		if (llen == 15 && !unpack_length(in, &pos, len, &llen)) break;
+		if (len - pos < llen || size - out_pos < llen) break;
+		memcpy(out + out_pos, in + pos, llen);
+		pos += llen;
+		out_pos += llen;
+		if (out_pos == size) break;
+
+		/* Match, copied a byte at a time since it may overlap itself */
+		if (len - pos < 2) break;
+		offset = in[pos] | (in[pos + 1] << 8);
+		pos += 2;
+		mlen = token & 0x0F;
+		if (mlen == 15 && !unpack_length(in, &pos, len, &mlen)) break;
+		mlen += PACK_MIN_MATCH;
+		if (!offset || offset > out_pos || size - out_pos < mlen) break;
+		for (; mlen; mlen--, out_pos++)
+			out[out_pos] = out[out_pos - offset];
+	}
+
+	if (out_pos != size) {
+		mem_free(out);
+		return NULL;
+	}
+
+	*unpacked_len = size;
+	return out;
+}
+
+
+/**
+ * ------------------------------------------------------------------------
+ * Savefile description index
+ *
+ * Each directory that savefiles are written to gets an index of their
+ * descriptions, so that listing them needs one small read rather than a
+ * partial load of every savefile.  It has a group of lines for each savefile,
+ *   N:<file name>
+ *   S:<modification time>:<size>
+ *   D:<description>
+ * and an entry is only trusted if the savefile still has the modification
+ * time and size it had when the entry was written.
+ * ------------------------------------------------------------------------ */
+
+/* The index last read, kept for the next lookup in the same directory */
+static char *index_loaded;
+static char **index_names;
+static char **index_descs;
+static unsigned long *index_mtimes;
+static unsigned long *index_sizes;
+static int index_num;
+
+/**
+ * Build the path of the index for the directory holding savefile 'path'
+ */
+static void savefile_index_path(char *buf, size_t len, const char *path)
+{
+	size_t dirlen = path_filename_index(path);
+
+	my_strcpy(buf, path, MIN(len, dirlen + 1));
+	my_strcat(buf, SAVEFILE_INDEX_NAME, len);
+}
+
+static void savefile_index_forget(void)
+{
+	int i;
+
+	for (i = 0; i < index_num; i++) {
+		string_free(index_names[i]);
+		string_free(index_descs[i]);
+	}
+	mem_free(index_names);
+	mem_free(index_descs);
+	mem_free(index_mtimes);
+	mem_free(index_sizes);
+	string_free(index_loaded);
+	index_loaded = NULL;
+	index_names = NULL;
+	index_descs = NULL;
+	index_mtimes = NULL;
+	index_sizes = NULL;
+	index_num = 0;
+}
+
+/**
+ * Read the index at 'ipath', unless it is the one we already have
+ */
+static void savefile_index_read(const char *ipath)
+{
+	char line[1024];
+	int alloc = 0;
+	ang_file *f;
+
+	if (index_loaded && streq(index_loaded, ipath))
+		return;
+
+	savefile_index_forget();
+	index_loaded = string_make(ipath);
+
+	f = file_open(ipath, MODE_READ, FTYPE_TEXT);
+	if (!f) return;
+
+	while (file_getl(f, line, sizeof line)) {
+		if (prefix(line, "N:")) {
+			if (index_num == alloc) {
+				alloc = alloc ? alloc * 2 : 16;
+				index_names = mem_realloc(index_names,
+					alloc * sizeof(*index_names));
+				index_descs = mem_realloc(index_descs,
+					alloc * sizeof(*index_descs));
+				index_mtimes = mem_realloc(index_mtimes,
+					alloc * sizeof(*index_mtimes));
+				index_sizes = mem_realloc(index_sizes,
+					alloc * sizeof(*index_sizes));
+			}
+			index_names[index_num] = string_make(line + 2);
+			index_descs[index_num] = string_make("");
+			index_mtimes[index_num] = 0;
+			index_sizes[index_num] = 0;
+			index_num++;
+		} else if (prefix(line, "S:") && index_num) {
+			if (sscanf(line + 2, "%lu:%lu", &index_mtimes[index_num - 1],
+					   &index_sizes[index_num - 1]) != 2)
+				index_mtimes[index_num - 1] = index_sizes[index_num - 1] = 0;
+		} else if (prefix(line, "D:") && index_num) {
+			string_free(index_descs[index_num - 1]);
+			index_descs[index_num - 1] = string_make(line + 2);
+		}
+	}
+
+	file_close(f);
+}
+
+/**
+ * Record the description of the savefile at 'path' in its directory's index
+ */
+static void savefile_index_update(const char *path, const char *desc)
+{
+	const char *fname = path + path_filename_index(path);
+	char ipath[1024], tpath[1024];
+	ang_file *f;
+	unsigned long mtime, size;
+	int i;
+
+	/* Without a stamp the entry could never be trusted */
+	if (!file_stamp(path, &mtime, &size)) return;
+
+	savefile_index_path(ipath, sizeof(ipath), path);
+	savefile_index_read(ipath);
+	strnfmt(tpath, sizeof(tpath), "%s.new", ipath);
+
+	f = file_open(tpath, MODE_WRITE, FTYPE_TEXT);
+	if (f) {
+		for (i = 0; i < index_num; i++) {
+			/* Drop the old entry, and any for savefiles now gone */
+			char spath[1024];
+			my_strcpy(spath, path, MIN(sizeof(spath),
+				path_filename_index(path) + 1));
+			my_strcat(spath, index_names[i], sizeof(spath));
+			if (streq(index_names[i], fname) || !file_exists(spath))
+				continue;
+
+			file_putf(f, "N:%s\nS:%lu:%lu\nD:%s\n", index_names[i],
+					  index_mtimes[i], index_sizes[i], index_descs[i]);
+		}
+		file_putf(f, "N:%s\nS:%lu:%lu\nD:%s\n", fname, mtime, size, desc);
+		file_close(f);
+
+		file_delete(ipath);
+		file_move(tpath, ipath);
+	}
+
+	/* Read it afresh next time */
+	savefile_index_forget();
+}
+
+/**
+ * Look up the savefile at 'path' in its index, if the entry is up to date
+ */
+static const char *savefile_index_lookup(const char *path)
+{
+	const char *fname = path + path_filename_index(path);
+	char ipath[1024];
+	unsigned long mtime, size;
+	int i;
+
+	savefile_index_path(ipath, sizeof(ipath), path);
+	if (!file_exists(ipath) || !file_stamp(path, &mtime, &size))
+		return NULL;
+
+	savefile_index_read(ipath);
+	for (i = 0; i < index_num; i++)
+		if (streq(index_names[i], fname))
+			return (index_mtimes[i] == mtime && index_sizes[i] == size) ?
+				index_descs[i] : NULL;
+
+	return NULL;
+}
+
+
 /**
  * ------------------------------------------------------------------------
  * Savefile saving functions
  * ------------------------------------------------------------------------ */
 
 
-static bool try_save(ang_file *file)
+static bool try_save(ang_file *file, char *desc, size_t desc_len)
 {
 	byte savefile_head[SAVEFILE_HEAD_SIZE];
 	size_t i, pos;
 
-	/* Start off the buffer */
-	buffer = mem_alloc(BUFFER_INITIAL_SIZE);
-	buffer_size = BUFFER_INITIAL_SIZE;
+	/* Start off the buffer big enough for the largest block last time */
+	buffer_size = MAX(buffer_size_hint, BUFFER_INITIAL_SIZE);
+	buffer = mem_alloc(buffer_size);
 
 	for (i = 0; i < N_ELEMENTS(savers); i++) {
+		u32b version = savers[i].version, size;
+		byte *data;
+
 		buffer_pos = 0;
 		buffer_check = 0;
 
 		savers[i].save();
 
+		/* Keep the description for the index */
+		if (streq(savers[i].name, "description") && buffer_pos)
+			my_strcpy(desc, (const char *)buffer, MIN(desc_len, buffer_pos));
+
+		/* Compress big blocks, if it helps; only blocks that have changed
+		 * since the last save need compressing again */
+		if (buffer_pos >= SAVEFILE_PACK_MIN &&
+				(block_cache[i].raw_len != buffer_pos ||
+				 memcmp(block_cache[i].raw, buffer, buffer_pos))) {
+			mem_free(block_cache[i].raw);
+			mem_free(block_cache[i].packed);
+			block_cache[i].raw = mem_alloc(buffer_pos);
+			memcpy(block_cache[i].raw, buffer, buffer_pos);
+			block_cache[i].raw_len = buffer_pos;
+			block_cache[i].packed = sf_pack(buffer, buffer_pos,
+				&block_cache[i].packed_len);
+		}
+		if (buffer_pos >= SAVEFILE_PACK_MIN && block_cache[i].packed) {
+			version |= SAVEFILE_PACKED;
+			data = block_cache[i].packed;
+			size = block_cache[i].packed_len;
+		} else {
+			data = buffer;
+			size = buffer_pos;
+		}
+
 		/* 16-byte block name */
 		pos = my_strcpy((char *)savefile_head,
 				savers[i].name,
@@ -348,25 +768,38 @@ static bool try_save(ang_file *file)
 		savefile_head[pos++] = ((v >> 16) & 0xFF); \
 		savefile_head[pos++] = ((v >> 24) & 0xFF);
 
-		SAVE_U32B(savers[i].version);
-		SAVE_U32B(buffer_pos);
+		SAVE_U32B(version);
+		SAVE_U32B(size);
 		SAVE_U32B(buffer_check);
 
 		assert(pos == SAVEFILE_HEAD_SIZE);
 
 		file_write(file, (char *)savefile_head, SAVEFILE_HEAD_SIZE);
-		file_write(file, (char *)buffer, buffer_pos);
+		file_write(file, (char *)data, size);
+		save_stats.last_bytes += SAVEFILE_HEAD_SIZE + size;
 
 		/* pad to 4 byte multiples */
-		if (buffer_pos % 4)
-			file_write(file, "xxx", 4 - (buffer_pos % 4));
+		if (size % 4) {
+			file_write(file, "xxx", 4 - (size % 4));
+			save_stats.last_bytes += 4 - (size % 4);
+		}
 	}
 
+	buffer_size_hint = buffer_size;
 	mem_free(buffer);
+	buffer = NULL;
 
 	return true;
 }
 
+/**
+ * Get how many saves have been made, and how big and slow the last one was
+ */
+void savefile_get_stats(struct savefile_stats *stats)
+{
+	*stats = save_stats;
+}
+
 /**
  * Attempt to save the player in a savefile
  */
@@ -376,6 +809,7 @@ bool savefile_save(const char *path)
 	int count = 0;
 	char new_savefile[1024];
 	char old_savefile[1024];
+	char desc[120] = "";
 
 	/* New savefile */
 	strnfmt(old_savefile, sizeof(old_savefile), "%s%u.old", path,
@@ -398,11 +832,19 @@ bool savefile_save(const char *path)
 	safe_setuid_drop();
 
 	if (file) {
+		double start = profile_now();
+
+		PROFILE_BEGIN("savefile_save");
 		file_write(file, (char *) &savefile_magic, 4);
 		file_write(file, (char *) &savefile_name, 4);
+		save_stats.last_bytes = 8;
 
-		character_saved = try_save(file);
+		character_saved = try_save(file, desc, sizeof(desc));
 		file_close(file);
+		PROFILE_END("savefile_save");
+
+		save_stats.saves++;
+		save_stats.last_ms = profile_now() - start;
 	}
 
 	if (character_saved) {
@@ -423,6 +865,9 @@ bool savefile_save(const char *path)
 				file_delete(old_savefile);
 		} 
 
+		if (!err)
+			savefile_index_update(path, desc);
+
 		safe_setuid_drop();
 
 		return err ? false : true;
@@ -441,18 +886,58 @@ bool savefile_save(const char *path)
 
 
 
+/**
+ * Free what the last save left behind for the next one
+ */
+void savefile_cleanup(void)
+{
+	size_t i;
+
+	for (i = 0; i < N_ELEMENTS(block_cache); i++) {
+		mem_free(block_cache[i].raw);
+		mem_free(block_cache[i].packed);
+	}
+	memset(block_cache, 0, sizeof(block_cache));
+	savefile_index_forget();
+}
+
+
 /**
  * ------------------------------------------------------------------------
  * Savefile loading functions
  * ------------------------------------------------------------------------ */
 
 /**
- * Check the savefile header file clearly inicates that it's a savefile
+ * Read the rest of a savefile into memory, returning NULL on a read error.
  */
-static bool check_header(ang_file *f) {
-	byte head[8];
+static byte *read_savefile(ang_file *f, u32b *size)
+{
+	u32b alloc = 64 * 1024;
+	byte *data = mem_alloc(alloc);
+	int n;
+
+	*size = 0;
+	while ((n = file_read(f, (char *)data + *size, alloc - *size)) > 0) {
+		*size += n;
+		if (*size == alloc) {
+			alloc *= 2;
+			data = mem_realloc(data, alloc);
+		}
+	}
+
+	if (n < 0) {
+		mem_free(data);
+		return NULL;
+	}
+
+	return data;
+}
 
-	if (file_read(f, (char *) &head, 8) == 8 &&
+/**
+ * Check the savefile header file clearly inicates that it's a savefile
+ */
+static bool check_header(const byte *head, size_t len) {
+	if (len >= 8 &&
 			memcmp(&head[0], savefile_magic, 4) == 0 &&
 			memcmp(&head[4], savefile_name, 4) == 0)
 		return true;
@@ -461,13 +946,10 @@ static bool check_header(ang_file *f) {
 }
 
 /**
- * Get the next block header from the savefile
+ * Decode the block header held in the first len bytes of savefile_head
  */
-static errr next_blockheader(ang_file *f, struct blockheader *b) {
-	byte savefile_head[SAVEFILE_HEAD_SIZE];
-	size_t len;
-
-	len = file_read(f, (char *)savefile_head, SAVEFILE_HEAD_SIZE);
+static errr next_blockheader(const byte *savefile_head, size_t len,
+		struct blockheader *b) {
 	if (len == 0) /* no more blocks */
 		return 1;
 
@@ -481,9 +963,11 @@ static errr next_blockheader(ang_file *f, struct blockheader *b) {
 	((u32b) savefile_head[from+2] << 16) | \
 	((u32b) savefile_head[from+3] << 24);
 
-	my_strcpy(b->name, (char *)&savefile_head, sizeof b->name);
+	my_strcpy(b->name, (const char *)savefile_head, sizeof b->name);
 	b->version = RECONSTRUCT_U32B(16);
 	b->size = RECONSTRUCT_U32B(20);
+	b->packed = (b->version & SAVEFILE_PACKED) ? true : false;
+	b->version &= ~SAVEFILE_PACKED;
 
 	/* Pad to 4 bytes */
 	if (b->size % 4)
@@ -512,24 +996,36 @@ static loader_t find_loader(struct blockheader *b,
 }
 
 /**
- * Load a given block with the given loader
+ * Load a given block, whose len bytes are at data, with the given loader
  */
-static bool load_block(ang_file *f, struct blockheader *b, loader_t loader)
+static bool load_block(byte *data, u32b len, struct blockheader *b,
+		loader_t loader)
 {
-	/* Allocate space for the buffer */
-	buffer = mem_alloc(b->size);
-	buffer_pos = 0;
-	buffer_check = 0;
+	byte *unpacked = NULL;
+	bool loaded;
 
-	buffer_size = file_read(f, (char *) buffer, b->size);
-	if (buffer_size != b->size ||
-			loader() != 0) {
-		mem_free(buffer);
+	if (len < b->size)
 		return false;
+
+	/* Read straight out of the data we were given, unpacking it first if
+	 * need be */
+	if (b->packed) {
+		unpacked = sf_unpack(data, b->size, &buffer_size);
+		if (!unpacked)
+			return false;
+		buffer = unpacked;
+	} else {
+		buffer = data;
+		buffer_size = b->size;
 	}
+	buffer_pos = 0;
+	buffer_check = 0;
 
-	mem_free(buffer);
-	return true;
+	loaded = (loader() == 0);
+
+	buffer = NULL;
+	mem_free(unpacked);
+	return loaded;
 }
 
 /**
@@ -542,32 +1038,46 @@ static void skip_block(ang_file *f, struct blockheader *b)
 
 /**
  * Try to load a savefile
+ *
+ * The whole file is read in one go, and the blocks are then loaded from
+ * memory.
  */
 static bool try_load(ang_file *f, const struct blockinfo *local_loaders)
 {
 	struct blockheader b;
 	errr err;
+	u32b size, pos;
+	byte *data = read_savefile(f, &size);
 
-	if (!check_header(f)) {
+	if (!data || !check_header(data, size)) {
 		note("Savefile is corrupted -- incorrect file header.");
+		mem_free(data);
 		return false;
 	}
+	pos = 8;
 
 	/* Get the next block header */
-	while ((err = next_blockheader(f, &b)) == 0) {
+	while ((err = next_blockheader(data + pos,
+			MIN(size - pos, SAVEFILE_HEAD_SIZE), &b)) == 0) {
 		loader_t loader = find_loader(&b, local_loaders);
+		pos += SAVEFILE_HEAD_SIZE;
 		if (!loader) {
 			note("Savefile block can't be read.");
 			note("Maybe try and load the savefile in an earlier version of Angband.");
+			mem_free(data);
 			return false;
 		}
 
-		if (!load_block(f, &b, loader)) {
+		if (!load_block(data + pos, size - pos, &b, loader)) {
 			note(format("Savefile corrupted - Couldn't load block %s", b.name));
+			mem_free(data);
 			return false;
 		}
+		pos += b.size;
 	}
 
+	mem_free(data);
+
 	if (err == -1) {
 		note("Savefile is corrupted -- block header mangled.");
 		return false;
@@ -589,22 +1099,39 @@ static int get_desc(void) {
  */
 const char *savefile_get_description(const char *path) {
 	struct blockheader b;
-
-	ang_file *f = file_open(path, MODE_READ, FTYPE_TEXT);
-	if (!f) return NULL;
+	byte head[SAVEFILE_HEAD_SIZE];
+	const char *indexed = savefile_index_lookup(path);
+	ang_file *f;
+	int len;
 
 	/* Blank the description */
 	savefile_desc[0] = 0;
 
-	if (!check_header(f)) {
+	if (indexed) {
+		my_strcpy(savefile_desc, indexed, sizeof savefile_desc);
+		return savefile_desc;
+	}
+
+	f = file_open(path, MODE_READ, FTYPE_TEXT);
+	if (!f) return NULL;
+
+	/* Only the description is wanted, so read just the blocks up to it */
+	len = file_read(f, (char *)head, 8);
+	if (!check_header(head, MAX(len, 0))) {
 		my_strcpy(savefile_desc, "Invalid savefile", sizeof savefile_desc);
 	} else {
-		while (!next_blockheader(f, &b)) {
+		while ((len = file_read(f, (char *)head, SAVEFILE_HEAD_SIZE)) >= 0 &&
+				!next_blockheader(head, len, &b)) {
+			byte *data;
+
 			if (!streq(b.name, "description")) {
 				skip_block(f, &b);
 				continue;
 			}
-			load_block(f, &b, get_desc);
+			data = mem_alloc(b.size);
+			len = file_read(f, (char *)data, b.size);
+			load_block(data, MAX(len, 0), &b, get_desc);
+			mem_free(data);
 			break;
 		}
 	}
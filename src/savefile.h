@@ -19,7 +19,7 @@
 #define INCLUDED_SAVEFILE_H
 
 #define FINISHED_CODE 255
-#define ITEM_VERSION	5
+#define ITEM_VERSION	6
 #define EGO_ART_KNOWN 0xffffffff
 
 /**
@@ -27,6 +27,11 @@
  * Savefile API
  * ------------------------------------------------------------------------ */
 
+/**
+ * Name of the index of savefile descriptions kept in each savefile directory
+ */
+#define SAVEFILE_INDEX_NAME "savefile.idx"
+
 /**
  * Global "we've just saved" variable
  */
@@ -37,6 +42,22 @@ extern bool character_saved;
  */
 bool savefile_save(const char *path);
 
+/**
+ * How many saves have been made, and how big and slow the last one was
+ */
+struct savefile_stats {
+	u32b saves;
+	u32b last_bytes;
+	double last_ms;
+};
+
+void savefile_get_stats(struct savefile_stats *stats);
+
+/**
+ * Free the memory kept between saves.
+ */
+void savefile_cleanup(void);
+
 /**
  * Load the savefile given.  Returns true on succcess, false otherwise.
  */
@@ -94,10 +115,13 @@ int rd_gear(void);
 int rd_stores(void);
 int rd_dungeon(void);
 int rd_chunks(void);
+int rd_chunks_1(void);
 int rd_objects(void);
 int rd_monsters(void);
+int rd_monsters_1(void);
 int rd_history(void);
 int rd_traps(void);
+int rd_traps_1(void);
 int rd_null(void);
 
 /* save.c */
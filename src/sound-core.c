@@ -84,6 +84,14 @@ static struct sound_hooks hooks;
  */
 static bool preload_sounds = false;
 
+/*
+ * Sounds before this one have had their chance to load while the player
+ * was idle; see sound_load_idle().
+ */
+static u16b next_idle_sound_id;
+
+#define SOUNDS_PER_IDLE	4
+
 static struct sound_data *grow_sound_list(void)
 {
 	int new_size;
@@ -282,6 +290,27 @@ errr register_sound_pref_parser(struct parser *p)
 #endif
 }
 
+/**
+ * Load a few of the sounds which haven't been played yet, so that the
+ * first play of each doesn't have to wait for it to be read and decoded.
+ * Front ends call this (through idle_update()) while waiting for a key.
+ */
+void sound_load_idle(void)
+{
+	int n = 0;
+
+	if (!hooks.load_sound_hook) return;
+
+	while ((next_idle_sound_id < next_sound_id) && (n < SOUNDS_PER_IDLE)) {
+		struct sound_data *sound_data = &sounds[next_idle_sound_id++];
+
+		if (sound_data->loaded) continue;
+
+		load_sound(sound_data);
+		n++;
+	}
+}
+
 /**
  * Play a sound of type "event".
  */
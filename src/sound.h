@@ -64,5 +64,6 @@ struct sound_hooks
 errr init_sound(const char *soundstr, int argc, char **argv);
 errr register_sound_pref_parser(struct parser *p);
 void print_sound_help(void);
+void sound_load_idle(void);
 
 #endif /* !INCLUDED_SOUND_H */
@@ -38,6 +38,7 @@
 #include "obj-util.h"
 #include "player-calcs.h"
 #include "player-history.h"
+#include "profile.h"
 #include "store.h"
 #include "target.h"
 #include "debug.h"
@@ -50,6 +51,11 @@ static void store_maint(struct store *s);
  * Constants and definitions
  * ------------------------------------------------------------------------ */
 
+/**
+ * Maintenance passes after which a store's stock no longer depends on what
+ * it held before; used to fill new stores and to cap catching up on return
+ */
+#define STORE_MAINT_PASSES	10
 
 /**
  * Array[MAX_STORES] of stores
@@ -347,7 +353,7 @@ void store_reset(void) {
 		s->stock = NULL;
 		if (i == STORE_HOME)
 			continue;
-		for (j = 0; j < 10; j++)
+		for (j = 0; j < STORE_MAINT_PASSES; j++)
 			store_maint(s);
 	}
 }
@@ -1353,11 +1359,17 @@ static void store_maint(struct store *s)
  */
 void store_update(void)
 {
+	int rng = Rand_stream(RNG_STORES);
+	int passes = MIN(daycount, STORE_MAINT_PASSES);
+
+	PROFILE_BEGIN("store_update");
 	if (OPT(player, cheat_xtra)) msg("Updating Shops...");
-	while (daycount--) {
+
+	/* Maintain each shop (except home); after a long absence the last few
+	 * passes give the same stock as running all of them would */
+	while (passes--) {
 		int n;
 
-		/* Maintain each shop (except home) */
 		for (n = 0; n < MAX_STORES; n++) {
 			/* Skip the home */
 			if (n == STORE_HOME) continue;
@@ -1365,8 +1377,12 @@ void store_update(void)
 			/* Maintain */
 			store_maint(&stores[n]);
 		}
+	}
+
+	/* Sometimes, shuffle the shop-keepers, once per day missed */
+	while (daycount--) {
+		int n;
 
-		/* Sometimes, shuffle the shop-keepers */
 		if (one_in_(z_info->store_shuffle)) {
 			/* Message */
 			if (OPT(player, cheat_xtra)) msg("Shuffling a Shopkeeper...");
@@ -1383,6 +1399,9 @@ void store_update(void)
 	}
 	daycount = 0;
 	if (OPT(player, cheat_xtra)) msg("Done.");
+	PROFILE_END("store_update");
+
+	Rand_stream(rng);
 }
 
 /** Owner stuff **/
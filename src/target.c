@@ -223,6 +223,19 @@ bool target_is_set(void)
 	return target_set;
 }
 
+/**
+ * Sorting hook -- order grids row by row, as a scan of the map meets them
+ */
+static int cmp_grid(const void *a, const void *b)
+{
+	const struct loc *pa = a;
+	const struct loc *pb = b;
+
+	if (pa->y != pb->y)
+		return pa->y - pb->y;
+	return pa->x - pb->x;
+}
+
 /**
  * Sorting hook -- comp function -- by "distance to player"
  *
@@ -387,6 +400,29 @@ void target_get(int *x, int *y)
 }
 
 
+/**
+ * Copy out the target, so that it can be put back just as it was
+ */
+void target_save(struct target *t)
+{
+	t->set = target_set;
+	t->who = target_who;
+	t->x = target_x;
+	t->y = target_y;
+}
+
+/**
+ * Put back a target copied out with target_save()
+ */
+void target_restore(const struct target *t)
+{
+	target_set = t->set;
+	target_who = t->who;
+	target_x = t->x;
+	target_y = t->y;
+}
+
+
 /**
  * Returns the currently targeted monster index.
  */
@@ -417,34 +453,55 @@ bool target_sighted(void)
  */
 struct point_set *target_get_monsters(int mode)
 {
-	int y, x;
+	int y, x, i;
 	int min_y, min_x, max_y, max_x;
 	struct point_set *targets = point_set_new(TS_INITIAL_SIZE);
 
 	/* Get the current panel */
 	get_panel(&min_y, &min_x, &max_y, &max_x);
 
-	/* Scan for targets */
-	for (y = min_y; y < max_y; y++) {
-		for (x = min_x; x < max_x; x++) {
+	if (mode & (TARGET_KILL)) {
+		/* Only grids holding monsters can qualify, so look just at those */
+		s16b *found = mem_zalloc(cave_monster_max(cave) * sizeof(s16b));
+		int n = monsters_in_rect(cave, min_y, min_x, max_y - 1, max_x - 1,
+								 found);
+
+		for (i = 0; i < n; i++) {
+			struct monster *mon = cave_monster(cave, found[i]);
+			y = mon->fy;
+			x = mon->fx;
+
 			/* Check bounds */
 			if (!square_in_bounds_fully(cave, y, x)) continue;
 
 			/* Require "interesting" contents */
 			if (!target_accept(y, x)) continue;
 
-			/* Special mode */
-			if (mode & (TARGET_KILL)) {
-				/* Must contain a monster */
-				if (!(cave->squares[y][x].mon > 0)) continue;
-
-				/* Must be a targettable monster */
-			 	if (!target_able(square_monster(cave, y, x))) continue;
-			}
+			/* Must be a monster we can target */
+			if (!target_able(mon)) continue;
 
 			/* Save the location */
 			add_to_point_set(targets, y, x);
 		}
+		mem_free(found);
+
+		/* Put the grids in the order a scan of the panel would give */
+		sort(targets->pts, point_set_size(targets), sizeof(*(targets->pts)),
+			 cmp_grid);
+	} else {
+		/* Scan for targets */
+		for (y = min_y; y < max_y; y++) {
+			for (x = min_x; x < max_x; x++) {
+				/* Check bounds */
+				if (!square_in_bounds_fully(cave, y, x)) continue;
+
+				/* Require "interesting" contents */
+				if (!target_accept(y, x)) continue;
+
+				/* Save the location */
+				add_to_point_set(targets, y, x);
+			}
+		}
 	}
 
 	sort(targets->pts, point_set_size(targets), sizeof(*(targets->pts)),
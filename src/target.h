@@ -34,6 +34,15 @@
 #define TARGET_GRID   0x08
 #define TARGET_QUIET  0x10
 
+/**
+ * The target as it stands, to put back after something that clears it
+ */
+struct target {
+	bool set;
+	struct monster *who;
+	int x, y;
+};
+
 int motion_dir(int y1, int x1, int y2, int x2);
 void look_mon_desc(char *buf, size_t max, int m_idx);
 bool target_able(struct monster *m);
@@ -46,6 +55,8 @@ s16b target_pick(int y1, int x1, int dy, int dx, struct point_set *targets);
 bool target_accept(int y, int x);
 void coords_desc(char *buf, int size, int y, int x);
 void target_get(int *x, int *y);
+void target_save(struct target *t);
+void target_restore(const struct target *t);
 struct monster *target_get_monster(void);
 bool target_sighted(void);
 struct point_set *target_get_monsters(int mode);
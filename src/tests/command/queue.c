@@ -0,0 +1,106 @@
+/* command/queue */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "cmd-core.h"
+#include "player.h"
+
+int setup_tests(void **state) {
+	player = &test_player;
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	cmdq_free();
+	return 0;
+}
+
+/* Commands carry a tag in nrepeats; nothing runs for CMD_NULL */
+static struct command tagged(int tag) {
+	struct command cmd = { .code = CMD_NULL, .nrepeats = tag };
+	return cmd;
+}
+
+static int pop_tag(void) {
+	return cmdq_pop(CMD_GAME) ? cmd_get_nrepeats() : -1;
+}
+
+int test_batch(void *state) {
+	struct command cmds[40];
+	int i;
+
+	for (i = 0; i < 40; i++)
+		cmds[i] = tagged(i + 1);
+
+	/* Too many for the usual queue, so nothing goes in */
+	eq(cmdq_push_batch(cmds, 40), 1);
+	eq(pop_tag(), -1);
+
+	require(!cmdq_set_size(64));
+	eq(cmdq_space(), 63);
+	eq(cmdq_push_batch(cmds, 40), 0);
+	eq(cmdq_space(), 23);
+	for (i = 0; i < 40; i++)
+		eq(pop_tag(), i + 1);
+	eq(pop_tag(), -1);
+	ok;
+}
+
+/* Resizing keeps what is waiting, in order, wherever the ring has got to */
+int test_resize(void *state) {
+	struct command cmd;
+	int i;
+
+	require(!cmdq_set_size(8));
+	for (i = 0; i < 5; i++) {
+		cmd = tagged(i + 1);
+		eq(cmdq_push_copy(&cmd), 0);
+	}
+	eq(pop_tag(), 1);
+	eq(pop_tag(), 2);
+	for (i = 5; i < 9; i++) {
+		cmd = tagged(i + 1);
+		eq(cmdq_push_copy(&cmd), 0);
+	}
+	eq(cmdq_space(), 0);
+	eq(cmdq_push_copy(&cmd), 1);
+
+	/* Too small for what is waiting */
+	eq(cmdq_set_size(4), 1);
+
+	require(!cmdq_set_size(10));
+	eq(cmdq_space(), 2);
+	eq(cmd_get_nrepeats(), 2);
+	for (i = 2; i < 9; i++)
+		eq(pop_tag(), i + 1);
+	eq(pop_tag(), -1);
+	ok;
+}
+
+/* cmdq_peek() finds the command pushed by cmdq_push_copy(), whatever else
+ * has been pushed since */
+int test_peek(void *state) {
+	struct command cmd = tagged(1);
+	struct command cmds[2];
+
+	cmds[0] = tagged(2);
+	cmds[1] = tagged(3);
+	eq(cmdq_push_copy(&cmd), 0);
+	eq(cmdq_push_batch(cmds, 2), 0);
+	eq(cmdq_peek()->nrepeats, 1);
+	cmdq_peek()->nrepeats = 4;
+
+	eq(pop_tag(), 4);
+	eq(pop_tag(), 2);
+	eq(pop_tag(), 3);
+	eq(pop_tag(), -1);
+	ok;
+}
+
+const char *suite_name = "command/queue";
+struct test tests[] = {
+	{ "batch", test_batch },
+	{ "resize", test_resize },
+	{ "peek", test_peek },
+	{ NULL, NULL }
+};
@@ -0,0 +1,116 @@
+/* game-event/event.c */
+
+#include "unit-test.h"
+#include "game-event.h"
+
+static int order[8];
+static int n_calls;
+static int n_grids;
+static bool got_all;
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	event_remove_all_handlers();
+	return 0;
+}
+
+static void note_call(game_event_type type, game_event_data *data, void *user)
+{
+	order[n_calls++] = *(int *)user;
+}
+
+static void note_points(game_event_type type, game_event_data *data,
+						void *user)
+{
+	n_calls++;
+	if (data->points.all)
+		got_all = true;
+	else
+		n_grids += data->points.count;
+}
+
+/* Handlers are called newest first, and can be removed from the middle */
+int test_order(void *state) {
+	static int ids[3] = { 1, 2, 3 };
+
+	event_add_handler(EVENT_INPUT_FLUSH, note_call, &ids[0]);
+	event_add_handler(EVENT_INPUT_FLUSH, note_call, &ids[1]);
+	event_add_handler(EVENT_INPUT_FLUSH, note_call, &ids[2]);
+	n_calls = 0;
+	event_signal(EVENT_INPUT_FLUSH);
+	eq(n_calls, 3);
+	eq(order[0], 3);
+	eq(order[2], 1);
+
+	event_remove_handler(EVENT_INPUT_FLUSH, note_call, &ids[1]);
+	n_calls = 0;
+	event_signal(EVENT_INPUT_FLUSH);
+	eq(n_calls, 2);
+	eq(order[0], 3);
+	eq(order[1], 1);
+
+	event_remove_handler_type(EVENT_INPUT_FLUSH);
+	n_calls = 0;
+	event_signal(EVENT_INPUT_FLUSH);
+	eq(n_calls, 0);
+	ok;
+}
+
+/* Repeated points go out once, in one batch, when flushed */
+int test_coalesce(void *state) {
+	int i;
+
+	event_set_coalescing(EVENT_MAP, true);
+	event_add_handler(EVENT_MAP, note_points, NULL);
+	n_calls = n_grids = 0;
+	got_all = false;
+
+	for (i = 0; i < 1000; i++)
+		event_signal_point(EVENT_MAP, i % 300, i % 7);
+	eq(n_calls, 0);
+	event_flush_points();
+	eq(n_calls, 1);
+	eq(n_grids, 1000);
+	event_flush_points();
+	eq(n_calls, 1);
+
+	/* Any other event sends waiting points first */
+	event_signal_point(EVENT_MAP, 1, 1);
+	event_signal_point(EVENT_MAP, 1, 1);
+	event_signal(EVENT_INPUT_FLUSH);
+	eq(n_calls, 2);
+	eq(n_grids, 1001);
+
+	/* A whole-map redraw replaces anything waiting */
+	event_signal_point(EVENT_MAP, 2, 2);
+	event_signal_point(EVENT_MAP, -1, -1);
+	eq(n_calls, 3);
+	require(got_all);
+	event_flush_points();
+	eq(n_calls, 3);
+	eq(n_grids, 1001);
+
+	/* Without coalescing each point goes out at once, still as a batch */
+	event_set_coalescing(EVENT_MAP, false);
+	got_all = false;
+	event_signal_point(EVENT_MAP, 3, 4);
+	eq(n_calls, 4);
+	eq(n_grids, 1002);
+	require(!got_all);
+	event_signal_point(EVENT_MAP, -1, -1);
+	eq(n_calls, 5);
+	require(got_all);
+
+	event_remove_handler(EVENT_MAP, note_points, NULL);
+	ok;
+}
+
+const char *suite_name = "game-event/event";
+struct test tests[] = {
+	{ "order", test_order },
+	{ "coalesce", test_coalesce },
+	{ NULL, NULL }
+};
@@ -40,6 +40,7 @@ int setup_tests(void **state) {
 
 int teardown_tests(void **state) {
 	file_delete("Test1");
+	file_delete(SAVEFILE_INDEX_NAME);
 	cleanup_angband();
 	return 0;
 }
@@ -76,6 +77,12 @@ int test_newgame(void *state) {
 	/* Make sure it saved properly */
 	eq(file_exists("Test1"), true);
 
+	/* The description should come back from the index */
+	eq(file_exists(SAVEFILE_INDEX_NAME), true);
+	eq(streq(savefile_get_description("Test1"), format("%s, L%d %s %s, at DL%d",
+		player->full_name, player->lev, player->race->name,
+		player->class->name, player->depth)), true);
+
 	ok;
 }
 
@@ -0,0 +1,139 @@
+/* game/pregen */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "init.h"
+#include "mon-make.h"
+#include "monster.h"
+#include "player.h"
+#include "savefile.h"
+#include "z-util.h"
+
+static void println(const char *str) {
+	printf("%s\n", str);
+}
+
+int setup_tests(void **state) {
+	plog_aux = println;
+	set_file_paths();
+	init_angband();
+	return 0;
+}
+
+int teardown_tests(void **state) {
+	file_delete("Test-pregen");
+	cleanup_angband();
+	return 0;
+}
+
+static void birth(void) {
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", "Tester");
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	cave_generate(&cave, player);
+	on_new_level();
+}
+
+static u32b mix(u32b h, u32b v) {
+	return (h ^ v) * 16777619U;
+}
+
+/* Everything about the level that should be the same however it was made */
+static u32b level_hash(void) {
+	struct rand_state rng;
+	u32b h = 2166136261U;
+	int y, x, i;
+
+	for (y = 0; y < cave->height; y++) {
+		for (x = 0; x < cave->width; x++) {
+			struct monster *mon = square_monster(cave, y, x);
+			struct object *obj = square_object(cave, y, x);
+
+			h = mix(h, cave->squares[y][x].feat);
+			h = mix(h, mon ? mon->race->ridx : 0);
+			h = mix(h, obj ? obj->kind->kidx : 0);
+		}
+	}
+	for (i = 0; i < z_info->r_max; i++)
+		h = mix(h, r_info[i].cur_num);
+	for (i = 0; i < z_info->a_max; i++)
+		h = mix(h, a_info[i].created);
+	Rand_stream_get(RNG_GENERATION, &rng);
+	for (i = 0; i < RAND_DEG; i++)
+		h = mix(h, rng.state[(rng.state_i + i) % RAND_DEG]);
+	h = mix(h, player->py);
+	h = mix(h, player->px);
+	h = mix(h, num_repro);
+
+	return h;
+}
+
+/* Give up on building ahead straight away */
+static bool give_up(void) {
+	return true;
+}
+
+/* Go down from the saved level, building the level ahead first or not */
+static int go_down(bool pregen, u32b *hash, u64b *fingerprint) {
+	/* Loading doesn't let go of the monsters on the level it replaces */
+	wipe_mon_list(cave, player);
+	require(savefile_load("Test-pregen", false));
+	if (pregen) {
+		/* A level given up on leaves nothing behind */
+		require(!cave_pregenerate(player, give_up));
+
+		require(cave_pregenerate(player, NULL));
+
+		/* Nothing has changed, so it is kept */
+		require(!cave_pregenerate(player, NULL));
+	}
+	cmdq_push(CMD_GO_DOWN);
+	run_game_loop();
+	eq(player->depth, 2);
+
+	*hash = level_hash();
+
+	/* However it was made, the fingerprint was kept up as it went */
+	require(cave->fingerprint == chunk_fingerprint(cave));
+	*fingerprint = cave->fingerprint;
+	return 0;
+}
+
+/* Taking the stairs makes the same level whether it was built ahead or not */
+int test_same_level(void *state) {
+	u32b built, made;
+	u64b built_fp, made_fp;
+
+	birth();
+	cmdq_push(CMD_GO_DOWN);
+	run_game_loop();
+	eq(player->depth, 1);
+	square_set_feat(cave, player->py, player->px, FEAT_MORE);
+	require(savefile_save("Test-pregen"));
+
+	require(!go_down(true, &built, &built_fp));
+	require(!go_down(false, &made, &made_fp));
+	eq(built, made);
+	require(built_fp == made_fp);
+	ok;
+}
+
+const char *suite_name = "game/pregen";
+struct test tests[] = {
+	{ "same_level", test_same_level },
+	{ NULL, NULL }
+};
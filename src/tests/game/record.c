@@ -0,0 +1,110 @@
+/* game/record */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+
+#include "cave.h"
+#include "cmd-core.h"
+#include "cmd-record.h"
+#include "game-world.h"
+#include "init.h"
+#include "player.h"
+#include "player-util.h"
+#include "z-util.h"
+
+static void println(const char *str) {
+	printf("%s\n", str);
+}
+
+int setup_tests(void **state) {
+	plog_aux = println;
+	set_file_paths();
+	init_angband();
+	return 0;
+}
+
+int teardown_tests(void **state) {
+	file_delete("Test-record");
+	cleanup_angband();
+	return 0;
+}
+
+static void birth(void) {
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", "Tester");
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	cave_generate(&cave, player);
+	on_new_level();
+}
+
+static void walk(int dir) {
+	/* A dead character's commands go nowhere */
+	if (player->is_dead) return;
+	cmdq_push(CMD_WALK);
+	cmd_set_arg_direction(cmdq_peek(), "direction", dir);
+	run_game_loop();
+}
+
+/* A game played back from its record should end up just as it was */
+int test_roundtrip(void *state) {
+	static const int dirs[] = { 2, 2, 6, 6, 8, 4, 1, 3, 9, 7, 2, 6 };
+	struct record_digest made, played, want;
+	size_t i;
+
+	require(cmd_record_start("Test-record"));
+	birth();
+	cmdq_push(CMD_GO_DOWN);
+	run_game_loop();
+	for (i = 0; i < N_ELEMENTS(dirs); i++)
+		walk(dirs[i]);
+	if (!player->is_dead) {
+		cmdq_push(CMD_REST);
+		cmd_set_arg_choice(cmdq_peek(), "choice", 20);
+		run_game_loop();
+	}
+	if (!player->is_dead && player->upkeep->inven[0]->number > 1) {
+		cmdq_push(CMD_DROP);
+		cmd_set_arg_item(cmdq_peek(), "item", player->upkeep->inven[0]);
+		cmd_set_arg_number(cmdq_peek(), "quantity", 1);
+		run_game_loop();
+		cmdq_push(CMD_PICKUP);
+		cmd_set_arg_item(cmdq_peek(), "item",
+						 square_object(cave, player->py, player->px));
+		run_game_loop();
+	}
+	cmd_record_digest(&made);
+	cmd_record_stop();
+	eq(made.depth, 1);
+
+	require(cmd_replay_start("Test-record"));
+	character_generated = false;
+	while (cmd_replay_push(CMD_BIRTH))
+		cmdq_execute(CMD_BIRTH);
+	cave_generate(&cave, player);
+	on_new_level();
+	while (!player->is_dead && cmd_replay_push(CMD_GAME))
+		run_game_loop();
+	cmd_record_digest(&played);
+	require(cmd_replay_expected(&want));
+	cmd_record_stop();
+
+	require(!memcmp(&made, &want, sizeof(made)));
+	require(!memcmp(&played, &want, sizeof(played)));
+	ok;
+}
+
+const char *suite_name = "game/record";
+struct test tests[] = {
+	{ "roundtrip", test_roundtrip },
+	{ NULL, NULL }
+};
@@ -0,0 +1,213 @@
+/* game/soak */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+
+#include <stdlib.h>
+#include "cave.h"
+#include "cmd-core.h"
+#include "game-world.h"
+#include "generate.h"
+#include "init.h"
+#include "mon-make.h"
+#include "obj-pile.h"
+#include "player.h"
+#include "player-calcs.h"
+#include "player-timed.h"
+#include "player-util.h"
+#include "profile.h"
+#include "savefile.h"
+#include "store.h"
+#include "z-util.h"
+
+/*
+ * A long walk about the dungeon, changing level, restocking the stores and
+ * saving and loading along the way, that fails if memory keeps growing or
+ * the slowest commands get too slow.  By default it is short enough for
+ * every test run, and only memory is checked, since how long commands
+ * take depends on the machine; set SOAK_TURNS (player commands) and
+ * SOAK_GROWTH_KB in the environment for a proper soak, SOAK_P99_MS to fail
+ * on commands slower than that, and SOAK_SEED to walk a different way.
+ */
+#define SOAK_LEVEL_EVERY	200
+#define SOAK_STORE_EVERY	500
+#define SOAK_SAVE_EVERY		1000
+
+static void println(const char *str) {
+	printf("%s\n", str);
+}
+
+static int env_int(const char *name, int def) {
+	const char *val = getenv(name);
+	return (val && *val) ? atoi(val) : def;
+}
+
+int setup_tests(void **state) {
+	/* Memory can only be counted from the start */
+	mem_flags |= MEM_ACCOUNT;
+	plog_aux = println;
+	set_file_paths();
+	init_angband();
+	return 0;
+}
+
+int teardown_tests(void **state) {
+	file_delete("Test-soak");
+	file_delete(SAVEFILE_INDEX_NAME);
+	cleanup_angband();
+	return 0;
+}
+
+/* Bytes allocated now */
+static size_t live_bytes(void) {
+	size_t total = 0;
+	int i;
+
+	for (i = 0; i < MEM_TAG_MAX; i++) {
+		struct mem_tag_stats stats;
+
+		mem_tag_get(i, &stats);
+		total += stats.live;
+	}
+	return total;
+}
+
+/*
+ * The loader expects to start from nothing, as it does when the game is
+ * first run, so let go of everything it is going to replace
+ */
+static void forget_game(void) {
+	wipe_mon_list(cave, player);
+	chunk_list_free();
+	cave_free(cave);
+	cave = NULL;
+	cave_free(player->cave);
+	player->cave = NULL;
+	object_pile_free(player->gear);
+	object_pile_free(player->gear_k);
+	player->gear = player->gear_k = NULL;
+}
+
+static int cmp_ms(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void birth(void) {
+	int i;
+
+	cmdq_push(CMD_BIRTH_INIT);
+	cmdq_push(CMD_BIRTH_RESET);
+	cmdq_push(CMD_CHOOSE_RACE);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_CHOOSE_CLASS);
+	cmd_set_arg_choice(cmdq_peek(), "choice", 0);
+	cmdq_push(CMD_ROLL_STATS);
+	cmdq_push(CMD_NAME_CHOICE);
+	cmd_set_arg_string(cmdq_peek(), "name", "Soaker");
+	cmdq_push(CMD_ACCEPT_CHARACTER);
+	cmdq_execute(CMD_BIRTH);
+
+	/* Tough enough to wander anywhere */
+	for (i = 0; i < PY_MAX_LEVEL; i++)
+		player->player_hp[i] = 10000;
+	player->upkeep->update |= PU_HP;
+	update_stuff(player);
+	player->chp = player->mhp;
+
+	cave_generate(&cave, player);
+	on_new_level();
+}
+
+int test_soak(void *state) {
+	int turns = env_int("SOAK_TURNS", 3000);
+	int growth_kb = env_int("SOAK_GROWTH_KB", 512);
+	int p99_ms = env_int("SOAK_P99_MS", 0);
+	double *samples = mem_zalloc(MAX(turns, 1) * sizeof(double));
+	size_t baseline = 0, last = 0;
+	int levels = 0, most_monsters = 0, most_objects = 0, most_chunks = 0;
+	int i;
+	double p50, p99, slowest;
+
+	Rand_init();
+	Rand_state_init(env_int("SOAK_SEED", 0x50a4));
+	birth();
+
+	for (i = 0; i < turns; i++) {
+		double start;
+
+		/* Change level now and then, anywhere shallow enough that
+		 * nothing can hold the player helpless for long */
+		if (i % SOAK_LEVEL_EVERY == 0)
+			dungeon_change_level(player, randint0(16));
+
+		/* Restock the stores as if a day had gone by */
+		if (i % SOAK_STORE_EVERY == SOAK_STORE_EVERY - 1) {
+			daycount = 1;
+			store_update();
+		}
+
+		/* Save and load the game back, as if starting afresh */
+		if (i % SOAK_SAVE_EVERY == SOAK_SAVE_EVERY - 1) {
+			require(savefile_save("Test-soak"));
+			forget_game();
+			require(savefile_load("Test-soak", false));
+			require(cave->fingerprint == chunk_fingerprint(cave));
+		}
+
+		/* Walk (or fight) somewhere */
+		player->chp = player->mhp;
+		player->food = PY_FOOD_FULL - 1;
+		cmdq_push(CMD_WALK);
+		cmd_set_arg_direction(cmdq_peek(), "direction",
+							  ddd[randint0(8)]);
+		start = profile_now();
+		run_game_loop();
+		samples[i] = profile_now() - start;
+		require(!player->is_dead);
+
+		/* Look around after each new level has been made */
+		if (i % SOAK_LEVEL_EVERY == 0) {
+			require(cave->fingerprint == chunk_fingerprint(cave));
+			last = live_bytes();
+			if (++levels == 3) baseline = last;
+		}
+		most_monsters = MAX(most_monsters, cave_monster_max(cave));
+		most_objects = MAX(most_objects, cave->obj_max);
+		most_chunks = MAX(most_chunks, chunk_list_max);
+	}
+
+	sort(samples, turns, sizeof(double), cmp_ms);
+	p50 = turns ? samples[turns / 2] : 0.0;
+	p99 = turns ? samples[(turns * 99) / 100] : 0.0;
+	slowest = turns ? samples[turns - 1] : 0.0;
+	mem_free(samples);
+
+	if (verbose) {
+		printf("    %d commands, %d levels: %.3f ms median, %.3f ms p99, "
+			   "%.3f ms slowest\n", turns, levels, p50, p99, slowest);
+		printf("    memory %lu -> %lu bytes; at most %d monsters, %d "
+			   "object slots, %d stored chunks\n", (unsigned long)baseline,
+			   (unsigned long)last, most_monsters, most_objects, most_chunks);
+	}
+
+	/* Only the town is ever kept */
+	require(most_chunks <= 1);
+
+	/* Nothing should pile up from level to level */
+	if (levels > 3)
+		require(last <= baseline + (size_t)growth_kb * 1024);
+
+	/* The slowest one in a hundred commands is still quick */
+	if (p99_ms)
+		require(p99 <= p99_ms);
+
+	ok;
+}
+
+const char *suite_name = "game/soak";
+struct test tests[] = {
+	{ "soak", test_soak },
+	{ NULL, NULL }
+};
@@ -0,0 +1,126 @@
+/* generate/cavern */
+
+#include "unit-test.h"
+#include "unit-test-data.h"
+#include "test-utils.h"
+
+#include "cave.h"
+#include "generate.h"
+#include "init.h"
+#include "z-rand.h"
+
+int setup_tests(void **state) {
+	set_file_paths();
+	init_angband();
+	return 0;
+}
+
+int teardown_tests(void **state) {
+	cleanup_angband();
+	return 0;
+}
+
+/* The walls (0-8) next to a square, as mutate_cavern() used to count them */
+static int count_adj_walls(struct chunk *c, int y, int x) {
+	int yd, xd;
+	int count = 0;
+
+	for (yd = -1; yd <= 1; yd++) {
+		for (xd = -1; xd <= 1; xd++) {
+			if (yd == 0 && xd == 0) continue;
+			if (square_isfloor(c, y + yd, x + xd)) continue;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* One pass of the rules (4,5), a square at a time */
+static void mutate_reference(struct chunk *c) {
+	int y, x;
+	int h = c->height;
+	int w = c->width;
+	int *temp = mem_zalloc(h * w * sizeof(int));
+
+	for (y = 1; y < h - 1; y++) {
+		for (x = 1; x < w - 1; x++) {
+			int count = count_adj_walls(c, y, x);
+			if (count > 5)
+				temp[y * w + x] = FEAT_GRANITE;
+			else if (count < 4)
+				temp[y * w + x] = FEAT_FLOOR;
+			else
+				temp[y * w + x] = c->squares[y][x].feat;
+		}
+	}
+
+	for (y = 1; y < h - 1; y++) {
+		for (x = 1; x < w - 1; x++) {
+			if (temp[y * w + x] == FEAT_GRANITE)
+				set_marked_granite(c, y, x, SQUARE_WALL_SOLID);
+			else
+				square_set_feat(c, y, x, temp[y * w + x]);
+		}
+	}
+
+	mem_free(temp);
+}
+
+/* Rock with a share of floors scattered over it, as init_cavern() makes */
+static void fill_cavern(struct chunk *c, int density) {
+	int y, x;
+
+	fill_rectangle(c, 0, 0, c->height - 1, c->width - 1, FEAT_GRANITE,
+				   SQUARE_WALL_SOLID);
+	for (y = 1; y < c->height - 1; y++)
+		for (x = 1; x < c->width - 1; x++)
+			if (randint0(100) < density)
+				square_set_feat(c, y, x, FEAT_FLOOR);
+}
+
+/* Caverns of widths either side of a word come out as they used to */
+static int test_mutate(void *state) {
+	int widths[] = { 3, 5, 31, 32, 33, 63, 64, 65, 100, 198 };
+	size_t i;
+
+	Rand_state_init(47);
+	for (i = 0; i < N_ELEMENTS(widths); i++) {
+		int density, pass, y, x;
+
+		for (density = 25; density <= 75; density += 25) {
+			struct chunk *a = cave_new(23, widths[i]);
+			struct chunk *b = cave_new(23, widths[i]);
+
+			fill_cavern(a, density);
+			for (y = 0; y < a->height; y++) {
+				for (x = 0; x < a->width; x++) {
+					square_set_feat(b, y, x, a->squares[y][x].feat);
+					sqinfo_copy(b->squares[y][x].info, a->squares[y][x].info);
+				}
+			}
+
+			for (pass = 0; pass < 4; pass++) {
+				mutate_cavern(a);
+				mutate_reference(b);
+				for (y = 0; y < a->height; y++) {
+					for (x = 0; x < a->width; x++) {
+						eq(a->squares[y][x].feat, b->squares[y][x].feat);
+						require(sqinfo_is_equal(a->squares[y][x].info,
+												b->squares[y][x].info));
+					}
+				}
+			}
+
+			cave_free(a);
+			cave_free(b);
+		}
+	}
+	ok;
+}
+
+const char *suite_name = "generate/cavern";
+struct test tests[] = {
+	{ "mutate", test_mutate },
+	{ NULL, NULL }
+};
@@ -0,0 +1 @@
+TESTPROGS += generate/cavern
@@ -9,6 +9,7 @@
 #include "unit-test.h"
 #include "unit-test-data.h"
 #include "test-utils.h"
+#include "mon-desc.h"
 #include "mon-util.h"
 
 int setup_tests(void **state) {
@@ -43,8 +44,46 @@ int test_match_monster_bases(void *state) {
 	ok;
 }
 
+/* Descriptions come out the same however often, and into whatever buffer,
+ * they are asked for */
+int test_monster_desc(void *state) {
+	struct monster mon;
+	char buf[80], expect[80];
+	struct monster_race *dog = &r_info[3];
+	struct monster_race *morgoth = lookup_monster("Morgoth, Lord of Darkness");
+
+	memset(&mon, 0, sizeof(mon));
+	mon.race = dog;
+	strnfmt(expect, sizeof(expect), "the %s", dog->name);
+
+	monster_desc(buf, sizeof(buf), &mon, MDESC_SHOW);
+	require(streq(buf, expect));
+	monster_desc(buf, 8, &mon, MDESC_SHOW);
+	require(strlen(buf) == 7 && !strncmp(buf, expect, 7));
+	monster_desc(buf, sizeof(buf), &mon, MDESC_SHOW | MDESC_CAPITAL);
+	require(buf[0] == 'T' && streq(buf + 1, expect + 1));
+	monster_desc(buf, sizeof(buf), &mon, MDESC_SHOW);
+	require(streq(buf, expect));
+
+	monster_desc(buf, sizeof(buf), &mon, MDESC_HIDE);
+	require(streq(buf, "it"));
+	monster_desc(buf, sizeof(buf), &mon, MDESC_HIDE | MDESC_IND_HID);
+	require(streq(buf, "something"));
+
+	mon.race = morgoth;
+	monster_desc(buf, sizeof(buf), &mon, MDESC_SHOW);
+	require(streq(buf, morgoth->name));
+	monster_desc(buf, sizeof(buf), &mon, MDESC_SHOW | MDESC_PRO_VIS);
+	require(streq(buf, "he"));
+	monster_desc(buf, sizeof(buf), &mon, MDESC_HIDE | MDESC_IND_HID |
+				 MDESC_PRO_HID);
+	require(streq(buf, "someone"));
+	ok;
+}
+
 const char *suite_name = "monster/monster";
 struct test tests[] = {
 	{ "match_monster_bases", test_match_monster_bases },
+	{ "monster_desc", test_monster_desc },
 	{ NULL, NULL }
 };
@@ -5,14 +5,20 @@
 #include "unit-test.h"
 #include "unit-test-data.h"
 
+#include "cave.h"
+#include "init.h"
 #include "object.h"
 #include "obj-pile.h"
 
 int setup_tests(void **state) {
+	z_info = mem_zalloc(sizeof(struct angband_constants));
 	return 0;
 }
 
-NOTEARDOWN
+int teardown_tests(void **state) {
+	mem_free(z_info);
+	return 0;
+}
 
 /* Testing the linked list functions in obj-pile.c */
 int test_obj_piles(void *state) {
@@ -90,8 +96,53 @@ int test_obj_piles(void *state) {
 	ok;
 }
 
+/* Objects go in the lowest free slot of a chunk's list, which grows when
+ * there is none */
+int test_obj_list(void *state) {
+	struct chunk *c = known_cave_new(4, 4);
+	struct object *objs[300];
+	struct object *o1 = object_new();
+	struct object *o2 = object_new();
+	struct object *o3 = object_new();
+	int i;
+
+	for (i = 0; i < 300; i++) {
+		objs[i] = object_new();
+		list_object(c, objs[i]);
+		eq(objs[i]->oidx, i + 1);
+	}
+	require(c->obj_max > 300);
+
+	/* Listing again changes nothing */
+	list_object(c, objs[10]);
+	eq(objs[10]->oidx, 11);
+
+	/* Holes are filled lowest first */
+	delist_object(c, objs[199]);
+	delist_object(c, objs[4]);
+	eq(objs[4]->oidx, 0);
+	null(c->objects[5]);
+	list_object(c, o1);
+	eq(o1->oidx, 5);
+	list_object(c, o2);
+	eq(o2->oidx, 200);
+	list_object(c, o3);
+	eq(o3->oidx, 301);
+
+	/* Free up */
+	for (i = 0; i < 300; i++)
+		object_free(objs[i]);
+	object_free(o1);
+	object_free(o2);
+	object_free(o3);
+	cave_free(c);
+
+	ok;
+}
+
 const char *suite_name = "object/pile";
 struct test tests[] = {
 	{ "pile checking", test_obj_piles },
+	{ "object list", test_obj_list },
 	{ NULL, NULL }
 };
@@ -3,6 +3,7 @@
 #include "unit-test.h"
 
 #include "parser.h"
+#include "z-form.h"
 
 int setup_tests(void **state) {
 	struct parser *p = parser_new();
@@ -394,6 +395,40 @@ int test_char1(void *state) {
 	ok;
 }
 
+static enum parser_error helper_dup0(struct parser *p) {
+	return PARSE_ERROR_GENERIC;
+}
+
+static enum parser_error helper_dup1(struct parser *p) {
+	int *wasok = parser_priv(p);
+	if (strcmp(parser_getsym(p, "s"), "foo"))
+		return PARSE_ERROR_GENERIC;
+	*wasok = 1;
+	return PARSE_ERROR_NONE;
+}
+
+int test_supersede(void *state) {
+	int wasok = 0;
+	char fmt[32];
+	int i;
+
+	/* Enough directives to make the hook table grow */
+	for (i = 0; i < 100; i++) {
+		strnfmt(fmt, sizeof(fmt), "test-many%d int i", i);
+		eq(parser_reg(state, fmt, ignored), 0);
+	}
+	eq(parser_reg(state, "test-dup int i", helper_dup0), 0);
+	eq(parser_reg(state, "test-dup sym s", helper_dup1), 0);
+	parser_setpriv(state, &wasok);
+	eq(parser_parse(state, "test-dup:foo"), PARSE_ERROR_NONE);
+	eq(wasok, 1);
+	for (i = 0; i < 100; i++) {
+		strnfmt(fmt, sizeof(fmt), "test-many%d:%d", i, i);
+		eq(parser_parse(state, fmt), PARSE_ERROR_NONE);
+	}
+	ok;
+}
+
 const char *suite_name = "parse/parser";
 struct test tests[] = {
 	{ "priv", test_priv },
@@ -435,6 +470,8 @@ struct test tests[] = {
 	{ "char0", test_char0 },
 	{ "char1", test_char1 },
 
+	{ "supersede", test_supersede },
+
 	{ "baddir", test_baddir },
 
 	{ NULL, NULL }
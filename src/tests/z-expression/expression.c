@@ -150,11 +150,33 @@ int test_evaluate(void *state)
 	ok;
 }
 
+int test_evaluate_folded(void *state)
+{
+	expression_t *new = expression_new();
+
+	/* Operations folded together on parsing give the same results. */
+	expression_set_base_value(new, base_value_2);
+	expression_add_operations_string(new, "- 4 + 1 - 2");
+	require(expression_evaluate(new) == 4);
+	expression_add_operations_string(new, "n n");
+	require(expression_evaluate(new) == 4);
+	expression_add_operations_string(new, "* 300 300");
+	require(expression_evaluate(new) == 360000);
+	expression_add_operations_string(new, "n / 7 11");
+	require(expression_evaluate(new) == -4675);
+	expression_add_operations_string(new, "/ -2 3");
+	require(expression_evaluate(new) == 779);
+
+	expression_free(new);
+	ok;
+}
+
 const char *suite_name = "z-expression/expression";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "parse-success", test_parse_success },
 	{ "parse-failure", test_parse_failure },
 	{ "evaluate", test_evaluate },
+	{ "evaluate-folded", test_evaluate_folded },
 	{ NULL, NULL },
 };
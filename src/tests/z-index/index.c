@@ -0,0 +1,80 @@
+/* z-index/index.c */
+
+#include "unit-test.h"
+#include "z-form.h"
+#include "z-index.h"
+#include "z-virt.h"
+
+int setup_tests(void **state) {
+	return 0;
+}
+
+int teardown_tests(void *state) {
+	return 0;
+}
+
+int test_find(void *state) {
+	struct name_index *ni = name_index_new(4, false);
+
+	name_index_add(ni, "open floor", 1);
+	name_index_add(ni, "granite wall", 21);
+	name_index_add(ni, "lava", 25);
+
+	eq(name_index_find(ni, "open floor"), 1);
+	eq(name_index_find(ni, "granite wall"), 21);
+	eq(name_index_find(ni, "lava"), 25);
+	eq(name_index_find(ni, "Lava"), -1);
+	eq(name_index_find(ni, "lav"), -1);
+	eq(name_index_find(NULL, "lava"), -1);
+
+	name_index_free(ni);
+	ok;
+}
+
+/* The first value added for a name is the one kept */
+int test_first_wins(void *state) {
+	struct name_index *ni = name_index_new(4, true);
+
+	name_index_add(ni, "Grip, Farmer Maggot's Dog", 3);
+	name_index_add(ni, "grip, farmer maggot's dog", 7);
+	name_index_add(ni, NULL, 9);
+
+	eq(name_index_find(ni, "GRIP, FARMER MAGGOT'S DOG"), 3);
+
+	name_index_free(ni);
+	ok;
+}
+
+/* Add far more names than the index was sized for */
+int test_grow(void *state) {
+	struct name_index *ni = name_index_new(1, false);
+	char **names = mem_zalloc(5000 * sizeof(*names));
+	char buf[32];
+	int i;
+
+	for (i = 0; i < 5000; i++) {
+		strnfmt(buf, sizeof(buf), "name %d", i);
+		names[i] = string_make(buf);
+		name_index_add(ni, names[i], i);
+	}
+
+	for (i = 0; i < 5000; i++) {
+		strnfmt(buf, sizeof(buf), "name %d", i);
+		eq(name_index_find(ni, buf), i);
+	}
+	eq(name_index_find(ni, "name 5000"), -1);
+
+	name_index_free(ni);
+	for (i = 0; i < 5000; i++)
+		string_free(names[i]);
+	mem_free(names);
+	ok;
+}
+
+const char *suite_name = "z-index/index";
+struct test tests[] = {
+	{ "find", test_find },
+	{ "first-wins", test_first_wins },
+	{ "grow", test_grow },
+	{ NULL, NULL }
+};
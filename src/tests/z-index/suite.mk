@@ -0,0 +1 @@
+TESTPROGS += z-index/index
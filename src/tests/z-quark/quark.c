@@ -2,6 +2,7 @@
 
 #include "unit-test.h"
 #include "z-quark.h"
+#include "z-form.h"
 
 int setup_tests(void **state) {
 	quarks_init();
@@ -46,9 +47,35 @@ int test_dedup(void *state) {
 	ok;
 }
 
+/* Intern enough strings to force the index to grow many times over */
+int test_many(void *state) {
+	char buf[32];
+	quark_t first = 0, q;
+	int i;
+
+	for (i = 0; i < 50000; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		q = quark_add(buf);
+		if (!first)
+			first = q;
+		require(q == first + i);
+	}
+
+	for (i = 0; i < 50000; i++) {
+		strnfmt(buf, sizeof(buf), "2-%d", i);
+		require(quark_add(buf) == first + i);
+		require(!strcmp(quark_str(first + i), buf));
+	}
+
+	require(quark_add("1-foo") < first);
+
+	ok;
+}
+
 const char *suite_name = "z-quark/quark";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "dedup", test_dedup },
+	{ "many", test_many },
 	{ NULL, NULL }
 };
@@ -0,0 +1,145 @@
+/* z-rand/rand */
+
+#include "unit-test.h"
+#include "z-rand.h"
+
+NOSETUP
+NOTEARDOWN
+
+/* Rand_fill() must leave the RNG just where single draws would */
+int test_fill(void *state)
+{
+	u32b words[100], more[50];
+	u32b saved[RAND_DEG];
+	u32b saved_i;
+	int i;
+
+	Rand_quick = false;
+	Rand_compat = true;
+	Rand_state_init(12345);
+	memcpy(saved, STATE, sizeof(saved));
+	saved_i = state_i;
+
+	Rand_fill(words, N_ELEMENTS(words));
+
+	memcpy(STATE, saved, sizeof(saved));
+	state_i = saved_i;
+	for (i = 0; i < (int)N_ELEMENTS(words); i++)
+		eq(Rand_div(0x10000000), words[i] >> 4);
+
+	/* Both ways should now carry on identically */
+	Rand_fill(words, 1);
+	memcpy(STATE, saved, sizeof(saved));
+	state_i = saved_i;
+	Rand_fill(more, N_ELEMENTS(more));
+	Rand_fill(more, N_ELEMENTS(more));
+	Rand_fill(more, 1);
+	eq(more[0], words[0]);
+
+	Rand_compat = false;
+	ok;
+}
+
+int test_bounded(void *state)
+{
+	static const u32b bounds[] = { 1, 2, 3, 7, 100, 65537, 0x10000000 };
+	size_t i;
+	int j;
+
+	Rand_quick = false;
+	Rand_state_init(54321);
+
+	for (i = 0; i < N_ELEMENTS(bounds); i++)
+		for (j = 0; j < 1000; j++)
+			require(Rand_div(bounds[i]) < bounds[i]);
+
+	/* Both values of a coin should turn up */
+	for (j = 0; j < 100 && randint0(2) == 0; j++) ;
+	require(j < 100);
+	for (j = 0; j < 100 && randint0(2) == 1; j++) ;
+	require(j < 100);
+
+	ok;
+}
+
+int test_damroll(void *state)
+{
+	int i;
+
+	Rand_quick = false;
+	Rand_state_init(999);
+
+	eq(damroll(100, 1), 100);
+	eq(damroll(0, 6), 0);
+	eq(damroll(3, 0), 0);
+
+	for (i = 0; i < 1000; i++) {
+		int roll = damroll(70, 6);
+		require(roll >= 70 && roll <= 420);
+	}
+
+	ok;
+}
+
+/* A jump of 2^k must land where 2^k single draws do */
+int test_jump(void *state)
+{
+	static u32b words[1 << 12];
+	u32b saved[RAND_DEG], after, jumped;
+	u32b saved_i;
+	int k;
+
+	Rand_quick = false;
+	Rand_state_init(777);
+
+	for (k = 0; k <= 12; k += 3) {
+		memcpy(saved, STATE, sizeof(saved));
+		saved_i = state_i;
+		Rand_fill(words, 1 << k);
+		Rand_fill(&after, 1);
+
+		memcpy(STATE, saved, sizeof(saved));
+		state_i = saved_i;
+		Rand_jump(k);
+		Rand_fill(&jumped, 1);
+		eq(jumped, after);
+	}
+
+	ok;
+}
+
+/* Streams don't disturb each other, and main is put back after a switch */
+int test_streams(void *state)
+{
+	u32b expect[4], got[4], other;
+	int old;
+
+	/* Rand_state_init() carries on from the old state index */
+	Rand_quick = false;
+	state_i = 0;
+	Rand_state_init(4242);
+	Rand_fill(expect, N_ELEMENTS(expect));
+
+	state_i = 0;
+	Rand_state_init(4242);
+	Rand_fill(got, 2);
+	old = Rand_stream(RNG_COMBAT);
+	eq(old, RNG_MAIN);
+	Rand_fill(&other, 1);
+	require(other != expect[2]);
+	eq(Rand_stream(old), RNG_COMBAT);
+	Rand_fill(got + 2, 2);
+	require(!memcmp(got, expect, sizeof(got)));
+
+	ok;
+}
+
+const char *suite_name = "z-rand/rand";
+struct test tests[] = {
+	{ "fill", test_fill },
+	{ "bounded", test_bounded },
+	{ "damroll", test_damroll },
+	{ "jump", test_jump },
+	{ "streams", test_streams },
+	{ NULL, NULL },
+};
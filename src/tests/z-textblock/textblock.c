@@ -75,11 +75,34 @@ int test_length(void *state) {
 	ok;
 }
 
+int test_equal(void *state) {
+	textblock *a = textblock_new();
+	textblock *b = textblock_new();
+
+	require(textblock_equal(a, b));
+
+	textblock_append(a, "same");
+	require(!textblock_equal(a, b));
+
+	textblock_append(b, "same");
+	require(textblock_equal(a, b));
+
+	textblock_append_c(a, COLOUR_RED, "!");
+	textblock_append_c(b, COLOUR_BLUE, "!");
+	require(!textblock_equal(a, b));
+
+	textblock_free(a);
+	textblock_free(b);
+
+	ok;
+}
+
 const char *suite_name = "z-textblock/textblock";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "append", test_append },
 	{ "colour", test_colour },
 	{ "length", test_length },
+	{ "equal", test_equal },
 	{ NULL, NULL }
 };
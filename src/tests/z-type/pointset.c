@@ -0,0 +1,60 @@
+/* z-type/pointset.c */
+
+#include "unit-test.h"
+#include "z-type.h"
+
+int setup_tests(void **state) {
+	ok;
+}
+
+int teardown_tests(void *state) {
+	ok;
+}
+
+int test_contains(void *state) {
+	struct point_set *ps = point_set_new(4);
+	int y, x;
+
+	/* Enough points to make the set grow several times */
+	for (y = 0; y < 20; y++)
+		for (x = 0; x < 30; x += 2)
+			add_to_point_set(ps, y, x);
+
+	eq(point_set_size(ps), 20 * 15);
+
+	for (y = 0; y < 20; y++)
+		for (x = 0; x < 30; x++)
+			eq(point_set_contains(ps, y, x), (x % 2) ? 0 : 1);
+
+	require(!point_set_contains(ps, 20, 0));
+	require(!point_set_contains(ps, 0, 30));
+
+	point_set_dispose(ps);
+	ok;
+}
+
+int test_order(void *state) {
+	struct point_set *ps = point_set_new(2);
+
+	add_to_point_set(ps, 5, 7);
+	add_to_point_set(ps, 1, 2);
+	add_to_point_set(ps, 3, 9);
+
+	/* Points stay in the order they were added */
+	eq(ps->pts[0].y, 5);
+	eq(ps->pts[0].x, 7);
+	eq(ps->pts[1].y, 1);
+	eq(ps->pts[1].x, 2);
+	eq(ps->pts[2].y, 3);
+	eq(ps->pts[2].x, 9);
+
+	point_set_dispose(ps);
+	ok;
+}
+
+const char *suite_name = "z-type/pointset";
+struct test tests[] = {
+	{ "contains", test_contains },
+	{ "order", test_order },
+	{ NULL, NULL }
+};
@@ -25,9 +25,64 @@ int test_realloc(void *state) {
 	return 0;
 }
 
+int test_arena(void *state) {
+	struct mem_arena *a = mem_arena_new(1024);
+	char *p1 = mem_arena_alloc(a, 24);
+	char *p2 = mem_arena_alloc(a, 24);
+	char *big = mem_arena_alloc(a, 4000);
+	char *p3;
+	require(p1 && p2 && big);
+	require(p1 != p2);
+	require(mem_arena_alloc(a, 0) == NULL);
+	memset(p1, 0x1, 24);
+	memset(p2, 0x2, 24);
+	memset(big, 0x3, 4000);
+
+	/* Released pieces come back, zeroed, for the same size class */
+	mem_arena_release(a, p1, 24);
+	p3 = mem_arena_alloc(a, 30);
+	require(p3 == p1);
+	require(p3[0] == 0 && p3[29] == 0);
+	require(p2[0] == 0x2);
+
+	mem_arena_free(a);
+	return 0;
+}
+
+int test_account(void *state) {
+	struct mem_tag_stats before, during, after;
+	void *untracked = mem_alloc(8);
+	void *p;
+	int tag;
+
+	mem_flags |= MEM_ACCOUNT;
+	mem_tag_get(MEM_TAG_CAVE, &before);
+	tag = mem_tag_set(MEM_TAG_CAVE);
+	p = mem_alloc(100);
+	p = mem_realloc(p, 300);
+	mem_tag_set(tag);
+	mem_tag_get(MEM_TAG_CAVE, &during);
+	require(during.live == before.live + 300);
+	require(during.blocks == before.blocks + 1);
+	require(during.high_water >= before.live + 300);
+
+	/* Frees count against where the allocation was made */
+	mem_free(p);
+	mem_free(untracked);
+	mem_tag_get(MEM_TAG_CAVE, &after);
+	mem_flags &= ~MEM_ACCOUNT;
+	require(after.live == before.live);
+	require(after.blocks == before.blocks);
+	require(after.high_water == during.high_water);
+	require(!strcmp(after.name, "cave"));
+	return 0;
+}
+
 const char *suite_name = "z-virt/mem";
 struct test tests[] = {
 	{ "alloc", test_alloc },
 	{ "realloc", test_realloc },
+	{ "arena", test_arena },
+	{ "account", test_account },
 	{ NULL, NULL }
 };
@@ -26,34 +26,61 @@
 #include "player-timed.h"
 #include "player-util.h"
 #include "trap.h"
+#include "z-index.h"
 
 struct trap_kind *trap_info;
 
+/**
+ * Index of trap descriptions, for the trap_info it was built from
+ */
+static struct name_index *trap_names;
+static struct trap_kind *trap_names_info;
+
+/**
+ * Forget the trap description index, as trap_info is going away.
+ */
+void lookup_trap_forget(void)
+{
+	name_index_free(trap_names);
+	trap_names = NULL;
+	trap_names_info = NULL;
+}
+
 /**
  * Find a trap kind based on its short description
  */
 struct trap_kind *lookup_trap(const char *desc)
 {
 	int i;
-	struct trap_kind *closest = NULL;
+
+	/* Index the descriptions the first time; wards and locks are looked up
+	 * by name during play */
+	if (trap_names_info != trap_info) {
+		name_index_free(trap_names);
+		trap_names = name_index_new(z_info->trap_max, false);
+		for (i = 1; i < z_info->trap_max; i++)
+			if (trap_info[i].name)
+				name_index_add(trap_names, trap_info[i].desc, i);
+		trap_names_info = trap_info;
+	}
 
 	/* Look for it */
+	i = name_index_find(trap_names, desc);
+	if (i >= 0)
+		return &trap_info[i];
+
+	/* Settle for the first close match */
 	for (i = 1; i < z_info->trap_max; i++) {
 		struct trap_kind *kind = &trap_info[i];
 		if (!kind->name)
 			continue;
 
-		/* Test for equality */
-		if (streq(desc, kind->desc))
-			return kind;
-
 		/* Test for close matches */
-		if (!closest && my_stristr(kind->desc, desc))
-			closest = kind;
+		if (my_stristr(kind->desc, desc))
+			return kind;
 	}
 
-	/* Return our best match */
-	return closest;
+	return NULL;
 }
 
 /**
@@ -602,6 +629,7 @@ bool square_set_trap_timeout(struct chunk *c, int y, int x, bool domsg,
 
 		/* Set the timer */
 		current_trap->timeout = time;
+		c->trap_timeouts = MAX(c->trap_timeouts, time);
 
 		/* Message if requested */
 		msg("You have disabled the %s.", current_trap->kind->name);
@@ -680,14 +708,15 @@ void square_set_door_lock(struct chunk *c, int y, int x, int power)
  */
 int square_door_power(struct chunk *c, int y, int x)
 {
-	struct trap_kind *lock = lookup_trap("door lock");
+	struct trap_kind *lock;
 	struct trap *trap;
 
-	/* Verify it's a closed door */
-	if (!square_iscloseddoor(c, y, x))
+	/* Verify it's a closed door with some trap on it */
+	if (!square_iscloseddoor(c, y, x) || !square_istrap(c, y, x))
 		return 0;
 
 	/* Is there a lock there? */
+	lock = lookup_trap("door lock");
 	if (!square_trap_specific(c, y, x, lock->tidx))
 		return 0;
 
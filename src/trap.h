@@ -78,8 +78,8 @@ struct trap
 	struct trap_kind *kind;		/**< Trap kind */
 	struct trap *next;			/**< Next trap in this location */
 
-	byte fy;					/**< Location of trap */
-	byte fx;
+	s16b fy;					/**< Location of trap */
+	s16b fx;
 
 	byte power;					/**< Power for locks, visibility for traps */
 	byte timeout;				/**< Timer for disabled traps */
@@ -87,6 +87,7 @@ struct trap
 	bitflag flags[TRF_SIZE];	/**< Trap flags (only this particular trap) */
 };
 
+void lookup_trap_forget(void);
 struct trap_kind *lookup_trap(const char *desc);
 bool square_trap_specific(struct chunk *c, int y, int x, int t_idx);
 bool square_trap_flag(struct chunk *c, int y, int x, int flag);
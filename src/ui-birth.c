@@ -611,7 +611,9 @@ static enum birth_stage menu_question(enum birth_stage current,
 		} else if (cx.type == EVT_KBRD) {
 			/* '*' chooses an option at random from those the game's provided */
 			if (cx.key.code == '*' && menu_data->allow_random) {
+				int rng = Rand_stream(RNG_UI);
 				current_menu->cursor = randint0(current_menu->count);
+				Rand_stream(rng);
 				cmdq_push(choice_command);
 				cmd_set_arg_choice(cmdq_peek(), "choice", current_menu->cursor);
 
@@ -40,6 +40,7 @@
 #include "player.h"
 #include "project.h"
 #include "savefile.h"
+#include "sound.h"
 #include "target.h"
 #include "ui-birth.h"
 #include "ui-display.h"
@@ -131,6 +132,69 @@ void cnv_stat(int val, char *out_val, size_t out_len)
  * Sidebar display functions
  * ------------------------------------------------------------------------ */
 
+/**
+ * Maximum width of a screen field whose contents are remembered
+ */
+#define FIELD_CACHE_MAX 256
+
+/**
+ * What a sidebar or status field last put on screen, and what it was drawn
+ * from.  A field is only redrawn when its inputs change or when something else
+ * has been written over it since (a menu, a Term_clear(), a resize...).
+ */
+struct field_cache {
+	bool valid;
+	term *t;
+	int row, col, len;
+	int a[FIELD_CACHE_MAX];
+	wchar_t c[FIELD_CACHE_MAX];
+};
+
+/**
+ * Check whether the field at (row, col) is still on screen as it was drawn
+ */
+static bool field_cache_check(const struct field_cache *fc, int row, int col,
+							  int len)
+{
+	int x;
+
+	if (!fc->valid || (fc->t != Term)) return false;
+	if ((fc->row != row) || (fc->col != col) || (fc->len != len)) return false;
+	if ((row >= Term->hgt) || (col + len > Term->wid)) return false;
+
+	for (x = 0; x < len; x++)
+		if ((Term->scr->a[row][col + x] != fc->a[x]) ||
+			(Term->scr->c[row][col + x] != fc->c[x]))
+			return false;
+
+	return true;
+}
+
+/**
+ * Remember what was just drawn at (row, col)
+ */
+static void field_cache_store(struct field_cache *fc, int row, int col,
+							  int len)
+{
+	int x;
+
+	fc->valid = false;
+	if ((len > FIELD_CACHE_MAX) || (row >= Term->hgt) ||
+		(col + len > Term->wid))
+		return;
+
+	for (x = 0; x < len; x++) {
+		fc->a[x] = Term->scr->a[row][col + x];
+		fc->c[x] = Term->scr->c[row][col + x];
+	}
+	fc->t = Term;
+	fc->row = row;
+	fc->col = col;
+	fc->len = len;
+	fc->valid = true;
+}
+
+
 /**
  * Print character info at given row, column in a 13 char field
  */
@@ -149,8 +213,19 @@ static void prt_field(const char *info, int row, int col)
  */
 static void prt_stat(int stat, int row, int col)
 {
+	static struct field_cache cache[STAT_MAX];
+	static s16b drawn[STAT_MAX][3];
+	s16b key[3];
 	char tmp[32];
 
+	/* Nothing to do if the stat and the screen are as last drawn */
+	key[0] = player->stat_cur[stat];
+	key[1] = player->stat_max[stat];
+	key[2] = player->state.stat_use[stat];
+	if (!memcmp(key, drawn[stat], sizeof(key)) &&
+		field_cache_check(&cache[stat], row, col, 12))
+		return;
+
 	/* Injured or healthy stat */
 	if (player->stat_cur[stat] < player->stat_max[stat]) {
 		put_str(stat_names_reduced[stat], row, col);
@@ -165,6 +240,9 @@ static void prt_stat(int stat, int row, int col)
 	/* Indicate natural maximum */
 	if (player->stat_max[stat] == 18+100)
 		put_str("!", row, col + 3);
+
+	memcpy(drawn[stat], key, sizeof(key));
+	field_cache_store(&cache[stat], row, col, 12);
 }
 
 
@@ -1028,21 +1106,104 @@ static status_f *status_handlers[] =
   prt_stun, prt_hunger, prt_study, prt_tmd, prt_dtrap };
 
 
+/**
+ * Everything the status line handlers draw from, reduced to what changes
+ * their output (cut, stun and hunger levels rather than raw counters, and
+ * whether each timed effect is active rather than its duration).
+ */
+struct status_key {
+	int feeling;
+	int feeling_known;
+	int unignoring;
+	int recall;
+	int descent;
+	int is_resting;
+	int resting;
+	int nrepeats;
+	int cut;
+	int stun;
+	int hunger;
+	int study;
+	int study_attr;
+	int dtrap;
+	byte timed[TMD_MAX];
+};
+
+/**
+ * Find which entry of a state_info table a value falls into
+ */
+static int state_level(const struct state_info *data, size_t n, int value,
+					   bool less)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		if (less ? (value <= data[i].value) : (value > data[i].value))
+			return i;
+
+	return n;
+}
+
+static void status_key_get(struct status_key *k)
+{
+	size_t i;
+
+	/* Zero the whole thing so padding compares equal */
+	memset(k, 0, sizeof(*k));
+
+	if (OPT(player, birth_feelings) && player->depth) {
+		k->feeling = cave->feeling;
+		k->feeling_known = cave->feeling_squares >= z_info->feeling_need;
+	}
+	k->unignoring = player->unignoring;
+	k->recall = player->word_recall != 0;
+	k->descent = player->deep_descent != 0;
+	k->is_resting = player_is_resting(player);
+	if (k->is_resting)
+		k->resting = player_resting_count(player);
+	k->nrepeats = cmd_get_nrepeats();
+	k->cut = state_level(cut_data, N_ELEMENTS(cut_data),
+						 player->timed[TMD_CUT], false);
+	k->stun = state_level(stun_data, N_ELEMENTS(stun_data),
+						  player->timed[TMD_STUN], false);
+	k->hunger = state_level(hunger_data, N_ELEMENTS(hunger_data),
+							player->food, true);
+	k->study = player->upkeep->new_spells;
+	if (k->study)
+		k->study_attr = player_book_has_unlearned_spells(player);
+	if (square_isdtrap(cave, player->py, player->px))
+		k->dtrap = square_dtrap_edge(cave, player->py, player->px) ? 2 : 1;
+	for (i = 0; i < N_ELEMENTS(effects); i++)
+		k->timed[effects[i].value] = player->timed[effects[i].value] != 0;
+}
+
 /**
  * Print the status line.
  */
 static void update_statusline(game_event_type type, game_event_data *data, void *user)
 {
+	static struct field_cache cache;
+	static struct status_key drawn;
+	struct status_key key;
 	int row = Term->hgt - 1;
 	int col = 13;
 	size_t i;
 
+	/* Skip the redraw if neither the inputs nor the screen have changed */
+	status_key_get(&key);
+	if (!memcmp(&key, &drawn, sizeof(key)) &&
+		field_cache_check(&cache, row, 13, Term->wid - 13))
+		return;
+
 	/* Clear the remainder of the line */
 	prt("", row, col);
 
 	/* Display those which need redrawing */
 	for (i = 0; i < N_ELEMENTS(status_handlers); i++)
 		col += status_handlers[i](row, col);
+
+	drawn = key;
+	field_cache_store(&cache, row, 13, Term->wid - 13);
 }
 
 
@@ -1055,83 +1216,105 @@ static void update_statusline(game_event_type type, game_event_data *data, void
 static void trace_map_updates(game_event_type type, game_event_data *data,
 							  void *user)
 {
-	if (data->point.x == -1 && data->point.y == -1)
+	int i;
+
+	if (data->points.all)
 		printf("Redraw whole map\n");
 	else
-		printf("Redraw (%i, %i)\n", data->point.x, data->point.y);
+		for (i = 0; i < data->points.count; i++)
+			printf("Redraw (%i, %i)\n", data->points.grids[i].x,
+				   data->points.grids[i].y);
 }
 #endif
 
 /**
- * Update either a single map grid or a whole map
+ * Queue a single map grid for redrawing; return whether it is on screen
  */
-static void update_maps(game_event_type type, game_event_data *data, void *user)
+static bool update_map_grid(term *t, int x, int y)
 {
-	term *t = user;
-
-	/* This signals a whole-map redraw. */
-	if (data->point.x == -1 && data->point.y == -1)
-		prt_map();
+	struct grid_data g;
+	int a, ta;
+	wchar_t c, tc;
 
-	/* Single point to be redrawn */
-	else {
-		struct grid_data g;
-		int a, ta;
-		wchar_t c, tc;
-
-		int ky, kx;
-		int vy, vx;
+	int ky, kx;
+	int vy, vx;
 
-		/* Location relative to panel */
-		ky = data->point.y - t->offset_y;
-		kx = data->point.x - t->offset_x;
+	/* Location relative to panel */
+	ky = y - t->offset_y;
+	kx = x - t->offset_x;
 
-		if (t == angband_term[0]) {
-			/* Verify location */
-			if ((ky < 0) || (ky >= SCREEN_HGT)) return;
+	if (t == angband_term[0]) {
+		/* Verify location */
+		if ((ky < 0) || (ky >= SCREEN_HGT)) return false;
 
-			/* Verify location */
-			if ((kx < 0) || (kx >= SCREEN_WID)) return;
+		/* Verify location */
+		if ((kx < 0) || (kx >= SCREEN_WID)) return false;
 
-			/* Location in window */
-			vy = ky + ROW_MAP;
-			vx = kx + COL_MAP;
+		/* Location in window */
+		vy = ky + ROW_MAP;
+		vx = kx + COL_MAP;
 
-			if (tile_width > 1)
-				vx += (tile_width - 1) * kx;
+		if (tile_width > 1)
+			vx += (tile_width - 1) * kx;
 
-			if (tile_height > 1)
-				vy += (tile_height - 1) * ky;
+		if (tile_height > 1)
+			vy += (tile_height - 1) * ky;
 
-		} else {
-			if (tile_width > 1)
-			        kx += (tile_width - 1) * kx;
+	} else {
+		if (tile_width > 1)
+		        kx += (tile_width - 1) * kx;
 
-			if (tile_height > 1)
-			        ky += (tile_height - 1) * ky;
+		if (tile_height > 1)
+		        ky += (tile_height - 1) * ky;
 
 			
-			/* Verify location */
-			if ((ky < 0) || (ky >= t->hgt)) return;
-			if ((kx < 0) || (kx >= t->wid)) return;
+		/* Verify location */
+		if ((ky < 0) || (ky >= t->hgt)) return false;
+		if ((kx < 0) || (kx >= t->wid)) return false;
 
-			/* Location in window */
-			vy = ky;
-			vx = kx;
-		}
+		/* Location in window */
+		vy = ky;
+		vx = kx;
+	}
 
 
-		/* Redraw the grid spot */
-		map_info(data->point.y, data->point.x, &g);
-		grid_data_as_text(&g, &a, &c, &ta, &tc);
-		Term_queue_char(t, vx, vy, a, c, ta, tc);
+	/* Redraw the grid spot */
+	map_info(y, x, &g);
+	grid_data_as_text(&g, &a, &c, &ta, &tc);
+	Term_queue_char(t, vx, vy, a, c, ta, tc);
 #ifdef MAP_DEBUG
-		/* Plot 'spot' updates in light green to make them visible */
-		Term_queue_char(t, vx, vy, COLOUR_L_GREEN, c, ta, tc);
+	/* Plot 'spot' updates in light green to make them visible */
+	Term_queue_char(t, vx, vy, COLOUR_L_GREEN, c, ta, tc);
 #endif
 
-		if ((tile_width > 1) || (tile_height > 1))
-			Term_big_queue_char(t, vx, vy, a, c, COLOUR_WHITE, ' ');
+	if ((tile_width > 1) || (tile_height > 1))
+		Term_big_queue_char(t, vx, vy, a, c, COLOUR_WHITE, ' ');
+
+	return true;
+}
+
+/**
+ * Update either a batch of map grids or a whole map
+ */
+static void update_maps(game_event_type type, game_event_data *data, void *user)
+{
+	term *t = user;
+
+	/* This signals a whole-map redraw. */
+	if (data->points.all)
+		prt_map();
+
+	/* Grids to be redrawn */
+	else {
+		bool shown = false;
+		int i;
+
+		for (i = 0; i < data->points.count; i++)
+			if (update_map_grid(t, data->points.grids[i].x,
+								data->points.grids[i].y))
+				shown = true;
+
+		if (!shown) return;
 	}
 
 	/* Refresh the main screen unless the map needs to center */
@@ -1201,6 +1384,7 @@ static byte get_flicker(byte a)
 static void do_animation(void)
 {
 	int i;
+	int rng = Rand_stream(RNG_UI);
 
 	for (i = 1; i < cave_monster_max(cave); i++) {
 		byte attr;
@@ -1220,6 +1404,7 @@ static void do_animation(void)
 	}
 
 	flicker++;
+	Rand_stream(rng);
 }
 
 /**
@@ -1248,10 +1433,13 @@ static void animate(game_event_type type, game_event_data *data, void *user)
 
 /**
  * This is used when the user is idle to allow for simple animations.
- * Currently the only thing it really does is animate shimmering monsters.
+ * Currently the only thing it really does is animate shimmering monsters,
+ * and load sounds ahead of their first use.
  */
 void idle_update(void)
 {
+	sound_load_idle();
+
 	if (!animations_allowed) return;
 	if (msg_flag) return;
 	if (!character_dungeon) return;
@@ -1305,6 +1493,23 @@ static void bolt_pict(int y, int x, int ny, int nx, int typ, byte *a,
 	}
 }
 
+/**
+ * Pause to show a frame of a projection animation.  There is nothing to wait
+ * for with no delay set; and once the player has pressed a key, the rest of
+ * the animation is drawn without pausing so the game gets on to it.
+ */
+static void animation_delay(int msec)
+{
+	if (msec <= 0) return;
+
+	/* Look for input without taking it, as Term_inkey() does */
+	if (Term->key_head == Term->key_tail)
+		Term_xtra(TERM_XTRA_EVENT, false);
+	if (Term->key_head != Term->key_tail) return;
+
+	Term_xtra(TERM_XTRA_DELAY, msec);
+}
+
 /**
  * Draw an explosion
  */
@@ -1361,7 +1566,7 @@ static void display_explosion(game_event_type type, game_event_data *data,
 
 			/* Delay to show this radius appearing */
 			if (drawn || drawing) {
-				Term_xtra(TERM_XTRA_DELAY, msec);
+				animation_delay(msec);
 			}
 
 			new_radius = false;
@@ -1380,6 +1585,7 @@ static void display_explosion(game_event_type type, game_event_data *data,
 			if (player_sees_grid[i])
 				event_signal_point(EVENT_MAP, x, y);
 		}
+		event_flush_points();
 
 		/* Center the cursor */
 		move_cursor_relative(centre.y, centre.x);
@@ -1421,8 +1627,9 @@ static void display_bolt(game_event_type type, game_event_data *data,
 		Term_fresh();
 		if (player->upkeep->redraw)
 			redraw_stuff(player);
-		Term_xtra(TERM_XTRA_DELAY, msec);
+		animation_delay(msec);
 		event_signal_point(EVENT_MAP, x, y);
+		event_flush_points();
 		Term_fresh();
 		if (player->upkeep->redraw)
 			redraw_stuff(player);
@@ -1438,7 +1645,7 @@ static void display_bolt(game_event_type type, game_event_data *data,
 		}
 	} else if (drawing) {
 		/* Delay for consistency */
-		Term_xtra(TERM_XTRA_DELAY, msec);
+		animation_delay(msec);
 	}
 }
 
@@ -1462,8 +1669,9 @@ static void display_missile(game_event_type type, game_event_data *data,
 		Term_fresh();
 		if (player->upkeep->redraw) redraw_stuff(player);
 
-		Term_xtra(TERM_XTRA_DELAY, msec);
+		animation_delay(msec);
 		event_signal_point(EVENT_MAP, x, y);
+		event_flush_points();
 
 		Term_fresh();
 		if (player->upkeep->redraw) redraw_stuff(player);
@@ -1591,19 +1799,75 @@ static void update_monlist_subwindow(game_event_type type,
 }
 
 
+/**
+ * The monster recall last drawn into a window showing nothing else, which
+ * can be left alone while the recall stays the same
+ */
+static textblock *monster_subwindow_tb;
+static term *monster_subwindow_term;
+static int monster_subwindow_wid, monster_subwindow_hgt;
+
+/**
+ * Forget the monster recall on display, so that it is drawn afresh
+ */
+static void monster_subwindow_forget(void)
+{
+	if (monster_subwindow_tb)
+		textblock_free(monster_subwindow_tb);
+	monster_subwindow_tb = NULL;
+	monster_subwindow_term = NULL;
+}
+
 static void update_monster_subwindow(game_event_type type,
 									 game_event_data *data, void *user)
 {
 	term *old = Term;
 	term *inv_term = user;
+	const struct monster_race *race = player->upkeep->monster_race;
+	bool only_recall = false;
+	textblock *tb;
+	int i, y;
 
 	/* Activate */
 	Term_activate(inv_term);
 
 	/* Display monster race info */
-	if (player->upkeep->monster_race)
-		lore_show_subwindow(player->upkeep->monster_race, 
-							get_lore(player->upkeep->monster_race));
+	if (race) {
+		tb = textblock_new();
+		lore_description(tb, race, get_lore(race), false);
+
+		/* See whether this window shows the recall and nothing else */
+		for (i = 0; i < ANGBAND_TERM_MAX; i++)
+			if (angband_term[i] == inv_term)
+				only_recall = (window_flag[i] == PW_MONSTER);
+
+		/* The recall is redrawn every turn, but rarely changes; only wrap
+		 * and draw it again if it differs from what is on display */
+		if (only_recall && monster_subwindow_term == inv_term &&
+			monster_subwindow_wid == Term->wid &&
+			monster_subwindow_hgt == Term->hgt &&
+			textblock_equal(tb, monster_subwindow_tb)) {
+			textblock_free(tb);
+		} else {
+			/* Erase the window, since textui_textblock_place() only clears
+			 * what it needs */
+			for (y = 0; y < Term->hgt; y++)
+				Term_erase(0, y, 255);
+
+			textui_textblock_place(tb, SCREEN_REGION, NULL);
+
+			/* Remember it if nothing else will draw over it */
+			monster_subwindow_forget();
+			if (only_recall) {
+				monster_subwindow_tb = tb;
+				monster_subwindow_term = inv_term;
+				monster_subwindow_wid = Term->wid;
+				monster_subwindow_hgt = Term->hgt;
+			} else {
+				textblock_free(tb);
+			}
+		}
+	}
 
 	Term_fresh();
 	
@@ -1632,17 +1896,57 @@ static void update_object_subwindow(game_event_type type,
 }
 
 
+static struct message_window
+{
+	int win_idx;
+	bool drawn;
+	u32b seen;
+	int wid, hgt;
+} message_window_data[ANGBAND_TERM_MAX];
+
+/**
+ * Draw the message of age `age` on row `y`
+ */
+static void display_message_line(int age, int y)
+{
+	byte color = message_color(age);
+	u16b count = message_count(age);
+	const char *str = message_str(age);
+	const char *msg;
+	int x;
+
+	if (count == 1)
+		msg = str;
+	else if (count == 0)
+		msg = " ";
+	else
+		msg = format("%s <%dx>", str, count);
+
+	Term_putstr(0, y, -1, color, msg);
+
+	/* Cursor */
+	Term_locate(&x, &y);
+
+	/* Clear to end of line */
+	Term_erase(x, y, 255);
+}
+
+/**
+ * Show the latest messages, newest at the bottom.  A new message scrolls
+ * what is already there and draws only the lines that changed; a plain
+ * redraw request, or a window that has changed size, gets the lot.
+ */
 static void update_messages_subwindow(game_event_type type,
 									  game_event_data *data, void *user)
 {
+	struct message_window *win = user;
 	term *old = Term;
-	term *inv_term = user;
+	term *inv_term = angband_term[win->win_idx];
+	u32b added = messages_added();
+	u32b fresh;
 
 	int i;
 	int w, h;
-	int x, y;
-
-	const char *msg;
 
 	/* Activate */
 	Term_activate(inv_term);
@@ -1650,28 +1954,26 @@ static void update_messages_subwindow(game_event_type type,
 	/* Get size */
 	Term_get_size(&w, &h);
 
-	/* Dump messages */
-	for (i = 0; i < h; i++) {
-		byte color = message_color(i);
-		u16b count = message_count(i);
-		const char *str = message_str(i);
-
-		if (count == 1)
-			msg = str;
-		else if (count == 0)
-			msg = " ";
-		else
-			msg = format("%s <%dx>", str, count);
-
-		Term_putstr(0, (h - 1) - i, -1, color, msg);
+	/* Anything but a new message needs the whole window */
+	if (!data || !win->drawn || w != win->wid || h != win->hgt)
+		fresh = h;
+	else
+		fresh = added - win->seen;
 
+	/* Move the old lines up, and redo the newest of them for its count */
+	if (fresh < (u32b)h) {
+		Term_scroll(fresh);
+		fresh++;
+	}
 
-		/* Cursor */
-		Term_locate(&x, &y);
+	/* Dump messages */
+	for (i = 0; i < h && (u32b)i < fresh; i++)
+		display_message_line(i, (h - 1) - i);
 
-		/* Clear to end of line */
-		Term_erase(x, y, 255);
-	}
+	win->drawn = true;
+	win->seen = added;
+	win->wid = w;
+	win->hgt = h;
 
 	Term_fresh();
 	
@@ -1962,9 +2264,12 @@ static void subwindow_flag_changed(int win_idx, u32b flag, bool new_state)
 
 		case PW_MESSAGE:
 		{
+			message_window_data[win_idx].win_idx = win_idx;
+			message_window_data[win_idx].drawn = false;
+
 			register_or_deregister(EVENT_MESSAGE,
 					       update_messages_subwindow,
-					       angband_term[win_idx]);
+					       &message_window_data[win_idx]);
 			break;
 		}
 
@@ -2040,6 +2345,10 @@ static void subwindow_set_flags(int win_idx, u32b new_flags)
 
 	/* Store the new flags */
 	window_flag[win_idx] = new_flags;
+
+	/* The window is about to be cleared */
+	if (angband_term[win_idx] == monster_subwindow_term)
+		monster_subwindow_forget();
 	
 	/* Activate */
 	Term_activate(angband_term[win_idx]);
@@ -2429,6 +2738,7 @@ static void ui_enter_world(game_event_type type, game_event_data *data,
 	event_add_handler(EVENT_HP, hp_colour_change, NULL);
 
 	/* Simplest way to keep the map up to date - will do for now */
+	event_set_coalescing(EVENT_MAP, true);
 	event_add_handler(EVENT_MAP, update_maps, angband_term[0]);
 #ifdef MAP_DEBUG
 	event_add_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
@@ -2494,6 +2804,7 @@ static void ui_leave_world(game_event_type type, game_event_data *data,
 	event_remove_handler(EVENT_HP, hp_colour_change, NULL);
 
 	/* Simplest way to keep the map up to date - will do for now */
+	event_set_coalescing(EVENT_MAP, false);
 	event_remove_handler(EVENT_MAP, update_maps, angband_term[0]);
 #ifdef MAP_DEBUG
 	event_remove_handler(EVENT_MAP, trace_map_updates, angband_term[0]);
@@ -2532,6 +2843,9 @@ static void ui_leave_world(game_event_type type, game_event_data *data,
 	/* Allow the player to cheat death, if appropriate */
 	event_remove_handler(EVENT_CHEAT_DEATH, cheat_death, NULL);
 
+	/* Let go of the remembered monster recall */
+	monster_subwindow_forget();
+
 	/* Prepare to interact with a store */
 	event_add_handler(EVENT_USE_STORE, use_store, NULL);
 
@@ -18,6 +18,7 @@
  */
 
 #include "angband.h"
+#include "cmd-record.h"
 #include "cmds.h"
 #include "datafile.h"
 #include "game-world.h"
@@ -111,6 +112,7 @@ struct cmd_info cmd_action[] =
 	{ "Fire at nearest target", { 'h', KC_TAB }, CMD_NULL, do_cmd_fire_at_nearest, NULL },
 	{ "Throw an item", { 'v' }, CMD_THROW, NULL, NULL },
 	{ "Walk into a trap", { 'W', '-' }, CMD_JUMP, NULL, NULL },
+	{ "Explore the level", { 'S' }, CMD_EXPLORE, NULL, NULL },
 };
 
 /**
@@ -435,6 +437,9 @@ void play_game(bool new_game)
 		run_game_loop();
 	}
 
+	/* Finish off any record of the game */
+	cmd_record_stop();
+
 	/* Close game on death or quitting */
 	close_game();
 }
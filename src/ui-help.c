@@ -39,9 +39,8 @@ static void string_lower(char *buf)
  *
  * Return false on "?", otherwise true.
  *
- * This function could be made much more efficient with the use of "seek"
- * functionality, especially when moving backwards through a file, or
- * forwards through a file by less than a page at a time.  XXX XXX XXX
+ * The file is read once, keeping the lines to be shown in memory, so that
+ * moving around in it and searching don't need to go back to the disk.
  */
 bool show_file(const char *name, const char *what, int line, int mode)
 {
@@ -55,6 +54,10 @@ bool show_file(const char *name, const char *what, int line, int mode)
 	/* Number of "real" lines in the file */
 	int size;
 
+	/* The "real" lines of the file, ready to display */
+	char **lines = NULL;
+	int lines_size = 0;
+
 	/* Backup value for "line" */
 	int back = 0;
 
@@ -91,6 +94,9 @@ bool show_file(const char *name, const char *what, int line, int mode)
 	/* General buffer */
 	char buf[1024];
 
+	/* The line being displayed */
+	const char *shown;
+
 	/* Lower case version of the buffer, for searching */
 	char lc_buf[1024];
 
@@ -209,13 +215,26 @@ bool show_file(const char *name, const char *what, int line, int mode)
 			continue;
 		}
 
-		/* Count the "real" lines */
-		next++;
+		/* skip | characters */
+		strskip(buf,'|','\\');
+
+		/* escape backslashes */
+		strescape(buf,'\\');
+
+		/* Keep the "real" lines */
+		if (next == lines_size) {
+			lines_size = lines_size ? lines_size * 2 : 256;
+			lines = mem_realloc(lines, lines_size * sizeof(*lines));
+		}
+		lines[next++] = string_make(buf);
 	}
 
 	/* Save the number of "real" lines */
 	size = next;
 
+	/* Everything needed is in memory now */
+	file_close(fff);
+
 
 	/* Display the file */
 	while (true) {
@@ -227,77 +246,15 @@ bool show_file(const char *name, const char *what, int line, int mode)
 		if (line > (size - (hgt - 4))) line = size - (hgt - 4);
 		if (line < 0) line = 0;
 
-		skip_lines = false;
-
-		/* Re-open the file if needed */
-		if (next > line) {
-			/* Close it */
-			file_close(fff);
-
-			/* Hack -- Re-Open the file */
-			fff = file_open(path, MODE_READ, FTYPE_TEXT);
-			if (!fff) return (true);
-
-			/* File has been restarted */
-			next = 0;
-		}
-
-
-		/* Goto the selected line */
-		while (next < line) {
-			/* Get a line */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
-
-			/* Skip lines if we are inside a RST directive*/
-			if (skip_lines) {
-				if (contains_only_spaces(buf))
-					skip_lines=false;
-				continue;
-			}
-
-			/* Skip RST directives */
-			if (prefix(buf, ".. ")) {
-				skip_lines=true;
-				continue;
-			}
-
-			/* Count the lines */
-			next++;
-		}
-
-
 		/* Dump the next lines of the file */
-		for (i = 0; i < hgt - 4; ) {
+		for (i = 0, next = line; (i < hgt - 4) && (next < size); next++) {
 			/* Hack -- track the "first" line */
 			if (!i) line = next;
 
-			/* Get a line of the file or stop */
-			if (!file_getl(fff, buf, sizeof(buf))) break;
-
-			/* Skip lines if we are inside a RST directive */
-			if (skip_lines) {
-				if (contains_only_spaces(buf))
-					skip_lines = false;
-				continue;
-			}
-
-			/* Skip RST directives */
-			if (prefix(buf, ".. ")) {
-				skip_lines=true;
-				continue;
-			}
-
-			/* skip | characters */
-			strskip(buf,'|','\\');
-
-			/* escape backslashes */
-			strescape(buf,'\\');
-
-			/* Count the "real" lines */
-			next++;
+			shown = lines[next];
 
 			/* Make a copy of the current line for searching */
-			my_strcpy(lc_buf, buf, sizeof(lc_buf));
+			my_strcpy(lc_buf, shown, sizeof(lc_buf));
 
 			/* Make the line lower case */
 			if (!case_sensitive) string_lower(lc_buf);
@@ -309,7 +266,7 @@ bool show_file(const char *name, const char *what, int line, int mode)
 			find = NULL;
 
 			/* Dump the line */
-			Term_putstr(0, i+2, -1, COLOUR_WHITE, buf);
+			Term_putstr(0, i+2, -1, COLOUR_WHITE, shown);
 
 			/* Highlight "shower" */
 			if (shower[0]) {
@@ -321,7 +278,7 @@ bool show_file(const char *name, const char *what, int line, int mode)
 
 					/* Display the match */
 					Term_putstr(str-lc_buf, i+2, len, COLOUR_YELLOW,
-								&buf[str-lc_buf]);
+								&shown[str-lc_buf]);
 
 					/* Advance */
 					str += len;
@@ -461,8 +418,10 @@ bool show_file(const char *name, const char *what, int line, int mode)
 		if (ch.code == ESCAPE) break;
 	}
 
-	/* Close the file */
-	file_close(fff);
+	/* Free the lines */
+	for (i = 0; i < size; i++)
+		string_free(lines[i]);
+	mem_free(lines);
 
 	/* Done */
 	return (ch.code != '?');
@@ -31,6 +31,7 @@
 #include "ui-input.h"
 #include "ui-keymap.h"
 #include "ui-knowledge.h"
+#include "ui-map.h"
 #include "ui-options.h"
 #include "ui-output.h"
 #include "ui-prefs.h"
@@ -105,4 +106,5 @@ void textui_cleanup(void)
 
 	keymap_free();
 	textui_prefs_free();
+	map_cells_free();
 }
@@ -17,6 +17,7 @@
  */
 
 #include "angband.h"
+#include "cave.h"
 #include "cmds.h"
 #include "game-event.h"
 #include "game-input.h"
@@ -26,6 +27,7 @@
 #include "obj-util.h"
 #include "player-calcs.h"
 #include "player-path.h"
+#include "profile.h"
 #include "randname.h"
 #include "savefile.h"
 #include "target.h"
@@ -114,6 +116,16 @@ struct keypress *inkey_next = NULL;
  */
 static bool keymap_auto_more;
 
+/**
+ * Whether the user has started on something, so building ahead should stop
+ */
+static bool inkey_pending(void)
+{
+	ui_event ke = EVENT_EMPTY;
+
+	return Term_inkey(&ke, false, false) == 0;
+}
+
 
 /**
  * Get a keypress from the user.
@@ -160,6 +172,13 @@ ui_event inkey_ex(void)
 
 	term *old = Term;
 
+	/* Catch up with anything put off while the game is busy */
+	if (player && player->upkeep)
+		flush_stuff(player);
+
+	/* Draw any map grids still waiting */
+	event_flush_points();
+
 	/* Delayed flush */
 	if (inkey_xtra) {
 		Term_flush();
@@ -220,7 +239,8 @@ ui_event inkey_ex(void)
 	Term_activate(term_screen);
 
 
-	/* Get a key */
+	/* Get a key; a command isn't timed while it waits for one */
+	PROFILE_WAIT_BEGIN();
 	while (ke.type == EVT_NONE) {
 		/* Hack -- Handle "inkey_scan == SCAN_INSTANT */
 		if (inkey_scan == SCAN_INSTANT &&
@@ -245,6 +265,10 @@ ui_event inkey_ex(void)
 			/* Mega-Hack -- reset signal counter */
 			signal_count = 0;
 
+			/* Build the levels nearby stairs lead to while we wait */
+			if (inkey_flag && character_dungeon)
+				cave_pregenerate(player, inkey_pending);
+
 			/* Only once */
 			done = true;
 		}
@@ -261,6 +285,7 @@ ui_event inkey_ex(void)
 		if (ke.key.code == '`')
 			ke.key.code = ESCAPE;
 	}
+	PROFILE_WAIT_END();
 
 	/* Hack -- restore the term */
 	Term_activate(old);
@@ -758,8 +783,10 @@ static bool get_name_keypress(char *buf, size_t buflen, size_t *curs,
 	{
 		case '*':
 		{
+			int rng = Rand_stream(RNG_UI);
 			*len = randname_make(RANDNAME_TOLKIEN, 4, 8, buf, buflen,
 								 name_sections);
+			Rand_stream(rng);
 			my_strcap(buf);
 			*curs = 0;
 			result = false;
@@ -45,14 +45,34 @@ struct keymap {
 	bool user;		/* User-defined keymap */
 
 	struct keymap *next;
+	struct keymap *prev;
+	struct keymap *hash_next;	/* Next keymap in the same hash bucket */
 };
 
 
 /**
- * List of keymaps.
+ * List of keymaps, newest first.
  */
 static struct keymap *keymaps[KEYMAP_MODE_MAX];
 
+/**
+ * The same keymaps chained by hash of trigger, so that finding one doesn't
+ * mean walking the whole list.
+ */
+#define KEYMAP_BUCKETS	1024
+
+static struct keymap *keymap_buckets[KEYMAP_MODE_MAX][KEYMAP_BUCKETS];
+
+
+/**
+ * Return the hash bucket for a trigger keypress.
+ */
+static struct keymap **keymap_bucket(int keymap, struct keypress kc)
+{
+	u32b hash = (kc.code * 31 + kc.mods) * 2654435761U;
+	return &keymap_buckets[keymap][(hash >> 16) & (KEYMAP_BUCKETS - 1)];
+}
+
 
 /**
  * Find a keymap, given a keypress.
@@ -61,7 +81,7 @@ const struct keypress *keymap_find(int keymap, struct keypress kc)
 {
 	struct keymap *k;
 	assert(keymap >= 0 && keymap < KEYMAP_MODE_MAX);
-	for (k = keymaps[keymap]; k; k = k->next) {
+	for (k = *keymap_bucket(keymap, kc); k; k = k->hash_next) {
 		if (k->key.code == kc.code && k->key.mods == kc.mods)
 			return k->actions;
 	}
@@ -99,6 +119,7 @@ static struct keypress *keymap_make(const struct keypress *actions)
 void keymap_add(int keymap, struct keypress trigger, struct keypress *actions, bool user)
 {
 	struct keymap *k = mem_zalloc(sizeof *k);
+	struct keymap **bucket;
 	assert(keymap >= 0 && keymap < KEYMAP_MODE_MAX);
 
 	keymap_remove(keymap, trigger);
@@ -108,8 +129,14 @@ void keymap_add(int keymap, struct keypress trigger, struct keypress *actions, b
 	k->user = user;
 
 	k->next = keymaps[keymap];
+	if (k->next)
+		k->next->prev = k;
 	keymaps[keymap] = k;
 
+	bucket = keymap_bucket(keymap, trigger);
+	k->hash_next = *bucket;
+	*bucket = k;
+
 	return;
 }
 
@@ -120,21 +147,26 @@ void keymap_add(int keymap, struct keypress trigger, struct keypress *actions, b
 bool keymap_remove(int keymap, struct keypress trigger)
 {
 	struct keymap *k;
-	struct keymap *prev = NULL;
+	struct keymap **link;
 	assert(keymap >= 0 && keymap < KEYMAP_MODE_MAX);
 
-	for (k = keymaps[keymap]; k; k = k->next) {
+	for (link = keymap_bucket(keymap, trigger); *link;
+		 link = &(*link)->hash_next) {
+		k = *link;
 		if (k->key.code == trigger.code && k->key.mods == trigger.mods) {
-			mem_free(k->actions);
-			if (prev)
-				prev->next = k->next;
+			*link = k->hash_next;
+
+			if (k->prev)
+				k->prev->next = k->next;
 			else
 				keymaps[keymap] = k->next;
+			if (k->next)
+				k->next->prev = k->prev;
+
+			mem_free(k->actions);
 			mem_free(k);
 			return true;
 		}
-
-		prev = k;
 	}
 
 	return false;
@@ -156,7 +188,10 @@ void keymap_free(void)
 			mem_free(k);
 			k = next;
 		}
+		keymaps[i] = NULL;
 	}
+
+	memset(keymap_buckets, 0, sizeof(keymap_buckets));
 }
 
 
@@ -1407,9 +1407,19 @@ static void display_artifact(int col, int row, bool cursor, int oid)
 }
 
 /**
- * Look for an artifact
+ * Note one object in the artifact location map, keeping the first copy found
  */
-static struct object *find_artifact(struct artifact *artifact)
+static void locate_artifact(struct object **where, struct object *obj)
+{
+	if (obj->artifact && !where[obj->artifact->aidx])
+		where[obj->artifact->aidx] = obj;
+}
+
+/**
+ * Find every artifact in the world in a single pass, filling 'where' (sized
+ * like a_info) with the object for each artifact found
+ */
+static void locate_artifacts(struct object **where)
 {
 	int y, x, i;
 	struct object *obj;
@@ -1418,35 +1428,41 @@ static struct object *find_artifact(struct artifact *artifact)
 	for (y = 1; y < cave->height; y++)
 		for (x = 1; x < cave->width; x++)
 			for (obj = square_object(cave, y, x); obj; obj = obj->next)
-				if (obj->artifact == artifact)
-					return obj;
+				locate_artifact(where, obj);
 
 	/* Player objects */
 	for (obj = player->gear; obj; obj = obj->next)
-		if (obj->artifact == artifact)
-			return obj;
+		locate_artifact(where, obj);
 
 	/* Monster objects */
 	for (i = cave_monster_max(cave) - 1; i >= 1; i--) {
 		struct monster *mon = cave_monster(cave, i);
-		obj = mon ? mon->held_obj : NULL;
 
-		while (obj) {
-			if (obj->artifact == artifact)
-				return obj;
-			obj = obj->next;
-		}
+		for (obj = mon ? mon->held_obj : NULL; obj; obj = obj->next)
+			locate_artifact(where, obj);
 	}
 
 	/* Store objects */
 	for (i = 0; i < MAX_STORES; i++) {
 		struct store *s = &stores[i];
 		for (obj = s->stock; obj; obj = obj->next)
-			if (obj->artifact == artifact)
-				return obj;
+			locate_artifact(where, obj);
 	}
+}
+
+/**
+ * Look for an artifact
+ */
+static struct object *find_artifact(struct artifact *artifact)
+{
+	struct object **where = mem_zalloc((z_info->a_max + 1) * sizeof(*where));
+	struct object *obj;
+
+	locate_artifacts(where);
+	obj = where[artifact->aidx];
+	mem_free(where);
 
-	return NULL;
+	return obj;
 }
 
 /**
@@ -1528,12 +1544,11 @@ static int art2gid(int oid)
 }
 
 /**
- * Check if the given artifact idx is something we should "Know" about
+ * Check if the given artifact idx is something we should "Know" about;
+ * 'obj' is where the artifact is, or NULL if it isn't anywhere
  */
-static bool artifact_is_known(int a_idx)
+static bool artifact_is_known(int a_idx, const struct object *obj)
 {
-	struct object *obj;
-
 	if (!a_info[a_idx].name)
 		return false;
 
@@ -1543,8 +1558,7 @@ static bool artifact_is_known(int a_idx)
 	if (!a_info[a_idx].created)
 		return false;
 
-	/* Check all objects to see if it exists but hasn't been IDed */
-	obj = find_artifact(&a_info[a_idx]);
+	/* Check whether it exists but hasn't been IDed */
 	if (obj && !object_is_known_artifact(obj))
 		return false;
 
@@ -1560,15 +1574,21 @@ static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 {
 	int a_count = 0;
 	int j;
+	struct object **where;
 
 	if (artifacts)
 		assert(artifacts_len >= z_info->a_max);
 
+	/* Find where all the artifacts are at once, rather than searching the
+	 * whole world for each one */
+	where = mem_zalloc((z_info->a_max + 1) * sizeof(*where));
+	locate_artifacts(where);
+
 	for (j = 0; j < z_info->a_max; j++) {
 		/* Artifact doesn't exist */
 		if (!a_info[j].name) continue;
 
-		if (OPT(player, cheat_xtra) || artifact_is_known(j)) {
+		if (OPT(player, cheat_xtra) || artifact_is_known(j, where[j])) {
 			if (artifacts)
 				artifacts[a_count++] = j;
 			else
@@ -1576,6 +1596,8 @@ static int collect_known_artifacts(int *artifacts, size_t artifacts_len)
 		}
 	}
 
+	mem_free(where);
+
 	return a_count;
 }
 
@@ -42,7 +42,9 @@ static void hallucinatory_monster(int *a, wchar_t *c)
 {
 	while (1) {
 		/* Select a random monster */
+		int rng = Rand_stream(RNG_UI);
 		struct monster_race *race = &r_info[randint0(z_info->r_max)];
+		Rand_stream(rng);
 		
 		/* Skip non-entries */
 		if (!race->name) continue;
@@ -63,7 +65,9 @@ static void hallucinatory_object(int *a, wchar_t *c)
 	
 	while (1) {
 		/* Select a random object */
+		int rng = Rand_stream(RNG_UI);
 		struct object_kind *kind = &k_info[randint0(z_info->k_max - 1) + 1];
+		Rand_stream(rng);
 
 		/* Skip non-entries */
 		if (!kind->name) continue;
@@ -486,6 +490,74 @@ static void print_rel_map(wchar_t c, byte a, int y, int x)
 
 
 
+/**
+ * What each grid looks like in the redraw under way, so that map subwindows
+ * showing the same grids as the main map need not work them out again.
+ * A cell is good for the current redraw if its frame is map_frame.
+ */
+struct map_cell {
+	int a, ta;
+	wchar_t c, tc;
+	u32b frame;
+};
+
+static struct map_cell *map_cells;
+static int map_cells_hgt, map_cells_wid;
+static u32b map_frame;
+
+/**
+ * Start a redraw, forgetting what the grids looked like last time
+ */
+static void map_cells_begin(void)
+{
+	if (map_cells_hgt != cave->height || map_cells_wid != cave->width) {
+		mem_free(map_cells);
+		map_cells_hgt = cave->height;
+		map_cells_wid = cave->width;
+		map_cells = mem_zalloc(map_cells_hgt * map_cells_wid *
+							   sizeof(*map_cells));
+		map_frame = 0;
+	}
+
+	/* Frame 0 marks cells never drawn, so skip it when we wrap around */
+	if (++map_frame == 0) {
+		memset(map_cells, 0, map_cells_hgt * map_cells_wid *
+			   sizeof(*map_cells));
+		map_frame = 1;
+	}
+}
+
+/**
+ * Get what grid (y, x) looks like in this redraw
+ */
+static void map_cell_get(int y, int x, int *ap, wchar_t *cp, int *tap,
+						 wchar_t *tcp)
+{
+	struct map_cell *cell = &map_cells[y * map_cells_wid + x];
+
+	if (cell->frame != map_frame) {
+		struct grid_data g;
+		map_info(y, x, &g);
+		grid_data_as_text(&g, &cell->a, &cell->c, &cell->ta, &cell->tc);
+		cell->frame = map_frame;
+	}
+
+	*ap = cell->a;
+	*cp = cell->c;
+	*tap = cell->ta;
+	*tcp = cell->tc;
+}
+
+/**
+ * Free the redraw cache
+ */
+void map_cells_free(void)
+{
+	mem_free(map_cells);
+	map_cells = NULL;
+	map_cells_hgt = map_cells_wid = 0;
+}
+
 /**
  * Display an attr/char pair at the given map location
  *
@@ -532,7 +604,6 @@ static void prt_map_aux(void)
 {
 	int a, ta;
 	wchar_t c, tc;
-	struct grid_data g;
 
 	int y, x;
 	int vy, vx;
@@ -563,8 +634,7 @@ static void prt_map_aux(void)
 				if (vx + tile_width - 1 >= t->wid) continue;
 
 				/* Determine what is there */
-				map_info(y, x, &g);
-				grid_data_as_text(&g, &a, &c, &ta, &tc);
+				map_cell_get(y, x, &a, &c, &ta, &tc);
 				Term_queue_char(t, vx, vy, a, c, ta, tc);
 
 				if ((tile_width > 1) || (tile_height > 1))
@@ -587,12 +657,14 @@ void prt_map(void)
 {
 	int a, ta;
 	wchar_t c, tc;
-	struct grid_data g;
 
 	int y, x;
 	int vy, vx;
 	int ty, tx;
 
+	/* Grids are worked out afresh for each redraw */
+	map_cells_begin();
+
 	/* Redraw map sub-windows */
 	prt_map_aux();
 
@@ -607,8 +679,7 @@ void prt_map(void)
 			if (!square_in_bounds(cave, y, x)) continue;
 
 			/* Determine what is there */
-			map_info(y, x, &g);
-			grid_data_as_text(&g, &a, &c, &ta, &tc);
+			map_cell_get(y, x, &a, &c, &ta, &tc);
 
 			/* Hack -- Queue it */
 			Term_queue_char(Term, vx, vy, a, c, ta, tc);
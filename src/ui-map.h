@@ -16,10 +16,13 @@
  *    are included in all such copies.  Other copyrights may also apply.
  */
 
+struct grid_data;
+
 extern void grid_data_as_text(struct grid_data *g, int *ap, wchar_t *cp,
 							  int *tap, wchar_t *tcp);
 extern void move_cursor_relative(int y, int x);
 extern void print_rel(wchar_t c, byte a, int y, int x);
 extern void prt_map(void);
+extern void map_cells_free(void);
 extern void display_map(int *cy, int *cx);
 extern void do_cmd_view_map(void);
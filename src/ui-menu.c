@@ -978,30 +978,34 @@ void menu_set_cursor_x_offset(struct menu *m, int offset)
 
 /*** Dynamic menu handling ***/
 
+/**
+ * Dynamic menu entries are kept in an array, indexed by row, which grows by
+ * doubling from DYNAMIC_MENU_INITIAL entries
+ */
 struct menu_entry {
 	char *text;
 	int value;
 	menu_row_validity_t valid;
-
-	struct menu_entry *next;
 };
 
-static int dynamic_valid(struct menu *m, int oid)
+#define DYNAMIC_MENU_INITIAL	8
+
+static struct menu_entry *dynamic_entry(struct menu *m, int oid)
 {
-	struct menu_entry *entry;
+	struct menu_entry *entries = menu_priv(m);
 
-	for (entry = menu_priv(m); oid; oid--) {
-		entry = entry->next;
-		assert(entry);
-	}
+	assert(oid >= 0 && oid < m->count);
+	return &entries[oid];
+}
 
-	return entry->valid;
+static int dynamic_valid(struct menu *m, int oid)
+{
+	return dynamic_entry(m, oid)->valid;
 }
 
 static void dynamic_display(struct menu *m, int oid, bool cursor,
 		int row, int col, int width)
 {
-	struct menu_entry *entry;
 	byte color = curs_attrs[MN_ROW_STYLE_ENABLED][0 != cursor];
 
 	/* Hack? While row_funcs is private, we need to be consistent with what the menu will do. */
@@ -1011,12 +1015,7 @@ static void dynamic_display(struct menu *m, int oid, bool cursor,
 		color = curs_attrs[style][0 != cursor];
 	}
 
-	for (entry = menu_priv(m); oid; oid--) {
-		entry = entry->next;
-		assert(entry);
-	}
-
-	Term_putstr(col, row, width, color, entry->text);
+	Term_putstr(col, row, width, color, dynamic_entry(m, oid)->text);
 }
 
 static const menu_iter dynamic_iter = {
@@ -1036,29 +1035,22 @@ struct menu *menu_dynamic_new(void)
 
 void menu_dynamic_add_valid(struct menu *m, const char *text, int value, menu_row_validity_t valid)
 {
-	struct menu_entry *head = menu_priv(m);
-	struct menu_entry *new = mem_zalloc(sizeof *new);
+	struct menu_entry *entries = menu_priv(m);
+	int n = m->count;
 
 	assert(m->row_funcs == &dynamic_iter);
 
-	new->text = string_make(text);
-	new->value = value;
-	new->valid = valid;
+	/* Grow the array when it is full */
+	if (n == 0)
+		entries = mem_alloc(DYNAMIC_MENU_INITIAL * sizeof(*entries));
+	else if (n >= DYNAMIC_MENU_INITIAL && !(n & (n - 1)))
+		entries = mem_realloc(entries, 2 * n * sizeof(*entries));
 
-	if (head) {
-		struct menu_entry *tail = head;
-		while (1) {
-			if (tail->next)
-				tail = tail->next;
-			else
-				break;
-		}
+	entries[n].text = string_make(text);
+	entries[n].value = value;
+	entries[n].valid = valid;
 
-		tail->next = new;
-		menu_setpriv(m, m->count + 1, head);
-	} else {
-		menu_setpriv(m, m->count + 1, new);
-	}
+	menu_setpriv(m, n + 1, entries);
 }
 
 void menu_dynamic_add(struct menu *m, const char *text, int value)
@@ -1084,10 +1076,10 @@ size_t menu_dynamic_longest_entry(struct menu *m)
 	size_t biggest = 0;
 	size_t current;
 
-	struct menu_entry *entry;
+	int i;
 
-	for (entry = menu_priv(m); entry; entry = entry->next) {
-		current = strlen(entry->text);
+	for (i = 0; i < m->count; i++) {
+		current = strlen(dynamic_entry(m, i)->text);
 		if (current > biggest)
 			biggest = current;
 	}
@@ -1125,29 +1117,20 @@ void menu_dynamic_calc_location(struct menu *m, int mx, int my)
 int menu_dynamic_select(struct menu *m)
 {
 	ui_event e = menu_select(m, 0, true);
-	struct menu_entry *entry;
-	int cursor = m->cursor;
 
 	if (e.type == EVT_ESCAPE)
 		return -1;
 
-	for (entry = menu_priv(m); cursor; cursor--) {
-		entry = entry->next;
-		assert(entry);
-	}	
-
-	return entry->value;
+	return dynamic_entry(m, m->cursor)->value;
 }
 
 void menu_dynamic_free(struct menu *m)
 {
-	struct menu_entry *entry = menu_priv(m);
-	while (entry) {
-		struct menu_entry *next = entry->next;
-		string_free(entry->text);
-		mem_free(entry);
-		entry = next;
-	}
+	int i;
+
+	for (i = 0; i < m->count; i++)
+		string_free(dynamic_entry(m, i)->text);
+	mem_free(menu_priv(m));
 	mem_free(m);
 }
 
@@ -175,32 +175,3 @@ void lore_show_interactive(const struct monster_race *race,
 	textui_textblock_show(tb, SCREEN_REGION, NULL);
 	textblock_free(tb);
 }
-
-/**
- * Display monster recall statically.
- *
- * This is intended to be called in a subwindow, since it clears the entire
- * window before drawing, and has no interactivity.
- *
- * \param race is the monster race we are describing.
- * \param lore is the known information about the monster race.
- */
-void lore_show_subwindow(const struct monster_race *race,
-						 const struct monster_lore *lore)
-{
-	int y;
-	textblock *tb;
-
-	assert(race && lore);
-
-	/* Erase the window, since textui_textblock_place() only clears what it
-	 * needs */
-	for (y = 0; y < Term->hgt; y++)
-		Term_erase(0, y, 255);
-
-	tb = textblock_new();
-	lore_description(tb, race, lore, false);
-	textui_textblock_place(tb, SCREEN_REGION, NULL);
-	textblock_free(tb);
-}
-
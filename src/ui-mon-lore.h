@@ -24,7 +24,5 @@ void lore_description(textblock *tb, const struct monster_race *race,
 					  const struct monster_lore *original_lore, bool spoilers);
 void lore_show_interactive(const struct monster_race *race,
 						   const struct monster_lore *lore);
-void lore_show_subwindow(const struct monster_race *race,
-						 const struct monster_lore *lore);
 
 #endif /* UI_MONSTER_LORE_H */
@@ -29,6 +29,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "profile.h"
 #include "store.h"
 #include "ui-display.h"
 #include "ui-history.h"
@@ -1164,6 +1165,13 @@ void write_character_dump(ang_file *fff)
 		file_putf(fff, "\n");
 	}
 
+	/* Dump command timings, if the game was built to take them */
+	if (profile_command_total()) {
+		file_putf(fff, "  [Command timings]\n\n");
+		profile_command_dump(fff);
+		file_putf(fff, "\n");
+	}
+
 	mem_free(home_list);
 }
 
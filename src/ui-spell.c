@@ -29,6 +29,15 @@
 #include "ui-output.h"
 
 
+/**
+ * A formatted spell menu row
+ */
+struct spell_menu_row {
+	char out[80];
+	int attr;
+	bool valid;
+};
+
 /**
  * Spell menu data struct
  */
@@ -36,6 +45,8 @@ struct spell_menu_data {
 	int *spells;
 	int n_spells;
 
+	struct spell_menu_row *rows;
+
 	bool browse;
 	bool (*is_valid)(int spell_index);
 	bool show_description;
@@ -50,56 +61,67 @@ struct spell_menu_data {
 static int spell_menu_valid(struct menu *m, int oid)
 {
 	struct spell_menu_data *d = menu_priv(m);
-	int *spells = d->spells;
 
-	return d->is_valid(spells[oid]);
+	return d->rows[oid].valid;
 }
 
 /**
- * Display a row of the spell menu
+ * Format a row of the spell menu.
+ *
+ * Nothing the row depends on can change while the menu is up, so this is
+ * done once when the menu is made rather than every time a row is drawn.
  */
-static void spell_menu_display(struct menu *m, int oid, bool cursor,
-		int row, int col, int wid)
+static void spell_menu_format(struct spell_menu_data *d, int oid)
 {
-	struct spell_menu_data *d = menu_priv(m);
+	struct spell_menu_row *row = &d->rows[oid];
 	int spell_index = d->spells[oid];
 	const struct class_spell *spell = spell_by_index(spell_index);
 
 	char help[30];
-	char out[80];
 
-	int attr;
-	const char *illegible = NULL;
 	const char *comment = NULL;
 
+	row->valid = d->is_valid(spell_index);
+
 	if (spell->slevel >= 99) {
-		illegible = "(illegible)";
-		attr = COLOUR_L_DARK;
+		my_strcpy(row->out, "(illegible)", sizeof(row->out));
+		row->attr = COLOUR_L_DARK;
+		return;
 	} else if (player->spell_flags[spell_index] & PY_SPELL_FORGOTTEN) {
 		comment = " forgotten";
-		attr = COLOUR_YELLOW;
+		row->attr = COLOUR_YELLOW;
 	} else if (player->spell_flags[spell_index] & PY_SPELL_LEARNED) {
 		if (player->spell_flags[spell_index] & PY_SPELL_WORKED) {
 			/* Get extra info */
 			get_spell_info(spell_index, help, sizeof(help));
 			comment = help;
-			attr = COLOUR_WHITE;
+			row->attr = COLOUR_WHITE;
 		} else {
 			comment = " untried";
-			attr = COLOUR_L_GREEN;
+			row->attr = COLOUR_L_GREEN;
 		}
 	} else if (spell->slevel <= player->lev) {
 		comment = " unknown";
-		attr = COLOUR_L_BLUE;
+		row->attr = COLOUR_L_BLUE;
 	} else {
 		comment = " difficult";
-		attr = COLOUR_RED;
+		row->attr = COLOUR_RED;
 	}
 
 	/* Dump the spell --(-- */
-	strnfmt(out, sizeof(out), "%-30s%2d %4d %3d%%%s", spell->name,
+	strnfmt(row->out, sizeof(row->out), "%-30s%2d %4d %3d%%%s", spell->name,
 			spell->slevel, spell->smana, spell_chance(spell_index), comment);
-	c_prt(attr, illegible ? illegible : out, row, col);
+}
+
+/**
+ * Display a row of the spell menu
+ */
+static void spell_menu_display(struct menu *m, int oid, bool cursor,
+		int row, int col, int wid)
+{
+	struct spell_menu_data *d = menu_priv(m);
+
+	c_prt(d->rows[oid].attr, d->rows[oid].out, row, col);
 }
 
 /**
@@ -162,6 +184,7 @@ static struct menu *spell_menu_new(const struct object *obj,
 {
 	struct menu *m = menu_new(MN_SKIN_SCROLL, &spell_menu_iter);
 	struct spell_menu_data *d = mem_alloc(sizeof *d);
+	int i;
 
 	region loc = { -60, 1, 60, -99 };
 
@@ -176,6 +199,9 @@ static struct menu *spell_menu_new(const struct object *obj,
 
 	/* Copy across private data */
 	d->is_valid = is_valid;
+	d->rows = mem_zalloc(d->n_spells * sizeof(*d->rows));
+	for (i = 0; i < d->n_spells; i++)
+		spell_menu_format(d, i);
 	d->selected_spell = -1;
 	d->browse = false;
 	d->show_description = false;
@@ -202,6 +228,7 @@ static struct menu *spell_menu_new(const struct object *obj,
 static void spell_menu_destroy(struct menu *m)
 {
 	struct spell_menu_data *d = menu_priv(m);
+	mem_free(d->rows);
 	mem_free(d->spells);
 	mem_free(d);
 	mem_free(m);
@@ -108,6 +108,7 @@ struct store_context {
 	struct menu menu;			/* Menu instance */
 	struct store *store;	/* Pointer to store */
 	struct object **list;	/* List of objects (unused) */
+	s32b *prices;			/* Price of one of each, kept with the list */
 	int flags;				/* Display flags */
 	bool inspect_only;		/* Only allow looking */
 
@@ -259,6 +260,24 @@ static void store_display_recalc(struct store_context *ctx)
 }
 
 
+/**
+ * Get the store's stock into the context, along with what each item costs.
+ * Prices only change with the stock or the owner, so they needn't be worked
+ * out again each time the menu is drawn.
+ */
+static void store_list_stock(struct store_context *ctx)
+{
+	int i;
+
+	store_stock_list(ctx->store, ctx->list, z_info->store_inven_max);
+	for (i = 0; i < z_info->store_inven_max && ctx->list[i]; i++) {
+		if (ctx->store->sidx == STORE_HOME)
+			ctx->prices[i] = 0;
+		else
+			ctx->prices[i] = price_item(ctx->store, ctx->list[i], false, 1);
+	}
+}
+
 /**
  * Redisplay a single store entry
  */
@@ -297,7 +316,7 @@ static void store_display_entry(struct menu *menu, int oid, bool cursor, int row
 	/* Describe an object (fully) in a store */
 	if (store->sidx != STORE_HOME) {
 		/* Extract the "minimum" price */
-		x = price_item(store, obj, false, 1);
+		x = ctx->prices[oid];
 
 		/* Make sure the player can afford it */
 		if ((int) player->au < (int) x)
@@ -1114,8 +1133,9 @@ static void store_menu_init(struct store_context *ctx, struct store *store, bool
 	ctx->flags = STORE_INIT_CHANGE;
 	ctx->inspect_only = inspect_only;
 	ctx->list = mem_zalloc(sizeof(struct object *) * z_info->store_inven_max);
+	ctx->prices = mem_zalloc(sizeof(s32b) * z_info->store_inven_max);
 
-	store_stock_list(ctx->store, ctx->list, z_info->store_inven_max);
+	store_list_stock(ctx);
 
 	/* Init the menu structure */
 	menu_init(menu, MN_SKIN_SCROLL, &store_menu);
@@ -1149,6 +1169,7 @@ void textui_store_knowledge(int n)
 
 	screen_load();
 
+	mem_free(ctx.prices);
 	mem_free(ctx.list);
 }
 
@@ -1161,7 +1182,7 @@ static void refresh_stock(game_event_type type, game_event_data *unused, void *u
 	struct store_context *ctx = user;
 	struct menu *menu = &ctx->menu;
 
-	store_stock_list(ctx->store, ctx->list, z_info->store_inven_max);
+	store_list_stock(ctx);
 
 	/* Display the store */
 	store_display_recalc(ctx);
@@ -1206,8 +1227,11 @@ void use_store(game_event_type type, game_event_data *data, void *user)
 	store_menu_init(&ctx, store, false);
 
 	/* Say a friendly hello. */
-	if (store->sidx != STORE_HOME)
+	if (store->sidx != STORE_HOME) {
+		int rng = Rand_stream(RNG_UI);
 		prt_welcome(store->owner);
+		Rand_stream(rng);
+	}
 
 	/* Shopping */
 	menu_select(&ctx.menu, 0, false);
@@ -1215,6 +1239,7 @@ void use_store(game_event_type type, game_event_data *data, void *user)
 	/* Shopping's done */
 	event_remove_handler(EVENT_STORECHANGED, refresh_stock, &ctx);
 	msg_flag = false;
+	mem_free(ctx.prices);
 	mem_free(ctx.list);
 
 	/* Take a turn */
@@ -249,7 +249,7 @@ static ui_event target_recall_loop_object(struct object *obj, int y, int x,
 				strnfmt(out_val, TARGET_OUT_VAL_SIZE,
 						"%s%s%s%s, %s (%d:%d, noise=%d, scent=%d).", s1, s2, s3,
 						o_name, coords, y, x, (int)cave->noise.grids[y][x],
-						(int)cave->scent.grids[y][x]);
+						(int)square_scent(cave, y, x));
 			} else {
 				strnfmt(out_val, TARGET_OUT_VAL_SIZE,
 						"%s%s%s%s, %s.", s1, s2, s3, o_name, coords);
@@ -354,7 +354,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 				strnfmt(out_val, sizeof(out_val),
 						"%s%s%s%s, %s (%d:%d, noise=%d, scent=%d).", s1, s2, s3,
 						name_strange, coords, y, x, (int)cave->noise.grids[y][x],
-						(int)cave->scent.grids[y][x]);
+						(int)square_scent(cave, y, x));
 			else
 				strnfmt(out_val, sizeof(out_val), "%s%s%s%s, %s.",
 						s1, s2, s3, name_strange, coords);
@@ -417,7 +417,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 									"%s%s%s%s (%s), %s (%d:%d, noise=%d, scent=%d).",
 									s1, s2, s3, m_name, buf, coords, y, x,
 									(int)cave->noise.grids[y][x],
-									(int)cave->scent.grids[y][x]);
+									(int)square_scent(cave, y, x));
 						} else {
 							strnfmt(out_val, sizeof(out_val),
 									"%s%s%s%s (%s), %s.",
@@ -483,7 +483,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 								"%s%s%s%s, %s (%d:%d, noise=%d, scent=%d).",
 								s1, s2, s3, o_name, coords, y, x,
 								(int)cave->noise.grids[y][x],
-								(int)cave->scent.grids[y][x]);
+								(int)square_scent(cave, y, x));
 					}
 
 					prt(out_val, 0, 0);
@@ -548,7 +548,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 							"%s%s%s%s, %s (%d:%d, noise=%d, scent=%d).", s1, s2,
 							s3, trap->kind->name, coords, y, x,
 							(int)cave->noise.grids[y][x],
-							(int)cave->scent.grids[y][x]);
+							(int)square_scent(cave, y, x));
 				} else {
 					strnfmt(out_val, sizeof(out_val), "%s%s%s%s, %s.", 
 							s1, s2, s3, trap->kind->desc, coords);
@@ -596,7 +596,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 								"%s%s%sa pile of %d objects, %s (%d:%d, noise=%d, scent=%d).",
 								s1, s2, s3, floor_num, coords, y, x,
 								(int)cave->noise.grids[y][x],
-								(int)cave->scent.grids[y][x]);
+								(int)square_scent(cave, y, x));
 					} else {
 						strnfmt(out_val, sizeof(out_val),
 								"%s%s%sa pile of %d objects, %s.",
@@ -699,7 +699,7 @@ static ui_event target_set_interactive_aux(int y, int x, int mode)
 				strnfmt(out_val, sizeof(out_val),
 						"%s%s%s%s, %s (%d:%d, noise=%d, scent=%d).", s1, s2, s3,
 						name, coords, y, x, (int)cave->noise.grids[y][x],
-						(int)cave->scent.grids[y][x]);
+						(int)square_scent(cave, y, x));
 			} else {
 				strnfmt(out_val, sizeof(out_val),
 						"%s%s%s%s, %s.", s1, s2, s3, name, coords);
@@ -1197,18 +1197,21 @@ bool target_set_interactive(int mode, int x, int y)
 
 					/* Change if legal */
 					if (change_panel(d)) {
+						struct point_set *old_targets = targets;
+
 						/* Recalculate interesting grids */
-						point_set_dispose(targets);
 						targets = target_get_monsters(mode);
 
 						/* Find a new monster */
 						i = target_pick(old_y, old_x, ddy[d], ddx[d], targets);
 
-						/* Restore panel if needed */
+						/* Restore panel if needed, and with it the grids that
+						 * were interesting there */
 						if ((i < 0) && modify_panel(Term, old_wy, old_wx)) {
-							/* Recalculate interesting grids */
 							point_set_dispose(targets);
-							targets = target_get_monsters(mode);
+							targets = old_targets;
+						} else {
+							point_set_dispose(old_targets);
 						}
 
 						/* Handle stuff */
@@ -653,6 +653,42 @@ void Term_queue_chars(int x, int y, int n, int a, const wchar_t *s)
  * ------------------------------------------------------------------------ */
 
 
+/**
+ * Narrow the modified columns x1..x2 of row y to the span that really differs
+ * between the old and new contents, comparing tile layers too if 'tiles'.
+ *
+ * Whole rows are compared with memcmp() first, since rows marked by a full
+ * redraw are mostly unchanged.  Returns false if nothing in the row differs.
+ */
+static bool Term_fresh_span(int y, int *x1, int *x2, bool tiles)
+{
+	term_win *old = Term->old, *scr = Term->scr;
+	int l = *x1, r = *x2;
+	size_t n = r - l + 1;
+
+	if (!memcmp(&old->a[y][l], &scr->a[y][l], n * sizeof(int)) &&
+		!memcmp(&old->c[y][l], &scr->c[y][l], n * sizeof(wchar_t)) &&
+		(!tiles ||
+		 (!memcmp(&old->ta[y][l], &scr->ta[y][l], n * sizeof(int)) &&
+		  !memcmp(&old->tc[y][l], &scr->tc[y][l], n * sizeof(wchar_t)))))
+		return false;
+
+#define TERM_CELL_SAME(X) \
+	(old->a[y][X] == scr->a[y][X] && old->c[y][X] == scr->c[y][X] && \
+	 (!tiles || (old->ta[y][X] == scr->ta[y][X] && \
+				 old->tc[y][X] == scr->tc[y][X])))
+
+	/* Something differs, so these stop inside the row */
+	while (TERM_CELL_SAME(l)) l++;
+	while (TERM_CELL_SAME(r)) r--;
+
+#undef TERM_CELL_SAME
+
+	*x1 = l;
+	*x2 = r;
+	return true;
+}
+
 /**
  * Flush a row of the current window (see "Term_fresh")
  *
@@ -1260,25 +1296,28 @@ errr Term_fresh(void)
 			int x1 = Term->x1[y];
 			int x2 = Term->x2[y];
 
-			/* Flush each "modified" row */
+			/* Flush each "modified" row that has really changed */
 			if (x1 <= x2) {
-				/* Use "Term_pict()" - always, sometimes or never */
-				if (Term->always_pict)
-					/* Flush the row */
-					Term_fresh_row_pict(y, x1, x2);
-				else if (Term->higher_pict)
-					/* Flush the row */
-					Term_fresh_row_both(y, x1, x2);
-				else
-					/* Flush the row */
-					Term_fresh_row_text(y, x1, x2);
+				if (Term_fresh_span(y, &x1, &x2,
+						Term->always_pict || Term->higher_pict)) {
+					/* Use "Term_pict()" - always, sometimes or never */
+					if (Term->always_pict)
+						/* Flush the row */
+						Term_fresh_row_pict(y, x1, x2);
+					else if (Term->higher_pict)
+						/* Flush the row */
+						Term_fresh_row_both(y, x1, x2);
+					else
+						/* Flush the row */
+						Term_fresh_row_text(y, x1, x2);
+
+					/* Hack -- Flush that row (if allowed) */
+					if (!Term->never_frosh) Term_xtra(TERM_XTRA_FROSH, y);
+				}
 
 				/* This row is all done */
 				Term->x1[y] = w;
 				Term->x2[y] = 0;
-
-				/* Hack -- Flush that row (if allowed) */
-				if (!Term->never_frosh) Term_xtra(TERM_XTRA_FROSH, y);
 			}
 		}
 
@@ -1477,17 +1516,21 @@ errr Term_addstr(int n, int a, const char *buf)
 
 	wchar_t s[1024];
 
-	/* Copy to a rewriteable string */
- 	text_mbstowcs(s, buf, 1024);
-
 	/* Handle "unusable" cursor */
 	if (Term->scr->cu) return (-1);
 
 	/* Obtain maximal length */
 	k = (n < 0) ? (w + 1) : n;
 
-	/* Obtain the usable string length */
-	for (n = 0; (n < k) && s[n]; n++) /* loop */;
+	/* Copy to a rewriteable string, widening plain ASCII directly */
+	for (n = 0; (n < k) && (n < 1023) && buf[n] && !(buf[n] & 0x80); n++)
+		s[n] = (unsigned char)buf[n];
+	if ((n < k) && (n < 1023) && buf[n]) {
+		text_mbstowcs(s, buf, 1024);
+
+		/* Obtain the usable string length */
+		for (n = 0; (n < k) && s[n]; n++) /* loop */;
+	}
 
 	/* React to reaching the edge of the screen */
 	if (Term->scr->cx + n >= w) res = n = w - Term->scr->cx;
@@ -1663,6 +1706,58 @@ errr Term_erase(int x, int y, int n)
 }
 
 
+/**
+ * Move every row of the window up by `n` rows, blanking the `n` rows left
+ * at the bottom.  Only the row pointers are moved, so this is cheap however
+ * wide the window is; every row is marked as changed for Term_fresh().
+ */
+errr Term_scroll(int n)
+{
+	int i, y;
+
+	int w = Term->wid;
+	int h = Term->hgt;
+
+	term_win *scr = Term->scr;
+
+	if (n <= 0) return (0);
+	if (n >= h) return (Term_clear());
+
+	/* Rotate the rows up one at a time; n is at most a screenful */
+	for (i = 0; i < n; i++) {
+		int *aa = scr->a[0];
+		wchar_t *cc = scr->c[0];
+		int *taa = scr->ta[0];
+		wchar_t *tcc = scr->tc[0];
+
+		memmove(scr->a, scr->a + 1, (h - 1) * sizeof(int *));
+		memmove(scr->c, scr->c + 1, (h - 1) * sizeof(wchar_t *));
+		memmove(scr->ta, scr->ta + 1, (h - 1) * sizeof(int *));
+		memmove(scr->tc, scr->tc + 1, (h - 1) * sizeof(wchar_t *));
+
+		scr->a[h - 1] = aa;
+		scr->c[h - 1] = cc;
+		scr->ta[h - 1] = taa;
+		scr->tc[h - 1] = tcc;
+	}
+
+	/* The rows that moved have all changed */
+	for (y = 0; y < h - n; y++) {
+		Term->x1[y] = 0;
+		Term->x2[y] = w - 1;
+	}
+	Term->y1 = 0;
+	if (Term->y2 < h - n - 1) Term->y2 = h - n - 1;
+
+	/* Blank the rows that came round from the top */
+	for (y = h - n; y < h; y++)
+		Term_erase(0, y, w);
+
+	/* Success */
+	return (0);
+}
+
+
 /**
  * Clear the entire window, and move to the top left corner
  *
@@ -2062,6 +2157,41 @@ errr Term_inkey(ui_event *ch, bool wait, bool take)
  * Extra routines
  * ------------------------------------------------------------------------ */
 
+/**
+ * Get a screen image of the current size, from the pool if there is one
+ */
+static term_win *term_win_get(int w, int h)
+{
+	term_win *s = Term->pool;
+
+	/* Reuse a saved screen, or make a new one */
+	if (s) {
+		Term->pool = s->next;
+	} else {
+		s = mem_zalloc(sizeof(term_win));
+		term_win_init(s, w, h);
+	}
+
+	s->next = NULL;
+	return s;
+}
+
+
+/**
+ * Free all the pooled screen images of a term
+ */
+static void term_win_pool_nuke(term *t)
+{
+	while (t->pool) {
+		term_win *s = t->pool;
+
+		t->pool = s->next;
+		term_win_nuke(s);
+		mem_free(s);
+	}
+}
+
+
 /**
  * Save the "requested" screen into the "memorized" screen
  *
@@ -2072,13 +2202,8 @@ errr Term_save(void)
 	int w = Term->wid;
 	int h = Term->hgt;
 
-	term_win *mem;
-
-	/* Allocate window */
-	mem = mem_zalloc(sizeof(term_win));
-
-	/* Initialize window */
-	term_win_init(mem, w, h);
+	/* Get a window */
+	term_win *mem = term_win_get(w, h);
 
 	/* Grab */
 	term_win_copy(mem, Term->scr, w, h);
@@ -2098,11 +2223,15 @@ errr Term_save(void)
 /**
  * Restore the "requested" contents (see above).
  *
+ * Only the parts of each row which were written over since the save (the
+ * menu or popup, usually) are copied back and marked as changed, so closing
+ * something small doesn't make the next refresh go over the whole screen.
+ *
  * Every "Term_save()" should match exactly one "Term_load()"
  */
 errr Term_load(void)
 {
-	int y;
+	int x, y;
 
 	int w = Term->wid;
 	int h = Term->hgt;
@@ -2111,32 +2240,56 @@ errr Term_load(void)
 
 	/* Pop off window from the list */
 	if (Term->mem) {
+		term_win *scr = Term->scr;
+
 		/* Save pointer to old mem */
 		tmp = Term->mem;
 
 		/* Forget it */
 		Term->mem = Term->mem->next;
 
-		/* Load */
-		term_win_copy(Term->scr, tmp, w, h);
+		/* Load the changed part of each row */
+		for (y = 0; y < h; y++) {
+			int x1 = w, x2 = -1;
 
-		/* Free the old window */
-		(void)term_win_nuke(tmp);
+			for (x = 0; x < w; x++) {
+				if ((scr->a[y][x] == tmp->a[y][x]) &&
+					(scr->c[y][x] == tmp->c[y][x]) &&
+					(scr->ta[y][x] == tmp->ta[y][x]) &&
+					(scr->tc[y][x] == tmp->tc[y][x]))
+					continue;
+
+				scr->a[y][x] = tmp->a[y][x];
+				scr->c[y][x] = tmp->c[y][x];
+				scr->ta[y][x] = tmp->ta[y][x];
+				scr->tc[y][x] = tmp->tc[y][x];
+
+				if (x1 > x) x1 = x;
+				x2 = x;
+			}
 
-		/* Kill it */
-		mem_free(tmp);
-	}
+			/* Nothing to do */
+			if (x2 < 0) continue;
 
-	/* Assume change */
-	for (y = 0; y < h; y++) {
-		/* Assume change */
-		Term->x1[y] = 0;
-		Term->x2[y] = w - 1;
-	}
+			/* Check for new min/max row info */
+			if (y < Term->y1) Term->y1 = y;
+			if (y > Term->y2) Term->y2 = y;
 
-	/* Assume change */
-	Term->y1 = 0;
-	Term->y2 = h - 1;
+			/* Check for new min/max col info in this row */
+			if (x1 < Term->x1[y]) Term->x1[y] = x1;
+			if (x2 > Term->x2[y]) Term->x2[y] = x2;
+		}
+
+		/* Load the cursor */
+		scr->cx = tmp->cx;
+		scr->cy = tmp->cy;
+		scr->cu = tmp->cu;
+		scr->cv = tmp->cv;
+
+		/* Keep the old window for the next save */
+		tmp->next = Term->pool;
+		Term->pool = tmp;
+	}
 
 	/* One less saved */
 	Term->saved--;
@@ -2146,7 +2299,6 @@ errr Term_load(void)
 }
 
 
-
 /**
  * React to a new physical window size.
  */
@@ -2196,6 +2348,9 @@ errr Term_resize(int w, int h)
 	/* Save old window */
 	hold_tmp = Term->tmp;
 
+	/* The pooled windows are the wrong size now */
+	term_win_pool_nuke(Term);
+
 	/* Create new scanners */
 	Term->x1 = mem_zalloc(h * sizeof(int));
 	Term->x2 = mem_zalloc(h * sizeof(int));
@@ -2408,6 +2563,9 @@ errr term_nuke(term *t)
 		mem_free(t->tmp);
 	}
 
+	/* Nuke the pooled windows */
+	term_win_pool_nuke(t);
+
 	/* Free some arrays */
 	mem_free(t->x1);
 	mem_free(t->x2);
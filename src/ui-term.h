@@ -213,6 +213,9 @@ struct term
 	term_win *tmp;
 	term_win *mem;
 
+	/* Saved screens no longer in use, kept for the next save */
+	term_win *pool;
+
 	/* Number of times saved */
 	byte saved;
 
@@ -372,6 +375,7 @@ extern void Term_big_putch(int x, int y, int a, wchar_t c);
 extern errr Term_putstr(int x, int y, int n, int a, const char *s);
 extern errr Term_erase(int x, int y, int n);
 extern errr Term_clear(void);
+extern errr Term_scroll(int n);
 extern errr Term_redraw(void);
 extern errr Term_redraw_section(int x1, int y1, int x2, int y2);
 extern errr Term_mark(int x, int y);
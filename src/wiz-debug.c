@@ -40,6 +40,7 @@
 #include "player-calcs.h"
 #include "player-timed.h"
 #include "player-util.h"
+#include "profile.h"
 #include "project.h"
 #include "target.h"
 #include "trap.h"
@@ -180,7 +181,7 @@ static void do_cmd_wiz_hack_nick(void)
 				if (!square_in_bounds_fully(cave, y, x)) continue;
 
 				/* Display proper smell */
-				if (cave->scent.grids[y][x] != i) continue;
+				if (square_scent(cave, y, x) != i) continue;
 
 				/* Display player/floors/walls */
 				if ((y == py) && (x == px))
@@ -1846,6 +1847,145 @@ static void do_cmd_wiz_help(void)
 	screen_load();
 }
 
+/**
+ * Report on the object pool: objects in use now, the most ever in use at
+ * once, and how many the allocated slabs can hold; then, if allocations are
+ * being counted, what they have been counted against.
+ */
+static void do_cmd_wiz_object_pool(void)
+{
+	struct object_pool_stats stats;
+	char buf[80];
+	int i;
+
+	object_pool_get_stats(&stats);
+	if (!(mem_flags & MEM_ACCOUNT)) {
+		msg("Objects: %d in use, %d at most, room for %d.", stats.live,
+			stats.high_water, stats.capacity);
+		return;
+	}
+
+	screen_save();
+	clear_from(0);
+	strnfmt(buf, sizeof(buf), "Objects: %d in use, %d at most, room for %d.",
+			stats.live, stats.high_water, stats.capacity);
+	prt(buf, 0, 0);
+	strnfmt(buf, sizeof(buf), "%-10s %12s %12s %10s %10s", "", "live bytes",
+			"most bytes", "blocks", "allocs");
+	prt(buf, 2, 0);
+
+	for (i = 0; i < MEM_TAG_MAX; i++) {
+		struct mem_tag_stats tag;
+
+		mem_tag_get(i, &tag);
+		strnfmt(buf, sizeof(buf), "%-10s %12lu %12lu %10u %10u", tag.name,
+				(unsigned long)tag.live, (unsigned long)tag.high_water,
+				tag.blocks, tag.allocs);
+		prt(buf, i + 3, 0);
+	}
+
+	prt("[Press any key to leave]", MEM_TAG_MAX + 4, 0);
+	inkey();
+	screen_load();
+}
+
+/**
+ * Show what each kind of command timed so far took, one row each, with the
+ * histogram as the number of digits in each bucket's count
+ */
+static void wiz_profile_commands(void)
+{
+	char buf[80];
+	int code, row = 3;
+
+	strnfmt(buf, sizeof(buf), "Commands timed: %u", profile_command_total());
+	prt(buf, 0, 0);
+	strnfmt(buf, sizeof(buf), "%-20s %6s %8s %8s %6s %5s %5s %s", "", "count",
+			"avg ms", "longest", "energy", "upd", "draw", "<1ms..>=1s");
+	prt(buf, 2, 0);
+
+	for (code = 0; code <= CMD_REPEAT && row < Term->hgt - 2; code++) {
+		struct profile_command cmd;
+		char hist[PROFILE_BUCKETS + 1];
+		const char *verb = cmd_verb(code);
+		int i;
+
+		if (!profile_command_get(code, &cmd)) continue;
+
+		for (i = 0; i < PROFILE_BUCKETS; i++) {
+			u32b n = cmd.buckets[i];
+			int digits = 0;
+
+			for (; n; n /= 10) digits++;
+			hist[i] = digits ? I2D(MIN(digits, 9)) : '.';
+		}
+		hist[PROFILE_BUCKETS] = '\0';
+
+		strnfmt(buf, sizeof(buf), "%-20.20s %6u %8.2f %8.1f %6.1f %5.2f %5.2f %s",
+				verb ? verb : format("command %d", code), cmd.count,
+				cmd.total / cmd.count, cmd.longest,
+				(double)cmd.energy / cmd.count,
+				(double)cmd.updates / cmd.count,
+				(double)cmd.redraws / cmd.count, hist);
+		prt(buf, row++, 0);
+	}
+}
+
+/**
+ * Show where the game turns timed so far have gone, and what the player's
+ * commands took, and let them be started again.
+ */
+static void do_cmd_wiz_profile(void)
+{
+	char buf[80];
+	struct keypress ch;
+	bool commands = false;
+	int i;
+
+	if (!profile_enabled()) {
+		msg("Timing is not built in; configure with --enable-profile.");
+		return;
+	}
+
+	screen_save();
+
+	do {
+		s32b turns = profile_turns();
+
+		clear_from(0);
+		if (commands) {
+			wiz_profile_commands();
+		} else {
+			strnfmt(buf, sizeof(buf), "Time spent over %d game turns:",
+					turns);
+			prt(buf, 0, 0);
+			strnfmt(buf, sizeof(buf), "%-17s %9s %10s %10s %8s %8s", "",
+					"calls", "total ms", "self ms", "ms/turn", "longest");
+			prt(buf, 2, 0);
+
+			for (i = 0; i < PROF_MAX; i++) {
+				struct profile_stat stat;
+
+				profile_get(i, &stat);
+				strnfmt(buf, sizeof(buf), "%-17s %9u %10.1f %10.1f %8.3f %8.2f",
+						stat.name, stat.calls, stat.total, stat.self,
+						turns ? stat.total / turns : 0.0, stat.longest);
+				prt(buf, i + 3, 0);
+			}
+		}
+
+		prt(format("[r to start again, c for %s, any other key to leave]",
+				   commands ? "timers" : "commands"), Term->hgt - 1, 0);
+		ch = inkey();
+		if (ch.code == 'r')
+			profile_reset();
+		else if (ch.code == 'c')
+			commands = !commands;
+	} while (ch.code == 'r' || ch.code == 'c');
+
+	screen_load();
+}
+
 /**
  * Advance the player to level 50 with max stats and other bonuses.
  */
@@ -2125,6 +2265,20 @@ void get_debug_command(void)
 			break;
 		}
 
+		/* Where the time goes */
+		case 'I':
+		{
+			do_cmd_wiz_profile();
+			break;
+		}
+
+		/* Object pool usage */
+		case 'M':
+		{
+			do_cmd_wiz_object_pool();
+			break;
+		}
+
 		/* Summon Named Monster */
 		case 'n':
 		{
@@ -193,7 +193,7 @@ static void kind_info(char *buf, size_t buf_len, char *dam, size_t dam_len,
 /**
  * Create a spoiler file for items
  */
-static void spoil_obj_desc(const char *fname)
+bool spoil_obj_desc(const char *fname)
 {
 	int i, k, s, t, n = 0;
 	u16b who[200];
@@ -209,7 +209,7 @@ static void spoil_obj_desc(const char *fname)
 	/* Oops */
 	if (!fh) {
 		msg("Cannot create spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Header */
@@ -289,11 +289,13 @@ static void spoil_obj_desc(const char *fname)
 	/* Check for errors */
 	if (!file_close(fh)) {
 		msg("Cannot close spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Message */
 	msg("Successfully created a spoiler file.");
+
+	return true;
 }
 
 
@@ -339,7 +341,7 @@ static const grouper group_artifact[] =
 /**
  * Create a spoiler file for artifacts
  */
-static void spoil_artifact(const char *fname)
+bool spoil_artifact(const char *fname)
 {
 	int i, j;
 	char buf[1024];
@@ -351,7 +353,7 @@ static void spoil_artifact(const char *fname)
 	/* Oops */
 	if (!fh) {
 		msg("Cannot create spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Dump to the spoiler file */
@@ -435,11 +437,13 @@ static void spoil_artifact(const char *fname)
 	/* Check for errors */
 	if (!file_close(fh)) {
 		msg("Cannot close spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Message */
 	msg("Successfully created a spoiler file.");
+
+	return true;
 }
 
 
@@ -450,7 +454,7 @@ static void spoil_artifact(const char *fname)
 /**
  * Create a brief spoiler file for monsters
  */
-static void spoil_mon_desc(const char *fname)
+bool spoil_mon_desc(const char *fname)
 {
 	int i, n = 0;
 
@@ -473,7 +477,7 @@ static void spoil_mon_desc(const char *fname)
 	/* Oops */
 	if (!fh) {
 		msg("Cannot create spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Dump the header */
@@ -553,11 +557,13 @@ static void spoil_mon_desc(const char *fname)
 	/* Check for errors */
 	if (!file_close(fh)) {
 		msg("Cannot close spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Worked */
 	msg("Successfully created a spoiler file.");
+
+	return true;
 }
 
 
@@ -572,7 +578,7 @@ static void spoil_mon_desc(const char *fname)
 /**
  * Create a spoiler file for monsters (-SHAWN-)
  */
-static void spoil_mon_info(const char *fname)
+bool spoil_mon_info(const char *fname)
 {
 	char buf[1024];
 	int i, n;
@@ -586,7 +592,7 @@ static void spoil_mon_info(const char *fname)
 
 	if (!fh) {
 		msg("Cannot create spoiler file.");
-		return;
+		return false;
 	}
 
 	/* Dump the header */
@@ -662,10 +668,12 @@ static void spoil_mon_info(const char *fname)
 	/* Check for errors */
 	if (!file_close(fh)) {
 		msg("Cannot close spoiler file.");
-		return;
+		return false;
 	}
 
 	msg("Successfully created a spoiler file.");
+
+	return true;
 }
 
 static void spoiler_menu_act(const char *title, int row)
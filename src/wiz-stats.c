@@ -30,6 +30,8 @@
 #include "obj-util.h"
 #include "object.h"
 #include "ui-command.h"
+#include "ui-input.h"
+#include "ui-output.h"
 #include "wizard.h"
 
 /**
@@ -1399,22 +1401,22 @@ static void post_process_stats(void)
  */
 static void scan_for_objects(void)
 { 
-	int y, x;
+	int i;
 
-	for (y = 1; y < cave->height - 1; y++) {
-		for (x = 1; x < cave->width - 1; x++) {
-			struct object *obj;
+	/* Go through the object list */
+	for (i = 1; i < cave->obj_max; i++) {
+		struct object *obj = cave->objects[i];
 
-			while ((obj = square_object(cave, y, x))) {
-				/* Get data on the object */
-				get_obj_data(obj, y, x, false, false);
+		/* Skip those monsters carry */
+		if (!obj || obj->held_m_idx) continue;
 
-				/* Delete the object */
-				square_excise_object(cave, y, x, obj);
-				delist_object(cave, obj);
-				object_delete(&obj);
-			}
-		}
+		/* Get data on the object */
+		get_obj_data(obj, obj->iy, obj->ix, false, false);
+
+		/* Delete the object */
+		square_excise_object(cave, obj->iy, obj->ix, obj);
+		delist_object(cave, obj);
+		object_delete(&obj);
 	}
 }
 
@@ -1487,13 +1489,39 @@ static void revive_uniques(void)
 	}
 }
 
+/**
+ * Show how far a stats run has got on the top line, and give the player the
+ * chance to stop it; returns false once a key has been pressed.
+ */
+static bool stats_progress(const char *what, int done, int total)
+{
+	char buf[80];
+	ui_event e;
+
+	strnfmt(buf, sizeof(buf), "%s: %d/%d levels (%d%%), any key to stop",
+			what, done, total, (done * 100) / MAX(total, 1));
+	prt(buf, 0, 0);
+	Term_fresh();
+
+	/* Check for a key, without waiting */
+	inkey_scan = SCAN_INSTANT;
+	e = inkey_ex();
+	if (e.type == EVT_NONE) return true;
+
+	event_signal(EVENT_INPUT_FLUSH);
+	msg("Cancelled.");
+	return false;
+}
+
 /**
  * This function loops through the level and does N iterations of
- * the stat calling function, assuming diving style.
+ * the stat calling function, assuming diving style.  Each depth is written
+ * out as it is finished, so stopping part way keeps those already done.
  */ 
 static void diving_stats(void)
 {
 	int depth;
+	int total = ((MAX_LVL + 4) / 5) * tries;
 
 	/* Iterate through levels */
 	for (depth = 0; depth < MAX_LVL; depth += 5) {
@@ -1501,8 +1529,13 @@ static void diving_stats(void)
 		if (player->depth == 0) player->depth = 1;
 
 		/* Do many iterations of each level */
-		for (iter = 0; iter < tries; iter++)
-		     stats_collect_level();
+		for (iter = 0; iter < tries; iter++) {
+			if (!stats_progress("Diving", (depth / 5) * tries + iter, total)) {
+				do_cmd_redraw();
+				return;
+			}
+			stats_collect_level();
+		}
 
 		/* Print the output to the file */
 		print_stats(depth);
@@ -1514,11 +1547,13 @@ static void diving_stats(void)
 
 /**
  * This function loops through the level and does N iterations of
- * the stat calling function, assuming clearing style.
+ * the stat calling function, assuming clearing style.  The results are
+ * averages over every iteration, so nothing is written if it is stopped.
  */ 
 static void clearing_stats(void)
 {
 	int depth;
+	int total = tries * (MAX_LVL - 1);
 
 	/* Do many iterations of the game */
 	for (iter = 0; iter < tries; iter++) {
@@ -1545,14 +1580,18 @@ static void clearing_stats(void)
 			/* Move player to that depth */
 			player->depth = depth;
 
+			if (!stats_progress("Clearing", iter * (MAX_LVL - 1) + depth - 1,
+								total)) {
+				do_cmd_redraw();
+				return;
+			}
+
 			/* Get stats */
 			stats_collect_level();
 
 			/* Debug
 			msg_format("Finished level %d,depth"); */
 		}
-
-		msg("Iteration %d complete",iter);
 	}
 
 	/* Print to file */
@@ -1889,6 +1928,8 @@ void disconnect_stats(void)
 	tries = temp;
 
 	for (i = 1; i <= tries; i++) {
+		if (!stats_progress("Connectivity", i - 1, tries)) break;
+
 		/* Assume no disconnected areas */
 		has_dsc = false;
 
@@ -1944,16 +1985,14 @@ void disconnect_stats(void)
 
 		if (has_dsc) dsc_area++;
 
-		msg("Iteration: %d",i); 
-
 		/* Free arrays */
-		for (y = 0; x < cave->height; x++)
+		for (y = 0; y < cave->height; y++)
 			mem_free(cave_dist[y]);
 		mem_free(cave_dist);
 	}
 
-	msg("Total levels with disconnected areas: %ld",dsc_area);
-	msg("Total levels isolated from stairs: %ld",dsc_from_stairs);
+	msg("Total levels with disconnected areas: %ld of %d", dsc_area, i - 1);
+	msg("Total levels isolated from stairs: %ld of %d", dsc_from_stairs, i - 1);
 
 	/* Redraw the level */
 	do_cmd_redraw();
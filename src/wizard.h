@@ -29,6 +29,10 @@ void disconnect_stats(void);
 void pit_stats(void);
 
 /* wiz-spoil.c */
+bool spoil_obj_desc(const char *fname);
+bool spoil_artifact(const char *fname);
+bool spoil_mon_desc(const char *fname);
+bool spoil_mon_info(const char *fname);
 void do_cmd_spoilers(void);
 
 #endif /* !INCLUDED_WIZARD_H */
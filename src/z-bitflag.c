@@ -71,13 +71,27 @@ bool flag_has_dbg(const bitflag *flags, const size_t size, const int flag,
 int flag_next(const bitflag *flags, const size_t size, const int flag)
 {
 	const int max_flags = FLAG_MAX(size);
-	int f, flag_offset, flag_binary;
+	int f = MAX(flag, FLAG_START);
 
-	for (f = flag; f < max_flags; f++) {
-		flag_offset = FLAG_OFFSET(f);
-		flag_binary = FLAG_BINARY(f);
+	while (f < max_flags) {
+		const size_t flag_offset = FLAG_OFFSET(f);
+
+		/* The flags in this element from f on */
+		bitflag bits = flags[flag_offset] >> ((f - FLAG_START) % FLAG_WIDTH);
+
+		/* Skip whole elements with nothing left on */
+		if (!bits) {
+			f = FLAG_START + (flag_offset + 1) * FLAG_WIDTH;
+			continue;
+		}
 
-		if (flags[flag_offset] & flag_binary) return f;
+		/* Find the lowest flag that is on */
+		while (!(bits & 1)) {
+			bits >>= 1;
+			f++;
+		}
+
+		return f;
 	}
 
 	return FLAG_END;
@@ -91,14 +105,16 @@ int flag_next(const bitflag *flags, const size_t size, const int flag)
  */
 int flag_count(const bitflag *flags, const size_t size)
 {
-	size_t i, j;
+	size_t i;
 	int count = 0;
 
 	for (i = 0; i < size; i++) {
-		for (j = 0; j < FLAG_WIDTH; j++) {
-			if (flags[i] & FLAG_BINARY(j)) {
-				count++;
-			}
+		bitflag bits = flags[i];
+
+		/* Clear the lowest flag that is on until none are left */
+		while (bits) {
+			bits &= bits - 1;
+			count++;
 		}
 	}
 
@@ -246,6 +246,64 @@ s32b expression_evaluate(expression_t const * const expression)
 	return value;
 }
 
+/**
+ * Fold an operation into the one before it where that gives the same result,
+ * so that evaluation has fewer steps.  Returns true if it was folded.
+ */
+static bool expression_fold_operation(expression_t *expression,
+									  const expression_operation_t operation)
+{
+	expression_operation_t *last;
+	s32b a, b, folded;
+
+	if (expression->operation_count == 0)
+		return false;
+
+	last = &expression->operations[expression->operation_count - 1];
+	a = last->operand;
+	b = operation.operand;
+
+	switch (operation.operator) {
+		case OPERATOR_ADD:
+		case OPERATOR_SUB:
+			/* Runs of additions and subtractions make one addition */
+			if (last->operator == OPERATOR_SUB)
+				a = -a;
+			else if (last->operator != OPERATOR_ADD)
+				return false;
+			folded = (operation.operator == OPERATOR_ADD) ? a + b : a - b;
+			break;
+		case OPERATOR_MUL:
+			if (last->operator != OPERATOR_MUL)
+				return false;
+			folded = a * b;
+			break;
+		case OPERATOR_DIV:
+			/* (x / a) / b is x / (a * b) for positive a and b */
+			if (last->operator != OPERATOR_DIV || a <= 0 || b <= 0)
+				return false;
+			folded = a * b;
+			break;
+		case OPERATOR_NEG:
+			/* Two negations cancel out */
+			if (last->operator != OPERATOR_NEG)
+				return false;
+			expression->operation_count--;
+			return true;
+		default:
+			return false;
+	}
+
+	/* The folded operand has to fit */
+	if (folded < -32768 || folded > 32767)
+		return false;
+
+	if (last->operator == OPERATOR_SUB)
+		last->operator = OPERATOR_ADD;
+	last->operand = (s16b)folded;
+	return true;
+}
+
 /**
  * Add an operation to an expression, allocating more memory as needed.
  */
@@ -254,6 +312,9 @@ static void expression_add_operation(expression_t *expression,
 {
 	size_t count = 0;
 
+	if (expression_fold_operation(expression, operation))
+		return;
+
 	if (expression->operation_count >= expression->operations_size) {
 		expression->operations_size += EXPRESSION_ALLOC_SIZE;
 		expression->operations = mem_realloc(expression->operations, expression->operations_size * sizeof(expression_operation_t));
@@ -360,6 +360,24 @@ bool file_newer(const char *first, const char *second)
 #endif /* !HAVE_STAT */
 }
 
+/**
+ * Get the modification time and size of a file; false if it doesn't exist
+ * or they can't be had.
+ */
+bool file_stamp(const char *fname, unsigned long *mtime, unsigned long *size)
+{
+#ifdef HAVE_STAT
+	struct stat st;
+
+	if (stat(fname, &st) != 0) return false;
+	*mtime = (unsigned long)st.st_mtime;
+	*size = (unsigned long)st.st_size;
+	return true;
+#else /* HAVE_STAT */
+	return false;
+#endif /* !HAVE_STAT */
+}
+
 
 
 
@@ -527,6 +545,14 @@ bool file_write(ang_file *f, const char *buf, size_t n)
 	return fwrite(buf, 1, n, f->fh) == n;
 }
 
+/**
+ * Push anything written to file 'f' out to the system now.
+ */
+bool file_flush(ang_file *f)
+{
+	return fflush(f->fh) == 0;
+}
+
 /** Line-based IO **/
 
 /**
@@ -540,7 +566,6 @@ bool file_write(ang_file *f, const char *buf, size_t n)
 bool file_getl(ang_file *f, char *buf, size_t len)
 {
 	bool seen_cr = false;
-	byte b;
 	size_t i = 0;
 
 	/* Leave a byte for the terminating 0 */
@@ -549,7 +574,9 @@ bool file_getl(ang_file *f, char *buf, size_t len)
 	while (i < max_len) {
 		char c;
 
-		if (!file_readc(f, &b)) {
+		/* Read straight from the stdio buffer rather than via file_readc() */
+		int b = getc(f->fh);
+		if (b == EOF) {
 			buf[i] = '\0';
 			return (i == 0) ? false : true;
 		}
@@ -561,8 +588,9 @@ bool file_getl(ang_file *f, char *buf, size_t len)
 			continue;
 		}
 
+		/* Push back the start of the next line; seeking would drop the buffer */
 		if (seen_cr && c != '\n') {
-			fseek(f->fh, -1, SEEK_CUR);
+			ungetc(b, f->fh);
 			buf[i] = '\0';
 			return true;
 		}
@@ -131,6 +131,11 @@ bool file_move(const char *fname, const char *newname);
  */
 bool file_newer(const char *first, const char *second);
 
+/**
+ * Get the modification time and size of a file, if they can be had.
+ */
+bool file_stamp(const char *fname, unsigned long *mtime, unsigned long *size);
+
 
 /** File handle creation **/
 
@@ -227,6 +232,14 @@ int file_read(ang_file *f, char *buf, size_t n);
  */
 bool file_write(ang_file *f, const char *buf, size_t n);
 
+/**
+ * Pass on anything written to the file represented by `f` so far, rather
+ * than leaving it buffered.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool file_flush(ang_file *f);
+
 /**
  * Read a byte from the file represented by `f` and place it at the location
  * specified by 'b'.
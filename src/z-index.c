@@ -0,0 +1,130 @@
+/**
+ * \file z-index.c
+ * \brief Hashed indices from names to table positions
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "z-index.h"
+#include "z-util.h"
+#include "z-virt.h"
+
+/**
+ * An open-addressed table of names, each with the value it was added with.
+ * The names are not copied, so they must outlive the index; in practice
+ * they belong to the game data table the index is for.
+ */
+struct name_index {
+	bool caseless;
+	size_t slots;
+	size_t count;
+	const char **names;
+	int *values;
+};
+
+/**
+ * Make an index with room for n names (it grows if more are added).  If
+ * caseless is set, names are matched as my_stricmp() does.
+ */
+struct name_index *name_index_new(size_t n, bool caseless)
+{
+	struct name_index *ni = mem_zalloc(sizeof(*ni));
+
+	ni->caseless = caseless;
+	for (ni->slots = 16; ni->slots < 2 * n; ni->slots *= 2) ;
+	ni->names = mem_zalloc(ni->slots * sizeof(*ni->names));
+	ni->values = mem_zalloc(ni->slots * sizeof(*ni->values));
+
+	return ni;
+}
+
+void name_index_free(struct name_index *ni)
+{
+	if (!ni) return;
+	mem_free(ni->names);
+	mem_free(ni->values);
+	mem_free(ni);
+}
+
+/**
+ * Find the slot holding `name`, or the empty one where it would go.  The
+ * hash is djb2, folded to lower case for caseless indices.
+ */
+static size_t name_index_slot(const struct name_index *ni, const char *name)
+{
+	u32b hash = 5381;
+	const char *s;
+	size_t i, mask = ni->slots - 1;
+
+	for (s = name; *s; s++)
+		hash = ((hash << 5) + hash) +
+			(ni->caseless ? tolower((unsigned char)*s) : (unsigned char)*s);
+
+	for (i = hash & mask; ni->names[i]; i = (i + 1) & mask)
+		if (ni->caseless ? !my_stricmp(ni->names[i], name) :
+			streq(ni->names[i], name))
+			break;
+
+	return i;
+}
+
+/**
+ * Add a name to the index.  If the name is there already the first value
+ * added for it is kept, so that lookups agree with a scan from the start
+ * of the table.
+ */
+void name_index_add(struct name_index *ni, const char *name, int value)
+{
+	size_t slot;
+
+	if (!name) return;
+
+	/* Keep the table at most half full */
+	if (2 * (ni->count + 1) > ni->slots) {
+		const char **old_names = ni->names;
+		int *old_values = ni->values;
+		size_t i, old_slots = ni->slots;
+
+		ni->slots *= 2;
+		ni->names = mem_zalloc(ni->slots * sizeof(*ni->names));
+		ni->values = mem_zalloc(ni->slots * sizeof(*ni->values));
+		for (i = 0; i < old_slots; i++) {
+			if (!old_names[i]) continue;
+			slot = name_index_slot(ni, old_names[i]);
+			ni->names[slot] = old_names[i];
+			ni->values[slot] = old_values[i];
+		}
+		mem_free(old_names);
+		mem_free(old_values);
+	}
+
+	slot = name_index_slot(ni, name);
+	if (ni->names[slot]) return;
+	ni->names[slot] = name;
+	ni->values[slot] = value;
+	ni->count++;
+}
+
+/**
+ * Return the value added with `name`, or -1 if it isn't in the index (or
+ * there is no index).
+ */
+int name_index_find(const struct name_index *ni, const char *name)
+{
+	size_t slot;
+
+	if (!ni) return -1;
+
+	slot = name_index_slot(ni, name);
+
+	return ni->names[slot] ? ni->values[slot] : -1;
+}
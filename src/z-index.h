@@ -0,0 +1,29 @@
+/**
+ * \file z-index.h
+ * \brief Hashed indices from names to table positions
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#ifndef Z_INDEX_H
+#define Z_INDEX_H
+
+#include "h-basic.h"
+
+struct name_index;
+
+struct name_index *name_index_new(size_t n, bool caseless);
+void name_index_free(struct name_index *ni);
+void name_index_add(struct name_index *ni, const char *name, int value);
+int name_index_find(const struct name_index *ni, const char *name);
+
+#endif /* !Z_INDEX_H */
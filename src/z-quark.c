@@ -17,6 +17,7 @@
  *    and not for profit purposes provided that this copyright and statement
  *    are included in all such copies.  Other copyrights may also apply.
  */
+#include "z-util.h"
 #include "z-virt.h"
 #include "z-quark.h"
 #include "init.h"
@@ -25,16 +26,52 @@ static char **quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/**
+ * Open-addressed hash index into quarks[]; each slot holds a quark, or 0
+ * if it is empty.  The size is a power of two, kept at least twice the
+ * number of quarks so that probe runs stay short.
+ */
+static quark_t *quark_index;
+static size_t index_size = 0;
+
 #define QUARKS_INIT	16
 
+/**
+ * Find the index slot holding 'str', or the empty slot where it would go.
+ */
+static size_t quark_slot(const char *str)
+{
+	size_t mask = index_size - 1;
+	size_t i = djb2_hash(str) & mask;
+
+	while (quark_index[i] && strcmp(quarks[quark_index[i]], str))
+		i = (i + 1) & mask;
+
+	return i;
+}
+
+/**
+ * Double the hash index and re-insert every quark.
+ */
+static void quark_grow_index(void)
+{
+	quark_t q;
+
+	mem_free(quark_index);
+	index_size *= 2;
+	quark_index = mem_zalloc(index_size * sizeof(*quark_index));
+
+	for (q = 1; q < nr_quarks; q++)
+		quark_index[quark_slot(quarks[q])] = q;
+}
+
 quark_t quark_add(const char *str)
 {
 	quark_t q;
+	size_t slot = quark_slot(str);
 
-	for (q = 1; q < nr_quarks; q++) {
-		if (!strcmp(quarks[q], str))
-			return q;
-	}
+	if (quark_index[slot])
+		return quark_index[slot];
 
 	if (nr_quarks == alloc_quarks) {
 		alloc_quarks *= 2;
@@ -43,6 +80,10 @@ quark_t quark_add(const char *str)
 
 	q = nr_quarks++;
 	quarks[q] = string_make(str);
+	quark_index[slot] = q;
+
+	if (nr_quarks * 2 > index_size)
+		quark_grow_index();
 
 	return q;
 }
@@ -56,6 +97,8 @@ void quarks_init(void)
 {
 	alloc_quarks = QUARKS_INIT;
 	quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+	index_size = QUARKS_INIT * 2;
+	quark_index = mem_zalloc(index_size * sizeof(*quark_index));
 }
 
 void quarks_free(void)
@@ -67,6 +110,12 @@ void quarks_free(void)
 		string_free(quarks[i]);
 
 	mem_free(quarks);
+	mem_free(quark_index);
+	quarks = NULL;
+	quark_index = NULL;
+	nr_quarks = 1;
+	alloc_quarks = 0;
+	index_size = 0;
 }
 
 struct init_module z_quark_module = {
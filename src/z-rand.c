@@ -74,6 +74,34 @@ static u32b WELLRNG1024a (void){
 	state_i = (state_i + 31) & 0x0000001fU;
 	return STATE[state_i];
 }
+
+/**
+ * Run WELLRNG1024a() n times, keeping the state index and the temporaries
+ * in locals rather than going back through the globals for every word.
+ */
+static void WELLRNG1024a_fill(u32b *buf, size_t n)
+{
+	u32b i = state_i;
+	u32b a = z0, b = z1, c = z2;
+	size_t k;
+
+	for (k = 0; k < n; k++) {
+		a = STATE[(i + 31) & 0x0000001fU];
+		b = Identity(STATE[i]) ^ MAT0POS(8, STATE[(i + M1) & 0x0000001fU]);
+		c = MAT0NEG(-19, STATE[(i + M2) & 0x0000001fU])
+			^ MAT0NEG(-14, STATE[(i + M3) & 0x0000001fU]);
+		STATE[i] = b ^ c;
+		i = (i + 31) & 0x0000001fU;
+		STATE[i] = MAT0NEG(-11, a) ^ MAT0NEG(-7, b) ^ MAT0NEG(-13, c);
+		buf[k] = STATE[i];
+	}
+
+	/* Leave everything as n single calls would have */
+	state_i = i;
+	z0 = a;
+	z1 = b;
+	z2 = c;
+}
 /* end WELL RNG */
 
 /**
@@ -92,6 +120,14 @@ bool Rand_quick = true;
  */
 u32b Rand_value;
 
+/**
+ * Whether the complex RNG should turn words into numbers the old way, so
+ * that a given seed gives exactly the sequence it did in older versions.
+ * The simple RNG always works the old way, as flavours and randarts are
+ * rebuilt from their seeds.
+ */
+bool Rand_compat = false;
+
 static bool rand_fixed = false;
 static u32b rand_fixval = 0;
 
@@ -120,6 +156,9 @@ void Rand_state_init(u32b seed)
 		/* Advance the index */
 		state_i = j;
 	}
+
+	/* Any other streams now come from the new seed */
+	Rand_streams_reset();
 }
 
 /**
@@ -150,6 +189,301 @@ void Rand_init(void)
 }
 
 
+/**
+ * Each stream is this many (as a power of two) draws on from the last
+ */
+#define RAND_STREAM_JUMP	64
+
+/**
+ * Streams not in use at the moment are parked here; the one in use is
+ * always in STATE.
+ */
+static struct rand_state rand_streams[RNG_MAX];
+static struct rand_state rand_streams_base;
+static int rand_stream_cur = RNG_MAIN;
+static bool rand_streams_ready = false;
+
+/**
+ * Polynomials over GF(2), one bit per coefficient, big enough to hold the
+ * characteristic polynomial of the generator (degree 32 * RAND_DEG).
+ */
+#define RAND_POLY_WORDS	(RAND_DEG + 1)
+#define RAND_POLY_BIT(p, i)	(((p)[(i) >> 5] >> ((i) & 31)) & 1)
+#define RAND_POLY_FLIP(p, i)	((p)[(i) >> 5] ^= (1U << ((i) & 31)))
+
+static u32b rand_charpoly[RAND_POLY_WORDS];
+static int rand_charpoly_deg = 0;
+static u32b rand_jump_poly[RAND_POLY_WORDS];
+static int rand_jump_log = -1;
+
+static void rand_state_save(struct rand_state *s)
+{
+	s->state_i = state_i;
+	s->z0 = z0;
+	s->z1 = z1;
+	s->z2 = z2;
+	memcpy(s->state, STATE, sizeof(STATE));
+}
+
+static void rand_state_load(const struct rand_state *s)
+{
+	state_i = s->state_i;
+	z0 = s->z0;
+	z1 = s->z1;
+	z2 = s->z2;
+	memcpy(STATE, s->state, sizeof(STATE));
+}
+
+/**
+ * Find the characteristic polynomial of the WELL generator, by running
+ * Berlekamp-Massey over the low bits of twice its degree worth of output.
+ * The generator is put back as it was.
+ */
+static void rand_find_charpoly(void)
+{
+	enum { N = 2 * 32 * RAND_DEG, W = N / 32 + 1 };
+	static u32b bits[W], c[W], b[W], t[W];
+	struct rand_state saved;
+	int n, i, len = 0, m = 1;
+
+	rand_state_save(&saved);
+	memset(bits, 0, sizeof(bits));
+	for (n = 0; n < N; n++) {
+		u32b word;
+
+		WELLRNG1024a_fill(&word, 1);
+		if (word & 1) RAND_POLY_FLIP(bits, n);
+	}
+	rand_state_load(&saved);
+
+	memset(c, 0, sizeof(c));
+	memset(b, 0, sizeof(b));
+	c[0] = b[0] = 1;
+	for (n = 0; n < N; n++) {
+		u32b d = RAND_POLY_BIT(bits, n);
+
+		for (i = 1; i <= len; i++)
+			d ^= RAND_POLY_BIT(c, i) & RAND_POLY_BIT(bits, n - i);
+
+		if (!d) {
+			m++;
+			continue;
+		}
+
+		memcpy(t, c, sizeof(c));
+		for (i = 0; i + m < N; i++)
+			if (RAND_POLY_BIT(b, i)) RAND_POLY_FLIP(c, i + m);
+
+		if (2 * len <= n) {
+			len = n + 1 - len;
+			memcpy(b, t, sizeof(b));
+			m = 1;
+		} else {
+			m++;
+		}
+	}
+
+	/* The characteristic polynomial is the reverse of the connection one */
+	assert(len <= 32 * RAND_DEG);
+	memset(rand_charpoly, 0, sizeof(rand_charpoly));
+	for (i = 0; i <= len; i++)
+		if (RAND_POLY_BIT(c, len - i)) RAND_POLY_FLIP(rand_charpoly, i);
+	rand_charpoly_deg = len;
+}
+
+/**
+ * r = a * b, modulo the characteristic polynomial
+ */
+static void rand_poly_mulmod(u32b *r, const u32b *a, const u32b *b)
+{
+	u32b acc[RAND_POLY_WORDS];
+	int i, w;
+
+	memset(acc, 0, sizeof(acc));
+	for (i = rand_charpoly_deg - 1; i >= 0; i--) {
+		/* Multiply by x... */
+		for (w = RAND_POLY_WORDS - 1; w > 0; w--)
+			acc[w] = (acc[w] << 1) | (acc[w - 1] >> 31);
+		acc[0] <<= 1;
+
+		/* ...reduce... */
+		if (RAND_POLY_BIT(acc, rand_charpoly_deg))
+			for (w = 0; w < RAND_POLY_WORDS; w++)
+				acc[w] ^= rand_charpoly[w];
+
+		/* ...and add */
+		if (RAND_POLY_BIT(a, i))
+			for (w = 0; w < RAND_POLY_WORDS; w++)
+				acc[w] ^= b[w];
+	}
+
+	memcpy(r, acc, sizeof(acc));
+}
+
+/**
+ * Move the current stream of the complex RNG on by 2^log2_steps draws.
+ *
+ * With P the characteristic polynomial of the generator, the state after
+ * J draws is g(A) applied to the state now, where g(x) = x^J mod P and A
+ * is the one-draw transition; so it is the sum of the states after 0 to
+ * deg(P) - 1 draws for which g has a coefficient.
+ */
+void Rand_jump(int log2_steps)
+{
+	u32b acc[RAND_DEG];
+	int i, k;
+
+	if (!rand_charpoly_deg)
+		rand_find_charpoly();
+
+	/* Work out x^(2^log2_steps) mod P, if it's not the one we have */
+	if (rand_jump_log != log2_steps) {
+		memset(rand_jump_poly, 0, sizeof(rand_jump_poly));
+		RAND_POLY_FLIP(rand_jump_poly, 1);
+		for (i = 0; i < log2_steps; i++)
+			rand_poly_mulmod(rand_jump_poly, rand_jump_poly, rand_jump_poly);
+		rand_jump_log = log2_steps;
+	}
+
+	memset(acc, 0, sizeof(acc));
+	for (i = 0; i < rand_charpoly_deg; i++) {
+		u32b word;
+
+		if (RAND_POLY_BIT(rand_jump_poly, i))
+			for (k = 0; k < RAND_DEG; k++)
+				acc[k] ^= STATE[(state_i + k) & 0x0000001fU];
+		WELLRNG1024a_fill(&word, 1);
+	}
+
+	memcpy(STATE, acc, sizeof(STATE));
+	state_i = 0;
+}
+
+/**
+ * Start each stream a long way on from the one before, beginning with the
+ * main stream as it was when last reset, so that the other streams don't
+ * depend on how far main has got by the time one is first wanted.
+ */
+static void rand_streams_derive(void)
+{
+	int i;
+
+	rand_state_save(&rand_streams[RNG_MAIN]);
+	rand_state_load(&rand_streams_base);
+	for (i = RNG_MAIN + 1; i < RNG_MAX; i++) {
+		Rand_jump(RAND_STREAM_JUMP);
+		rand_state_save(&rand_streams[i]);
+	}
+	rand_state_load(&rand_streams[RNG_MAIN]);
+	rand_streams_ready = true;
+}
+
+/**
+ * Forget the other streams, because the main one has been reseeded or
+ * loaded.  They are worked out again from it when next wanted.
+ */
+void Rand_streams_reset(void)
+{
+	rand_state_save(&rand_streams_base);
+	rand_stream_cur = RNG_MAIN;
+	rand_streams_ready = false;
+}
+
+/**
+ * Make the given stream the one the complex RNG draws from, returning the
+ * one that was in use so that the caller can put it back.  With
+ * Rand_compat there is only ever the main stream.
+ */
+int Rand_stream(int stream)
+{
+	int old = rand_stream_cur;
+
+	assert(stream >= RNG_MAIN && stream < RNG_MAX);
+
+	if (Rand_compat) stream = RNG_MAIN;
+	if (stream == old) return old;
+
+	if (!rand_streams_ready)
+		rand_streams_derive();
+
+	rand_state_save(&rand_streams[old]);
+	rand_state_load(&rand_streams[stream]);
+	rand_stream_cur = stream;
+
+	return old;
+}
+
+/**
+ * Copy out the state of a stream, so that it can be put back later
+ */
+void Rand_stream_get(int stream, struct rand_state *s)
+{
+	if (Rand_compat) stream = RNG_MAIN;
+	if (stream == rand_stream_cur) {
+		rand_state_save(s);
+		return;
+	}
+
+	if (!rand_streams_ready)
+		rand_streams_derive();
+	*s = rand_streams[stream];
+}
+
+/**
+ * Put back the state of a stream got with Rand_stream_get()
+ */
+void Rand_stream_set(int stream, const struct rand_state *s)
+{
+	if (Rand_compat) stream = RNG_MAIN;
+	if (stream == rand_stream_cur) {
+		rand_state_load(s);
+		return;
+	}
+
+	if (!rand_streams_ready)
+		rand_streams_derive();
+	rand_streams[stream] = *s;
+}
+
+/**
+ * Fill buf with the next n words from the RNG, exactly as if they had been
+ * drawn one at a time.
+ */
+void Rand_fill(u32b *buf, size_t n)
+{
+	size_t k;
+
+	if (Rand_quick) {
+		for (k = 0; k < n; k++)
+			buf[k] = (Rand_value = LCRNG(Rand_value));
+	} else {
+		WELLRNG1024a_fill(buf, n);
+	}
+}
+
+/**
+ * Map a word from the complex RNG onto 0 to m - 1 by taking the high half
+ * of a 64-bit product (Lemire's method).  A word is only thrown away, and
+ * another drawn, in the rare case that it falls in the small biased slice;
+ * the division to find that slice is only done when it might matter.
+ */
+static u32b Rand_bounded(u32b r, u32b m)
+{
+	u64b prod = (u64b)r * m;
+	u32b low = (u32b)prod;
+
+	if (low < m) {
+		u32b thresh = (0U - m) % m;
+
+		while (low < thresh) {
+			prod = (u64b)WELLRNG1024a() * m;
+			low = (u32b)prod;
+		}
+	}
+
+	return (u32b)(prod >> 32);
+}
+
 /**
  * Extract a "random" number from 0 to m - 1, via division.
  *
@@ -160,6 +494,8 @@ void Rand_init(void)
  *
  * This method has no bias, and is much less affected by patterns in the "low"
  * bits of the underlying RNG's. However, it is potentially non-terminating.
+ *
+ * The complex RNG now uses Rand_bounded() instead, unless Rand_compat is set.
  */
 u32b Rand_div(u32b m)
 {
@@ -190,6 +526,9 @@ u32b Rand_div(u32b m)
 			/* Done */
 			if (r < m) break;
 		}
+	} else if (!Rand_compat) {
+		/* Use a complex RNG, without division */
+		r = Rand_bounded(WELLRNG1024a(), m);
 	} else {
 		/* Use a complex RNG */
 		while (1) {
@@ -346,18 +685,41 @@ int Rand_sample(int mean, int upper, int lower, int stand_u, int stand_l)
 	return mean + pick;
 }
 
+/**
+ * How many dice damroll() draws words for at a time
+ */
+#define DAMROLL_BATCH	32
+
 /**
  * Generates damage for "2d6" style dice rolls
  */
 int damroll(int num, int sides)
 {
+	u32b words[DAMROLL_BATCH];
 	int i;
 	int sum = 0;
 
 	if (sides <= 0) return 0;
 
-	for (i = 0; i < num; i++)
-		sum += randint1(sides);
+	/* The old way, one die at a time */
+	if (Rand_quick || Rand_compat || rand_fixed || (num < 2)) {
+		for (i = 0; i < num; i++)
+			sum += randint1(sides);
+		return sum;
+	}
+
+	assert(sides <= 0x10000000);
+
+	/* Draw the words for a batch of dice together */
+	while (num > 0) {
+		int n = MIN(num, DAMROLL_BATCH);
+
+		Rand_fill(words, n);
+		for (i = 0; i < n; i++)
+			sum += Rand_bounded(words[i], sides) + 1;
+		num -= n;
+	}
+
 	return sum;
 }
 
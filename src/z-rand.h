@@ -99,6 +99,11 @@ extern bool Rand_quick;
  */
 extern u32b Rand_value;
 
+/**
+ * Whether the "complex" RNG keeps to the original sequence for each seed.
+ */
+extern bool Rand_compat;
+
 /**
  * The state used by the "complex" RNG.
  */
@@ -109,6 +114,30 @@ extern u32b z1;
 extern u32b z2;
 
 
+/**
+ * Independent streams for the "complex" RNG.  RNG_MAIN is the one saved
+ * with the game; the others are jumped far ahead of it, and so can be
+ * replayed without depending on how much the others have been used.
+ */
+enum {
+	RNG_MAIN = 0,
+	RNG_GENERATION,
+	RNG_MONSTERS,
+	RNG_COMBAT,
+	RNG_STORES,
+	RNG_UI,		/* Only for what is shown, never for the game */
+	RNG_MAX
+};
+
+/**
+ * The state of one stream of the complex RNG
+ */
+struct rand_state {
+	u32b state_i;
+	u32b z0, z1, z2;
+	u32b state[RAND_DEG];
+};
+
 /**
  * Initialise the RNG state with the given seed.
  */
@@ -119,6 +148,32 @@ void Rand_state_init(u32b seed);
  */
 void Rand_init(void);
 
+/**
+ * Fill a buffer with the next `n` raw 32-bit words from the RNG.
+ */
+void Rand_fill(u32b *buf, size_t n);
+
+/**
+ * Choose the stream the "complex" RNG uses, returning the previous one.
+ */
+int Rand_stream(int stream);
+
+/**
+ * Copy out or put back the state of one stream.
+ */
+void Rand_stream_get(int stream, struct rand_state *s);
+void Rand_stream_set(int stream, const struct rand_state *s);
+
+/**
+ * Drop the other streams after the main one is reseeded or loaded.
+ */
+void Rand_streams_reset(void);
+
+/**
+ * Move the current stream on by 2^log2_steps draws.
+ */
+void Rand_jump(int log2_steps);
+
 /**
  * Generates a random unsigned long integer X where "0 <= X < M" holds.
  *
@@ -75,9 +75,11 @@ void textblock_resize_if_needed(textblock *tb, size_t additional_size)
 {
 	size_t remaining = tb->size - tb->strlen;
 
-	/* If we need more room, reallocate it */
+	/* If we need more room, reallocate it, doubling the size so that long
+	 * descriptions built from many small appends don't realloc each time */
 	if (remaining < additional_size) {
-		tb->size = TEXTBLOCK_LEN_INCR(tb->strlen + additional_size);
+		while (tb->size < tb->strlen + additional_size)
+			tb->size *= 2;
 		tb->text = mem_realloc(tb->text, tb->size * sizeof *tb->text);
 		tb->attrs = mem_realloc(tb->attrs, tb->size);
 	}
@@ -205,13 +207,25 @@ const byte *textblock_attrs(textblock *tb)
 	return tb->attrs;
 }
 
+/**
+ * Check whether two textblocks hold the same text in the same colours.
+ */
+bool textblock_equal(textblock *a, textblock *b)
+{
+	if (a->strlen != b->strlen) return false;
+	if (wmemcmp(a->text, b->text, a->strlen)) return false;
+	return !memcmp(a->attrs, b->attrs, a->strlen);
+}
+
 static void new_line(size_t **line_starts, size_t **line_lengths,
 		size_t *n_lines, size_t *cur_line,
 		size_t start, size_t len)
 {
 	if (*cur_line == *n_lines) {
-		/* this number is not arbitrary: it's the height of a "standard" term */
-		(*n_lines) += 24;
+		/* this number is not arbitrary: it's the height of a "standard" term;
+		 * after that, double, since long help and info text runs to many
+		 * screens */
+		(*n_lines) = *n_lines ? *n_lines * 2 : 24;
 
 		*line_starts = mem_realloc(*line_starts,
 				*n_lines * sizeof **line_starts);
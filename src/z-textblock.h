@@ -36,6 +36,7 @@ void textblock_append_utf8(textblock *tb, const char *utf8_string);
 
 const wchar_t *textblock_text(textblock *tb);
 const byte *textblock_attrs(textblock *tb);
+bool textblock_equal(textblock *a, textblock *b);
 
 size_t textblock_calculate_lines(textblock *tb, size_t **line_starts,
 								 size_t **line_lengths, size_t width);
@@ -29,17 +29,61 @@ struct loc loc(int x, int y) {
 /**
  * Utility functions to work with point_sets
  */
+
+/**
+ * Hash slot key for a point; zero marks an empty slot
+ */
+static u32b point_set_key(int y, int x)
+{
+	return (((u32b)y & 0xFFFF) << 16 | ((u32b)x & 0xFFFF)) + 1;
+}
+
+/**
+ * Find the slot holding a point's key, or the empty slot where it would go
+ */
+static int point_set_slot(struct point_set *ps, u32b key)
+{
+	int i = (key * 2654435761U) & (ps->n_slots - 1);
+
+	while (ps->slots[i] && ps->slots[i] != key)
+		i = (i + 1) & (ps->n_slots - 1);
+
+	return i;
+}
+
+/**
+ * Rebuild the hash slots, sized to stay no more than half full
+ */
+static void point_set_rehash(struct point_set *ps)
+{
+	int i;
+
+	mem_free(ps->slots);
+	ps->n_slots = 16;
+	while (ps->n_slots < ps->allocated * 2)
+		ps->n_slots *= 2;
+	ps->slots = mem_zalloc(ps->n_slots * sizeof(*ps->slots));
+
+	for (i = 0; i < ps->n; i++) {
+		u32b key = point_set_key(ps->pts[i].y, ps->pts[i].x);
+		ps->slots[point_set_slot(ps, key)] = key;
+	}
+}
+
 struct point_set *point_set_new(int initial_size)
 {
 	struct point_set *ps = mem_alloc(sizeof(struct point_set));
 	ps->n = 0;
 	ps->allocated = initial_size;
 	ps->pts = mem_zalloc(sizeof(*(ps->pts)) * ps->allocated);
+	ps->slots = NULL;
+	point_set_rehash(ps);
 	return ps;
 }
 
 void point_set_dispose(struct point_set *ps)
 {
+	mem_free(ps->slots);
 	mem_free(ps->pts);
 	mem_free(ps);
 }
@@ -50,12 +94,16 @@ void point_set_dispose(struct point_set *ps)
  */
 void add_to_point_set(struct point_set *ps, int y, int x)
 {
+	u32b key = point_set_key(y, x);
+
 	ps->pts[ps->n].x = x;
 	ps->pts[ps->n].y = y;
 	ps->n++;
+	ps->slots[point_set_slot(ps, key)] = key;
 	if (ps->n >= ps->allocated) {
 		ps->allocated *= 2;
 		ps->pts = mem_realloc(ps->pts, sizeof(*(ps->pts)) * ps->allocated);
+		point_set_rehash(ps);
 	}
 }
 
@@ -66,9 +114,6 @@ int point_set_size(struct point_set *ps)
 
 int point_set_contains(struct point_set *ps, int y, int x)
 {
-	int i;
-	for (i = 0; i < ps->n; i++)
-		if (ps->pts[i].x == x && ps->pts[i].y == y)
-			return 1;
-	return 0;
+	u32b key = point_set_key(y, x);
+	return ps->slots[point_set_slot(ps, key)] == key;
 }
@@ -40,11 +40,18 @@ struct grouper {
 
 /**
  * A set of points that can be constructed to apply a set of changes to
+ *
+ * The points are kept in pts in the order they were added, and may be
+ * reordered there freely; slots is an open-addressing hash of the same
+ * points, so membership tests don't have to search the array.
  */
 struct point_set {
 	int n;
 	int allocated;
 	struct loc *pts;
+
+	int n_slots;
+	u32b *slots;
 };
 
 struct point_set *point_set_new(int initial_size);
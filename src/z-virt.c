@@ -20,7 +20,83 @@
 
 unsigned int mem_flags = 0;
 
-#define SZ(uptr)	*((size_t *)((char *)(uptr) - sizeof(size_t)))
+/**
+ * Each allocation is preceded by its length and the tag it was counted
+ * against, plus one; zero means it was made without MEM_ACCOUNT set
+ */
+struct mem_header {
+	size_t len;
+	size_t tag;
+};
+
+#define HEADER(uptr)	((struct mem_header *)((char *)(uptr) - \
+									   sizeof(struct mem_header)))
+#define SZ(uptr)	HEADER(uptr)->len
+
+static const char *mem_tag_names[MEM_TAG_MAX] = {
+	"other", "gamedata", "cave", "objects", "messages", "ui"
+};
+
+static struct mem_tag_stats mem_tags[MEM_TAG_MAX];
+static int mem_tag = MEM_TAG_OTHER;
+
+/**
+ * Make `tag` the one new allocations are counted against, returning the
+ * previous one so that it can be put back
+ */
+int mem_tag_set(int tag)
+{
+	int old = mem_tag;
+
+	assert(tag >= 0 && tag < MEM_TAG_MAX);
+	mem_tag = tag;
+	return old;
+}
+
+/**
+ * Report what has been counted against `tag`
+ */
+void mem_tag_get(int tag, struct mem_tag_stats *stats)
+{
+	assert(tag >= 0 && tag < MEM_TAG_MAX);
+	*stats = mem_tags[tag];
+	stats->name = mem_tag_names[tag];
+}
+
+/**
+ * Count a new allocation of `len` bytes at `mem`
+ */
+static void mem_count(void *mem, size_t len)
+{
+	struct mem_tag_stats *t;
+
+	if (!(mem_flags & MEM_ACCOUNT)) {
+		HEADER(mem)->tag = 0;
+		return;
+	}
+
+	HEADER(mem)->tag = mem_tag + 1;
+	t = &mem_tags[mem_tag];
+	t->live += len;
+	t->blocks++;
+	t->allocs++;
+	if (t->live > t->high_water)
+		t->high_water = t->live;
+}
+
+/**
+ * Stop counting the allocation at `mem`
+ */
+static void mem_uncount(void *mem)
+{
+	struct mem_tag_stats *t;
+
+	if (!HEADER(mem)->tag) return;
+
+	t = &mem_tags[HEADER(mem)->tag - 1];
+	t->live -= SZ(mem);
+	t->blocks--;
+}
 
 /**
  * Allocate `len` bytes of memory.
@@ -38,13 +114,14 @@ void *mem_alloc(size_t len)
 	/* Allow allocation of "zero bytes" */
 	if (len == 0) return (NULL);
 
-	mem = malloc(len + sizeof(size_t));
+	mem = malloc(len + sizeof(struct mem_header));
 	if (!mem)
 		quit("Out of Memory!");
-	mem += sizeof(size_t);
+	mem += sizeof(struct mem_header);
 	if (mem_flags & MEM_POISON_ALLOC)
 		memset(mem, 0xCC, len);
 	SZ(mem) = len;
+	mem_count(mem, len);
 
 	return mem;
 }
@@ -60,9 +137,10 @@ void mem_free(void *p)
 {
 	if (!p) return;
 
+	mem_uncount(p);
 	if (mem_flags & MEM_POISON_FREE)
 		memset(p, 0xCD, SZ(p));
-	free((char *)p - sizeof(size_t));
+	free(HEADER(p));
 }
 
 void *mem_realloc(void *p, size_t len)
@@ -72,16 +150,144 @@ void *mem_realloc(void *p, size_t len)
 	/* Fail gracefully */
 	if (len == 0) return (NULL);
 
-	m = realloc(m ? m - sizeof(size_t) : NULL, len + sizeof(size_t));
-	m += sizeof(size_t);
+	if (m) mem_uncount(m);
+	m = realloc(m ? (char *)HEADER(m) : NULL,
+				len + sizeof(struct mem_header));
 
 	/* Handle OOM */
 	if (!m) quit("Out of Memory!");
+	m += sizeof(struct mem_header);
 	SZ(m) = len;
+	mem_count(m, len);
 
 	return m;
 }
 
+/**
+ * Arenas hand out memory from large blocks, so that things which live and
+ * die together can all be freed at once.  Pieces released before then are
+ * kept on free lists by size, for reuse by later requests of the same size
+ * class; pieces too big for any class just wait for the arena to go.
+ */
+#define ARENA_ALIGN		16
+#define ARENA_CLASSES	64
+
+struct mem_arena_block {
+	struct mem_arena_block *next;
+	size_t size;
+	size_t used;
+};
+
+struct mem_arena {
+	struct mem_arena_block *blocks;
+	size_t block_size;
+	void *free_list[ARENA_CLASSES];
+};
+
+/* Room taken by a block header, keeping what follows aligned */
+#define ARENA_HEADER \
+	((sizeof(struct mem_arena_block) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+static struct mem_arena_block *mem_arena_block_new(size_t size)
+{
+	struct mem_arena_block *b = mem_alloc(ARENA_HEADER + size);
+	b->next = NULL;
+	b->size = size;
+	b->used = 0;
+	return b;
+}
+
+/**
+ * Make an arena which gets memory `block_size` bytes at a time
+ */
+struct mem_arena *mem_arena_new(size_t block_size)
+{
+	struct mem_arena *a = mem_zalloc(sizeof(*a));
+	a->block_size = block_size;
+	return a;
+}
+
+/**
+ * Allocate `len` bytes of zeroed memory from an arena.
+ *
+ * Returns NULL if `len` == 0; doesn't return on out of memory.
+ */
+void *mem_arena_alloc(struct mem_arena *a, size_t len)
+{
+	size_t size = (len + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	size_t class = size / ARENA_ALIGN - 1;
+	struct mem_arena_block *b = a->blocks;
+	char *mem;
+
+	if (len == 0) return NULL;
+
+	/* Reuse a released piece of the same class */
+	if (class < ARENA_CLASSES && a->free_list[class]) {
+		mem = a->free_list[class];
+		a->free_list[class] = *(void **)mem;
+		memset(mem, 0, size);
+		return mem;
+	}
+
+	if (size > a->block_size / 4) {
+		/* Big pieces get a block of their own, behind the current one */
+		struct mem_arena_block *own = mem_arena_block_new(size);
+		own->used = size;
+		if (b) {
+			own->next = b->next;
+			b->next = own;
+		} else {
+			a->blocks = own;
+		}
+		b = own;
+	} else {
+		/* Otherwise take the next piece of the current block */
+		if (!b || b->size - b->used < size) {
+			b = mem_arena_block_new(a->block_size);
+			b->next = a->blocks;
+			a->blocks = b;
+		}
+		b->used += size;
+	}
+
+	mem = (char *)b + ARENA_HEADER + b->used - size;
+	memset(mem, 0, size);
+	return mem;
+}
+
+/**
+ * Give back `len` bytes at `p`, which came from mem_arena_alloc() on the
+ * same arena with the same length
+ */
+void mem_arena_release(struct mem_arena *a, void *p, size_t len)
+{
+	size_t size = (len + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	size_t class = size / ARENA_ALIGN - 1;
+
+	if (!p || len == 0 || class >= ARENA_CLASSES) return;
+
+	if (mem_flags & MEM_POISON_FREE)
+		memset(p, 0xCD, size);
+	*(void **)p = a->free_list[class];
+	a->free_list[class] = p;
+}
+
+/**
+ * Free an arena and everything allocated from it
+ */
+void mem_arena_free(struct mem_arena *a)
+{
+	struct mem_arena_block *b, *next;
+
+	if (!a) return;
+
+	for (b = a->blocks; b; b = next) {
+		next = b->next;
+		mem_free(b);
+	}
+	mem_free(a);
+}
+
 /**
  * Duplicates an existing string `str`, allocating as much memory as necessary.
  */
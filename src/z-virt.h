@@ -23,15 +23,48 @@ void *mem_zalloc(size_t len);
 void mem_free(void *p);
 void *mem_realloc(void *p, size_t len);
 
+struct mem_arena;
+struct mem_arena *mem_arena_new(size_t block_size);
+void *mem_arena_alloc(struct mem_arena *a, size_t len);
+void mem_arena_release(struct mem_arena *a, void *p, size_t len);
+void mem_arena_free(struct mem_arena *a);
+
 char *string_make(const char *str);
 void string_free(char *str);
 char *string_append(char *s1, const char *s2);
 
 enum {
 	MEM_POISON_ALLOC = 0x00000001,
-	MEM_POISON_FREE  = 0x00000002
+	MEM_POISON_FREE  = 0x00000002,
+	MEM_ACCOUNT      = 0x00000004
 };
 
 extern unsigned int mem_flags;
 
+/**
+ * Parts of the game that allocations are counted against, when MEM_ACCOUNT
+ * is set; an allocation goes to whichever tag is current when it is made
+ */
+enum {
+	MEM_TAG_OTHER = 0,
+	MEM_TAG_GAMEDATA,
+	MEM_TAG_CAVE,
+	MEM_TAG_OBJECT,
+	MEM_TAG_MESSAGE,
+	MEM_TAG_UI,
+
+	MEM_TAG_MAX
+};
+
+struct mem_tag_stats {
+	const char *name;
+	size_t live;		/* Bytes allocated now */
+	size_t high_water;	/* Most bytes allocated at once */
+	u32b blocks;		/* Allocations not yet freed */
+	u32b allocs;		/* Allocations ever made */
+};
+
+int mem_tag_set(int tag);
+void mem_tag_get(int tag, struct mem_tag_stats *stats);
+
 #endif /* INCLUDED_Z_VIRT_H */